@@ -22,6 +22,7 @@ AttributeTable::AttributeTable() :
     newRowIndices(128, 128),
     deletedRowIndices(128, 128),
     userData(128, 128),
+    storageMode(RowMajor),
     rowPitch(0),
     numRows(0),
     allocatedRows(0),
@@ -42,7 +43,8 @@ AttributeTable::AttributeTable() :
 //------------------------------------------------------------------------------
 /**
 */
-AttributeTable::AttributeTable(std::initializer_list<Attr::AttrId> columns, bool recordColumns)
+AttributeTable::AttributeTable(std::initializer_list<Attr::AttrId> columns, bool recordColumns) :
+    AttributeTable()
 {
     this->BeginAddColumns(recordColumns);
     for (auto col : columns)
@@ -58,6 +60,30 @@ AttributeTable::AttributeTable(std::initializer_list<Attr::AttrId> columns, bool
 AttributeTable::~AttributeTable()
 {
     this->Delete();
+
+    IndexT colIndex;
+    for (colIndex = 0; colIndex < this->columns.Size(); colIndex++)
+    {
+        if (nullptr != this->columns[colIndex].index)
+        {
+            n_delete(this->columns[colIndex].index);
+            this->columns[colIndex].index = nullptr;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Column-major storage keeps all values of a column in one packed array,
+    which makes scanning a column cheap, while row-major storage is better
+    when whole rows are read or copied. The layout can only be changed
+    while the table has no value buffer.
+*/
+void
+AttributeTable::SetStorageMode(StorageMode mode)
+{
+    n_assert2(0 == this->valueBuffer, "AttributeTable::SetStorageMode(): storage mode must be set before adding rows!");
+    this->storageMode = mode;
 }
 
 //------------------------------------------------------------------------------
@@ -252,6 +278,16 @@ AttributeTable::Delete()
         Memory::Free(Memory::DefaultHeap, this->rowNewBuffer);
         this->rowNewBuffer = 0;
     }
+    for (colIndex = 0; colIndex < this->columns.Size(); colIndex++)
+    {
+        ColumnIndex* index = this->columns[colIndex].index;
+        if (nullptr != index)
+        {
+            index->rowsByHash.Clear();
+            index->rowHashes.Clear();
+            index->rowIndexed.Clear();
+        }
+    }
     this->numRows = 0;
     this->allocatedRows = 0;
     this->isModified = false;
@@ -281,6 +317,7 @@ AttributeTable::Realloc(SizeT newPitch, SizeT newAllocRows)
     n_assert(newPitch >= this->rowPitch);
 
     // allocate new value buffer
+    const SizeT oldAllocRows = this->allocatedRows;
     this->allocatedRows = newAllocRows;
     SizeT newValueBufferSize = newPitch * newAllocRows;
     void* newValueBuffer = Memory::Alloc(Memory::DefaultHeap, newValueBufferSize);
@@ -292,7 +329,20 @@ AttributeTable::Realloc(SizeT newPitch, SizeT newAllocRows)
         IndexT rowIndex;
         char* fromPtr = (char*) this->valueBuffer;
         char* toPtr = (char*) newValueBuffer;
-        if (newPitch == this->rowPitch)
+        if (ColumnMajor == this->storageMode)
+        {
+            // each column moves to its new start, columns outside the old pitch are new and have no data yet
+            IndexT colIndex;
+            for (colIndex = 0; colIndex < this->columns.Size(); colIndex++)
+            {
+                const ColumnInfo& column = this->columns[colIndex];
+                if (column.byteOffset < this->rowPitch)
+                {
+                    Memory::Copy(fromPtr + (size_t)column.byteOffset * oldAllocRows, toPtr + (size_t)column.byteOffset * newAllocRows, column.byteSize * this->numRows);
+                }
+            }
+        }
+        else if (newPitch == this->rowPitch)
         {
             // same pitch, copy one big block
             Memory::Copy(fromPtr, toPtr, this->rowPitch * this->numRows);
@@ -431,6 +481,8 @@ AttributeTable::InternalAddColumnHelper(const AttrId& id, bool recordAsNewColumn
     ColumnInfo newColumnInfo;
     newColumnInfo.attrId = id;
     newColumnInfo.byteOffset = 0;
+    newColumnInfo.byteSize = this->GetValueTypeSize(id.GetValueType());
+    newColumnInfo.index = nullptr;
     this->columns.Append(newColumnInfo);
     if (this->trackModifications)
     {
@@ -466,9 +518,9 @@ AttributeTable::EndAddColumns()
     {
         // recompute column byte offset and pitch values and re-allocate data table
         SizeT newPitch = this->UpdateColumnOffsets();
-        if (this->numRows > 0)
+        if (0 != this->valueBuffer)
         {
-            this->Realloc(newPitch, this->numRows);
+            this->Realloc(newPitch, this->allocatedRows);
         }
         else
         {
@@ -506,9 +558,9 @@ AttributeTable::AddColumn(const AttrId& id, bool recordAsNewColumn)
     SizeT newPitch = this->UpdateColumnOffsets();
 
 	    // if necessary, re-allocate value buffer
-	    if (this->numRows > 0)
+	    if (0 != this->valueBuffer)
 	    {
-	        this->Realloc(newPitch, this->numRows);
+	        this->Realloc(newPitch, this->allocatedRows);
 	    }
 	    else
 	    {
@@ -541,6 +593,7 @@ AttributeTable::DeleteRow(IndexT rowIndex)
         this->isModified = true;
     }
     this->userData[rowIndex] = 0;
+    this->RemoveRowFromColumnIndices(rowIndex);
 	// FIXME this causes delete command on the database to fail as the primary key (usually a guid) used to match rows with is gone
 	// its a (minor) memleak that should get cleaned up after the table is removed
     // // free memory for unused celldata
@@ -784,25 +837,343 @@ AttributeTable::ClearDeletedRowsFlags()
 
 //------------------------------------------------------------------------------
 /**
-    Finds a row index by multiple attribute values. This method can be slow since
-    it may search linearly (and vertically) through the table. Also, for one
-    attribute this method is slower then InternalFindRowIndicesByAttr()!
+    Add a hash index to a column. The index maps the hash of a value to
+    all rows containing a value with that hash, and is updated whenever
+    a value in the column is set. This makes finding rows by value of the
+    column independent of the number of rows, at the cost of slower
+    setters. Best suited for columns with many different values, like
+    ids or names.
+*/
+void
+AttributeTable::AddColumnIndex(const AttrId& id)
+{
+    IndexT colIndex = this->GetColumnIndex(id);
+    n_assert2(nullptr == this->columns[colIndex].index, "AttributeTable::AddColumnIndex(): column already has an index!");
+    switch (id.GetValueType())
+    {
+        case IntType:
+        case UIntType:
+        case FloatType:
+        case BoolType:
+        case StringType:
+        case GuidType:
+            break;
+        default:
+            n_error("AttributeTable::AddColumnIndex(): column type of '%s' can't be indexed!", id.GetName().AsCharPtr());
+            return;
+    }
+
+    ColumnIndex* index = n_new(ColumnIndex);
+    this->columns[colIndex].index = index;
+    index->rowHashes.SetSize(this->numRows);
+    index->rowIndexed.SetSize(this->numRows);
+    index->rowIndexed.Fill(0, this->numRows, false);
+
+    IndexT rowIndex;
+    for (rowIndex = 0; rowIndex < this->numRows; rowIndex++)
+    {
+        if (!this->IsRowDeleted(rowIndex))
+        {
+            this->ReindexCell(colIndex, rowIndex);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AttributeTable::RemoveColumnIndex(const AttrId& id)
+{
+    IndexT colIndex = this->GetColumnIndex(id);
+    n_assert2(nullptr != this->columns[colIndex].index, "AttributeTable::RemoveColumnIndex(): column has no index!");
+    n_delete(this->columns[colIndex].index);
+    this->columns[colIndex].index = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Moves a row to the bucket of its current value. Rows are stored with
+    the hash they were inserted with, so they can be removed after the
+    value has already been overwritten.
+*/
+void
+AttributeTable::ReindexCell(IndexT colIndex, IndexT rowIndex)
+{
+    ColumnIndex* index = this->columns[colIndex].index;
+    n_assert(nullptr != index);
+    if (rowIndex >= index->rowHashes.Size())
+    {
+        const SizeT oldSize = index->rowHashes.Size();
+        index->rowHashes.SetSize(this->allocatedRows);
+        index->rowIndexed.SetSize(this->allocatedRows);
+        index->rowIndexed.Fill(oldSize, this->allocatedRows - oldSize, false);
+    }
+
+    const uint hash = this->HashCell(colIndex, rowIndex);
+    if (index->rowIndexed[rowIndex])
+    {
+        if (index->rowHashes[rowIndex] == hash)
+        {
+            return;
+        }
+        Util::Array<IndexT>& rows = index->rowsByHash[index->rowHashes[rowIndex]];
+        rows.EraseIndexSwap(rows.FindIndex(rowIndex));
+        if (rows.IsEmpty())
+        {
+            index->rowsByHash.Erase(index->rowHashes[rowIndex]);
+        }
+    }
+    index->rowsByHash.AddUnique(hash).Append(rowIndex);
+    index->rowHashes[rowIndex] = hash;
+    index->rowIndexed[rowIndex] = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Must be called before the row data is deleted.
+*/
+void
+AttributeTable::RemoveRowFromColumnIndices(IndexT rowIndex)
+{
+    IndexT colIndex;
+    for (colIndex = 0; colIndex < this->columns.Size(); colIndex++)
+    {
+        ColumnIndex* index = this->columns[colIndex].index;
+        if (nullptr != index && rowIndex < index->rowIndexed.Size() && index->rowIndexed[rowIndex])
+        {
+            const uint hash = index->rowHashes[rowIndex];
+            Util::Array<IndexT>& rows = index->rowsByHash[hash];
+            rows.EraseIndexSwap(rows.FindIndex(rowIndex));
+            if (rows.IsEmpty())
+            {
+                index->rowsByHash.Erase(hash);
+            }
+            index->rowIndexed[rowIndex] = false;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static uint
+HashIndexValue(uint value)
+{
+    value ^= value >> 16;
+    value *= 0x85ebca6b;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35;
+    value ^= value >> 16;
+    return value;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Floats are hashed by bit pattern, with -0.0 and 0.0 mapped to the same
+    hash since they compare equal.
+*/
+static uint
+HashIndexValue(float value)
+{
+    if (value == 0.0f)
+    {
+        value = 0.0f;
+    }
+    uint bits;
+    Memory::Copy(&value, &bits, sizeof(bits));
+    return HashIndexValue(bits);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Must produce the same hash as HashAttr() for equal values.
+*/
+uint
+AttributeTable::HashCell(IndexT colIndex, IndexT rowIndex) const
+{
+    switch (this->GetColumnValueType(colIndex))
+    {
+        case IntType:       return HashIndexValue((uint)this->GetInt(colIndex, rowIndex));
+        case UIntType:      return HashIndexValue(this->GetUInt(colIndex, rowIndex));
+        case FloatType:     return HashIndexValue(this->GetFloat(colIndex, rowIndex));
+        case BoolType:      return HashIndexValue((uint)this->GetBool(colIndex, rowIndex));
+        case StringType:    return (uint)this->GetString(colIndex, rowIndex).HashCode();
+        case GuidType:      return (uint)this->GetGuid(colIndex, rowIndex).HashCode();
+        default:
+            n_error("AttributeTable::HashCell(): invalid attribute type!");
+            return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint
+AttributeTable::HashAttr(const Attribute& attr)
+{
+    switch (attr.GetValueType())
+    {
+        case IntType:       return HashIndexValue((uint)attr.GetInt());
+        case UIntType:      return HashIndexValue(attr.GetUInt());
+        case FloatType:     return HashIndexValue(attr.GetFloat());
+        case BoolType:      return HashIndexValue((uint)attr.GetBool());
+        case StringType:    return (uint)attr.GetString().HashCode();
+        case GuidType:      return (uint)attr.GetGuid().HashCode();
+        default:
+            n_error("AttributeTable::HashAttr(): invalid attribute type!");
+            return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+AttributeTable::IsCellEqual(IndexT colIndex, IndexT rowIndex, const Attribute& attr) const
+{
+    switch (attr.GetValueType())
+    {
+        case IntType:       return attr.GetInt() == this->GetInt(colIndex, rowIndex);
+        case UIntType:      return attr.GetUInt() == this->GetUInt(colIndex, rowIndex);
+        case FloatType:     return attr.GetFloat() == this->GetFloat(colIndex, rowIndex);
+        case BoolType:      return attr.GetBool() == this->GetBool(colIndex, rowIndex);
+        case Float4Type:    return attr.GetFloat4() == this->GetFloat4(colIndex, rowIndex);
+        case StringType:    return attr.GetString() == this->GetString(colIndex, rowIndex);
+        case BlobType:      return attr.GetBlob() == this->GetBlob(colIndex, rowIndex);
+        case GuidType:      return attr.GetGuid() == this->GetGuid(colIndex, rowIndex);
+        default:            return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Rows are returned in ascending order, same as a table scan would.
+*/
+Util::Array<IndexT>
+AttributeTable::FindRowIndicesInColumnIndex(IndexT colIndex, const Attribute& attr, bool firstMatchOnly) const
+{
+    Util::Array<IndexT> result;
+    const ColumnIndex* index = this->columns[colIndex].index;
+    n_assert(nullptr != index);
+    const uint hash = HashAttr(attr);
+    IndexT bucket = index->rowsByHash.FindIndex(hash);
+    if (InvalidIndex != bucket)
+    {
+        // rows in the bucket may only share the hash, so compare the actual values
+        const Util::Array<IndexT>& rows = index->rowsByHash.ValueAtIndex(hash, bucket);
+        IndexT i;
+        for (i = 0; i < rows.Size(); i++)
+        {
+            if (this->IsCellEqual(colIndex, rows[i], attr))
+            {
+                result.Append(rows[i]);
+            }
+        }
+        result.Sort();
+        if (firstMatchOnly && result.Size() > 1)
+        {
+            IndexT first = result[0];
+            result.Clear();
+            result.Append(first);
+        }
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Scan a column of values which can be compared directly in memory. In
+    column-major tables the values are tightly packed and this is a linear
+    sweep, otherwise the scan strides over whole rows.
+*/
+template <typename TYPE>
+void
+AttributeTable::ScanColumn(IndexT colIndex, TYPE value, bool firstMatchOnly, Util::Array<IndexT>& result) const
+{
+    if (0 == this->numRows)
+    {
+        return;
+    }
+
+    const uchar* deleted = this->rowDeletedBuffer;
+    IndexT rowIndex;
+    if (ColumnMajor == this->storageMode)
+    {
+        const TYPE* values = (const TYPE*)this->GetValuePtr(colIndex, 0);
+        for (rowIndex = 0; rowIndex < this->numRows; rowIndex++)
+        {
+            if ((values[rowIndex] == value) && (0 == deleted[rowIndex]))
+            {
+                result.Append(rowIndex);
+                if (firstMatchOnly) return;
+            }
+        }
+    }
+    else
+    {
+        const char* ptr = (const char*)this->GetValuePtr(colIndex, 0);
+        for (rowIndex = 0; rowIndex < this->numRows; rowIndex++, ptr += this->rowPitch)
+        {
+            if ((*(const TYPE*)ptr == value) && (0 == deleted[rowIndex]))
+            {
+                result.Append(rowIndex);
+                if (firstMatchOnly) return;
+            }
+        }
+    }
+}
 
-    FIXME: keep row indices for indexed rows in nDictionaries?
+//------------------------------------------------------------------------------
+/**
+    Finds a row index by multiple attribute values. If one of the attribute
+    columns has a hash index, only the rows found through the index are
+    checked, otherwise this searches linearly through the table. For one
+    attribute this method is slower then InternalFindRowIndicesByAttr()!
 */
 Util::Array<IndexT>
 AttributeTable::InternalFindRowIndicesByAttrs(const Util::Array<Attribute>& attrs, bool firstMatchOnly) const
 {
     Util::Array<IndexT> result;
 
-    // create a table of column indices for each attribute
+    // create a table of column indices for each attribute, and find an indexed column
     Util::FixedArray<IndexT> attrColIndices(attrs.Size());
+    IndexT indexedAttr = InvalidIndex;
     IndexT attrIndex;
     SizeT numAttrs = attrs.Size();
     for (attrIndex = 0; attrIndex < numAttrs; attrIndex++)
     {
         attrColIndices[attrIndex] = this->GetColumnIndex(attrs[attrIndex].GetAttrId());
+        if ((InvalidIndex == indexedAttr) && (nullptr != this->columns[attrColIndices[attrIndex]].index))
+        {
+            indexedAttr = attrIndex;
+        }
+    }
+
+    // only check rows which match the indexed attribute
+    if (InvalidIndex != indexedAttr)
+    {
+        Util::Array<IndexT> candidates = this->FindRowIndicesInColumnIndex(attrColIndices[indexedAttr], attrs[indexedAttr], false);
+        IndexT i;
+        for (i = 0; i < candidates.Size(); i++)
+        {
+            bool isEqual = true;
+            for (attrIndex = 0; isEqual && (attrIndex < numAttrs); attrIndex++)
+            {
+                isEqual = (attrIndex == indexedAttr) || this->IsCellEqual(attrColIndices[attrIndex], candidates[i], attrs[attrIndex]);
+            }
+            if (isEqual)
+            {
+                result.Append(candidates[i]);
+                if (firstMatchOnly)
+                {
+                    return result;
+                }
+            }
+        }
+        return result;
     }
+
     // for each row...
     IndexT rowIndex;
     for (rowIndex = 0; rowIndex < this->GetNumRows(); rowIndex++)
@@ -811,73 +1182,9 @@ AttributeTable::InternalFindRowIndicesByAttrs(const Util::Array<Attribute>& attr
         {
             // for each attribute...
             bool isEqual = true;
-            IndexT attrIndex;
             for (attrIndex = 0; isEqual && (attrIndex < numAttrs); attrIndex++)
             {
-                IndexT colIndex = attrColIndices[attrIndex];
-                const Attribute& attr = attrs[attrIndex];
-                switch (attr.GetValueType())
-                {
-                    case IntType:
-                        if (attr.GetInt() != this->GetInt(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    case FloatType:
-                        if (attr.GetFloat() != this->GetFloat(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    case BoolType:
-                        if (attr.GetBool() != this->GetBool(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    case Float4Type:
-                        if (attr.GetFloat4() != this->GetFloat4(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    case StringType:
-                        if (attr.GetString() != this->GetString(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    case BlobType:
-                        if (attr.GetBlob() != this->GetBlob(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    case GuidType:
-                        if (attr.GetGuid() != this->GetGuid(colIndex, rowIndex))
-                        {
-                            isEqual = false;
-                            break;
-                        }
-                        break;
-
-                    default:
-                        isEqual = false;
-                        break;
-                }
+                isEqual = this->IsCellEqual(attrColIndices[attrIndex], rowIndex, attrs[attrIndex]);
             }
             if (isEqual)
             {
@@ -894,10 +1201,8 @@ AttributeTable::InternalFindRowIndicesByAttrs(const Util::Array<Attribute>& attr
 
 //------------------------------------------------------------------------------
 /**
-    Finds a row index by single attribute value. This method can be slow since
-    it may search linearly (and vertically) through the table. 
-
-    FIXME: keep row indices for indexed rows in nDictionaries?
+    Finds a row index by single attribute value. Uses the column's hash index
+    if it has one, otherwise this searches linearly through the table.
 */
 Util::Array<IndexT>
 AttributeTable::InternalFindRowIndicesByAttr(const Attribute& attr, bool firstMatchOnly) const
@@ -906,40 +1211,29 @@ AttributeTable::InternalFindRowIndicesByAttr(const Attribute& attr, bool firstMa
     IndexT colIndex = this->GetColumnIndex(attr.GetAttrId());
     ValueType colType = this->GetColumnValueType(colIndex);
     n_assert(colType == attr.GetValueType());
+    if (nullptr != this->columns[colIndex].index)
+    {
+        return this->FindRowIndicesInColumnIndex(colIndex, attr, firstMatchOnly);
+    }
+
     IndexT rowIndex;
     switch (colType)
     {
         case IntType:
-            for (rowIndex = 0; rowIndex < this->GetNumRows(); rowIndex++)
-            {
-                if ((!this->IsRowDeleted(rowIndex)) && (attr.GetInt() == this->GetInt(colIndex, rowIndex)))
-                {
-                    result.Append(rowIndex);
-                    if (firstMatchOnly) return result;
-                }
-            }
+            this->ScanColumn<int>(colIndex, attr.GetInt(), firstMatchOnly, result);
+            break;
+
+        case UIntType:
+            this->ScanColumn<uint>(colIndex, attr.GetUInt(), firstMatchOnly, result);
             break;
 
         case FloatType:
-            for (rowIndex = 0; rowIndex < this->GetNumRows(); rowIndex++)
-            {
-                if ((!this->IsRowDeleted(rowIndex)) && (attr.GetFloat() == this->GetFloat(colIndex, rowIndex)))
-                {
-                    result.Append(rowIndex);
-                    if (firstMatchOnly) return result;
-                }
-            }
+            this->ScanColumn<float>(colIndex, attr.GetFloat(), firstMatchOnly, result);
             break;
 
         case BoolType:
-            for (rowIndex = 0; rowIndex < this->GetNumRows(); rowIndex++)
-            {
-                if ((!this->IsRowDeleted(rowIndex)) && (attr.GetBool() == this->GetBool(colIndex, rowIndex)))
-                {
-                    result.Append(rowIndex);
-                    if (firstMatchOnly) return result;
-                }
-            }
+            // bools are stored as ints
+            this->ScanColumn<int>(colIndex, attr.GetBool() ? 1 : 0, firstMatchOnly, result);
             break;
 
         case Float4Type:
@@ -1371,6 +1665,7 @@ AttributeTable::SetVariant(IndexT colIndex, IndexT rowIndex, const Util::Variant
             n_error("AttributeTable::SetVariant(): invalid attribute type!");
             break;
     }
+    this->UpdateColumnIndex(colIndex, rowIndex);
     if (this->trackModifications)
     {
         this->rowModifiedBuffer[rowIndex] = 1;
@@ -28,11 +28,23 @@
 
     The AttributeTable object keeps track of all changes (added columns,
     added rows, modified rows, modified values).
+
+    Tables can optionally store their values column-major (see 
+    SetStorageMode()), where all values of a column are stored in one
+    tightly packed array. Scans over a single column (as done by 
+    FindRowIndicesByAttr()) are then a linear sweep over contiguous memory.
+
+    Columns which are frequently searched by value can be given a hash
+    index with AddColumnIndex(). The index is kept up to date by all
+    setter methods, and the FindRowIndex* methods use it instead of
+    scanning the table. Indices are supported for Int, UInt, Float,
+    Bool, String and Guid columns.
     
     (C) 2006 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "attribute.h"
+#include "util/flathashtable.h"
 
 //------------------------------------------------------------------------------
 namespace Attr
@@ -40,6 +52,13 @@ namespace Attr
 class AttributeTable
 {
 public:
+    /// value buffer layouts
+    enum StorageMode
+    {
+        RowMajor,       // values of a row are stored together (default)
+        ColumnMajor,    // values of a column are stored together
+    };
+
     /// constructor
     AttributeTable();
     /// construct with initializer list
@@ -59,6 +78,10 @@ public:
     void Clear();
     /// print the contents of the table for debugging reasons
     void PrintDebug();
+    /// set the value buffer layout, must be called before rows are added
+    void SetStorageMode(StorageMode mode);
+    /// get the value buffer layout
+    StorageMode GetStorageMode() const;
     
     /// optional: call before adding columns, speeds up adding many columns at once
     void BeginAddColumns(bool recordNewColumns=true);
@@ -86,6 +109,12 @@ public:
     const Util::Array<IndexT>& GetNewColumnIndices() const;
     /// return indices of all ReadWrite columns
     const Util::Array<IndexT>& GetReadWriteColumnIndices() const;
+    /// add a hash index to a column, used to find rows by value of this column
+    void AddColumnIndex(const AttrId& id);
+    /// remove the hash index of a column
+    void RemoveColumnIndex(const AttrId& id);
+    /// return true if a column has a hash index
+    bool HasColumnIndex(const AttrId& id) const;
 
     /// add a row to the table, returns index of new row
     IndexT AddRow();
@@ -242,6 +271,22 @@ private:
     void DeleteGuid(IndexT colIndex, IndexT rowIndex);
     /// copy a guid into the table
     void CopyGuid(IndexT colIndex, IndexT rowIndex, const Util::Guid& val);
+    /// get the column hash index of a cell up to date after its value changed
+    void UpdateColumnIndex(IndexT colIndex, IndexT rowIndex);
+    /// (re-)insert a cell into its column's hash index
+    void ReindexCell(IndexT colIndex, IndexT rowIndex);
+    /// remove a row from all column hash indices
+    void RemoveRowFromColumnIndices(IndexT rowIndex);
+    /// compute the hash of a cell value for column hash indices
+    uint HashCell(IndexT colIndex, IndexT rowIndex) const;
+    /// compute the hash of an attribute value for column hash indices
+    static uint HashAttr(const Attribute& attr);
+    /// return true if a cell equals an attribute value
+    bool IsCellEqual(IndexT colIndex, IndexT rowIndex, const Attribute& attr) const;
+    /// find rows by value using the hash index of a column
+    Util::Array<IndexT> FindRowIndicesInColumnIndex(IndexT colIndex, const Attribute& attr, bool firstMatchOnly) const;
+    /// scan a column of plain values for matching rows
+    template <typename TYPE> void ScanColumn(IndexT colIndex, TYPE value, bool firstMatchOnly, Util::Array<IndexT>& result) const;
 	/// internal row-indices-by-attr find method
     Util::Array<IndexT> InternalFindRowIndicesByAttr(const Attr::Attribute& attr, bool firstMatchOnly) const;
     /// internal row-indices-by-multiple-attrs find method
@@ -271,10 +316,18 @@ private:
     /// set entire column to blob value
     void SetColumnBlob(const BlobAttrId& attrId, const Util::Blob& blob);
 
+    struct ColumnIndex
+    {
+        Util::FlatHashTable<uint, Util::Array<IndexT>> rowsByHash;  // value hash to rows with that hash
+        Util::Array<uint> rowHashes;            // value hash per row, needed to remove the row after its value changed
+        Util::Array<bool> rowIndexed;           // true if a row is in the index
+    };
     struct ColumnInfo
     {
         AttrId attrId;          // attribute id of the column
-        IndexT byteOffset;      // byte offset into a row
+        IndexT byteOffset;      // byte offset into a row, for column-major storage the column starts at byteOffset * allocatedRows
+        SizeT byteSize;         // byte size of a value
+        ColumnIndex* index;     // optional hash index
     };
     Util::Array<ColumnInfo> columns;
     Util::Dictionary<AttrId,IndexT> indexMap;   // map attribute id to column index
@@ -283,6 +336,7 @@ private:
     Util::Array<IndexT> newRowIndices;          // indices of new rows since last ResetModifiedState
     Util::Array<IndexT> deletedRowIndices;      // indices of rows that are marked for deletion
     Util::Array<void*>  userData; 
+    StorageMode storageMode;                    // row-major or column-major value buffer
     SizeT rowPitch;                             // pitch of a row in bytes
     SizeT numRows;                              // number of rows
     SizeT allocatedRows;                        // number of allocated rows
@@ -499,6 +553,24 @@ AttributeTable::GetNumRows() const
     return this->numRows;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline AttributeTable::StorageMode
+AttributeTable::GetStorageMode() const
+{
+    return this->storageMode;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+AttributeTable::HasColumnIndex(const AttrId& id) const
+{
+    return nullptr != this->columns[this->GetColumnIndex(id)].index;
+}
+
 //------------------------------------------------------------------------------
 /**
     This returns a pointer to a value's memory location.
@@ -507,10 +579,31 @@ inline void*
 AttributeTable::GetValuePtr(IndexT colIndex, IndexT rowIndex) const
 {
     n_assert((colIndex < this->columns.Size()) && (rowIndex < this->numRows));
-    IndexT bufferOffset = (rowIndex * this->rowPitch) + this->columns[colIndex].byteOffset;
+    const ColumnInfo& column = this->columns[colIndex];
+    size_t bufferOffset;
+    if (ColumnMajor == this->storageMode)
+    {
+        bufferOffset = ((size_t)column.byteOffset * this->allocatedRows) + ((size_t)rowIndex * column.byteSize);
+    }
+    else
+    {
+        bufferOffset = ((size_t)rowIndex * this->rowPitch) + column.byteOffset;
+    }
     return (void*)((char*)this->valueBuffer + bufferOffset);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+AttributeTable::UpdateColumnIndex(IndexT colIndex, IndexT rowIndex)
+{
+    if (nullptr != this->columns[colIndex].index)
+    {
+        this->ReindexCell(colIndex, rowIndex);
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -523,6 +616,7 @@ AttributeTable::SetBool(IndexT colIndex, IndexT rowIndex, bool val)
     *valuePtr = val ? 1 : 0;
     this->rowModifiedBuffer[rowIndex] = 1;
     this->isModified = true;
+    this->UpdateColumnIndex(colIndex, rowIndex);
 }
 
 //------------------------------------------------------------------------------
@@ -548,6 +642,7 @@ AttributeTable::SetFloat(IndexT colIndex, IndexT rowIndex, float val)
     *valuePtr = val;
     this->rowModifiedBuffer[rowIndex] = 1;
     this->isModified = true;
+    this->UpdateColumnIndex(colIndex, rowIndex);
 }
 
 //------------------------------------------------------------------------------
@@ -573,6 +668,7 @@ AttributeTable::SetInt(IndexT colIndex, IndexT rowIndex, int val)
     *valuePtr = val;
     this->rowModifiedBuffer[rowIndex] = 1;
     this->isModified = true;
+    this->UpdateColumnIndex(colIndex, rowIndex);
 }
 
 //------------------------------------------------------------------------------
@@ -598,6 +694,7 @@ AttributeTable::SetUInt(IndexT colIndex, IndexT rowIndex, uint val)
     *valuePtr = val;
     this->rowModifiedBuffer[rowIndex] = 1;
     this->isModified = true;
+    this->UpdateColumnIndex(colIndex, rowIndex);
 }
 
 //------------------------------------------------------------------------------
@@ -682,6 +779,7 @@ AttributeTable::SetString(IndexT colIndex, IndexT rowIndex, const Util::String&
     n_assert(this->GetColumnValueType(colIndex) == StringType);
     n_assert(!this->IsRowDeleted(rowIndex));
     this->CopyString(colIndex, rowIndex, val);
+    this->UpdateColumnIndex(colIndex, rowIndex);
     if (this->trackModifications)
     {
         this->rowModifiedBuffer[rowIndex] = 1;
@@ -710,6 +808,7 @@ AttributeTable::SetGuid(IndexT colIndex, IndexT rowIndex, const Util::Guid& val)
     n_assert(this->GetColumnValueType(colIndex) == GuidType);
     n_assert(!this->IsRowDeleted(rowIndex));
     this->CopyGuid(colIndex, rowIndex, val);
+    this->UpdateColumnIndex(colIndex, rowIndex);
     if (this->trackModifications)
     {
         this->rowModifiedBuffer[rowIndex] = 1;
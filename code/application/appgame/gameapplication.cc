@@ -7,7 +7,10 @@
 #include "appgame/gameapplication.h"
 #include "core/debug/corepagehandler.h"
 #include "threading/debug/threadpagehandler.h"
+#include "jobs/debug/jobpagehandler.h"
 #include "memory/debug/memorypagehandler.h"
+#include "memory/memorytracker.h"
+#include "memory/frameallocator.h"
 #include "io/debug/iopagehandler.h"
 #include "io/logfileconsolehandler.h"
 #include "io/debug/consolepagehandler.h"
@@ -127,6 +130,7 @@ GameApplication::Open()
 		this->httpServerProxy->Open();
 		this->httpServerProxy->AttachRequestHandler(Debug::CorePageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::ThreadPageHandler::Create());
+		this->httpServerProxy->AttachRequestHandler(Debug::JobPageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::MemoryPageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::ConsolePageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::IoPageHandler::Create());
@@ -248,10 +252,23 @@ GameApplication::StepFrame()
 
 	// trigger end of frame for feature units
 	this->gameServer->OnEndFrame();
+
+#if NEBULA_MEMORY_TRACKING
+	Memory::TrackerEndFrame();
+#endif
+	Memory::FrameAllocatorNewFrame();
     
     GameApplication::FrameIndex++;
 
     _stop_timer(GameApplicationFrameTimeAll);
+
+#if __NEBULA_HTTP__
+	// sample the frame for telemetry clients
+	if (Debug::TelemetryCollector::HasInstance())
+	{
+		Debug::TelemetryCollector::Instance()->OnFrame();
+	}
+#endif
 }
 
 //------------------------------------------------------------------------------
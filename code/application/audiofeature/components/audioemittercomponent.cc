@@ -16,6 +16,9 @@ namespace AudioFeature
 
 static AudioEmitterComponentAllocator* component;
 
+/// the UpdateTransform listener may be called on a job thread, which can't reach the device singleton
+static Audio::AudioDevice* device;
+
 __ImplementComponent(AudioFeature::AudioEmitterComponent, component)
 
 using namespace Audio;
@@ -38,6 +41,10 @@ AudioEmitterComponent::Create()
 	__SetupDefaultComponentBundle(component);
 	component->functions.OnActivate = OnActivate;
 	component->functions.OnDeactivate = OnDeactivate;
+	device = AudioDevice::Instance();
+
+	// no frame callbacks, garbage collection only touches the emitter ids
+	component->DeclareFrameAccess({}, {});
 	__RegisterComponent(component, "AudioEmitterComponent"_atm);
 
 	SetupAcceptedMessages();
@@ -58,7 +65,8 @@ AudioEmitterComponent::Discard()
 void
 AudioEmitterComponent::SetupAcceptedMessages()
 {
-	__RegisterMsg(Msg::UpdateTransform, UpdateTransform);
+	// only writes the positions of our own emitters, so it can run in parallel with other listeners
+	__RegisterThreadSafeBatchMsg(Msg::UpdateTransform, UpdateTransforms);
 	__RegisterMsg(Msg::SetAudioResource, SetAudioResource);
 }
 
@@ -93,13 +101,17 @@ AudioEmitterComponent::OnDeactivate(Game::InstanceId instance)
 /**
 */
 void
-AudioEmitterComponent::UpdateTransform(Game::Entity entity, const Math::matrix44 & transform)
+AudioEmitterComponent::UpdateTransforms(SizeT num, const Game::Entity* entities, const Math::matrix44* transforms)
 {
-	auto instance = component->GetInstance(entity);
-	if (instance != InvalidIndex)
+	IndexT i;
+	for (i = 0; i < num; i++)
 	{
-		AudioEmitterId emitter = { component->Get<Attr::AudioEmitter>(instance) };
-		AudioDevice::Instance()->SetPosition(emitter, transform.get_position());
+		auto instance = component->GetInstance(entities[i]);
+		if (instance != InvalidIndex)
+		{
+			AudioEmitterId emitter = { component->Get<Attr::AudioEmitter>(instance) };
+			device->SetPosition(emitter, transforms[i].get_position());
+		}
 	}
 }
 
@@ -27,8 +27,8 @@ public:
 	static void OnActivate(Game::InstanceId instance);
 	static void OnDeactivate(Game::InstanceId instance);
 
-	/// transform updated callback
-	static void UpdateTransform(Game::Entity entity, const Math::matrix44 & transform);
+	/// transform updated callback, called once per batch of updated transforms
+	static void UpdateTransforms(SizeT num, const Game::Entity* entities, const Math::matrix44* transforms);
 	/// set the current audio resource of an entity
 	static void SetAudioResource(Game::Entity entity, Util::String const& resource);
 	/// set the current audio resource of an instance
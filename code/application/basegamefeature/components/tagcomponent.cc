@@ -29,6 +29,9 @@ TagComponent::Create()
 	}
 
 	__SetupDefaultComponentBundle(data);
+
+	// no frame callbacks, garbage collection only touches the tags
+	data->DeclareFrameAccess({}, {});
 	Game::ComponentManager::Instance()->RegisterComponent(data, "TagComponent"_atm, 'tagc');
 }
 
@@ -3,16 +3,39 @@
 /**
 	TagComponent
 
+	The tags are kept in an archetype storage, see Game::ArchetypeComponent,
+	so the allocator is declared here instead of being generated from
+	tagdata.nidl.
+
 	(C) 2018-2020 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
-#include "game/component/component.h"
+#include "game/component/archetypecomponent.h"
 #include "game/component/attribute.h"
 #include "basegamefeature/components/tagdata.h"
 
 namespace Game
 {
 
+class TagComponentAllocator : public Game::ArchetypeComponent<Attr::Tag>
+{
+public:
+	/// constructor
+	TagComponentAllocator() : ArchetypeComponent({ true }) {}
+
+	/// Returns the components fourcc
+	static Util::FourCC GetIdentifier()
+	{
+		return 'TAGC';
+	}
+
+	/// Attribute access methods
+	Util::Guid& Tag(Game::InstanceId instance)
+	{
+		return this->Get<Attr::Tag>(instance);
+	}
+};
+
 class TagComponent
 {
 	__DeclareComponent(TagComponent)
@@ -6,13 +6,102 @@
 #include "game/component/component.h"
 #include "transformcomponent.h"
 #include "basegamefeature/managers/componentmanager.h"
+#include "jobs/jobs.h"
+#include "system/cpu.h"
+#include "system/systeminfo.h"
+#include "debug/debugtimer.h"
 
 namespace Game
 {
 
 static TransformComponentAllocator* data;
 
-static Msg::UpdateTransform::MessageQueueId messageQueue;
+/// per instance dirty flag, indexed by instance id
+static Util::Array<bool> dirtyFlags;
+/// all instances, sorted by hierarchy depth
+static Util::Array<InstanceId> hierarchyLevels;
+/// start of each depth level in hierarchyLevels, with the total count appended last
+static Util::Array<IndexT> levelOffsets;
+/// set whenever parent, child or sibling relationships have changed
+static bool hierarchyDirty = true;
+/// set whenever any instance has been flagged dirty since the last update
+static bool anyDirty = false;
+
+static Jobs::JobPortId jobPort;
+static Jobs::JobSyncId jobSync;
+
+/// levels with fewer instances than this are updated on the calling thread
+static const SizeT ParallelLevelThreshold = 2048;
+/// number of instances per job slice
+static const SizeT InstancesPerSlice = 256;
+
+_declare_static_timer(TransformComponentUpdateWorldTransforms);
+
+//------------------------------------------------------------------------------
+/**
+	Pointers to the component arrays used by the world transform update.
+*/
+struct TransformUpdateUniforms
+{
+	const Math::matrix44* local;
+	Math::matrix44* world;
+	const InstanceId* parent;
+	bool* dirty;
+};
+
+//------------------------------------------------------------------------------
+/**
+	Update the world transform of a range of instances within the same depth level.
+	Instances are only recalculated if they, or their parent, have been flagged dirty.
+	Since all parents live in the previous level, which is already done, the sweep
+	never writes to anything another slice reads.
+*/
+static inline void
+UpdateLevelRange(const TransformUpdateUniforms& u, const InstanceId* instances, SizeT num)
+{
+	for (IndexT i = 0; i < num; i++)
+	{
+		const InstanceId instance = instances[i];
+		const InstanceId parent = u.parent[instance];
+		if (parent == InvalidIndex)
+		{
+			if (u.dirty[instance])
+				u.world[instance] = u.local[instance];
+		}
+		else if (u.dirty[instance] || u.dirty[parent])
+		{
+			u.world[instance] = Math::matrix44::multiply(u.local[instance], u.world[parent]);
+			u.dirty[instance] = true;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+TransformLevelJob(const Jobs::JobFuncContext& ctx)
+{
+	const TransformUpdateUniforms* uniforms = (const TransformUpdateUniforms*)ctx.uniforms[0];
+	const InstanceId* instances = (const InstanceId*)ctx.inputs[0];
+	UpdateLevelRange(*uniforms, instances, ctx.inputSizes[0] / sizeof(InstanceId));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline void
+MarkDirty(InstanceId instance)
+{
+	if (dirtyFlags.Size() <= (SizeT)instance)
+	{
+		SizeT first = dirtyFlags.Size();
+		dirtyFlags.SetSize(instance + 1);
+		dirtyFlags.Fill(first, dirtyFlags.Size() - first, true);
+	}
+	dirtyFlags[instance] = true;
+	anyDirty = true;
+}
 
 //------------------------------------------------------------------------------
 /**
@@ -33,14 +122,52 @@ TransformComponent::Create()
 	else
 	{
         data = n_new(TransformComponentAllocator);
+
+		// one worker per core, except for the core of the game thread. This is a port
+		// of its own since OnEndFrame may already run as a job on the ComponentJobPort
+		SizeT numCores = Core::SysFunc::GetSystemInfo()->GetNumCpuCores();
+		SizeT numThreads = Math::n_max(Math::n_min(numCores - 1, 31), 1);
+		uint affinity = 0;
+		IndexT i;
+		for (i = 0; i < numThreads; i++)
+			affinity |= (uint)System::Cpu::Core1 << i;
+
+		Jobs::CreateJobPortInfo info =
+		{
+			"TransformJobPort",
+			numThreads,
+			affinity,
+			UINT_MAX
+		};
+		jobPort = Jobs::CreateJobPort(info);
+
+		Jobs::CreateJobSyncInfo sinfo =
+		{
+			nullptr
+		};
+		jobSync = Jobs::CreateJobSync(sinfo);
+
+		_setup_grouped_timer(TransformComponentUpdateWorldTransforms, "Components");
 	}
 
+	dirtyFlags.Clear();
+	hierarchyLevels.Clear();
+	levelOffsets.Clear();
+	hierarchyDirty = true;
+	anyDirty = false;
+
 	data->EnableEvent(Game::ComponentEvent::OnDeactivate);
 	
 	__SetupDefaultComponentBundle(data);
 	data->functions.OnDeactivate = OnDeactivate;
+	data->functions.OnEndFrame = OnEndFrame;
 	data->functions.OnInstanceMoved = OnInstanceMoved;
 	data->functions.SetParents = SetParents;
+
+	// OnEndFrame propagates local into world transforms, the UpdateTransform listeners run after the frame
+	data->DeclareFrameAccess(
+		{ Attr::LocalTransform::FourCC(), Attr::Parent::FourCC() },
+		{ Attr::WorldTransform::FourCC() });
 	Game::ComponentManager::Instance()->RegisterComponent(data, "TransformComponent"_atm, GetFourCC());
 
 	SetupAcceptedMessages();
@@ -55,6 +182,15 @@ TransformComponent::Discard()
 	data->DestroyAll();
 	// __DeregisterComponent(data);
 	delete data;
+	data = nullptr;
+
+	Jobs::DestroyJobPort(jobPort);
+	Jobs::DestroyJobSync(jobSync);
+	_discard_timer(TransformComponentUpdateWorldTransforms);
+
+	dirtyFlags.Clear();
+	hierarchyLevels.Clear();
+	levelOffsets.Clear();
 }
 
 //------------------------------------------------------------------------------
@@ -67,75 +203,19 @@ TransformComponent::SetupAcceptedMessages()
 	__RegisterMsg(Msg::SetLocalTransform, SetLocalTransform);
 	__RegisterMsg(Msg::SetWorldTransform, SetWorldTransform);
 	__RegisterMsg(Msg::SetParent, SetParent);
-	messageQueue = Msg::UpdateTransform::AllocateMessageQueue();
-	
 }
 
 //------------------------------------------------------------------------------
 /**
+	Only stores the local transform and flags the instance as dirty.
+	The world transforms of this instance and all its children are
+	updated in UpdateWorldTransforms.
 */
 void
 TransformComponent::SetLocalTransform(InstanceId i, const Math::matrix44& val)
 {
 	data->Get<Attr::LocalTransform>(i) = val;
-	
-	InstanceId parent = data->Get<Attr::Parent>(i);
-	InstanceId child = data->Get<Attr::FirstChild>(i);
-	if (parent == InvalidIndex)
-	{
-		if (child == InvalidIndex)
-		{
-			// Early out if we don't have any children
-			Msg::UpdateTransform::Send(data->GetOwner(i), val);
-
-			// This means world transform will remain untouched
-			// for entities without parents and children
-			return;
-		}
-
-		data->Get<Attr::WorldTransform>(i) = val;
-
-		Msg::UpdateTransform::Defer(messageQueue, data->GetOwner(i), val);
-	}
-	else
-	{
-		// First of, transform this with parent transform if any
-		data->Get<Attr::WorldTransform>(i) = Math::matrix44::multiply(val, data->Get<Attr::WorldTransform>(parent));
-
-		if (child == InvalidIndex)
-		{
-			// Early out if we don't have any children
-			Msg::UpdateTransform::Send(data->GetOwner(i), val);
-			return;
-		}
-
-		Msg::UpdateTransform::Defer(messageQueue, data->GetOwner(i), data->Get<Attr::WorldTransform>(i));
-	}
-	
-	parent = i;
-	// Transform every child and their siblings.
-	while (parent != InvalidIndex)
-	{
-		while (child != InvalidIndex)
-		{
-			data->Get<Attr::WorldTransform>(child) = Math::matrix44::multiply(data->Get<Attr::LocalTransform>(child), data->Get<Attr::WorldTransform>(parent));
-			Msg::UpdateTransform::Defer(messageQueue, data->GetOwner(child), data->Get<Attr::WorldTransform>(child));
-			parent = child;
-			child = data->Get<Attr::FirstChild>(child);
-		}
-		child = data->Get<Attr::NextSibling>(parent);
-		parent = data->Get<Attr::Parent>(parent);
-	}
-	// Dispatch all world transform update messages sequentially at the end of the method.
-	// Keeps it cache friendly(er)
-	/**
-		@todo	Is this really faster? this requires us to copy all
-				the transforms temporarily. Might be faster to just
-				ignore the cache misses we'll likely hit when updating
-				the hierarchy.
-				(try replacing all the defer calls to regular sends).
-	*/
-	Msg::UpdateTransform::DispatchMessageQueue(messageQueue);
+	MarkDirty(i);
 }
 
 //------------------------------------------------------------------------------
@@ -166,6 +246,10 @@ TransformComponent::SetWorldTransform(InstanceId instance, const Math::matrix44&
 	InstanceId parentInstance = data->Get<Attr::Parent>(instance);
 	if (parentInstance != InvalidIndex)
 	{
+		// make sure the parent's world transform is up to date before inverting it
+		if (anyDirty)
+			UpdateWorldTransforms();
+
 		Math::matrix44& parentWorld = data->Get<Attr::WorldTransform>(parentInstance);
 		Math::matrix44 parentInverse = Math::matrix44::inverse(parentWorld);
 		Math::matrix44 local = Math::matrix44::multiply(val, parentInverse);
@@ -278,6 +362,9 @@ InternalSetParent(InstanceId instance, InstanceId parentInstance)
 
 	// Update all new nearest neighbor relationships
 	data->Get<Attr::Parent>(instance) = parentInstance;
+	data->Get<Attr::NextSibling>(instance) = InvalidIndex;
+	data->Get<Attr::PreviousSibling>(instance) = InvalidIndex;
+	hierarchyDirty = true;
 
 	if (parentInstance != InvalidIndex)
 	{
@@ -422,6 +509,8 @@ TransformComponent::GetFourCC()
 void
 TransformComponent::OnDeactivate(InstanceId instance)
 {
+	hierarchyDirty = true;
+
 	// update sibling relationships
 	InstanceId previousSibling = data->Get<Attr::PreviousSibling>(instance);
 	InstanceId nextSibling = data->Get<Attr::NextSibling>(instance);
@@ -479,6 +568,11 @@ TransformComponent::OnInstanceMoved(InstanceId instance, InstanceId oldIndex)
 	InstanceId nextSibling = data->Get<Attr::NextSibling>(instance);
 	InstanceId previousSibling = data->Get<Attr::PreviousSibling>(instance);
 	InstanceId child = data->Get<Attr::FirstChild>(instance);
+
+	// carry the dirty flag over to the new index
+	if (oldIndex < (InstanceId)dirtyFlags.Size() && dirtyFlags[oldIndex])
+		MarkDirty(instance);
+	hierarchyDirty = true;
 	
 	if (parent != InvalidIndex && data->Get<Attr::FirstChild>(parent) == oldIndex)
 	{
@@ -508,8 +602,150 @@ TransformComponent::OnInstanceMoved(InstanceId instance, InstanceId oldIndex)
 void
 TransformComponent::UpdateHierarchy(InstanceId instance)
 {
-	// TODO: There are more elegant ways for this.	
-	SetLocalTransform(instance, data->Get<Attr::LocalTransform>(instance));
+	// children are picked up by the level sweep since their parent is dirty
+	MarkDirty(instance);
+}
+
+//------------------------------------------------------------------------------
+/**
+	Sorts all instances by their depth in the hierarchy. Level 0 contains all
+	roots, level 1 all their children and so on. Within a level, instances are
+	sorted by index to keep the sweep access pattern as linear as possible.
+*/
+void
+TransformComponent::RebuildHierarchyLevels()
+{
+	const SizeT num = data->NumRegistered();
+	const InstanceId* parents = data->data.GetArray<TransformComponentAllocator::GetAttributeIndex<Attr::Parent>()>().Begin();
+	const InstanceId* firstChildren = data->data.GetArray<TransformComponentAllocator::GetAttributeIndex<Attr::FirstChild>()>().Begin();
+	const InstanceId* nextSiblings = data->data.GetArray<TransformComponentAllocator::GetAttributeIndex<Attr::NextSibling>()>().Begin();
+
+	hierarchyLevels.Clear();
+	hierarchyLevels.Reserve(num);
+	levelOffsets.Clear();
+
+	// all roots go into the first level
+	IndexT i;
+	for (i = 0; i < num; i++)
+	{
+		if (parents[i] == InvalidIndex)
+			hierarchyLevels.Append(i);
+	}
+
+	// breadth first, each level is the children of the previous one
+	IndexT levelStart = 0;
+	while (levelStart < hierarchyLevels.Size())
+	{
+		IndexT levelEnd = hierarchyLevels.Size();
+		levelOffsets.Append(levelStart);
+		for (i = levelStart; i < levelEnd; i++)
+		{
+			const InstanceId parent = hierarchyLevels[i];
+			InstanceId child = firstChildren[parent];
+			while (child != InvalidIndex)
+			{
+				// instances which have been deactivated may still hold stale links
+				if (parents[child] == parent)
+					hierarchyLevels.Append(child);
+				child = nextSiblings[child];
+			}
+		}
+		std::sort(hierarchyLevels.Begin() + levelEnd, hierarchyLevels.End());
+		levelStart = levelEnd;
+	}
+	levelOffsets.Append(hierarchyLevels.Size());
+
+	hierarchyDirty = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Propagates all dirty local transforms down the hierarchy, one depth level
+	at a time. Levels which are large enough are split into job slices and
+	updated in parallel, since all instances within a level only depend on the
+	previous level. All updated instances are then sent as UpdateTransform
+	messages in a single batch.
+*/
+void
+TransformComponent::UpdateWorldTransforms()
+{
+	if (!anyDirty && !hierarchyDirty && hierarchyLevels.Size() == data->NumRegistered())
+		return;
+
+	_start_timer(TransformComponentUpdateWorldTransforms);
+
+	const SizeT num = data->NumRegistered();
+	if (dirtyFlags.Size() < num)
+		MarkDirty(num - 1);
+
+	// instances might have been allocated or reused without touching the hierarchy
+	if (hierarchyDirty || hierarchyLevels.Size() != num)
+		RebuildHierarchyLevels();
+
+	TransformUpdateUniforms uniforms;
+	uniforms.local = data->data.GetArray<TransformComponentAllocator::GetAttributeIndex<Attr::LocalTransform>()>().Begin();
+	uniforms.world = data->data.GetArray<TransformComponentAllocator::GetAttributeIndex<Attr::WorldTransform>()>().Begin();
+	uniforms.parent = data->data.GetArray<TransformComponentAllocator::GetAttributeIndex<Attr::Parent>()>().Begin();
+	uniforms.dirty = dirtyFlags.Begin();
+
+	IndexT level;
+	for (level = 0; level < levelOffsets.Size() - 1; level++)
+	{
+		const InstanceId* instances = hierarchyLevels.Begin() + levelOffsets[level];
+		const SizeT levelSize = levelOffsets[level + 1] - levelOffsets[level];
+
+		if (levelSize < ParallelLevelThreshold)
+		{
+			UpdateLevelRange(uniforms, instances, levelSize);
+			continue;
+		}
+
+		Jobs::JobContext ctx;
+		ctx.uniform.numBuffers = 1;
+		ctx.uniform.data[0] = &uniforms;
+		ctx.uniform.dataSize[0] = sizeof(TransformUpdateUniforms);
+		ctx.uniform.scratchSize = 0;
+
+		ctx.input.numBuffers = 1;
+		ctx.input.data[0] = (void*)instances;
+		ctx.input.dataSize[0] = sizeof(InstanceId) * levelSize;
+		ctx.input.sliceSize[0] = sizeof(InstanceId) * InstancesPerSlice;
+
+		// not really an output, the world transforms are written through the uniforms
+		ctx.output.numBuffers = 1;
+		ctx.output.data[0] = (void*)instances;
+		ctx.output.dataSize[0] = sizeof(InstanceId) * levelSize;
+		ctx.output.sliceSize[0] = sizeof(InstanceId) * InstancesPerSlice;
+
+		Jobs::JobId job = Jobs::CreateJob({ TransformLevelJob, "TransformLevelJob" });
+		Jobs::JobSchedule(job, jobPort, ctx);
+
+		// the next level depends on this one, so wait for it to finish
+		Jobs::JobSyncSignal(jobSync, jobPort);
+		Jobs::JobSyncHostWait(jobSync);
+		Jobs::DestroyJob(job);
+	}
+
+	// the updates are dispatched as a single batch at the end of the frame
+	const bool* dirty = dirtyFlags.Begin();
+	for (IndexT i = 0; i < num; i++)
+	{
+		if (dirty[i])
+			Msg::UpdateTransform::Batch(data->GetOwner(i), uniforms.world[i]);
+	}
+	dirtyFlags.Fill(0, dirtyFlags.Size(), false);
+	anyDirty = false;
+
+	_stop_timer(TransformComponentUpdateWorldTransforms);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TransformComponent::OnEndFrame()
+{
+	UpdateWorldTransforms();
 }
 
 //------------------------------------------------------------------------------
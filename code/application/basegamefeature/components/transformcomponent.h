@@ -16,6 +16,15 @@
 	reflected outward since if you ask for the world transform it will return
 	the correct one that is used internally no matter what.
 
+	World transforms are not propagated when the local transform is set. Instead
+	the instance is flagged dirty, and once per frame (OnEndFrame) all dirty
+	instances and their descendants are updated in a single pass. Instances
+	are bucketed by hierarchy depth so that each depth level can be swept
+	independently, and large levels are split into jobs. UpdateTransform
+	messages are dispatched in one batch after the pass.
+	Call UpdateWorldTransforms() if you need world transforms of children
+	to be valid before the end of the frame.
+
 	(C) 2018-2020 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
@@ -33,7 +42,7 @@ public:
 	/// Setup callbacks.
 	static void SetupAcceptedMessages();
 
-	/// Set the local transform of instance. Will update hierarchy.
+	/// Set the local transform of instance. Hierarchy is updated in UpdateWorldTransforms.
 	static void SetLocalTransform(InstanceId instance, const Math::matrix44& val);
 	static void SetLocalTransform(Game::Entity entity, const Math::matrix44& val);
 	
@@ -76,14 +85,23 @@ public:
 	/// Return this components fourcc
 	static Util::FourCC GetFourCC();
 
+	/// Propagate all dirty local transforms through the hierarchy and dispatch UpdateTransform messages.
+	static void UpdateWorldTransforms();
+
 private:
+	/// Called at the end of each frame. Runs UpdateWorldTransforms.
+	static void OnEndFrame();
+
+	/// Bucket all instances by hierarchy depth.
+	static void RebuildHierarchyLevels();
+
 	/// Updates relationships
 	static void OnDeactivate(InstanceId instance);
 
 	/// Special case if an instance has changed index because of garbage collection
 	static void OnInstanceMoved(InstanceId instance, InstanceId oldIndex);
 
-	/// Update the transform hierarchy of this instance and all its children
+	/// Flag the instance dirty, its children will be updated in the next UpdateWorldTransforms
 	static void UpdateHierarchy(InstanceId instance);
 };
 
@@ -17,6 +17,17 @@ using namespace Http;
 using namespace Util;
 using namespace Game;
 
+/// a row of the component table, copied on the game thread
+struct ComponentInfo
+{
+	Util::FourCC identifier;
+	Util::String name;
+	SizeT numRegistered;
+	SizeT numAttributes;
+	bool frameAccess;
+	ComponentManager::ComponentTimings timings;
+};
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -25,6 +36,7 @@ GamePageHandler::GamePageHandler()
     this->SetName("Game System");
     this->SetDesc("display game system information");
     this->SetRootLocation("game");
+	this->SetThreadSafe(true);
 }
 
 //------------------------------------------------------------------------------
@@ -43,10 +55,44 @@ GamePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
 		return;
 	}
 
-	Ptr<EntityManager> entityManager = Game::EntityManager::Instance();
-	Ptr<ComponentManager> componentManager = Game::ComponentManager::Instance();
-	
+	// copy what the page shows on the game thread
+	bool available = false;
+	SizeT numEntities = 0;
+	Array<ComponentInfo> components;
+	bool copied = this->RunOnOwnerThread([&]()
+	{
+		if (!Game::EntityManager::HasInstance() || !Game::ComponentManager::HasInstance())
+		{
+			return;
+		}
+		Ptr<EntityManager> entityManager = Game::EntityManager::Instance();
+		Ptr<ComponentManager> componentManager = Game::ComponentManager::Instance();
+		available = true;
+		numEntities = entityManager->GetNumEntities();
+		SizeT numComponents = componentManager->GetNumComponents();
+		components.Reserve(numComponents);
+		IndexT componentIndex;
+		for (componentIndex = 0; componentIndex < numComponents; componentIndex++)
+		{
+			ComponentInterface* component = componentManager->GetComponentAtIndex(componentIndex);
+			ComponentInfo info;
+			info.identifier = component->GetIdentifier();
+			info.name = component->GetName().AsString();
+			info.numRegistered = component->NumRegistered();
+			info.numAttributes = component->GetAttributes().Size();
+			info.frameAccess = component->HasDeclaredFrameAccess();
+			info.timings = componentManager->GetComponentTimings(componentIndex);
+			components.Append(info);
+		}
+	});
+	if (!copied)
+	{
+		request->SetStatus(HttpStatus::ServiceUnavailable);
+		return;
+	}
+
     // configure a HTML page writer
+    request->SetStatus(HttpStatus::OK);
     Ptr<HtmlPageWriter> htmlWriter = HtmlPageWriter::Create();
     htmlWriter->SetStream(request->GetResponseContentStream());
     htmlWriter->SetTitle("Nebula Game Info");
@@ -56,7 +102,7 @@ GamePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
         htmlWriter->AddAttr("href", "/index.html");
         htmlWriter->Element(HtmlElement::Anchor, "Home");
 
-		if (!entityManager.isvalid() || !componentManager.isvalid())
+		if (!available)
 		{
 			htmlWriter->LineBreak();
 			htmlWriter->LineBreak();
@@ -68,7 +114,7 @@ GamePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
 			htmlWriter->Begin(HtmlElement::Table);
 			htmlWriter->Begin(HtmlElement::TableRow);
 			htmlWriter->Element(HtmlElement::TableData, "Entity Count:");
-			htmlWriter->Element(HtmlElement::TableData, String::FromUInt(entityManager->GetNumEntities()));
+			htmlWriter->Element(HtmlElement::TableData, String::FromUInt(numEntities));
 			htmlWriter->End(HtmlElement::TableRow);
 			htmlWriter->End(HtmlElement::Table);
 
@@ -81,25 +127,31 @@ GamePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
 			htmlWriter->Element(HtmlElement::TableHeader, "Component");
 			htmlWriter->Element(HtmlElement::TableHeader, "Registered entities");
 			htmlWriter->Element(HtmlElement::TableHeader, "Attribute count");
+			htmlWriter->Element(HtmlElement::TableHeader, "Parallel");
+			htmlWriter->Element(HtmlElement::TableHeader, "Optimize (ms)");
+			htmlWriter->Element(HtmlElement::TableHeader, "OnBeginFrame (ms)");
+			htmlWriter->Element(HtmlElement::TableHeader, "OnEndFrame (ms)");
 			htmlWriter->End(HtmlElement::TableRow);
-			SizeT numComponents = componentManager->GetNumComponents();
 			IndexT componentIndex;
-			for (componentIndex = 0; componentIndex < numComponents; componentIndex++)
+			for (componentIndex = 0; componentIndex < components.Size(); componentIndex++)
 			{
-				ComponentInterface* component = componentManager->GetComponentAtIndex(componentIndex);
+				const ComponentInfo& info = components[componentIndex];
 				htmlWriter->Begin(HtmlElement::TableRow);
 				htmlWriter->Begin(HtmlElement::TableData);
-				htmlWriter->AddAttr("href", "/game?component=" + component->GetIdentifier().AsString());
-				htmlWriter->Element(HtmlElement::Anchor, component->GetName().AsString());
+				htmlWriter->AddAttr("href", "/game?component=" + info.identifier.AsString());
+				htmlWriter->Element(HtmlElement::Anchor, info.name);
 				htmlWriter->End(HtmlElement::TableData);
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(component->NumRegistered()));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(component->GetAttributes().Size()));
+				htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.numRegistered));
+				htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.numAttributes));
+				htmlWriter->Element(HtmlElement::TableData, info.frameAccess ? "yes" : "no");
+				htmlWriter->Element(HtmlElement::TableData, String::FromDouble(info.timings.optimize * 1000.0));
+				htmlWriter->Element(HtmlElement::TableData, String::FromDouble(info.timings.onBeginFrame * 1000.0));
+				htmlWriter->Element(HtmlElement::TableData, String::FromDouble(info.timings.onEndFrame * 1000.0));
 				htmlWriter->End(HtmlElement::TableRow);
 			}
 			htmlWriter->End(HtmlElement::Table);
 		}
         htmlWriter->Close();
-        request->SetStatus(HttpStatus::OK);
     }
     else
     {
@@ -107,12 +159,136 @@ GamePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
     }
 }
 
-void GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Http::HttpRequest>& request)
+//------------------------------------------------------------------------------
+/**
+    Writes an attribute value into a table cell.
+*/
+static void
+WriteAttributeValue(const Ptr<HtmlPageWriter>& htmlWriter, Attr::ValueType type, const Util::Variant& value)
 {
-	Ptr<EntityManager> entityManager = Game::EntityManager::Instance();
-	Ptr<ComponentManager> componentManager = Game::ComponentManager::Instance();
+	String str = "";
+	switch (type)
+	{
+	case Attr::ValueType::Matrix44Type:
+	{
+		Math::matrix44 mat4 = value.GetMatrix44();
+		htmlWriter->Text(String::FromFloat4(mat4.getrow0()));
+		htmlWriter->LineBreak();
+		htmlWriter->Text(String::FromFloat4(mat4.getrow1()));
+		htmlWriter->LineBreak();
+		htmlWriter->Text(String::FromFloat4(mat4.getrow2()));
+		htmlWriter->LineBreak();
+		htmlWriter->Text(String::FromFloat4(mat4.getrow3()));
+		break;
+	}
+	case Attr::ValueType::IntType:
+		str = String::FromInt(value.GetInt());
+		break;
+	case Attr::ValueType::UIntType:
+	case Attr::ValueType::EntityType:
+		if (value.GetUInt() == InvalidIndex)
+		{
+			str = "-1";
+		}
+		else
+		{
+			str = String::FromUInt(value.GetUInt());
+		}
+		break;
+	case Attr::ValueType::Int64Type:
+		str = String::FromLongLong(value.GetInt64());
+		break;
+	case Attr::ValueType::UInt64Type:
+		str = String::FromLongLong(value.GetUInt64());
+		break;
+	case Attr::ValueType::ByteType:
+		str = String::FromByte(value.GetByte());
+		break;
+	case Attr::ValueType::StringType:
+		str = value.GetString();
+		break;
+	case Attr::ValueType::UShortType:
+		str = String::FromUShort(value.GetUShort());
+		break;
+	case Attr::ValueType::ShortType:
+		str = String::FromShort(value.GetShort());
+		break;
+	case Attr::ValueType::BoolType:
+		str = String::FromBool(value.GetBool());
+		break;
+	case Attr::ValueType::QuaternionType:
+		str = String::FromQuaternion(value.GetQuaternion());
+		break;
+	case Attr::ValueType::Float4Type:
+		str = String::FromFloat4(value.GetFloat4());
+		break;
+	case Attr::ValueType::Float2Type:
+		str = String::FromFloat2(value.GetFloat2());
+		break;
+	case Attr::ValueType::FloatType:
+		str = String::FromFloat(value.GetFloat());
+		break;
+	case Attr::ValueType::DoubleType:
+		str = String::FromDouble(value.GetDouble());
+		break;
+	default:
+		str = "";
+		break;
+	}
+	if (!str.IsEmpty())
+		htmlWriter->Text(str);
+}
+
+//------------------------------------------------------------------------------
+/**
+	The attribute values of all instances are copied in one go on the game
+	thread, formatting them is by far the more expensive part.
+*/
+void
+GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Http::HttpRequest>& request)
+{
+	bool available = false;
+	bool found = false;
+	String componentName;
+	Util::FixedArray<Attr::AttrId> attributes;
+	Array<uint> owners;
+	Array<Util::Variant> values;
+	bool copied = this->RunOnOwnerThread([&]()
+	{
+		if (!Game::EntityManager::HasInstance() || !Game::ComponentManager::HasInstance())
+		{
+			return;
+		}
+		available = true;
+		ComponentInterface* component = Game::ComponentManager::Instance()->GetComponentByFourCC(fourcc);
+		if (component == nullptr)
+		{
+			return;
+		}
+		found = true;
+		componentName = component->GetName().AsString();
+		attributes = component->GetAttributes();
+		SizeT numInstances = component->NumRegistered();
+		owners.Reserve(numInstances);
+		values.Reserve(numInstances * attributes.Size());
+		IndexT instance;
+		for (instance = 0; instance < numInstances; instance++)
+		{
+			owners.Append(component->GetOwner(instance).id);
+			for (SizeT i = 1; i < attributes.Size(); i++)
+			{
+				values.Append(component->GetAttributeValue(instance, i));
+			}
+		}
+	});
+	if (!copied)
+	{
+		request->SetStatus(HttpStatus::ServiceUnavailable);
+		return;
+	}
 
 	// configure a HTML page writer
+	request->SetStatus(HttpStatus::OK);
 	Ptr<HtmlPageWriter> htmlWriter = HtmlPageWriter::Create();
 	htmlWriter->SetStream(request->GetResponseContentStream());
 	htmlWriter->SetTitle("Nebula Game Info");
@@ -125,7 +301,7 @@ void GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Htt
 		htmlWriter->AddAttr("href", "/game");
 		htmlWriter->Element(HtmlElement::Anchor, "Game Subsystem Home");
 
-		if (!entityManager.isvalid() || !componentManager.isvalid())
+		if (!available)
 		{
 			htmlWriter->LineBreak();
 			htmlWriter->LineBreak();
@@ -133,15 +309,14 @@ void GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Htt
 		}
 		else
 		{
-			ComponentInterface* component = componentManager->GetComponentByFourCC(fourcc);
-			if (component == nullptr)
+			if (!found)
 			{
 				htmlWriter->Text("No component found with provided FourCC.");
 			}
 			else
 			{
-				SizeT numInstances = component->NumRegistered();
-				htmlWriter->Element(HtmlElement::Heading3, component->GetName().AsString());
+				SizeT numInstances = owners.Size();
+				htmlWriter->Element(HtmlElement::Heading3, componentName);
 				htmlWriter->Begin(HtmlElement::Table);
 				htmlWriter->Begin(HtmlElement::TableRow);
 				htmlWriter->Element(HtmlElement::TableData, "Registered Entities:");
@@ -149,7 +324,7 @@ void GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Htt
 				htmlWriter->End(HtmlElement::TableRow);
 				htmlWriter->Begin(HtmlElement::TableRow);
 				htmlWriter->Element(HtmlElement::TableData, "Attribute Count:");
-				htmlWriter->Element(HtmlElement::TableData, String::FromUInt(component->GetAttributes().Size()));
+				htmlWriter->Element(HtmlElement::TableData, String::FromUInt(attributes.Size()));
 				htmlWriter->End(HtmlElement::TableRow);
 				htmlWriter->End(HtmlElement::Table);
 
@@ -161,13 +336,13 @@ void GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Htt
 				htmlWriter->Begin(HtmlElement::TableRow);
 				htmlWriter->Element(HtmlElement::TableHeader, "Instance Id");
 				htmlWriter->Element(HtmlElement::TableHeader, "Entity Id");
-				const auto& attributes = component->GetAttributes();
 				for (SizeT i = 1; i < attributes.Size(); i++)
 				{
 					htmlWriter->Element(HtmlElement::TableHeader, attributes[i].GetName());
 				}
 				htmlWriter->End(HtmlElement::TableRow);
 				
+				IndexT valueIndex = 0;
 				IndexT instance;
 				for (instance = 0; instance < numInstances; instance++)
 				{
@@ -176,97 +351,30 @@ void GamePageHandler::InspectComponent(const Util::FourCC& fourcc, const Ptr<Htt
 						htmlWriter->AddAttr("bgcolor", "gainsboro");
 					htmlWriter->Begin(HtmlElement::TableRow);
 					htmlWriter->Element(HtmlElement::TableData, String::FromInt(instance));
-					htmlWriter->Element(HtmlElement::TableData, String::FromUInt(component->GetOwner(instance).id));
+					htmlWriter->Element(HtmlElement::TableData, String::FromUInt(owners[instance]));
 					for (SizeT i = 1; i < attributes.Size(); i++)
 					{
 						htmlWriter->Begin(HtmlElement::TableHeader);
-						String str = "";
-						Util::Variant value = component->GetAttributeValue(instance, i);
-						switch (attributes[i].GetValueType())
-						{
-						case Attr::ValueType::Matrix44Type:
-						{
-							Math::matrix44 mat4 = value.GetMatrix44();
-							htmlWriter->Text(String::FromFloat4(mat4.getrow0()));
-							htmlWriter->LineBreak();
-							htmlWriter->Text(String::FromFloat4(mat4.getrow1()));
-							htmlWriter->LineBreak();
-							htmlWriter->Text(String::FromFloat4(mat4.getrow2()));
-							htmlWriter->LineBreak();
-							htmlWriter->Text(String::FromFloat4(mat4.getrow3()));
-							break;
-						}
-						case Attr::ValueType::IntType:
-							str = String::FromInt(value.GetInt());
-							break;
-						case Attr::ValueType::UIntType:
-						case Attr::ValueType::EntityType:
-							if (value.GetUInt() == InvalidIndex)
-							{
-								str = "-1";
-							}
-							else
-							{
-								str = String::FromUInt(value.GetUInt());
-							}
-							break;
-						case Attr::ValueType::Int64Type:
-							str = String::FromLongLong(value.GetInt64());
-							break;
-						case Attr::ValueType::UInt64Type:
-							str = String::FromLongLong(value.GetUInt64());
-							break;
-						case Attr::ValueType::ByteType:
-							str = String::FromByte(value.GetByte());
-							break;
-						case Attr::ValueType::StringType:
-							str = value.GetString();
-							break;
-						case Attr::ValueType::UShortType:
-							str = String::FromUShort(value.GetUShort());
-							break;
-						case Attr::ValueType::ShortType:
-							str = String::FromShort(value.GetShort());
-							break;
-						case Attr::ValueType::BoolType:
-							str = String::FromBool(value.GetBool());
-							break;
-						case Attr::ValueType::QuaternionType:
-							str = String::FromQuaternion(value.GetQuaternion());
-							break;
-						case Attr::ValueType::Float4Type:
-							str = String::FromFloat4(value.GetFloat4());
-							break;
-						case Attr::ValueType::Float2Type:
-							str = String::FromFloat2(value.GetFloat2());
-							break;
-						case Attr::ValueType::FloatType:
-							str = String::FromFloat(value.GetFloat());
-							break;
-						case Attr::ValueType::DoubleType:
-							str = String::FromDouble(value.GetDouble());
-							break;
-						default:
-							str = "";
-							break;
-						}
-						if (!str.IsEmpty())
-							htmlWriter->Text(str);
+						WriteAttributeValue(htmlWriter, attributes[i].GetValueType(), values[valueIndex++]);
 						htmlWriter->End(HtmlElement::TableHeader);
 					}
 					htmlWriter->End(HtmlElement::TableRow);
+
+					// let the server send what is there while the rest is formatted
+					if ((instance + 1) % RowsPerFlush == 0)
+					{
+						request->FlushResponseContent();
+					}
 				}
 				htmlWriter->End(HtmlElement::Table);
 			}
 		}
 		htmlWriter->Close();
-		request->SetStatus(HttpStatus::OK);
 	}
 	else
 	{
 		request->SetStatus(HttpStatus::InternalServerError);
 	}
-
 }
 
 } // namespace Debug
@@ -6,6 +6,11 @@
     @class Debug::GamePageHandler
     
     Displays info about currently running Nebula BaseGameFeatureUnit system.
+
+    Requests are handled on the worker thread of the HttpServer. The
+    component data is copied on the game thread with RunOnOwnerThread(),
+    the page is formatted and flushed in pieces on the worker thread, so
+    dumping a component with many instances doesn't stall a frame.
     
     (C) 2018-2020 Individual contributors, see AUTHORS file
 */
@@ -22,7 +27,11 @@ public:
 	GamePageHandler();
     /// handle a http request, the handler is expected to fill the content stream with response data
     void HandleRequest(const Ptr<Http::HttpRequest>& request);
+	/// handle a request for the instances of a single component
 	void InspectComponent(const Util::FourCC& fourcc, const Ptr<Http::HttpRequest>& request);
+
+	/// number of table rows written between two flushes
+	static const SizeT RowsPerFlush = 256;
 };
 
 } // namespace Debug
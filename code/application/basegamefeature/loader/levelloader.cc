@@ -10,6 +10,10 @@
 #include "basegamefeature/managers/componentmanager.h"
 #include "basegamefeature/components/transformcomponent.h"
 #include "io/filestream.h"
+#include "io/constmemorystream.h"
+#include "io/binaryreader.h"
+#include "jobs/jobs.h"
+#include "loaderserver.h"
 
 // Generated Flatbuffer header
 #include "basegamefeature/loader/level_generated.h"
@@ -178,6 +182,77 @@ struct Listener
 
 //------------------------------------------------------------------------------
 /**
+	The serialized data of one component in a level, and the instances it
+	has been allocated.
+*/
+struct ComponentLoad
+{
+	Game::ComponentInterface* component;
+	const Game::Serialization::ComponentData* data;
+	uint firstInstance;
+	uint numInstances;
+};
+
+//------------------------------------------------------------------------------
+/**
+	Deserializes the attributes of a component directly from the mapped
+	level file, and patches the owners to the newly created entities.
+	Only touches the component's own storage, so different components
+	can be loaded concurrently.
+*/
+static void
+LoadComponentData(const ComponentLoad& load, const Game::Entity* entities)
+{
+	Game::ComponentInterface* c = load.component;
+	auto dataStream = load.data->dataStream();
+
+	Ptr<IO::ConstMemoryStream> mStream = IO::ConstMemoryStream::Create();
+	mStream->SetMemory(dataStream->data(), dataStream->size());
+
+	Ptr<IO::BinaryReader> bReader = IO::BinaryReader::Create();
+	bReader->SetStream(mStream);
+	bReader->SetMemoryMappingEnabled(dataStream->size() > 0);
+	bReader->Open();
+
+	if (c->functions.Deserialize != nullptr)
+		c->functions.Deserialize(bReader, load.firstInstance, load.numInstances);
+	else
+		c->InternalDeserialize(bReader, load.firstInstance, load.numInstances);
+
+	bReader->Close();
+
+	// owners are stored as indices into the entity array of the level
+	const Game::Entity* owners = (const Game::Entity*)load.data->owners()->data();
+	for (uint i = 0; i < load.numInstances; i++)
+	{
+		c->SetOwner(load.firstInstance + i, entities[owners[i].id]);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+LoadComponentDataJob(const Jobs::JobFuncContext& ctx)
+{
+	const ComponentLoad* loads = (const ComponentLoad*)ctx.inputs[0];
+	const Game::Entity* entities = *(const Game::Entity**)ctx.uniforms[0];
+	const SizeT num = ctx.inputSizes[0] / sizeof(ComponentLoad);
+	for (IndexT i = 0; i < num; i++)
+	{
+		LoadComponentData(loads[i], entities);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+	The level file is memory mapped and component data is deserialized
+	straight from the mapping. Instances for all components are allocated
+	up front, after which the components are deserialized in parallel on
+	the LoaderServer's job port, one component per job slice. Without an
+	open LoaderServer they are deserialized on the calling thread.
+	Parenting, OnLoad and OnActivate may touch other components, so they
+	are run on the calling thread afterwards.
 */
 bool
 LevelLoader::Load(const Util::String& levelName)
@@ -190,7 +265,7 @@ LevelLoader::Load(const Util::String& levelName)
     if (!stream->Open())
         return false;
 
-    void* fileMap = stream->Map();
+    const void* fileMap = stream->MapFile();
 
     if (!Game::Serialization::LevelBufferHasIdentifier(fileMap))
     {
@@ -209,73 +284,93 @@ LevelLoader::Load(const Util::String& levelName)
     // Create a convenient array to pass to all components
     const Util::Array<uint> parentIndices(entityBundle->parentIndices()->data(), entityBundle->parentIndices()->size());
 
-	// We need to save each component and enitity start index so that we can call activate after
-	// all components has been loaded
-	Util::Array<Listener> activateListeners;
-    
+	// Needs to create entirely new instances, not reuse old.
+	// This is so that we can actually patch owners and parents.
+	Util::Array<ComponentLoad> loads;
+	loads.Reserve(components.size());
 	for (auto component : components)
 	{
 		Game::ComponentInterface* c = Game::ComponentManager::Instance()->GetComponentByFourCC(component->fourcc());
 		if (c != nullptr)
 		{
-			// Needs to create entirely new instances, not reuse old.
-            // This is so that we can actually patch owners and parents.
-
-            auto numInstances = component->numInstances();
-
-			uint start = c->NumRegistered();
-			c->Allocate(numInstances);
-			uint end = c->NumRegistered();
-
-			Ptr<IO::BinaryReader> bReader = IO::BinaryReader::Create();
-            Ptr<IO::MemoryStream> mStream = IO::MemoryStream::Create();
-
-            // TODO: Kind of an unnecessary copy, should create a constant memory stream (memory scanner?) that only allows reading.
-            mStream->SetSize(component->dataStream()->size());
-            Memory::Copy(component->dataStream()->data(), mStream->GetRawPointer(), component->dataStream()->size());
+			ComponentLoad load;
+			load.component = c;
+			load.data = component;
+			load.firstInstance = c->NumRegistered();
+			load.numInstances = component->numInstances();
+			c->Allocate(load.numInstances);
+			loads.Append(load);
+		}
+	}
 
-            bReader->SetStream(mStream);
-			bReader->Open();
-			
-            if (c->functions.Deserialize != nullptr)
-                c->functions.Deserialize(bReader, start, numInstances);
-            else
-                c->InternalDeserialize(bReader, start, numInstances);
+	LoaderServer* loaderServer = LoaderServer::HasInstance() ? LoaderServer::Instance() : nullptr;
+	if (loads.Size() > 1 && loaderServer != nullptr && loaderServer->IsOpen())
+	{
+		const Game::Entity* entityData = entities.Begin();
+
+		// one component per slice
+		Jobs::JobContext ctx;
+		ctx.uniform.numBuffers = 1;
+		ctx.uniform.data[0] = &entityData;
+		ctx.uniform.dataSize[0] = sizeof(const Game::Entity*);
+		ctx.uniform.scratchSize = 0;
+
+		ctx.input.numBuffers = 1;
+		ctx.input.data[0] = loads.Begin();
+		ctx.input.dataSize[0] = sizeof(ComponentLoad) * loads.Size();
+		ctx.input.sliceSize[0] = sizeof(ComponentLoad);
+
+		// not really an output, the components are written to directly
+		ctx.output.numBuffers = 1;
+		ctx.output.data[0] = loads.Begin();
+		ctx.output.dataSize[0] = sizeof(ComponentLoad) * loads.Size();
+		ctx.output.sliceSize[0] = sizeof(ComponentLoad);
+
+		Jobs::JobId job = Jobs::CreateJob({ LoadComponentDataJob, "LoadComponentDataJob" });
+		Jobs::JobSchedule(job, loaderServer->jobPort, ctx);
+		Jobs::JobSyncSignal(loaderServer->jobSync, loaderServer->jobPort);
+		Jobs::JobSyncHostWait(loaderServer->jobSync);
+		Jobs::DestroyJob(job);
+	}
+	else
+	{
+		for (const ComponentLoad& load : loads)
+		{
+			LoadComponentData(load, entities.Begin());
+		}
+	}
 
-			bReader->Close(); // automatically closes the memory stream. The copied memory will be freed when the destructor is called (end of scope)
+	// We need to save each component and enitity start index so that we can call activate after
+	// all components has been loaded
+	Util::Array<Listener> activateListeners;
 
-            Util::Array<Game::Entity> newOwners((Game::Entity*)component->owners()->data(), component->owners()->size());
-            c->SetOwners(start, newOwners);
+	for (const ComponentLoad& load : loads)
+	{
+		Game::ComponentInterface* c = load.component;
+		uint start = load.firstInstance;
+		uint end = start + load.numInstances;
 
-			// update owner and id maps
-            for (uint j = start; j < end; j++)
-            {
-                c->SetOwner(j, entities[c->GetOwner(j).id]);
-            }
-			
-			if (c->functions.SetParents != nullptr && parentIndices.Size() > 0)
-			{
-				c->functions.SetParents(start, end, entities, parentIndices);
-			}
+		if (c->functions.SetParents != nullptr && parentIndices.Size() > 0)
+		{
+			c->functions.SetParents(start, end, entities, parentIndices);
+		}
 
-			if (c->SubscribedEvents().IsSet(Game::ComponentEvent::OnLoad) && c->functions.OnLoad != nullptr)
+		if (c->SubscribedEvents().IsSet(Game::ComponentEvent::OnLoad) && c->functions.OnLoad != nullptr)
+		{
+			for (SizeT i = start; i < end; i++)
 			{
-				SizeT end = start + numInstances;
-				for (SizeT i = start; i < end; i++)
-				{
-					c->functions.OnLoad(i);
-				}
+				c->functions.OnLoad(i);
 			}
+		}
 
-			if (c->SubscribedEvents().IsSet(Game::ComponentEvent::OnActivate) && c->functions.OnActivate != nullptr)
-			{
-				// Add to list to that we can activate all instances in this component later.
-				Listener listener;
-				listener.component = c;
-				listener.firstInstance = start;
-				listener.numInstances = numInstances;
-				activateListeners.Append(listener);
-			}
+		if (c->SubscribedEvents().IsSet(Game::ComponentEvent::OnActivate) && c->functions.OnActivate != nullptr)
+		{
+			// Add to list to that we can activate all instances in this component later.
+			Listener listener;
+			listener.component = c;
+			listener.firstInstance = start;
+			listener.numInstances = load.numInstances;
+			activateListeners.Append(listener);
 		}
 	}
 
@@ -8,6 +8,8 @@
 #include "core/factory.h"
 #include "levelloader.h"
 #include "io/ioserver.h"
+#include "system/cpu.h"
+#include "system/systeminfo.h"
 
 namespace BaseGameFeature
 {
@@ -19,7 +21,9 @@ __ImplementSingleton(LoaderServer);
 */
 LoaderServer::LoaderServer() :
     isOpen(false),
-    debugTextEnabled(true)
+    debugTextEnabled(true),
+    jobPort(Jobs::JobPortId::Invalid()),
+    jobSync(Jobs::JobSyncId::Invalid())
 {
     n_assert(0 == Singleton);
     Singleton = this;
@@ -55,6 +59,29 @@ LoaderServer::Open()
         userProfile->Load();
     }
     this->SetUserProfile(userProfile);
+
+    // one worker per core, except for the core of the loading thread
+    SizeT numCores = Core::SysFunc::GetSystemInfo()->GetNumCpuCores();
+    SizeT numThreads = Math::n_max(Math::n_min(numCores - 1, 31), 1);
+    uint affinity = 0;
+    IndexT i;
+    for (i = 0; i < numThreads; i++)
+        affinity |= (uint)System::Cpu::Core1 << i;
+
+    Jobs::CreateJobPortInfo info =
+    {
+        "LevelLoaderJobPort",
+        numThreads,
+        affinity,
+        UINT_MAX
+    };
+    this->jobPort = Jobs::CreateJobPort(info);
+
+    Jobs::CreateJobSyncInfo sinfo =
+    {
+        nullptr
+    };
+    this->jobSync = Jobs::CreateJobSync(sinfo);
   
     // create progress indicator window
     //this->progressIndicator = UI::ProgressBarWindow::Create();
@@ -80,6 +107,11 @@ LoaderServer::Close()
     //}
     //this->progressIndicator = 0;
 
+    Jobs::DestroyJobPort(this->jobPort);
+    Jobs::DestroyJobSync(this->jobSync);
+    this->jobPort = Jobs::JobPortId::Invalid();
+    this->jobSync = Jobs::JobSyncId::Invalid();
+
     this->isOpen = false;
 }
 
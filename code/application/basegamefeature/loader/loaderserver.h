@@ -16,6 +16,7 @@
 #include "basegamefeature/loader/userprofile.h"
 #include "entityloaderbase.h"
 #include "io/uri.h"
+#include "jobs/jobs.h"
 
 //------------------------------------------------------------------------------
 namespace BaseGameFeature
@@ -93,6 +94,9 @@ private:
     bool debugTextEnabled;
     Ptr<UserProfile> userProfile;
     Ptr<EntityLoaderBase> entityLoader;
+    /// used by the LevelLoader to load components in parallel
+    Jobs::JobPortId jobPort;
+    Jobs::JobSyncId jobSync;
 };
 
 //------------------------------------------------------------------------------
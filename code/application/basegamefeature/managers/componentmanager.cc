@@ -5,6 +5,10 @@
 #include "application/stdneb.h"
 #include "game/component/componentinterface.h"
 #include "componentmanager.h"
+#include "timing/timer.h"
+#include "system/cpu.h"
+#include "system/systeminfo.h"
+#include "debug/profiling.h"
 
 namespace Game
 {
@@ -15,10 +19,35 @@ __ImplementSingleton(Game::ComponentManager);
 //------------------------------------------------------------------------------
 /**
 */
-ComponentManager::ComponentManager()
+ComponentManager::ComponentManager() :
+	currentPass(PassOptimize),
+	serialExecution(false)
 {
     __ConstructSingleton;
 
+	// one worker per core, except for the core of the game thread
+	SizeT numCores = Core::SysFunc::GetSystemInfo()->GetNumCpuCores();
+	SizeT numThreads = Math::n_max(Math::n_min(numCores - 1, 31), 1);
+	uint affinity = 0;
+	IndexT i;
+	for (i = 0; i < numThreads; i++)
+		affinity |= (uint)System::Cpu::Core1 << i;
+
+	Jobs::CreateJobPortInfo info =
+	{
+		"ComponentJobPort",
+		numThreads,
+		affinity,
+		UINT_MAX
+	};
+	this->jobPort = Jobs::CreateJobPort(info);
+
+	Jobs::CreateJobSyncInfo sinfo =
+	{
+		nullptr
+	};
+	this->jobSync = Jobs::CreateJobSync(sinfo);
+
     _setup_grouped_timer(OnBeginFrameTimer, "ComponentManager");
     _setup_grouped_timer(OnRenderTimer, "ComponentManager");
     _setup_grouped_timer(OnEndFrameTimer, "ComponentManager");
@@ -37,6 +66,9 @@ ComponentManager::~ComponentManager()
     _discard_timer(OnRenderDebugTimer);
     _discard_timer(GarbageCollection);
 
+	Jobs::DestroyJobPort(this->jobPort);
+	Jobs::DestroyJobSync(this->jobSync);
+
 	__DestructSingleton;
 }
 
@@ -68,8 +100,10 @@ ComponentManager::RegisterComponent(ComponentInterface* component, const Util::S
 	component->fourcc = fourcc;
 
 	this->components.Append(component);
+	this->componentTimings.Append(ComponentTimings());
 	this->componentByFourcc.Add(fourcc, component);
 	this->componentByName.Add(name, component);
+	this->InvalidateSchedules();
 }
 
 //------------------------------------------------------------------------------
@@ -82,6 +116,8 @@ ComponentManager::DeregisterComponent(ComponentInterface * component)
 	if (index != InvalidIndex)
 	{
 		this->components.EraseIndex(index);
+		this->componentTimings.EraseIndex(index);
+		this->InvalidateSchedules();
 	}
 
 	auto it = this->componentByFourcc.Begin();
@@ -124,6 +160,8 @@ ComponentManager::DeregisterAll()
 	this->componentByFourcc.Clear();
 	this->componentByName.Clear();
 	this->components.Clear();
+	this->componentTimings.Clear();
+	this->InvalidateSchedules();
 }
 
 //------------------------------------------------------------------------------
@@ -192,8 +230,11 @@ void
 ComponentManager::EnableComponent(const Util::FourCC & fourcc)
 {
 	auto component = GetComponentByFourCC(fourcc);
-	if (component != nullptr)
+	if (component != nullptr && !component->enabled)
+	{
 		component->enabled = true;
+		this->InvalidateSchedules();
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -203,8 +244,11 @@ void
 ComponentManager::DisableComponent(const Util::FourCC & fourcc)
 {
 	auto component = GetComponentByFourCC(fourcc);
-	if (component != nullptr)
+	if (component != nullptr && component->enabled)
+	{
 		component->enabled = false;
+		this->InvalidateSchedules();
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -215,22 +259,12 @@ ComponentManager::OnBeginFrame()
 {
 	// We need to clean up any erased components, no matter if they're registered to this event.
 	// TODO: Can we do this in a better way?
-	SizeT size = this->components.Size();
     _start_timer(GarbageCollection);
-	for (SizeT i = 0; i < size; ++i)
-	{
-		this->components[i]->Optimize();
-	}
+	this->ExecuteSchedule(PassOptimize);
     _stop_timer(GarbageCollection);
 
     _start_timer(OnBeginFrameTimer);
-	ComponentInterface* component;
-	for (SizeT i = 0; i < size; ++i)
-	{
-		component = this->components[i];
-		if (component->Enabled() == true && component->functions.OnBeginFrame != nullptr)
-			component->functions.OnBeginFrame();
-	}
+	this->ExecuteSchedule(PassBeginFrame);
     _stop_timer(OnBeginFrameTimer);
 }
 
@@ -247,7 +281,10 @@ ComponentManager::OnRender()
 	{
 		component = this->components[i];
 		if (component->Enabled() && component->functions.OnRender != nullptr)
+		{
+			N_SCOPE(component->GetName().Value(), "Components");
 			component->functions.OnRender();
+		}
 	}
     _stop_timer(OnRenderTimer);
 }
@@ -259,14 +296,7 @@ void
 ComponentManager::OnEndFrame()
 {
     _start_timer(OnEndFrameTimer);
-	SizeT length = this->components.Size();
-	ComponentInterface* component;
-	for (SizeT i = 0; i < length; ++i)
-	{
-		component = this->components[i];
-		if (component->Enabled() && component->functions.OnEndFrame != nullptr)
-			component->functions.OnEndFrame();
-	}
+	this->ExecuteSchedule(PassEndFrame);
     _stop_timer(OnEndFrameTimer);
 }
 
@@ -281,9 +311,248 @@ ComponentManager::OnRenderDebug()
 	for (SizeT i = 0; i < length; ++i)
 	{
 		if (this->components[i]->functions.OnRenderDebug != nullptr)
+		{
+			N_SCOPE(this->components[i]->GetName().Value(), "Components");
 			this->components[i]->functions.OnRenderDebug();
+		}
 	}
     _stop_timer(OnRenderDebugTimer);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ComponentManager::SetSerialExecution(bool serial)
+{
+	this->serialExecution = serial;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ComponentManager::IsSerialExecution() const
+{
+	return this->serialExecution;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const ComponentManager::ComponentTimings&
+ComponentManager::GetComponentTimings(IndexT index) const
+{
+	return this->componentTimings[index];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ComponentManager::InvalidateSchedules()
+{
+	IndexT i;
+	for (i = 0; i < NumFramePasses; i++)
+		this->schedules[i].valid = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Each participating component is put in the batch directly after the last
+	batch containing an earlier component it conflicts with. Garbage collection
+	only touches the component's own data, so any two components which have
+	declared their access can be collected concurrently.
+*/
+void
+ComponentManager::BuildSchedule(FramePass pass, Schedule& schedule)
+{
+	Util::Array<ComponentInterface*> candidates;
+	Util::Array<IndexT> candidateIndices;
+	Util::Array<IndexT> candidateBatches;
+	SizeT numBatches = 0;
+
+	IndexT i, j;
+	for (i = 0; i < this->components.Size(); i++)
+	{
+		ComponentInterface* component = this->components[i];
+		switch (pass)
+		{
+		case PassBeginFrame:
+			if (!component->Enabled() || component->functions.OnBeginFrame == nullptr)
+				continue;
+			break;
+		case PassEndFrame:
+			if (!component->Enabled() || component->functions.OnEndFrame == nullptr)
+				continue;
+			break;
+		default:
+			break;
+		}
+
+		IndexT batch = 0;
+		for (j = 0; j < candidates.Size(); j++)
+		{
+			if (candidateBatches[j] < batch)
+				continue;
+
+			bool conflict = pass == PassOptimize
+				? (!component->HasDeclaredFrameAccess() || !candidates[j]->HasDeclaredFrameAccess())
+				: component->ConflictsWith(candidates[j]);
+			if (conflict)
+				batch = candidateBatches[j] + 1;
+		}
+
+		candidates.Append(component);
+		candidateIndices.Append(i);
+		candidateBatches.Append(batch);
+		numBatches = Math::n_max(numBatches, batch + 1);
+	}
+
+	// flatten batches, registration order is kept within each batch
+	schedule.components.Clear();
+	schedule.indices.Clear();
+	schedule.batchOffsets.Clear();
+	IndexT batch;
+	for (batch = 0; batch < numBatches; batch++)
+	{
+		schedule.batchOffsets.Append(schedule.components.Size());
+		for (j = 0; j < candidates.Size(); j++)
+		{
+			if (candidateBatches[j] == batch)
+			{
+				schedule.components.Append(candidates[j]);
+				schedule.indices.Append(candidateIndices[j]);
+			}
+		}
+	}
+	schedule.batchOffsets.Append(schedule.components.Size());
+	schedule.timings.SetSize(schedule.components.Size());
+	schedule.valid = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ComponentManager::ExecuteSchedule(FramePass pass)
+{
+	Schedule& schedule = this->schedules[pass];
+	if (!schedule.valid)
+		this->BuildSchedule(pass, schedule);
+	this->currentPass = pass;
+
+	IndexT batch;
+	for (batch = 0; batch < schedule.batchOffsets.Size() - 1; batch++)
+	{
+		const IndexT first = schedule.batchOffsets[batch];
+		const SizeT num = schedule.batchOffsets[batch + 1] - first;
+
+		if (num == 1 || this->serialExecution)
+		{
+			IndexT i;
+			for (i = first; i < first + num; i++)
+				schedule.timings[i] = RunComponentPass(schedule.components[i], pass);
+			continue;
+		}
+
+		// one component per slice
+		Jobs::JobContext ctx;
+		ctx.uniform.numBuffers = 1;
+		ctx.uniform.data[0] = &this->currentPass;
+		ctx.uniform.dataSize[0] = sizeof(FramePass);
+		ctx.uniform.scratchSize = 0;
+
+		ctx.input.numBuffers = 1;
+		ctx.input.data[0] = schedule.components.Begin() + first;
+		ctx.input.dataSize[0] = sizeof(ComponentInterface*) * num;
+		ctx.input.sliceSize[0] = sizeof(ComponentInterface*);
+
+		ctx.output.numBuffers = 1;
+		ctx.output.data[0] = schedule.timings.Begin() + first;
+		ctx.output.dataSize[0] = sizeof(Timing::Time) * num;
+		ctx.output.sliceSize[0] = sizeof(Timing::Time);
+
+		Jobs::JobId job = Jobs::CreateJob({ ComponentPassJob, "ComponentPassJob" });
+		Jobs::JobSchedule(job, this->jobPort, ctx);
+
+		// the next batch may depend on this one
+		Jobs::JobSyncSignal(this->jobSync, this->jobPort);
+		Jobs::JobSyncHostWait(this->jobSync);
+		Jobs::DestroyJob(job);
+	}
+
+	// store timings, components that did not participate are reset
+	IndexT i;
+	for (i = 0; i < this->componentTimings.Size(); i++)
+	{
+		ComponentTimings& timings = this->componentTimings[i];
+		switch (pass)
+		{
+		case PassOptimize: timings.optimize = 0; timings.optimizeBatch = InvalidIndex; break;
+		case PassBeginFrame: timings.onBeginFrame = 0; timings.onBeginFrameBatch = InvalidIndex; break;
+		case PassEndFrame: timings.onEndFrame = 0; timings.onEndFrameBatch = InvalidIndex; break;
+		default: break;
+		}
+	}
+	batch = 0;
+	for (i = 0; i < schedule.indices.Size(); i++)
+	{
+		while (schedule.batchOffsets[batch + 1] <= i)
+			batch++;
+
+		ComponentTimings& timings = this->componentTimings[schedule.indices[i]];
+		switch (pass)
+		{
+		case PassOptimize: timings.optimize = schedule.timings[i]; timings.optimizeBatch = batch; break;
+		case PassBeginFrame: timings.onBeginFrame = schedule.timings[i]; timings.onBeginFrameBatch = batch; break;
+		case PassEndFrame: timings.onEndFrame = schedule.timings[i]; timings.onEndFrameBatch = batch; break;
+		default: break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Timing::Time
+ComponentManager::RunComponentPass(ComponentInterface* component, FramePass pass)
+{
+	N_SCOPE(component->GetName().Value(), "Components");
+	Timing::Timer timer;
+	timer.Start();
+	switch (pass)
+	{
+	case PassOptimize:
+		component->Optimize();
+		break;
+	case PassBeginFrame:
+		component->functions.OnBeginFrame();
+		break;
+	case PassEndFrame:
+		component->functions.OnEndFrame();
+		break;
+	default:
+		break;
+	}
+	timer.Stop();
+	return timer.GetTime();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ComponentManager::ComponentPassJob(const Jobs::JobFuncContext& ctx)
+{
+	const FramePass pass = *(const FramePass*)ctx.uniforms[0];
+	ComponentInterface** components = (ComponentInterface**)ctx.inputs[0];
+	Timing::Time* timings = (Timing::Time*)ctx.outputs[0];
+
+	const SizeT num = ctx.inputSizes[0] / sizeof(ComponentInterface*);
+	IndexT i;
+	for (i = 0; i < num; i++)
+		timings[i] = RunComponentPass(components[i], pass);
+}
+
 } // namespace Game
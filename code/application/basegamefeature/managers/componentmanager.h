@@ -5,6 +5,18 @@
 
 	Holds components and acts as interface agains other systems.
 
+	Each frame, the components participating in a pass (garbage collection,
+	OnBeginFrame or OnEndFrame) are split into batches. A component is placed
+	in the batch after the last earlier component it conflicts with, so the
+	registration order is kept between components that touch the same
+	attributes. Batches with more than one component are executed in parallel
+	on the component job port. Serial execution runs the exact same schedule
+	on the game thread, which is useful for determinism testing.
+
+	The schedules are only rebuilt when components are registered, enabled,
+	disabled or change their declared access.
+	@see	ComponentInterface::DeclareFrameAccess
+
 	(C) 2018-2020 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
@@ -17,6 +29,8 @@
 #include "ids/id.h"
 #include "util/fourcc.h"
 #include "debug/debugtimer.h"
+#include "jobs/jobs.h"
+#include "timing/time.h"
 
 namespace Game
 {
@@ -27,6 +41,18 @@ class ComponentManager : public Game::Manager
 	__DeclareClass(ComponentManager)
 	__DeclareSingleton(ComponentManager)
 public:
+	/// Time spent in each pass by a single component during the last frame,
+	/// and the batch it was run in, InvalidIndex if it didn't take part
+	struct ComponentTimings
+	{
+		Timing::Time optimize = 0;
+		Timing::Time onBeginFrame = 0;
+		Timing::Time onEndFrame = 0;
+		IndexT optimizeBatch = InvalidIndex;
+		IndexT onBeginFrameBatch = InvalidIndex;
+		IndexT onEndFrameBatch = InvalidIndex;
+	};
+
 	ComponentManager();
 	~ComponentManager();
 
@@ -72,11 +98,66 @@ public:
 	/// Execute all OnRenderDebug events
 	void OnRenderDebug();
 
+	/// Run all component passes on the game thread, in schedule order
+	void SetSerialExecution(bool serial);
+
+	/// Returns true if all component passes are run on the game thread
+	bool IsSerialExecution() const;
+
+	/// Returns the timings of the component at index from the last frame
+	const ComponentTimings& GetComponentTimings(IndexT index) const;
+
+	/// Rebuild the schedules before the next pass, called when the set of participating components changes
+	void InvalidateSchedules();
+
 private:
+	/// Passes that can be scheduled
+	enum FramePass
+	{
+		PassOptimize,
+		PassBeginFrame,
+		PassEndFrame,
+
+		NumFramePasses
+	};
+
+	/// The batches of a pass
+	struct Schedule
+	{
+		/// Components in schedule order, with their index in the components array
+		Util::Array<ComponentInterface*> components;
+		Util::Array<IndexT> indices;
+		/// Start of each batch in the scheduled arrays, with the total count appended last
+		Util::Array<IndexT> batchOffsets;
+		/// Timings written by the jobs, parallel to components
+		Util::Array<Timing::Time> timings;
+		bool valid = false;
+	};
+
+	/// Split all participating components into batches of non-conflicting components
+	void BuildSchedule(FramePass pass, Schedule& schedule);
+
+	/// Build and execute the schedule for a pass
+	void ExecuteSchedule(FramePass pass);
+
+	/// Run a pass for a single component and return the time it took
+	static Timing::Time RunComponentPass(ComponentInterface* component, FramePass pass);
+
+	/// Job function that runs a pass for a slice of components
+	static void ComponentPassJob(const Jobs::JobFuncContext& ctx);
+
 	// We can afford double hashtables here because there'll never be THAT many components.
 	Util::HashTable<Util::StringAtom, ComponentInterface*, 64> componentByName;
 	Util::HashTable<Util::FourCC, ComponentInterface*, 64> componentByFourcc;
 	Util::Array<ComponentInterface*> components;
+	Util::Array<ComponentTimings> componentTimings;
+
+	Schedule schedules[NumFramePasses];
+
+	FramePass currentPass;
+	bool serialExecution;
+	Jobs::JobPortId jobPort;
+	Jobs::JobSyncId jobSync;
 
     _declare_timer(OnBeginFrameTimer);
     _declare_timer(OnRenderTimer);
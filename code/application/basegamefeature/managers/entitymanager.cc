@@ -9,7 +9,7 @@ namespace Game
 {
 
 __ImplementClass(Game::EntityManager, 'EnMr', Game::Manager);
-__ImplementSingleton(EntityManager)
+__ImplementInterfaceSingleton(EntityManager)
 
 //------------------------------------------------------------------------------
 /**
@@ -17,7 +17,7 @@ __ImplementSingleton(EntityManager)
 EntityManager::EntityManager() :
 	numEntities(0)
 {
-	__ConstructSingleton;
+	__ConstructInterfaceSingleton;
 }
 
 //------------------------------------------------------------------------------
@@ -25,7 +25,7 @@ EntityManager::EntityManager() :
 */
 EntityManager::~EntityManager()
 {
-	__DestructSingleton;
+	__DestructInterfaceSingleton;
 }
 
 //------------------------------------------------------------------------------
@@ -46,10 +46,13 @@ EntityManager::NewEntity()
 Util::Array<Entity>
 EntityManager::CreateEntities(uint n)
 {
+	static_assert(sizeof(Entity) == sizeof(Ids::Id32), "Entity must be binary compatible with Ids::Id32");
 	Util::Array<Entity> arr;
-	for (SizeT i = 0; i < n; i++)
+	if (n > 0)
 	{
-		arr.Append(this->NewEntity());
+		arr.SetSize(n);
+		this->pool.Allocate((Ids::Id32*)arr.Begin(), n);
+		this->numEntities += n;
 	}
 	return arr;
 }
@@ -63,15 +66,17 @@ EntityManager::DeleteEntity(const Entity & e)
 	this->pool.Deallocate(e.id);
 
 	// Call deletion callbacks for this entity
-	if (this->deletionCallbacks.Contains(e))
+	IndexT index = this->deletionCallbacks.FindIndex(e);
+	if (index != InvalidIndex)
 	{
-		Util::Array<Util::Delegate<void(Entity)>>& delegates = this->deletionCallbacks[e];
+		// callbacks may add or remove callbacks of other entities, which can move entries in the table
+		Util::Array<Util::Delegate<void(Entity)>> delegates = std::move(this->deletionCallbacks.ValueAtIndex(e, index));
+		this->deletionCallbacks.EraseIndex(e, index);
 		for (SizeT i = 0; i < delegates.Size(); ++i)
 		{
 			n_assert2(delegates[i].IsValid(), "Deletion callback is not valid!");
 			delegates[i](e);
 		}
-		this->deletionCallbacks.Erase(e);
 	}
 
 	this->numEntities--;
@@ -7,6 +7,9 @@
 
 	Components can register deletion callbacks to
 
+	This is an interface singleton, since component garbage collection may
+	run on the component job port, and checks which entities are alive.
+
 	(C) 2018-2020 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
@@ -16,6 +19,7 @@
 #include "game/entity.h"
 #include "game/manager.h"
 #include "util/delegate.h"
+#include "util/flathashtable.h"
 #include "game/component/componentinterface.h"
 
 namespace Game {
@@ -23,7 +27,7 @@ namespace Game {
 class EntityManager : public Game::Manager
 {
 	__DeclareClass(EntityManager)
-	__DeclareSingleton(EntityManager)
+	__DeclareInterfaceSingleton(EntityManager)
 public:
 	/// constructor
 	EntityManager();
@@ -33,7 +37,7 @@ public:
 	/// Generate a new entity.
 	Entity NewEntity();
 	
-	/// Create n amount of entities at the same time.
+	/// Create n amount of entities at the same time. Faster than calling NewEntity n times.
 	Util::Array<Entity> CreateEntities(uint n);
 
 	/// Delete an entity.
@@ -66,7 +70,7 @@ private:
 	SizeT numEntities;
 
 	/// Contains all callbacks for deletion to components for each entity
-	Util::HashTable<Entity, Util::Array<Util::Delegate<void(Entity)>>> deletionCallbacks;
+	Util::FlatHashTable<Entity, Util::Array<Util::Delegate<void(Entity)>>> deletionCallbacks;
 };
 
 } // namespace Game
\ No newline at end of file
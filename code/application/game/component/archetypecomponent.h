@@ -0,0 +1,588 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	@class Game::ArchetypeComponent
+
+	A component that keeps its instances in a Game::ArchetypeStorage
+	instead of one array per attribute.
+
+	Instance ids are the dense indices of the rows in the component's
+	archetype, so they stay packed like in Game::Component; removing an
+	instance moves the last instance into its place and calls
+	OnInstanceMoved. Systems that touch all instances can iterate the
+	chunks directly with ForEachChunk.
+
+	Use it like Game::Component, the allocator declared for a component
+	inherits from it with the component's attributes as template arguments.
+	@see	Game::TagComponent
+
+	(C) 2020 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "game/component/component.h"
+#include "game/component/archetypestorage.h"
+#include "util/random.h"
+#include "basegamefeature/managers/entitymanager.h"
+
+namespace Game
+{
+
+template <typename ... TYPES>
+class ArchetypeComponent : public ComponentInterface
+{
+public:
+	ArchetypeComponent();
+	ArchetypeComponent(ComponentCreateInfo const& settings);
+	~ArchetypeComponent();
+
+	SizeT NumRegistered() const;
+
+	/// register an Id. Will create new mapping and allocate instance data. Returns index of new instance data
+	InstanceId RegisterEntity(Entity e);
+
+	/// allocates a new instance without registering it
+	InstanceId AllocateInstance();
+
+	/// register a previously allocated instance
+	void RegisterInstance(Entity e, InstanceId id);
+
+	/// deregister an Id. The last instance is moved into its place
+	void DeregisterEntity(Entity e);
+
+	/// Destroys all instances and sets all memory used free.
+	void DestroyAll();
+
+	/// Deregister all inactive entities.
+	void DeregisterAllInactive();
+
+	/// Free up all non-reserved by entity data.
+	void Clean();
+
+	/// Return the owner of a given instance
+	Entity GetOwner(InstanceId i) const;
+
+	/// Set the owner of a given instance
+	void SetOwner(InstanceId i, Game::Entity entity);
+
+	/// retrieve the instance id of an entity, InvalidIndex if not registered
+	InstanceId GetInstance(Entity e) const;
+
+	/// Write data into writer.
+	void Serialize(const Ptr<IO::BinaryWriter>& writer) const;
+
+	/// Set data from blob
+	void Deserialize(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances);
+
+	/// Allocate multiple instances
+	void Allocate(uint num);
+
+	/// get single item from resource
+	template <typename ATTR>
+	typename ATTR::InnerType& Get(const InstanceId instance);
+
+	/// call func(SizeT num, const Entity* owners, ATTRS::InnerType*...) once for every chunk
+	template <typename ... ATTRS, typename FUNC>
+	void ForEachChunk(FUNC&& func);
+
+	/// Callback for when an entity is deleted.
+	void OnEntityDeleted(Game::Entity entity);
+
+	/// perform garbage collection. Returns number of erased instances.
+	SizeT Optimize();
+
+	/// Get attribute value as a variant. This is generally quite slow, so use with care!
+	Util::Variant GetAttributeValue(InstanceId instance, IndexT attributeIndex);
+
+	/// Get attribute value as a variant. This is generally quite slow, so use with care!
+	Util::Variant GetAttributeValue(InstanceId instance, Util::FourCC attribute);
+
+	/// Set attribute value as a variant. This is generally quite slow and won't propagate to other components, so use with care!
+	void SetAttributeValue(InstanceId instance, IndexT attributeIndex, const Util::Variant& value);
+
+	/// Set attribute value as a variant. This is generally quite slow and won't propagate to other components, so use with care!
+	void SetAttributeValue(InstanceId instance, Util::FourCC attribute, const Util::Variant& value);
+
+	/// return the owner map, gathered from the chunks
+	Util::Array<Game::Entity> const& GetOwners() const;
+
+	/// sets owners of offset -> (newOwners.Size() + offset) to newOwners.
+	void SetOwners(uint offset, Util::Array<Game::Entity> const& newOwners);
+
+	/// Write owners into writer.
+	void SerializeOwners(const Ptr<IO::BinaryWriter>& writer) const;
+
+	/// Set owners from reader
+	void DeserializeOwners(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances);
+
+protected:
+	ComponentCreateInfo settings;
+	ArchetypeStorage storage;
+	ArchetypeId archetype;
+
+private:
+	/// Initialize attribute list.
+	template<std::size_t...Is>
+	void Init(std::index_sequence<Is...>);
+
+	/// Remove an instance, moving the last instance into its place
+	void EraseInstance(InstanceId index);
+
+	/// Write the values of a single attribute
+	template <typename ATTR>
+	void SerializeAttribute(const Ptr<IO::BinaryWriter>& writer) const;
+
+	/// Read the values of a single attribute
+	template <typename ATTR>
+	void DeserializeAttribute(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances);
+
+	/// gathered by GetOwners
+	mutable Util::Array<Entity> owners;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+ArchetypeComponent<TYPES...>::ArchetypeComponent()
+{
+	this->Init(std::make_index_sequence<sizeof...(TYPES)>());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+ArchetypeComponent<TYPES...>::ArchetypeComponent(ComponentCreateInfo const& settings) :
+	settings(settings)
+{
+	this->Init(std::make_index_sequence<sizeof...(TYPES)>());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+ArchetypeComponent<TYPES...>::~ArchetypeComponent()
+{
+	// empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+template <std::size_t...Is>
+void ArchetypeComponent<TYPES...>::Init(std::index_sequence<Is...>)
+{
+	this->attributes.SetSize(sizeof...(TYPES) + 1);
+	// We always have an owner
+	this->attributes[0] = Attr::Owner();
+
+	using expander = int[];
+	(void)expander
+	{
+		0, (
+			this->attributes[Is + 1] = TYPES(),
+		0)...
+	};
+
+	this->archetype = this->storage.template CreateArchetype<TYPES...>();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> SizeT
+ArchetypeComponent<TYPES...>::NumRegistered() const
+{
+	return this->storage.NumEntities(this->archetype);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> InstanceId
+ArchetypeComponent<TYPES...>::RegisterEntity(Entity e)
+{
+	IndexT index = this->storage.GetIndex(e);
+	if (index != InvalidIndex)
+		return index;
+
+	InstanceId instance = this->AllocateInstance();
+	this->RegisterInstance(e, instance);
+	return instance;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> InstanceId
+ArchetypeComponent<TYPES...>::AllocateInstance()
+{
+	return this->storage.Allocate(this->archetype, 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::RegisterInstance(Entity e, InstanceId index)
+{
+	this->storage.SetOwner(this->archetype, index, e);
+
+	if (this->events.IsSet<ComponentEvent::OnActivate>())
+	{
+		this->functions.OnActivate(index);
+	}
+
+	if (!this->settings.incrementalDeletion)
+	{
+		Game::EntityManager::Instance()->RegisterDeletionCallback(e, this);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::DeregisterEntity(Entity e)
+{
+	IndexT index = this->storage.GetIndex(e);
+	n_assert2(index != InvalidIndex, "Tried to remove an ID that had not been registered.");
+
+	if (this->events.IsSet<ComponentEvent::OnDeactivate>())
+	{
+		this->functions.OnDeactivate(index);
+	}
+
+	if (!this->settings.incrementalDeletion)
+	{
+		Game::EntityManager::Instance()->DeregisterDeletionCallback(e, this);
+	}
+
+	this->EraseInstance(index);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::EraseInstance(InstanceId index)
+{
+	InstanceId oldIndex = this->NumRegistered() - 1;
+	this->storage.EraseIndexSwap(this->archetype, index);
+
+	// make sure the instance has actually moved and that
+	// we actually have any registered entities left
+	if (this->functions.OnInstanceMoved != nullptr && this->NumRegistered() != 0 && index != oldIndex)
+	{
+		this->functions.OnInstanceMoved(index, oldIndex);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::OnEntityDeleted(Game::Entity entity)
+{
+	IndexT index = this->storage.GetIndex(entity);
+	if (index != InvalidIndex)
+	{
+		if (this->events.IsSet<ComponentEvent::OnDeactivate>())
+		{
+			this->functions.OnDeactivate(index);
+		}
+		this->EraseInstance(index);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+	Runs until it hits four entities that are alive, like Game::Component.
+	Instances are erased right away when deregistered, so there are no
+	free ids to pack.
+*/
+template <class ... TYPES> SizeT
+ArchetypeComponent<TYPES...>::Optimize()
+{
+	SizeT numErased = 0;
+	if (this->settings.incrementalDeletion)
+	{
+		Ptr<EntityManager> entityManager = EntityManager::Instance();
+		uint numAlive = 0;
+		while (this->NumRegistered() > 0 && numAlive < 4)
+		{
+			InstanceId index = Util::FastRandom() % this->NumRegistered();
+			if (entityManager->IsAlive(this->GetOwner(index)))
+			{
+				++numAlive;
+				continue;
+			}
+			numAlive = 0;
+			this->EraseInstance(index);
+			++numErased;
+		}
+	}
+	return numErased;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::DestroyAll()
+{
+	if (!this->settings.incrementalDeletion)
+	{
+		SizeT length = this->NumRegistered();
+		for (SizeT i = 0; i < length; i++)
+		{
+			Entity owner = this->GetOwner(i);
+			if (owner != Entity::Invalid())
+				Game::EntityManager::Instance()->DeregisterDeletionCallback(owner, this);
+		}
+	}
+	this->storage.Clear();
+	this->owners.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::DeregisterAllInactive()
+{
+	this->Clean();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::Clean()
+{
+	Ptr<Game::EntityManager> entityManager = Game::EntityManager::Instance();
+	SizeT index = 0;
+	while (index < this->NumRegistered())
+	{
+		if (!entityManager->IsAlive(this->GetOwner(index)))
+		{
+			this->EraseInstance(index);
+			continue;
+		}
+		index++;
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> Entity
+ArchetypeComponent<TYPES...>::GetOwner(InstanceId i) const
+{
+	return this->storage.GetOwner(this->archetype, i);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::SetOwner(InstanceId i, Game::Entity entity)
+{
+	this->storage.SetOwner(this->archetype, i, entity);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> InstanceId
+ArchetypeComponent<TYPES...>::GetInstance(Entity e) const
+{
+	return this->storage.GetIndex(e);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES> void
+ArchetypeComponent<TYPES...>::Allocate(uint num)
+{
+	this->storage.Allocate(this->archetype, num);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+template <typename ATTR>
+inline typename ATTR::InnerType&
+ArchetypeComponent<TYPES...>::Get(const InstanceId instance)
+{
+	return this->storage.template Get<ATTR>(this->archetype, instance);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+template <typename ... ATTRS, typename FUNC>
+inline void
+ArchetypeComponent<TYPES...>::ForEachChunk(FUNC&& func)
+{
+	this->storage.template ForEachChunk<ATTRS...>(std::forward<FUNC>(func));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline Util::Variant
+ArchetypeComponent<TYPES...>::GetAttributeValue(InstanceId instance, IndexT attributeIndex)
+{
+	n_assert2(attributeIndex > 0 && attributeIndex <= sizeof...(TYPES), "Index out of range");
+	return this->GetAttributeValue(instance, this->attributes[attributeIndex].GetFourCC());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline Util::Variant
+ArchetypeComponent<TYPES...>::GetAttributeValue(InstanceId instance, Util::FourCC attribute)
+{
+	n_assert2(instance < (uint)this->NumRegistered(), "Invalid instance id");
+	Util::Variant value;
+	(void)((attribute == TYPES::FourCC() ? (value = Util::Variant(this->Get<TYPES>(instance)), true) : false) || ...);
+	return value;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::SetAttributeValue(InstanceId instance, IndexT attributeIndex, const Util::Variant& value)
+{
+	n_assert2(attributeIndex > 0 && attributeIndex <= sizeof...(TYPES), "Index out of range");
+	this->SetAttributeValue(instance, this->attributes[attributeIndex].GetFourCC(), value);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::SetAttributeValue(InstanceId instance, Util::FourCC attribute, const Util::Variant& value)
+{
+	n_assert2(instance < (uint)this->NumRegistered(), "Invalid instance id");
+	(void)((attribute == TYPES::FourCC() ? (this->Get<TYPES>(instance) = value.Get<typename TYPES::InnerType>(), true) : false) || ...);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline Util::Array<Game::Entity> const&
+ArchetypeComponent<TYPES...>::GetOwners() const
+{
+	const SizeT num = this->NumRegistered();
+	this->owners.SetSize(num);
+	IndexT i;
+	for (i = 0; i < num; i++)
+		this->owners[i] = this->GetOwner(i);
+	return this->owners;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::SetOwners(uint offset, Util::Array<Game::Entity> const& newOwners)
+{
+	n_assert(offset + newOwners.Size() <= (uint)this->NumRegistered());
+	IndexT i;
+	for (i = 0; i < newOwners.Size(); i++)
+		this->SetOwner(offset + i, newOwners[i]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::SerializeOwners(const Ptr<IO::BinaryWriter>& writer) const
+{
+	Game::Serialize(writer, this->GetOwners());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::DeserializeOwners(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances)
+{
+	Util::Array<Game::Entity> newOwners;
+	newOwners.SetSize(numInstances);
+	Game::Deserialize(reader, newOwners, 0, numInstances);
+	this->SetOwners(offset, newOwners);
+}
+
+//------------------------------------------------------------------------------
+/**
+	Writes the same layout as Game::Component, one array per attribute.
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::Serialize(const Ptr<IO::BinaryWriter>& writer) const
+{
+	(this->template SerializeAttribute<TYPES>(writer), ...);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+inline void
+ArchetypeComponent<TYPES...>::Deserialize(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances)
+{
+	(this->template DeserializeAttribute<TYPES>(reader, offset, numInstances), ...);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+template <typename ATTR>
+inline void
+ArchetypeComponent<TYPES...>::SerializeAttribute(const Ptr<IO::BinaryWriter>& writer) const
+{
+	const SizeT num = this->NumRegistered();
+	Util::Array<typename ATTR::InnerType> column;
+	column.SetSize(num);
+	IndexT i;
+	for (i = 0; i < num; i++)
+		column[i] = this->storage.template Get<ATTR>(this->archetype, i);
+	Game::Serialize(writer, column);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <class ... TYPES>
+template <typename ATTR>
+inline void
+ArchetypeComponent<TYPES...>::DeserializeAttribute(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances)
+{
+	n_assert(offset + numInstances <= (uint)this->NumRegistered());
+	Util::Array<typename ATTR::InnerType> column;
+	column.SetSize(numInstances);
+	Game::Deserialize(reader, column, 0, numInstances);
+	IndexT i;
+	for (i = 0; i < (IndexT)numInstances; i++)
+		this->Get<ATTR>(offset + i) = column[i];
+}
+
+} // namespace Game
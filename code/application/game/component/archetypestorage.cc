@@ -0,0 +1,455 @@
+//------------------------------------------------------------------------------
+//  archetypestorage.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "archetypestorage.h"
+
+namespace Game
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+ArchetypeStorage::ArchetypeStorage() :
+	numEntities(0)
+{
+	// empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ArchetypeStorage::~ArchetypeStorage()
+{
+	this->Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+	Columns are sorted by fourcc, so the same set of attributes always
+	results in the same archetype regardless of template argument order.
+	Column offsets are computed so that the owners and all columns fit in
+	a single chunk, with every column aligned to 16 bytes.
+*/
+ArchetypeId
+ArchetypeStorage::FindOrCreateArchetype(Util::Array<Column>& columns)
+{
+	columns.SortWithFunc([](const Column& a, const Column& b) { return a.fourcc < b.fourcc; });
+
+	IndexT i;
+	for (i = 0; i < this->archetypes.Size(); i++)
+	{
+		const Util::Array<Column>& other = this->archetypes[i].columns;
+		if (other.Size() != columns.Size())
+			continue;
+
+		bool equal = true;
+		IndexT j;
+		for (j = 0; j < columns.Size() && equal; j++)
+			equal = other[j].fourcc == columns[j].fourcc;
+
+		if (equal)
+			return ArchetypeId(i);
+	}
+
+	// calculate how many rows fit in a chunk, reserving padding for each column
+	SizeT rowSize = sizeof(Entity);
+	SizeT padding = 0;
+	for (i = 0; i < columns.Size(); i++)
+	{
+		n_assert2(columns[i].alignment <= 16, "Attributes with alignment above 16 bytes are not supported by the archetype storage!");
+		n_assert2(i == 0 || columns[i - 1].fourcc != columns[i].fourcc, "Archetype contains the same attribute more than once!");
+		rowSize += columns[i].byteSize;
+		padding += 16;
+	}
+	n_assert2(rowSize + padding <= ChunkByteSize, "Archetype row size exceeds chunk size!");
+	const SizeT capacity = (ChunkByteSize - padding) / rowSize;
+
+	SizeT offset = Math::n_align(sizeof(Entity) * capacity, 16);
+	for (i = 0; i < columns.Size(); i++)
+	{
+		columns[i].offset = offset;
+		offset = Math::n_align(offset + columns[i].byteSize * capacity, 16);
+	}
+	n_assert(offset <= ChunkByteSize);
+
+	Archetype archetype;
+	archetype.columns = columns;
+	archetype.capacity = capacity;
+	archetype.count = 0;
+	this->archetypes.Append(archetype);
+	return ArchetypeId(this->archetypes.Size() - 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+IndexT
+ArchetypeStorage::FindColumn(const Archetype& archetype, Util::FourCC fourcc)
+{
+	// archetypes rarely have more than a handful of columns, a linear search is fastest
+	IndexT i;
+	for (i = 0; i < archetype.columns.Size(); i++)
+	{
+		if (archetype.columns[i].fourcc == fourcc)
+			return i;
+	}
+	return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorage::AllocateRow(Archetype& archetype, uint& chunk, uint& row)
+{
+	chunk = archetype.count / archetype.capacity;
+	row = archetype.count % archetype.capacity;
+	if (chunk == (uint)archetype.chunks.Size())
+		archetype.chunks.Append((ubyte*)Memory::Alloc(Memory::ObjectArrayHeap, ChunkByteSize));
+	archetype.count++;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorage::EraseRowSwap(Archetype& archetype, uint chunk, uint row)
+{
+	n_assert(archetype.count > 0);
+	const uint lastChunk = (archetype.count - 1) / archetype.capacity;
+	const uint lastRow = (archetype.count - 1) % archetype.capacity;
+	ubyte* dst = archetype.chunks[chunk];
+	ubyte* src = archetype.chunks[lastChunk];
+
+	IndexT i;
+	if (chunk != lastChunk || row != lastRow)
+	{
+		for (i = 0; i < archetype.columns.Size(); i++)
+			archetype.columns[i].move(Value(dst, archetype.columns[i], row), Value(src, archetype.columns[i], lastRow));
+
+		// rows allocated with Allocate may not have an owner yet
+		const Entity moved = Owners(src)[lastRow];
+		Owners(dst)[row] = moved;
+		if (moved != Entity::Invalid())
+		{
+			EntityLocation& location = this->locations[Ids::Index(moved.id)];
+			location.chunk = chunk;
+			location.row = row;
+		}
+	}
+
+	for (i = 0; i < archetype.columns.Size(); i++)
+		archetype.columns[i].destruct(Value(src, archetype.columns[i], lastRow), 1);
+
+	archetype.count--;
+
+	// release the last chunk once it's empty
+	if (lastRow == 0)
+	{
+		Memory::Free(Memory::ObjectArrayHeap, archetype.chunks.Back());
+		archetype.chunks.EraseBack();
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ArchetypeStorage::EntityLocation&
+ArchetypeStorage::AllocateLocation(Entity e)
+{
+	const IndexT index = Ids::Index(e.id);
+	if (index >= this->locations.Size())
+	{
+		const SizeT oldSize = this->locations.Size();
+		const SizeT newSize = Math::n_max(index + 1, oldSize * 2);
+		this->locations.SetSize(newSize);
+		this->locations.Fill(oldSize, newSize - oldSize, { Entity::Invalid(), ArchetypeId::Invalid(), 0, 0 });
+	}
+	return this->locations[index];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const ArchetypeStorage::EntityLocation*
+ArchetypeStorage::FindLocation(Entity e) const
+{
+	const IndexT index = Ids::Index(e.id);
+	if (index >= this->locations.Size())
+		return nullptr;
+	const EntityLocation& location = this->locations[index];
+	if (location.entity != e || location.archetype == ArchetypeId::Invalid())
+		return nullptr;
+	return &location;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorage::AddEntity(Entity e, ArchetypeId archetypeId)
+{
+	n_assert2(!this->HasEntity(e), "Entity is already stored in this archetype storage!");
+	n_assert(archetypeId.id < (uint)this->archetypes.Size());
+
+	Archetype& archetype = this->archetypes[archetypeId.id];
+	EntityLocation& location = this->AllocateLocation(e);
+	location.entity = e;
+	location.archetype = archetypeId;
+	this->AllocateRow(archetype, location.chunk, location.row);
+
+	ubyte* chunk = archetype.chunks[location.chunk];
+	Owners(chunk)[location.row] = e;
+	IndexT i;
+	for (i = 0; i < archetype.columns.Size(); i++)
+		archetype.columns[i].construct(Value(chunk, archetype.columns[i], location.row), 1);
+
+	this->numEntities++;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorage::RemoveEntity(Entity e)
+{
+	const EntityLocation* found = this->FindLocation(e);
+	n_assert2(found != nullptr, "Entity is not stored in this archetype storage!");
+	EntityLocation& location = this->locations[Ids::Index(e.id)];
+
+	this->EraseRowSwap(this->archetypes[location.archetype.id], location.chunk, location.row);
+	location.entity = Entity::Invalid();
+	location.archetype = ArchetypeId::Invalid();
+	this->numEntities--;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Attributes that exist in both archetypes are moved, attributes only
+	present in the new archetype are default constructed.
+*/
+void
+ArchetypeStorage::MoveEntity(Entity e, ArchetypeId archetypeId)
+{
+	const EntityLocation* found = this->FindLocation(e);
+	n_assert2(found != nullptr, "Entity is not stored in this archetype storage!");
+	n_assert(archetypeId.id < (uint)this->archetypes.Size());
+	EntityLocation& location = this->locations[Ids::Index(e.id)];
+	if (location.archetype == archetypeId)
+		return;
+
+	Archetype& from = this->archetypes[location.archetype.id];
+	Archetype& to = this->archetypes[archetypeId.id];
+	const uint fromChunk = location.chunk;
+	const uint fromRow = location.row;
+
+	uint toChunk, toRow;
+	this->AllocateRow(to, toChunk, toRow);
+	ubyte* src = from.chunks[fromChunk];
+	ubyte* dst = to.chunks[toChunk];
+	Owners(dst)[toRow] = e;
+
+	IndexT i;
+	for (i = 0; i < to.columns.Size(); i++)
+	{
+		void* value = Value(dst, to.columns[i], toRow);
+		to.columns[i].construct(value, 1);
+		IndexT column = FindColumn(from, to.columns[i].fourcc);
+		if (column != InvalidIndex)
+			to.columns[i].move(value, Value(src, from.columns[column], fromRow));
+	}
+
+	// this may move another entity into the old slot, so update our location afterwards
+	this->EraseRowSwap(from, fromChunk, fromRow);
+	location.archetype = archetypeId;
+	location.chunk = toChunk;
+	location.row = toRow;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ArchetypeStorage::HasEntity(Entity e) const
+{
+	return this->FindLocation(e) != nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ArchetypeId
+ArchetypeStorage::GetArchetype(Entity e) const
+{
+	const EntityLocation* location = this->FindLocation(e);
+	return location != nullptr ? location->archetype : ArchetypeId::Invalid();
+}
+
+//------------------------------------------------------------------------------
+/**
+	The rows have no owner until SetOwner is called, which lets a level
+	loader fill in attribute values before entities exist.
+*/
+IndexT
+ArchetypeStorage::Allocate(ArchetypeId archetypeId, SizeT num)
+{
+	n_assert(archetypeId.id < (uint)this->archetypes.Size());
+	Archetype& archetype = this->archetypes[archetypeId.id];
+	const IndexT first = archetype.count;
+
+	IndexT i;
+	for (i = 0; i < num; i++)
+	{
+		uint chunkIndex, row;
+		this->AllocateRow(archetype, chunkIndex, row);
+		ubyte* chunk = archetype.chunks[chunkIndex];
+		Owners(chunk)[row] = Entity::Invalid();
+		IndexT column;
+		for (column = 0; column < archetype.columns.Size(); column++)
+			archetype.columns[column].construct(Value(chunk, archetype.columns[column], row), 1);
+	}
+	this->numEntities += num;
+	return first;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorage::EraseIndexSwap(ArchetypeId archetypeId, IndexT index)
+{
+	Archetype& archetype = this->archetypes[archetypeId.id];
+	n_assert(index >= 0 && index < archetype.count);
+	const uint chunk = index / archetype.capacity;
+	const uint row = index % archetype.capacity;
+
+	const Entity owner = Owners(archetype.chunks[chunk])[row];
+	if (owner != Entity::Invalid())
+	{
+		EntityLocation& location = this->locations[Ids::Index(owner.id)];
+		location.entity = Entity::Invalid();
+		location.archetype = ArchetypeId::Invalid();
+	}
+	this->EraseRowSwap(archetype, chunk, row);
+	this->numEntities--;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+IndexT
+ArchetypeStorage::GetIndex(Entity e) const
+{
+	const EntityLocation* location = this->FindLocation(e);
+	if (location == nullptr)
+		return InvalidIndex;
+	return location->chunk * this->archetypes[location->archetype.id].capacity + location->row;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Entity
+ArchetypeStorage::GetOwner(ArchetypeId archetypeId, IndexT index) const
+{
+	const Archetype& archetype = this->archetypes[archetypeId.id];
+	n_assert(index >= 0 && index < archetype.count);
+	return Owners(archetype.chunks[index / archetype.capacity])[index % archetype.capacity];
+}
+
+//------------------------------------------------------------------------------
+/**
+	An entity can only own one row, so if it already owns another row
+	that row is left without an owner.
+*/
+void
+ArchetypeStorage::SetOwner(ArchetypeId archetypeId, IndexT index, Entity e)
+{
+	Archetype& archetype = this->archetypes[archetypeId.id];
+	n_assert(index >= 0 && index < archetype.count);
+	const uint chunk = index / archetype.capacity;
+	const uint row = index % archetype.capacity;
+	Entity* owners = Owners(archetype.chunks[chunk]);
+
+	const Entity previous = owners[row];
+	if (previous != Entity::Invalid())
+	{
+		EntityLocation& location = this->locations[Ids::Index(previous.id)];
+		location.entity = Entity::Invalid();
+		location.archetype = ArchetypeId::Invalid();
+	}
+
+	owners[row] = e;
+	if (e != Entity::Invalid())
+	{
+		const EntityLocation* found = this->FindLocation(e);
+		if (found != nullptr)
+		{
+			const Archetype& other = this->archetypes[found->archetype.id];
+			Owners(other.chunks[found->chunk])[found->row] = Entity::Invalid();
+		}
+		EntityLocation& location = this->AllocateLocation(e);
+		location.entity = e;
+		location.archetype = archetypeId;
+		location.chunk = chunk;
+		location.row = row;
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+ArchetypeStorage::NumEntities() const
+{
+	return this->numEntities;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+ArchetypeStorage::NumEntities(ArchetypeId archetype) const
+{
+	return this->archetypes[archetype.id].count;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+ArchetypeStorage::ChunkCapacity(ArchetypeId archetype) const
+{
+	return this->archetypes[archetype.id].capacity;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorage::Clear()
+{
+	IndexT i;
+	for (i = 0; i < this->archetypes.Size(); i++)
+	{
+		Archetype& archetype = this->archetypes[i];
+		IndexT chunkIndex;
+		for (chunkIndex = 0; chunkIndex < archetype.chunks.Size(); chunkIndex++)
+		{
+			ubyte* chunk = archetype.chunks[chunkIndex];
+			const SizeT num = chunkIndex == archetype.chunks.Size() - 1 ? archetype.count - chunkIndex * archetype.capacity : archetype.capacity;
+			IndexT column;
+			for (column = 0; column < archetype.columns.Size(); column++)
+				archetype.columns[column].destruct(chunk + archetype.columns[column].offset, num);
+			Memory::Free(Memory::ObjectArrayHeap, chunk);
+		}
+		archetype.chunks.Clear();
+		archetype.count = 0;
+	}
+	this->locations.Clear();
+	this->numEntities = 0;
+}
+
+} // namespace Game
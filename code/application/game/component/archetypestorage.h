@@ -0,0 +1,352 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	@class Game::ArchetypeStorage
+
+	Chunked archetype storage for entity attributes.
+
+	Game::Component keeps every component in its own structure of arrays with
+	a hash table from entity to instance, which means a system that touches
+	several components of an entity pays for one lookup and one random access
+	per component. The archetype storage is an alternative for such systems.
+
+	An archetype is a set of attributes. All entities with the same set of
+	attributes are stored together in fixed size chunks, where each chunk
+	contains the owners followed by one tightly packed array per attribute.
+	Chunks are always kept dense; removing an entity moves the last entity of
+	the archetype into its slot.
+
+	Queries iterate all chunks of every archetype that contains the requested
+	attributes, and hand the callback contiguous arrays:
+
+		storage.ForEachChunk<Attr::WorldTransform, Attr::GraphicsEntity>(
+			[](SizeT num, const Game::Entity* owners, Math::matrix44* transforms, uint* gfxEntities)
+			{
+				...
+			});
+
+	Attributes are the same attribute types as used by Game::Component, so
+	they are declared in NIDL files as usual.
+
+	Within an archetype, every entity also has a dense index, the chunk
+	times the chunk capacity plus the row. Game::ArchetypeComponent uses
+	it as the instance id, so a component can keep its instances in an
+	archetype storage. Rows can be allocated before their owner is known.
+	@see	Game::ArchetypeComponent
+
+	(C) 2020 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "game/entity.h"
+#include "ids/id.h"
+#include "ids/idgenerationpool.h"
+#include "util/array.h"
+#include "util/fourcc.h"
+#include "memory/memory.h"
+#include <new>
+#include <utility>
+
+namespace Game
+{
+
+ID_32_TYPE(ArchetypeId);
+
+class ArchetypeStorage
+{
+public:
+	/// byte size of each chunk
+	static const SizeT ChunkByteSize = 16 * 1024;
+
+	/// constructor
+	ArchetypeStorage();
+	/// destructor
+	~ArchetypeStorage();
+
+	/// Create an archetype from a set of attributes. Returns the existing archetype if the set already exists.
+	template <typename ... ATTRS>
+	ArchetypeId CreateArchetype();
+
+	/// Add an entity to an archetype. All attributes are set to their default values.
+	void AddEntity(Entity e, ArchetypeId archetype);
+	/// Remove an entity. The last entity of the archetype is moved into its place.
+	void RemoveEntity(Entity e);
+	/// Move an entity to another archetype, keeping the values of attributes that exist in both
+	void MoveEntity(Entity e, ArchetypeId archetype);
+	/// Returns true if the entity is stored
+	bool HasEntity(Entity e) const;
+	/// Returns the archetype of an entity
+	ArchetypeId GetArchetype(Entity e) const;
+
+	/// Allocate rows at the end of an archetype, without owners and with default values. Returns the index of the first row
+	IndexT Allocate(ArchetypeId archetype, SizeT num);
+	/// Remove the row at index, the last row of the archetype is moved into its place
+	void EraseIndexSwap(ArchetypeId archetype, IndexT index);
+	/// Returns the index of an entity within its archetype, or InvalidIndex if it's not stored
+	IndexT GetIndex(Entity e) const;
+	/// Returns the owner of the row at index, Entity::Invalid() if it has none
+	Entity GetOwner(ArchetypeId archetype, IndexT index) const;
+	/// Set the owner of the row at index, the previous owner is no longer stored
+	void SetOwner(ArchetypeId archetype, IndexT index, Entity e);
+
+	/// Returns true if the entity has a specific attribute
+	template <typename ATTR>
+	bool Has(Entity e) const;
+	/// Get an attribute value of an entity
+	template <typename ATTR>
+	typename ATTR::InnerType& Get(Entity e);
+	/// Get an attribute value of the row at index
+	template <typename ATTR>
+	typename ATTR::InnerType& Get(ArchetypeId archetype, IndexT index);
+	/// Get an attribute value of the row at index
+	template <typename ATTR>
+	const typename ATTR::InnerType& Get(ArchetypeId archetype, IndexT index) const;
+
+	/// Call func(SizeT num, const Entity* owners, ATTRS::InnerType*...) once for every chunk of every archetype containing all ATTRS
+	template <typename ... ATTRS, typename FUNC>
+	void ForEachChunk(FUNC&& func);
+
+	/// Returns the total amount of stored entities
+	SizeT NumEntities() const;
+	/// Returns the amount of entities in an archetype
+	SizeT NumEntities(ArchetypeId archetype) const;
+	/// Returns the number of entities that fit in a single chunk of an archetype
+	SizeT ChunkCapacity(ArchetypeId archetype) const;
+
+	/// Remove all entities and free all chunks. Archetypes are kept.
+	void Clear();
+
+private:
+	/// Type erased description of an attribute column
+	struct Column
+	{
+		Util::FourCC fourcc;
+		SizeT byteSize;
+		SizeT alignment;
+		/// offset of the column within a chunk
+		SizeT offset;
+		/// construct num default values
+		void(*construct)(void* dst, SizeT num);
+		/// destruct num values
+		void(*destruct)(void* dst, SizeT num);
+		/// move assign a single value
+		void(*move)(void* dst, void* src);
+	};
+
+	struct Archetype
+	{
+		/// columns sorted by fourcc
+		Util::Array<Column> columns;
+		/// chunk memory, only the last chunk may be partially filled
+		Util::Array<ubyte*> chunks;
+		/// number of entities that fit in a chunk
+		SizeT capacity;
+		/// total number of entities
+		SizeT count;
+	};
+
+	struct EntityLocation
+	{
+		Entity entity;
+		ArchetypeId archetype;
+		uint chunk;
+		uint row;
+	};
+
+	/// Make a column description for an attribute type
+	template <typename ATTR>
+	static Column MakeColumn();
+	/// Find an existing archetype with exactly these columns, or create a new one
+	ArchetypeId FindOrCreateArchetype(Util::Array<Column>& columns);
+	/// Find a column by fourcc, returns InvalidIndex if not found
+	static IndexT FindColumn(const Archetype& archetype, Util::FourCC fourcc);
+	/// Allocate a row at the end of an archetype, values are left unconstructed
+	void AllocateRow(Archetype& archetype, uint& chunk, uint& row);
+	/// Remove a row by moving the last row into it. Destroys the values of the removed row.
+	void EraseRowSwap(Archetype& archetype, uint chunk, uint row);
+	/// Returns the location slot of an entity, growing the location table if needed
+	EntityLocation& AllocateLocation(Entity e);
+	/// Returns the location of an entity, or nullptr if it's not stored
+	const EntityLocation* FindLocation(Entity e) const;
+	/// Call a chunk query callback with the column pointers of a chunk
+	template <typename ... ATTRS, typename FUNC, std::size_t ... INDICES>
+	static void InvokeChunk(FUNC& func, SizeT num, ubyte* chunk, const SizeT* offsets, std::index_sequence<INDICES...>);
+
+	/// Returns the owner array of a chunk
+	static Entity* Owners(ubyte* chunk);
+	/// Returns a value within a chunk
+	static void* Value(ubyte* chunk, const Column& column, uint row);
+
+	Util::Array<Archetype> archetypes;
+	/// indexed by entity index
+	Util::Array<EntityLocation> locations;
+	SizeT numEntities;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ATTR>
+inline ArchetypeStorage::Column
+ArchetypeStorage::MakeColumn()
+{
+	using T = typename ATTR::InnerType;
+	Column column;
+	column.fourcc = ATTR::FourCC();
+	column.byteSize = sizeof(T);
+	column.alignment = alignof(T);
+	column.offset = 0;
+	column.construct = [](void* dst, SizeT num)
+	{
+		T* values = (T*)dst;
+		for (IndexT i = 0; i < num; i++)
+			::new (values + i) T(ATTR::DefaultValue());
+	};
+	column.destruct = [](void* dst, SizeT num)
+	{
+		T* values = (T*)dst;
+		for (IndexT i = 0; i < num; i++)
+			values[i].~T();
+	};
+	column.move = [](void* dst, void* src)
+	{
+		*(T*)dst = std::move(*(T*)src);
+	};
+	return column;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ... ATTRS>
+inline ArchetypeId
+ArchetypeStorage::CreateArchetype()
+{
+	Util::Array<Column> columns = { MakeColumn<ATTRS>()... };
+	return this->FindOrCreateArchetype(columns);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Entity*
+ArchetypeStorage::Owners(ubyte* chunk)
+{
+	return (Entity*)chunk;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void*
+ArchetypeStorage::Value(ubyte* chunk, const Column& column, uint row)
+{
+	return chunk + column.offset + (SizeT)row * column.byteSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ATTR>
+inline bool
+ArchetypeStorage::Has(Entity e) const
+{
+	const EntityLocation* location = this->FindLocation(e);
+	if (location == nullptr)
+		return false;
+	return FindColumn(this->archetypes[location->archetype.id], ATTR::FourCC()) != InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ATTR>
+inline typename ATTR::InnerType&
+ArchetypeStorage::Get(Entity e)
+{
+	const EntityLocation* location = this->FindLocation(e);
+	n_assert2(location != nullptr, "Entity is not stored in this archetype storage!");
+	const Archetype& archetype = this->archetypes[location->archetype.id];
+	IndexT column = FindColumn(archetype, ATTR::FourCC());
+	n_assert2(column != InvalidIndex, "Entity does not have this attribute!");
+	return *(typename ATTR::InnerType*)Value(archetype.chunks[location->chunk], archetype.columns[column], location->row);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ATTR>
+inline typename ATTR::InnerType&
+ArchetypeStorage::Get(ArchetypeId archetypeId, IndexT index)
+{
+	const Archetype& archetype = this->archetypes[archetypeId.id];
+	n_assert(index >= 0 && index < archetype.count);
+	IndexT column = FindColumn(archetype, ATTR::FourCC());
+	n_assert2(column != InvalidIndex, "Archetype does not have this attribute!");
+	return *(typename ATTR::InnerType*)Value(archetype.chunks[index / archetype.capacity], archetype.columns[column], index % archetype.capacity);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ATTR>
+inline const typename ATTR::InnerType&
+ArchetypeStorage::Get(ArchetypeId archetypeId, IndexT index) const
+{
+	return const_cast<ArchetypeStorage*>(this)->Get<ATTR>(archetypeId, index);
+}
+
+//------------------------------------------------------------------------------
+/**
+	Archetypes are matched once per query, after that each chunk is a
+	linear sweep over tightly packed arrays.
+*/
+template <typename ... ATTRS, typename FUNC>
+inline void
+ArchetypeStorage::ForEachChunk(FUNC&& func)
+{
+	constexpr SizeT numAttrs = sizeof...(ATTRS);
+	static_assert(numAttrs > 0, "A chunk query needs at least one attribute");
+	const Util::FourCC fourccs[] = { Util::FourCC(ATTRS::FourCC())... };
+
+	IndexT archetypeIndex;
+	for (archetypeIndex = 0; archetypeIndex < this->archetypes.Size(); archetypeIndex++)
+	{
+		Archetype& archetype = this->archetypes[archetypeIndex];
+		if (archetype.count == 0)
+			continue;
+
+		// find the column of every requested attribute
+		SizeT offsets[numAttrs];
+		bool match = true;
+		IndexT i;
+		for (i = 0; i < numAttrs && match; i++)
+		{
+			IndexT column = FindColumn(archetype, fourccs[i]);
+			match = column != InvalidIndex;
+			if (match)
+				offsets[i] = archetype.columns[column].offset;
+		}
+		if (!match)
+			continue;
+
+		IndexT chunkIndex;
+		for (chunkIndex = 0; chunkIndex < archetype.chunks.Size(); chunkIndex++)
+		{
+			ubyte* chunk = archetype.chunks[chunkIndex];
+			const SizeT num = chunkIndex == archetype.chunks.Size() - 1 ? archetype.count - chunkIndex * archetype.capacity : archetype.capacity;
+			InvokeChunk<ATTRS...>(func, num, chunk, offsets, std::make_index_sequence<numAttrs>());
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename ... ATTRS, typename FUNC, std::size_t ... INDICES>
+inline void
+ArchetypeStorage::InvokeChunk(FUNC& func, SizeT num, ubyte* chunk, const SizeT* offsets, std::index_sequence<INDICES...>)
+{
+	func(num, (const Entity*)Owners(chunk), (typename ATTRS::InnerType*)(chunk + offsets[INDICES])...);
+}
+
+} // namespace Game
@@ -13,6 +13,7 @@
 */
 //-----------------------------------------------------------------------------
 #include "util/hashtable.h"
+#include "util/flathashtable.h"
 #include "util/stack.h"
 #include "ids/id.h"
 #include "util/random.h"
@@ -256,10 +257,8 @@ private:
 	/// contains free id's that we reuse as soon as possible.
 	Util::Array<InstanceId> freeIds;
 
-	const static int STACK_SIZE = 1;
-	const static int TABLE_SIZE = 1024;
 	/// Contains the link between InstanceData and Entity Id
-	Util::HashTable<Ids::Id32, InstanceId, TABLE_SIZE, STACK_SIZE> idMap;
+	Util::FlatHashTable<Ids::Id32, InstanceId> idMap;
 };
 
 //------------------------------------------------------------------------------
@@ -793,7 +792,7 @@ Component<TYPES ...>::DeregisterAllInactive()
 		Entity e = this->data.Get<0>(i);
 		if (!manager->IsAlive(e))
 		{
-			this->freeIds.InsertSorted(this->idMap.ValueAtIndex(e.id, i));
+			this->freeIds.InsertSorted(this->idMap[e.id]);
 			this->idMap.Erase(e.id);
 		}
 	}
@@ -6,6 +6,7 @@
 #include "componentinterface.h"
 #include "io/binaryreader.h"
 #include "io/binarywriter.h"
+#include "basegamefeature/managers/componentmanager.h"
 
 namespace Game
 {
@@ -16,6 +17,7 @@ namespace Game
 ComponentInterface::ComponentInterface()
 {
 	this->enabled = true;
+	this->frameAccessDeclared = false;
 
 	this->functions.OnActivate = nullptr;
 	this->functions.OnDeactivate = nullptr;
@@ -102,6 +104,59 @@ ComponentInterface::Enabled() const
 	return this->enabled;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ComponentInterface::DeclareFrameAccess(const Util::Array<Util::FourCC>& reads, const Util::Array<Util::FourCC>& writes)
+{
+	this->frameReads = reads;
+	this->frameWrites = writes;
+	this->frameReads.Sort();
+	this->frameWrites.Sort();
+	this->frameAccessDeclared = true;
+
+	// the component may have been scheduled already
+	if (ComponentManager::HasInstance())
+		ComponentManager::Instance()->InvalidateSchedules();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ComponentInterface::HasDeclaredFrameAccess() const
+{
+	return this->frameAccessDeclared;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Two components conflict if either one writes an attribute the other reads or writes.
+	Components without declared access conflict with everything.
+*/
+bool
+ComponentInterface::ConflictsWith(const ComponentInterface* other) const
+{
+	if (!this->frameAccessDeclared || !other->frameAccessDeclared)
+		return true;
+
+	IndexT i;
+	for (i = 0; i < this->frameWrites.Size(); i++)
+	{
+		const Util::FourCC attr = this->frameWrites[i];
+		if (other->frameWrites.BinarySearchIndex(attr) != InvalidIndex ||
+			other->frameReads.BinarySearchIndex(attr) != InvalidIndex)
+			return true;
+	}
+	for (i = 0; i < other->frameWrites.Size(); i++)
+	{
+		if (this->frameReads.BinarySearchIndex(other->frameWrites[i]) != InvalidIndex)
+			return true;
+	}
+	return false;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
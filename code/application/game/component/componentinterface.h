@@ -25,6 +25,17 @@
 	to messages with delegates.
 	@see	game/messaging/message.h
 
+	A component can declare which attributes its OnBeginFrame and OnEndFrame
+	callbacks read and write by calling DeclareFrameAccess. By doing so, the
+	component promises that its frame callbacks, and its garbage collection,
+	only touch those attributes and its own data, which allows the component
+	manager to run it in parallel with other components it does not conflict with.
+	State outside of attributes which is shared between components, like a
+	graphics context, is declared with a fourcc naming it, see
+	GraphicsComponent.
+	Components that don't declare their access are always run exclusively on
+	the game thread.
+
 	(C) 2018-2020 Individual contributors, see AUTHORS file
 */
 //------------------------------------------------------------------------------
@@ -150,6 +161,15 @@ public:
 	/// Returns whether a component container is enabled.
 	bool Enabled() const;
 
+	/// Declare the attributes read and written by the frame callbacks. Marks the component as safe to run in parallel.
+	void DeclareFrameAccess(const Util::Array<Util::FourCC>& reads, const Util::Array<Util::FourCC>& writes);
+
+	/// Returns true if the component has declared its frame access
+	bool HasDeclaredFrameAccess() const;
+
+	/// Returns true if the frame callbacks of this and another component must not run concurrently
+	bool ConflictsWith(const ComponentInterface* other) const;
+
 	struct FunctionBundle
 	{
 		/// Called upon activation of component instance.
@@ -183,6 +203,7 @@ public:
 		void(*Serialize)(const Ptr<IO::BinaryWriter>& writer);
 
 		/// Deserialize the components attributes (excluding owners)
+		/// Must only write to the component's own storage, since components are deserialized concurrently when loading levels.
 		void(*Deserialize)(const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances);
 
 		/// Destroy all instances
@@ -221,6 +242,15 @@ protected:
 
 	/// Identifier
 	Util::FourCC fourcc;
+
+	/// Attributes read by the frame callbacks
+	Util::Array<Util::FourCC> frameReads;
+
+	/// Attributes written by the frame callbacks
+	Util::Array<Util::FourCC> frameWrites;
+
+	/// True if frameReads and frameWrites has been declared
+	bool frameAccessDeclared;
 };
 
 } // namespace Game
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "application/stdneb.h"
 #include "game/gameserver.h"
 #include "core/factory.h"
+#include "game/messaging/message.h"
 
 namespace Game
 {
@@ -48,6 +49,7 @@ GameServer::Open()
 {
     n_assert(!this->isOpen);
     n_assert(!this->isStarted);
+    MessageDispatcher::Setup();
     this->isOpen = true;
     return true;
 }
@@ -68,6 +70,7 @@ GameServer::Close()
         this->gameFeatures[0]->OnDeactivate();
         this->gameFeatures.EraseIndex(0);
     }
+    MessageDispatcher::Discard();
     this->isOpen = false;
 }
 
@@ -196,6 +199,9 @@ GameServer::OnEndFrame()
 		this->gameFeatures[i]->OnEndFrame();
 	}
 
+	// dispatch all messages that were batched during this frame
+	MessageDispatcher::DispatchFrameBatches();
+
 	_stop_timer(GameServerOnEndFrame);
 }
 
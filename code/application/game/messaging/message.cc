@@ -4,7 +4,148 @@
 //------------------------------------------------------------------------------
 #include "application/stdneb.h"
 #include "message.h"
-namespace Msg
+#include "jobs/jobs.h"
+#include "system/cpu.h"
+#include "system/systeminfo.h"
+#include "threading/thread.h"
+#include "threading/criticalsection.h"
+
+namespace Game
+{
+
+namespace MessageDispatcher
+{
+
+static Jobs::JobPortId jobPort = Jobs::JobPortId::Invalid();
+static Jobs::JobSyncId jobSync = Jobs::JobSyncId::Invalid();
+static Threading::ThreadId mainThread;
+static Util::Array<void(*)()> frameBatches;
+/// components may batch their first message from a job
+static Threading::CriticalSection frameBatchLock;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+BatchListenerJob(const Jobs::JobFuncContext& ctx)
+{
+	const MessageBatchInvocation* invocations = (const MessageBatchInvocation*)ctx.inputs[0];
+	const SizeT num = ctx.inputSizes[0] / sizeof(MessageBatchInvocation);
+	IndexT i;
+	for (i = 0; i < num; i++)
+		invocations[i].invoke(invocations[i].queue, invocations[i].listener);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Setup()
+{
+	n_assert(jobPort == Jobs::JobPortId::Invalid());
+
+	// leave one core for the main thread, which waits for the listeners anyway
+	SizeT numCores = Core::SysFunc::GetSystemInfo()->GetNumCpuCores();
+	SizeT numThreads = Math::n_max(Math::n_min(numCores - 1, 31), 1);
+	uint affinity = 0;
+	IndexT i;
+	for (i = 0; i < numThreads; i++)
+		affinity |= (uint)System::Cpu::Core1 << i;
+
+	Jobs::CreateJobPortInfo info =
+	{
+		"MessageJobPort",
+		numThreads,
+		affinity,
+		UINT_MAX
+	};
+	jobPort = Jobs::CreateJobPort(info);
+
+	Jobs::CreateJobSyncInfo sinfo =
+	{
+		nullptr
+	};
+	jobSync = Jobs::CreateJobSync(sinfo);
+	mainThread = Threading::Thread::GetMyThreadId();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Discard()
+{
+	n_assert(jobPort != Jobs::JobPortId::Invalid());
+	Jobs::DestroyJobPort(jobPort);
+	Jobs::DestroyJobSync(jobSync);
+	jobPort = Jobs::JobPortId::Invalid();
+	jobSync = Jobs::JobSyncId::Invalid();
+}
+
+//------------------------------------------------------------------------------
+/**
+	There is only one job sync, so parallel dispatch is only done when
+	dispatching from the main thread. Messages dispatched from other
+	threads, or before the dispatcher is set up, call all listeners
+	serially.
+*/
+void
+DispatchParallel(const MessageBatchInvocation* invocations, SizeT num)
 {
+	if (num == 1 || jobPort == Jobs::JobPortId::Invalid() || Threading::Thread::GetMyThreadId() != mainThread)
+	{
+		IndexT i;
+		for (i = 0; i < num; i++)
+			invocations[i].invoke(invocations[i].queue, invocations[i].listener);
+		return;
+	}
+
+	// one listener per slice
+	Jobs::JobContext ctx;
+	ctx.uniform.numBuffers = 0;
+	ctx.uniform.scratchSize = 0;
+
+	ctx.input.numBuffers = 1;
+	ctx.input.data[0] = (void*)invocations;
+	ctx.input.dataSize[0] = sizeof(MessageBatchInvocation) * num;
+	ctx.input.sliceSize[0] = sizeof(MessageBatchInvocation);
+
+	// listeners don't produce any output, but the job system requires matching slices
+	ctx.output.numBuffers = 1;
+	ctx.output.data[0] = (void*)invocations;
+	ctx.output.dataSize[0] = sizeof(MessageBatchInvocation) * num;
+	ctx.output.sliceSize[0] = sizeof(MessageBatchInvocation);
+
+	Jobs::JobId job = Jobs::CreateJob({ BatchListenerJob, "BatchListenerJob" });
+	Jobs::JobSchedule(job, jobPort, ctx);
+	Jobs::JobSyncSignal(jobSync, jobPort);
+	Jobs::JobSyncHostWait(jobSync);
+	Jobs::DestroyJob(job);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+RegisterFrameBatch(void(*dispatch)())
+{
+	frameBatchLock.Enter();
+	frameBatches.Append(dispatch);
+	frameBatchLock.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DispatchFrameBatches()
+{
+	// listeners may batch new message types while we dispatch
+	IndexT i;
+	for (i = 0; i < frameBatches.Size(); i++)
+		frameBatches[i]();
+}
+
+} // namespace MessageDispatcher
 
-} // namespace Msg
+} // namespace Game
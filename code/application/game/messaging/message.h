@@ -11,6 +11,21 @@
 
 	A component can register a message callback by using the __RegisterMsg macro.
 
+	Listeners that handle a lot of messages per frame should be registered as
+	batch listeners using __RegisterBatchMsg instead. A batch listener is called
+	once per dispatched queue with the number of messages and one array per
+	message parameter, instead of once per message. Batch listeners that do not
+	touch any shared state can be registered with __RegisterThreadSafeBatchMsg,
+	in which case they are called in parallel on the message dispatcher's job
+	port. Messages that are sent directly reach batch listeners as batches of
+	a single message, so batch listeners only pay off for messages that are
+	deferred to a message queue or batched.
+
+	Messages sent with Batch are appended to a per frame queue which is
+	dispatched by the game server at the end of the frame, on the main
+	thread, so thread safe batch listeners of batched messages always run
+	in parallel.
+
 	Messages should be generated using Nebula's IDLC.
 	If that's not preferred, you can implement a message by deriving from the
 	Game::Message class and overriding the GetName, GetFourCC, Send and Defer methods.
@@ -54,6 +69,12 @@ class NAME : public Game::Message<NAME, __VA_ARGS__> \
 #define __this_RegisterMsg(MSGTYPE, METHOD) \
 	MSGTYPE::Register(MSGTYPE::Delegate::FromMethod<std::remove_pointer<decltype(this)>::type, &std::remove_pointer<decltype(this)>::type::METHOD>(this))
 
+#define __RegisterBatchMsg(MSGTYPE, FUNCTION) \
+	MSGTYPE::RegisterBatch(MSGTYPE::BatchDelegate::FromFunction<FUNCTION>(), false)
+
+#define __RegisterThreadSafeBatchMsg(MSGTYPE, FUNCTION) \
+	MSGTYPE::RegisterBatch(MSGTYPE::BatchDelegate::FromFunction<FUNCTION>(), true)
+
 /// Removes const reference from T.
 template<class T>
 using UnqualifiedType = typename std::remove_const<typename std::remove_reference<T>::type>::type;
@@ -72,6 +93,36 @@ struct MessageListener
 	MessageListenerId listenerId;
 };
 
+//------------------------------------------------------------------------------
+/**
+	A call to a thread safe batch listener, executed by the MessageDispatcher
+*/
+struct MessageBatchInvocation
+{
+	void(*invoke)(void* queue, IndexT listener);
+	void* queue;
+	IndexT listener;
+};
+
+//------------------------------------------------------------------------------
+/**
+	Runs thread safe batch listeners in parallel and dispatches the per frame
+	message batches. Set up and triggered by the Game::GameServer.
+*/
+namespace MessageDispatcher
+{
+/// create the job port used for parallel dispatch
+void Setup();
+/// destroy the job port
+void Discard();
+/// execute invocations, in parallel if possible. Returns when all invocations are done.
+void DispatchParallel(const MessageBatchInvocation* invocations, SizeT num);
+/// register a function that dispatches a message type's frame batch, called once per message type
+void RegisterFrameBatch(void(*dispatch)());
+/// dispatch all per frame message batches
+void DispatchFrameBatches();
+} // namespace MessageDispatcher
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -166,18 +217,30 @@ public:
 	/// Type definition for this message's delegate
 	using Delegate = Util::Delegate<void(TYPES...)>;
 
+	/// Type definition for this message's batch delegate, which receives the amount of messages and one array per parameter
+	using BatchDelegate = Util::Delegate<void(SizeT, UnqualifiedType<TYPES> const*...)>;
+
     /// Type definition for this message's queues
     using MessageQueue = typename Util::ArrayAllocator<UnqualifiedType<TYPES> ...>;
 
 	/// Register a listener to this message. Returns an ID for the listener so that we can associate it.
 	static MessageListener Register(Delegate&& callback);
 
+	/// Register a batch listener. Thread safe listeners may be called from worker threads, concurrently with other thread safe listeners.
+	static MessageListener RegisterBatch(BatchDelegate&& callback, bool threadSafe);
+
 	/// Deregister a listener
 	static void Deregister(MessageListener listener);
 
 	/// Send a message
 	static void Send(TYPES ... values);
 
+	/// Add a message to the per frame batch, which is dispatched at the end of the frame. Must not be called concurrently for the same message type.
+	static void Batch(TYPES ... values);
+
+	/// Dispatch all messages in the per frame batch
+	static void DispatchBatch();
+
 	/// Creates a new message queue for deferred dispatching
 	static MessageQueueId AllocateMessageQueue();
 
@@ -226,6 +289,23 @@ protected:
 		Delegate
 	> callbacks;
 
+	/// Registry between batch listener and index in list.
+	Util::HashTable<MessageListenerId, IndexT> batchListenerMap;
+
+	/// contains the batch callbacks, the listener they're attached to and whether they're thread safe
+	Util::ArrayAllocator<
+		MessageListenerId,
+		BatchDelegate,
+		bool
+	> batchCallbacks;
+
+	/// thread safe batch listener calls of the current dispatch
+	Util::Array<MessageBatchInvocation> parallelInvocations;
+
+	/// Per frame message batch
+	MessageQueue frameBatch;
+	bool frameBatchRegistered;
+
 	/// id generation pool for the deferred messages queues.
 	Ids::IdGenerationPool messageQueueIdPool;
 
@@ -243,6 +323,12 @@ protected:
 
 
 private:
+	/// Dispatch all messages in a queue to all listeners and clear it
+	static void Dispatch(MessageQueue& data);
+
+	/// Call a batch listener, used for parallel dispatch
+	static void InvokeBatchListener(void* queue, IndexT listener);
+
 	template<std::size_t...Is>
 	void send_expander(MessageQueue& data, const IndexT cid, const SizeT index, std::index_sequence<Is...>)
 	{
@@ -253,6 +339,17 @@ private:
 	{
 		this->send_expander(data, cid, index, std::make_index_sequence<sizeof...(TYPES)>());
 	}
+
+	template<std::size_t...Is>
+	void batch_expander(MessageQueue& data, const IndexT cid, std::index_sequence<Is...>)
+	{
+		this->batchCallbacks.Get<1>(cid)(data.Size(), data.template GetArray<Is>().Begin()...);
+	}
+
+	void batch_expander(MessageQueue& data, const IndexT cid)
+	{
+		this->batch_expander(data, cid, std::make_index_sequence<sizeof...(TYPES)>());
+	}
 };
 
 //------------------------------------------------------------------------------
@@ -260,7 +357,8 @@ private:
 */
 template <typename MSG, class ... TYPES>
 inline
-Message<MSG, TYPES...>::Message()
+Message<MSG, TYPES...>::Message() :
+	frameBatchRegistered(false)
 {
 	this->name = MSG::GetName();
 	this->fourcc = MSG::GetFourCC();
@@ -292,6 +390,22 @@ Message<MSG, TYPES...>::Register(Delegate&& callback)
 	return listener;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename MSG, class ... TYPES>
+inline MessageListener
+Message<MSG, TYPES...>::RegisterBatch(BatchDelegate&& callback, bool threadSafe)
+{
+	MessageListenerId l;
+	Instance()->listenerPool.Allocate(l.id);
+	IndexT index = Instance()->batchCallbacks.Alloc();
+	Instance()->batchCallbacks.Set(index, l, callback, threadSafe);
+	Instance()->batchListenerMap.Add(l, index);
+	MessageListener listener = { Instance()->fourcc, l };
+	return listener;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -301,6 +415,18 @@ Message<MSG, TYPES...>::Deregister(MessageListener listener)
 {
 	auto instance = Instance();
 	n_assert(listener.messageId == instance->fourcc);
+	if (instance->batchListenerMap.Contains(listener.listenerId))
+	{
+		IndexT index = instance->batchListenerMap[listener.listenerId];
+		instance->batchListenerMap.Erase(listener.listenerId);
+		instance->batchCallbacks.EraseIndexSwap(index);
+		if (index < instance->batchCallbacks.Size())
+		{
+			instance->batchListenerMap[instance->batchCallbacks.template Get<0>(index)] = index;
+		}
+		return;
+	}
+
 	IndexT index = instance->listenerMap[listener.listenerId];
 	if (index != InvalidIndex)
 	{
@@ -315,6 +441,9 @@ Message<MSG, TYPES...>::Deregister(MessageListener listener)
 
 //------------------------------------------------------------------------------
 /**
+	Batch listeners are called with a batch of one message. There is
+	nothing to gain from running a single message in parallel, so thread
+	safe batch listeners are called directly as well.
 */
 template <typename MSG, class ... TYPES>
 inline void
@@ -327,6 +456,12 @@ Message<MSG, TYPES...>::Send(TYPES ... values)
 		// n_assert(instance->callbacks.Get<1>(i).GetObject() != nullptr);
 		instance->callbacks.Get<1>(i)(values...);
 	}
+
+	size = instance->batchCallbacks.Size();
+	for (SizeT i = 0; i < size; ++i)
+	{
+		instance->batchCallbacks.template Get<1>(i)(1, &values...);
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -373,11 +508,56 @@ Message<MSG, TYPES...>::DispatchMessageQueue(MessageQueueId id)
 	n_assert(instance->messageQueues.Size() > Ids::Index(id.id));
 	n_assert(instance->messageQueueIdPool.IsValid(id.id));
 
-	auto& data = instance->messageQueues[Ids::Index(id.id)];
+	Dispatch(instance->messageQueues[Ids::Index(id.id)]);
+}
+
+//------------------------------------------------------------------------------
+/**
+	The first batched message registers the frame batch with the
+	MessageDispatcher, so that message types that are never batched
+	don't cost anything at the end of the frame.
+*/
+template<typename MSG, class ... TYPES>
+inline void
+Message<MSG, TYPES...>::Batch(TYPES ... values)
+{
+	auto instance = Instance();
+	if (!instance->frameBatchRegistered)
+	{
+		MessageDispatcher::RegisterFrameBatch(&Message<MSG, TYPES...>::DispatchBatch);
+		instance->frameBatchRegistered = true;
+	}
+	auto i = instance->frameBatch.Alloc();
+	instance->frameBatch.Set(i, values...);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<typename MSG, class ... TYPES>
+inline void
+Message<MSG, TYPES...>::DispatchBatch()
+{
+	Dispatch(Instance()->frameBatch);
+}
+
+//------------------------------------------------------------------------------
+/**
+	Per message listeners are called once per message, batch listeners once
+	per queue. Thread safe batch listeners are run in parallel after the
+	others are done.
+*/
+template<typename MSG, class ... TYPES>
+inline void
+Message<MSG, TYPES...>::Dispatch(MessageQueue& data)
+{
+	auto instance = Instance();
 
 	SizeT size = data.Size();
-    SizeT cidSize = instance->callbacks.Size();
+	if (size == 0)
+		return;
 
+    SizeT cidSize = instance->callbacks.Size();
     for (SizeT cid = 0; cid < cidSize; ++cid)
     {
 	    for (SizeT i = 0; i < size; i++)
@@ -386,10 +566,42 @@ Message<MSG, TYPES...>::DispatchMessageQueue(MessageQueueId id)
 	    }
     }
 
+	SizeT batchSize = instance->batchCallbacks.Size();
+	for (SizeT cid = 0; cid < batchSize; ++cid)
+	{
+		if (!instance->batchCallbacks.template Get<2>(cid))
+			instance->batch_expander(data, cid);
+	}
+
+	// collect after the serial listeners are done, they might dispatch messages of this type themselves
+	Util::Array<MessageBatchInvocation>& invocations = instance->parallelInvocations;
+	invocations.Clear();
+	batchSize = instance->batchCallbacks.Size();
+	for (SizeT cid = 0; cid < batchSize; ++cid)
+	{
+		if (instance->batchCallbacks.template Get<2>(cid))
+			invocations.Append({ &Message<MSG, TYPES...>::InvokeBatchListener, &data, cid });
+	}
+	if (!invocations.IsEmpty())
+	{
+		MessageDispatcher::DispatchParallel(invocations.Begin(), invocations.Size());
+		invocations.Clear();
+	}
+
 	// TODO:	Should we call reset here instead?
 	data.Clear();
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+template<typename MSG, class ... TYPES>
+inline void
+Message<MSG, TYPES...>::InvokeBatchListener(void* queue, IndexT listener)
+{
+	Instance()->batch_expander(*(MessageQueue*)queue, listener);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -437,9 +649,17 @@ Message<MSG, TYPES...>::DeregisterAll()
 	{
 		instance->listenerPool.Deallocate(instance->callbacks.Get<0>(i).id);
 	}
+	size = instance->batchCallbacks.Size();
+	for (SizeT i = 0; i < size; i++)
+	{
+		instance->listenerPool.Deallocate(instance->batchCallbacks.template Get<0>(i).id);
+	}
 	instance->callbacks.Clear();
+	instance->batchCallbacks.Clear();
 	instance->distributedMessages.Clear();
+	instance->frameBatch.Clear();
 	instance->listenerMap.Clear();	
+	instance->batchListenerMap.Clear();
 }
 
 //------------------------------------------------------------------------------
@@ -20,6 +20,9 @@ namespace GraphicsFeature
 
 static GraphicsComponentAllocator* component;
 
+// the model context isn't an attribute, but has to be declared as a write for the scheduler
+static const Util::FourCC ModelContextAccess('MDLC');
+
 _declare_static_timer(GraphicsComponentOnEndFrame);
 
 __ImplementComponent_woSerialization(GraphicsFeature::GraphicsComponent, component)
@@ -45,6 +48,9 @@ GraphicsComponent::Create()
 	component->functions.OnActivate = OnActivate;
 	component->functions.OnDeactivate = OnDeactivate;
 	component->functions.OnEndFrame = OnEndFrame;
+
+	// OnEndFrame reads world transforms and writes to the model context
+	component->DeclareFrameAccess({ Attr::GraphicsEntity::FourCC(), Attr::WorldTransform::FourCC() }, { ModelContextAccess });
 	__RegisterComponent(component, "GraphicsComponent"_atm);
 
 	SetupAcceptedMessages();
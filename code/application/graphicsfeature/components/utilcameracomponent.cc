@@ -56,6 +56,8 @@ UtilCameraComponent::Create()
 	component->functions.OnActivate = OnActivate;
 	component->functions.OnDeactivate = OnDeactivate;
     component->functions.OnBeginFrame = OnBeginFrame;
+
+	// doesn't declare its frame access, OnBeginFrame reads the input server, which is only valid on the game thread
 	__RegisterComponent(component, "CameraComponent"_atm);
 
 	SetupAcceptedMessages();
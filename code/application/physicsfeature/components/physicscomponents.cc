@@ -41,6 +41,9 @@ ActorComponent::Create()
 	__SetupDefaultComponentBundle(component);
 	component->functions.OnActivate = OnActivate;
 	component->functions.OnDeactivate = OnDeactivate;
+
+	// no frame callbacks, garbage collection only touches the actor ids
+	component->DeclareFrameAccess({}, {});
 	__RegisterComponent(component, "ActorComponent"_atm);
 
 	SetupAcceptedMessages();
@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+//  archetypestoragebenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "archetypestoragebenchmark.h"
+#include "game/component/component.h"
+#include "game/component/archetypestorage.h"
+#include "basegamefeature/components/transformdata.h"
+#include "graphicsfeature/components/graphicsdata.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::ArchetypeStorageBenchmark, 'BMAS', Benchmarking::Benchmark);
+
+using namespace Game;
+
+static const SizeT NumEntities = 1000000;
+static const SizeT NumPasses = 10;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+Print(const char* name, Timing::Time setup, Timing::Time pass)
+{
+    n_printf("    %-26s: setup %7.2f ms, pass %6.2f ms, %5.2f ns/entity\n",
+        name, setup * 1000.0, pass * 1000.0, pass * 1000000000.0 / NumEntities);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArchetypeStorageBenchmark::Run(Timing::Timer& timer)
+{
+    const ComponentCreateInfo info = { true };
+    float checksum = 0.0f;
+    IndexT i, pass;
+
+    // per component storage, every graphics instance looks up the transform of its owner
+    {
+        Component<Attr::WorldTransform>* transforms = n_new(Component<Attr::WorldTransform>(info));
+        Component<Attr::GraphicsEntity>* graphics = n_new(Component<Attr::GraphicsEntity>(info));
+
+        Timing::Time before = timer.GetTime();
+        timer.Start();
+        for (i = 0; i < NumEntities; i++)
+        {
+            const Entity entity = (Ids::Id32)i;
+            transforms->Get<Attr::WorldTransform>(transforms->RegisterEntity(entity)) = Math::matrix44::translation((float)i, 0.0f, 0.0f);
+            graphics->Get<Attr::GraphicsEntity>(graphics->RegisterEntity(entity)) = i;
+        }
+        timer.Stop();
+        const Timing::Time setup = timer.GetTime() - before;
+
+        before = timer.GetTime();
+        timer.Start();
+        for (pass = 0; pass < NumPasses; pass++)
+        {
+            for (i = 0; i < graphics->NumRegistered(); i++)
+            {
+                const uint gfxEntity = graphics->Get<Attr::GraphicsEntity>(i);
+                const InstanceId transform = transforms->GetInstance(graphics->GetOwner(i));
+                checksum += transforms->Get<Attr::WorldTransform>(transform).get_position().x() + gfxEntity;
+            }
+        }
+        timer.Stop();
+        Print("per component lookup", setup, (timer.GetTime() - before) / NumPasses);
+
+        transforms->DestroyAll();
+        graphics->DestroyAll();
+        n_delete(transforms);
+        n_delete(graphics);
+    }
+
+    // archetype storage, both attributes are in the same chunk
+    {
+        ArchetypeStorage* storage = n_new(ArchetypeStorage);
+        const ArchetypeId archetype = storage->CreateArchetype<Attr::WorldTransform, Attr::GraphicsEntity>();
+
+        Timing::Time before = timer.GetTime();
+        timer.Start();
+        for (i = 0; i < NumEntities; i++)
+        {
+            const Entity entity = (Ids::Id32)i;
+            storage->AddEntity(entity, archetype);
+            storage->Get<Attr::WorldTransform>(entity) = Math::matrix44::translation((float)i, 0.0f, 0.0f);
+            storage->Get<Attr::GraphicsEntity>(entity) = i;
+        }
+        timer.Stop();
+        const Timing::Time setup = timer.GetTime() - before;
+
+        before = timer.GetTime();
+        timer.Start();
+        for (pass = 0; pass < NumPasses; pass++)
+        {
+            storage->ForEachChunk<Attr::WorldTransform, Attr::GraphicsEntity>(
+                [&checksum](SizeT num, const Entity* owners, Math::matrix44* transforms, uint* gfxEntities)
+                {
+                    IndexT row;
+                    for (row = 0; row < num; row++)
+                        checksum += transforms[row].get_position().x() + gfxEntities[row];
+                });
+        }
+        timer.Stop();
+        Print("archetype chunk query", setup, (timer.GetTime() - before) / NumPasses);
+
+        n_delete(storage);
+    }
+
+    // keeps the passes from being optimized away
+    n_printf("    checksum %f\n", checksum);
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::ArchetypeStorageBenchmark
+
+    Compares a pass over 1M entities with a world transform and a graphics
+    entity, once through a chunk query on a Game::ArchetypeStorage and once
+    the way GraphicsComponent::OnEndFrame does it, with two Game::Component
+    instances and a transform lookup per graphics instance.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class ArchetypeStorageBenchmark : public Benchmark
+{
+    __DeclareClass(ArchetypeStorageBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
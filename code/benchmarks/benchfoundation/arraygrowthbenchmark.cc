@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+//  arraygrowthbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "arraygrowthbenchmark.h"
+#include "util/array.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::ArrayGrowthBenchmark, 'BMAG', Benchmarking::Benchmark);
+
+using namespace Util;
+
+static const SizeT NumSizes = 4;
+static const SizeT Sizes[NumSizes] = { 10000, 100000, 1000000, 10000000 };
+
+/// the growth step of the old Array::Grow()
+static const SizeT OldMinGrowSize = 16;
+static const SizeT OldMaxGrowSize = 65536;
+
+enum Growth
+{
+    OldGrowth,
+    NewGrowth,
+
+    NumGrowths
+};
+
+//------------------------------------------------------------------------------
+/**
+    A larger element, like the vertices the mesh tools append.
+*/
+struct ArrayGrowthVertex
+{
+    float position[4];
+    float normal[4];
+    float uv[4];
+    uint color;
+    uint pad[3];
+};
+
+//------------------------------------------------------------------------------
+/**
+    Appends num elements, returns the number of reallocations. Before the
+    array runs full, the old growth reserves the step the old Grow() would
+    have taken, so Append itself never grows.
+*/
+template<class TYPE>
+static SizeT
+AppendElements(Array<TYPE>& array, SizeT num, Growth growth, const TYPE& element)
+{
+    SizeT numGrows = 0;
+    IndexT i;
+    for (i = 0; i < num; i++)
+    {
+        if (array.Size() == array.Capacity())
+        {
+            if (growth == OldGrowth)
+                array.Reserve(Math::n_min(Math::n_max(array.Capacity() >> 1, OldMinGrowSize), OldMaxGrowSize));
+            numGrows++;
+        }
+        array.Append(element);
+    }
+    return numGrows;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE>
+static void
+RunAppends(Timing::Timer& timer, const char* typeName, SizeT maxSize)
+{
+    const char* names[NumGrowths] = { "old", "new" };
+    TYPE element;
+    Memory::Clear(&element, sizeof(element));
+    IndexT sizeIndex;
+    for (sizeIndex = 0; sizeIndex < NumSizes && Sizes[sizeIndex] <= maxSize; sizeIndex++)
+    {
+        const SizeT size = Sizes[sizeIndex];
+        IndexT growth;
+        for (growth = 0; growth < NumGrowths; growth++)
+        {
+            Array<TYPE> array;
+            const Timing::Time before = timer.GetTime();
+            timer.Start();
+            const SizeT numGrows = AppendElements(array, size, (Growth)growth, element);
+            timer.Stop();
+            const Timing::Time time = timer.GetTime() - before;
+            n_printf("    %-6s %8d appends, %s growth: %9.3f ms, %5d reallocations, %7.2f ns/append\n",
+                typeName, size, names[growth], time * 1000.0, numGrows, time * 1e9 / size);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ArrayGrowthBenchmark::Run(Timing::Timer& timer)
+{
+    RunAppends<uint>(timer, "uint", 10000000);
+
+    // 64 byte elements, at 10M the old growth would copy up to 640 MB per step
+    RunAppends<ArrayGrowthVertex>(timer, "vertex", 1000000);
+}
+
+} // namespace Benchmarking
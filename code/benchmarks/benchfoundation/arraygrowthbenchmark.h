@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::ArrayGrowthBenchmark
+
+    Appends up to 10M elements to a Util::Array, once with the current
+    growth by half the capacity, and once with the old growth which was
+    capped at 65536 elements, emulated with Reserve().
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class ArrayGrowthBenchmark : public Benchmark
+{
+    __DeclareClass(ArrayGrowthBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
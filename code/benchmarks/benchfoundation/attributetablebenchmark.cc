@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+//  attributetablebenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "attributetablebenchmark.h"
+#include "attr/attributetable.h"
+#include "attr/attributedefinition.h"
+
+namespace Attr
+{
+DefineInt(AttributeTableBenchmarkRowId, 'BTid', AccessMode::ReadWrite);
+DefineInt(AttributeTableBenchmarkGroup, 'BTgr', AccessMode::ReadWrite);
+DefineFloat(AttributeTableBenchmarkWeight, 'BTwt', AccessMode::ReadWrite);
+} // namespace Attr
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::AttributeTableBenchmark, 'BMAT', Benchmarking::Benchmark);
+
+using namespace Attr;
+
+static const SizeT NumRows = 1000000;
+static const SizeT NumGroups = 64;
+static const SizeT NumScans = 16;
+static const SizeT NumScanLookups = 32;
+static const SizeT NumIndexLookups = 1000000;
+
+//------------------------------------------------------------------------------
+/**
+    Row ids are scrambled so that lookups don't find their rows in order.
+*/
+static int
+RowId(IndexT rowIndex)
+{
+    return (int)(((uint)rowIndex * 2654435761u) % (uint)NumRows);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AttributeTableBenchmark::Run(Timing::Timer& timer)
+{
+    const AttributeTable::StorageMode modes[] = { AttributeTable::RowMajor, AttributeTable::ColumnMajor };
+    const char* modeNames[] = { "row-major", "column-major" };
+    int64_t checksum = 0;
+    IndexT modeIndex;
+    for (modeIndex = 0; modeIndex < 2; modeIndex++)
+    {
+        n_printf("    %s:\n", modeNames[modeIndex]);
+        AttributeTable table;
+        table.SetStorageMode(modes[modeIndex]);
+        table.AddColumn(AttributeTableBenchmarkRowId);
+        table.AddColumn(AttributeTableBenchmarkGroup);
+        table.AddColumn(AttributeTableBenchmarkWeight);
+        const IndexT idColumn = table.GetColumnIndex(AttributeTableBenchmarkRowId);
+        const IndexT groupColumn = table.GetColumnIndex(AttributeTableBenchmarkGroup);
+        const IndexT weightColumn = table.GetColumnIndex(AttributeTableBenchmarkWeight);
+
+        // fill
+        Timing::Time before = timer.GetTime();
+        timer.Start();
+        table.ReserveRows(NumRows);
+        IndexT i;
+        for (i = 0; i < NumRows; i++)
+        {
+            const IndexT rowIndex = table.AddRow();
+            table.SetInt(idColumn, rowIndex, RowId(i));
+            table.SetInt(groupColumn, rowIndex, i % NumGroups);
+            table.SetFloat(weightColumn, rowIndex, float(i & 0xff));
+        }
+        timer.Stop();
+        Timing::Time time = timer.GetTime() - before;
+        n_printf("      fill:               %8.2f ms for %d rows\n", time * 1e3, NumRows);
+
+        // full column scans, every scan matches 1/NumGroups of the rows
+        before = timer.GetTime();
+        timer.Start();
+        for (i = 0; i < NumScans; i++)
+        {
+            const Util::Array<IndexT> rows = table.FindRowIndicesByAttr(Attribute(IntAttrId(AttributeTableBenchmarkGroup), i % NumGroups), false);
+            checksum += rows.Size();
+        }
+        timer.Stop();
+        time = timer.GetTime() - before;
+        n_printf("      column scan:        %8.2f ms per scan\n", time * 1e3 / NumScans);
+
+        // single row lookups without an index, each one is a scan up to the match
+        before = timer.GetTime();
+        timer.Start();
+        for (i = 0; i < NumScanLookups; i++)
+        {
+            checksum += table.FindRowIndexByAttr(Attribute(IntAttrId(AttributeTableBenchmarkRowId), RowId((i * 31337) % NumRows)));
+        }
+        timer.Stop();
+        time = timer.GetTime() - before;
+        n_printf("      lookup, no index:   %8.2f us per lookup\n", time * 1e6 / NumScanLookups);
+
+        // build the index, then look up through it
+        before = timer.GetTime();
+        timer.Start();
+        table.AddColumnIndex(AttributeTableBenchmarkRowId);
+        timer.Stop();
+        time = timer.GetTime() - before;
+        n_printf("      index build:        %8.2f ms\n", time * 1e3);
+
+        before = timer.GetTime();
+        timer.Start();
+        for (i = 0; i < NumIndexLookups; i++)
+        {
+            checksum += table.FindRowIndexByAttr(Attribute(IntAttrId(AttributeTableBenchmarkRowId), RowId((i * 31337) % NumRows)));
+        }
+        timer.Stop();
+        time = timer.GetTime() - before;
+        n_printf("      lookup, indexed:    %8.3f us per lookup\n", time * 1e6 / NumIndexLookups);
+    }
+    n_printf("    checksum %lld\n", (long long)checksum);
+}
+
+} // namespace Benchmarking
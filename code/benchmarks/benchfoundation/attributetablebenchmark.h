@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::AttributeTableBenchmark
+
+    Fills a 1M row Attr::AttributeTable in row-major and in column-major
+    storage mode, then measures full column scans with
+    FindRowIndicesByAttr(), and single row lookups with FindRowIndexByAttr()
+    with and without a column index.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class AttributeTableBenchmark : public Benchmark
+{
+    __DeclareClass(AttributeTableBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
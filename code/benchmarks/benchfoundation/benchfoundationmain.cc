@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+//  benchfoundationmain.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "core/coreserver.h"
+#include "system/appentry.h"
+#include "debug/debuginterface.h"
+#include "benchmarkbase/benchmarkrunner.h"
+#include "archetypestoragebenchmark.h"
+#include "arraygrowthbenchmark.h"
+#include "attributetablebenchmark.h"
+#include "blockpoolbenchmark.h"
+#include "blockringbenchmark.h"
+#include "dictionarybenchmark.h"
+#include "flathashtablebenchmark.h"
+#include "frameallocatorbenchmark.h"
+#include "httpserverbenchmark.h"
+#include "levelloaderbenchmark.h"
+#include "memorythreadbenchmark.h"
+#include "messagedispatchbenchmark.h"
+#include "profilingbenchmark.h"
+#include "stringatombenchmark.h"
+#include "stringidbenchmark.h"
+#include "tcpmessagecodecbenchmark.h"
+#include "tcpserverbenchmark.h"
+#include "transformhierarchybenchmark.h"
+
+ImplementNebulaApplication();
+
+using namespace Core;
+using namespace Benchmarking;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NebulaMain(const Util::CommandLineArgs& args)
+{
+    // create Nebula runtime
+    Ptr<CoreServer> coreServer = CoreServer::Create();
+    coreServer->SetAppName(Util::StringAtom("Nebula Foundation Benchmarks"));
+    coreServer->Open();
+
+#if __NEBULA_HTTP__
+    // the game benchmarks setup debug timers, which register with the debug server
+    Ptr<Debug::DebugInterface> debugInterface = Debug::DebugInterface::Create();
+    debugInterface->Open();
+#endif
+
+    n_printf("NEBULA FOUNDATION BENCHMARKS\n");
+    n_printf("============================\n");
+
+    // setup and run benchmarks
+    Ptr<BenchmarkRunner> runner = BenchmarkRunner::Create();
+    runner->AttachBenchmark(MemoryThreadBenchmark::Create());
+    runner->AttachBenchmark(BlockPoolBenchmark::Create());
+    runner->AttachBenchmark(TcpServerBenchmark::Create());
+    runner->AttachBenchmark(HttpServerBenchmark::Create());
+    runner->AttachBenchmark(TransformHierarchyBenchmark::Create());
+    runner->AttachBenchmark(ArchetypeStorageBenchmark::Create());
+    runner->AttachBenchmark(MessageDispatchBenchmark::Create());
+    runner->AttachBenchmark(FlatHashTableBenchmark::Create());
+    runner->AttachBenchmark(BlockRingBenchmark::Create());
+    runner->AttachBenchmark(ArrayGrowthBenchmark::Create());
+    runner->AttachBenchmark(DictionaryBenchmark::Create());
+    runner->AttachBenchmark(ProfilingBenchmark::Create());
+    runner->AttachBenchmark(FrameAllocatorBenchmark::Create());
+    runner->AttachBenchmark(TcpMessageCodecBenchmark::Create());
+    runner->AttachBenchmark(LevelLoaderBenchmark::Create());
+    runner->AttachBenchmark(StringAtomBenchmark::Create());
+    runner->AttachBenchmark(StringIdBenchmark::Create());
+    runner->AttachBenchmark(AttributeTableBenchmark::Create());
+    runner->Run();
+
+    runner = nullptr;
+#if __NEBULA_HTTP__
+    debugInterface->Close();
+    debugInterface = nullptr;
+#endif
+    coreServer->Close();
+    coreServer = nullptr;
+}
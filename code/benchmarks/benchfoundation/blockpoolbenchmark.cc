@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+//  blockpoolbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "blockpoolbenchmark.h"
+#include "memory/blockpool.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "util/fixedarray.h"
+#include <stdlib.h>
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::BlockPoolBenchmark, 'BMBL', Benchmarking::Benchmark);
+
+using namespace Threading;
+
+static const SizeT NumThreads = 32;
+static const SizeT NumIterations = 20000;
+static const SizeT BlocksPerIteration = 64;
+static const SizeT BlockSize = 64;
+
+enum Allocator
+{
+    RuntimeAllocator,
+    NebulaAllocator,
+    PoolAllocator,
+
+    NumAllocators
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+class BlockPoolBenchmarkThread : public Thread
+{
+    __DeclareClass(BlockPoolBenchmarkThread);
+public:
+    /// setup before starting the thread
+    void Setup(Allocator allocator, Memory::BlockPool* pool, Event* startEvent);
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    Allocator allocator;
+    Memory::BlockPool* pool;
+    Event* startEvent;
+};
+__ImplementClass(Benchmarking::BlockPoolBenchmarkThread, 'BMBT', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPoolBenchmarkThread::Setup(Allocator allocator_, Memory::BlockPool* pool_, Event* startEvent_)
+{
+    this->allocator = allocator_;
+    this->pool = pool_;
+    this->startEvent = startEvent_;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPoolBenchmarkThread::DoWork()
+{
+    void* blocks[BlocksPerIteration];
+    this->startEvent->Wait();
+    IndexT iteration;
+    for (iteration = 0; iteration < NumIterations; iteration++)
+    {
+        IndexT i;
+        switch (this->allocator)
+        {
+        case RuntimeAllocator:
+            for (i = 0; i < BlocksPerIteration; i++)
+                blocks[i] = malloc(BlockSize);
+            for (i = 0; i < BlocksPerIteration; i++)
+                free(blocks[i]);
+            break;
+        case NebulaAllocator:
+            for (i = 0; i < BlocksPerIteration; i++)
+                blocks[i] = Memory::Alloc(Memory::ObjectHeap, BlockSize);
+            for (i = 0; i < BlocksPerIteration; i++)
+                Memory::Free(Memory::ObjectHeap, blocks[i]);
+            break;
+        case PoolAllocator:
+            for (i = 0; i < BlocksPerIteration; i++)
+                blocks[i] = this->pool->Alloc();
+            for (i = 0; i < BlocksPerIteration; i++)
+                this->pool->Free(blocks[i]);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Every allocation and every free counts as one operation.
+*/
+void
+BlockPoolBenchmark::Run(Timing::Timer& timer)
+{
+    const char* names[NumAllocators] = { "malloc", "Memory::Alloc", "BlockPool" };
+    Memory::BlockPool pool;
+    pool.Setup("BlockPoolBenchmark", Memory::ObjectHeap, BlockSize);
+
+    IndexT allocator;
+    for (allocator = 0; allocator < NumAllocators; allocator++)
+    {
+        Event startEvent(true);
+        Util::FixedArray<Ptr<BlockPoolBenchmarkThread>> threads(NumThreads);
+        IndexT i;
+        for (i = 0; i < NumThreads; i++)
+        {
+            threads[i] = BlockPoolBenchmarkThread::Create();
+            threads[i]->SetName(Util::String::Sprintf("BlockPoolBenchmark%d", i));
+            threads[i]->Setup((Allocator)allocator, &pool, &startEvent);
+            threads[i]->Start();
+        }
+
+        // the threads wait for the start event, so their creation isn't measured
+        const Timing::Time before = timer.GetTime();
+        timer.Start();
+        startEvent.Signal();
+        for (i = 0; i < NumThreads; i++)
+            threads[i]->Stop();
+        timer.Stop();
+        const Timing::Time time = timer.GetTime() - before;
+
+        const double numOps = double(NumThreads) * NumIterations * BlocksPerIteration * 2;
+        n_printf("    %-14s %d threads: %8.2f Mops/s\n", names[allocator], NumThreads, numOps / time / 1000000.0);
+    }
+    pool.Discard();
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::BlockPoolBenchmark
+
+    Measures the throughput of Memory::BlockPool with 32 threads, which
+    allocate and free 64 blocks per iteration, against Memory::Alloc() and
+    malloc() doing the same.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class BlockPoolBenchmark : public Benchmark
+{
+    __DeclareClass(BlockPoolBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,283 @@
+//------------------------------------------------------------------------------
+//  blockringbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "blockringbenchmark.h"
+#include "threading/blockring.h"
+#include "threading/safequeue.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "util/fixedarray.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::BlockRingBenchmark, 'BMBR', Benchmarking::Benchmark);
+
+using namespace Threading;
+
+static const SizeT NumProducerCounts = 5;
+static const SizeT ProducerCounts[NumProducerCounts] = { 1, 2, 4, 8, 16 };
+static const SizeT NumCommands = 1000000;
+
+/// commands are flushed about as often as the graphics device ends a batch
+static const SizeT FlushInterval = 64;
+
+enum Transport
+{
+    BlockRingTransport,
+    SafeQueueTransport,
+
+    NumTransports
+};
+
+//------------------------------------------------------------------------------
+/**
+    About the size of a VkCommandBufferThread::Command. A command with a
+    sync event tells the consumer to signal it, like the Sync command.
+*/
+struct BenchmarkCommand
+{
+    uint type;
+    uint value;
+    Event* syncEvent;
+    uint64_t payload[5];
+};
+
+//------------------------------------------------------------------------------
+/**
+    Mirrors VkCommandBufferThread::DoWork, but records into a checksum
+    instead of a command buffer.
+*/
+class BlockRingBenchmarkConsumer : public Thread
+{
+    __DeclareClass(BlockRingBenchmarkConsumer);
+public:
+    /// constructor
+    BlockRingBenchmarkConsumer();
+    /// setup before starting the thread
+    void Setup(Transport transport);
+    /// push a command
+    void PushCommand(const BenchmarkCommand& cmd);
+    /// hand all pushed commands over to the thread
+    void FlushCommands();
+    /// called if thread needs a wakeup call before stopping
+    virtual void EmitWakeupSignal();
+    /// this method runs in the thread context
+    virtual void DoWork();
+
+    uint64_t checksum;
+private:
+    /// record a single command
+    void RecordCommand(const BenchmarkCommand& cmd);
+
+    Transport transport;
+    BlockRing<BenchmarkCommand> ring;
+    SafeQueue<BenchmarkCommand> queue;
+};
+__ImplementClass(Benchmarking::BlockRingBenchmarkConsumer, 'BMRC', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+BlockRingBenchmarkConsumer::BlockRingBenchmarkConsumer() :
+    checksum(0),
+    transport(BlockRingTransport)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkConsumer::Setup(Transport transport_)
+{
+    this->transport = transport_;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkConsumer::PushCommand(const BenchmarkCommand& cmd)
+{
+    if (this->transport == BlockRingTransport)
+        this->ring.Enqueue(cmd);
+    else
+        this->queue.Enqueue(cmd);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkConsumer::FlushCommands()
+{
+    if (this->transport == BlockRingTransport)
+        this->ring.Publish();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkConsumer::EmitWakeupSignal()
+{
+    if (this->transport == BlockRingTransport)
+        this->ring.Signal();
+    else
+        this->queue.Signal();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkConsumer::RecordCommand(const BenchmarkCommand& cmd)
+{
+    if (cmd.syncEvent != nullptr)
+        cmd.syncEvent->Signal();
+    else
+        this->checksum += cmd.type + cmd.value + cmd.payload[0];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkConsumer::DoWork()
+{
+    Util::Array<BenchmarkCommand> dequeued;
+    while (!this->ThreadStopRequested())
+    {
+        if (this->transport == BlockRingTransport)
+        {
+            this->ring.Consume([this](const BenchmarkCommand* cmds, SizeT num)
+            {
+                IndexT i;
+                for (i = 0; i < num; i++)
+                    this->RecordCommand(cmds[i]);
+            });
+            this->ring.Wait();
+        }
+        else
+        {
+            this->queue.DequeueAll(dequeued);
+            IndexT i;
+            for (i = 0; i < dequeued.Size(); i++)
+                this->RecordCommand(dequeued[i]);
+            this->queue.Wait();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+class BlockRingBenchmarkProducer : public Thread
+{
+    __DeclareClass(BlockRingBenchmarkProducer);
+public:
+    /// setup before starting the thread
+    void Setup(BlockRingBenchmarkConsumer* consumer, Event* startEvent);
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    BlockRingBenchmarkConsumer* consumer;
+    Event* startEvent;
+};
+__ImplementClass(Benchmarking::BlockRingBenchmarkProducer, 'BMRP', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmarkProducer::Setup(BlockRingBenchmarkConsumer* consumer_, Event* startEvent_)
+{
+    this->consumer = consumer_;
+    this->startEvent = startEvent_;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Ends with a sync command, so the producer is done once the consumer
+    has recorded everything.
+*/
+void
+BlockRingBenchmarkProducer::DoWork()
+{
+    BenchmarkCommand cmd;
+    Memory::Clear(&cmd, sizeof(cmd));
+    this->startEvent->Wait();
+    IndexT i;
+    for (i = 0; i < NumCommands; i++)
+    {
+        cmd.type = i & 15;
+        cmd.value = i;
+        cmd.payload[0] = i * 3;
+        this->consumer->PushCommand(cmd);
+        if ((i % FlushInterval) == FlushInterval - 1)
+            this->consumer->FlushCommands();
+    }
+
+    Event syncEvent;
+    cmd.syncEvent = &syncEvent;
+    this->consumer->PushCommand(cmd);
+    this->consumer->FlushCommands();
+    syncEvent.Wait();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingBenchmark::Run(Timing::Timer& timer)
+{
+    const char* names[NumTransports] = { "BlockRing", "SafeQueue" };
+    IndexT transport;
+    for (transport = 0; transport < NumTransports; transport++)
+    {
+        IndexT countIndex;
+        for (countIndex = 0; countIndex < NumProducerCounts; countIndex++)
+        {
+            const SizeT numProducers = ProducerCounts[countIndex];
+            Event startEvent(true);
+            Util::FixedArray<Ptr<BlockRingBenchmarkConsumer>> consumers(numProducers);
+            Util::FixedArray<Ptr<BlockRingBenchmarkProducer>> producers(numProducers);
+            IndexT i;
+            for (i = 0; i < numProducers; i++)
+            {
+                consumers[i] = BlockRingBenchmarkConsumer::Create();
+                consumers[i]->SetName(Util::String::Sprintf("BlockRingBenchmarkConsumer%d", i));
+                consumers[i]->Setup((Transport)transport);
+                consumers[i]->Start();
+                producers[i] = BlockRingBenchmarkProducer::Create();
+                producers[i]->SetName(Util::String::Sprintf("BlockRingBenchmarkProducer%d", i));
+                producers[i]->Setup(consumers[i], &startEvent);
+                producers[i]->Start();
+            }
+
+            // the threads wait for the start event, so their creation isn't measured
+            const Timing::Time before = timer.GetTime();
+            timer.Start();
+            startEvent.Signal();
+            for (i = 0; i < numProducers; i++)
+                producers[i]->Stop();
+            timer.Stop();
+            const Timing::Time time = timer.GetTime() - before;
+
+            uint64_t checksum = 0;
+            for (i = 0; i < numProducers; i++)
+            {
+                consumers[i]->Stop();
+                checksum += consumers[i]->checksum;
+            }
+
+            const double numCommands = double(numProducers) * NumCommands;
+            n_printf("    %-9s %2d producers: %8.2f Mcommands/s (checksum %llu)\n", names[transport], numProducers, numCommands / time / 1000000.0, (unsigned long long)checksum);
+        }
+    }
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,29 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::BlockRingBenchmark
+
+    Measures how many commands per second can be handed from submitting
+    threads to command buffer threads, with 1 to 16 producers. Every
+    producer feeds its own consumer, like the graphics device feeds its
+    VkCommandBufferThreads, and the consumers replay the commands against
+    a null backend. Threading::BlockRing is compared against the
+    Threading::SafeQueue it replaced.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class BlockRingBenchmark : public Benchmark
+{
+    __DeclareClass(BlockRingBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
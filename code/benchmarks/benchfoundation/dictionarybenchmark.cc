@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+//  dictionarybenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "dictionarybenchmark.h"
+#include "util/dictionary.h"
+#include "util/fixedarray.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::DictionaryBenchmark, 'BMDI', Benchmarking::Benchmark);
+
+using namespace Util;
+
+static const SizeT NumSizes = 6;
+static const SizeT Sizes[NumSizes] = { 16, 64, 256, 1024, 4096, 32768 };
+
+/// every size does at least this many operations per pass, so the small dictionaries can be timed
+static const SizeT MinOpsPerPass = 200000;
+
+//------------------------------------------------------------------------------
+/**
+    Keys are added in a scrambled order, so sorted inserts don't always
+    end up at the back of the array.
+*/
+static int
+MakeKey(IndexT i)
+{
+    return (int)(((uint)i * 2654435761u) >> 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class POLICY>
+static void
+RunPolicy(Timing::Timer& timer, const char* name)
+{
+    IndexT sizeIndex;
+    for (sizeIndex = 0; sizeIndex < NumSizes; sizeIndex++)
+    {
+        const SizeT size = Sizes[sizeIndex];
+        const SizeT repeat = Math::n_max(MinOpsPerPass / size, 1);
+        FixedArray<int> keys(size);
+        IndexT i;
+        for (i = 0; i < size; i++)
+            keys[i] = MakeKey(i);
+
+        Timing::Time addTime = 0.0;
+        Timing::Time findTime = 0.0;
+        Timing::Time eraseTime = 0.0;
+        Timing::Time before;
+        int64_t checksum = 0;
+        IndexT r;
+        for (r = 0; r < repeat; r++)
+        {
+            Dictionary<int, int, POLICY> dict;
+
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                dict.Add(keys[i], i);
+            timer.Stop();
+            addTime += timer.GetTime() - before;
+
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                checksum += dict.FindIndex(keys[i]);
+            timer.Stop();
+            findTime += timer.GetTime() - before;
+
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                dict.Erase(keys[i]);
+            timer.Stop();
+            eraseTime += timer.GetTime() - before;
+            checksum += dict.Size();
+        }
+
+        const double numOps = double(size) * repeat;
+        n_printf("    %-6s %6d pairs: add %8.1f ns, find %6.1f ns, erase %8.1f ns (checksum %lld)\n",
+            name,
+            size,
+            addTime * 1e9 / numOps,
+            findTime * 1e9 / numOps,
+            eraseTime * 1e9 / numOps,
+            (long long)checksum);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DictionaryBenchmark::Run(Timing::Timer& timer)
+{
+    RunPolicy<DictionarySorted>(timer, "sorted");
+    RunPolicy<DictionaryHashed<>>(timer, "hashed");
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::DictionaryBenchmark
+
+    Measures add, find and erase on a Util::Dictionary with the default
+    DictionarySorted policy against DictionaryHashed, for dictionaries
+    from 16 to 32k pairs.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class DictionaryBenchmark : public Benchmark
+{
+    __DeclareClass(DictionaryBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+//  flathashtablebenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "flathashtablebenchmark.h"
+#include "util/flathashtable.h"
+#include "util/fixedarray.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::FlatHashTableBenchmark, 'BMFH', Benchmarking::Benchmark);
+
+using namespace Util;
+
+static const SizeT NumSizes = 5;
+static const SizeT Sizes[NumSizes] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+//------------------------------------------------------------------------------
+/**
+    Every size does at least this many operations per pass, so the small
+    tables aren't dominated by timer resolution.
+*/
+static const SizeT MinOpsPerPass = 10000000;
+
+//------------------------------------------------------------------------------
+/**
+    Keys are scattered over the whole integer range, the table mixes the
+    bits anyway, but the lookups shouldn't walk memory in insertion order.
+*/
+static int
+MakeKey(IndexT i)
+{
+    return (int)((uint)i * 2654435761u);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FlatHashTableBenchmark::Run(Timing::Timer& timer)
+{
+    IndexT sizeIndex;
+    for (sizeIndex = 0; sizeIndex < NumSizes; sizeIndex++)
+    {
+        const SizeT size = Sizes[sizeIndex];
+        const SizeT repeat = Math::n_max(MinOpsPerPass / size, 1);
+        FixedArray<int> keys(size);
+        IndexT i;
+        for (i = 0; i < size; i++)
+            keys[i] = MakeKey(i);
+
+        Timing::Time insertTime = 0.0;
+        Timing::Time hitTime = 0.0;
+        Timing::Time missTime = 0.0;
+        Timing::Time eraseTime = 0.0;
+        Timing::Time before;
+        int64_t checksum = 0;
+        IndexT r;
+        for (r = 0; r < repeat; r++)
+        {
+            FlatHashTable<int, int> table;
+
+            // insert, the table grows as it goes
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                table.Add(keys[i], i);
+            timer.Stop();
+            insertTime += timer.GetTime() - before;
+
+            // find existing keys
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                checksum += table.FindIndex(keys[i]);
+            timer.Stop();
+            hitTime += timer.GetTime() - before;
+
+            // find keys which were never added
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                checksum += table.FindIndex(MakeKey(size + i));
+            timer.Stop();
+            missTime += timer.GetTime() - before;
+
+            // erase all keys
+            before = timer.GetTime();
+            timer.Start();
+            for (i = 0; i < size; i++)
+                table.Erase(keys[i]);
+            timer.Stop();
+            eraseTime += timer.GetTime() - before;
+            checksum += table.Size();
+        }
+
+        const double numOps = double(size) * repeat;
+        n_printf("    %8d keys: insert %6.1f ns, find hit %6.1f ns, find miss %6.1f ns, erase %6.1f ns (checksum %lld)\n",
+            size,
+            insertTime * 1e9 / numOps,
+            hitTime * 1e9 / numOps,
+            missTime * 1e9 / numOps,
+            eraseTime * 1e9 / numOps,
+            (long long)checksum);
+    }
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::FlatHashTableBenchmark
+
+    Measures insert, find and erase on Util::FlatHashTable for tables
+    from 1k to 10M keys.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class FlatHashTableBenchmark : public Benchmark
+{
+    __DeclareClass(FlatHashTableBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
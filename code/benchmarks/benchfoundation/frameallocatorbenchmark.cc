@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------
+//  frameallocatorbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "frameallocatorbenchmark.h"
+#include "memory/arenaallocator.h"
+#include "memory/frameallocator.h"
+#include "util/fixedarray.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::FrameAllocatorBenchmark, 'BMFA', Benchmarking::Benchmark);
+
+static const SizeT AllocsPerFrame = 4096;
+static const SizeT NumFrames = 1000;
+
+enum FrameAllocator
+{
+    ArenaFrameAllocator,
+    ScratchFrameAllocator,
+    LinearFrameAllocator,
+
+    NumFrameAllocators
+};
+
+//------------------------------------------------------------------------------
+/**
+    Block sizes from 16 to 256 bytes, from a fixed LCG so every allocator
+    gets the same sequence.
+*/
+static inline SizeT
+NextBlockSize(uint& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return 16 + ((seed >> 16) % 61) * 4;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Runs one frame, the blocks are touched so no allocator can get away
+    with handing out untouched pages, and dropped at the end of the frame
+    the way their current users do it.
+*/
+static uint
+RunFrame(FrameAllocator allocator, Memory::ArenaAllocator<1024>& arena, Util::FixedArray<void*>& blocks, uint& seed)
+{
+    uint checksum = 0;
+    IndexT i;
+    for (i = 0; i < AllocsPerFrame; i++)
+    {
+        const SizeT size = NextBlockSize(seed);
+        void* ptr;
+        switch (allocator)
+        {
+            case ArenaFrameAllocator:   ptr = arena.Alloc(size); break;
+            case ScratchFrameAllocator: ptr = Memory::Alloc(Memory::ScratchHeap, size); break;
+            default:                    ptr = Memory::FrameAlloc(size); break;
+        }
+        *(uint*)ptr = i;
+        blocks[i] = ptr;
+    }
+    for (i = 0; i < AllocsPerFrame; i++)
+        checksum += *(uint*)blocks[i];
+
+    switch (allocator)
+    {
+        case ArenaFrameAllocator:
+            arena.Release();
+            break;
+        case ScratchFrameAllocator:
+            for (i = 0; i < AllocsPerFrame; i++)
+                Memory::Free(Memory::ScratchHeap, blocks[i]);
+            break;
+        default:
+            Memory::FrameAllocatorNewFrame();
+            break;
+    }
+    return checksum;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The time includes the end of the frame, which is where the arena
+    frees its chunks and the scratch blocks are freed.
+*/
+void
+FrameAllocatorBenchmark::Run(Timing::Timer& timer)
+{
+    const char* names[NumFrameAllocators] = { "ArenaAllocator<1024>", "ScratchHeap", "FrameAlloc" };
+    Memory::ArenaAllocator<1024> arena;
+    Util::FixedArray<void*> blocks(AllocsPerFrame);
+    uint checksum = 0;
+
+    IndexT allocator;
+    for (allocator = 0; allocator < NumFrameAllocators; allocator++)
+    {
+        // warm up, this also fills every buffered frame of the frame allocator with chunks
+        uint seed = 1;
+        IndexT frame;
+        for (frame = 0; frame < Memory::FrameAllocatorNumFrames; frame++)
+            checksum += RunFrame((FrameAllocator)allocator, arena, blocks, seed);
+
+        seed = 1;
+        const Timing::Time before = timer.GetTime();
+        timer.Start();
+        for (frame = 0; frame < NumFrames; frame++)
+            checksum += RunFrame((FrameAllocator)allocator, arena, blocks, seed);
+        timer.Stop();
+        const Timing::Time time = timer.GetTime() - before;
+
+        n_printf("    %-20s %6.2f ns per allocation, %8.2f us per frame\n",
+            names[allocator],
+            time * 1e9 / (double(NumFrames) * AllocsPerFrame),
+            time * 1e6 / NumFrames);
+    }
+
+    Memory::FrameAllocatorStats stats;
+    Memory::FrameAllocatorGetStats(stats);
+    n_printf("    %d allocations per frame, frame allocator high-water mark %d kB, reserved %d kB (checksum %u)\n",
+        AllocsPerFrame, int(stats.highWaterMark / 1024), int(stats.reservedSize / 1024), checksum);
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::FrameAllocatorBenchmark
+
+    Allocates a frame's worth of small transient blocks, like draw packets,
+    and throws them away again at the end of the frame, through an
+    ArenaAllocator<1024> which is released every frame, through the
+    ScratchHeap and through Memory::FrameAlloc().
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class FrameAllocatorBenchmark : public Benchmark
+{
+    __DeclareClass(FrameAllocatorBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
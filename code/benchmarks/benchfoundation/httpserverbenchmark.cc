@@ -0,0 +1,398 @@
+//------------------------------------------------------------------------------
+//  httpserverbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "httpserverbenchmark.h"
+#include "http/httpserver.h"
+#include "http/html/htmlpagewriter.h"
+#include "net/tcpclient.h"
+#include "io/memorystream.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "util/fixedarray.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::HttpServerBenchmark, 'BMHS', Benchmarking::Benchmark);
+
+using namespace Http;
+using namespace IO;
+using namespace Net;
+using namespace Threading;
+using namespace Util;
+
+static const ushort Port = 2111;
+static const SizeT NumTextureRows = 800;
+static const SizeT RowsPerFlush = 256;
+static const SizeT NumRequests = 400;
+
+//------------------------------------------------------------------------------
+/**
+    Writes a page which looks like the texture list of the
+    TexturePageHandler, flushed every RowsPerFlush rows for "?flush=1".
+*/
+class TextureListHandler : public HttpRequestHandler
+{
+    __DeclareClass(TextureListHandler);
+public:
+    /// constructor
+    TextureListHandler();
+    /// handle a http request
+    virtual void HandleRequest(const Ptr<HttpRequest>& request);
+};
+__ImplementClass(Benchmarking::TextureListHandler, 'BMHH', Http::HttpRequestHandler);
+
+//------------------------------------------------------------------------------
+/**
+*/
+TextureListHandler::TextureListHandler()
+{
+    this->SetName("Benchmark");
+    this->SetDesc("texture list for the HttpServer benchmark");
+    this->SetRootLocation("bench");
+    this->SetThreadSafe(true);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TextureListHandler::HandleRequest(const Ptr<HttpRequest>& request)
+{
+    const bool flush = request->GetURI().ParseQuery().Contains("flush");
+    request->SetStatus(HttpStatus::OK);
+    Ptr<HtmlPageWriter> htmlWriter = HtmlPageWriter::Create();
+    htmlWriter->SetStream(request->GetResponseContentStream());
+    htmlWriter->SetTitle("Nebula Textures");
+    if (htmlWriter->Open())
+    {
+        htmlWriter->Element(HtmlElement::Heading1, "Texture Resources (stream loaded)");
+        htmlWriter->AddAttr("border", "1");
+        htmlWriter->AddAttr("rules", "cols");
+        htmlWriter->Begin(HtmlElement::Table);
+        IndexT i;
+        for (i = 0; i < NumTextureRows; i++)
+        {
+            String name;
+            name.Format("tex:textures/level/prop_%04d.dds", i);
+            htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Begin(HtmlElement::TableData);
+            htmlWriter->AddAttr("href", "/texture?texinfo=" + name);
+            htmlWriter->Element(HtmlElement::Anchor, name);
+            htmlWriter->End(HtmlElement::TableData);
+            htmlWriter->Element(HtmlElement::TableData, "Loaded");
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(1 + i % 5));
+            htmlWriter->Element(HtmlElement::TableData, "2D");
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(256 << (i % 4)));
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(256 << (i % 3)));
+            htmlWriter->Element(HtmlElement::TableData, "1");
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(9 + i % 3));
+            htmlWriter->Element(HtmlElement::TableData, "DXT5");
+            htmlWriter->End(HtmlElement::TableRow);
+            if (flush && ((i + 1) % RowsPerFlush == 0))
+            {
+                request->FlushResponseContent();
+            }
+        }
+        htmlWriter->End(HtmlElement::Table);
+        htmlWriter->Close();
+    }
+    else
+    {
+        request->SetStatus(HttpStatus::InternalServerError);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Runs the HttpServer the way the HttpMessageHandler does, the server
+    is a thread local singleton, so it is created on this thread.
+*/
+class HttpServerThread : public Thread
+{
+    __DeclareClass(HttpServerThread);
+public:
+    /// wait until the server is open
+    void WaitUntilOpen();
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    Event openEvent;
+};
+__ImplementClass(Benchmarking::HttpServerThread, 'BMHT', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServerThread::WaitUntilOpen()
+{
+    this->openEvent.Wait();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServerThread::DoWork()
+{
+    Ptr<HttpServer> server = HttpServer::Create();
+    server->SetPort(Port);
+    n_assert(server->Open());
+    server->AttachRequestHandler(TextureListHandler::Create());
+    this->openEvent.Signal();
+    while (!this->ThreadStopRequested())
+    {
+        server->WaitForWork(10);
+        server->OnFrame();
+    }
+    server->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns the size of the response at the start of the data, or 0 if
+    it hasn't been received completely yet.
+*/
+static SizeT
+CompleteResponseSize(const char* data, SizeT size)
+{
+    IndexT headerEnd;
+    for (headerEnd = 0; headerEnd + 4 <= size; headerEnd++)
+    {
+        if (0 == memcmp(data + headerEnd, "\r\n\r\n", 4))
+        {
+            break;
+        }
+    }
+    if (headerEnd + 4 > size)
+    {
+        return 0;
+    }
+    String header;
+    header.Set(data, headerEnd);
+    SizeT position = headerEnd + 4;
+
+    IndexT lengthIndex = header.FindStringIndex("Content-Length: ");
+    if (InvalidIndex != lengthIndex)
+    {
+        position += atoi(header.AsCharPtr() + lengthIndex + 16);
+        return (position <= size) ? position : 0;
+    }
+
+    // chunked transfer encoding, every chunk is a hex size line, the data, and a line break
+    n_assert(InvalidIndex != header.FindStringIndex("Transfer-Encoding: chunked"));
+    while (true)
+    {
+        IndexT lineEnd = position;
+        while ((lineEnd + 2 <= size) && (data[lineEnd] != '\r'))
+        {
+            lineEnd++;
+        }
+        if (lineEnd + 2 > size)
+        {
+            return 0;
+        }
+        const SizeT chunkSize = (SizeT)strtoul(data + position, nullptr, 16);
+        position = lineEnd + 2 + chunkSize + 2;
+        if (position > size)
+        {
+            return 0;
+        }
+        if (0 == chunkSize)
+        {
+            return position;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    A keep-alive client which sends a request after the response to the
+    previous one has been received completely.
+*/
+class HttpClientThread : public Thread
+{
+    __DeclareClass(HttpClientThread);
+public:
+    /// setup before starting the thread
+    void Setup(const String& request, SizeT numRequests);
+    /// this method runs in the thread context
+    virtual void DoWork();
+    /// get the number of complete responses, valid after the thread has stopped
+    SizeT GetNumResponses() const;
+    /// get the number of received bytes, valid after the thread has stopped
+    SizeT GetNumBytes() const;
+private:
+    String request;
+    SizeT numRequests;
+    SizeT numResponses;
+    SizeT numBytes;
+};
+__ImplementClass(Benchmarking::HttpClientThread, 'BMHC', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpClientThread::Setup(const String& request_, SizeT numRequests_)
+{
+    this->request = request_;
+    this->numRequests = numRequests_;
+    this->numResponses = 0;
+    this->numBytes = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpClientThread::DoWork()
+{
+    Ptr<TcpClient> client = TcpClient::Create();
+    client->SetBlocking(true);
+    client->SetServerAddress(IpAddress("127.0.0.1", Port));
+    if (TcpClient::Success != client->Connect())
+    {
+        return;
+    }
+
+    Ptr<MemoryStream> response = MemoryStream::Create();
+    response->SetAccessMode(Stream::AppendAccess);
+    IndexT i;
+    for (i = 0; i < this->numRequests; i++)
+    {
+        const Ptr<Stream>& sendStream = client->GetSendStream();
+        sendStream->SetAccessMode(Stream::WriteAccess);
+        if (sendStream->Open())
+        {
+            sendStream->Write(this->request.AsCharPtr(), this->request.Length());
+            sendStream->Close();
+        }
+        if (!client->Send())
+        {
+            break;
+        }
+
+        // receive until the response is complete, there is nothing behind it
+        response->SetSize(0);
+        SizeT responseSize = 0;
+        while ((0 == responseSize) && client->Recv())
+        {
+            const Ptr<MemoryStream>& recvStream = client->GetRecvStream().downcast<MemoryStream>();
+            if (response->Open())
+            {
+                response->Write(recvStream->GetRawPointer(), recvStream->GetSize());
+                response->Close();
+            }
+            responseSize = CompleteResponseSize((const char*)response->GetRawPointer(), response->GetSize());
+        }
+        if (0 == responseSize)
+        {
+            break;
+        }
+        this->numResponses++;
+        this->numBytes += responseSize;
+    }
+    client->Disconnect();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+HttpClientThread::GetNumResponses() const
+{
+    return this->numResponses;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+HttpClientThread::GetNumBytes() const
+{
+    return this->numBytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Runs one pass of NumRequests requests spread over numClients
+    connections, returns the number of requests per second.
+*/
+static double
+RunPass(SizeT numClients, bool gzip, bool flush, Timing::Timer& timer, SizeT& bytesPerResponse)
+{
+    String request;
+    request.Format("GET /bench%s HTTP/1.1\r\nHost: 127.0.0.1\r\n%s\r\n",
+        flush ? "?flush=1" : "", gzip ? "Accept-Encoding: gzip\r\n" : "");
+
+    FixedArray<Ptr<HttpClientThread>> clients(numClients);
+    IndexT i;
+    for (i = 0; i < clients.Size(); i++)
+    {
+        clients[i] = HttpClientThread::Create();
+        clients[i]->SetName("HttpServerBenchmark::Client");
+        clients[i]->Setup(request, NumRequests / numClients);
+    }
+
+    const Timing::Time before = timer.GetTime();
+    timer.Start();
+    for (i = 0; i < clients.Size(); i++)
+    {
+        clients[i]->Start();
+    }
+
+    // the clients return by themselves once all of their requests are answered
+    SizeT numResponses = 0;
+    SizeT numBytes = 0;
+    for (i = 0; i < clients.Size(); i++)
+    {
+        clients[i]->Stop();
+        numResponses += clients[i]->GetNumResponses();
+        numBytes += clients[i]->GetNumBytes();
+    }
+    timer.Stop();
+    const Timing::Time time = timer.GetTime() - before;
+
+    n_assert(numResponses == (NumRequests / numClients) * numClients);
+    bytesPerResponse = numBytes / Math::n_max(numResponses, 1);
+    return numResponses / time;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServerBenchmark::Run(Timing::Timer& timer)
+{
+    Ptr<HttpServerThread> serverThread = HttpServerThread::Create();
+    serverThread->SetName("HttpServerBenchmark::Server");
+    serverThread->Start();
+    serverThread->WaitUntilOpen();
+
+    const SizeT clientCounts[] = { 1, 8 };
+    IndexT i;
+    for (i = 0; i < (IndexT)(sizeof(clientCounts) / sizeof(SizeT)); i++)
+    {
+        int gzip;
+        for (gzip = 0; gzip < 2; gzip++)
+        {
+            int flush;
+            for (flush = 0; flush < 2; flush++)
+            {
+                SizeT bytesPerResponse = 0;
+                const double requests = RunPass(clientCounts[i], gzip != 0, flush != 0, timer, bytesPerResponse);
+                n_printf("    %d clients, %-8s %-8s: %7.0f requests/s, %6.1f KB/response\n",
+                    clientCounts[i], gzip ? "gzip" : "identity", flush ? "streamed" : "whole",
+                    requests, bytesPerResponse / 1024.0);
+            }
+        }
+    }
+
+    serverThread->Stop();
+    serverThread = nullptr;
+}
+
+} // namespace Benchmarking
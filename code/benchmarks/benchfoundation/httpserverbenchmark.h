@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::HttpServerBenchmark
+
+    Load test for Http::HttpServer over loopback. Keep-alive clients
+    request a texture list page of about 100 KB from a thread-safe
+    request handler, with 1 and 8 clients, with and without gzip, and
+    with the page written in one piece or flushed while it is written.
+    Reports the requests per second, and the size of a response.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class HttpServerBenchmark : public Benchmark
+{
+    __DeclareClass(HttpServerBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
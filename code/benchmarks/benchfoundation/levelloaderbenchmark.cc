@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------
+//  levelloaderbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "levelloaderbenchmark.h"
+#include "game/component/component.h"
+#include "basegamefeature/managers/entitymanager.h"
+#include "basegamefeature/managers/componentmanager.h"
+#include "basegamefeature/components/transformcomponent.h"
+#include "basegamefeature/loader/levelloader.h"
+#include "basegamefeature/loader/loaderserver.h"
+#include "graphicsfeature/components/graphicsdata.h"
+#include "game/messaging/message.h"
+#include "io/ioserver.h"
+#include "io/filestream.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::LevelLoaderBenchmark, 'BMLL', Benchmarking::Benchmark);
+
+using namespace Game;
+
+static const SizeT NumEntities = 1000000;
+/// every entity with an index which is a multiple of this is a root, the others are its children
+static const SizeT NumChildren = 16;
+/// every entity with an index which is a multiple of this has a camera
+static const SizeT CameraStride = 10;
+static const SizeT NumModels = 64;
+static const char* LevelUri = "temp:levelloaderbenchmark.lvl";
+
+typedef Component<Attr::GraphicsEntity, Attr::ModelResource> GraphicsAllocator;
+typedef Component<Attr::CameraMode, Attr::CameraMoveSpeed, Attr::CameraProjection> CameraAllocator;
+static GraphicsAllocator* graphics = nullptr;
+static CameraAllocator* cameras = nullptr;
+
+//------------------------------------------------------------------------------
+/**
+    Creates the components of the level, the synthetic ones get the
+    same function bundle __SetupDefaultComponentBundle would give them.
+*/
+static void
+SetupComponents()
+{
+    const ComponentCreateInfo info = { true };
+    TransformComponent::Create();
+
+    graphics = n_new(GraphicsAllocator(info));
+    graphics->functions.DestroyAll = []() { graphics->DestroyAll(); };
+    graphics->functions.Serialize = [](const Ptr<IO::BinaryWriter>& writer) { graphics->Serialize(writer); };
+    graphics->functions.Deserialize = [](const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances) { graphics->Deserialize(reader, offset, numInstances); };
+    ComponentManager::Instance()->RegisterComponent(graphics, "LevelBenchmarkGraphics", 'LBGR');
+
+    cameras = n_new(CameraAllocator(info));
+    cameras->functions.DestroyAll = []() { cameras->DestroyAll(); };
+    cameras->functions.Serialize = [](const Ptr<IO::BinaryWriter>& writer) { cameras->Serialize(writer); };
+    cameras->functions.Deserialize = [](const Ptr<IO::BinaryReader>& reader, uint offset, uint numInstances) { cameras->Deserialize(reader, offset, numInstances); };
+    ComponentManager::Instance()->RegisterComponent(cameras, "LevelBenchmarkCameras", 'LBCA');
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+DiscardComponents()
+{
+    ComponentManager::Instance()->DeregisterAll();
+    TransformComponent::Discard();
+    graphics->DestroyAll();
+    n_delete(graphics);
+    graphics = nullptr;
+    cameras->DestroyAll();
+    n_delete(cameras);
+    cameras = nullptr;
+    EntityManager::Instance()->InvalidateAllEntities();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+BuildLevel()
+{
+    Util::FixedArray<Util::String> models(NumModels);
+    IndexT i;
+    for (i = 0; i < NumModels; i++)
+        models[i].Format("mdl:benchmark/model_%02d.n3", i);
+
+    Util::Array<Entity> entities = EntityManager::Instance()->CreateEntities(NumEntities);
+    for (i = 0; i < NumEntities; i++)
+    {
+        const InstanceId transform = TransformComponent::RegisterEntity(entities[i]);
+        TransformComponent::SetLocalTransform(transform, Math::matrix44::translation((float)i, 0.0f, 0.0f));
+        if (i % NumChildren != 0)
+            TransformComponent::SetParent(transform, (InstanceId)(i - i % NumChildren));
+
+        const InstanceId gfx = graphics->RegisterEntity(entities[i]);
+        graphics->Get<Attr::GraphicsEntity>(gfx) = i;
+        graphics->Get<Attr::ModelResource>(gfx) = models[i % NumModels];
+
+        if (i % CameraStride == 0)
+        {
+            const InstanceId camera = cameras->RegisterEntity(entities[i]);
+            cameras->Get<Attr::CameraMode>(camera) = i;
+        }
+    }
+    TransformComponent::UpdateWorldTransforms();
+    MessageDispatcher::DispatchFrameBatches();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static uint
+Checksum()
+{
+    n_assert(TransformComponent::NumRegistered() == NumEntities);
+    n_assert(graphics->NumRegistered() == NumEntities);
+    n_assert(cameras->NumRegistered() == NumEntities / CameraStride);
+    uint checksum = 0;
+    IndexT i;
+    for (i = 0; i < NumEntities; i += 997)
+    {
+        checksum += graphics->Get<Attr::GraphicsEntity>(i) + graphics->Get<Attr::ModelResource>(i).Length();
+        checksum += TransformComponent::GetParent(i);
+    }
+    return checksum + cameras->Get<Attr::CameraMode>(cameras->NumRegistered() - 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static SizeT
+LevelFileSize()
+{
+    Ptr<IO::FileStream> stream = IO::FileStream::Create();
+    stream->SetURI(LevelUri);
+    stream->SetAccessMode(IO::Stream::ReadAccess);
+    SizeT size = 0;
+    if (stream->Open())
+    {
+        size = stream->GetSize();
+        stream->Close();
+    }
+    return size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static Timing::Time
+LoadLevel(Timing::Timer& timer, uint& checksum)
+{
+    SetupComponents();
+    const Timing::Time before = timer.GetTime();
+    timer.Start();
+    n_assert(BaseGameFeature::LevelLoader::Load(LevelUri));
+    timer.Stop();
+    const Timing::Time time = timer.GetTime() - before;
+    MessageDispatcher::DispatchFrameBatches();
+    checksum += Checksum();
+    DiscardComponents();
+    return time;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LevelLoaderBenchmark::Run(Timing::Timer& timer)
+{
+    Ptr<IO::IoServer> ioServer;
+    if (!IO::IoServer::HasInstance())
+        ioServer = IO::IoServer::Create();
+    MessageDispatcher::Setup();
+    Ptr<EntityManager> entityManager = EntityManager::Create();
+    Ptr<ComponentManager> componentManager = ComponentManager::Create();
+    uint checksum = 0;
+
+    SetupComponents();
+    BuildLevel();
+    checksum += Checksum();
+    Timing::Time before = timer.GetTime();
+    timer.Start();
+    n_assert(BaseGameFeature::LevelLoader::Save(LevelUri));
+    timer.Stop();
+    const Timing::Time saveTime = timer.GetTime() - before;
+    DiscardComponents();
+    n_printf("    %d entities, %d components: save %8.2f ms, %d kB\n",
+        NumEntities, NumEntities * 2 + NumEntities / CameraStride, saveTime * 1000.0,
+        LevelFileSize() / 1024);
+
+    // without an open LoaderServer the components are deserialized on this thread
+    const Timing::Time serialTime = LoadLevel(timer, checksum);
+    n_printf("    load, calling thread: %8.2f ms, %6.2f Mentities/s\n", serialTime * 1000.0, NumEntities / serialTime / 1000000.0);
+
+    Ptr<BaseGameFeature::LoaderServer> loaderServer = BaseGameFeature::LoaderServer::Create();
+    loaderServer->Open();
+    const Timing::Time parallelTime = LoadLevel(timer, checksum);
+    n_printf("    load, job port:       %8.2f ms, %6.2f Mentities/s (checksum %u)\n", parallelTime * 1000.0, NumEntities / parallelTime / 1000000.0, checksum);
+    loaderServer->Close();
+    loaderServer = nullptr;
+
+    IO::IoServer::Instance()->DeleteFile(LevelUri);
+    componentManager = nullptr;
+    entityManager = nullptr;
+    MessageDispatcher::Discard();
+    ioServer = nullptr;
+}
+
+} // namespace Benchmarking
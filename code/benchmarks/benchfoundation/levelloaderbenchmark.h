@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::LevelLoaderBenchmark
+
+    Saves a synthetic level with 1M entities, every entity has a transform
+    in a shallow hierarchy and a graphics component with a model resource,
+    every tenth one a camera component. The level is then loaded with
+    BaseGameFeature::LevelLoader, once on the calling thread and once on
+    the job port of an open LoaderServer.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class LevelLoaderBenchmark : public Benchmark
+{
+    __DeclareClass(LevelLoaderBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
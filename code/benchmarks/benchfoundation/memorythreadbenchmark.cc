@@ -0,0 +1,258 @@
+//------------------------------------------------------------------------------
+//  memorythreadbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memorythreadbenchmark.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "threading/safequeue.h"
+#include "util/fixedarray.h"
+#include <stdlib.h>
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::MemoryThreadBenchmark, 'BMMT', Benchmarking::Benchmark);
+
+using namespace Threading;
+
+static const SizeT BatchSize = 256;
+static const SizeT NumBatches = 4000;
+static const SizeT NumHeaps = 4;
+static const Memory::HeapType Heaps[NumHeaps] = { Memory::ObjectHeap, Memory::ObjectArrayHeap, Memory::ScratchHeap, Memory::StringDataHeap };
+
+enum Allocator
+{
+    RuntimeAllocator,
+    NebulaAllocator
+};
+
+struct Batch
+{
+    void* blocks[BatchSize];
+};
+
+//------------------------------------------------------------------------------
+/**
+    Block sizes from 8 to 508 bytes, from a fixed LCG so every run is the same.
+*/
+static inline size_t
+NextBlockSize(uint& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return 8 + ((seed >> 16) % 126) * 4;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+AllocBatch(Allocator allocator, Batch& batch, uint& seed)
+{
+    IndexT i;
+    for (i = 0; i < BatchSize; i++)
+    {
+        const size_t size = NextBlockSize(seed);
+        void* ptr = allocator == NebulaAllocator ? Memory::Alloc(Heaps[i % NumHeaps], size) : malloc(size);
+
+        // touch the block, so the allocator can't get away with handing out untouched pages
+        *(uint*)ptr = i;
+        batch.blocks[i] = ptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+FreeBatch(Allocator allocator, Batch& batch)
+{
+    IndexT i;
+    for (i = 0; i < BatchSize; i++)
+    {
+        if (allocator == NebulaAllocator)
+            Memory::Free(Heaps[i % NumHeaps], batch.blocks[i]);
+        else
+            free(batch.blocks[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Allocates and frees NumBatches batches once the start event is signalled.
+*/
+class AllocFreeThread : public Thread
+{
+    __DeclareClass(AllocFreeThread);
+public:
+    /// setup before starting the thread
+    void Setup(Allocator allocator, Event* startEvent, uint seed);
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    Allocator allocator;
+    Event* startEvent;
+    uint seed;
+};
+__ImplementClass(Benchmarking::AllocFreeThread, 'BMAF', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AllocFreeThread::Setup(Allocator allocator_, Event* startEvent_, uint seed_)
+{
+    this->allocator = allocator_;
+    this->startEvent = startEvent_;
+    this->seed = seed_;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+AllocFreeThread::DoWork()
+{
+    Batch batch;
+    this->startEvent->Wait();
+    IndexT i;
+    for (i = 0; i < NumBatches; i++)
+    {
+        AllocBatch(this->allocator, batch, this->seed);
+        FreeBatch(this->allocator, batch);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    One side of the producer/consumer pair, the producer allocates batches
+    and passes them on through full, the consumer frees them and hands the
+    empty batch back.
+*/
+class BatchPassThread : public Thread
+{
+    __DeclareClass(BatchPassThread);
+public:
+    /// setup before starting the thread
+    void Setup(Allocator allocator, bool producer, Event* startEvent, SafeQueue<Batch*>* empty, SafeQueue<Batch*>* full);
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    Allocator allocator;
+    bool producer;
+    Event* startEvent;
+    SafeQueue<Batch*>* empty;
+    SafeQueue<Batch*>* full;
+};
+__ImplementClass(Benchmarking::BatchPassThread, 'BMBP', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BatchPassThread::Setup(Allocator allocator_, bool producer_, Event* startEvent_, SafeQueue<Batch*>* empty_, SafeQueue<Batch*>* full_)
+{
+    this->allocator = allocator_;
+    this->producer = producer_;
+    this->startEvent = startEvent_;
+    this->empty = empty_;
+    this->full = full_;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BatchPassThread::DoWork()
+{
+    SafeQueue<Batch*>* input = this->producer ? this->empty : this->full;
+    SafeQueue<Batch*>* output = this->producer ? this->full : this->empty;
+    uint seed = 1;
+    this->startEvent->Wait();
+    IndexT i;
+    for (i = 0; i < NumBatches; i++)
+    {
+        while (input->IsEmpty())
+            input->Wait();
+        Batch* batch = input->Dequeue();
+        if (this->producer)
+            AllocBatch(this->allocator, *batch, seed);
+        else
+            FreeBatch(this->allocator, *batch);
+        output->Enqueue(batch);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Starts the threads, they wait for the start event so thread creation
+    isn't measured, and returns the time until all of them have finished.
+*/
+static Timing::Time
+RunThreads(Util::FixedArray<Ptr<Thread>>& threads, Event& startEvent, Timing::Timer& timer)
+{
+    IndexT i;
+    for (i = 0; i < threads.Size(); i++)
+    {
+        threads[i]->SetName(Util::String::Sprintf("MemoryBenchmark%d", i));
+        threads[i]->Start();
+    }
+
+    const Timing::Time before = timer.GetTime();
+    timer.Start();
+    startEvent.Signal();
+    for (i = 0; i < threads.Size(); i++)
+        threads[i]->Stop();
+    timer.Stop();
+    return timer.GetTime() - before;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Every Alloc() and every Free() counts as one operation.
+*/
+void
+MemoryThreadBenchmark::Run(Timing::Timer& timer)
+{
+    const SizeT threadCounts[] = { 1, 2, 4, 8, 16 };
+    const char* names[] = { "malloc", "Memory" };
+    IndexT allocator;
+    for (allocator = RuntimeAllocator; allocator <= NebulaAllocator; allocator++)
+    {
+        IndexT i;
+        for (i = 0; i < (IndexT)(sizeof(threadCounts) / sizeof(SizeT)); i++)
+        {
+            Event startEvent(true);
+            Util::FixedArray<Ptr<Thread>> threads(threadCounts[i]);
+            IndexT j;
+            for (j = 0; j < threads.Size(); j++)
+            {
+                Ptr<AllocFreeThread> thread = AllocFreeThread::Create();
+                thread->Setup((Allocator)allocator, &startEvent, j + 1);
+                threads[j] = thread.upcast<Thread>();
+            }
+            const Timing::Time time = RunThreads(threads, startEvent, timer);
+            const double numOps = double(threads.Size()) * NumBatches * BatchSize * 2;
+            n_printf("    %-6s %2d threads alloc/free: %8.2f Mops/s\n", names[allocator], threads.Size(), numOps / time / 1000000.0);
+        }
+
+        // free on another thread than the one which allocated
+        Event startEvent(true);
+        SafeQueue<Batch*> empty, full;
+        Util::FixedArray<Batch> batches(16);
+        for (i = 0; i < batches.Size(); i++)
+            empty.Enqueue(&batches[i]);
+        Util::FixedArray<Ptr<Thread>> threads(2);
+        for (i = 0; i < threads.Size(); i++)
+        {
+            Ptr<BatchPassThread> thread = BatchPassThread::Create();
+            thread->Setup((Allocator)allocator, i == 0, &startEvent, &empty, &full);
+            threads[i] = thread.upcast<Thread>();
+        }
+        const Timing::Time time = RunThreads(threads, startEvent, timer);
+        const double numOps = double(NumBatches) * BatchSize * 2;
+        n_printf("    %-6s producer/consumer:     %8.2f Mops/s\n", names[allocator], numOps / time / 1000000.0);
+    }
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,29 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::MemoryThreadBenchmark
+
+    Measures Memory::Alloc() and Memory::Free() from several threads at
+    once, against malloc() and free() of the C runtime. Every thread
+    allocates and frees batches of small blocks round robin over the heaps
+    which see the most traffic, with 1 to 16 threads. A producer/consumer
+    pair measures blocks freed by another thread than the one which
+    allocated them.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class MemoryThreadBenchmark : public Benchmark
+{
+    __DeclareClass(MemoryThreadBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
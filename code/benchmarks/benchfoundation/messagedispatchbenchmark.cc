@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+//  messagedispatchbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "messagedispatchbenchmark.h"
+#include "game/entity.h"
+#include "game/messaging/message.h"
+#include "math/matrix44.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::MessageDispatchBenchmark, 'BMMD', Benchmarking::Benchmark);
+
+using namespace Game;
+
+/// same signature as Msg::UpdateTransform
+__DeclareMsg(DispatchBenchmarkMsg, 'BMDM', Game::Entity, Math::matrix44 const&);
+
+static const SizeT NumMessages = 1000000;
+static const SizeT NumListeners = 4;
+
+/// one sum per listener, so thread safe listeners don't share anything
+static float sums[NumListeners];
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <int N>
+static void
+Listener(Game::Entity entity, Math::matrix44 const& transform)
+{
+    sums[N] += transform.get_position().x() + entity.id;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <int N>
+static void
+BatchListener(SizeT num, const Game::Entity* entities, const Math::matrix44* transforms)
+{
+    float sum = 0.0f;
+    IndexT i;
+    for (i = 0; i < num; i++)
+        sum += transforms[i].get_position().x() + entities[i].id;
+    sums[N] += sum;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+enum ListenerKind
+{
+    PerMessage,
+    Batched,
+    ThreadSafeBatched
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+RegisterListeners(ListenerKind kind)
+{
+    switch (kind)
+    {
+    case PerMessage:
+        __RegisterMsg(DispatchBenchmarkMsg, Listener<0>);
+        __RegisterMsg(DispatchBenchmarkMsg, Listener<1>);
+        __RegisterMsg(DispatchBenchmarkMsg, Listener<2>);
+        __RegisterMsg(DispatchBenchmarkMsg, Listener<3>);
+        break;
+    case Batched:
+        __RegisterBatchMsg(DispatchBenchmarkMsg, BatchListener<0>);
+        __RegisterBatchMsg(DispatchBenchmarkMsg, BatchListener<1>);
+        __RegisterBatchMsg(DispatchBenchmarkMsg, BatchListener<2>);
+        __RegisterBatchMsg(DispatchBenchmarkMsg, BatchListener<3>);
+        break;
+    case ThreadSafeBatched:
+        __RegisterThreadSafeBatchMsg(DispatchBenchmarkMsg, BatchListener<0>);
+        __RegisterThreadSafeBatchMsg(DispatchBenchmarkMsg, BatchListener<1>);
+        __RegisterThreadSafeBatchMsg(DispatchBenchmarkMsg, BatchListener<2>);
+        __RegisterThreadSafeBatchMsg(DispatchBenchmarkMsg, BatchListener<3>);
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+enum SendKind
+{
+    Send,
+    Defer,
+    Batch
+};
+
+//------------------------------------------------------------------------------
+/**
+    Sends all messages and dispatches them, returns messages per second.
+*/
+static double
+RunPass(SendKind send, ListenerKind listeners, Timing::Timer& timer)
+{
+    RegisterListeners(listeners);
+    DispatchBenchmarkMsg::MessageQueueId queue = DispatchBenchmarkMsg::AllocateMessageQueue();
+    const Math::matrix44 transform = Math::matrix44::translation(1.0f, 0.0f, 0.0f);
+
+    const Timing::Time before = timer.GetTime();
+    timer.Start();
+    IndexT i;
+    switch (send)
+    {
+    case Send:
+        for (i = 0; i < NumMessages; i++)
+            DispatchBenchmarkMsg::Send((Ids::Id32)i, transform);
+        break;
+    case Defer:
+        for (i = 0; i < NumMessages; i++)
+            DispatchBenchmarkMsg::Defer(queue, (Ids::Id32)i, transform);
+        DispatchBenchmarkMsg::DispatchMessageQueue(queue);
+        break;
+    case Batch:
+        for (i = 0; i < NumMessages; i++)
+            DispatchBenchmarkMsg::Batch((Ids::Id32)i, transform);
+        MessageDispatcher::DispatchFrameBatches();
+        break;
+    }
+    timer.Stop();
+    const Timing::Time time = timer.GetTime() - before;
+
+    DispatchBenchmarkMsg::DeAllocateMessageQueue(queue);
+    DispatchBenchmarkMsg::DeregisterAll();
+    return NumMessages / time;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MessageDispatchBenchmark::Run(Timing::Timer& timer)
+{
+    MessageDispatcher::Setup();
+
+    struct Pass
+    {
+        const char* name;
+        SendKind send;
+        ListenerKind listeners;
+    };
+    const Pass passes[] =
+    {
+        { "send, per message", Send, PerMessage },
+        { "send, batch", Send, Batched },
+        { "defer, per message", Defer, PerMessage },
+        { "defer, batch", Defer, Batched },
+        { "frame batch, batch", Batch, Batched },
+        { "frame batch, thread safe batch", Batch, ThreadSafeBatched },
+    };
+
+    IndexT i;
+    for (i = 0; i < (IndexT)(sizeof(passes) / sizeof(Pass)); i++)
+    {
+        const double messages = RunPass(passes[i].send, passes[i].listeners, timer);
+        n_printf("    %-32s: %7.2f M messages/s, %d listeners\n", passes[i].name, messages / 1000000.0, NumListeners);
+    }
+
+    // keeps the listeners from being optimized away
+    n_printf("    checksum %f\n", sums[0] + sums[1] + sums[2] + sums[3]);
+    MessageDispatcher::Discard();
+}
+
+} // namespace Benchmarking
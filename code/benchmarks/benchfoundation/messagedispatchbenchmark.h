@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::MessageDispatchBenchmark
+
+    Dispatches 1M messages through Game::Message, sent directly, deferred
+    to a message queue and batched per frame, and compares per message
+    listeners with batch listeners and thread safe batch listeners.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class MessageDispatchBenchmark : public Benchmark
+{
+    __DeclareClass(MessageDispatchBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+//  profilingbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "profilingbenchmark.h"
+#include "debug/profiling.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::ProfilingBenchmark, 'BMPS', Benchmarking::Benchmark);
+
+/// scopes per capture, stays below the capacity of a thread's buffer so nothing is dropped
+static const SizeT ScopesPerCapture = 60000;
+static const SizeT NumCaptures = 100;
+
+enum ScopeMode
+{
+    NoScope,
+    ScopeNotCapturing,
+    ScopeCapturing,
+
+    NumScopeModes
+};
+
+//------------------------------------------------------------------------------
+/**
+    Each iteration depends on the previous one, so the loop without
+    scopes can't be vectorized away.
+*/
+static uint
+RunScopes(ScopeMode mode, uint seed)
+{
+    uint value = seed;
+    IndexT i;
+    if (mode == NoScope)
+    {
+        for (i = 0; i < ScopesPerCapture; i++)
+            value = value * 1664525 + i;
+    }
+    else
+    {
+        for (i = 0; i < ScopesPerCapture; i++)
+        {
+            Debug::ProfilingScope scope("ProfilingBenchmark", "Benchmark");
+            value = value * 1664525 + i;
+        }
+    }
+    return value;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingBenchmark::Run(Timing::Timer& timer)
+{
+    const char* names[NumScopeModes] = { "no scope", "scope, not capturing", "scope, capturing" };
+    Timing::Time times[NumScopeModes];
+    uint checksum = 0;
+
+    // the thread's event buffer is allocated by the first recorded scope, keep that out of the measurement
+    Debug::ProfilingBeginCapture();
+    checksum += RunScopes(ScopeCapturing, 0);
+    Debug::ProfilingEndCapture();
+
+    IndexT mode;
+    for (mode = 0; mode < NumScopeModes; mode++)
+    {
+        times[mode] = 0.0;
+        IndexT capture;
+        for (capture = 0; capture < NumCaptures; capture++)
+        {
+            if (mode == ScopeCapturing)
+                Debug::ProfilingBeginCapture();
+            const Timing::Time before = timer.GetTime();
+            timer.Start();
+            checksum += RunScopes((ScopeMode)mode, capture);
+            timer.Stop();
+            times[mode] += timer.GetTime() - before;
+            if (mode == ScopeCapturing)
+            {
+                Debug::ProfilingEndCapture();
+                n_assert(Debug::ProfilingGetNumDroppedEvents() == 0);
+            }
+        }
+    }
+
+    const double numScopes = double(ScopesPerCapture) * NumCaptures;
+    for (mode = 0; mode < NumScopeModes; mode++)
+    {
+        n_printf("    %-22s %6.2f ns per iteration, %6.2f ns overhead\n",
+            names[mode],
+            times[mode] * 1e9 / numScopes,
+            (times[mode] - times[NoScope]) * 1e9 / numScopes);
+    }
+    n_printf("    recorded %d events in the last capture, target is below 50 ns per scope (checksum %u)\n", Debug::ProfilingGetNumEvents(), checksum);
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::ProfilingBenchmark
+
+    Measures the overhead of a Debug::ProfilingScope, with no capture
+    running and while a capture is recording, against the same loop
+    without scopes, which is what N_SCOPE compiles to when
+    NEBULA_ENABLE_PROFILING is off. A recorded scope should stay below
+    50 ns.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class ProfilingBenchmark : public Benchmark
+{
+    __DeclareClass(ProfilingBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
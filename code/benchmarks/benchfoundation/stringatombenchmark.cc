@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------
+//  stringatombenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "stringatombenchmark.h"
+#include "util/stringatom.h"
+#include "util/fixedarray.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "threading/criticalsection.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::StringAtomBenchmark, 'BMSA', Benchmarking::Benchmark);
+
+using namespace Threading;
+
+/// new atoms per pass, split between the threads
+static const SizeT NumUniqueAtoms = 512 * 1024;
+/// atoms every thread interns in the shared pass
+static const SizeT NumSharedAtoms = 256 * 1024;
+
+enum AtomMode
+{
+    UniqueAtoms,
+    UniqueAtomsSingleLock,
+    SharedAtoms,
+
+    NumAtomModes
+};
+
+static CriticalSection singleLock;
+
+//------------------------------------------------------------------------------
+/**
+    Creates an atom from every string once the start event is signalled.
+    The strings are formatted in advance, so only the atoms are measured.
+*/
+class StringAtomThread : public Thread
+{
+    __DeclareClass(StringAtomThread);
+public:
+    /// setup before starting the thread
+    void Setup(const Util::Array<Util::String>* strings, bool lock, Event* startEvent);
+    /// this method runs in the thread context
+    virtual void DoWork();
+    /// get the checksum over the atoms, valid after the thread has stopped
+    SizeT GetChecksum() const;
+private:
+    const Util::Array<Util::String>* strings;
+    bool lock;
+    Event* startEvent;
+    SizeT checksum;
+};
+__ImplementClass(Benchmarking::StringAtomThread, 'BMST', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+StringAtomThread::Setup(const Util::Array<Util::String>* strings_, bool lock_, Event* startEvent_)
+{
+    this->strings = strings_;
+    this->lock = lock_;
+    this->startEvent = startEvent_;
+    this->checksum = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+StringAtomThread::DoWork()
+{
+    const Util::Array<Util::String>& strs = *this->strings;
+    this->startEvent->Wait();
+    IndexT i;
+    for (i = 0; i < strs.Size(); i++)
+    {
+        if (this->lock)
+            singleLock.Enter();
+        const Util::StringAtom atom(strs[i].AsCharPtr());
+        if (this->lock)
+            singleLock.Leave();
+        this->checksum += atom.Value()[0];
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+StringAtomThread::GetChecksum() const
+{
+    return this->checksum;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Atoms are never removed from the global table, so every pass uses
+    strings of its own, otherwise later passes would only find the atoms
+    of earlier ones.
+*/
+static void
+FormatStrings(Util::Array<Util::String>& strings, const char* prefix, IndexT pass, IndexT thread, SizeT num)
+{
+    strings.Reserve(num);
+    IndexT i;
+    for (i = 0; i < num; i++)
+        strings.Append(Util::String::Sprintf("%s/pass%d/thread%d/atom%d", prefix, pass, thread, i));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+StringAtomBenchmark::Run(Timing::Timer& timer)
+{
+    const SizeT threadCounts[] = { 1, 4, 16, 32 };
+    const char* names[NumAtomModes] = { "unique, sharded", "unique, one lock", "shared" };
+    SizeT checksum = 0;
+    IndexT pass = 0;
+    IndexT mode;
+    for (mode = 0; mode < NumAtomModes; mode++)
+    {
+        IndexT i;
+        for (i = 0; i < (IndexT)(sizeof(threadCounts) / sizeof(SizeT)); i++, pass++)
+        {
+            const SizeT numThreads = threadCounts[i];
+            Util::FixedArray<Util::Array<Util::String>> strings(numThreads);
+            IndexT j;
+            for (j = 0; j < numThreads; j++)
+            {
+                if (mode == SharedAtoms)
+                    FormatStrings(strings[j], "shared", pass, 0, NumSharedAtoms);
+                else
+                    FormatStrings(strings[j], "unique", pass, j, NumUniqueAtoms / numThreads);
+            }
+
+            Event startEvent(true);
+            Util::FixedArray<Ptr<StringAtomThread>> threads(numThreads);
+            for (j = 0; j < numThreads; j++)
+            {
+                threads[j] = StringAtomThread::Create();
+                threads[j]->SetName(Util::String::Sprintf("StringAtomBenchmark%d", j));
+                threads[j]->Setup(&strings[j], mode == UniqueAtomsSingleLock, &startEvent);
+                threads[j]->Start();
+            }
+
+            const Timing::Time before = timer.GetTime();
+            timer.Start();
+            startEvent.Signal();
+            SizeT numAtoms = 0;
+            for (j = 0; j < numThreads; j++)
+            {
+                threads[j]->Stop();
+                checksum += threads[j]->GetChecksum();
+                numAtoms += strings[j].Size();
+            }
+            timer.Stop();
+            const Timing::Time time = timer.GetTime() - before;
+            n_printf("    %-16s %2d threads: %8.2f M atoms/s\n", names[mode], numThreads, numAtoms / time / 1000000.0);
+        }
+    }
+    n_printf("    (checksum %u)\n", (uint)checksum);
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::StringAtomBenchmark
+
+    Creates string atoms from 1 to 32 threads at once. Every thread
+    interns strings nobody else uses, once straight through the sharded
+    global table and once with all threads serialized on one lock, like
+    the global table used to be, and finally all threads intern the same
+    strings. Reports millions of atoms per second.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class StringAtomBenchmark : public Benchmark
+{
+    __DeclareClass(StringAtomBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
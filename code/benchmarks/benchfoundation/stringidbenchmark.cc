@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+//  stringidbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "stringidbenchmark.h"
+#include "util/stringid.h"
+#include "util/stringatom.h"
+#include "util/dictionary.h"
+#include "util/hashtable.h"
+#include "util/fixedarray.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::StringIdBenchmark, 'BMSI', Benchmarking::Benchmark);
+
+using namespace Util;
+
+/// names of a typical material, the order they are looked up in is scrambled
+static const char* Names[] =
+{
+    "AlbedoMap", "ParameterMap", "NormalMap", "EmissiveMap", "MatAlbedoIntensity", "MatSpecularIntensity",
+    "MatRoughnessIntensity", "MatMetallicIntensity", "MatEmissiveIntensity", "AlphaSensitivity", "AlphaBlendFactor",
+    "TransmissionFactor", "UVScale", "UVOffset", "DetailMap", "DetailScale", "EnvironmentMap", "IrradianceMap",
+    "NumEnvMips", "LightMap", "LightMapIntensity", "TessellationFactor", "HeightScale", "DisplacementMap"
+};
+static const SizeT NumNames = sizeof(Names) / sizeof(const char*);
+static const SizeT NumLookups = 2000000;
+
+enum LookupMode
+{
+    AtomFromLiteral,
+    AtomPrepared,
+    IdLiteral,
+    IdFromAtom,
+    IdLiteralHashTable,
+
+    NumLookupModes
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+static IndexT
+Lookup(LookupMode mode, IndexT i, const Dictionary<StringAtom, IndexT>& atomDict, const Dictionary<StringId, IndexT>& idDict, const HashTable<StringId, IndexT>& idTable, const FixedArray<StringAtom>& atoms, const FixedArray<StringId>& ids)
+{
+    switch (mode)
+    {
+        case AtomFromLiteral:   return atomDict.FindIndex(StringAtom(Names[i]));
+        case AtomPrepared:      return atomDict.FindIndex(atoms[i]);
+        case IdLiteral:         return idDict.FindIndex(ids[i]);
+        case IdFromAtom:        return idDict.FindIndex(StringId(atoms[i]));
+        default:                return idTable.FindIndex(ids[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The containers are filled from runtime strings, like MaterialServer
+    does when it loads a material type. The literal ids are constants,
+    they are computed up front here so the names can be kept in one list.
+*/
+void
+StringIdBenchmark::Run(Timing::Timer& timer)
+{
+    const char* names[NumLookupModes] = { "StringAtom from literal", "StringAtom", "\"Name\"_id", "StringId from StringAtom", "\"Name\"_id, HashTable" };
+    Dictionary<StringAtom, IndexT> atomDict;
+    Dictionary<StringId, IndexT> idDict;
+    HashTable<StringId, IndexT> idTable;
+    FixedArray<StringAtom> atoms(NumNames);
+    FixedArray<StringId> ids(NumNames);
+    IndexT i;
+    for (i = 0; i < NumNames; i++)
+    {
+        const String name = Names[i];
+        atomDict.Add(StringAtom(name), i);
+        idDict.Add(StringId(name), i);
+        idTable.Add(StringId(name), i);
+        atoms[i] = Names[i];
+        ids[i] = StringId(Names[i]);
+    }
+
+    int64_t checksum = 0;
+    IndexT mode;
+    for (mode = 0; mode < NumLookupModes; mode++)
+    {
+        const Timing::Time before = timer.GetTime();
+        timer.Start();
+        for (i = 0; i < NumLookups; i++)
+            checksum += Lookup((LookupMode)mode, (i * 7) % NumNames, atomDict, idDict, idTable, atoms, ids);
+        timer.Stop();
+        const Timing::Time time = timer.GetTime() - before;
+        n_printf("    %-26s %6.2f ns per lookup\n", names[mode], time * 1e9 / NumLookups);
+    }
+    n_printf("    %d names (checksum %lld)\n", NumNames, (long long)checksum);
+}
+
+} // namespace Benchmarking
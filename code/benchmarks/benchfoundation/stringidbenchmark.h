@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::StringIdBenchmark
+
+    Looks up material constant names the ways MaterialType could be asked
+    for them: by creating a StringAtom from the literal name, by a StringAtom
+    created up front, by a "Name"_id literal, by converting a StringAtom to
+    a StringId for every lookup, and by literal id in a Util::HashTable.
+    Reports ns per lookup.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class StringIdBenchmark : public Benchmark
+{
+    __DeclareClass(StringIdBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
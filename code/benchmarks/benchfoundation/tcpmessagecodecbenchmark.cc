@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+//  tcpmessagecodecbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "tcpmessagecodecbenchmark.h"
+#include "net/tcpserver.h"
+#include "net/tcpclient.h"
+#include "net/messageclient.h"
+#include "net/tcpmessagecodec.h"
+#include "io/memorystream.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::TcpMessageCodecBenchmark, 'BMMC', Benchmarking::Benchmark);
+
+using namespace Net;
+using namespace Threading;
+
+static const ushort Port = 2111;
+/// bytes sent per payload size, so every size runs for a similar time
+static const SizeT BytesPerPass = 64 * 1024 * 1024;
+static const SizeT MaxMessagesPerPass = 200000;
+
+//------------------------------------------------------------------------------
+/**
+    Receives on the server side and decodes everything which arrives,
+    signals the done event once all messages of the pass are there.
+*/
+class TcpMessageRecvThread : public Thread
+{
+    __DeclareClass(TcpMessageRecvThread);
+public:
+    /// setup before starting the thread
+    void Setup(const Ptr<TcpServer>& server, SizeT numMessages, bool copyToStream, Event* doneEvent);
+    /// this method runs in the thread context
+    virtual void DoWork();
+    /// get the number of bytes copied while decoding, valid after the thread has stopped
+    size_t GetNumBytesCopied() const;
+    /// get the checksum over the received messages, valid after the thread has stopped
+    uint GetChecksum() const;
+private:
+    Ptr<TcpServer> server;
+    SizeT numMessages;
+    bool copyToStream;
+    Event* doneEvent;
+    size_t numBytesCopied;
+    uint checksum;
+};
+__ImplementClass(Benchmarking::TcpMessageRecvThread, 'BMMR', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TcpMessageRecvThread::Setup(const Ptr<TcpServer>& server_, SizeT numMessages_, bool copyToStream_, Event* doneEvent_)
+{
+    this->server = server_;
+    this->numMessages = numMessages_;
+    this->copyToStream = copyToStream_;
+    this->doneEvent = doneEvent_;
+    this->numBytesCopied = 0;
+    this->checksum = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+    There is only one client, so a single codec is enough.
+*/
+void
+TcpMessageRecvThread::DoWork()
+{
+    TcpMessageCodec codec;
+    size_t streamBytesCopied = 0;
+    SizeT numReceived = 0;
+    while (!this->ThreadStopRequested())
+    {
+        this->server->WaitForRecv(10);
+        Util::Array<Ptr<TcpClientConnection>> connections = this->server->Recv();
+        IndexT i;
+        for (i = 0; i < connections.Size(); i++)
+        {
+            codec.DecodeStream(connections[i]->GetRecvStream());
+            TcpMessageCodec::MessageView message;
+            while (codec.DequeueMessage(message))
+            {
+                if (this->copyToStream)
+                {
+                    Ptr<IO::MemoryStream> stream = IO::MemoryStream::Create();
+                    stream->SetAccessMode(IO::Stream::WriteAccess);
+                    if (stream->Open())
+                    {
+                        stream->Write(message.data, message.size);
+                        stream->Close();
+                    }
+                    streamBytesCopied += message.size;
+                }
+                this->checksum += message.data[numReceived % message.size];
+                if (++numReceived == this->numMessages)
+                {
+                    this->doneEvent->Signal();
+                }
+            }
+        }
+    }
+    n_assert(!codec.HasError());
+    this->numBytesCopied = codec.GetNumBytesCopied() + streamBytesCopied;
+    this->server = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+TcpMessageRecvThread::GetNumBytesCopied() const
+{
+    return this->numBytesCopied;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint
+TcpMessageRecvThread::GetChecksum() const
+{
+    return this->checksum;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The stream path writes a copy of the payload with header into the
+    client's send stream, the view path hands header and payload to the
+    socket in one gathering send. Returns the bytes copied.
+*/
+static size_t
+SendMessage(const Ptr<MessageClient>& client, bool copyToStream, TcpMessageCodec& codec, const Ptr<IO::MemoryStream>& payload, const ubyte* data, SizeT size)
+{
+    if (copyToStream)
+    {
+        payload->SetSize(0);
+        payload->SetAccessMode(IO::Stream::WriteAccess);
+        if (payload->Open())
+        {
+            payload->Write(data, size);
+            payload->Close();
+        }
+        codec.EncodeToMessage(payload.upcast<IO::Stream>(), client->TcpClient::GetSendStream());
+        n_assert(client->TcpClient::Send());
+        return TcpMessageCodec::HeaderSize + size;
+    }
+    else
+    {
+        const Ptr<IO::Stream>& stream = client->GetSendStream();
+        stream->SetAccessMode(IO::Stream::WriteAccess);
+        if (stream->Open())
+        {
+            stream->Write(data, size);
+            stream->Close();
+        }
+        n_assert(client->Send());
+        return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sends numMessages messages of the given size and returns the time until
+    the last one has been decoded.
+*/
+static Timing::Time
+RunPass(SizeT messageSize, SizeT numMessages, bool copyToStream, Timing::Timer& timer, size_t& outBytesCopied, uint& outChecksum)
+{
+    Ptr<TcpServer> server = TcpServer::Create();
+    server->SetAddress(IpAddress("127.0.0.1", Port));
+    n_assert(server->Open());
+    Event doneEvent(true);
+    Ptr<TcpMessageRecvThread> recvThread = TcpMessageRecvThread::Create();
+    recvThread->SetName("TcpMessageCodecBenchmark");
+    recvThread->Setup(server, numMessages, copyToStream, &doneEvent);
+    recvThread->Start();
+
+    Ptr<MessageClient> client = MessageClient::Create();
+    client->SetBlocking(true);
+    client->SetServerAddress(IpAddress("127.0.0.1", Port));
+    n_assert(TcpClient::Success == client->Connect());
+
+    Util::FixedArray<ubyte> data(messageSize);
+    IndexT i;
+    for (i = 0; i < messageSize; i++)
+    {
+        data[i] = (ubyte)i;
+    }
+    Ptr<IO::MemoryStream> payload = IO::MemoryStream::Create();
+    TcpMessageCodec encoder;
+
+    size_t bytesCopied = 0;
+    const Timing::Time before = timer.GetTime();
+    timer.Start();
+    for (i = 0; i < numMessages; i++)
+    {
+        bytesCopied += SendMessage(client, copyToStream, encoder, payload, data.Begin(), messageSize);
+    }
+    doneEvent.Wait();
+    timer.Stop();
+    const Timing::Time time = timer.GetTime() - before;
+
+    recvThread->Stop();
+    outBytesCopied = bytesCopied + recvThread->GetNumBytesCopied();
+    outChecksum = recvThread->GetChecksum();
+    recvThread = nullptr;
+    client->Disconnect();
+    server->Close();
+    return time;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sends of up to 1 KB are copied together by PosixSocket in both paths,
+    which is not counted.
+*/
+void
+TcpMessageCodecBenchmark::Run(Timing::Timer& timer)
+{
+    const SizeT messageSizes[] = { 64, 1024, 16 * 1024 };
+    const char* names[] = { "views", "streams" };
+    uint checksum = 0;
+    IndexT i;
+    for (i = 0; i < (IndexT)(sizeof(messageSizes) / sizeof(SizeT)); i++)
+    {
+        const SizeT messageSize = messageSizes[i];
+        const SizeT numMessages = Math::n_min(BytesPerPass / messageSize, MaxMessagesPerPass);
+        int copyToStream;
+        for (copyToStream = 1; copyToStream >= 0; copyToStream--)
+        {
+            size_t bytesCopied = 0;
+            uint passChecksum = 0;
+            const Timing::Time time = RunPass(messageSize, numMessages, copyToStream != 0, timer, bytesCopied, passChecksum);
+            checksum += passChecksum;
+            n_printf("    %5d bytes, %-7s %9.0f msgs/s, %8.1f bytes copied per message\n",
+                messageSize, names[copyToStream], numMessages / time, double(bytesCopied) / numMessages);
+        }
+    }
+    n_printf("    (checksum %u)\n", checksum);
+}
+
+} // namespace Benchmarking
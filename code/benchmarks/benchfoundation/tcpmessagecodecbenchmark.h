@@ -0,0 +1,30 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::TcpMessageCodecBenchmark
+
+    Sends messages of 64 bytes, 1 KB and 16 KB from a Net::MessageClient
+    to a Net::TcpServer over loopback, where a Net::TcpMessageCodec
+    decodes them. Once with the stream path, which encodes each message
+    into a stream with EncodeToMessage() and copies each received message
+    into its own stream like MessageClient::GetRecvStream(), and once with
+    the gathering send and the message views. Reports the messages per
+    second and the bytes copied per message by the codec and the streams.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class TcpMessageCodecBenchmark : public Benchmark
+{
+    __DeclareClass(TcpMessageCodecBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+//  tcpserverbenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "tcpserverbenchmark.h"
+#include "net/tcpserver.h"
+#include "net/tcpclient.h"
+#include "threading/thread.h"
+#include "util/fixedarray.h"
+#if __linux__
+#include <sys/resource.h>
+#endif
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::TcpServerBenchmark, 'BMTS', Benchmarking::Benchmark);
+
+using namespace Net;
+using namespace Threading;
+
+static const ushort Port = 2110;
+static const SizeT MessageSize = 64;
+static const SizeT NumRoundTrips = 10000;
+static const SizeT NumMessagesAllActive = 20000;
+
+//------------------------------------------------------------------------------
+/**
+    Serves the connections the way an application would, waits until
+    something was received and sends it back.
+*/
+class TcpEchoThread : public Thread
+{
+    __DeclareClass(TcpEchoThread);
+public:
+    /// setup before starting the thread
+    void Setup(const Ptr<TcpServer>& server);
+    /// this method runs in the thread context
+    virtual void DoWork();
+    /// get the number of Recv() calls, valid after the thread has stopped
+    SizeT GetNumRecvCalls() const;
+    /// get the time spent in Recv(), valid after the thread has stopped
+    Timing::Time GetRecvTime() const;
+private:
+    Ptr<TcpServer> server;
+    SizeT numRecvCalls;
+    Timing::Time recvTime;
+};
+__ImplementClass(Benchmarking::TcpEchoThread, 'BMTE', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TcpEchoThread::Setup(const Ptr<TcpServer>& server_)
+{
+    this->server = server_;
+    this->numRecvCalls = 0;
+    this->recvTime = 0.0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TcpEchoThread::DoWork()
+{
+    Timing::Timer timer;
+    while (!this->ThreadStopRequested())
+    {
+        this->server->WaitForRecv(10);
+
+        timer.Start();
+        Util::Array<Ptr<TcpClientConnection>> connections = this->server->Recv();
+        timer.Stop();
+        this->numRecvCalls++;
+
+        IndexT i;
+        for (i = 0; i < connections.Size(); i++)
+        {
+            connections[i]->Send(connections[i]->GetRecvStream());
+        }
+    }
+    this->recvTime = timer.GetTime();
+    this->server = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+TcpEchoThread::GetNumRecvCalls() const
+{
+    return this->numRecvCalls;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Timing::Time
+TcpEchoThread::GetRecvTime() const
+{
+    return this->recvTime;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Each connection needs a descriptor on both ends, which doesn't fit
+    the usual default limit of 1024 with 1000 connections.
+*/
+static bool
+RaiseDescriptorLimit(SizeT numConnections)
+{
+#if __linux__
+    const rlim_t needed = numConnections * 2 + 64;
+    rlimit limit;
+    if (0 != getrlimit(RLIMIT_NOFILE, &limit))
+    {
+        return false;
+    }
+    if (limit.rlim_cur >= needed)
+    {
+        return true;
+    }
+    if ((RLIM_INFINITY != limit.rlim_max) && (limit.rlim_max < needed))
+    {
+        return false;
+    }
+    limit.rlim_cur = needed;
+    return 0 == setrlimit(RLIMIT_NOFILE, &limit);
+#else
+    return true;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+SendMessage(const Ptr<TcpClient>& client, const ubyte* msg)
+{
+    const Ptr<IO::Stream>& stream = client->GetSendStream();
+    stream->SetAccessMode(IO::Stream::WriteAccess);
+    if (stream->Open())
+    {
+        stream->Write(msg, MessageSize);
+        stream->Close();
+    }
+    n_assert(client->Send());
+}
+
+//------------------------------------------------------------------------------
+/**
+    A blocking Recv() returns as soon as some data has arrived, which on
+    loopback is practically always the whole message.
+*/
+static void
+RecvMessage(const Ptr<TcpClient>& client)
+{
+    SizeT received = 0;
+    while (received < MessageSize)
+    {
+        n_assert(client->Recv());
+        received += client->GetRecvStream()->GetSize();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Runs one pass with numConnections connected clients of which either
+    one or all send, returns the number of round trips per second.
+*/
+static double
+RunPass(SizeT numConnections, bool allActive, Timing::Timer& timer, Timing::Time& recvTimePerCall)
+{
+    Ptr<TcpServer> server = TcpServer::Create();
+    server->SetAddress(IpAddress("127.0.0.1", Port));
+    n_assert(server->Open());
+    Ptr<TcpEchoThread> echoThread = TcpEchoThread::Create();
+    echoThread->SetName("TcpServerBenchmark");
+    echoThread->Setup(server);
+    echoThread->Start();
+
+    Util::FixedArray<Ptr<TcpClient>> clients(numConnections);
+    IndexT i;
+    for (i = 0; i < clients.Size(); i++)
+    {
+        clients[i] = TcpClient::Create();
+        clients[i]->SetBlocking(true);
+        clients[i]->SetServerAddress(IpAddress("127.0.0.1", Port));
+        n_assert(TcpClient::Success == clients[i]->Connect());
+    }
+
+    // one round trip on every connection, so every connection has been accepted before timing
+    ubyte msg[MessageSize];
+    Memory::Fill(msg, MessageSize, 0x42);
+    for (i = 0; i < clients.Size(); i++)
+    {
+        SendMessage(clients[i], msg);
+    }
+    for (i = 0; i < clients.Size(); i++)
+    {
+        RecvMessage(clients[i]);
+    }
+
+    SizeT numMessages = 0;
+    const Timing::Time before = timer.GetTime();
+    timer.Start();
+    if (allActive)
+    {
+        const SizeT numRounds = Math::n_max(NumMessagesAllActive / numConnections, 10);
+        IndexT round;
+        for (round = 0; round < numRounds; round++)
+        {
+            for (i = 0; i < clients.Size(); i++)
+            {
+                SendMessage(clients[i], msg);
+            }
+            for (i = 0; i < clients.Size(); i++)
+            {
+                RecvMessage(clients[i]);
+            }
+        }
+        numMessages = numRounds * numConnections;
+    }
+    else
+    {
+        // the first client is the only one which sends, the others stay idle
+        for (i = 0; i < NumRoundTrips; i++)
+        {
+            SendMessage(clients[0], msg);
+            RecvMessage(clients[0]);
+        }
+        numMessages = NumRoundTrips;
+    }
+    timer.Stop();
+    const Timing::Time time = timer.GetTime() - before;
+
+    echoThread->Stop();
+    recvTimePerCall = echoThread->GetRecvTime() / Math::n_max(echoThread->GetNumRecvCalls(), 1);
+    echoThread = nullptr;
+    for (i = 0; i < clients.Size(); i++)
+    {
+        clients[i]->Disconnect();
+    }
+    server->Close();
+    return numMessages / time;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TcpServerBenchmark::Run(Timing::Timer& timer)
+{
+    const SizeT connectionCounts[] = { 1, 10, 100, 1000 };
+    IndexT i;
+    for (i = 0; i < (IndexT)(sizeof(connectionCounts) / sizeof(SizeT)); i++)
+    {
+        const SizeT numConnections = connectionCounts[i];
+        if (!RaiseDescriptorLimit(numConnections))
+        {
+            n_printf("    %4d connections: skipped, not enough file descriptors\n", numConnections);
+            continue;
+        }
+        int allActive;
+        for (allActive = 0; allActive < 2; allActive++)
+        {
+            Timing::Time recvTimePerCall = 0.0;
+            const double roundTrips = RunPass(numConnections, allActive != 0, timer, recvTimePerCall);
+            n_printf("    %4d connections, %4d active: %9.0f round trips/s, Recv() %8.1f us/call\n",
+                numConnections, allActive ? numConnections : 1, roundTrips, recvTimePerCall * 1000000.0);
+        }
+    }
+}
+
+} // namespace Benchmarking
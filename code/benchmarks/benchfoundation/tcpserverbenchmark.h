@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::TcpServerBenchmark
+
+    Echoes 64 byte messages through a Net::TcpServer over loopback with
+    1, 10, 100 and 1000 connected clients, once with a single client
+    doing round trips while the others stay idle, and once with all
+    clients sending. Reports the round trips per second, and the time
+    the server spends in Recv() per call.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class TcpServerBenchmark : public Benchmark
+{
+    __DeclareClass(TcpServerBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------
+//  transformhierarchybenchmark.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "transformhierarchybenchmark.h"
+#include "basegamefeature/managers/entitymanager.h"
+#include "basegamefeature/managers/componentmanager.h"
+#include "basegamefeature/components/transformcomponent.h"
+#include "game/messaging/message.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::TransformHierarchyBenchmark, 'BMTH', Benchmarking::Benchmark);
+
+using namespace Game;
+
+static const SizeT NumInstances = 100000;
+static const SizeT NumPasses = 10;
+
+//------------------------------------------------------------------------------
+/**
+    Builds a hierarchy where instance i is a child of (i - 1) / numChildren,
+    so instance 0 is the single root.
+*/
+static void
+BuildHierarchy(SizeT numChildren)
+{
+    Util::Array<Entity> entities = EntityManager::Instance()->CreateEntities(NumInstances);
+    IndexT i;
+    for (i = 0; i < NumInstances; i++)
+    {
+        InstanceId instance = TransformComponent::RegisterEntity(entities[i]);
+        n_assert(instance == i);
+        if (i > 0)
+            TransformComponent::SetParent(instance, (InstanceId)((i - 1) / numChildren));
+    }
+    TransformComponent::UpdateWorldTransforms();
+    MessageDispatcher::DispatchFrameBatches();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns the average time of an update after dirtying every stride'th
+    instance, starting at the last one.
+*/
+static Timing::Time
+MeasureUpdate(SizeT stride, Timing::Timer& timer)
+{
+    const Math::matrix44 offset = Math::matrix44::translation(0.0f, 1.0f, 0.0f);
+    Timing::Time time = 0.0;
+    IndexT pass;
+    for (pass = 0; pass < NumPasses; pass++)
+    {
+        IndexT i;
+        for (i = NumInstances - 1; i >= 0; i -= stride)
+            TransformComponent::SetLocalTransform((InstanceId)i, offset);
+
+        const Timing::Time before = timer.GetTime();
+        timer.Start();
+        TransformComponent::UpdateWorldTransforms();
+        timer.Stop();
+        time += timer.GetTime() - before;
+
+        // the game server does this at the end of every frame
+        MessageDispatcher::DispatchFrameBatches();
+    }
+    return time / NumPasses;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TransformHierarchyBenchmark::Run(Timing::Timer& timer)
+{
+    MessageDispatcher::Setup();
+    Ptr<EntityManager> entityManager = EntityManager::Create();
+    Ptr<ComponentManager> componentManager = ComponentManager::Create();
+
+    const SizeT childCounts[] = { 8, 2 };
+    IndexT i;
+    for (i = 0; i < (IndexT)(sizeof(childCounts) / sizeof(SizeT)); i++)
+    {
+        TransformComponent::Create();
+        BuildHierarchy(childCounts[i]);
+
+        const Timing::Time all = MeasureUpdate(1, timer);
+        const Timing::Time some = MeasureUpdate(100, timer);
+        n_printf("    %d instances, %d children per node: %7.3f ms all dirty, %7.3f ms 1%% dirty\n",
+            NumInstances, childCounts[i], all * 1000.0, some * 1000.0);
+
+        componentManager->DeregisterAll();
+        TransformComponent::Discard();
+    }
+
+    componentManager = nullptr;
+    entityManager = nullptr;
+    MessageDispatcher::Discard();
+}
+
+} // namespace Benchmarking
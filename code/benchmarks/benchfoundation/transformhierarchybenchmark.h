@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::TransformHierarchyBenchmark
+
+    Measures TransformComponent::UpdateWorldTransforms on hierarchies of
+    100k instances, a wide one with 8 children per node and a deep one
+    with 2. Each shape is updated once with every instance dirty, and
+    once with only 1% of the leaves dirty.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "benchmarkbase/benchmark.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class TransformHierarchyBenchmark : public Benchmark
+{
+    __DeclareClass(TransformHierarchyBenchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
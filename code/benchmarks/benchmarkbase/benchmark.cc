@@ -0,0 +1,23 @@
+//------------------------------------------------------------------------------
+//  benchmark.cc
+//  (C) 2006 Radon Labs GmbH
+//  (C) 2013-2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "benchmarkbase/benchmark.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::Benchmark, 'BENC', Core::RefCounted);
+
+//------------------------------------------------------------------------------
+/**
+    Override this method in a subclass.
+*/
+void
+Benchmark::Run(Timing::Timer& timer)
+{
+    // empty
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,29 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::Benchmark
+
+    Base class for a benchmark. Override Run() and start and stop the timer
+    around the code which should be measured, so setup and teardown aren't
+    counted. The BenchmarkRunner prints the measured time, benchmarks which
+    sweep over several configurations print their own numbers as well.
+
+    (C) 2006 Radon Labs GmbH
+    (C) 2013-2020 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+#include "timing/timer.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class Benchmark : public Core::RefCounted
+{
+    __DeclareClass(Benchmark);
+public:
+    /// run the benchmark
+    virtual void Run(Timing::Timer& timer);
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
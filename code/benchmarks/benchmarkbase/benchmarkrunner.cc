@@ -0,0 +1,40 @@
+//------------------------------------------------------------------------------
+//  benchmarkrunner.cc
+//  (C) 2006 Radon Labs GmbH
+//  (C) 2013-2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "benchmarkbase/benchmarkrunner.h"
+
+namespace Benchmarking
+{
+__ImplementClass(Benchmarking::BenchmarkRunner, 'BENR', Core::RefCounted);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BenchmarkRunner::AttachBenchmark(Benchmark* benchmark)
+{
+    this->benchmarks.Append(benchmark);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BenchmarkRunner::Run()
+{
+    IndexT i;
+    for (i = 0; i < this->benchmarks.Size(); i++)
+    {
+        Benchmark* benchmark = this->benchmarks[i];
+        n_printf("-> Running benchmark: %s\n", benchmark->GetClassName().AsCharPtr());
+
+        Timing::Timer timer;
+        benchmark->Run(timer);
+        n_printf("   total: %.3f sec\n\n", timer.GetTime());
+    }
+}
+
+} // namespace Benchmarking
@@ -0,0 +1,32 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Benchmarking::BenchmarkRunner
+
+    Runs a list of benchmarks and prints the time each of them measured.
+
+    (C) 2006 Radon Labs GmbH
+    (C) 2013-2020 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+#include "benchmarkbase/benchmark.h"
+#include "util/array.h"
+
+//------------------------------------------------------------------------------
+namespace Benchmarking
+{
+class BenchmarkRunner : public Core::RefCounted
+{
+    __DeclareClass(BenchmarkRunner);
+public:
+    /// attach a benchmark
+    void AttachBenchmark(Benchmark* benchmark);
+    /// run all benchmarks
+    void Run();
+
+private:
+    Util::Array<Ptr<Benchmark>> benchmarks;
+};
+
+} // namespace Benchmarking
+//------------------------------------------------------------------------------
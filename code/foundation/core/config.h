@@ -59,6 +59,13 @@ static const int JobMaxSliceSize = 0xFFFF;
 #define NEBULA_MEMORY_ADVANCED_DEBUGGING (0)
 #endif
 
+// enable/disable the allocation tracker, it stays idle until Memory::TrackerEnable() is called
+#if NEBULA_DEBUG
+#define NEBULA_MEMORY_TRACKING (1)
+#else
+#define NEBULA_MEMORY_TRACKING (0)
+#endif
+
 // enable/disable memory pool allocation for refcounted object
 // FIXME -> memory pool is disabled for all platforms, cause it causes crashes (reproducable on xbox360)
 #if (__MAYA__ || __WIN32__ )
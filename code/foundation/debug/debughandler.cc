@@ -50,6 +50,8 @@ DebugHandler::Open()
     this->httpServerProxy = HttpServerProxy::Create();
     this->httpServerProxy->Open();
     this->httpServerProxy->AttachRequestHandler(Debug::DebugPageHandler::Create());
+    this->telemetryPageHandler = TelemetryPageHandler::Create();
+    this->httpServerProxy->AttachRequestHandler(this->telemetryPageHandler.upcast<HttpRequestHandler>());
 }
 
 //------------------------------------------------------------------------------
@@ -60,6 +62,9 @@ DebugHandler::Close()
 {
     n_assert(this->IsOpen());
 
+    this->telemetryPageHandler->CloseStreams();
+    this->telemetryPageHandler = nullptr;
+
     this->httpServerProxy->Close();
     this->httpServerProxy = nullptr;
 
@@ -79,6 +84,7 @@ DebugHandler::DoWork()
 {
     n_assert(this->IsOpen());
     this->httpServerProxy->HandlePendingRequests();
+    this->telemetryPageHandler->UpdateStreams();
     Timing::Sleep(0.1);
 }
 
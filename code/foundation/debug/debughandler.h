@@ -4,7 +4,8 @@
     @class Debug::DebugHandler
     
     The message handler for the debug interface. Just wakes up from time
-    to time to check for incoming Http requests.
+    to time to check for incoming Http requests, and to send new frames
+    to telemetry clients.
     
     (C) 2008 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
@@ -13,6 +14,7 @@
 #include "io/console.h"
 #include "debug/debugserver.h"
 #include "http/httpserverproxy.h"
+#include "debug/telemetrypagehandler.h"
 
 //------------------------------------------------------------------------------
 namespace Debug
@@ -36,6 +38,7 @@ public:
 private:
     Ptr<DebugServer> debugServer;
     Ptr<Http::HttpServerProxy> httpServerProxy;
+    Ptr<TelemetryPageHandler> telemetryPageHandler;
 };
 
 } // namespace Debug
@@ -38,6 +38,10 @@ DebugInterface::~DebugInterface()
 void
 DebugInterface::Open()
 {
+    // the telemetry collector is fed by the main thread, so it's created here
+    this->telemetryCollector = TelemetryCollector::Create();
+    this->telemetryCollector->Open();
+
     // setup the message handler thread object
     Ptr<RunThroughHandlerThread> handlerThread = RunThroughHandlerThread::Create();
     handlerThread->SetName("DebugInterface Thread");
@@ -51,4 +55,16 @@ DebugInterface::Open()
     InterfaceBase::Open();
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DebugInterface::Close()
+{
+    InterfaceBase::Close();
+
+    this->telemetryCollector->Close();
+    this->telemetryCollector = nullptr;
+}
+
 } // namespace Debug
@@ -11,6 +11,7 @@
 */
 #include "interface/interfacebase.h"
 #include "core/singleton.h"
+#include "debug/telemetrycollector.h"
 
 //------------------------------------------------------------------------------
 namespace Debug
@@ -26,6 +27,11 @@ public:
     virtual ~DebugInterface();
     /// open the interface object
     virtual void Open();
+    /// close the interface object
+    virtual void Close();
+
+private:
+    Ptr<TelemetryCollector> telemetryCollector;
 };
 
 } // namespace Debug
@@ -0,0 +1,281 @@
+//------------------------------------------------------------------------------
+//  profiling.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "debug/profiling.h"
+#include "io/ioserver.h"
+#include "threading/criticalsection.h"
+#include "threading/thread.h"
+#include "util/array.h"
+#include <stdio.h>
+
+namespace Debug
+{
+
+std::atomic<bool> ProfilingCaptureEnabled{ false };
+
+//------------------------------------------------------------------------------
+/**
+    Events of a single thread. Only the owning thread writes to it, count is
+    published with release semantics so that a reader sees complete events.
+    Buffers are never freed, so the events of threads which exited during a
+    capture can still be written out.
+*/
+struct ProfilingThreadBuffer
+{
+    static const SizeT Capacity = 65536;
+
+    char name[64];
+    uint tid;
+    std::atomic<uint> generation;
+    std::atomic<SizeT> count;
+    std::atomic<SizeT> dropped;
+    ProfilingEvent events[Capacity];
+};
+
+static Threading::CriticalSection profilingLock;
+static Util::Array<ProfilingThreadBuffer*> profilingBuffers;
+static std::atomic<uint> profilingGeneration{ 0 };
+static uint64_t profilingCaptureStartTicks = 0;
+static uint64_t profilingCaptureStartNanoseconds = 0;
+static uint64_t profilingCaptureEndTicks = 0;
+static uint64_t profilingCaptureEndNanoseconds = 0;
+static ThreadLocal ProfilingThreadBuffer* profilingThreadBuffer = nullptr;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static ProfilingThreadBuffer*
+ProfilingGetThreadBuffer()
+{
+    ProfilingThreadBuffer* buffer = profilingThreadBuffer;
+    if (buffer == nullptr)
+    {
+        buffer = new ProfilingThreadBuffer;
+
+        // touch all pages now instead of taking page faults while recording
+        Memory::Clear(buffer->events, sizeof(buffer->events));
+        const char* threadName = Threading::Thread::GetMyThreadName();
+        snprintf(buffer->name, sizeof(buffer->name), "%s", threadName != nullptr ? threadName : "Main");
+        buffer->generation = profilingGeneration.load(std::memory_order_acquire);
+        buffer->count = 0;
+        buffer->dropped = 0;
+
+        profilingLock.Enter();
+        buffer->tid = profilingBuffers.Size() + 1;
+        profilingBuffers.Append(buffer);
+        profilingLock.Leave();
+        profilingThreadBuffer = buffer;
+    }
+    return buffer;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingRecord(const char* name, const char* category, uint64_t start, uint64_t end)
+{
+    ProfilingThreadBuffer* buffer = ProfilingGetThreadBuffer();
+
+    // first event of this thread in a new capture, throw away the old ones
+    const uint generation = profilingGeneration.load(std::memory_order_acquire);
+    if (buffer->generation.load(std::memory_order_relaxed) != generation)
+    {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->generation.store(generation, std::memory_order_release);
+    }
+
+    const SizeT count = buffer->count.load(std::memory_order_relaxed);
+    if (count == ProfilingThreadBuffer::Capacity)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ProfilingEvent& event = buffer->events[count];
+    event.name = name;
+    event.category = category;
+    event.start = start;
+    event.duration = end - start;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingBeginCapture()
+{
+    profilingLock.Enter();
+    profilingCaptureStartNanoseconds = ProfilingNanoseconds();
+    profilingCaptureStartTicks = ProfilingTimestamp();
+    profilingCaptureEndTicks = 0;
+    profilingGeneration.fetch_add(1, std::memory_order_acq_rel);
+    ProfilingCaptureEnabled.store(true, std::memory_order_release);
+    profilingLock.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProfilingEndCapture()
+{
+    ProfilingCaptureEnabled.store(false, std::memory_order_release);
+    profilingLock.Enter();
+    profilingCaptureEndTicks = ProfilingTimestamp();
+    profilingCaptureEndNanoseconds = ProfilingNanoseconds();
+    profilingLock.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+ProfilingGetNumDroppedEvents()
+{
+    const uint generation = profilingGeneration.load(std::memory_order_acquire);
+    SizeT dropped = 0;
+    profilingLock.Enter();
+    IndexT i;
+    for (i = 0; i < profilingBuffers.Size(); i++)
+    {
+        if (profilingBuffers[i]->generation.load(std::memory_order_acquire) == generation)
+            dropped += profilingBuffers[i]->dropped.load(std::memory_order_relaxed);
+    }
+    profilingLock.Leave();
+    return dropped;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+ProfilingGetNumEvents()
+{
+    const uint generation = profilingGeneration.load(std::memory_order_acquire);
+    SizeT count = 0;
+    profilingLock.Enter();
+    IndexT i;
+    for (i = 0; i < profilingBuffers.Size(); i++)
+    {
+        if (profilingBuffers[i]->generation.load(std::memory_order_acquire) == generation)
+            count += profilingBuffers[i]->count.load(std::memory_order_acquire);
+    }
+    profilingLock.Leave();
+    return count;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Copy a string to a JSON string literal, returns the number of characters
+    written. Output is truncated to fit.
+*/
+static SizeT
+ProfilingEscape(char* dst, SizeT size, const char* str)
+{
+    SizeT written = 0;
+    if (str == nullptr)
+        str = "";
+    while (*str != 0 && written + 2 < size)
+    {
+        const char c = *str++;
+        if (c == '"' || c == '\\')
+            dst[written++] = '\\';
+        dst[written++] = ((uchar)c < 0x20) ? ' ' : c;
+    }
+    dst[written] = 0;
+    return written;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Writes complete ("X") events with timestamps in microseconds relative
+    to the start of the capture, plus a thread_name metadata event per thread.
+    Should be called after ProfilingEndCapture(), events recorded while
+    writing might be missing from the output.
+*/
+bool
+ProfilingWriteChromeTrace(const Ptr<IO::Stream>& stream)
+{
+    n_assert(stream.isvalid());
+    if (!stream->IsOpen())
+        return false;
+
+    const uint generation = profilingGeneration.load(std::memory_order_acquire);
+    char line[512];
+    char name[192];
+    char category[64];
+    bool first = true;
+
+    static const char* header = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    stream->Write(header, (IO::Stream::Size)strlen(header));
+
+    profilingLock.Enter();
+
+    // tick rate over the whole capture, or up to now if it is still running
+    uint64_t endTicks = profilingCaptureEndTicks;
+    uint64_t endNanoseconds = profilingCaptureEndNanoseconds;
+    if (endTicks == 0)
+    {
+        endTicks = ProfilingTimestamp();
+        endNanoseconds = ProfilingNanoseconds();
+    }
+    double microsecondsPerTick = 0.001;
+    if (endTicks > profilingCaptureStartTicks && endNanoseconds > profilingCaptureStartNanoseconds)
+        microsecondsPerTick = (endNanoseconds - profilingCaptureStartNanoseconds) / (1000.0 * (endTicks - profilingCaptureStartTicks));
+
+    IndexT i;
+    for (i = 0; i < profilingBuffers.Size(); i++)
+    {
+        const ProfilingThreadBuffer* buffer = profilingBuffers[i];
+        if (buffer->generation.load(std::memory_order_acquire) != generation)
+            continue;
+
+        ProfilingEscape(name, sizeof(name), buffer->name);
+        int len = snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", buffer->tid, name);
+        stream->Write(line, len);
+        first = false;
+
+        const SizeT count = buffer->count.load(std::memory_order_acquire);
+        IndexT j;
+        for (j = 0; j < count; j++)
+        {
+            const ProfilingEvent& event = buffer->events[j];
+            ProfilingEscape(name, sizeof(name), event.name);
+            ProfilingEscape(category, sizeof(category), event.category);
+            const double ts = (int64_t)(event.start - profilingCaptureStartTicks) * microsecondsPerTick;
+            const double dur = event.duration * microsecondsPerTick;
+            len = snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                name, category, ts, dur, buffer->tid);
+            stream->Write(line, len);
+        }
+    }
+    profilingLock.Leave();
+
+    static const char* footer = "\n]}\n";
+    stream->Write(footer, (IO::Stream::Size)strlen(footer));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ProfilingWriteChromeTrace(const IO::URI& uri)
+{
+    Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(uri);
+    stream->SetAccessMode(IO::Stream::WriteAccess);
+    if (stream->Open())
+    {
+        const bool result = ProfilingWriteChromeTrace(stream);
+        stream->Close();
+        return result;
+    }
+    return false;
+}
+
+} // namespace Debug
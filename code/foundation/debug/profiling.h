@@ -0,0 +1,184 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file debug/profiling.h
+
+    Scope based CPU profiler which records a timeline of every thread.
+
+    Put N_SCOPE(name, category) at the top of a block to record how long it
+    takes. Name and category must be string literals or otherwise outlive
+    the capture, StringAtom::Value() is fine. Scopes may be nested, and are
+    shown as a call hierarchy per thread by the trace viewer.
+
+    Every thread writes its events to its own buffer without any locking,
+    the buffer is only looked up through a thread local pointer. Nothing is
+    recorded unless a capture is running, in which case a scope costs two
+    reads of the time stamp counter and one store to the thread's buffer.
+    Ticks are converted to nanoseconds when the capture is written, using
+    the tick rate measured against the monotonic clock during the capture.
+    Events which don't fit into the buffer are dropped and counted.
+
+    A capture is written as Chrome trace event JSON, which can be opened
+    in chrome://tracing or ui.perfetto.dev.
+
+        Debug::ProfilingBeginCapture();
+        ...
+        Debug::ProfilingEndCapture();
+        Debug::ProfilingWriteChromeTrace("home:trace.json");
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include "io/stream.h"
+#include "io/uri.h"
+#include <atomic>
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define NEBULA_PROFILING_RDTSC 1
+#if __WIN32__
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define NEBULA_PROFILING_RDTSC 0
+#endif
+#if !__WIN32__
+#include <time.h>
+#endif
+
+//------------------------------------------------------------------------------
+#if NEBULA_ENABLE_PROFILING
+#define N_SCOPE_CONCAT_INTERNAL(a, b) a##b
+#define N_SCOPE_CONCAT(a, b) N_SCOPE_CONCAT_INTERNAL(a, b)
+#define N_SCOPE(name, category) Debug::ProfilingScope N_SCOPE_CONCAT(__profilingScope, __LINE__)(name, category);
+#else
+#define N_SCOPE(name, category)
+#endif
+
+//------------------------------------------------------------------------------
+namespace Debug
+{
+
+/// a single completed scope
+struct ProfilingEvent
+{
+    const char* name;
+    const char* category;
+    uint64_t start;         // ticks
+    uint64_t duration;      // ticks
+};
+
+/// start recording, discards the events of the previous capture
+void ProfilingBeginCapture();
+/// stop recording, scopes which are still open are not recorded
+void ProfilingEndCapture();
+/// returns true if a capture is running
+bool ProfilingIsCapturing();
+/// get the number of events which were dropped because a thread's buffer was full
+SizeT ProfilingGetNumDroppedEvents();
+/// get the number of events recorded by the current capture
+SizeT ProfilingGetNumEvents();
+/// write the current capture as chrome trace JSON
+bool ProfilingWriteChromeTrace(const Ptr<IO::Stream>& stream);
+/// write the current capture as chrome trace JSON to a file
+bool ProfilingWriteChromeTrace(const IO::URI& uri);
+
+/// get a timestamp in ticks, cheap enough to be taken twice per scope
+uint64_t ProfilingTimestamp();
+/// get a monotonic timestamp in nanoseconds, used to calibrate the ticks
+uint64_t ProfilingNanoseconds();
+/// record an event on the calling thread, used by ProfilingScope
+void ProfilingRecord(const char* name, const char* category, uint64_t start, uint64_t end);
+
+/// global capture state, use ProfilingIsCapturing()
+extern std::atomic<bool> ProfilingCaptureEnabled;
+
+//------------------------------------------------------------------------------
+/**
+    Records the time from its construction to its destruction.
+*/
+class ProfilingScope
+{
+public:
+    /// constructor, starts the scope
+    ProfilingScope(const char* name, const char* category);
+    /// destructor, records the scope
+    ~ProfilingScope();
+
+private:
+    const char* name;
+    const char* category;
+    uint64_t start;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Reading the monotonic clock costs 20-30ns even through the vDSO, rdtsc
+    is a fraction of that. All x86 CPUs of the last decade have an invariant
+    TSC, which ticks at a constant rate and is synchronized between cores.
+*/
+inline uint64_t
+ProfilingTimestamp()
+{
+#if NEBULA_PROFILING_RDTSC
+    return __rdtsc();
+#else
+    return ProfilingNanoseconds();
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    CLOCK_MONOTONIC_RAW is not slewed by NTP, so the tick rate is not
+    distorted while the clock is being adjusted.
+*/
+inline uint64_t
+ProfilingNanoseconds()
+{
+#if __WIN32__
+    static LARGE_INTEGER freq = { 0 };
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((counter.QuadPart / freq.QuadPart) * 1000000000ull + ((counter.QuadPart % freq.QuadPart) * 1000000000ull) / freq.QuadPart);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+ProfilingIsCapturing()
+{
+    return ProfilingCaptureEnabled.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline
+ProfilingScope::ProfilingScope(const char* name, const char* category) :
+    name(name),
+    category(category),
+    start(ProfilingIsCapturing() ? ProfilingTimestamp() : 0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline
+ProfilingScope::~ProfilingScope()
+{
+    if (this->start != 0 && ProfilingIsCapturing())
+        ProfilingRecord(this->name, this->category, this->start, ProfilingTimestamp());
+}
+
+} // namespace Debug
+//------------------------------------------------------------------------------
@@ -0,0 +1,352 @@
+//------------------------------------------------------------------------------
+//  telemetrycollector.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "debug/telemetrycollector.h"
+#include "debug/debugserver.h"
+#include "debug/debugtimer.h"
+#include "debug/debugcounter.h"
+#include "threading/interlocked.h"
+
+namespace Debug
+{
+__ImplementClass(Debug::TelemetryCollector, 'TLMC', Core::RefCounted);
+__ImplementInterfaceSingleton(Debug::TelemetryCollector);
+
+using namespace Util;
+using namespace Jobs;
+
+// job times are counted in nanoseconds
+static const double NanosecondsToMs = 1.0 / 1000000.0;
+
+//------------------------------------------------------------------------------
+/**
+*/
+TelemetryCollector::TelemetryCollector() :
+    isOpen(false),
+    capacity(256),
+    numClients(0),
+    isSampling(false),
+    frameIndex(0),
+    lastTime(0.0),
+    schemaVersion(0),
+    firstFrame(0),
+    firstRow(0),
+    numFrames(0)
+{
+    __ConstructInterfaceSingleton;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TelemetryCollector::~TelemetryCollector()
+{
+    n_assert(!this->isOpen);
+    __DestructInterfaceSingleton;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TelemetryCollector::SetCapacity(SizeT numFrames)
+{
+    n_assert(!this->isOpen);
+    n_assert(numFrames > 0);
+    this->capacity = numFrames;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TelemetryCollector::Open()
+{
+    n_assert(!this->isOpen);
+    this->timer.Start();
+    this->isOpen = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TelemetryCollector::Close()
+{
+    n_assert(this->isOpen);
+    this->timer.Stop();
+    this->timers.Clear();
+    this->counters.Clear();
+    this->portStats.Clear();
+    this->critSect.Enter();
+    this->channels.Clear();
+    this->values.SetSize(0);
+    this->numFrames = 0;
+    this->critSect.Leave();
+    this->isOpen = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+    May be called from any thread.
+*/
+void
+TelemetryCollector::AttachClient()
+{
+    Threading::Interlocked::Increment(this->numClients);
+}
+
+//------------------------------------------------------------------------------
+/**
+    May be called from any thread.
+*/
+void
+TelemetryCollector::DetachClient()
+{
+    n_assert(this->numClients > 0);
+    Threading::Interlocked::Decrement(this->numClients);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The first frame after a client attached, or after the channels changed,
+    only sets the baseline for the frame time and the job totals, so all
+    values of a frame are per-frame values.
+*/
+void
+TelemetryCollector::OnFrame()
+{
+    this->frameIndex++;
+    if (!this->isOpen || (0 == this->numClients))
+    {
+        this->isSampling = false;
+        return;
+    }
+
+    Timing::Time time = this->timer.GetTime();
+    bool changed = this->ChannelsChanged();
+    if (!this->isSampling || changed)
+    {
+        this->SetupChannels();
+        this->SampleJobTotals(this->prevJobTotals);
+        this->lastTime = time;
+        this->isSampling = true;
+        return;
+    }
+
+    // frame time, debug timers and debug counters
+    this->row.Clear();
+    this->row.Append((time - this->lastTime) * 1000.0);
+    this->lastTime = time;
+    IndexT i;
+    for (i = 0; i < this->timers.Size(); i++)
+    {
+        this->row.Append(this->timers[i]->GetSample());
+    }
+    for (i = 0; i < this->counters.Size(); i++)
+    {
+        this->row.Append(double(this->counters[i]->GetSample()));
+    }
+
+    // job counters are totals, the channels get the difference to the last frame
+    this->SampleJobTotals(this->jobTotals);
+    for (i = 0; i < this->jobTotals.Size(); i++)
+    {
+        this->row.Append(this->jobTotals[i] - this->prevJobTotals[i]);
+    }
+    this->prevJobTotals = this->jobTotals;
+
+#if NEBULA_MEMORY_STATS
+    for (i = 0; i < Memory::NumHeapTypes; i++)
+    {
+        this->row.Append(double(Memory::HeapTypeAllocSize[i]));
+    }
+#elif NEBULA_MEMORY_THREADCACHE
+    // the thread caches keep their counters without NEBULA_MEMORY_STATS
+    Memory::ThreadCacheHeapStats heapStats[Memory::NumHeapTypes];
+    Memory::ThreadCacheGetStats(heapStats);
+    for (i = 0; i < Memory::NumHeapTypes; i++)
+    {
+        this->row.Append(double(int64_t(heapStats[i].allocSize - heapStats[i].freeSize)));
+    }
+#endif
+
+    // append the frame to the ring buffer, the oldest frame gets overwritten when it's full
+    const SizeT numChannels = this->row.Size();
+    this->critSect.Enter();
+    n_assert(numChannels == this->channels.Size());
+    IndexT rowIndex;
+    if (this->numFrames < this->capacity)
+    {
+        rowIndex = (this->firstRow + this->numFrames) % this->capacity;
+        this->numFrames++;
+    }
+    else
+    {
+        rowIndex = this->firstRow;
+        this->firstRow = (this->firstRow + 1) % this->capacity;
+        this->firstFrame++;
+    }
+    Memory::Copy(&this->row[0], &this->values[rowIndex * numChannels], numChannels * sizeof(double));
+    this->critSect.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+    The stored timers, counters and job ports are updated in SetupChannels(),
+    the job port stats are refreshed every frame.
+*/
+bool
+TelemetryCollector::ChannelsChanged()
+{
+    bool changed = false;
+    if (DebugServer::HasInstance())
+    {
+        DebugServer* debugServer = DebugServer::Instance();
+        changed |= (debugServer->GetDebugTimers() != this->timers);
+        changed |= (debugServer->GetDebugCounters() != this->counters);
+    }
+    SizeT numPorts = this->portStats.Size();
+    JobGetPortStats(this->portStats);
+    changed |= (numPorts != this->portStats.Size());
+    return changed;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TelemetryCollector::SetupChannels()
+{
+    if (DebugServer::HasInstance())
+    {
+        this->timers = DebugServer::Instance()->GetDebugTimers();
+        this->counters = DebugServer::Instance()->GetDebugCounters();
+    }
+
+    Array<String> names;
+    names.Append("frameTime");
+    IndexT i;
+    for (i = 0; i < this->timers.Size(); i++)
+    {
+        names.Append("timer/" + this->timers[i]->GetName().AsString());
+    }
+    for (i = 0; i < this->counters.Size(); i++)
+    {
+        names.Append("counter/" + this->counters[i]->GetName().AsString());
+    }
+    for (i = 0; i < this->portStats.Size(); i++)
+    {
+        String port = "jobs/" + this->portStats[i].name.AsString();
+        names.Append(port + "/commands");
+        names.Append(port + "/execMs");
+        names.Append(port + "/queueMs");
+        names.Append(port + "/waitMs");
+    }
+    names.Append("jobs/hostWaitMs");
+#if NEBULA_MEMORY_STATS || NEBULA_MEMORY_THREADCACHE
+    for (i = 0; i < Memory::NumHeapTypes; i++)
+    {
+        names.Append(String("memory/") + Memory::GetHeapTypeName((Memory::HeapType)i));
+    }
+#endif
+
+    // start over with an empty ring buffer
+    this->critSect.Enter();
+    this->schemaVersion++;
+    this->channels = names;
+    this->values.SetSize(this->capacity * this->channels.Size());
+    this->firstFrame = this->frameIndex + 1;
+    this->firstRow = 0;
+    this->numFrames = 0;
+    this->critSect.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Four totals per job port, summed up over its threads, followed by
+    the time the main thread waited for jobs.
+*/
+void
+TelemetryCollector::SampleJobTotals(Array<double>& outTotals) const
+{
+    outTotals.Clear();
+    IndexT i;
+    for (i = 0; i < this->portStats.Size(); i++)
+    {
+        uint64_t numCommands = 0;
+        uint64_t executionTime = 0;
+        uint64_t queueTime = 0;
+        uint64_t waitTime = 0;
+        IndexT j;
+        for (j = 0; j < this->portStats[i].threads.Size(); j++)
+        {
+            const JobThreadStats& stats = this->portStats[i].threads[j];
+            numCommands += stats.numCommands;
+            executionTime += stats.executionTime;
+            queueTime += stats.queueTime;
+            waitTime += stats.waitTime;
+        }
+        outTotals.Append(double(numCommands));
+        outTotals.Append(executionTime * NanosecondsToMs);
+        outTotals.Append(queueTime * NanosecondsToMs);
+        outTotals.Append(waitTime * NanosecondsToMs);
+    }
+    outTotals.Append(JobGetHostWaitStats().waitTime * NanosecondsToMs);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Copies the frames from inOutFrameIndex on into outValues, one row of
+    values per frame, and returns the number of frames. Frames which have
+    already been overwritten are skipped, inOutFrameIndex is set to the
+    index of the first copied frame. If inOutSchemaVersion isn't the
+    current schema version, the channel names are copied to outChannels
+    and all frames of the current schema are copied, otherwise outChannels
+    is left empty. May be called from any thread.
+*/
+SizeT
+TelemetryCollector::ReadFrames(uint& inOutSchemaVersion, uint64_t& inOutFrameIndex, Array<String>& outChannels, Array<double>& outValues) const
+{
+    outChannels.Clear();
+    outValues.Clear();
+    this->critSect.Enter();
+    if (inOutSchemaVersion != this->schemaVersion)
+    {
+        inOutSchemaVersion = this->schemaVersion;
+        inOutFrameIndex = this->firstFrame;
+        outChannels = this->channels;
+    }
+    else if (inOutFrameIndex < this->firstFrame)
+    {
+        inOutFrameIndex = this->firstFrame;
+    }
+    const uint64_t endFrame = this->firstFrame + this->numFrames;
+    SizeT numCopied = 0;
+    if (inOutFrameIndex < endFrame)
+    {
+        const SizeT numChannels = this->channels.Size();
+        numCopied = SizeT(endFrame - inOutFrameIndex);
+        outValues.Reserve(numCopied * numChannels);
+        IndexT i;
+        for (i = 0; i < numCopied; i++)
+        {
+            IndexT rowIndex = (this->firstRow + IndexT(inOutFrameIndex - this->firstFrame) + i) % this->capacity;
+            IndexT channelIndex;
+            for (channelIndex = 0; channelIndex < numChannels; channelIndex++)
+            {
+                outValues.Append(this->values[rowIndex * numChannels + channelIndex]);
+            }
+        }
+    }
+    else
+    {
+        inOutFrameIndex = endFrame;
+    }
+    this->critSect.Leave();
+    return numCopied;
+}
+
+} // namespace Debug
@@ -0,0 +1,121 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Debug::TelemetryCollector
+
+    Samples per-frame metrics into a ring buffer, from where they are
+    streamed to telemetry clients (see TelemetryPageHandler).
+
+    A frame is one row of values, one value per channel: the frame time,
+    the samples of all debug timers and debug counters, the job commands
+    and job times of each job port (per frame, in milliseconds), the time
+    the main thread waited for jobs, and the allocated size of each heap
+    (with NEBULA_MEMORY_STATS, or from the thread caches with
+    NEBULA_MEMORY_THREADCACHE). The channels change whenever a timer,
+    counter or job port is added or removed, in which case the ring buffer
+    starts over and the schema version increments.
+
+    OnFrame() must be called once per frame from the main thread. It
+    returns right away as long as no client is attached, so the collector
+    doesn't cost anything when nobody is looking.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+#include "core/singleton.h"
+#include "threading/criticalsection.h"
+#include "timing/timer.h"
+#include "util/fixedarray.h"
+#include "jobs/jobs.h"
+
+//------------------------------------------------------------------------------
+namespace Debug
+{
+class DebugCounter;
+class DebugTimer;
+
+class TelemetryCollector : public Core::RefCounted
+{
+    __DeclareClass(TelemetryCollector);
+    __DeclareInterfaceSingleton(TelemetryCollector);
+public:
+    /// constructor
+    TelemetryCollector();
+    /// destructor
+    virtual ~TelemetryCollector();
+
+    /// set the number of frames kept in the ring buffer, call before Open()
+    void SetCapacity(SizeT numFrames);
+    /// open the collector
+    void Open();
+    /// close the collector
+    void Close();
+    /// return true if the collector is open
+    bool IsOpen() const;
+
+    /// sample the frame which just ended, call once per frame from the main thread
+    void OnFrame();
+
+    /// attach a client, frames are only sampled while a client is attached
+    void AttachClient();
+    /// detach a client
+    void DetachClient();
+    /// return true if a client is attached
+    bool IsActive() const;
+    /// copy the frames from a frame index on, see the method for details
+    SizeT ReadFrames(uint& inOutSchemaVersion, uint64_t& inOutFrameIndex, Util::Array<Util::String>& outChannels, Util::Array<double>& outValues) const;
+
+private:
+    /// return true if timers, counters or job ports have been added or removed
+    bool ChannelsChanged();
+    /// rebuild the channel names and start over
+    void SetupChannels();
+    /// sample the current totals of the job ports
+    void SampleJobTotals(Util::Array<double>& outTotals) const;
+
+    bool isOpen;
+    SizeT capacity;
+    int volatile numClients;
+
+    // only touched by the main thread
+    bool isSampling;
+    uint64_t frameIndex;
+    Timing::Timer timer;
+    Timing::Time lastTime;
+    Util::Array<Ptr<DebugTimer>> timers;
+    Util::Array<Ptr<DebugCounter>> counters;
+    Util::Array<Jobs::JobPortStats> portStats;
+    Util::Array<double> jobTotals;
+    Util::Array<double> prevJobTotals;
+    Util::Array<double> row;
+
+    // shared with the readers
+    Threading::CriticalSection critSect;
+    uint schemaVersion;
+    Util::Array<Util::String> channels;
+    Util::FixedArray<double> values;
+    uint64_t firstFrame;
+    IndexT firstRow;
+    SizeT numFrames;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+TelemetryCollector::IsOpen() const
+{
+    return this->isOpen;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+TelemetryCollector::IsActive() const
+{
+    return 0 != this->numClients;
+}
+
+} // namespace Debug
+//------------------------------------------------------------------------------
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+//  telemetrypagehandler.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "debug/telemetrypagehandler.h"
+#include "debug/telemetrycollector.h"
+#include "io/memorystream.h"
+
+namespace Debug
+{
+__ImplementClass(Debug::TelemetryPageHandler, 'TLPH', Http::HttpRequestHandler);
+
+using namespace Http;
+using namespace Util;
+using namespace IO;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+AppendJsonString(String& text, const String& str)
+{
+    text.Append("\"");
+    const char* ptr = str.AsCharPtr();
+    const char* begin = ptr;
+    for (; 0 != *ptr; ptr++)
+    {
+        if (('"' == *ptr) || ('\\' == *ptr))
+        {
+            text.AppendRange(begin, SizeT(ptr - begin));
+            text.Append("\\");
+            begin = ptr;
+        }
+    }
+    text.AppendRange(begin, SizeT(ptr - begin));
+    text.Append("\"");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TelemetryPageHandler::TelemetryPageHandler()
+{
+    this->SetName("Telemetry");
+    this->SetDesc("stream per-frame metrics as server-sent events");
+    this->SetRootLocation("telemetry");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TelemetryPageHandler::~TelemetryPageHandler()
+{
+    n_assert(this->streams.IsEmpty());
+}
+
+//------------------------------------------------------------------------------
+/**
+    The content of a stream is discarded with every flush, which needs
+    chunked transfer encoding, so HTTP/1.0 clients are turned away.
+*/
+void
+TelemetryPageHandler::HandleRequest(const Ptr<HttpRequest>& request)
+{
+    if (!TelemetryCollector::HasInstance())
+    {
+        request->SetStatus(HttpStatus::ServiceUnavailable);
+        return;
+    }
+    if ((HttpMethod::Get != request->GetMethod()) || (request->GetHttpVersion() == "HTTP/1.0"))
+    {
+        request->SetStatus(HttpStatus::BadRequest);
+        return;
+    }
+
+    // keep the request open, and send the response header right away
+    request->SetStatus(HttpStatus::OK);
+    request->GetResponseContentStream()->SetMediaType(MediaType("text/event-stream"));
+    request->SetDeferred(true);
+    this->WriteEvents(request, "retry: 1000\n\n");
+
+    EventStream stream;
+    stream.request = request;
+    stream.schemaVersion = 0;
+    stream.nextFrame = 0;
+    this->streams.Append(stream);
+    TelemetryCollector::Instance()->AttachClient();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TelemetryPageHandler::UpdateStreams()
+{
+    IndexT i;
+    for (i = 0; i < this->streams.Size();)
+    {
+        EventStream& stream = this->streams[i];
+        if (stream.request->IsCanceled())
+        {
+            // the client is gone
+            TelemetryCollector::Instance()->DetachClient();
+            stream.request->SetHandled(true);
+            this->streams.EraseIndex(i);
+            continue;
+        }
+
+        SizeT numFrames = TelemetryCollector::Instance()->ReadFrames(stream.schemaVersion, stream.nextFrame, this->channels, this->values);
+        this->text.Clear();
+        if (!this->channels.IsEmpty())
+        {
+            this->text.Append("event: channels\ndata: [");
+            IndexT channelIndex;
+            for (channelIndex = 0; channelIndex < this->channels.Size(); channelIndex++)
+            {
+                if (channelIndex > 0)
+                {
+                    this->text.Append(",");
+                }
+                AppendJsonString(this->text, this->channels[channelIndex]);
+            }
+            this->text.Append("]\n\n");
+        }
+        if (numFrames > 0)
+        {
+            const SizeT numChannels = this->values.Size() / numFrames;
+            char buf[64];
+            IndexT frameIndex;
+            for (frameIndex = 0; frameIndex < numFrames; frameIndex++)
+            {
+                int len = snprintf(buf, sizeof(buf), "data: [%llu", (unsigned long long)(stream.nextFrame + frameIndex));
+                this->text.AppendRange(buf, len);
+                IndexT channelIndex;
+                for (channelIndex = 0; channelIndex < numChannels; channelIndex++)
+                {
+                    len = snprintf(buf, sizeof(buf), ",%.6g", this->values[frameIndex * numChannels + channelIndex]);
+                    this->text.AppendRange(buf, len);
+                }
+                this->text.Append("]\n\n");
+            }
+            stream.nextFrame += numFrames;
+        }
+        if (this->text.IsValid())
+        {
+            this->WriteEvents(stream.request, this->text);
+        }
+        i++;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The HttpServer ends the responses of the streams, if it's still
+    running.
+*/
+void
+TelemetryPageHandler::CloseStreams()
+{
+    IndexT i;
+    for (i = 0; i < this->streams.Size(); i++)
+    {
+        TelemetryCollector::Instance()->DetachClient();
+        this->streams[i].request->SetHandled(true);
+    }
+    this->streams.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TelemetryPageHandler::WriteEvents(const Ptr<HttpRequest>& request, const String& events)
+{
+    const Ptr<IO::Stream>& content = request->GetResponseContentStream();
+    content->SetAccessMode(IO::Stream::AppendAccess);
+    if (content->Open())
+    {
+        content->Write(events.AsCharPtr(), events.Length());
+        content->Close();
+    }
+    request->FlushResponseContent(true);
+}
+
+} // namespace Debug
@@ -0,0 +1,64 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Debug::TelemetryPageHandler
+
+    Http request handler which streams the frames of the TelemetryCollector
+    as server-sent events (text/event-stream), so tools can record or plot
+    the metrics while the application runs:
+
+    event: channels
+    data: ["frameTime","timer/...",...]
+
+    data: [frameIndex,frameTime,...]
+
+    A channels event is sent first and whenever the channels change, after
+    that every frame is one data event, with the frame index followed by
+    one value per channel. A gap in the frame indices means the client
+    couldn't keep up and frames have been dropped.
+
+    The requests stay open until the client disconnects, new frames are
+    written by UpdateStreams(), which must be called frequently from the
+    thread of the request handler.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "http/httprequesthandler.h"
+
+//------------------------------------------------------------------------------
+namespace Debug
+{
+class TelemetryPageHandler : public Http::HttpRequestHandler
+{
+    __DeclareClass(TelemetryPageHandler);
+public:
+    /// constructor
+    TelemetryPageHandler();
+    /// destructor
+    virtual ~TelemetryPageHandler();
+    /// handle a http request
+    virtual void HandleRequest(const Ptr<Http::HttpRequest>& request);
+
+    /// write new frames to the open streams
+    void UpdateStreams();
+    /// end all open streams
+    void CloseStreams();
+
+private:
+    /// write text to the response of a stream and hand it to the HttpServer
+    void WriteEvents(const Ptr<Http::HttpRequest>& request, const Util::String& text);
+
+    struct EventStream
+    {
+        Ptr<Http::HttpRequest> request;
+        uint schemaVersion;
+        uint64_t nextFrame;
+    };
+    Util::Array<EventStream> streams;
+    Util::Array<Util::String> channels;
+    Util::Array<double> values;
+    Util::String text;
+};
+
+} // namespace Debug
+//------------------------------------------------------------------------------
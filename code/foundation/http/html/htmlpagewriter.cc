@@ -37,11 +37,9 @@ HtmlPageWriter::Open()
 {
     if (StreamWriter::Open())
     {
-        // create an XmlWriter and attach it to our stream
-        this->xmlWriter = XmlWriter::Create();
-        this->xmlWriter->SetStream(this->stream);
-        this->xmlWriter->Open();
-        
+        // set the MIME type right away, a request handler may flush the page before it is complete
+        this->stream->SetMediaType(MediaType("text/html"));
+        this->Write("<!DOCTYPE html>\n");
         this->Begin(HtmlElement::Html);
         this->Begin(HtmlElement::Head);
         this->Begin(HtmlElement::Title);
@@ -80,13 +78,6 @@ HtmlPageWriter::Close()
     this->End(HtmlElement::Html);
     n_assert(elementStack.IsEmpty());
 
-    // close XML writer
-    this->xmlWriter->Close();
-    this->xmlWriter = nullptr;
-
-    // set MIME type on our stream
-    this->stream->SetMediaType(MediaType("text/html"));    
-
     // call parent class
     StreamWriter::Close();
 }
@@ -115,13 +106,19 @@ HtmlPageWriter::Begin(HtmlElement::Code element)
 {
     n_assert(this->IsOpen());
     this->elementStack.Push(element);
-    this->xmlWriter->BeginNode(HtmlElement::ToHtml(element));
+    this->Write("<");
+    this->Write(HtmlElement::ToHtml(element));
     IndexT i;
     for (i = 0; i < this->attrs.Size(); i++)
     {
-        this->xmlWriter->SetString(this->attrs[i].Key(), this->attrs[i].Value());
+        this->Write(" ");
+        this->Write(this->attrs[i].Key());
+        this->Write("=\"");
+        this->WriteEscaped(this->attrs[i].Value());
+        this->Write("\"");
     }
     this->attrs.Clear();
+    this->Write(">");
 }
 
 //------------------------------------------------------------------------------
@@ -135,7 +132,9 @@ HtmlPageWriter::End(HtmlElement::Code element)
     n_assert(!this->elementStack.IsEmpty());
     n_assert(this->elementStack.Peek() == element);
     this->elementStack.Pop();
-    this->xmlWriter->EndNode();
+    this->Write("</");
+    this->Write(HtmlElement::ToHtml(element));
+    this->Write(">\n");
 }
 
 //------------------------------------------------------------------------------
@@ -145,8 +144,7 @@ void
 HtmlPageWriter::LineBreak()
 {
     n_assert(this->IsOpen());
-    this->xmlWriter->BeginNode("br");
-    this->xmlWriter->EndNode();
+    this->Write("<br>\n");
 }
 
 //------------------------------------------------------------------------------
@@ -156,8 +154,7 @@ void
 HtmlPageWriter::HorizontalRule()
 {
     n_assert(this->IsOpen());
-    this->xmlWriter->BeginNode("hr");
-    this->xmlWriter->EndNode();
+    this->Write("<hr>\n");
 }
 
 //------------------------------------------------------------------------------
@@ -166,7 +163,8 @@ HtmlPageWriter::HorizontalRule()
 void
 HtmlPageWriter::Text(const Util::String& str)
 {
-    this->xmlWriter->WriteContent(str);
+    n_assert(this->IsOpen());
+    this->WriteEscaped(str);
 }
 
 //------------------------------------------------------------------------------
@@ -175,7 +173,8 @@ HtmlPageWriter::Text(const Util::String& str)
 void 
 HtmlPageWriter::Raw( const Util::String& r )
 {
-    this->xmlWriter->WriteRaw(r);
+    n_assert(this->IsOpen());
+    this->Write(r);
 }
 
 //------------------------------------------------------------------------------
@@ -201,4 +200,43 @@ HtmlPageWriter::TableRow2(const String& col0, const String& col1)
     this->End(HtmlElement::TableRow);   
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HtmlPageWriter::Write(const String& str)
+{
+    this->stream->Write(str.AsCharPtr(), str.Length());
+}
+
+//------------------------------------------------------------------------------
+/**
+    Used for text and attribute values, so quotes are replaced as well.
+*/
+void
+HtmlPageWriter::WriteEscaped(const String& str)
+{
+    const char* ptr = str.AsCharPtr();
+    const char* begin = ptr;
+    for (; 0 != *ptr; ptr++)
+    {
+        const char* entity = nullptr;
+        switch (*ptr)
+        {
+            case '&':   entity = "&amp;"; break;
+            case '<':   entity = "&lt;"; break;
+            case '>':   entity = "&gt;"; break;
+            case '"':   entity = "&quot;"; break;
+            default:    break;
+        }
+        if (nullptr != entity)
+        {
+            this->stream->Write(begin, SizeT(ptr - begin));
+            this->stream->Write(entity, (SizeT)strlen(entity));
+            begin = ptr + 1;
+        }
+    }
+    this->stream->Write(begin, SizeT(ptr - begin));
+}
+
 } // namespace Http
\ No newline at end of file
@@ -6,13 +6,17 @@
     @class Http::HtmlPageWriter
     
     A stream writer which supports writing a HTML-formatted page into a stream.
+
+    The HTML is written to the stream right away, so a request handler can
+    flush a part of a large page with HttpRequest::FlushResponseContent()
+    while it writes the rest. The media type is set on the stream when
+    the writer is opened.
     
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "io/streamwriter.h"
 #include "http/html/htmlelement.h"
-#include "io/xmlwriter.h"
 #include "util/array.h"
 #include "util/stack.h"
 
@@ -57,9 +61,13 @@ public:
     void TableRow2(const Util::String& col0, const Util::String& col1);
 
 private:
+    /// write a string to the stream
+    void Write(const Util::String& str);
+    /// write a string with the HTML special characters replaced
+    void WriteEscaped(const Util::String& str);
+
     Util::String title;
     Util::String style;
-    Ptr<IO::XmlWriter> xmlWriter;
     Util::Array<Util::KeyValuePair<Util::String,Util::String> > attrs;
     Util::Stack<HtmlElement::Code> elementStack;
 };
@@ -0,0 +1,85 @@
+#pragma once
+#ifndef HTTP_HTTPCONTENTENCODING_H
+#define HTTP_HTTPCONTENTENCODING_H
+//------------------------------------------------------------------------------
+/**
+    @class Http::HttpContentEncoding
+
+    Http content encodings (gzip, deflate), as accepted by a client in the
+    Accept-Encoding header and used by the server in the Content-Encoding
+    header of a response. The set of encodings a client accepts is kept
+    as a bit mask, see ToMask().
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "util/string.h"
+
+//------------------------------------------------------------------------------
+namespace Http
+{
+class HttpContentEncoding
+{
+public:
+    /// content encodings
+    enum Code
+    {
+        Identity,
+        Deflate,
+        Gzip,
+
+        NumHttpContentEncodings,
+        InvalidHttpContentEncoding,
+    };
+
+    /// convert from string
+    static Code FromString(const Util::String& str);
+    /// convert to string
+    static Util::String ToString(Code c);
+    /// convert to a bit in a mask of encodings
+    static uint ToMask(Code c);
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline HttpContentEncoding::Code
+HttpContentEncoding::FromString(const Util::String& str)
+{
+    if (0 == n_stricmp(str.AsCharPtr(), "identity")) return Identity;
+    else if (0 == n_stricmp(str.AsCharPtr(), "deflate")) return Deflate;
+    else if (0 == n_stricmp(str.AsCharPtr(), "gzip")) return Gzip;
+    else
+    {
+        return InvalidHttpContentEncoding;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline Util::String
+HttpContentEncoding::ToString(Code c)
+{
+    switch (c)
+    {
+        case Identity:  return "identity";
+        case Deflate:   return "deflate";
+        case Gzip:      return "gzip";
+        default:
+            return "InvalidHttpContentEncoding";
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+HttpContentEncoding::ToMask(Code c)
+{
+    n_assert(c < NumHttpContentEncodings);
+    return (1 << c);
+}
+
+} // namespace Http
+//------------------------------------------------------------------------------
+#endif
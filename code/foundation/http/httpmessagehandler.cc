@@ -63,16 +63,16 @@ HttpMessageHandler::Close()
 
 //------------------------------------------------------------------------------
 /**
-    Triggers the http server from time to time.
+    Triggers the http server whenever there is something to serve. The
+    wait is limited, so messages to the handler are not held back.
 */
 void
 HttpMessageHandler::DoWork()
 {
     n_assert(this->IsOpen());
 
-    // only process http requests once in a while
     this->httpServer->OnFrame();
-    Core::SysFunc::Sleep(0.1f);   
+    this->httpServer->WaitForWork(100);
 }
 
 //------------------------------------------------------------------------------
@@ -11,12 +11,18 @@ namespace Http
 __ImplementClass(Http::HttpRequest, 'HTRQ', Messaging::Message);
 __ImplementMsgId(HttpRequest);
 
+using namespace IO;
+
 //------------------------------------------------------------------------------
 /**
 */
 HttpRequest::HttpRequest() :
     method(HttpMethod::InvalidHttpMethod),
-    status(HttpStatus::InvalidHttpStatus)
+    status(HttpStatus::InvalidHttpStatus),
+    keepAlive(false),
+    acceptedEncodings(0),
+    canceled(0),
+    flushedSize(0)
 {
     // empty
 }
@@ -29,4 +35,78 @@ HttpRequest::~HttpRequest()
     // empty
 }
 
+//------------------------------------------------------------------------------
+/**
+    The content written since the last flush is copied, the response
+    content stream itself is left alone, since the request handler may
+    still have a writer open on it. If the content is discarded, the
+    content stream is emptied instead, it must not be open then. Discarded
+    content can't be sent in one piece anymore, so this needs a client
+    which accepts chunked transfer encoding (HTTP/1.1).
+*/
+void
+HttpRequest::FlushResponseContent(bool discardContent)
+{
+    n_assert(this->responseContentStream->IsA(MemoryStream::RTTI));
+    const Ptr<MemoryStream>& content = this->responseContentStream.downcast<MemoryStream>();
+    SizeT size = content->GetSize();
+    if (size > this->flushedSize)
+    {
+        const uchar* ptr = (const uchar*)content->GetRawPointer();
+        this->flushCritSect.Enter();
+        if (!this->flushedContent.isvalid())
+        {
+            this->flushedContent = MemoryStream::Create();
+        }
+        this->flushedContent->SetAccessMode(Stream::AppendAccess);
+        if (this->flushedContent->Open())
+        {
+            this->flushedContent->Write(ptr + this->flushedSize, size - this->flushedSize);
+            this->flushedContent->Close();
+        }
+        this->flushCritSect.Leave();
+        this->flushedSize = size;
+    }
+    if (discardContent)
+    {
+        n_assert(!content->IsOpen());
+        content->SetSize(0);
+        this->flushedSize = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+HttpRequest::HasFlushedContent() const
+{
+    this->flushCritSect.Enter();
+    bool flushed = this->flushedContent.isvalid() && (this->flushedContent->GetSize() > 0);
+    this->flushCritSect.Leave();
+    return flushed;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The given stream must be empty, it receives the flushed content
+    and the request keeps the given stream to collect the next flushes.
+*/
+bool
+HttpRequest::DequeueFlushedContent(Ptr<MemoryStream>& inOutStream)
+{
+    n_assert(inOutStream.isvalid() && (0 == inOutStream->GetSize()));
+    bool flushed = false;
+    this->flushCritSect.Enter();
+    if (this->flushedContent.isvalid() && (this->flushedContent->GetSize() > 0))
+    {
+        Ptr<MemoryStream> content = this->flushedContent;
+        this->flushedContent = inOutStream;
+        inOutStream = content;
+        flushed = true;
+    }
+    this->flushCritSect.Leave();
+    return flushed;
+}
+
 } // namespace Http
@@ -6,6 +6,18 @@
     @class Http::HttpRequest
     
     Encapsulates a complete Http request into a message.
+
+    A request handler which produces a lot of content may call
+    FlushResponseContent() from time to time while it writes the response
+    content stream. The HttpServer then starts to send the response
+    with chunked transfer encoding while the handler is still busy. The
+    status and the media type of the response content stream must be set
+    before the first flush and must not change afterwards.
+
+    A request handler which streams content for an open-ended time marks
+    the request as deferred, so it isn't set to handled after
+    HandleRequest(), and discards the content with every flush. The
+    HttpServer cancels the request when the client goes away.
     
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
@@ -14,6 +26,9 @@
 #include "http/httpmethod.h"
 #include "http/httpstatus.h"
 #include "io/uri.h"
+#include "io/memorystream.h"
+#include "threading/criticalsection.h"
+#include "threading/interlocked.h"
 
 //------------------------------------------------------------------------------
 namespace Http
@@ -44,12 +59,43 @@ public:
     void SetStatus(HttpStatus::Code status);
     /// get the http status 
     HttpStatus::Code GetStatus() const;
+    /// set the http version of the request (e.g. "HTTP/1.1")
+    void SetHttpVersion(const Util::String& version);
+    /// get the http version of the request
+    const Util::String& GetHttpVersion() const;
+    /// set whether the client wants to keep the connection open
+    void SetKeepAlive(bool b);
+    /// get whether the client wants to keep the connection open
+    bool GetKeepAlive() const;
+    /// set the content encodings the client accepts, as mask of HttpContentEncoding::ToMask() bits
+    void SetAcceptedEncodings(uint mask);
+    /// get the content encodings the client accepts
+    uint GetAcceptedEncodings() const;
+
+    /// hand the content written since the last flush to the HttpServer, called by the request handler
+    void FlushResponseContent(bool discardContent = false);
+    /// return true if content has been flushed and not been dequeued yet
+    bool HasFlushedContent() const;
+    /// swap the flushed content with an empty stream, returns false if nothing has been flushed, called by the HttpServer
+    bool DequeueFlushedContent(Ptr<IO::MemoryStream>& inOutStream);
+    /// cancel the request, called by the HttpServer when nobody waits for the response anymore
+    void Cancel();
+    /// return true if the request has been canceled
+    bool IsCanceled() const;
 
 private:
     HttpMethod::Code method;
     IO::URI uri;
     Ptr<IO::Stream> responseContentStream;
     HttpStatus::Code status;
+    Util::String httpVersion;
+    bool keepAlive;
+    uint acceptedEncodings;
+    volatile int canceled;
+
+    Threading::CriticalSection flushCritSect;
+    Ptr<IO::MemoryStream> flushedContent;
+    SizeT flushedSize;
 };
 
 //------------------------------------------------------------------------------
@@ -124,6 +170,78 @@ HttpRequest::GetStatus() const
     return this->status;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpRequest::SetHttpVersion(const Util::String& v)
+{
+    this->httpVersion = v;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const Util::String&
+HttpRequest::GetHttpVersion() const
+{
+    return this->httpVersion;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpRequest::SetKeepAlive(bool b)
+{
+    this->keepAlive = b;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+HttpRequest::GetKeepAlive() const
+{
+    return this->keepAlive;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpRequest::SetAcceptedEncodings(uint mask)
+{
+    this->acceptedEncodings = mask;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+HttpRequest::GetAcceptedEncodings() const
+{
+    return this->acceptedEncodings;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpRequest::Cancel()
+{
+    Threading::Interlocked::Exchange(&this->canceled, 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+HttpRequest::IsCanceled() const
+{
+    return 0 != this->canceled;
+}
+
 } // namespace Http
 //------------------------------------------------------------------------------
 #endif
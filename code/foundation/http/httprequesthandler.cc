@@ -9,14 +9,18 @@
 namespace Http
 {
 __ImplementClass(Http::HttpRequestHandler, 'HRHD', Core::RefCounted);
+__ImplementClass(Http::HttpRequestHandler::OwnerCall, 'HROC', Core::RefCounted);
 
 using namespace IO;
 using namespace Util;
+using namespace Threading;
 
 //------------------------------------------------------------------------------
 /**
 */
-HttpRequestHandler::HttpRequestHandler()
+HttpRequestHandler::HttpRequestHandler() :
+    isThreadSafe(false),
+    ownerThreadId(Thread::GetMyThreadId())
 {
     // empty
 }
@@ -27,6 +31,7 @@ HttpRequestHandler::HttpRequestHandler()
 HttpRequestHandler::~HttpRequestHandler()
 {
     this->pendingRequests.SetSignalOnEnqueueEnabled(false);
+    this->ownerCalls.SetSignalOnEnqueueEnabled(false);
     // empty
 }
 
@@ -50,14 +55,85 @@ HttpRequestHandler::PutRequest(const Ptr<HttpRequest>& httpRequest)
 void
 HttpRequestHandler::HandlePendingRequests()
 {
+    this->ownerCalls.DequeueAll(this->curOwnerCalls);
+    IndexT callIndex;
+    for (callIndex = 0; callIndex < this->curOwnerCalls.Size(); callIndex++)
+    {
+        OwnerCall* call = this->curOwnerCalls[callIndex];
+        call->critSect.Enter();
+        bool run = (OwnerCall::Queued == call->state);
+        if (run)
+        {
+            call->state = OwnerCall::Running;
+        }
+        call->critSect.Leave();
+        if (run)
+        {
+            call->func();
+            call->critSect.Enter();
+            call->state = OwnerCall::Done;
+            call->critSect.Leave();
+            call->doneEvent.Signal();
+        }
+    }
+    this->curOwnerCalls.Clear();
+
 	this->curWorkRequests.Reserve(this->pendingRequests.Size());
     this->pendingRequests.DequeueAll(this->curWorkRequests);
     IndexT i;
     for (i = 0; i < this->curWorkRequests.Size(); i++)
     {
         this->HandleRequest(this->curWorkRequests[i]);
-        this->curWorkRequests[i]->SetHandled(true);
+        if (!this->curWorkRequests[i]->IsDeferred())
+        {
+            this->curWorkRequests[i]->SetHandled(true);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Run a function on the thread which created the request handler, and
+    wait until it has returned. Meant for thread-safe request handlers,
+    which need some data of the owning thread. The function runs the next
+    time the owning thread calls HandlePendingRequests(), if that doesn't
+    happen within OwnerCallTimeout milliseconds, the function is dropped
+    and false is returned, the request should then fail with
+    HttpStatus::ServiceUnavailable. Called on the owning thread, the
+    function runs right away.
+*/
+bool
+HttpRequestHandler::RunOnOwnerThread(const std::function<void()>& func)
+{
+    if (Thread::GetMyThreadId() == this->ownerThreadId)
+    {
+        func();
+        return true;
+    }
+
+    Ptr<OwnerCall> call = OwnerCall::Create();
+    call->func = func;
+    call->state = OwnerCall::Queued;
+    this->ownerCalls.Enqueue(call);
+    if (call->doneEvent.WaitTimeout(OwnerCallTimeout))
+    {
+        return true;
+    }
+
+    // the function may have been started in the meantime, it must not outlive the caller then
+    call->critSect.Enter();
+    bool abandoned = (OwnerCall::Queued == call->state);
+    if (abandoned)
+    {
+        call->state = OwnerCall::Abandoned;
+    }
+    call->critSect.Leave();
+    if (abandoned)
+    {
+        return false;
     }
+    call->doneEvent.Wait();
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -67,7 +143,9 @@ HttpRequestHandler::HandlePendingRequests()
     properly process the request by filling the responseContentStream with
     data (for instance a HTML page), set the MediaType on the 
     responseContentStream (for instance "text/html") and return with a
-    HttpStatus code (usually HttpStatus::OK).
+    HttpStatus code (usually HttpStatus::OK). A request handler which
+    isn't done with the request when this method returns marks the request
+    as deferred and sets it to handled later.
 */
 void
 HttpRequestHandler::HandleRequest(const Ptr<HttpRequest>& request)
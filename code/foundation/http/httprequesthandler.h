@@ -14,6 +14,15 @@
     content stream (IMPORTANT: don't forget to set the MediaType on the stream!)
     and return with a HttpStatus code.
 
+    Requests are handled on the thread which created the request handler,
+    when it calls HandlePendingRequests(). A request handler which
+    doesn't touch any state of that thread may declare itself thread-safe
+    with SetThreadSafe(), its requests are then handled on a worker
+    thread of the HttpServer, and don't have to wait for the owning
+    thread. Such a request handler may still run a small function on the
+    owning thread with RunOnOwnerThread(), for instance to take a snapshot
+    of the data it presents, and format the page on the worker thread.
+
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
@@ -23,6 +32,10 @@
 #include "io/stream.h"
 #include "util/string.h"
 #include "threading/safequeue.h"
+#include "threading/criticalsection.h"
+#include "threading/event.h"
+#include "threading/thread.h"
+#include <functional>
 
 //------------------------------------------------------------------------------
 namespace Http
@@ -42,6 +55,8 @@ public:
     const Util::String& GetDesc() const;
     /// get a resource location path which is accepted by the handler (e.g. "/display")
     const Util::String& GetRootLocation() const;
+    /// return true if requests may be handled on any thread
+    bool IsThreadSafe() const;
 
 protected:
     friend class HttpServer;
@@ -59,10 +74,39 @@ protected:
     void SetDesc(const Util::String& d);
     /// set the root location of the request handler
     void SetRootLocation(const Util::String& l);
+    /// declare that requests may be handled on any thread, default is false
+    void SetThreadSafe(bool b);
+    /// run a function on the thread which created the request handler, returns false on timeout
+    bool RunOnOwnerThread(const std::function<void()>& func);
+
+    /// a function queued by RunOnOwnerThread()
+    class OwnerCall : public Core::RefCounted
+    {
+        __DeclareClass(OwnerCall);
+    public:
+        enum State
+        {
+            Queued,
+            Running,
+            Done,
+            Abandoned,
+        };
+        std::function<void()> func;
+        Threading::CriticalSection critSect;
+        Threading::Event doneEvent;
+        State state;
+    };
+
+    /// how long RunOnOwnerThread() waits for the owning thread
+    static const int OwnerCallTimeout = 5000;
 
     Util::String name;
     Util::String desc;
     Util::String rootLocation;
+    bool isThreadSafe;
+    Threading::ThreadId ownerThreadId;
+    Threading::SafeQueue<Ptr<OwnerCall> > ownerCalls;
+    Util::Array<Ptr<OwnerCall> > curOwnerCalls;
     Threading::SafeQueue<Ptr<HttpRequest> > pendingRequests;
     Util::Array<Ptr<HttpRequest> > curWorkRequests;
 };
@@ -121,6 +165,24 @@ HttpRequestHandler::GetRootLocation() const
     return this->rootLocation;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpRequestHandler::SetThreadSafe(bool b)
+{
+    this->isThreadSafe = b;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+HttpRequestHandler::IsThreadSafe() const
+{
+    return this->isThreadSafe;
+}
+
 } // namespace Http
 //------------------------------------------------------------------------------
 #endif
@@ -5,7 +5,6 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "http/httprequestreader.h"
-#include "io/textreader.h"
 
 namespace Http
 {
@@ -14,81 +13,213 @@ __ImplementClass(Http::HttpRequestReader, 'HRQR', IO::StreamReader);
 using namespace Util;
 using namespace IO;
 
+//------------------------------------------------------------------------------
+/**
+    Finds the next line, the line end excludes the CR of a CRLF. Returns
+    false if the data ends before the line does.
+*/
+static bool
+NextLine(const char*& cur, const char* end, const char*& outLineBegin, const char*& outLineEnd)
+{
+    const char* newLine = (const char*)memchr(cur, '\n', end - cur);
+    if (nullptr == newLine)
+    {
+        return false;
+    }
+    outLineBegin = cur;
+    outLineEnd = newLine;
+    if ((outLineEnd > outLineBegin) && ('\r' == outLineEnd[-1]))
+    {
+        outLineEnd--;
+    }
+    cur = newLine + 1;
+    return true;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
 HttpRequestReader::HttpRequestReader() :
     isValidHttpRequest(false),
-    httpMethod(HttpMethod::InvalidHttpMethod)
+    isPartialHttpRequest(false),
+    httpMethod(HttpMethod::InvalidHttpMethod),
+    keepAlive(false),
+    acceptedEncodings(0)
 {
     // empty
 }
 
 //------------------------------------------------------------------------------
 /**
+    The request is parsed right from the mapped stream, the header lines
+    are not read one by one through a TextReader.
 */
 bool
 HttpRequestReader::ReadRequest()
 {
     this->isValidHttpRequest = false;
-        
-    // attach a text reader to our stream and parse the request header
-    Ptr<TextReader> textReader = TextReader::Create();
-    textReader->SetStream(this->stream);
-    if (textReader->Open())
+    this->isPartialHttpRequest = false;
+
+    n_assert(this->stream->CanBeMapped());
+    const SizeT position = this->stream->GetPosition();
+    const SizeT size = this->stream->GetSize();
+    if (position >= size)
+    {
+        // nothing there yet
+        this->isPartialHttpRequest = true;
+        return false;
+    }
+
+    const char* data = (const char*)this->stream->Map();
+    const char* begin = data + position;
+    const char* end = data + size;
+    const char* cur = begin;
+    const char* lineBegin = nullptr;
+    const char* lineEnd = nullptr;
+    SizeT requestSize = 0;
+
+    // read the first line of the request
+    // should be "METHOD PATH HTTP/1.1[CRLF]
+    if (!NextLine(cur, end, lineBegin, lineEnd))
     {
-        // read the first line of the request
-        // should be "METHOD PATH HTTP/1.1[CRLF]
-        String headLine =  textReader->ReadLine();
-        Array<String> headTokens = headLine.Tokenize(" ");
-        if (headTokens.Size() != 3)
+        this->isPartialHttpRequest = true;
+        this->stream->Unmap();
+        return false;
+    }
+    String headLine;
+    headLine.Set(lineBegin, SizeT(lineEnd - lineBegin));
+    Array<String> headTokens = headLine.Tokenize(" ");
+    if ((headTokens.Size() != 3) || !String::MatchPattern(headTokens[2], "HTTP/*"))
+    {
+        // malformed request header
+        this->stream->Unmap();
+        return false;
+    }
+
+    // decode the HTTP method and version, connections are persistent by default since HTTP/1.1
+    this->httpMethod = HttpMethod::FromString(headTokens[0]);
+    this->httpVersion = headTokens[2];
+    this->keepAlive = (this->httpVersion != "HTTP/1.0");
+    this->acceptedEncodings = 0;
+
+    // decode the remaining request header lines
+    String host;
+    SizeT contentLength = 0;
+    bool endOfHeader = false;
+    while (!endOfHeader && NextLine(cur, end, lineBegin, lineEnd))
+    {
+        if (lineBegin == lineEnd)
         {
-            // malformed request header
-            textReader->Close();
-            return false;
+            endOfHeader = true;
+            continue;
         }
-
-        // check if the HTTP version string looks alright
-        if (!String::MatchPattern(headTokens[2], "HTTP/*"))
+        const char* colon = (const char*)memchr(lineBegin, ':', lineEnd - lineBegin);
+        if (nullptr == colon)
         {
-            // malformed request header
-            textReader->Close();
-            return false;
+            continue;
         }
-
-        // decode the HTTP method
-        this->httpMethod = HttpMethod::FromString(headTokens[0]);
-
-        // decode the remaining request header lines
-        String host;
-        bool endOfHeader = false;
-        while (!textReader->Eof() && !endOfHeader)
+        String name;
+        name.Set(lineBegin, SizeT(colon - lineBegin));
+        String value;
+        value.Set(colon + 1, SizeT(lineEnd - colon - 1));
+        value.Trim(" \t");
+        if (0 == n_stricmp(name.AsCharPtr(), "Host"))
+        {
+            host = value;
+        }
+        else if (0 == n_stricmp(name.AsCharPtr(), "Connection"))
         {
-            String curLine = textReader->ReadLine();
-            if (curLine.IsValid())
+            Array<String> options = value.Tokenize(", ");
+            IndexT i;
+            for (i = 0; i < options.Size(); i++)
             {
-                if (String::MatchPattern(curLine, "Host: *"))
+                if (0 == n_stricmp(options[i].AsCharPtr(), "close"))
                 {
-                    host = curLine;
-                    host.SubstituteString("Host: ", "");
+                    this->keepAlive = false;
+                }
+                else if (0 == n_stricmp(options[i].AsCharPtr(), "keep-alive"))
+                {
+                    this->keepAlive = true;
                 }
             }
-            else
+        }
+        else if (0 == n_stricmp(name.AsCharPtr(), "Accept-Encoding"))
+        {
+            this->acceptedEncodings = ParseAcceptEncoding(value);
+        }
+        else if (0 == n_stricmp(name.AsCharPtr(), "Content-Length"))
+        {
+            contentLength = value.IsValidInt() ? value.AsInt() : 0;
+            if (contentLength < 0)
             {
-                endOfHeader = true;
+                // malformed request header
+                this->stream->Unmap();
+                return false;
             }
         }
+    }
+
+    // the content of the request belongs to it, even though it's not used
+    if (endOfHeader && ((end - cur) >= contentLength))
+    {
+        requestSize = SizeT(cur - begin) + contentLength;
 
         // build URI
         String uriString;
         uriString.Format("http://%s%s", host.AsCharPtr(), headTokens[1].AsCharPtr());
         this->requestURI = uriString;
-
         this->isValidHttpRequest = true;
-        textReader->Close();
-        return true;
     }
-    return false;
+    else
+    {
+        this->isPartialHttpRequest = true;
+    }
+    this->stream->Unmap();
+
+    if (this->isValidHttpRequest)
+    {
+        this->stream->Seek(position + requestSize, Stream::Begin);
+    }
+    return this->isValidHttpRequest;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Encodings with a quality of 0 are not accepted.
+*/
+uint
+HttpRequestReader::ParseAcceptEncoding(const String& value)
+{
+    uint mask = 0;
+    Array<String> encodings = value.Tokenize(",");
+    IndexT i;
+    for (i = 0; i < encodings.Size(); i++)
+    {
+        Array<String> params = encodings[i].Tokenize("; \t");
+        if (params.IsEmpty())
+        {
+            continue;
+        }
+        HttpContentEncoding::Code code = HttpContentEncoding::FromString(params[0]);
+        if (HttpContentEncoding::InvalidHttpContentEncoding == code)
+        {
+            continue;
+        }
+        bool accepted = true;
+        IndexT paramIndex;
+        for (paramIndex = 1; paramIndex < params.Size(); paramIndex++)
+        {
+            if (String::MatchPattern(params[paramIndex], "q=*"))
+            {
+                accepted = (params[paramIndex].ExtractToEnd(2).AsFloat() > 0.0f);
+            }
+        }
+        if (accepted)
+        {
+            mask |= HttpContentEncoding::ToMask(code);
+        }
+    }
+    return mask;
 }
 
-} // namespace Http
\ No newline at end of file
+} // namespace Http
@@ -6,12 +6,21 @@
     @class Http::HttpRequestReader
     
     A stream reader which cracks a HTTP request into its components.
+
+    The request is read from the current position of the stream, which
+    must be mappable. After a complete request has been read, the stream
+    is positioned behind it (including the content of the request), so
+    several requests which arrived together on a persistent connection
+    can be read one after another. If the stream ends before the request
+    does, IsPartialHttpRequest() returns true and the stream position is
+    left alone.
     
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "io/streamreader.h"
 #include "http/httpmethod.h"
+#include "http/httpcontentencoding.h"
 #include "io/uri.h"
 
 //------------------------------------------------------------------------------
@@ -27,15 +36,30 @@ public:
     bool ReadRequest();
     /// return true if the stream contains a valid HTTP request 
     bool IsValidHttpRequest() const;
+    /// return true if the stream ends before the request is complete
+    bool IsPartialHttpRequest() const;
     /// get HTTP request method
     HttpMethod::Code GetHttpMethod() const;
     /// get request URI
     const IO::URI& GetRequestURI() const;
+    /// get HTTP version (e.g. "HTTP/1.1")
+    const Util::String& GetHttpVersion() const;
+    /// return true if the client wants to keep the connection open
+    bool GetKeepAlive() const;
+    /// get the accepted content encodings as mask of HttpContentEncoding::ToMask() bits
+    uint GetAcceptedEncodings() const;
 
 private:
+    /// parse the value of an Accept-Encoding header
+    static uint ParseAcceptEncoding(const Util::String& value);
+
     bool isValidHttpRequest;
+    bool isPartialHttpRequest;
     HttpMethod::Code httpMethod;
     IO::URI requestURI;
+    Util::String httpVersion;
+    bool keepAlive;
+    uint acceptedEncodings;
 };
 
 //------------------------------------------------------------------------------
@@ -47,6 +71,15 @@ HttpRequestReader::IsValidHttpRequest() const
     return this->isValidHttpRequest;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+HttpRequestReader::IsPartialHttpRequest() const
+{
+    return this->isPartialHttpRequest;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -65,6 +98,33 @@ HttpRequestReader::GetRequestURI() const
     return this->requestURI;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline const Util::String&
+HttpRequestReader::GetHttpVersion() const
+{
+    return this->httpVersion;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+HttpRequestReader::GetKeepAlive() const
+{
+    return this->keepAlive;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint
+HttpRequestReader::GetAcceptedEncodings() const
+{
+    return this->acceptedEncodings;
+}
+
 } // namespace Http
 //------------------------------------------------------------------------------
 #endif
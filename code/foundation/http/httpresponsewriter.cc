@@ -5,58 +5,236 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "http/httpresponsewriter.h"
-#include "io/textwriter.h"
+#include "zlib/zlib.h"
 
 namespace Http
 {
 __ImplementClass(Http::HttpResponseWriter, 'HRSW', IO::StreamWriter);
 
 using namespace IO;
+using namespace Util;
+
+// debug pages are generated on the fly, so favour speed over size
+static const int CompressionLevel = Z_BEST_SPEED;
+
+//------------------------------------------------------------------------------
+/**
+*/
+HttpResponseWriter::HttpResponseWriter() :
+    statusCode(HttpStatus::InvalidHttpStatus),
+    keepAlive(false),
+    contentEncoding(HttpContentEncoding::Identity),
+    zstream(nullptr)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+HttpResponseWriter::~HttpResponseWriter()
+{
+    if (nullptr != this->zstream)
+    {
+        deflateEnd(this->zstream);
+        n_delete(this->zstream);
+        this->zstream = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpResponseWriter::WriteHeaderBegin(String& header) const
+{
+    header.Format("HTTP/1.1 %s %s\r\n",
+        HttpStatus::ToString(this->statusCode).AsCharPtr(),
+        HttpStatus::ToHumanReadableString(this->statusCode).AsCharPtr());
+    header.Append(this->keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    if (HttpContentEncoding::Identity != this->contentEncoding)
+    {
+        header.Append("Content-Encoding: ");
+        header.Append(HttpContentEncoding::ToString(this->contentEncoding));
+        header.Append("\r\nVary: Accept-Encoding\r\n");
+    }
+}
 
 //------------------------------------------------------------------------------
 /**
+    Since the Content-Length must be known before the content is written,
+    compressed content is compressed into a scratch buffer first.
 */
 void
 HttpResponseWriter::WriteResponse()
 {
-    Ptr<TextWriter> textWriter = TextWriter::Create();
-    textWriter->SetStream(this->stream);
-    if (textWriter->Open())
+    String header;
+    this->WriteHeaderBegin(header);
+    String line;
+    if (!this->contentStream.isvalid() || (0 == this->contentStream->GetSize()))
+    {
+        header.Append("Content-Length: 0\r\n\r\n");
+        this->stream->Write(header.AsCharPtr(), header.Length());
+        return;
+    }
+
+    n_assert(this->contentStream->CanBeMapped());
+    this->contentStream->SetAccessMode(IO::Stream::ReadAccess);
+    if (this->contentStream->Open())
     {
-        textWriter->WriteFormatted("HTTP/1.1 %s %s\r\n", 
-            HttpStatus::ToString(this->statusCode).AsCharPtr(),
-            HttpStatus::ToHumanReadableString(this->statusCode).AsCharPtr());
-        if (this->contentStream.isvalid())
+        const void* content = this->contentStream->Map();
+        SizeT contentSize = this->contentStream->GetSize();
+        void* compressed = nullptr;
+        if (HttpContentEncoding::Identity != this->contentEncoding)
+        {
+            this->BeginCompression();
+            uLong bound = deflateBound(this->zstream, contentSize);
+            compressed = Memory::Alloc(Memory::ScratchHeap, bound);
+            this->zstream->next_in = (Bytef*)content;
+            this->zstream->avail_in = contentSize;
+            this->zstream->next_out = (Bytef*)compressed;
+            this->zstream->avail_out = bound;
+            int res = deflate(this->zstream, Z_FINISH);
+            n_assert(Z_STREAM_END == res);
+            content = compressed;
+            contentSize = SizeT(bound - this->zstream->avail_out);
+        }
+
+        line.Format("Content-Length: %d\r\n", contentSize);
+        header.Append(line);
+        if (this->contentStream->GetMediaType().IsValid())
+        {
+            line.Format("Content-Type: %s\r\n", this->contentStream->GetMediaType().AsString().AsCharPtr());
+            header.Append(line);
+        }
+        header.Append("\r\n");
+        this->stream->Write(header.AsCharPtr(), header.Length());
+        this->stream->Write(content, contentSize);
+
+        if (nullptr != compressed)
         {
-            textWriter->WriteFormatted("Content-Length: %d\r\n", 
-                this->contentStream->GetSize());
-            if (this->contentStream->GetMediaType().AsString().IsValid())
-            {
-                textWriter->WriteFormatted("Content-Type: %s\r\n", 
-                    this->contentStream->GetMediaType().AsString().AsCharPtr());
-            }
+            Memory::Free(Memory::ScratchHeap, compressed);
+        }
+        this->contentStream->Unmap();
+        this->contentStream->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpResponseWriter::WriteChunkedHeader(const MediaType& mediaType)
+{
+    String header;
+    this->WriteHeaderBegin(header);
+    header.Append("Transfer-Encoding: chunked\r\n");
+    if (mediaType.IsValid())
+    {
+        String line;
+        line.Format("Content-Type: %s\r\n", mediaType.AsString().AsCharPtr());
+        header.Append(line);
+    }
+    header.Append("\r\n");
+    this->stream->Write(header.AsCharPtr(), header.Length());
+
+    if (HttpContentEncoding::Identity != this->contentEncoding)
+    {
+        this->BeginCompression();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpResponseWriter::WriteChunk(const void* ptr, SizeT size)
+{
+    if (size > 0)
+    {
+        if (nullptr != this->zstream)
+        {
+            this->CompressChunks(ptr, size, Z_SYNC_FLUSH);
         }
         else
         {
-            textWriter->WriteString("Content-Length: 0\r\n");
+            this->WriteChunkData(ptr, size);
         }
-        textWriter->WriteString("\r\n");
-        textWriter->Close();
     }
+}
 
-    // append content string
-    if (this->contentStream.isvalid())
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpResponseWriter::WriteLastChunk()
+{
+    if (nullptr != this->zstream)
     {
-        n_assert(this->contentStream->CanBeMapped());
-        this->contentStream->SetAccessMode(IO::Stream::ReadAccess);
-        if (this->contentStream->Open())
-        {                 
-            void* ptr = this->contentStream->Map();
-            this->stream->Write(ptr, this->contentStream->GetSize());
-            this->contentStream->Unmap();                                                          
-            this->contentStream->Close();
-        }             
+        this->CompressChunks(nullptr, 0, Z_FINISH);
     }
+    this->stream->Write("0\r\n\r\n", 5);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The zlib stream is reused if the writer writes more than one
+    response.
+*/
+void
+HttpResponseWriter::BeginCompression()
+{
+    n_assert(HttpContentEncoding::Identity != this->contentEncoding);
+    if (nullptr == this->zstream)
+    {
+        this->zstream = n_new(z_stream);
+        Memory::Clear(this->zstream, sizeof(z_stream));
+    }
+    else
+    {
+        deflateEnd(this->zstream);
+    }
+    // a window of 15 bits gives a zlib stream (deflate), 16 more bits a gzip stream
+    int windowBits = (HttpContentEncoding::Gzip == this->contentEncoding) ? (15 + 16) : 15;
+    int res = deflateInit2(this->zstream, CompressionLevel, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+    n_assert(Z_OK == res);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpResponseWriter::CompressChunks(const void* ptr, SizeT size, int flush)
+{
+    uchar buf[16 * 1024];
+    this->zstream->next_in = (Bytef*)ptr;
+    this->zstream->avail_in = size;
+    do
+    {
+        this->zstream->next_out = buf;
+        this->zstream->avail_out = sizeof(buf);
+        int res = deflate(this->zstream, flush);
+        n_assert(Z_STREAM_ERROR != res);
+        SizeT compressedSize = SizeT(sizeof(buf) - this->zstream->avail_out);
+        if (compressedSize > 0)
+        {
+            this->WriteChunkData(buf, compressedSize);
+        }
+    }
+    while (0 == this->zstream->avail_out);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpResponseWriter::WriteChunkData(const void* ptr, SizeT size)
+{
+    String sizeLine;
+    sizeLine.Format("%x\r\n", size);
+    this->stream->Write(sizeLine.AsCharPtr(), sizeLine.Length());
+    this->stream->Write(ptr, size);
+    this->stream->Write("\r\n", 2);
 }
 
-} // namespace Http
\ No newline at end of file
+} // namespace Http
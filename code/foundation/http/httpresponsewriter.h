@@ -4,14 +4,29 @@
 //------------------------------------------------------------------------------
 /**
     @class Http::HttpResponseWriter
-  
+
     Stream writer which writes a correct HTTP response to a stream.
-    
+
+    WriteResponse() writes a complete response with a Content-Length.
+    A response whose content isn't complete yet is written with
+    chunked transfer encoding instead: WriteChunkedHeader() once, then
+    WriteChunk() whenever more content is available, and finally
+    WriteLastChunk(). The writer may be opened and closed between these
+    calls, for instance to send each chunk right away.
+
+    If a content encoding is set, the content is compressed with zlib.
+    Chunked content is flushed to the stream with every chunk, so the
+    client can decompress what it received so far.
+
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "io/streamwriter.h"
+#include "io/mediatype.h"
 #include "http/httpstatus.h"
+#include "http/httpcontentencoding.h"
+
+struct z_stream_s;
 
 //------------------------------------------------------------------------------
 namespace Http
@@ -20,16 +35,44 @@ class HttpResponseWriter : public IO::StreamWriter
 {
     __DeclareClass(HttpResponseWriter);
 public:
+    /// constructor
+    HttpResponseWriter();
+    /// destructor
+    virtual ~HttpResponseWriter();
+
     /// set status code
     void SetStatusCode(HttpStatus::Code statusCode);
     /// set optional content stream (needs valid media type!)
     void SetContent(const Ptr<IO::Stream>& contentStream);
+    /// set whether the connection stays open after the response, default is false
+    void SetKeepAlive(bool b);
+    /// set the content encoding of the response, default is identity
+    void SetContentEncoding(HttpContentEncoding::Code encoding);
     /// write http response to the stream
     void WriteResponse();
 
+    /// write the header of a response with chunked transfer encoding
+    void WriteChunkedHeader(const IO::MediaType& mediaType);
+    /// write a chunk of content
+    void WriteChunk(const void* ptr, SizeT size);
+    /// write the last chunk, which ends the response
+    void WriteLastChunk();
+
 private:
+    /// write the status line and the headers shared by all responses
+    void WriteHeaderBegin(Util::String& header) const;
+    /// setup the zlib stream for the content encoding
+    void BeginCompression();
+    /// compress data into chunks, flush is a zlib flush mode
+    void CompressChunks(const void* ptr, SizeT size, int flush);
+    /// write data as one chunk
+    void WriteChunkData(const void* ptr, SizeT size);
+
     HttpStatus::Code statusCode;
     Ptr<IO::Stream> contentStream;
+    bool keepAlive;
+    HttpContentEncoding::Code contentEncoding;
+    z_stream_s* zstream;
 };
 
 //------------------------------------------------------------------------------
@@ -50,6 +93,25 @@ HttpResponseWriter::SetContent(const Ptr<IO::Stream>& s)
     this->contentStream = s;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpResponseWriter::SetKeepAlive(bool b)
+{
+    this->keepAlive = b;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpResponseWriter::SetContentEncoding(HttpContentEncoding::Code e)
+{
+    n_assert(e < HttpContentEncoding::NumHttpContentEncodings);
+    this->contentEncoding = e;
+}
+
 }
 //------------------------------------------------------------------------------
 #endif
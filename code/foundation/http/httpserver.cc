@@ -11,18 +11,25 @@
 namespace Http
 {
 __ImplementClass(Http::HttpServer, 'HTPS', Core::RefCounted);
+__ImplementClass(Http::HttpServer::WorkerThread, 'htwt', Threading::Thread);
 __ImplementSingleton(Http::HttpServer);
 
 using namespace Util;
 using namespace Net;
 using namespace IO;
 
+// larger requests which don't end are not accepted
+static const SizeT MaxPartialRequestSize = 1024 * 1024;
+// smaller responses are not worth compressing
+static const SizeT MinCompressedSize = 1024;
+
 //------------------------------------------------------------------------------
 /**
 */
 HttpServer::HttpServer() :
     isOpen(false),
-    isSingleThreadMode(false)
+    isSingleThreadMode(false),
+    isCompressionEnabled(true)
 {
     __ConstructSingleton;
     this->ipAddress.SetHostName("any");
@@ -54,6 +61,13 @@ HttpServer::Open()
 
     // create the default http request handler
     this->defaultRequestHandler = DefaultHttpRequestHandler::Create();
+
+    // setup the worker thread for thread-safe request handlers
+    this->workerThread = WorkerThread::Create();
+    this->workerThread->SetName("HttpServer::WorkerThread");
+    this->workerThread->Start();
+
+    this->chunkStream = MemoryStream::Create();
     return success;
 }
 
@@ -65,8 +79,17 @@ HttpServer::Close()
 {
     n_assert(this->isOpen);
 
-    // clear pending requests
+    // stop the worker thread, and cancel pending requests
+    this->workerThread->Stop();
+    this->workerThread = nullptr;
+    IndexT i;
+    for (i = 0; i < this->pendingRequests.Size(); i++)
+    {
+        this->pendingRequests[i].httpRequest->Cancel();
+    }
     this->pendingRequests.Clear();
+    this->partialRequests.Clear();
+    this->chunkStream = nullptr;
 
     // destroy the default http request handler
     this->defaultRequestHandler = nullptr;
@@ -105,6 +128,9 @@ HttpServer::RemoveRequestHandler(const Ptr<HttpRequestHandler>& requestHandler)
 
 //------------------------------------------------------------------------------
 /**
+    Requests of a connection are sent in order, so a pending request
+    whose response isn't complete yet holds back the requests which
+    came in after it on the same connection.
 */
 void
 HttpServer::OnFrame()
@@ -116,26 +142,52 @@ HttpServer::OnFrame()
     IndexT i;
     for (i = 0; i < recvConns.Size(); i++)
     {
-        if (!this->HandleHttpRequest(recvConns[i]))
+        if (!this->HandleHttpRequests(recvConns[i]))
         {
             recvConns[i]->Shutdown();
         }
     }
 
     // handle processed http requests
+    this->busyConnections.Clear();
     for (i = 0; i < this->pendingRequests.Size();)
     {
-        const Ptr<HttpRequest>& httpRequest = this->pendingRequests[i].httpRequest;
-        if (httpRequest->Handled())
+        PendingRequest& pendingRequest = this->pendingRequests[i];
+        TcpClientConnection* conn = pendingRequest.clientConnection.get();
+        if (!conn->IsConnected())
+        {
+            // the client is gone, nobody is waiting for the response anymore
+            pendingRequest.httpRequest->Cancel();
+            this->pendingRequests.EraseIndex(i);
+        }
+        else if (InvalidIndex != this->busyConnections.FindIndex(conn))
         {
-            const Ptr<TcpClientConnection>& conn = this->pendingRequests[i].clientConnection;
-            if (this->BuildHttpResponse(conn, httpRequest))
+            i++;
+        }
+        else if (this->SendPendingResponse(pendingRequest))
+        {
+            if (!pendingRequest.httpRequest->GetKeepAlive())
             {
-                conn->Send();
+                conn->Shutdown();
             }
             this->pendingRequests.EraseIndex(i);
         }
         else
+        {
+            this->busyConnections.Append(conn);
+            i++;
+        }
+    }
+    this->busyConnections.Clear();
+
+    // forget about partial requests of closed connections
+    for (i = 0; i < this->partialRequests.Size();)
+    {
+        if (!this->partialRequests[i].clientConnection->IsConnected())
+        {
+            this->partialRequests.EraseIndex(i);
+        }
+        else
         {
             i++;
         }
@@ -144,84 +196,239 @@ HttpServer::OnFrame()
 
 //------------------------------------------------------------------------------
 /**
+    Responses which are handled on other threads are polled, otherwise
+    this waits for incoming requests.
+*/
+void
+HttpServer::WaitForWork(int timeoutMs)
+{
+    n_assert(this->isOpen);
+    if (this->pendingRequests.IsEmpty())
+    {
+        this->tcpServer->WaitForRecv(timeoutMs);
+    }
+    else
+    {
+        Core::SysFunc::Sleep(0.001);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    A connection may have received several requests at once, or a part
+    of a request, which is kept until the rest comes in. Returns false if
+    the received data isn't a valid HTTP request.
 */
 bool
-HttpServer::HandleHttpRequest(const Ptr<TcpClientConnection>& clientConnection)  
+HttpServer::HandleHttpRequests(const Ptr<TcpClientConnection>& clientConnection)  
 {
-    // decode the request
-    Ptr<HttpRequestReader> httpRequestReader = HttpRequestReader::Create();
-    httpRequestReader->SetStream(clientConnection->GetRecvStream());
-    if (httpRequestReader->Open())
+    Ptr<Stream> stream = clientConnection->GetRecvStream();
+
+    // append the received data to the part of a request which came in before
+    IndexT partialIndex;
+    for (partialIndex = 0; partialIndex < this->partialRequests.Size(); partialIndex++)
     {
-        httpRequestReader->ReadRequest();
-        httpRequestReader->Close();
+        if (this->partialRequests[partialIndex].clientConnection == clientConnection)
+        {
+            break;
+        }
     }
-    if (httpRequestReader->IsValidHttpRequest())
+    if (partialIndex < this->partialRequests.Size())
     {
-        URI requestURI = httpRequestReader->GetRequestURI();
-    
-        // create a content stream for the response
-        Ptr<MemoryStream> responseContentStream = MemoryStream::Create();
-        
-        // build a HttpRequest object
-        Ptr<HttpRequest> httpRequest = HttpRequest::Create();
-        httpRequest->SetMethod(httpRequestReader->GetHttpMethod());
-        httpRequest->SetURI(httpRequestReader->GetRequestURI());
-        httpRequest->SetResponseContentStream(responseContentStream.upcast<Stream>());
-        httpRequest->SetStatus(HttpStatus::NotFound);
-
-        // find a request handler which accepts the request
-        Ptr<HttpRequestHandler> requestHandler;
-        Array<String> tokens = requestURI.LocalPath().Tokenize("/");
-        if (tokens.Size() > 0)
+        Ptr<MemoryStream> partialStream = this->partialRequests[partialIndex].stream;
+        this->partialRequests.EraseIndex(partialIndex);
+        stream->SetAccessMode(Stream::ReadAccess);
+        partialStream->SetAccessMode(Stream::AppendAccess);
+        if (stream->Open())
         {
-            if (this->requestHandlers.Contains(tokens[0]))
+            if (partialStream->Open())
             {
-                requestHandler = this->requestHandlers[tokens[0]];
+                partialStream->Write(stream->Map(), stream->GetSize());
+                stream->Unmap();
+                partialStream->Close();
             }
+            stream->Close();
+        }
+        stream = partialStream.upcast<Stream>();
+    }
+
+    // decode the requests
+    bool success = false;
+    Ptr<HttpRequestReader> httpRequestReader = HttpRequestReader::Create();
+    httpRequestReader->SetStream(stream);
+    if (httpRequestReader->Open())
+    {
+        while (httpRequestReader->ReadRequest())
+        {
+            this->HandleHttpRequest(clientConnection, httpRequestReader);
         }
-        if (requestHandler.isvalid())
+
+        // the received data ends with a valid request, or a part of it
+        success = httpRequestReader->IsPartialHttpRequest();
+        SizeT restSize = stream->GetSize() - stream->GetPosition();
+        if (restSize > MaxPartialRequestSize)
         {
-            // handle the request, default is asynchronous handling 
-            // (request is added to request handler with PutRequest()
-            // and processed when the thread where the request handler
-            // lives calls HandlePendingRequests()
-            // in SingleThread mode, the request will be processed immediately,
-            // but this is a death-receipt if request handlers live on
-            // different threads!!!
-            if (this->IsSingleThreadMode())
+            success = false;
+        }
+        else if (success && (restSize > 0))
+        {
+            PartialRequest partialRequest;
+            partialRequest.clientConnection = clientConnection;
+            partialRequest.stream = MemoryStream::Create();
+            partialRequest.stream->SetAccessMode(Stream::WriteAccess);
+            if (partialRequest.stream->Open())
             {
-                // handle request immediately
-                requestHandler->HandleRequest(httpRequest);
-                httpRequest->SetHandled(true);
+                const uchar* ptr = (const uchar*)stream->Map();
+                partialRequest.stream->Write(ptr + stream->GetPosition(), restSize);
+                stream->Unmap();
+                partialRequest.stream->Close();
             }
-            else
+            this->partialRequests.Append(partialRequest);
+        }
+        httpRequestReader->Close();
+    }
+    return success;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServer::HandleHttpRequest(const Ptr<TcpClientConnection>& clientConnection, const Ptr<HttpRequestReader>& httpRequestReader)
+{
+    URI requestURI = httpRequestReader->GetRequestURI();
+
+    // create a content stream for the response
+    Ptr<MemoryStream> responseContentStream = MemoryStream::Create();
+    
+    // build a HttpRequest object
+    Ptr<HttpRequest> httpRequest = HttpRequest::Create();
+    httpRequest->SetMethod(httpRequestReader->GetHttpMethod());
+    httpRequest->SetURI(httpRequestReader->GetRequestURI());
+    httpRequest->SetHttpVersion(httpRequestReader->GetHttpVersion());
+    httpRequest->SetKeepAlive(httpRequestReader->GetKeepAlive());
+    httpRequest->SetAcceptedEncodings(httpRequestReader->GetAcceptedEncodings());
+    httpRequest->SetResponseContentStream(responseContentStream.upcast<Stream>());
+    httpRequest->SetStatus(HttpStatus::NotFound);
+
+    // find a request handler which accepts the request
+    Ptr<HttpRequestHandler> requestHandler;
+    Array<String> tokens = requestURI.LocalPath().Tokenize("/");
+    if (tokens.Size() > 0)
+    {
+        if (this->requestHandlers.Contains(tokens[0]))
+        {
+            requestHandler = this->requestHandlers[tokens[0]];
+        }
+    }
+    if (requestHandler.isvalid())
+    {
+        // handle the request, default is asynchronous handling 
+        // (request is added to request handler with PutRequest()
+        // and processed when the thread where the request handler
+        // lives calls HandlePendingRequests()
+        // in SingleThread mode, the request will be processed immediately,
+        // but this is a death-receipt if request handlers live on
+        // different threads!!!
+        if (this->IsSingleThreadMode())
+        {
+            // handle request immediately
+            requestHandler->HandleRequest(httpRequest);
+            if (!httpRequest->IsDeferred())
             {
-                // asynchronously handle the request
-                requestHandler->PutRequest(httpRequest);
+                httpRequest->SetHandled(true);
             }
         }
+        else if (requestHandler->IsThreadSafe())
+        {
+            // the request doesn't have to wait for the thread of the request handler
+            this->workerThread->PutRequest(requestHandler, httpRequest);
+        }
         else
         {
-            // no request handler accepts the request, let the default
-            // request handler handle the request
-            this->defaultRequestHandler->HandleRequest(httpRequest);
-            httpRequest->SetHandled(true);
+            // asynchronously handle the request
+            requestHandler->PutRequest(httpRequest);
         }
+    }
+    else
+    {
+        // no request handler accepts the request, let the default
+        // request handler handle the request
+        this->defaultRequestHandler->HandleRequest(httpRequest);
+        httpRequest->SetHandled(true);
+    }
 
-        // append request to pending queue
-        PendingRequest pendingRequest;
-        pendingRequest.clientConnection = clientConnection;
-        pendingRequest.httpRequest = httpRequest;
-        this->pendingRequests.Append(pendingRequest);
+    // append request to pending queue
+    PendingRequest pendingRequest;
+    pendingRequest.clientConnection = clientConnection;
+    pendingRequest.httpRequest = httpRequest;
+    this->pendingRequests.Append(pendingRequest);
+}
 
-        return true;
+//------------------------------------------------------------------------------
+/**
+    A response is sent in one piece if the request has been handled before
+    the server found any flushed content. Otherwise the response is
+    started with chunked transfer encoding as soon as the request handler
+    flushes content, and the rest follows when the request has been handled. Clients which
+    only speak HTTP/1.0 don't know chunked transfer encoding, their
+    response is sent when the request has been handled.
+*/
+bool
+HttpServer::SendPendingResponse(PendingRequest& pendingRequest)
+{
+    const Ptr<TcpClientConnection>& conn = pendingRequest.clientConnection;
+    const Ptr<HttpRequest>& httpRequest = pendingRequest.httpRequest;
+
+    // check the handled flag first, everything flushed before it was set is there then
+    bool handled = httpRequest->Handled();
+    if (!pendingRequest.chunkedWriter.isvalid())
+    {
+        if ((httpRequest->GetHttpVersion() == "HTTP/1.0") || !httpRequest->HasFlushedContent())
+        {
+            if (handled)
+            {
+                if (this->BuildHttpResponse(conn, httpRequest))
+                {
+                    conn->Send();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        // start the response, status and media type are set before the first flush
+        const Ptr<Stream>& contentStream = httpRequest->GetResponseContentStream();
+        pendingRequest.chunkedWriter = HttpResponseWriter::Create();
+        pendingRequest.chunkedWriter->SetStream(conn->GetSendStream());
+        pendingRequest.chunkedWriter->SetStatusCode(httpRequest->GetStatus());
+        pendingRequest.chunkedWriter->SetKeepAlive(httpRequest->GetKeepAlive());
+        pendingRequest.chunkedWriter->SetContentEncoding(this->SelectContentEncoding(httpRequest, contentStream->GetMediaType()));
+        pendingRequest.chunkedWriter->Open();
+        pendingRequest.chunkedWriter->WriteChunkedHeader(contentStream->GetMediaType());
+        pendingRequest.chunkedWriter->Close();
     }
-    else
+    if (handled)
+    {
+        // the request handler is done with the content stream
+        httpRequest->FlushResponseContent();
+    }
+    httpRequest->DequeueFlushedContent(this->chunkStream);
+
+    const Ptr<HttpResponseWriter>& responseWriter = pendingRequest.chunkedWriter;
+    responseWriter->Open();
+    if (this->chunkStream->GetSize() > 0)
+    {
+        responseWriter->WriteChunk(this->chunkStream->GetRawPointer(), this->chunkStream->GetSize());
+        this->chunkStream->SetSize(0);
+    }
+    if (handled)
     {
-        // the received data was not a valid HTTP request
-        return false;
+        responseWriter->WriteLastChunk();
     }
+    responseWriter->Close();
+    conn->Send();
+    return handled;
 }
 
 //------------------------------------------------------------------------------
@@ -233,6 +440,7 @@ HttpServer::BuildHttpResponse(const Ptr<TcpClientConnection>& conn, const Ptr<Ht
     Ptr<HttpResponseWriter> responseWriter = HttpResponseWriter::Create();
     responseWriter->SetStream(conn->GetSendStream());
     responseWriter->SetStatusCode(httpRequest->GetStatus());
+    responseWriter->SetKeepAlive(httpRequest->GetKeepAlive());
     if (HttpStatus::OK != httpRequest->GetStatus())
     {
         // an error occured, need to write an error message to the response stream
@@ -243,10 +451,14 @@ HttpServer::BuildHttpResponse(const Ptr<TcpClientConnection>& conn, const Ptr<Ht
         textWriter->Close();
         httpRequest->GetResponseContentStream()->SetMediaType(MediaType("text/plain"));
     }
-    if (httpRequest->GetResponseContentStream()->GetSize() > 0)
+    const Ptr<Stream>& contentStream = httpRequest->GetResponseContentStream();
+    if (contentStream->GetSize() > 0)
     {
-        httpRequest->GetResponseContentStream()->GetMediaType().IsValid();
-        responseWriter->SetContent(httpRequest->GetResponseContentStream());
+        responseWriter->SetContent(contentStream);
+        if (contentStream->GetSize() >= MinCompressedSize)
+        {
+            responseWriter->SetContentEncoding(this->SelectContentEncoding(httpRequest, contentStream->GetMediaType()));
+        }
     }
     // do nothing, if stream isn't valid
     if (responseWriter->GetStream().isvalid())
@@ -259,5 +471,79 @@ HttpServer::BuildHttpResponse(const Ptr<TcpClientConnection>& conn, const Ptr<Ht
     return false;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Only text is compressed, other media types like images are usually
+    compressed already. Gzip is preferred, since some clients expect raw
+    deflate data instead of a zlib stream for the deflate encoding.
+*/
+HttpContentEncoding::Code
+HttpServer::SelectContentEncoding(const Ptr<HttpRequest>& httpRequest, const MediaType& mediaType) const
+{
+    if (!this->isCompressionEnabled || !mediaType.IsValid())
+    {
+        return HttpContentEncoding::Identity;
+    }
+    const String& subType = mediaType.GetSubType();
+    bool isText = (mediaType.GetType() == "text") || (subType == "json") || (subType == "xml") || (subType == "javascript") || (subType == "svg+xml");
+    uint acceptedEncodings = httpRequest->GetAcceptedEncodings();
+    if (isText && (0 != (acceptedEncodings & HttpContentEncoding::ToMask(HttpContentEncoding::Gzip))))
+    {
+        return HttpContentEncoding::Gzip;
+    }
+    else if (isText && (0 != (acceptedEncodings & HttpContentEncoding::ToMask(HttpContentEncoding::Deflate))))
+    {
+        return HttpContentEncoding::Deflate;
+    }
+    else
+    {
+        return HttpContentEncoding::Identity;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServer::WorkerThread::PutRequest(const Ptr<HttpRequestHandler>& requestHandler, const Ptr<HttpRequest>& httpRequest)
+{
+    Work work;
+    work.requestHandler = requestHandler;
+    work.httpRequest = httpRequest;
+    this->workQueue.Enqueue(work);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServer::WorkerThread::DoWork()
+{
+    while (!this->ThreadStopRequested())
+    {
+        this->workQueue.Wait();
+        this->workQueue.DequeueAll(this->curWork);
+        IndexT i;
+        for (i = 0; i < this->curWork.Size(); i++)
+        {
+            this->curWork[i].requestHandler->HandleRequest(this->curWork[i].httpRequest);
+            if (!this->curWork[i].httpRequest->IsDeferred())
+            {
+                this->curWork[i].httpRequest->SetHandled(true);
+            }
+        }
+        this->curWork.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+HttpServer::WorkerThread::EmitWakeupSignal()
+{
+    this->workQueue.Signal();
+}
+
 } // namespace Http
 
@@ -9,6 +9,21 @@
     HttpRequestHandlers. Can be used to serve debug information about the 
     Nebula application to web browsers.
 
+    Connections are persistent (HTTP/1.1 keep-alive) unless the client
+    asks to close them, several requests on one connection are answered
+    in order. Requests which arrive in pieces are collected until they
+    are complete. Responses are compressed with gzip or deflate if the
+    client accepts it and the content is text. A request handler may
+    flush its content while it's still working on the request (see
+    HttpRequest::FlushResponseContent()), the response is then sent with
+    chunked transfer encoding as the content comes in. Requests which
+    are still pending when their client goes away are canceled, so
+    request handlers which stream content know when to stop.
+
+    Requests for thread-safe request handlers are handled on a worker
+    thread of the server, all others on the threads which own their
+    request handlers.
+
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
@@ -16,9 +31,13 @@
 #include "core/singleton.h"
 #include "net/tcpserver.h"
 #include "net/socket/ipaddress.h"
+#include "threading/thread.h"
+#include "threading/safequeue.h"
+#include "io/memorystream.h"
 #include "io/textreader.h"
 #include "io/textwriter.h"
 #include "http/httpresponsewriter.h"
+#include "http/httprequestreader.h"
 #include "http/httprequesthandler.h"
 #include "http/defaulthttprequesthandler.h"
 
@@ -43,6 +62,10 @@ public:
     void SetSingleThreadMode(bool b);
     /// get single-thread mode
     bool IsSingleThreadMode() const;
+    /// enable/disable compression of responses, default is on
+    void SetCompressionEnabled(bool b);
+    /// get compression of responses
+    bool IsCompressionEnabled() const;
     /// open the http server
     bool Open();
     /// close the http server
@@ -57,26 +80,68 @@ public:
     Util::Array<Ptr<HttpRequestHandler> > GetRequestHandlers() const;
     /// call this method frequently to serve http connections
     void OnFrame();
+    /// wait until there may be something to serve, or the timeout expired
+    void WaitForWork(int timeoutMs);
 
 private:
+    /// a private worker thread class, handles requests for thread-safe request handlers
+    class WorkerThread : public Threading::Thread
+    {
+        __DeclareClass(WorkerThread);
+    public:
+        /// queue a request for a request handler
+        void PutRequest(const Ptr<HttpRequestHandler>& requestHandler, const Ptr<HttpRequest>& httpRequest);
+    private:
+        /// implements the actual worker method
+        virtual void DoWork();
+        /// send a wakeup signal
+        virtual void EmitWakeupSignal();
+
+        struct Work
+        {
+            Ptr<HttpRequestHandler> requestHandler;
+            Ptr<HttpRequest> httpRequest;
+        };
+        Threading::SafeQueue<Work> workQueue;
+        Util::Array<Work> curWork;
+    };
+
+    /// handle all requests received by a connection
+    bool HandleHttpRequests(const Ptr<Net::TcpClientConnection>& clientConnection);
     /// handle an HttpRequest
-    bool HandleHttpRequest(const Ptr<Net::TcpClientConnection>& clientConnection);
+    void HandleHttpRequest(const Ptr<Net::TcpClientConnection>& clientConnection, const Ptr<HttpRequestReader>& httpRequestReader);
     /// build an HttpResponse for a handled http request
     bool BuildHttpResponse(const Ptr<Net::TcpClientConnection>& clientConnection, const Ptr<HttpRequest>& httpRequest);
+    /// select the content encoding for a response
+    HttpContentEncoding::Code SelectContentEncoding(const Ptr<HttpRequest>& httpRequest, const IO::MediaType& mediaType) const;
 
     struct PendingRequest
     {
         Ptr<Net::TcpClientConnection> clientConnection;
         Ptr<HttpRequest> httpRequest;
+        Ptr<HttpResponseWriter> chunkedWriter;
+    };
+    /// send the flushed content of a pending request, returns true if the response is complete
+    bool SendPendingResponse(PendingRequest& pendingRequest);
+
+    struct PartialRequest
+    {
+        Ptr<Net::TcpClientConnection> clientConnection;
+        Ptr<IO::MemoryStream> stream;
     };
 
     Util::Dictionary<Util::String, Ptr<HttpRequestHandler> > requestHandlers;
     Ptr<DefaultHttpRequestHandler> defaultRequestHandler;    
     Net::IpAddress ipAddress;
     Ptr<Net::TcpServer> tcpServer;
+    Ptr<WorkerThread> workerThread;
     Util::Array<PendingRequest> pendingRequests;
+    Util::Array<PartialRequest> partialRequests;
+    Util::Array<Net::TcpClientConnection*> busyConnections;
+    Ptr<IO::MemoryStream> chunkStream;
     bool isOpen;
     bool isSingleThreadMode;
+    bool isCompressionEnabled;
 };
 
 //------------------------------------------------------------------------------
@@ -112,6 +177,24 @@ HttpServer::IsSingleThreadMode() const
     return this->isSingleThreadMode;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+HttpServer::SetCompressionEnabled(bool b)
+{
+    this->isCompressionEnabled = b;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+HttpServer::IsCompressionEnabled() const
+{
+    return this->isCompressionEnabled;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
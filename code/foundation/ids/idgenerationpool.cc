@@ -47,6 +47,35 @@ IdGenerationPool::Allocate(Id32& id)
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Same rules as allocating one id at a time, but all new ids are
+    appended to the generation array in one go.
+*/
+void
+IdGenerationPool::Allocate(Id32* ids, SizeT num)
+{
+    IndexT i = 0;
+    for (; i < num && this->freeIdsSize >= 1024; i++)
+    {
+        this->freeIdsSize--;
+        Id32 id = this->freeIds.Dequeue();
+        ids[i] = CreateId(id, this->generations[id]);
+    }
+
+    if (i < num)
+    {
+        const SizeT first = this->generations.Size();
+        const SizeT remaining = num - i;
+        this->generations.SetSize(first + remaining);
+        this->generations.Fill(first, remaining, 0);
+        for (IndexT j = 0; j < remaining; j++)
+        {
+            ids[i + j] = CreateId(first + j, 0);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
 */
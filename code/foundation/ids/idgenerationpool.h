@@ -49,6 +49,8 @@ public:
 
     /// allocate a new id, returns whether or not the id was reused or new
 	bool Allocate(Id32& id);
+    /// allocate num ids at once
+    void Allocate(Id32* ids, SizeT num);
     /// remove an id
     void Deallocate(Id32 id);
     /// check if valid
@@ -0,0 +1,200 @@
+//------------------------------------------------------------------------------
+//  constmemorystream.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "io/constmemorystream.h"
+
+namespace IO
+{
+__ImplementClass(IO::ConstMemoryStream, 'CMST', IO::Stream);
+
+//------------------------------------------------------------------------------
+/**
+*/
+ConstMemoryStream::ConstMemoryStream() :
+    buffer(0),
+    size(0),
+    position(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ConstMemoryStream::~ConstMemoryStream()
+{
+    if (this->IsOpen())
+    {
+        this->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ConstMemoryStream::SetMemory(const void* ptr, Size s)
+{
+    n_assert(!this->IsOpen());
+    n_assert((0 != ptr) || (0 == s));
+    this->buffer = (const unsigned char*)ptr;
+    this->size = s;
+    this->position = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ConstMemoryStream::CanRead() const
+{
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ConstMemoryStream::CanWrite() const
+{
+    return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ConstMemoryStream::CanSeek() const
+{
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ConstMemoryStream::CanBeMapped() const
+{
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Stream::Size
+ConstMemoryStream::GetSize() const
+{
+    return this->size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Stream::Position
+ConstMemoryStream::GetPosition() const
+{
+    return this->position;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ConstMemoryStream::Open()
+{
+    n_assert(!this->IsOpen());
+    n_assert(ReadAccess == this->accessMode);
+    if (Stream::Open())
+    {
+        this->position = 0;
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ConstMemoryStream::Close()
+{
+    n_assert(this->IsOpen());
+    if (this->IsMapped())
+    {
+        this->Unmap();
+    }
+    Stream::Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Stream::Size
+ConstMemoryStream::Read(void* ptr, Size numBytes)
+{
+    n_assert(this->IsOpen());
+    n_assert(!this->IsMapped());
+    n_assert((this->position >= 0) && (this->position <= this->size));
+
+    // check if end-of-stream is near
+    Size readBytes = numBytes <= this->size - this->position ? numBytes : this->size - this->position;
+    if (readBytes > 0)
+    {
+        Memory::Copy(this->buffer + this->position, ptr, readBytes);
+        this->position += readBytes;
+    }
+    return readBytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ConstMemoryStream::Seek(Offset offset, SeekOrigin origin)
+{
+    n_assert(this->IsOpen());
+    n_assert(!this->IsMapped());
+    switch (origin)
+    {
+        case Begin:
+            this->position = offset;
+            break;
+        case Current:
+            this->position += offset;
+            break;
+        case End:
+            this->position = this->size + offset;
+            break;
+    }
+
+    // make sure read position doesn't become invalid
+    this->position = Math::n_iclamp(this->position, 0, this->size);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ConstMemoryStream::Eof() const
+{
+    n_assert(this->IsOpen());
+    n_assert(!this->IsMapped());
+    return (this->position == this->size);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The returned memory must not be written to.
+*/
+void*
+ConstMemoryStream::Map()
+{
+    n_assert(this->IsOpen());
+    Stream::Map();
+    n_assert(this->GetSize() > 0);
+    return (void*)this->buffer;
+}
+
+} // namespace IO
@@ -0,0 +1,59 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class IO::ConstMemoryStream
+    
+    A read-only stream on top of memory owned by someone else, for example
+    a part of a memory mapped file. Unlike IO::MemoryStream no copy of the
+    data is made, so the memory must stay valid while the stream is open.
+    
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "io/stream.h"
+
+//------------------------------------------------------------------------------
+namespace IO
+{
+class ConstMemoryStream : public Stream
+{
+    __DeclareClass(ConstMemoryStream);
+public:
+    /// constructor
+    ConstMemoryStream();
+    /// destructor
+    virtual ~ConstMemoryStream();
+    /// set the memory to read from, call before Open()
+    void SetMemory(const void* ptr, Size size);
+    /// const memory streams support reading
+    virtual bool CanRead() const;
+    /// const memory streams don't support writing
+    virtual bool CanWrite() const;
+    /// const memory streams support seeking
+    virtual bool CanSeek() const;
+    /// const memory streams are mappable
+    virtual bool CanBeMapped() const;
+    /// get the size of the stream in bytes
+    virtual Size GetSize() const;
+    /// get the current position of the read cursor
+    virtual Position GetPosition() const;
+    /// open the stream
+    virtual bool Open();
+    /// close the stream
+    virtual void Close();
+    /// directly read from the stream
+    virtual Size Read(void* ptr, Size numBytes);
+    /// seek in stream
+    virtual void Seek(Offset offset, SeekOrigin origin);
+    /// return true if end-of-stream reached
+    virtual bool Eof() const;
+    /// map for direct memory-access
+    virtual void* Map();
+
+private:
+    const unsigned char* buffer;
+    Size size;
+    Position position;
+};
+
+} // namespace IO
+//------------------------------------------------------------------------------
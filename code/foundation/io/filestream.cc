@@ -18,7 +18,8 @@ using namespace Core;
 */
 FileStream::FileStream() :
     handle(0),
-    mappedContent(0)
+    mappedContent(0),
+    mappedFileSize(0)
 {
     // empty
 }
@@ -216,6 +217,31 @@ FileStream::Map()
     return this->mappedContent;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Maps the file itself read-only, so the content is paged in on demand
+    instead of being read into a copy up front. The stream must have been
+    opened for reading only. If the file can't be mapped, this falls back
+    to Map(). Unmap with Unmap() as usual.
+*/
+const void*
+FileStream::MapFile()
+{
+    n_assert(0 == this->mappedContent);
+    n_assert(ReadAccess == this->accessMode);
+
+    Size size = this->GetSize();
+    n_assert(size > 0);
+    this->mappedContent = FSWrapper::MapFile(this->handle, size);
+    if (0 == this->mappedContent)
+    {
+        return this->Map();
+    }
+    this->mappedFileSize = size;
+    Stream::Map();
+    return this->mappedContent;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -224,7 +250,15 @@ FileStream::Unmap()
 {
     n_assert(0 != this->mappedContent);
     Stream::Unmap();
-    Memory::Free(Memory::ScratchHeap, this->mappedContent);
+    if (this->mappedFileSize > 0)
+    {
+        FSWrapper::UnmapFile(this->mappedContent, this->mappedFileSize);
+        this->mappedFileSize = 0;
+    }
+    else
+    {
+        Memory::Free(Memory::ScratchHeap, this->mappedContent);
+    }
     this->mappedContent = 0;
 }
 
@@ -52,12 +52,16 @@ public:
     virtual bool Eof() const;
     /// map stream to memory
     virtual void* Map();
+    /// map the file itself read-only instead of reading a copy, only for streams opened with ReadAccess
+    const void* MapFile();
     /// unmap stream
     virtual void Unmap();
 
 protected:
     FSWrapper::Handle handle;
     void* mappedContent;
+    /// size of the mapped content if the file itself is mapped, 0 if the content is a copy
+    Size mappedFileSize;
 };
 
 } // namespace IO
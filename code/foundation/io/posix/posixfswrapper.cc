@@ -13,6 +13,7 @@
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 
 #ifdef __APPLE__
 namespace CoreFoundation {
@@ -189,6 +190,33 @@ PosixFSWrapper::GetFileSize(Handle handle)
     return s.st_size;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Maps a file into memory for reading.
+*/
+void*
+PosixFSWrapper::MapFile(Handle handle, Stream::Size size)
+{
+    n_assert(0 != handle);
+    n_assert(size > 0);
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(handle), 0);
+    if (MAP_FAILED == ptr)
+    {
+        return nullptr;
+    }
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PosixFSWrapper::UnmapFile(void* ptr, Stream::Size size)
+{
+    n_assert(0 != ptr);
+    munmap(ptr, size);
+}
+
 //------------------------------------------------------------------------------
 /**
     Set the read-only status of a file.
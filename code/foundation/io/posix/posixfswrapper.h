@@ -43,6 +43,10 @@ public:
     static bool Eof(Handle h);
     /// get size of a file in bytes
     static IO::Stream::Size GetFileSize(Handle h);
+    /// map a file opened for reading into read-only memory, returns nullptr if the file can't be mapped
+    static void* MapFile(Handle h, IO::Stream::Size size);
+    /// unmap a file mapped with MapFile
+    static void UnmapFile(void* ptr, IO::Stream::Size size);
     /// set read-only status of a file
     static void SetReadOnly(const Util::String& path, bool readOnly);
     /// get read-only status of a file
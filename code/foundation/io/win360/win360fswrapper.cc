@@ -228,6 +228,36 @@ Win360FSWrapper::GetFileSize(Handle handle)
     return ::GetFileSize(handle, NULL);
 }
 
+//------------------------------------------------------------------------------
+/**
+    Maps a file into memory for reading. The mapping object is kept alive
+    by the view, so it can be closed right away.
+*/
+void*
+Win360FSWrapper::MapFile(Handle handle, Stream::Size size)
+{
+    n_assert(0 != handle);
+    n_assert(size > 0);
+    HANDLE mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (NULL == mapping)
+    {
+        return nullptr;
+    }
+    void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Win360FSWrapper::UnmapFile(void* ptr, Stream::Size size)
+{
+    n_assert(0 != ptr);
+    UnmapViewOfFile(ptr);
+}
+
 //------------------------------------------------------------------------------
 /**
     Set the read-only status of a file. This method does nothing on the
@@ -0,0 +1,187 @@
+//------------------------------------------------------------------------------
+//  jobpagehandler.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "jobs/debug/jobpagehandler.h"
+#include "jobs/jobs.h"
+#include "http/html/htmlpagewriter.h"
+
+namespace Debug
+{
+__ImplementClass(Debug::JobPageHandler, 'JPGH', Http::HttpRequestHandler);
+
+using namespace IO;
+using namespace Http;
+using namespace Util;
+using namespace Jobs;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static String
+FormatTime(uint64_t nanoseconds)
+{
+    return String::Sprintf("%.3f ms", nanoseconds / 1000000.0);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static String
+FormatAverage(uint64_t nanoseconds, uint64_t count)
+{
+    if (count == 0)
+        return "-";
+    return String::Sprintf("%.1f us", nanoseconds / (1000.0 * count));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+JobPageHandler::JobPageHandler()
+{
+    this->SetName("Jobs");
+    this->SetDesc("display job system statistics");
+    this->SetRootLocation("jobs");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JobPageHandler::HandleRequest(const Ptr<HttpRequest>& request) 
+{
+    n_assert(HttpMethod::Get == request->GetMethod());
+
+    // configure a HTML page writer
+    Ptr<HtmlPageWriter> htmlWriter = HtmlPageWriter::Create();
+    htmlWriter->SetStream(request->GetResponseContentStream());
+    htmlWriter->SetTitle("Nebula Job Info");
+    if (htmlWriter->Open())
+    {
+        htmlWriter->Element(HtmlElement::Heading1, "Nebula Jobs");
+        htmlWriter->AddAttr("href", "/index.html");
+        htmlWriter->Element(HtmlElement::Anchor, "Home");
+        htmlWriter->LineBreak();
+        htmlWriter->LineBreak();
+        htmlWriter->Text("All numbers are totals since the application started, reload the page to see how they change.");
+
+        // host waits
+        JobHostWaitStats hostStats = JobGetHostWaitStats();
+        htmlWriter->Element(HtmlElement::Heading3, "Host Waits");
+        htmlWriter->Begin(HtmlElement::Table);
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableData, "Number of JobSyncHostWait calls:");
+                htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(hostStats.numWaits));
+            htmlWriter->End(HtmlElement::TableRow);
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableData, "Total time blocked:");
+                htmlWriter->Element(HtmlElement::TableData, FormatTime(hostStats.waitTime));
+            htmlWriter->End(HtmlElement::TableRow);
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableData, "Average time blocked:");
+                htmlWriter->Element(HtmlElement::TableData, FormatAverage(hostStats.waitTime, hostStats.numWaits));
+            htmlWriter->End(HtmlElement::TableRow);
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableData, "Longest time blocked:");
+                htmlWriter->Element(HtmlElement::TableData, FormatTime(hostStats.maxWaitTime));
+            htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->End(HtmlElement::Table);
+
+        // port threads
+        Array<JobPortStats> portStats;
+        JobGetPortStats(portStats);
+        IndexT i;
+        for (i = 0; i < portStats.Size(); i++)
+        {
+            const JobPortStats& port = portStats[i];
+            uint64_t portSlices = 0;
+            IndexT j;
+            for (j = 0; j < port.threads.Size(); j++)
+                portSlices += port.threads[j].numSlices;
+
+            htmlWriter->Element(HtmlElement::Heading3, String::Sprintf("Port %s", port.name.Value()));
+            htmlWriter->AddAttr("border", "1");
+            htmlWriter->AddAttr("rules", "cols");
+            htmlWriter->Begin(HtmlElement::Table);
+                htmlWriter->AddAttr("bgcolor", "lightsteelblue");
+                htmlWriter->Begin(HtmlElement::TableRow);
+                    htmlWriter->Element(HtmlElement::TableHeader, "Thread");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Commands");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Slices");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Share of Slices");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Avg Queue Latency");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Max Queue Latency");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Execution");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Thread Wait");
+                    htmlWriter->Element(HtmlElement::TableHeader, "Idle");
+                htmlWriter->End(HtmlElement::TableRow);
+
+                for (j = 0; j < port.threads.Size(); j++)
+                {
+                    const JobThreadStats& thread = port.threads[j];
+                    htmlWriter->Begin(HtmlElement::TableRow);
+                        htmlWriter->Element(HtmlElement::TableData, String::Sprintf("%s%d", port.name.Value(), j));
+                        htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(thread.numCommands));
+                        htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(thread.numSlices));
+                        htmlWriter->Element(HtmlElement::TableData, portSlices > 0 ? String::Sprintf("%.1f %%", 100.0 * thread.numSlices / portSlices) : String("-"));
+                        htmlWriter->Element(HtmlElement::TableData, FormatAverage(thread.queueTime, thread.numCommands));
+                        htmlWriter->Element(HtmlElement::TableData, FormatTime(thread.maxQueueTime));
+                        htmlWriter->Element(HtmlElement::TableData, FormatTime(thread.executionTime));
+                        htmlWriter->Element(HtmlElement::TableData, FormatTime(thread.waitTime));
+                        htmlWriter->Element(HtmlElement::TableData, FormatTime(thread.idleTime));
+                    htmlWriter->End(HtmlElement::TableRow);
+                }
+            htmlWriter->End(HtmlElement::Table);
+        }
+
+        // job functions
+        Array<JobFuncStats> funcStats;
+        JobGetFuncStats(funcStats);
+        htmlWriter->Element(HtmlElement::Heading3, "Job Functions");
+        htmlWriter->AddAttr("border", "1");
+        htmlWriter->AddAttr("rules", "cols");
+        htmlWriter->Begin(HtmlElement::Table);
+            htmlWriter->AddAttr("bgcolor", "lightsteelblue");
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableHeader, "Job");
+                htmlWriter->Element(HtmlElement::TableHeader, "Schedules");
+                htmlWriter->Element(HtmlElement::TableHeader, "Commands");
+                htmlWriter->Element(HtmlElement::TableHeader, "Slices");
+                htmlWriter->Element(HtmlElement::TableHeader, "Avg Slices per Command");
+                htmlWriter->Element(HtmlElement::TableHeader, "Avg Queue Latency");
+                htmlWriter->Element(HtmlElement::TableHeader, "Max Queue Latency");
+                htmlWriter->Element(HtmlElement::TableHeader, "Avg Execution per Command");
+                htmlWriter->Element(HtmlElement::TableHeader, "Max Execution per Command");
+                htmlWriter->Element(HtmlElement::TableHeader, "Total Execution");
+            htmlWriter->End(HtmlElement::TableRow);
+
+            for (i = 0; i < funcStats.Size(); i++)
+            {
+                const JobFuncStats& func = funcStats[i];
+                htmlWriter->Begin(HtmlElement::TableRow);
+                    htmlWriter->Element(HtmlElement::TableData, func.name != nullptr ? String(func.name) : String::Sprintf("%p", (void*)func.JobFunc));
+                    htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(func.numSchedules));
+                    htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(func.numCommands));
+                    htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(func.numSlices));
+                    htmlWriter->Element(HtmlElement::TableData, func.numCommands > 0 ? String::Sprintf("%.1f", (double)func.numSlices / func.numCommands) : String("-"));
+                    htmlWriter->Element(HtmlElement::TableData, FormatAverage(func.queueTime, func.numCommands));
+                    htmlWriter->Element(HtmlElement::TableData, FormatTime(func.maxQueueTime));
+                    htmlWriter->Element(HtmlElement::TableData, FormatAverage(func.executionTime, func.numCommands));
+                    htmlWriter->Element(HtmlElement::TableData, FormatTime(func.maxExecutionTime));
+                    htmlWriter->Element(HtmlElement::TableData, FormatTime(func.executionTime));
+                htmlWriter->End(HtmlElement::TableRow);
+            }
+        htmlWriter->End(HtmlElement::Table);
+
+        htmlWriter->Close();
+        request->SetStatus(HttpStatus::OK);
+    }
+    else
+    {
+        request->SetStatus(HttpStatus::InternalServerError);
+    }
+}
+
+} // namespace Debug
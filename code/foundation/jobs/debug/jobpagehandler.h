@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Debug::JobPageHandler
+    
+    Displays the job system statistics, per port thread and per job function.
+    
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "http/httprequesthandler.h"
+
+//------------------------------------------------------------------------------
+namespace Debug
+{
+class JobPageHandler : public Http::HttpRequestHandler
+{
+    __DeclareClass(JobPageHandler);
+public:
+    /// constructor
+    JobPageHandler();
+    /// handle a http request, the handler is expected to fill the content stream with response data
+    virtual void HandleRequest(const Ptr<Http::HttpRequest>& request);
+};
+
+} // namespace Debug
+//------------------------------------------------------------------------------
@@ -4,12 +4,80 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "jobs.h"
+#include "debug/profiling.h"
+#include "threading/criticalsection.h"
 namespace Jobs
 {
 
 JobPortAllocator jobPortAllocator(0xFFFF);
 JobAllocator jobAllocator(0xFFFFFFFF);
 JobSyncAllocator jobSyncAllocator(0xFFFFFFFF);
+
+// statistics, the lock protects the port and job function lists, job threads never take it
+static Threading::CriticalSection statsLock;
+static Util::Array<JobPortId> statsPorts;
+static Util::Array<JobFuncCounters*> statsFuncs;
+static std::atomic<uint64_t> hostWaitCount{ 0 };
+static std::atomic<uint64_t> hostWaitTime{ 0 };
+static std::atomic<uint64_t> hostWaitMaxTime{ 0 };
+
+//------------------------------------------------------------------------------
+/**
+	Add to a counter which has only one writer, avoids the locked instruction of fetch_add
+*/
+static inline void
+CounterAdd(std::atomic<uint64_t>& counter, uint64_t value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline void
+CounterMax(std::atomic<uint64_t>& counter, uint64_t value)
+{
+	uint64_t prev = counter.load(std::memory_order_relaxed);
+	while (prev < value && !counter.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+		;
+}
+//------------------------------------------------------------------------------
+/**
+	Find or register the counters of a job function, this takes the stats
+	lock, so CreateJob only calls it if the job slot doesn't have the
+	counters cached already.
+*/
+static JobFuncCounters*
+FindJobFuncCounters(const CreateJobInfo& info)
+{
+	JobFuncCounters* counters = nullptr;
+	statsLock.Enter();
+	IndexT i;
+	for (i = 0; i < statsFuncs.Size(); i++)
+	{
+		if (statsFuncs[i]->JobFunc == info.JobFunc)
+		{
+			counters = statsFuncs[i];
+			break;
+		}
+	}
+	if (counters == nullptr)
+	{
+		n_assert2(statsFuncs.Size() < MaxNumJobFuncs, "Jobs: too many job functions, raise MaxNumJobFuncs\n");
+		counters = n_new(JobFuncCounters);
+		counters->name = info.name;
+		counters->JobFunc = info.JobFunc;
+		counters->index = statsFuncs.Size();
+		counters->numSchedules = 0;
+		Memory::Clear(&counters->retired, sizeof(JobFuncStats));
+		statsFuncs.Append(counters);
+	}
+	else if (counters->name == nullptr)
+		counters->name = info.name;
+	statsLock.Leave();
+	return counters;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -34,6 +102,10 @@ CreateJobPort(const CreateJobPortInfo& info)
 	// we limit the id count to be ushort max
 	JobPortId id;
 	id.id = (Ids::Id16)port;
+
+	statsLock.Enter();
+	statsPorts.Append(id);
+	statsLock.Leave();
 	return id;
 }
 
@@ -48,6 +120,21 @@ DestroyJobPort(const JobPortId& id)
 	{
 		threads[i]->Stop();        
 	}
+
+	// the threads are stopped, keep their job function counters, so the totals don't go backwards
+	statsLock.Enter();
+	IndexT i;
+	for (i = 0; i < statsFuncs.Size(); i++)
+	{
+		IndexT j;
+		for (j = 0; j < threads.Size(); j++)
+			threads[j]->AccumulateFuncStats(statsFuncs[i], statsFuncs[i]->retired);
+	}
+	IndexT statsIndex = statsPorts.FindIndex(id);
+	if (statsIndex != InvalidIndex)
+		statsPorts.EraseIndexSwap(statsIndex);
+	statsLock.Leave();
+
     threads.Clear();
     jobPortAllocator.Dealloc((Ids::Id32)id.id);
 }
@@ -64,6 +151,11 @@ CreateJob(const CreateJobInfo& info)
 	// ugh, so ugly, would rather have these in the allocator, but atomic_uint is not copyable, and events don't implement copy constructors or moves yet
 	jobAllocator.Get<JobScratchMemory>(job) = { Memory::HeapType::ScratchHeap, 0, nullptr };
 
+	// freed job slots keep their counters, jobs recreated every frame with the same function find them there
+	JobFuncCounters*& counters = jobAllocator.Get<JobCounters>(job);
+	if (counters == nullptr || counters->JobFunc != info.JobFunc || (counters->name == nullptr && info.name != nullptr))
+		counters = FindJobFuncCounters(info);
+
 	JobId id;
 	id.id = job;
 	return id;
@@ -109,6 +201,9 @@ JobSchedule(const JobId& job, const JobPortId& port, const JobContext& ctx, cons
 
 	// job related stuff
 	const CreateJobInfo& info = jobAllocator.Get<0>(job.id);	
+	JobFuncCounters* counters = jobAllocator.Get<JobCounters>(job.id);
+	counters->numSchedules.fetch_add(1, std::memory_order_relaxed);
+	const uint64_t queued = Debug::ProfilingNanoseconds();
 
 	SizeT numInputSlices = (ctx.input.dataSize[0] + (ctx.input.sliceSize[0] - 1)) / ctx.input.sliceSize[0];
 	SizeT numOutputSlices = (ctx.output.dataSize[0] + (ctx.output.sliceSize[0] - 1)) / ctx.output.sliceSize[0];
@@ -141,6 +236,8 @@ JobSchedule(const JobId& job, const JobPortId& port, const JobContext& ctx, cons
 			cmd.run.context = ctx;
 			cmd.run.JobFunc = info.JobFunc;
 			cmd.run.callback = callback ? &callback : nullptr;
+			cmd.run.counters = counters;
+			cmd.run.queued = queued;
 			threads[threadIndex]->PushCommand(cmd);
 
 			offset += numWorkUnitSlices[i];
@@ -161,6 +258,8 @@ JobSchedule(const JobId& job, const JobPortId& port)
 	Util::FixedArray<Ptr<JobThread>>& threads = jobPortAllocator.Get<PortThreads>((Ids::Id32)port.id);
 	const uint& threadIndex = jobPortAllocator.Get<PortNextThreadIndex>((Ids::Id32)port.id);
 	const CreateJobInfo& info = jobAllocator.Get<0>(job.id);
+	JobFuncCounters* counters = jobAllocator.Get<JobCounters>(job.id);
+	counters->numSchedules.fetch_add(1, std::memory_order_relaxed);
 	JobThread::JobThreadCommand cmd;
 	cmd.ev = JobThread::RunJob;
 	cmd.run.slice = 0;
@@ -168,6 +267,8 @@ JobSchedule(const JobId& job, const JobPortId& port)
 	cmd.run.context = Jobs::JobContext();
 	cmd.run.JobFunc = info.JobFunc;
 	cmd.run.callback = nullptr;
+	cmd.run.counters = counters;
+	cmd.run.queued = Debug::ProfilingNanoseconds();
 	threads[threadIndex]->PushCommand(cmd);
 }
 
@@ -300,7 +401,12 @@ void
 JobSyncHostWait(const JobSyncId id)
 {
 	Threading::Event* event = jobSyncAllocator.Get<SyncCompletionEvent>(id.id);
+	const uint64_t start = Debug::ProfilingNanoseconds();
 	event->Wait();
+	const uint64_t time = Debug::ProfilingNanoseconds() - start;
+	hostWaitCount.fetch_add(1, std::memory_order_relaxed);
+	hostWaitTime.fetch_add(time, std::memory_order_relaxed);
+	CounterMax(hostWaitMaxTime, time);
 }
 
 //------------------------------------------------------------------------------
@@ -336,6 +442,76 @@ JobSyncSignaled(const JobSyncId id)
 	return event->Peek();
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+JobHostWaitStats
+JobGetHostWaitStats()
+{
+	JobHostWaitStats stats;
+	stats.numWaits = hostWaitCount.load(std::memory_order_relaxed);
+	stats.waitTime = hostWaitTime.load(std::memory_order_relaxed);
+	stats.maxWaitTime = hostWaitMaxTime.load(std::memory_order_relaxed);
+	return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JobGetPortStats(Util::Array<JobPortStats>& outStats)
+{
+	outStats.Clear();
+	statsLock.Enter();
+	IndexT i;
+	for (i = 0; i < statsPorts.Size(); i++)
+	{
+		const JobPortId port = statsPorts[i];
+		const Util::FixedArray<Ptr<JobThread>>& threads = jobPortAllocator.Get<PortThreads>((Ids::Id32)port.id);
+		JobPortStats stats;
+		stats.port = port;
+		stats.name = jobPortAllocator.Get<PortName>((Ids::Id32)port.id);
+		stats.threads.Reserve(threads.Size());
+		IndexT j;
+		for (j = 0; j < threads.Size(); j++)
+			stats.threads.Append(threads[j]->GetStats());
+		outStats.Append(stats);
+	}
+	statsLock.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JobGetFuncStats(Util::Array<JobFuncStats>& outStats)
+{
+	outStats.Clear();
+	statsLock.Enter();
+	outStats.Reserve(statsFuncs.Size());
+	IndexT i;
+	for (i = 0; i < statsFuncs.Size(); i++)
+	{
+		const JobFuncCounters* counters = statsFuncs[i];
+		JobFuncStats stats = counters->retired;
+		stats.name = counters->name;
+		stats.JobFunc = counters->JobFunc;
+		stats.numSchedules = counters->numSchedules.load(std::memory_order_relaxed);
+
+		// sum up the counters of the job threads
+		IndexT j;
+		for (j = 0; j < statsPorts.Size(); j++)
+		{
+			const Util::FixedArray<Ptr<JobThread>>& threads = jobPortAllocator.Get<PortThreads>((Ids::Id32)statsPorts[j].id);
+			IndexT k;
+			for (k = 0; k < threads.Size(); k++)
+				threads[k]->AccumulateFuncStats(counters, stats);
+		}
+		outStats.Append(stats);
+	}
+	statsLock.Leave();
+}
+
 __ImplementClass(Jobs::JobThread, 'JBTH', Threading::Thread);
 //------------------------------------------------------------------------------
 /**
@@ -343,7 +519,16 @@ __ImplementClass(Jobs::JobThread, 'JBTH', Threading::Thread);
 JobThread::JobThread() :
 	scratchBuffer(nullptr)
 {
-	// empty
+	this->counters.numCommands = 0;
+	this->counters.numSlices = 0;
+	this->counters.queueTime = 0;
+	this->counters.maxQueueTime = 0;
+	this->counters.executionTime = 0;
+	this->counters.waitTime = 0;
+	this->counters.idleTime = 0;
+	IndexT i;
+	for (i = 0; i < MaxNumJobFuncs; i++)
+		this->funcCounters[i] = nullptr;
 }
 
 //------------------------------------------------------------------------------
@@ -356,6 +541,12 @@ JobThread::~JobThread()
     {
         this->Stop();
     }
+	IndexT i;
+	for (i = 0; i < MaxNumJobFuncs; i++)
+	{
+		if (this->funcCounters[i] != nullptr)
+			n_delete(this->funcCounters[i].load(std::memory_order_relaxed));
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -392,10 +583,42 @@ JobThread::DoWork()
 			switch (cmd.ev)
 			{
 			case RunJob:
+			{
+				N_SCOPE("RunJob", "Jobs");
+				const uint64_t start = Debug::ProfilingNanoseconds();
 				this->RunJobSlices(cmd.run.slice, cmd.run.numSlices, cmd.run.context, cmd.run.JobFunc, cmd.run.callback);
+				const uint64_t end = Debug::ProfilingNanoseconds();
+
+				const uint64_t queueTime = start - cmd.run.queued;
+				const uint64_t executionTime = end - start;
+				CounterAdd(this->counters.numCommands, 1);
+				CounterAdd(this->counters.numSlices, cmd.run.numSlices);
+				CounterAdd(this->counters.queueTime, queueTime);
+				CounterAdd(this->counters.executionTime, executionTime);
+				if (queueTime > this->counters.maxQueueTime.load(std::memory_order_relaxed))
+					this->counters.maxQueueTime.store(queueTime, std::memory_order_relaxed);
+
+				// the function counters are private to this thread as well, readers sum them up over all threads
+				std::atomic<JobFuncThreadCounters*>& funcSlot = this->funcCounters[cmd.run.counters->index];
+				JobFuncThreadCounters* funcCounters = funcSlot.load(std::memory_order_relaxed);
+				if (funcCounters == nullptr)
+				{
+					funcCounters = n_new(JobFuncThreadCounters);
+					funcSlot.store(funcCounters, std::memory_order_release);
+				}
+				CounterAdd(funcCounters->numCommands, 1);
+				CounterAdd(funcCounters->numSlices, cmd.run.numSlices);
+				CounterAdd(funcCounters->queueTime, queueTime);
+				CounterAdd(funcCounters->executionTime, executionTime);
+				if (queueTime > funcCounters->maxQueueTime.load(std::memory_order_relaxed))
+					funcCounters->maxQueueTime.store(queueTime, std::memory_order_relaxed);
+				if (executionTime > funcCounters->maxExecutionTime.load(std::memory_order_relaxed))
+					funcCounters->maxExecutionTime.store(executionTime, std::memory_order_relaxed);
 				break;
+			}
 			case Signal:
 			{
+				N_SCOPE("Signal", "Jobs");
 				// subtract 1 from completion counter
 				uint prev = cmd.sync.completionCounter->fetch_sub(1);
 				if (prev == 1)
@@ -407,13 +630,20 @@ JobThread::DoWork()
 				break;
 			}
 			case Wait:
+			{
+				N_SCOPE("Wait", "Jobs");
+				const uint64_t start = Debug::ProfilingNanoseconds();
 				cmd.sync.ev->Wait();
+				CounterAdd(this->counters.waitTime, Debug::ProfilingNanoseconds() - start);
 				break;
 			}
+			}
 		}
 
 		// reset commands, but don't destroy them
+		const uint64_t idleStart = Debug::ProfilingNanoseconds();
 		this->commands.Wait();
+		CounterAdd(this->counters.idleTime, Debug::ProfilingNanoseconds() - idleStart);
 	}
 
 	// free scratch buffer
@@ -511,4 +741,42 @@ JobThread::PushCommands(const Util::Array<JobThreadCommand>& commands)
 	this->commands.EnqueueArray(commands);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+JobThreadStats
+JobThread::GetStats() const
+{
+	JobThreadStats stats;
+	stats.numCommands = this->counters.numCommands.load(std::memory_order_relaxed);
+	stats.numSlices = this->counters.numSlices.load(std::memory_order_relaxed);
+	stats.queueTime = this->counters.queueTime.load(std::memory_order_relaxed);
+	stats.maxQueueTime = this->counters.maxQueueTime.load(std::memory_order_relaxed);
+	stats.executionTime = this->counters.executionTime.load(std::memory_order_relaxed);
+	stats.waitTime = this->counters.waitTime.load(std::memory_order_relaxed);
+	stats.idleTime = this->counters.idleTime.load(std::memory_order_relaxed);
+	return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+JobThread::AccumulateFuncStats(const JobFuncCounters* func, JobFuncStats& stats) const
+{
+	const JobFuncThreadCounters* funcCounters = this->funcCounters[func->index].load(std::memory_order_acquire);
+	if (funcCounters == nullptr)
+		return;
+	stats.numCommands += funcCounters->numCommands.load(std::memory_order_relaxed);
+	stats.numSlices += funcCounters->numSlices.load(std::memory_order_relaxed);
+	stats.queueTime += funcCounters->queueTime.load(std::memory_order_relaxed);
+	stats.executionTime += funcCounters->executionTime.load(std::memory_order_relaxed);
+	const uint64_t maxQueueTime = funcCounters->maxQueueTime.load(std::memory_order_relaxed);
+	if (maxQueueTime > stats.maxQueueTime)
+		stats.maxQueueTime = maxQueueTime;
+	const uint64_t maxExecutionTime = funcCounters->maxExecutionTime.load(std::memory_order_relaxed);
+	if (maxExecutionTime > stats.maxExecutionTime)
+		stats.maxExecutionTime = maxExecutionTime;
+}
+
 } // namespace Jobs
@@ -19,6 +19,12 @@
 	How to setup a job:
 		Create port, create a job when required, use the function context to provide the
 		job with inputs, outputs and uniform data.
+
+	The job system keeps statistics about queue latency, execution and idle time per
+	port thread and per job function, and about the time spent in JobSyncHostWait.
+	They can be read with JobGetPortStats, JobGetFuncStats and JobGetHostWaitStats,
+	or viewed on the jobs page of the debug http server. All counters are totals,
+	take two snapshots and subtract them to get the numbers for a frame.
 		
 
 	(C) 2018-2020 Individual contributors, see AUTHORS file
@@ -87,6 +93,73 @@ struct JobContext
 	JobUniformData uniform;
 };
 
+//------------------------------------------------------------------------------
+/**
+	Snapshot of the counters of a job thread, times are in nanoseconds
+*/
+struct JobThreadStats
+{
+	uint64_t numCommands;		// number of job commands executed
+	uint64_t numSlices;			// number of job slices executed
+	uint64_t queueTime;			// total time between scheduling and start of execution
+	uint64_t maxQueueTime;		// longest time a job command waited in the queue
+	uint64_t executionTime;		// total time spent executing job slices
+	uint64_t waitTime;			// total time spent waiting in JobSyncThreadWait
+	uint64_t idleTime;			// total time spent waiting for new commands
+};
+
+//------------------------------------------------------------------------------
+/**
+	Snapshot of the counters of a job function, accumulated over all ports and threads
+*/
+struct JobFuncStats
+{
+	const char* name;
+	void(*JobFunc)(const JobFuncContext& ctx);
+	uint64_t numSchedules;		// number of times a job with this function was scheduled
+	uint64_t numCommands;		// number of commands, a schedule is split into one command per thread
+	uint64_t numSlices;			// number of job slices executed
+	uint64_t queueTime;			// total time between scheduling and start of execution
+	uint64_t maxQueueTime;		// longest time a job command waited in the queue
+	uint64_t executionTime;		// total time spent executing job slices
+	uint64_t maxExecutionTime;	// longest time a single job command took
+};
+
+//------------------------------------------------------------------------------
+/**
+	Snapshot of the time the calling threads have spent in JobSyncHostWait
+*/
+struct JobHostWaitStats
+{
+	uint64_t numWaits;
+	uint64_t waitTime;
+	uint64_t maxWaitTime;
+};
+
+/// max number of distinct job functions the statistics can tell apart
+static const SizeT MaxNumJobFuncs = 256;
+
+/// counters of a job function, registered once per function and cached in the job
+struct JobFuncCounters
+{
+	const char* name;
+	void(*JobFunc)(const JobFuncContext& ctx);
+	IndexT index;							// slot of the function in the per thread counters
+	std::atomic<uint64_t> numSchedules;
+	JobFuncStats retired;					// totals of the job threads which have been destroyed, protected by the stats lock
+};
+
+/// counters of a job function on a single job thread, only written by that thread
+struct JobFuncThreadCounters
+{
+	std::atomic<uint64_t> numCommands{ 0 };
+	std::atomic<uint64_t> numSlices{ 0 };
+	std::atomic<uint64_t> queueTime{ 0 };
+	std::atomic<uint64_t> maxQueueTime{ 0 };
+	std::atomic<uint64_t> executionTime{ 0 };
+	std::atomic<uint64_t> maxExecutionTime{ 0 };
+};
+
 class JobThread : public Threading::Thread
 {
 	__DeclareClass(JobThread);
@@ -111,6 +184,8 @@ public:
 				JobContext context;
 				void(*JobFunc)(const JobFuncContext& ctx);
 				const std::function<void()>* callback;
+				JobFuncCounters* counters;
+				uint64_t queued;
 			} run;
 
 			struct // synchronize
@@ -140,6 +215,10 @@ public:
 	void PushCommand(const JobThreadCommand& command);
 	/// push command buffer work
 	void PushCommands(const Util::Array<JobThreadCommand>& commands);
+	/// get a snapshot of the counters, may be called from any thread
+	JobThreadStats GetStats() const;
+	/// add the counters this thread keeps for a job function to stats, may be called from any thread
+	void AccumulateFuncStats(const JobFuncCounters* func, JobFuncStats& stats) const;
 
 private:
 
@@ -147,6 +226,21 @@ private:
 
 	Threading::SafeQueue<JobThreadCommand> commands;
 	ubyte* scratchBuffer;
+
+	// only written by the job thread itself, read by GetStats
+	struct
+	{
+		std::atomic<uint64_t> numCommands;
+		std::atomic<uint64_t> numSlices;
+		std::atomic<uint64_t> queueTime;
+		std::atomic<uint64_t> maxQueueTime;
+		std::atomic<uint64_t> executionTime;
+		std::atomic<uint64_t> waitTime;
+		std::atomic<uint64_t> idleTime;
+	} counters;
+
+	// per job function counters, allocated by the job thread the first time it runs the function
+	std::atomic<JobFuncThreadCounters*> funcCounters[MaxNumJobFuncs];
 };
 
 //------------------------------------------------------------------------------
@@ -171,6 +265,16 @@ void DestroyJobPort(const JobPortId& id);
 /// check to see if port is idle
 bool JobPortBusy(const JobPortId& id);
 
+struct JobPortStats
+{
+	JobPortId port;
+	Util::StringAtom name;
+	Util::Array<JobThreadStats> threads;
+};
+
+/// get the counters of all threads of all ports
+void JobGetPortStats(Util::Array<JobPortStats>& outStats);
+
 enum
 {
 	PortName,
@@ -192,6 +296,7 @@ extern JobPortAllocator jobPortAllocator;
 struct CreateJobInfo
 {
 	void(*JobFunc)(const JobFuncContext& ctx);
+	const char* name;		// optional, shown in the job statistics
 };
 
 /// create job
@@ -212,6 +317,9 @@ void JobScheduleSequence(const Util::Array<JobId>& jobs, const JobPortId& port,
 /// allocate memory for job
 void* JobAllocateScratchMemory(const JobId& job, const Memory::HeapType heap, const SizeT size);
 
+/// get the counters of every job function which has been used so far
+void JobGetFuncStats(Util::Array<JobFuncStats>& outStats);
+
 struct PrivateMemory
 {
 	Memory::HeapType heapType;
@@ -223,13 +331,15 @@ enum
 {
 	JobCreateInfo,
 	JobCallbackFunc,
-	JobScratchMemory
+	JobScratchMemory,
+	JobCounters
 };
 
 typedef Ids::IdAllocator<
 	CreateJobInfo,				// 0 - job info
 	std::function<void()>,		// 1 - callback
-	PrivateMemory				// 4 - private buffer, destroyed when job is finished
+	PrivateMemory,				// 2 - private buffer, destroyed when job is finished
+	JobFuncCounters*			// 3 - counters of the job function, shared by all jobs using it
 > JobAllocator;
 extern JobAllocator jobAllocator;
 
@@ -264,6 +374,9 @@ void JobSyncThreadWait(const JobSyncId id, const JobPortId port);
 /// returns true if sync object has been signaled
 bool JobSyncSignaled(const JobSyncId id);
 
+/// get the time spent in JobSyncHostWait
+JobHostWaitStats JobGetHostWaitStats();
+
 typedef Ids::IdAllocator<
 	std::function<void()>,		// 0 - callback
 	Threading::Event*,			// 1 - event
@@ -0,0 +1,356 @@
+//------------------------------------------------------------------------------
+//  blockpool.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memory/blockpool.h"
+#if __WIN32__
+#include <intrin.h>
+#endif
+
+namespace Memory
+{
+
+ThreadLocal int BlockPoolThreadIndex = -1;
+
+//------------------------------------------------------------------------------
+/**
+    Gives the thread index back when its thread exits.
+*/
+struct BlockPoolThreadIndexOwner
+{
+    ~BlockPoolThreadIndexOwner();
+};
+
+static Threading::CriticalSection blockPoolThreadIndexLock;
+static int blockPoolFreeThreadIndices[BlockPool::MaxThreads];
+static int blockPoolNumFreeThreadIndices = 0;
+static int blockPoolNextThreadIndex = 0;
+static thread_local BlockPoolThreadIndexOwner blockPoolThreadIndexOwner;
+
+//------------------------------------------------------------------------------
+/**
+    A thread which frees blocks after this point, from the destructor of
+    another thread local object, falls back to the shared free list.
+*/
+BlockPoolThreadIndexOwner::~BlockPoolThreadIndexOwner()
+{
+    const int index = BlockPoolThreadIndex;
+    BlockPoolThreadIndex = BlockPool::MaxThreads;
+    if (index >= 0 && index < BlockPool::MaxThreads)
+    {
+        blockPoolThreadIndexLock.Enter();
+        blockPoolFreeThreadIndices[blockPoolNumFreeThreadIndices++] = index;
+        blockPoolThreadIndexLock.Leave();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+BlockPool::AcquireThreadIndex()
+{
+    int index = MaxThreads;
+    blockPoolThreadIndexLock.Enter();
+    if (blockPoolNumFreeThreadIndices > 0)
+        index = blockPoolFreeThreadIndices[--blockPoolNumFreeThreadIndices];
+    else if (blockPoolNextThreadIndex < MaxThreads)
+        index = blockPoolNextThreadIndex++;
+    blockPoolThreadIndexLock.Leave();
+
+    // make sure the index is given back when this thread exits
+    (void)&blockPoolThreadIndexOwner;
+    BlockPoolThreadIndex = index;
+    return index;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Load the head of the global list. The pointer and the tag are read
+    separately, a torn read only makes the following compare-and-swap fail.
+*/
+static inline void
+LoadHead(const void* head, void*& outBatch, uint64_t& outTag)
+{
+    const uint64_t* words = (const uint64_t*)head;
+    #if __WIN32__
+    outTag = *(const volatile uint64_t*)&words[1];
+    outBatch = (void*)*(const volatile uint64_t*)&words[0];
+    #else
+    outTag = __atomic_load_n(&words[1], __ATOMIC_ACQUIRE);
+    outBatch = (void*)__atomic_load_n(&words[0], __ATOMIC_ACQUIRE);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    Swap the pointer and the tag of the global list in one go. Updates the
+    expected values with the current ones if the swap fails. On gcc and
+    clang this needs cmpxchg16b, which the -march setting of the build
+    enables.
+*/
+static inline bool
+CompareAndSwapHead(void* head, void*& expectedBatch, uint64_t& expectedTag, void* batch, uint64_t tag)
+{
+    #if __WIN32__
+    __int64 comparand[2] = { (__int64)expectedBatch, (__int64)expectedTag };
+    const bool swapped = _InterlockedCompareExchange128((volatile __int64*)head, (__int64)tag, (__int64)batch, comparand) != 0;
+    expectedBatch = (void*)comparand[0];
+    expectedTag = (uint64_t)comparand[1];
+    return swapped;
+    #else
+    typedef unsigned __int128 uint128;
+    const uint128 comparand = ((uint128)expectedTag << 64) | (uint64_t)expectedBatch;
+    const uint128 exchange = ((uint128)tag << 64) | (uint64_t)batch;
+    const uint128 prev = __sync_val_compare_and_swap((uint128*)head, comparand, exchange);
+    if (prev == comparand)
+        return true;
+    expectedBatch = (void*)(uint64_t)prev;
+    expectedTag = (uint64_t)(prev >> 64);
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+BlockPool::BlockPool() :
+    name(nullptr),
+    heapType(Memory::InvalidHeapType),
+    blockSize(0),
+    blockStride(0),
+    blocksPerChunk(0),
+    numChunks(0)
+{
+    static_assert(sizeof(FreeBlock) <= 16, "A free block must fit into the front guard");
+    memset(this->threadLists, 0, sizeof(this->threadLists));
+    this->globalHead.batch = nullptr;
+    this->globalHead.tag = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+BlockPool::~BlockPool()
+{
+    if (this->IsValid())
+        this->Discard();
+}
+
+//------------------------------------------------------------------------------
+/**
+    The number of blocks per chunk is rounded up to a multiple of the
+    batch size.
+*/
+void
+BlockPool::Setup(const char* name, Memory::HeapType heapType, SizeT blockSize, SizeT blocksPerChunk)
+{
+    n_assert(!this->IsValid());
+    n_assert(blockSize > 0);
+    n_assert(blocksPerChunk > 0);
+    this->name = name;
+    this->heapType = heapType;
+    this->blockSize = blockSize;
+    #if NEBULA_DEBUG
+    this->blockStride = GuardSize + ((blockSize + 15) & ~15) + GuardSize;
+    #else
+    this->blockStride = blockSize > (SizeT)sizeof(FreeBlock) ? ((blockSize + 15) & ~15) : (SizeT)sizeof(FreeBlock);
+    #endif
+    this->blocksPerChunk = ((blocksPerChunk + BatchSize - 1) / BatchSize) * BatchSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPool::Discard()
+{
+    n_assert(this->IsValid());
+    IndexT i;
+    for (i = 0; i < this->chunks.Size(); i++)
+    {
+        Memory::Free(this->heapType, this->chunks[i]);
+    }
+    this->chunks.Clear();
+    this->numChunks.store(0, std::memory_order_relaxed);
+    memset(this->threadLists, 0, sizeof(this->threadLists));
+    this->globalHead.batch = nullptr;
+    this->globalHead.tag = 0;
+    this->name = nullptr;
+    this->heapType = Memory::InvalidHeapType;
+    this->blockSize = 0;
+    this->blockStride = 0;
+    this->blocksPerChunk = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPool::Refill(ThreadList& list)
+{
+    n_assert(list.head == nullptr);
+    FreeBlock* batch = this->PopBatch();
+    if (batch == nullptr)
+        batch = this->AllocChunk();
+    list.head = batch;
+    list.count = BatchSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Blocks at the front of the list were freed last and are the most
+    likely to be in the cache, but that also goes for the next Alloc(), so
+    the batch is taken from the front and the thread keeps the older ones.
+*/
+void
+BlockPool::ReleaseBatch(ThreadList& list)
+{
+    FreeBlock* batch = list.head;
+    FreeBlock* last = batch;
+    IndexT i;
+    for (i = 1; i < BatchSize; i++)
+    {
+        last = last->next;
+    }
+    list.head = last->next;
+    list.count -= BatchSize;
+    last->next = nullptr;
+    this->PushBatch(batch);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPool::PushBatch(FreeBlock* batch)
+{
+    void* head;
+    uint64_t tag;
+    LoadHead(&this->globalHead, head, tag);
+    do
+    {
+        batch->nextBatch.store((FreeBlock*)head, std::memory_order_relaxed);
+    }
+    while (!CompareAndSwapHead(&this->globalHead, head, tag, batch, tag + 1));
+}
+
+//------------------------------------------------------------------------------
+/**
+    The batch at the head may be popped, handed out and overwritten by
+    another thread while it is being read here. Chunks are never freed
+    while the pool is in use, so the read is safe, and the tag makes the
+    swap fail.
+*/
+BlockPool::FreeBlock*
+BlockPool::PopBatch()
+{
+    void* head;
+    uint64_t tag;
+    LoadHead(&this->globalHead, head, tag);
+    while (head != nullptr)
+    {
+        FreeBlock* next = ((FreeBlock*)head)->nextBatch.load(std::memory_order_relaxed);
+        if (CompareAndSwapHead(&this->globalHead, head, tag, next, tag + 1))
+            return (FreeBlock*)head;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Threads which run dry at the same time wait for the one which allocates
+    the chunk, and then take their batches from the global list.
+*/
+BlockPool::FreeBlock*
+BlockPool::AllocChunk()
+{
+    this->chunkLock.Enter();
+    FreeBlock* result = this->PopBatch();
+    if (result == nullptr)
+    {
+        uchar* chunk = (uchar*)Memory::Alloc(this->heapType, this->blockStride * this->blocksPerChunk);
+        n_assert(((uintptr_t)chunk & 15) == 0);
+        this->chunks.Append(chunk);
+
+        IndexT batchIndex;
+        for (batchIndex = 0; batchIndex < this->blocksPerChunk / BatchSize; batchIndex++)
+        {
+            uchar* first = chunk + batchIndex * BatchSize * this->blockStride;
+            IndexT i;
+            for (i = 0; i < BatchSize; i++)
+            {
+                FreeBlock* block = (FreeBlock*)(first + i * this->blockStride);
+                block->next = i < BatchSize - 1 ? (FreeBlock*)(first + (i + 1) * this->blockStride) : nullptr;
+                new (&block->nextBatch) std::atomic<FreeBlock*>(nullptr);
+            }
+            if (batchIndex == 0)
+                result = (FreeBlock*)first;
+            else
+                this->PushBatch((FreeBlock*)first);
+        }
+        this->numChunks.fetch_add(1, std::memory_order_relaxed);
+    }
+    this->chunkLock.Leave();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void*
+BlockPool::AllocShared()
+{
+    this->sharedListLock.Enter();
+    ThreadList& list = this->threadLists[MaxThreads];
+    if (list.head == nullptr)
+        this->Refill(list);
+    FreeBlock* block = list.head;
+    list.head = block->next;
+    list.count--;
+    this->sharedListLock.Leave();
+    return this->BlockToPtr(block);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPool::FreeShared(void* ptr)
+{
+    FreeBlock* block = this->PtrToBlock(ptr);
+    this->sharedListLock.Enter();
+    ThreadList& list = this->threadLists[MaxThreads];
+    block->next = list.head;
+    list.head = block;
+    list.count++;
+    if (list.count > 2 * BatchSize)
+        this->ReleaseBatch(list);
+    this->sharedListLock.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+    A damaged front guard means an underrun or that the block has already
+    been freed, in which case it holds the free list links.
+*/
+void
+BlockPool::CheckGuards(uchar* block) const
+{
+    #if NEBULA_DEBUG
+    const uchar* back = block + GuardSize + this->blockSize;
+    IndexT i;
+    for (i = 0; i < GuardSize; i++)
+    {
+        if (block[i] != GuardPattern)
+            n_error("BlockPool '%s': block at %p was freed twice or written before its start!\n", this->name, block + GuardSize);
+        if (back[i] != GuardPattern)
+            n_error("BlockPool '%s': block at %p was written past its end!\n", this->name, block + GuardSize);
+    }
+    #else
+    (void)block;
+    #endif
+}
+
+} // namespace Memory
@@ -0,0 +1,314 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Memory::BlockPool
+
+    Thread safe pool of fixed-size blocks, which may be used from job
+    functions and any other thread without taking a lock.
+
+    Every thread owns a free list in every pool, Alloc() and Free() only
+    touch the calling thread's list. A thread refills an empty list with a
+    batch of blocks from a global list, and returns a batch once its list
+    grows beyond two batches, so blocks freed by other threads than the
+    ones which allocated them circulate back. The global list is a stack
+    of batches, which is changed with a single compare-and-swap of a
+    pointer and a tag. The tag is incremented by every change, so a batch
+    which was popped and pushed again in between can't be mistaken for an
+    unchanged list (the ABA problem). New memory is allocated in chunks
+    from the pool's heap and is only given back when the pool is
+    discarded.
+
+    The free lists are indexed by a small per-thread index, which is given
+    to the next new thread when a thread exits, together with the blocks
+    left in its lists. The first MaxThreads threads get their own lists,
+    any more threads share a list which is protected by a lock.
+
+    In debug builds every block is surrounded by guard bytes, which are
+    checked when the block is freed, and freed blocks are filled with a
+    pattern.
+
+    Blocks are 16 byte aligned.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include "util/array.h"
+#include "threading/criticalsection.h"
+#include <atomic>
+#include <new>
+#include <utility>
+
+//------------------------------------------------------------------------------
+namespace Memory
+{
+
+/// index of the free lists of the calling thread, use BlockPool::GetThreadIndex()
+extern ThreadLocal int BlockPoolThreadIndex;
+
+class BlockPool
+{
+public:
+    /// number of threads which get their own free lists
+    static const SizeT MaxThreads = 64;
+    /// number of blocks moved between a thread and the global list at once
+    static const SizeT BatchSize = 32;
+
+    /// constructor
+    BlockPool();
+    /// destructor
+    ~BlockPool();
+
+    /// setup the pool, name must be a static string
+    void Setup(const char* name, Memory::HeapType heapType, SizeT blockSize, SizeT blocksPerChunk = 1024);
+    /// discard the pool and its memory, no other thread may use the pool at the same time
+    void Discard();
+    /// return true if the pool has been setup
+    bool IsValid() const;
+
+    /// allocate a block
+    void* Alloc();
+    /// free a block, may be called from another thread than the one which allocated it
+    void Free(void* ptr);
+    /// allocate a block and construct an object in it
+    template <typename TYPE, typename... ARGS> TYPE* New(ARGS&&... args);
+    /// destroy an object and free its block
+    template <typename TYPE> void Delete(TYPE* ptr);
+
+    /// get the name of the pool
+    const char* GetName() const;
+    /// get the usable size of a block
+    SizeT GetBlockSize() const;
+    /// get the number of chunks allocated so far
+    SizeT GetNumChunks() const;
+    /// get the number of blocks in all chunks
+    SizeT GetCapacity() const;
+
+    /// get the index of the calling thread's free lists, MaxThreads for the shared list
+    static int GetThreadIndex();
+
+private:
+    /// a block while it is free, the batch link is only valid for the first block of a batch
+    struct FreeBlock
+    {
+        FreeBlock* next;
+        std::atomic<FreeBlock*> nextBatch;
+    };
+
+    /// head of the global list, a batch pointer and a tag which changes with every update
+    struct alignas(16) TaggedHead
+    {
+        FreeBlock* batch;
+        uint64_t tag;
+    };
+
+    /// a free list, owned by one thread
+    struct alignas(64) ThreadList
+    {
+        FreeBlock* head;
+        SizeT count;
+    };
+
+    /// assign a thread index to the calling thread
+    static int AcquireThreadIndex();
+    /// refill an empty free list from the global list or from a new chunk
+    void Refill(ThreadList& list);
+    /// return a batch from the front of a free list to the global list
+    void ReleaseBatch(ThreadList& list);
+    /// push a linked batch of BatchSize blocks onto the global list
+    void PushBatch(FreeBlock* batch);
+    /// pop a batch from the global list, returns nullptr if the list is empty
+    FreeBlock* PopBatch();
+    /// allocate a new chunk, keeps one batch for the caller and pushes the rest
+    FreeBlock* AllocChunk();
+    /// allocate from the shared free list
+    void* AllocShared();
+    /// free to the shared free list
+    void FreeShared(void* ptr);
+    /// turn a free block into a block which is handed out
+    void* BlockToPtr(FreeBlock* block);
+    /// turn a pointer which is given back into a free block
+    FreeBlock* PtrToBlock(void* ptr);
+    /// check the guard bytes of a block which is given back
+    void CheckGuards(uchar* block) const;
+
+    #if NEBULA_DEBUG
+    static const SizeT GuardSize = 16;
+    static const uchar GuardPattern = 0xfd;
+    static const uchar FreedPattern = 0xdd;
+    #else
+    static const SizeT GuardSize = 0;
+    #endif
+
+    const char* name;
+    Memory::HeapType heapType;
+    SizeT blockSize;
+    SizeT blockStride;
+    SizeT blocksPerChunk;
+    ThreadList threadLists[MaxThreads + 1];
+    Threading::CriticalSection sharedListLock;
+    TaggedHead globalHead;
+    Threading::CriticalSection chunkLock;
+    Util::Array<void*> chunks;
+    std::atomic<SizeT> numChunks;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+BlockPool::IsValid() const
+{
+    return this->blockSize > 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline int
+BlockPool::GetThreadIndex()
+{
+    int index = BlockPoolThreadIndex;
+    if (index < 0)
+        index = AcquireThreadIndex();
+    return index;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void*
+BlockPool::BlockToPtr(FreeBlock* block)
+{
+    #if NEBULA_DEBUG
+    uchar* data = (uchar*)block;
+    memset(data, GuardPattern, GuardSize);
+    memset(data + GuardSize + this->blockSize, GuardPattern, GuardSize);
+    return data + GuardSize;
+    #else
+    return block;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline BlockPool::FreeBlock*
+BlockPool::PtrToBlock(void* ptr)
+{
+    #if NEBULA_DEBUG
+    uchar* data = (uchar*)ptr - GuardSize;
+    this->CheckGuards(data);
+    memset(data + GuardSize, FreedPattern, this->blockSize);
+    return (FreeBlock*)data;
+    #else
+    return (FreeBlock*)ptr;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void*
+BlockPool::Alloc()
+{
+    n_assert(this->IsValid());
+    const int threadIndex = GetThreadIndex();
+    if (threadIndex == MaxThreads)
+        return this->AllocShared();
+
+    ThreadList& list = this->threadLists[threadIndex];
+    if (list.head == nullptr)
+        this->Refill(list);
+    FreeBlock* block = list.head;
+    list.head = block->next;
+    list.count--;
+    return this->BlockToPtr(block);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+BlockPool::Free(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+    const int threadIndex = GetThreadIndex();
+    if (threadIndex == MaxThreads)
+    {
+        this->FreeShared(ptr);
+        return;
+    }
+
+    ThreadList& list = this->threadLists[threadIndex];
+    FreeBlock* block = this->PtrToBlock(ptr);
+    block->next = list.head;
+    list.head = block;
+    list.count++;
+    if (list.count > 2 * BatchSize)
+        this->ReleaseBatch(list);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename TYPE, typename... ARGS>
+inline TYPE*
+BlockPool::New(ARGS&&... args)
+{
+    n_assert(sizeof(TYPE) <= (size_t)this->blockSize);
+    return new (this->Alloc()) TYPE(std::forward<ARGS>(args)...);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename TYPE>
+inline void
+BlockPool::Delete(TYPE* ptr)
+{
+    if (ptr != nullptr)
+    {
+        ptr->~TYPE();
+        this->Free(ptr);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline const char*
+BlockPool::GetName() const
+{
+    return this->name;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+BlockPool::GetBlockSize() const
+{
+    return this->blockSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+BlockPool::GetNumChunks() const
+{
+    return this->numChunks.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+BlockPool::GetCapacity() const
+{
+    return this->GetNumChunks() * this->blocksPerChunk;
+}
+
+} // namespace Memory
+//------------------------------------------------------------------------------
@@ -8,6 +8,8 @@
 #include "memory/heap.h"
 #include "http/html/htmlpagewriter.h"
 #include "memory/poolarrayallocator.h"
+#include "memory/memorytracker.h"
+#include "memory/frameallocator.h"
 
 namespace Debug
 {
@@ -18,6 +20,170 @@ using namespace Http;
 using namespace Util;
 using namespace Memory;
 
+#if NEBULA_MEMORY_TRACKING
+//------------------------------------------------------------------------------
+/**
+    Shows the allocations of the last frame by callsite, /memory?tracking=on
+    or off enables or disables the allocation tracker.
+*/
+static void
+WriteTrackerReport(const Ptr<HttpRequest>& request, const Ptr<HtmlPageWriter>& htmlWriter)
+{
+    Dictionary<String,String> query = request->GetURI().ParseQuery();
+    if (query.Contains("tracking"))
+        TrackerEnable(query["tracking"] == "on");
+
+    htmlWriter->Element(HtmlElement::Heading3, "Allocations Last Frame");
+    htmlWriter->AddAttr("href", TrackerIsEnabled() ? "/memory?tracking=off" : "/memory?tracking=on");
+    htmlWriter->Element(HtmlElement::Anchor, TrackerIsEnabled() ? "Disable allocation tracking" : "Enable allocation tracking");
+    if (!TrackerIsEnabled())
+        return;
+
+    TrackerFrameReport report;
+    TrackerGetLastFrame(report);
+    htmlWriter->Begin(HtmlElement::Table);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Frame:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromUInt(report.frameIndex));
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Allocations:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(report.allocCount));
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Allocated Size:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(report.allocSize) + " bytes");
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Dropped Records:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(report.droppedCount));
+        htmlWriter->End(HtmlElement::TableRow);
+    htmlWriter->End(HtmlElement::Table);
+
+    htmlWriter->AddAttr("border", "1");
+    htmlWriter->AddAttr("rules", "cols");
+    htmlWriter->Begin(HtmlElement::Table);
+        htmlWriter->AddAttr("bgcolor", "lightsteelblue");
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableHeader, "Alloc Count");
+            htmlWriter->Element(HtmlElement::TableHeader, "Alloc Size");
+            htmlWriter->Element(HtmlElement::TableHeader, "Heap");
+            htmlWriter->Element(HtmlElement::TableHeader, "Callsite");
+        htmlWriter->End(HtmlElement::TableRow);
+
+        IndexT i;
+        for (i = 0; i < report.callsites.Size() && i < 50; i++)
+        {
+            const TrackerCallsiteStats& stats = report.callsites[i];
+            Array<String> stack = TrackerGetCallsiteStack(stats.callsite);
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableData, String::FromInt(stats.allocCount));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats.allocSize));
+                htmlWriter->Element(HtmlElement::TableData, GetHeapTypeName(stats.heapType));
+                htmlWriter->Begin(HtmlElement::TableData);
+                IndexT j;
+                for (j = 0; j < stack.Size(); j++)
+                {
+                    htmlWriter->Text(stack[j]);
+                    htmlWriter->LineBreak();
+                }
+                htmlWriter->End(HtmlElement::TableData);
+            htmlWriter->End(HtmlElement::TableRow);
+        }
+    htmlWriter->End(HtmlElement::Table);
+}
+#endif
+
+//------------------------------------------------------------------------------
+/**
+    Shows how much transient memory the frames allocate.
+*/
+static void
+WriteFrameAllocatorStats(const Ptr<HtmlPageWriter>& htmlWriter)
+{
+    FrameAllocatorStats stats;
+    FrameAllocatorGetStats(stats);
+
+    htmlWriter->Element(HtmlElement::Heading3, "Frame Allocator Stats");
+    htmlWriter->Begin(HtmlElement::Table);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Frame:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromUInt(stats.frameIndex));
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Threads:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(stats.numThreads));
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Last Frame:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats.lastFrameSize) + " bytes");
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "High-Water Mark:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats.highWaterMark) + " bytes");
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Thread High-Water Mark:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats.threadHighWaterMark) + " bytes");
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Reserved:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats.reservedSize) + " bytes");
+        htmlWriter->End(HtmlElement::TableRow);
+    htmlWriter->End(HtmlElement::Table);
+}
+
+#if NEBULA_MEMORY_THREADCACHE
+//------------------------------------------------------------------------------
+/**
+    Shows the statistics of the thread caching allocator, which are kept
+    even if NEBULA_MEMORY_STATS is off.
+*/
+static void
+WriteThreadCacheStats(const Ptr<HtmlPageWriter>& htmlWriter)
+{
+    ThreadCacheHeapStats stats[NumHeapTypes];
+    ThreadCacheGetStats(stats);
+
+    htmlWriter->Element(HtmlElement::Heading3, "Thread Cache Stats");
+    htmlWriter->Begin(HtmlElement::Table);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Threads:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(ThreadCacheGetNumThreads()));
+        htmlWriter->End(HtmlElement::TableRow);
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableData, "Slab Memory:");
+            htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(ThreadCacheGetSlabSize() / 1024) + " KB");
+        htmlWriter->End(HtmlElement::TableRow);
+    htmlWriter->End(HtmlElement::Table);
+
+    htmlWriter->AddAttr("border", "1");
+    htmlWriter->AddAttr("rules", "cols");
+    htmlWriter->Begin(HtmlElement::Table);
+        htmlWriter->AddAttr("bgcolor", "lightsteelblue");
+        htmlWriter->Begin(HtmlElement::TableRow);
+            htmlWriter->Element(HtmlElement::TableHeader, "Heap Name");
+            htmlWriter->Element(HtmlElement::TableHeader, "Live Count");
+            htmlWriter->Element(HtmlElement::TableHeader, "Live Size");
+            htmlWriter->Element(HtmlElement::TableHeader, "Total Allocs");
+            htmlWriter->Element(HtmlElement::TableHeader, "Total Frees");
+        htmlWriter->End(HtmlElement::TableRow);
+
+        IndexT i;
+        for (i = 0; i < NumHeapTypes; i++)
+        {
+            htmlWriter->Begin(HtmlElement::TableRow);
+                htmlWriter->Element(HtmlElement::TableData, GetHeapTypeName((HeapType)i));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats[i].allocCount - stats[i].freeCount));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats[i].allocSize - stats[i].freeSize));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats[i].allocCount));
+                htmlWriter->Element(HtmlElement::TableData, String::FromLongLong(stats[i].freeCount));
+            htmlWriter->End(HtmlElement::TableRow);
+        }
+    htmlWriter->End(HtmlElement::Table);
+}
+#endif
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -217,6 +383,14 @@ MemoryPageHandler::HandleRequest(const Ptr<HttpRequest>& request)
 
         #endif // NEBULA_OBJECTS_USE_MEMORYPOOL
         #endif // NEBULA_MEMORY_STATS
+
+        WriteFrameAllocatorStats(htmlWriter);
+        #if NEBULA_MEMORY_THREADCACHE
+        WriteThreadCacheStats(htmlWriter);
+        #endif
+        #if NEBULA_MEMORY_TRACKING
+        WriteTrackerReport(request, htmlWriter);
+        #endif
         htmlWriter->Close();
         request->SetStatus(HttpStatus::OK);
     }
@@ -0,0 +1,269 @@
+//------------------------------------------------------------------------------
+//  frameallocator.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memory/frameallocator.h"
+#include "threading/criticalsection.h"
+#include <atomic>
+
+namespace Memory
+{
+
+static const size_t FrameChunkSize = 256 * 1024;
+
+/// a block of memory of an arena, the data follows the header
+struct FrameChunk
+{
+    FrameChunk* next;
+    size_t size;
+};
+
+/// the chunks of an arena for one of the buffered frames
+struct FrameArenaSlot
+{
+    std::atomic<uint> frame;        // frame which last used the slot
+    std::atomic<size_t> used;       // bytes allocated during that frame, only written by the owner
+    FrameChunk* first;
+    FrameChunk* current;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Arenas are never freed, a thread which exits hands its arena over to
+    the next thread which starts allocating.
+*/
+struct FrameArena
+{
+    FrameArenaSlot slots[FrameAllocatorNumFrames];
+    FrameArenaSlot* slot;           // slot of the current frame
+    uint frame;
+    char* cur;
+    char* end;
+    FrameArena* next;
+    std::atomic<bool> inUse;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Gives the arena of a thread back when the thread exits.
+*/
+struct FrameArenaOwner
+{
+    ~FrameArenaOwner();
+};
+
+static std::atomic<uint> frameAllocatorFrame{ 0 };
+static std::atomic<FrameArena*> frameArenaList{ nullptr };
+static std::atomic<size_t> frameAllocatorReservedSize{ 0 };
+static Threading::CriticalSection frameAllocatorStatsLock;
+static FrameAllocatorStats frameAllocatorStats = { 0, 0, 0, 0, 0, 0 };
+static ThreadLocal FrameArena* frameArena = nullptr;
+static thread_local FrameArenaOwner frameArenaOwner;
+
+//------------------------------------------------------------------------------
+/**
+*/
+FrameArenaOwner::~FrameArenaOwner()
+{
+    if (frameArena != nullptr)
+    {
+        frameArena->inUse.store(false, std::memory_order_release);
+        frameArena = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static FrameArena*
+FrameArenaAcquire()
+{
+    FrameArena* arena;
+    for (arena = frameArenaList.load(std::memory_order_acquire); arena != nullptr; arena = arena->next)
+    {
+        bool expected = false;
+        if (!arena->inUse.load(std::memory_order_relaxed) &&
+            arena->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            break;
+    }
+    if (arena == nullptr)
+    {
+        arena = n_new(FrameArena);
+        IndexT i;
+        for (i = 0; i < FrameAllocatorNumFrames; i++)
+        {
+            arena->slots[i].frame.store(InvalidIndex, std::memory_order_relaxed);
+            arena->slots[i].used.store(0, std::memory_order_relaxed);
+            arena->slots[i].first = nullptr;
+            arena->slots[i].current = nullptr;
+        }
+        arena->slot = nullptr;
+        arena->frame = InvalidIndex;
+        arena->cur = nullptr;
+        arena->end = nullptr;
+        arena->inUse.store(true, std::memory_order_relaxed);
+        FrameArena* head = frameArenaList.load(std::memory_order_relaxed);
+        do
+        {
+            arena->next = head;
+        }
+        while (!frameArenaList.compare_exchange_weak(head, arena, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // make sure the arena is given back when this thread exits
+    (void)&frameArenaOwner;
+    frameArena = arena;
+    return arena;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Switch an arena to the slot of a new frame. If the slot still holds
+    the memory of an old frame it is reset. Chunks which that frame didn't
+    need are freed, so an arena shrinks again after a peak.
+*/
+static void
+FrameArenaBeginFrame(FrameArena* arena, uint frame)
+{
+    FrameArenaSlot* slot = &arena->slots[frame % FrameAllocatorNumFrames];
+    if (slot->frame.load(std::memory_order_relaxed) != frame)
+    {
+        FrameChunk* unused = slot->current != nullptr ? slot->current->next : slot->first;
+        if (slot->current != nullptr)
+            slot->current->next = nullptr;
+        else
+            slot->first = nullptr;
+        while (unused != nullptr)
+        {
+            FrameChunk* next = unused->next;
+            frameAllocatorReservedSize.fetch_sub(unused->size, std::memory_order_relaxed);
+            Memory::Free(Memory::ScratchHeap, unused);
+            unused = next;
+        }
+        slot->current = slot->first;
+        slot->used.store(0, std::memory_order_relaxed);
+        slot->frame.store(frame, std::memory_order_release);
+    }
+    arena->slot = slot;
+    arena->frame = frame;
+    if (slot->current != nullptr)
+    {
+        arena->cur = (char*)(slot->current + 1);
+        arena->end = arena->cur + slot->current->size;
+    }
+    else
+    {
+        arena->cur = nullptr;
+        arena->end = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Move on to the next chunk of the current slot, or put a new chunk
+    after the current one if the next one is too small.
+*/
+static void
+FrameArenaGrow(FrameArena* arena, size_t size, size_t alignment)
+{
+    FrameArenaSlot* slot = arena->slot;
+    const size_t needed = size + alignment;
+    FrameChunk* chunk = slot->current != nullptr ? slot->current->next : slot->first;
+    if (chunk == nullptr || chunk->size < needed)
+    {
+        const size_t chunkSize = needed > FrameChunkSize ? needed : FrameChunkSize;
+        FrameChunk* newChunk = (FrameChunk*)Memory::Alloc(Memory::ScratchHeap, sizeof(FrameChunk) + chunkSize);
+        newChunk->size = chunkSize;
+        newChunk->next = chunk;
+        if (slot->current != nullptr)
+            slot->current->next = newChunk;
+        else
+            slot->first = newChunk;
+        frameAllocatorReservedSize.fetch_add(chunkSize, std::memory_order_relaxed);
+        chunk = newChunk;
+    }
+    slot->current = chunk;
+    arena->cur = (char*)(chunk + 1);
+    arena->end = arena->cur + chunk->size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void*
+FrameAlloc(size_t size, size_t alignment)
+{
+    n_assert((alignment & (alignment - 1)) == 0);
+    FrameArena* arena = frameArena;
+    if (arena == nullptr)
+        arena = FrameArenaAcquire();
+    const uint frame = frameAllocatorFrame.load(std::memory_order_relaxed);
+    if (arena->frame != frame)
+        FrameArenaBeginFrame(arena, frame);
+
+    char* ptr = (char*)(((uintptr_t)arena->cur + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    if (arena->cur == nullptr || ptr + size > arena->end)
+    {
+        FrameArenaGrow(arena, size, alignment);
+        ptr = (char*)(((uintptr_t)arena->cur + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    }
+    arena->cur = ptr + size;
+
+    std::atomic<size_t>& used = arena->slot->used;
+    used.store(used.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Threads might still be allocating while the frame is summed up, so the
+    size of a frame is only exact if all work of that frame is done.
+*/
+void
+FrameAllocatorNewFrame()
+{
+    const uint frame = frameAllocatorFrame.load(std::memory_order_relaxed);
+    size_t frameSize = 0;
+    size_t threadMax = 0;
+    SizeT numThreads = 0;
+    FrameArena* arena;
+    for (arena = frameArenaList.load(std::memory_order_acquire); arena != nullptr; arena = arena->next)
+    {
+        const FrameArenaSlot& slot = arena->slots[frame % FrameAllocatorNumFrames];
+        if (slot.frame.load(std::memory_order_acquire) == frame)
+        {
+            const size_t used = slot.used.load(std::memory_order_relaxed);
+            frameSize += used;
+            threadMax = used > threadMax ? used : threadMax;
+        }
+        if (arena->inUse.load(std::memory_order_relaxed))
+            numThreads++;
+    }
+
+    frameAllocatorStatsLock.Enter();
+    frameAllocatorStats.frameIndex = frame;
+    frameAllocatorStats.numThreads = numThreads;
+    frameAllocatorStats.lastFrameSize = frameSize;
+    if (frameSize > frameAllocatorStats.highWaterMark)
+        frameAllocatorStats.highWaterMark = frameSize;
+    if (threadMax > frameAllocatorStats.threadHighWaterMark)
+        frameAllocatorStats.threadHighWaterMark = threadMax;
+    frameAllocatorStatsLock.Leave();
+
+    frameAllocatorFrame.store(frame + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FrameAllocatorGetStats(FrameAllocatorStats& outStats)
+{
+    frameAllocatorStatsLock.Enter();
+    outStats = frameAllocatorStats;
+    frameAllocatorStatsLock.Leave();
+    outStats.reservedSize = frameAllocatorReservedSize.load(std::memory_order_relaxed);
+}
+
+} // namespace Memory
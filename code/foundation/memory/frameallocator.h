@@ -0,0 +1,84 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file memory/frameallocator.h
+
+    Linear allocator for transient data which only lives for a few frames,
+    such as draw packets and the parameters of jobs.
+
+    Every thread bumps a pointer through its own arena, so FrameAlloc()
+    never takes a lock and costs little more than an aligned pointer
+    increment. An arena keeps a list of chunks for each of the last
+    FrameAllocatorNumFrames frames. Memory allocated during a frame stays
+    valid until FrameAllocatorNewFrame() has been called that many times,
+    which leaves room for consumers lagging behind the frame that filled
+    it, like the GPU. After that the owning thread reuses the chunks as
+    soon as it allocates again. Memory is never freed individually and
+    destructors are never run.
+
+    FrameAllocatorNewFrame() is called once per frame by the application.
+    It also sums up how much the finished frame allocated and keeps the
+    high-water marks.
+
+        Packet* packet = Memory::FrameNew<Packet>(...);
+        float* weights = Memory::FrameAllocArray<float>(numWeights);
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include <new>
+#include <utility>
+
+//------------------------------------------------------------------------------
+namespace Memory
+{
+
+/// number of frames memory from FrameAlloc() stays valid
+static const SizeT FrameAllocatorNumFrames = 3;
+
+/// frame allocator statistics, sizes in bytes
+struct FrameAllocatorStats
+{
+    uint frameIndex;
+    SizeT numThreads;               // threads which own an arena
+    size_t lastFrameSize;           // allocated by all threads during the last frame
+    size_t highWaterMark;           // largest frame so far
+    size_t threadHighWaterMark;     // largest frame of a single thread so far
+    size_t reservedSize;            // held in chunks by all arenas
+};
+
+/// allocate transient memory, may be called from any thread
+void* FrameAlloc(size_t size, size_t alignment = 16);
+/// allocate transient memory for an array, constructors are not called
+template <typename TYPE> TYPE* FrameAllocArray(SizeT count);
+/// allocate and construct a transient object, the destructor is never called
+template <typename TYPE, typename... ARGS> TYPE* FrameNew(ARGS&&... args);
+
+/// start a new frame, the memory of the frame FrameAllocatorNumFrames ago may be reused from now on
+void FrameAllocatorNewFrame();
+/// get the statistics of the frame allocator, may be called from any thread
+void FrameAllocatorGetStats(FrameAllocatorStats& outStats);
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename TYPE>
+inline TYPE*
+FrameAllocArray(SizeT count)
+{
+    return (TYPE*)FrameAlloc(sizeof(TYPE) * count, alignof(TYPE) > 16 ? alignof(TYPE) : 16);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename TYPE, typename... ARGS>
+inline TYPE*
+FrameNew(ARGS&&... args)
+{
+    void* mem = FrameAlloc(sizeof(TYPE), alignof(TYPE) > 16 ? alignof(TYPE) : 16);
+    return new (mem) TYPE(std::forward<ARGS>(args)...);
+}
+
+} // namespace Memory
+//------------------------------------------------------------------------------
@@ -0,0 +1,420 @@
+//------------------------------------------------------------------------------
+//  memorytracker.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memory/memorytracker.h"
+
+#if NEBULA_MEMORY_TRACKING
+#include "threading/criticalsection.h"
+#include "util/flathashtable.h"
+#include <atomic>
+#include <stdlib.h>
+#if !__WIN32__
+#include <execinfo.h>
+#endif
+
+namespace Memory
+{
+
+// published with release after trackerCallsites is allocated, the allocators test it with acquire
+std::atomic<bool> TrackerEnabled{ false };
+
+//------------------------------------------------------------------------------
+/**
+    A single allocation
+*/
+struct TrackerRecord
+{
+    uint64_t callsite;
+    uint size;
+    uint frameIndex;
+    HeapType heapType;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Ring of records written by one thread and read by TrackerEndFrame
+*/
+struct TrackerThreadBuffer
+{
+    static const uint Capacity = 16384;
+
+    std::atomic<uint> write;
+    std::atomic<uint> read;
+    std::atomic<uint> dropped;
+    TrackerRecord records[Capacity];
+};
+
+//------------------------------------------------------------------------------
+/**
+    Stack of a callsite, stored the first time the callsite is seen
+*/
+struct TrackerCallsite
+{
+    static const SizeT MaxFrames = 12;
+
+    std::atomic<uint64_t> callsite;
+    std::atomic<bool> ready;
+    int numFrames;
+    void* frames[MaxFrames];
+};
+
+static const SizeT TrackerMaxThreads = 256;
+static const SizeT TrackerMaxCallsites = 8192;
+
+static TrackerThreadBuffer* trackerThreads[TrackerMaxThreads] = { nullptr };
+static std::atomic<SizeT> trackerNumThreads{ 0 };
+static TrackerCallsite* trackerCallsites = nullptr;
+static std::atomic<uint> trackerFrameIndex{ 0 };
+static ThreadLocal TrackerThreadBuffer* trackerThreadBuffer = nullptr;
+static ThreadLocal bool trackerBusy = false;
+
+// only touched by the thread which calls TrackerEndFrame
+static Util::FlatHashTable<uint64_t, IndexT> trackerCallsiteIndices;
+static TrackerFrameReport trackerCurrentReport;
+
+// the report of the last frame, also read by the http thread
+static Threading::CriticalSection trackerReportLock;
+static TrackerFrameReport trackerLastReport;
+
+struct TrackerBudget
+{
+    SizeT maxAllocCount;
+    size_t maxAllocSize;
+};
+static TrackerBudget trackerBudgets[NumHeapTypes + 1] = { { 0, 0 } };
+static bool trackerBudgetsFatal = false;
+
+//------------------------------------------------------------------------------
+/**
+    Store the stack of a callsite unless it is known already. The table is
+    filled lock free, the slot is claimed by the first thread to swap in the
+    hash, and readers wait for the ready flag before looking at the frames.
+*/
+static void
+TrackerRegisterCallsite(uint64_t callsite, void** frames, int numFrames)
+{
+    uint64_t slot = callsite & (TrackerMaxCallsites - 1);
+    SizeT probe;
+    for (probe = 0; probe < TrackerMaxCallsites; probe++)
+    {
+        TrackerCallsite& entry = trackerCallsites[slot];
+        uint64_t current = entry.callsite.load(std::memory_order_acquire);
+        if (current == callsite)
+            return;
+        if (current == 0)
+        {
+            if (entry.callsite.compare_exchange_strong(current, callsite, std::memory_order_acq_rel))
+            {
+                entry.numFrames = Math::n_min(numFrames, TrackerCallsite::MaxFrames);
+                Memory::Copy(frames, entry.frames, entry.numFrames * sizeof(void*));
+                entry.ready.store(true, std::memory_order_release);
+                return;
+            }
+            if (current == callsite)
+                return;
+        }
+        slot = (slot + 1) & (TrackerMaxCallsites - 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static TrackerThreadBuffer*
+TrackerGetThreadBuffer()
+{
+    if (trackerThreadBuffer == nullptr)
+    {
+        // don't go through Memory::Alloc, the tracker would record itself
+        SizeT index = trackerNumThreads.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= TrackerMaxThreads)
+            return nullptr;
+        TrackerThreadBuffer* buffer = (TrackerThreadBuffer*)calloc(1, sizeof(TrackerThreadBuffer));
+        trackerThreads[index] = buffer;
+        trackerThreadBuffer = buffer;
+    }
+    return trackerThreadBuffer;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Called by Memory::Alloc when the tracker is enabled.
+*/
+void
+TrackerRecordAlloc(HeapType heapType, size_t size)
+{
+    if (trackerBusy)
+        return;
+    trackerBusy = true;
+
+    TrackerThreadBuffer* buffer = TrackerGetThreadBuffer();
+    if (buffer != nullptr)
+    {
+        // skip our own frame, Alloc is inlined into its caller
+        void* frames[TrackerCallsite::MaxFrames + 1];
+#if __WIN32__
+        int numFrames = CaptureStackBackTrace(0, TrackerCallsite::MaxFrames + 1, frames, NULL) - 1;
+#else
+        int numFrames = backtrace(frames, TrackerCallsite::MaxFrames + 1) - 1;
+#endif
+        uint64_t callsite = 14695981039346656037ull;
+        int i;
+        for (i = 0; i < numFrames; i++)
+        {
+            callsite ^= (uint64_t)PtrT(frames[i + 1]);
+            callsite *= 1099511628211ull;
+        }
+        if (callsite == 0)
+            callsite = 1;
+        TrackerRegisterCallsite(callsite, frames + 1, numFrames);
+
+        const uint write = buffer->write.load(std::memory_order_relaxed);
+        const uint read = buffer->read.load(std::memory_order_acquire);
+        if (write - read == TrackerThreadBuffer::Capacity)
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        else
+        {
+            TrackerRecord& record = buffer->records[write & (TrackerThreadBuffer::Capacity - 1)];
+            record.callsite = callsite;
+            record.size = (uint)size;
+            record.frameIndex = trackerFrameIndex.load(std::memory_order_relaxed);
+            record.heapType = heapType;
+            buffer->write.store(write + 1, std::memory_order_release);
+        }
+    }
+    trackerBusy = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TrackerEnable(bool enable)
+{
+    if (enable && trackerCallsites == nullptr)
+        trackerCallsites = (TrackerCallsite*)calloc(TrackerMaxCallsites, sizeof(TrackerCallsite));
+    TrackerEnabled.store(enable, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TrackerIsEnabled()
+{
+    return TrackerEnabled.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+TrackerCompareCallsites(const TrackerCallsiteStats& lhs, const TrackerCallsiteStats& rhs)
+{
+    return lhs.allocCount > rhs.allocCount;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+TrackerCheckBudget(const TrackerFrameReport& report, IndexT budgetIndex, SizeT allocCount, size_t allocSize)
+{
+    const TrackerBudget& budget = trackerBudgets[budgetIndex];
+    if ((budget.maxAllocCount == 0 || allocCount <= budget.maxAllocCount) && (budget.maxAllocSize == 0 || allocSize <= budget.maxAllocSize))
+        return true;
+
+    const char* heapName = budgetIndex == NumHeapTypes ? "total" : GetHeapTypeName((HeapType)budgetIndex);
+    Util::String msg;
+    msg.Format("Memory::TrackerEndFrame(): frame %d exceeded the %s allocation budget with %d allocations, %d bytes (budget %d allocations, %d bytes)\n",
+        report.frameIndex, heapName, allocCount, (int)allocSize, budget.maxAllocCount, (int)budget.maxAllocSize);
+
+    // list the worst offenders
+    SizeT listed = 0;
+    IndexT i;
+    for (i = 0; i < report.callsites.Size() && listed < 5; i++)
+    {
+        const TrackerCallsiteStats& stats = report.callsites[i];
+        if (budgetIndex != NumHeapTypes && stats.heapType != budgetIndex)
+            continue;
+        msg.Append(Util::String::Sprintf("    %d allocations, %d bytes at\n", stats.allocCount, (int)stats.allocSize));
+
+        // the innermost frames are often containers, show a few callers as well
+        Util::Array<Util::String> stack = TrackerGetCallsiteStack(stats.callsite);
+        IndexT j;
+        for (j = 0; j < stack.Size() && j < 4; j++)
+            msg.Append(Util::String::Sprintf("        %s\n", stack[j].AsCharPtr()));
+        listed++;
+    }
+
+    if (trackerBudgetsFatal)
+        n_error("%s", msg.AsCharPtr());
+    else
+        n_warning("%s", msg.AsCharPtr());
+    return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Drains the records of all threads up to the closing frame. Records in a
+    ring are in allocation order, so draining a thread stops at the first
+    record which belongs to the next frame.
+*/
+bool
+TrackerEndFrame()
+{
+    const uint closingFrame = trackerFrameIndex.fetch_add(1, std::memory_order_acq_rel);
+    if (!TrackerEnabled.load(std::memory_order_acquire) && trackerNumThreads.load(std::memory_order_acquire) == 0)
+        return true;
+
+    // the report containers allocate, which must not be recorded
+    const bool wasBusy = trackerBusy;
+    trackerBusy = true;
+
+    TrackerFrameReport& report = trackerCurrentReport;
+    report.frameIndex = closingFrame;
+    report.allocCount = 0;
+    report.allocSize = 0;
+    report.droppedCount = 0;
+    IndexT i;
+    for (i = 0; i < NumHeapTypes; i++)
+    {
+        report.heapAllocCount[i] = 0;
+        report.heapAllocSize[i] = 0;
+    }
+    report.callsites.Clear();
+    trackerCallsiteIndices.Reset();
+
+    const SizeT numThreads = Math::n_min(trackerNumThreads.load(std::memory_order_acquire), TrackerMaxThreads);
+    for (i = 0; i < numThreads; i++)
+    {
+        TrackerThreadBuffer* buffer = trackerThreads[i];
+        if (buffer == nullptr)
+            continue;
+
+        uint read = buffer->read.load(std::memory_order_relaxed);
+        const uint write = buffer->write.load(std::memory_order_acquire);
+        while (read != write)
+        {
+            const TrackerRecord& record = buffer->records[read & (TrackerThreadBuffer::Capacity - 1)];
+            if ((int)(record.frameIndex - closingFrame) > 0)
+                break;
+
+            report.allocCount++;
+            report.allocSize += record.size;
+            report.heapAllocCount[record.heapType]++;
+            report.heapAllocSize[record.heapType] += record.size;
+
+            // the same stack may allocate from different heaps, keep them apart
+            const uint64_t key = record.callsite ^ ((uint64_t)record.heapType << 56);
+            IndexT slot = trackerCallsiteIndices.FindIndex(key);
+            if (slot == InvalidIndex)
+            {
+                trackerCallsiteIndices.Add(key, report.callsites.Size());
+                TrackerCallsiteStats stats = { record.callsite, record.heapType, 1, record.size };
+                report.callsites.Append(stats);
+            }
+            else
+            {
+                TrackerCallsiteStats& stats = report.callsites[trackerCallsiteIndices.ValueAtIndex(key, slot)];
+                stats.allocCount++;
+                stats.allocSize += record.size;
+            }
+            read++;
+        }
+        buffer->read.store(read, std::memory_order_release);
+        report.droppedCount += buffer->dropped.exchange(0, std::memory_order_relaxed);
+    }
+    report.callsites.SortWithFunc(TrackerCompareCallsites);
+
+    // check the budgets
+    bool withinBudget = TrackerCheckBudget(report, NumHeapTypes, report.allocCount, report.allocSize);
+    for (i = 0; i < NumHeapTypes; i++)
+        withinBudget &= TrackerCheckBudget(report, i, report.heapAllocCount[i], report.heapAllocSize[i]);
+
+    trackerReportLock.Enter();
+    trackerLastReport = report;
+    trackerReportLock.Leave();
+
+    trackerBusy = wasBusy;
+    return withinBudget;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TrackerGetLastFrame(TrackerFrameReport& outReport)
+{
+    trackerReportLock.Enter();
+    outReport = trackerLastReport;
+    trackerReportLock.Leave();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Util::Array<Util::String>
+TrackerGetCallsiteStack(uint64_t callsite)
+{
+    Util::Array<Util::String> result;
+    if (trackerCallsites == nullptr)
+        return result;
+
+    uint64_t slot = callsite & (TrackerMaxCallsites - 1);
+    SizeT probe;
+    for (probe = 0; probe < TrackerMaxCallsites; probe++)
+    {
+        const TrackerCallsite& entry = trackerCallsites[slot];
+        const uint64_t current = entry.callsite.load(std::memory_order_acquire);
+        if (current == 0)
+            break;
+        if (current == callsite)
+        {
+            if (!entry.ready.load(std::memory_order_acquire))
+                break;
+#if __WIN32__
+            int i;
+            for (i = 0; i < entry.numFrames; i++)
+                result.Append(Util::String::Sprintf("%p", entry.frames[i]));
+#else
+            char** symbols = backtrace_symbols(entry.frames, entry.numFrames);
+            if (symbols != nullptr)
+            {
+                int i;
+                for (i = 0; i < entry.numFrames; i++)
+                    result.Append(symbols[i]);
+                free(symbols);
+            }
+#endif
+            break;
+        }
+        slot = (slot + 1) & (TrackerMaxCallsites - 1);
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TrackerSetFrameBudget(HeapType heapType, SizeT maxAllocCount, size_t maxAllocSize)
+{
+    n_assert(heapType <= NumHeapTypes);
+    trackerBudgets[heapType].maxAllocCount = maxAllocCount;
+    trackerBudgets[heapType].maxAllocSize = maxAllocSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TrackerSetBudgetsFatal(bool fatal)
+{
+    trackerBudgetsFatal = fatal;
+}
+
+} // namespace Memory
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file memory/memorytracker.h
+
+    Allocation tracker which attributes the allocations of every frame to
+    the callsites which made them.
+
+    When enabled, Memory::Alloc and Memory::Realloc record the hash of the
+    calling stack, the heap type, the size and the current frame index of
+    every allocation into a buffer owned by the allocating thread. The
+    buffers are single producer, single consumer rings, so allocating
+    threads never take a lock. TrackerEndFrame(), called once per frame by
+    the application, drains them into a report of the frame, sorted by the
+    number of allocations per callsite, and checks the report against the
+    per-frame budgets in debug builds.
+
+    The tracker is compiled in with NEBULA_MEMORY_TRACKING and costs a
+    single flag test per allocation until TrackerEnable(true) is called.
+    Capturing the stack is expensive, so expect allocation heavy code to
+    run noticeably slower while it is enabled. Only the posix allocation
+    functions report to the tracker.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/config.h"
+#include "memory/memory.h"
+#include "util/array.h"
+#include "util/string.h"
+
+#if NEBULA_MEMORY_TRACKING
+//------------------------------------------------------------------------------
+namespace Memory
+{
+
+/// allocations of one callsite during a frame
+struct TrackerCallsiteStats
+{
+    uint64_t callsite;          // hash of the stack of the callsite
+    HeapType heapType;
+    SizeT allocCount;
+    size_t allocSize;
+};
+
+/// allocations of a frame
+struct TrackerFrameReport
+{
+    uint frameIndex;
+    SizeT allocCount;
+    size_t allocSize;
+    SizeT heapAllocCount[NumHeapTypes];
+    size_t heapAllocSize[NumHeapTypes];
+    SizeT droppedCount;                             // allocations which didn't fit into a thread's buffer
+    Util::Array<TrackerCallsiteStats> callsites;    // sorted by allocation count, highest first
+};
+
+/// enable or disable recording of allocations
+void TrackerEnable(bool enable);
+/// returns true if allocations are recorded
+bool TrackerIsEnabled();
+/// close the current frame, builds the frame report and checks the budgets, returns false if a budget was exceeded
+bool TrackerEndFrame();
+/// get a copy of the report of the last frame, may be called from any thread
+void TrackerGetLastFrame(TrackerFrameReport& outReport);
+/// get the symbolized stack of a callsite
+Util::Array<Util::String> TrackerGetCallsiteStack(uint64_t callsite);
+
+/// set the per-frame budget of a heap, NumHeapTypes sets the budget over all heaps, 0 means unlimited
+void TrackerSetFrameBudget(HeapType heapType, SizeT maxAllocCount, size_t maxAllocSize);
+/// stop the application instead of printing a warning when a budget is exceeded
+void TrackerSetBudgetsFatal(bool fatal);
+
+} // namespace Memory
+#endif
+//------------------------------------------------------------------------------
@@ -46,3 +46,64 @@ void DumpMemoryLeaks()
 #endif
 
 } // namespace Memory
+
+//------------------------------------------------------------------------------
+/**
+    Replacement global new operator.
+*/
+void*
+operator new(size_t size)
+{
+    return Memory::Alloc(Memory::ObjectHeap, size);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Replacement global new[] operator.
+*/
+void*
+operator new[](size_t size)
+{
+    return Memory::Alloc(Memory::ObjectArrayHeap, size);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Replacement global delete operator.
+*/
+void
+operator delete(void* p) noexcept
+{
+    Memory::Free(Memory::ObjectHeap, p);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Replacement global delete[] operator.
+*/
+void
+operator delete[](void* p) noexcept
+{
+    Memory::Free(Memory::ObjectArrayHeap, p);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Replacement global sized delete operator, the compiler calls this
+    instead of the unsized one when the size is known.
+*/
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    Memory::Free(Memory::ObjectHeap, p);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Replacement global sized delete[] operator.
+*/
+void
+operator delete[](void* p, std::size_t) noexcept
+{
+    Memory::Free(Memory::ObjectArrayHeap, p);
+}
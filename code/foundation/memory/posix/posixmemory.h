@@ -14,7 +14,9 @@
 #include "core/debug.h"
 #include "threading/interlocked.h"
 #include "memory/posix/posixmemoryconfig.h"
+#include "memory/posix/posixthreadcache.h"
 #include <malloc.h>
+#include <atomic>
 #include <string.h>
 
 namespace Memory
@@ -25,6 +27,10 @@ extern int volatile TotalAllocSize;
 extern int volatile HeapTypeAllocCount[NumHeapTypes];
 extern int volatile HeapTypeAllocSize[NumHeapTypes];
 #endif
+#if NEBULA_MEMORY_TRACKING
+extern std::atomic<bool> TrackerEnabled;
+extern void TrackerRecordAlloc(HeapType heapType, size_t size);
+#endif
 
 //------------------------------------------------------------------------------
 /**
@@ -38,7 +44,11 @@ Alloc(HeapType heapType, size_t size)
     {
         // XXX: n_assert(0 != Heaps[heapType]);
         // allocPtr =  HeapAlloc(Heaps[heapType], HEAP_GENERATE_EXCEPTIONS, size);
-        allocPtr = memalign(16,size);        
+        #if NEBULA_MEMORY_THREADCACHE
+        allocPtr = ThreadCacheAlloc(heapType, size);
+        #else
+        allocPtr = memalign(16,size);
+        #endif
         #if NEBULA_DEBUG
         explicit_bzero(allocPtr,size);
         #endif
@@ -50,6 +60,10 @@ Alloc(HeapType heapType, size_t size)
         Threading::Interlocked::Increment(HeapTypeAllocCount[heapType]);
         Threading::Interlocked::Add(HeapTypeAllocSize[heapType], int(s));
     #endif
+    #if NEBULA_MEMORY_TRACKING
+        if (TrackerEnabled.load(std::memory_order_acquire))
+            TrackerRecordAlloc(heapType, size);
+    #endif
     return allocPtr;
 }
 
@@ -66,12 +80,20 @@ Realloc(HeapType heapType, void* ptr, size_t size)
         SIZE_T oldSize = HeapSize(Heaps[heapType], 0, ptr);
     #endif
     // void* allocPtr = HeapReAlloc(Heaps[heapType], HEAP_GENERATE_EXCEPTIONS, ptr, size);
+    #if NEBULA_MEMORY_THREADCACHE
+    void* allocPtr = ThreadCacheRealloc(heapType, ptr, size);
+    #else
     void* allocPtr = realloc(ptr, size);
+    #endif
     #if NEBULA_MEMORY_STATS
         SIZE_T newSize = HeapSize(Heaps[heapType], 0, allocPtr);
         Threading::Interlocked::Add(TotalAllocSize, int(newSize - oldSize));
         Threading::Interlocked::Add(HeapTypeAllocSize[heapType], int(newSize - oldSize));
     #endif
+    #if NEBULA_MEMORY_TRACKING
+        if (TrackerEnabled.load(std::memory_order_acquire))
+            TrackerRecordAlloc(heapType, size);
+    #endif
     return allocPtr;
 }
 
@@ -95,7 +117,11 @@ Free(HeapType heapType, void* ptr)
                 size = HeapSize(Heaps[heapType], 0, ptr);
             #endif
             // HeapFree(Heaps[heapType], 0, ptr);
+            #if NEBULA_MEMORY_THREADCACHE
+            ThreadCacheFree(ptr);
+            #else
             free(ptr);
+            #endif
         }
         #if NEBULA_MEMORY_STATS
             Threading::Interlocked::Add(TotalAllocSize, -int(size));
@@ -122,6 +148,22 @@ Copy(const void* from, void* to, size_t numBytes)
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Move a chunk of memory, can handle overlapping regions
+*/
+__forceinline void
+Move(const void* from, void* to, size_t numBytes)
+{
+    if (numBytes > 0)
+    {
+        n_assert(0 != from);
+        n_assert(0 != to);
+        n_assert(from != to);
+        memmove(to, from, numBytes);
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
     Copy data from a system memory buffer to graphics resource memory. Some
@@ -241,45 +283,9 @@ extern bool Validate();
 #undef delete
 #endif
 
-//------------------------------------------------------------------------------
-/**
-    Replacement global new operator.
-*/
-__forceinline void*
-__cdecl operator new(size_t size)
-{
-    return Memory::Alloc(Memory::ObjectHeap, size);
-}
-
-//------------------------------------------------------------------------------
-/**
-    Replacement global new[] operator.
-*/
-__forceinline void*
-__cdecl operator new[](size_t size)
-{
-    return Memory::Alloc(Memory::ObjectArrayHeap, size);
-}
-
-//------------------------------------------------------------------------------
-/**
-    Replacement global delete operator.
-*/
-__forceinline void
-__cdecl operator delete(void* p)
-{
-    Memory::Free(Memory::ObjectHeap, p);
-}
-
-//------------------------------------------------------------------------------
-/**
-    Replacement global delete[] operator.
-*/
-__forceinline void
-__cdecl operator delete[](void* p)
-{
-    Memory::Free(Memory::ObjectArrayHeap, p);
-}
+// The global new and delete operators are replaced in posixmemory.cc. They
+// must not be inline, memory allocated by the C++ runtime itself has to go
+// through the same allocator as the memory it might free.
 
 #define n_new(type) new type
 #define n_new_inplace(type, mem) new (mem) type 
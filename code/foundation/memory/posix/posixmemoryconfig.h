@@ -12,6 +12,12 @@
 */
 #include "core/config.h"
 
+// allocator backend of Memory::Alloc(), (1) uses the thread caching allocator
+// in memory/posix/posixthreadcache.h, (0) calls the C runtime directly
+#ifndef NEBULA_MEMORY_THREADCACHE
+#define NEBULA_MEMORY_THREADCACHE (1)
+#endif
+
 namespace Memory
 {
 
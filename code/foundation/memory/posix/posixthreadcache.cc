@@ -0,0 +1,605 @@
+//------------------------------------------------------------------------------
+//  posixthreadcache.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "core/types.h"
+#include "memory/posix/posixthreadcache.h"
+#include <atomic>
+#include <new>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if NEBULA_MEMORY_THREADCACHE
+namespace Memory
+{
+
+// Memory::Alloc() may be called by static constructors of other modules,
+// so everything in here must be constant initialized.
+
+static const uint32_t ThreadCacheLiveState = 0x4e454241;    // block is allocated
+static const uint32_t ThreadCacheFreedState = 0x4e454246;   // block is on a free list, only used to catch double frees
+static const uint16_t ThreadCacheLargeClass = 0xffff;       // block allocated by the C runtime
+static const size_t ThreadCacheRegionSize = (size_t)32 << 30;
+static const size_t ThreadCacheHeaderSize = 16;
+static const size_t ThreadCacheMaxClassSize = 32768;
+static const uint ThreadCacheNumClasses = 40;
+static const size_t ThreadCacheSlabSize = 65536;
+static const uint ThreadCacheNumCachedHeaps = 4;
+static const uint ThreadCacheMaxBatch = 32;
+
+/// precedes every block, keeps the payload 16 byte aligned
+struct ThreadCacheHeader
+{
+    uint32_t state;
+    uint16_t heapType;
+    uint16_t sizeClass;
+    uint64_t size;
+};
+static_assert(sizeof(ThreadCacheHeader) == ThreadCacheHeaderSize, "ThreadCacheHeader must be 16 bytes");
+
+/// a block on a free list, the link is stored in the payload so the header stays intact
+struct ThreadCacheBlock
+{
+    ThreadCacheHeader header;
+    ThreadCacheBlock* next;
+};
+
+/// the free list of a thread for one heap and size class
+struct ThreadCacheBin
+{
+    ThreadCacheBlock* head;
+    uint count;
+};
+
+/// statistics of a thread for one heap, only written by the owning thread
+struct ThreadCacheCounters
+{
+    std::atomic<uint64_t> allocCount;
+    std::atomic<uint64_t> freeCount;
+    std::atomic<uint64_t> allocSize;
+    std::atomic<uint64_t> freeSize;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Caches are never freed. When a thread exits its cache is flushed and
+    handed to the next new thread, which keeps the statistics complete and
+    the number of caches bounded by the peak number of threads.
+*/
+struct ThreadCache
+{
+    ThreadCacheBin bins[ThreadCacheNumCachedHeaps][ThreadCacheNumClasses];
+    ThreadCacheCounters counters[NumHeapTypes];
+    ThreadCache* next;
+    std::atomic<bool> inUse;
+};
+
+/// the blocks shared between all threads for one heap and size class
+struct alignas(64) ThreadCacheCentral
+{
+    std::atomic<int> lock;
+    ThreadCacheBlock* head;
+    size_t count;
+};
+
+static ThreadCacheCentral threadCacheCentral[ThreadCacheNumCachedHeaps][ThreadCacheNumClasses];
+static std::atomic<ThreadCache*> threadCacheList{ nullptr };
+static std::atomic<size_t> threadCacheSlabBytes{ 0 };
+/// start of the reserved slab range, null until the first slab is needed
+static std::atomic<char*> threadCacheRegion{ nullptr };
+static pthread_once_t threadCacheRegionOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t threadCacheKey;
+static pthread_once_t threadCacheKeyOnce = PTHREAD_ONCE_INIT;
+static ThreadLocal ThreadCache* threadCache = nullptr;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline void
+ThreadCacheCounterAdd(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Index of a heap into the bins, -1 if the heap is not cached.
+*/
+static inline int
+ThreadCacheHeapIndex(uint heapType)
+{
+    switch (heapType)
+    {
+        case ObjectHeap:        return 0;
+        case ObjectArrayHeap:   return 1;
+        case ScratchHeap:       return 2;
+        case StringDataHeap:    return 3;
+        default:                return -1;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Size classes are 16 byte steps up to 128 bytes, and 4 steps per power
+    of two above, so no more than 25% of a block is wasted. Block sizes
+    include the header. Class 0 is never used, a free block needs room
+    for the link.
+*/
+static inline uint
+ThreadCacheSizeClass(size_t blockSize)
+{
+    if (blockSize <= 128)
+        return (uint)((blockSize + 15) >> 4) - 1;
+    const uint log = 63 - __builtin_clzll(blockSize - 1);
+    return 8 + (log - 7) * 4 + (uint)(((blockSize - 1) >> (log - 2)) & 3);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline size_t
+ThreadCacheClassSize(uint sizeClass)
+{
+    if (sizeClass < 8)
+        return (size_t)(sizeClass + 1) << 4;
+    const uint log = 7 + (sizeClass - 8) / 4;
+    return (size_t)(5 + (sizeClass - 8) % 4) << (log - 2);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Number of blocks moved between a thread and the central list at once.
+*/
+static inline uint
+ThreadCacheBatchSize(uint sizeClass)
+{
+    const size_t count = ThreadCacheSlabSize / ThreadCacheClassSize(sizeClass) / 2;
+    return count < 2 ? 2 : (count > ThreadCacheMaxBatch ? ThreadCacheMaxBatch : (uint)count);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline void
+ThreadCacheLock(std::atomic<int>& lock)
+{
+    uint spins = 0;
+    while (lock.exchange(1, std::memory_order_acquire) != 0)
+    {
+        while (lock.load(std::memory_order_relaxed) != 0)
+        {
+            if (++spins > 64)
+                sched_yield();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline void
+ThreadCacheUnlock(std::atomic<int>& lock)
+{
+    lock.store(0, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Push a linked list of blocks onto a central list.
+*/
+static void
+ThreadCachePushCentral(int heapIndex, uint sizeClass, ThreadCacheBlock* first, ThreadCacheBlock* last, uint count)
+{
+    ThreadCacheCentral& central = threadCacheCentral[heapIndex][sizeClass];
+    ThreadCacheLock(central.lock);
+    last->next = central.head;
+    central.head = first;
+    central.count += count;
+    ThreadCacheUnlock(central.lock);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Reserves the address range of all slabs without committing any memory.
+*/
+static void
+ThreadCacheReserveRegion()
+{
+    void* region = mmap(nullptr, ThreadCacheRegionSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region != MAP_FAILED)
+        threadCacheRegion.store((char*)region, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Commits the next slab of the reserved range, returns null once the
+    range is used up.
+*/
+static char*
+ThreadCacheCommitSlab()
+{
+    pthread_once(&threadCacheRegionOnce, ThreadCacheReserveRegion);
+    char* region = threadCacheRegion.load(std::memory_order_acquire);
+    if (region == nullptr)
+        return nullptr;
+
+    size_t offset = threadCacheSlabBytes.load(std::memory_order_relaxed);
+    do
+    {
+        if (offset + ThreadCacheSlabSize > ThreadCacheRegionSize)
+            return nullptr;
+    }
+    while (!threadCacheSlabBytes.compare_exchange_weak(offset, offset + ThreadCacheSlabSize, std::memory_order_relaxed));
+
+    char* slab = region + offset;
+    if (0 != mprotect(slab, ThreadCacheSlabSize, PROT_READ | PROT_WRITE))
+        return nullptr;
+    return slab;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Refill an empty bin with a batch from the central list, or carve a new
+    slab if the central list is empty. Returns false if no slab is left.
+*/
+static bool
+ThreadCacheRefill(ThreadCacheBin& bin, int heapIndex, uint sizeClass)
+{
+    const uint batch = ThreadCacheBatchSize(sizeClass);
+    ThreadCacheCentral& central = threadCacheCentral[heapIndex][sizeClass];
+    ThreadCacheLock(central.lock);
+    if (central.head != nullptr)
+    {
+        ThreadCacheBlock* first = central.head;
+        ThreadCacheBlock* last = first;
+        uint count = 1;
+        while (count < batch && last->next != nullptr)
+        {
+            last = last->next;
+            count++;
+        }
+        central.head = last->next;
+        central.count -= count;
+        ThreadCacheUnlock(central.lock);
+
+        last->next = bin.head;
+        bin.head = first;
+        bin.count += count;
+        return true;
+    }
+    ThreadCacheUnlock(central.lock);
+
+    char* slab = ThreadCacheCommitSlab();
+    if (slab == nullptr)
+        return false;
+
+    // link all blocks of the slab, keep a batch and share the rest
+    const size_t blockSize = ThreadCacheClassSize(sizeClass);
+    const uint numBlocks = (uint)(ThreadCacheSlabSize / blockSize);
+    uint i;
+    for (i = 0; i < numBlocks; i++)
+    {
+        ThreadCacheBlock* block = (ThreadCacheBlock*)(slab + i * blockSize);
+        block->header.state = ThreadCacheFreedState;
+        block->next = (i + 1 < numBlocks) ? (ThreadCacheBlock*)(slab + (i + 1) * blockSize) : nullptr;
+    }
+    const uint keep = numBlocks < batch ? numBlocks : batch;
+    ThreadCacheBlock* lastKept = (ThreadCacheBlock*)(slab + (keep - 1) * blockSize);
+    if (keep < numBlocks)
+    {
+        ThreadCacheBlock* firstShared = lastKept->next;
+        ThreadCacheBlock* lastShared = (ThreadCacheBlock*)(slab + (numBlocks - 1) * blockSize);
+        ThreadCachePushCentral(heapIndex, sizeClass, firstShared, lastShared, numBlocks - keep);
+    }
+    lastKept->next = bin.head;
+    bin.head = (ThreadCacheBlock*)slab;
+    bin.count += keep;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Return a batch of blocks from the front of a bin to the central list.
+*/
+static void
+ThreadCacheReleaseBatch(ThreadCacheBin& bin, int heapIndex, uint sizeClass, uint batch)
+{
+    ThreadCacheBlock* first = bin.head;
+    ThreadCacheBlock* last = first;
+    uint i;
+    for (i = 1; i < batch; i++)
+        last = last->next;
+    bin.head = last->next;
+    bin.count -= batch;
+    ThreadCachePushCentral(heapIndex, sizeClass, first, last, batch);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Called when a thread exits, hands all cached blocks back to the
+    central lists and makes the cache available to new threads.
+*/
+static void
+ThreadCacheRelease(void* ptr)
+{
+    ThreadCache* cache = (ThreadCache*)ptr;
+    uint heapIndex;
+    for (heapIndex = 0; heapIndex < ThreadCacheNumCachedHeaps; heapIndex++)
+    {
+        uint sizeClass;
+        for (sizeClass = 0; sizeClass < ThreadCacheNumClasses; sizeClass++)
+        {
+            ThreadCacheBin& bin = cache->bins[heapIndex][sizeClass];
+            if (bin.count > 0)
+                ThreadCacheReleaseBatch(bin, heapIndex, sizeClass, bin.count);
+        }
+    }
+    if (threadCache == cache)
+        threadCache = nullptr;
+    cache->inUse.store(false, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+ThreadCacheCreateKey()
+{
+    int res = pthread_key_create(&threadCacheKey, ThreadCacheRelease);
+    n_assert(0 == res);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Set up the cache of the calling thread, a thread which allocates while
+    its thread locals are being destroyed gets a new cache, which is
+    released again by the next round of destructors.
+*/
+static ThreadCache*
+ThreadCacheAcquire()
+{
+    pthread_once(&threadCacheKeyOnce, ThreadCacheCreateKey);
+
+    ThreadCache* cache;
+    for (cache = threadCacheList.load(std::memory_order_acquire); cache != nullptr; cache = cache->next)
+    {
+        bool expected = false;
+        if (!cache->inUse.load(std::memory_order_relaxed) &&
+            cache->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            break;
+    }
+    if (cache == nullptr)
+    {
+        void* mem = calloc(1, sizeof(ThreadCache));
+        n_assert(0 != mem);
+        cache = new (mem) ThreadCache();
+        cache->inUse.store(true, std::memory_order_relaxed);
+        ThreadCache* head = threadCacheList.load(std::memory_order_relaxed);
+        do
+        {
+            cache->next = head;
+        }
+        while (!threadCacheList.compare_exchange_weak(head, cache, std::memory_order_release, std::memory_order_relaxed));
+    }
+    pthread_setspecific(threadCacheKey, cache);
+    threadCache = cache;
+    return cache;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline ThreadCache*
+ThreadCacheGet()
+{
+    ThreadCache* cache = threadCache;
+    if (cache == nullptr)
+        cache = ThreadCacheAcquire();
+    return cache;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Slab blocks are recognized by their address, every other block must be
+    a large block, which is flagged by the size class in its header.
+*/
+static inline ThreadCacheHeader*
+ThreadCacheGetHeader(const void* ptr)
+{
+    ThreadCacheHeader* header = (ThreadCacheHeader*)ptr - 1;
+    n_assert2(ThreadCacheIsSlabBlock(ptr) || header->sizeClass == ThreadCacheLargeClass, "Memory: block was not allocated by Memory::Alloc()");
+    return header;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void*
+ThreadCacheAlloc(HeapType heapType, size_t size)
+{
+    ThreadCache* cache = ThreadCacheGet();
+    const int heapIndex = ThreadCacheHeapIndex(heapType);
+    ThreadCacheHeader* header = nullptr;
+    uint sizeClass;
+    if (heapIndex >= 0 && size <= ThreadCacheMaxClassSize - ThreadCacheHeaderSize)
+    {
+        sizeClass = ThreadCacheSizeClass(size < 16 ? 32 : size + ThreadCacheHeaderSize);
+        ThreadCacheBin& bin = cache->bins[heapIndex][sizeClass];
+        if (bin.head != nullptr || ThreadCacheRefill(bin, heapIndex, sizeClass))
+        {
+            ThreadCacheBlock* block = bin.head;
+            bin.head = block->next;
+            bin.count--;
+            header = &block->header;
+        }
+    }
+    if (header == nullptr)
+    {
+        header = (ThreadCacheHeader*)memalign(16, size + ThreadCacheHeaderSize);
+        if (header == nullptr)
+            return nullptr;
+        sizeClass = ThreadCacheLargeClass;
+    }
+    header->state = ThreadCacheLiveState;
+    header->heapType = (uint16_t)heapType;
+    header->sizeClass = (uint16_t)sizeClass;
+    header->size = size;
+
+    ThreadCacheCounters& counters = cache->counters[heapType];
+    ThreadCacheCounterAdd(counters.allocCount, 1);
+    ThreadCacheCounterAdd(counters.allocSize, size);
+    return header + 1;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The block keeps the heap type it was allocated from, heapType is only
+    used if ptr is null.
+*/
+void*
+ThreadCacheRealloc(HeapType heapType, void* ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return ThreadCacheAlloc(heapType, size);
+
+    ThreadCacheHeader* header = ThreadCacheGetHeader(ptr);
+    ThreadCache* cache = ThreadCacheGet();
+    ThreadCacheCounters& counters = cache->counters[header->heapType];
+    const size_t oldSize = header->size;
+    if (header->sizeClass == ThreadCacheLargeClass)
+    {
+        // the C runtime might be able to grow the block in place
+        ThreadCacheHeader* newHeader = (ThreadCacheHeader*)realloc(header, size + ThreadCacheHeaderSize);
+        if (newHeader == nullptr)
+            return nullptr;
+        newHeader->size = size;
+        ThreadCacheCounterAdd(counters.allocSize, size);
+        ThreadCacheCounterAdd(counters.freeSize, oldSize);
+        return newHeader + 1;
+    }
+    if (size + ThreadCacheHeaderSize <= ThreadCacheClassSize(header->sizeClass))
+    {
+        header->size = size;
+        ThreadCacheCounterAdd(counters.allocSize, size);
+        ThreadCacheCounterAdd(counters.freeSize, oldSize);
+        return ptr;
+    }
+
+    void* newPtr = ThreadCacheAlloc((HeapType)header->heapType, size);
+    if (newPtr != nullptr)
+    {
+        memcpy(newPtr, ptr, oldSize < size ? oldSize : size);
+        ThreadCacheFree(ptr);
+    }
+    return newPtr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ThreadCacheFree(void* ptr)
+{
+    ThreadCacheHeader* header = ThreadCacheGetHeader(ptr);
+    n_assert2(header->state != ThreadCacheFreedState, "Memory::Free(): block freed twice");
+
+    ThreadCache* cache = ThreadCacheGet();
+    ThreadCacheCounters& counters = cache->counters[header->heapType];
+    ThreadCacheCounterAdd(counters.freeCount, 1);
+    ThreadCacheCounterAdd(counters.freeSize, header->size);
+    header->state = ThreadCacheFreedState;
+    if (header->sizeClass == ThreadCacheLargeClass)
+    {
+        free(header);
+        return;
+    }
+
+    const int heapIndex = ThreadCacheHeapIndex(header->heapType);
+    const uint sizeClass = header->sizeClass;
+    ThreadCacheBin& bin = cache->bins[heapIndex][sizeClass];
+    ThreadCacheBlock* block = (ThreadCacheBlock*)header;
+    block->next = bin.head;
+    bin.head = block;
+    bin.count++;
+
+    // don't let a thread which only frees hoard blocks
+    const uint batch = ThreadCacheBatchSize(sizeClass);
+    if (bin.count > 2 * batch)
+        ThreadCacheReleaseBatch(bin, heapIndex, sizeClass, batch);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+ThreadCacheGetSize(const void* ptr)
+{
+    return ThreadCacheGetHeader(ptr)->size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ThreadCacheIsSlabBlock(const void* ptr)
+{
+    const char* region = threadCacheRegion.load(std::memory_order_acquire);
+    return region != nullptr && (uintptr_t)ptr - (uintptr_t)region < ThreadCacheRegionSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The counters of other threads are read while they are being written,
+    so the totals are only consistent for a quiet allocator.
+*/
+void
+ThreadCacheGetStats(ThreadCacheHeapStats (&outStats)[NumHeapTypes])
+{
+    memset(outStats, 0, sizeof(outStats));
+    ThreadCache* cache;
+    for (cache = threadCacheList.load(std::memory_order_acquire); cache != nullptr; cache = cache->next)
+    {
+        uint i;
+        for (i = 0; i < NumHeapTypes; i++)
+        {
+            const ThreadCacheCounters& counters = cache->counters[i];
+            outStats[i].allocCount += counters.allocCount.load(std::memory_order_relaxed);
+            outStats[i].freeCount += counters.freeCount.load(std::memory_order_relaxed);
+            outStats[i].allocSize += counters.allocSize.load(std::memory_order_relaxed);
+            outStats[i].freeSize += counters.freeSize.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+ThreadCacheGetNumThreads()
+{
+    size_t count = 0;
+    ThreadCache* cache;
+    for (cache = threadCacheList.load(std::memory_order_acquire); cache != nullptr; cache = cache->next)
+    {
+        if (cache->inUse.load(std::memory_order_relaxed))
+            count++;
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+ThreadCacheGetSlabSize()
+{
+    return threadCacheSlabBytes.load(std::memory_order_relaxed);
+}
+
+} // namespace Memory
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file memory/posix/posixthreadcache.h
+
+    Thread caching allocator backend of Memory::Alloc() on posix platforms.
+
+    Small blocks of the heaps which see the most traffic (ObjectHeap,
+    ObjectArrayHeap, ScratchHeap and StringDataHeap) are served from size
+    classes, which are carved from 64 KB slabs. Every thread keeps a free
+    list per heap and size class, so the common case of Alloc() and Free()
+    neither locks nor executes an atomic read-modify-write. Threads refill
+    their lists from, and return surplus blocks to, a central list per heap
+    and size class in batches. Large blocks and the other heaps are passed
+    on to the C runtime.
+
+    Slabs are committed from a single address range which is reserved up
+    front, so whether a pointer is a small block is decided by a range
+    check. Every other pointer must be a large block, which is flagged as
+    such in its header. Every block is preceded by a 16 byte header which
+    holds its heap type, size class and requested size, so blocks may be
+    freed and reallocated by any thread. Every pointer passed to Free() and
+    Realloc() must come from ThreadCacheAlloc(), pointers of the C runtime
+    are not accepted. Once the range is used up, small blocks are allocated
+    as large blocks.
+
+    The statistics are kept per thread and are only written by the owning
+    thread, ThreadCacheGetStats() sums them up when they are requested.
+    Slab memory is never returned to the system.
+
+    Select the backend with NEBULA_MEMORY_THREADCACHE in posixmemoryconfig.h.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/config.h"
+#include "memory/posix/posixmemoryconfig.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if NEBULA_MEMORY_THREADCACHE
+//------------------------------------------------------------------------------
+namespace Memory
+{
+
+/// allocator statistics of a heap, summed up over all threads
+struct ThreadCacheHeapStats
+{
+    uint64_t allocCount;
+    uint64_t freeCount;
+    uint64_t allocSize;         // requested bytes
+    uint64_t freeSize;
+};
+
+/// allocate a 16 byte aligned block
+void* ThreadCacheAlloc(HeapType heapType, size_t size);
+/// resize a block, keeps the block in place if it fits into its size class
+void* ThreadCacheRealloc(HeapType heapType, void* ptr, size_t size);
+/// free a block allocated by ThreadCacheAlloc()
+void ThreadCacheFree(void* ptr);
+/// get the requested size of a block allocated by ThreadCacheAlloc()
+size_t ThreadCacheGetSize(const void* ptr);
+/// return true if ptr is a small block carved from a slab
+bool ThreadCacheIsSlabBlock(const void* ptr);
+
+/// get the statistics of all heaps
+void ThreadCacheGetStats(ThreadCacheHeapStats (&outStats)[NumHeapTypes]);
+/// get the number of threads which own a cache
+size_t ThreadCacheGetNumThreads();
+/// get the number of bytes committed for slabs
+size_t ThreadCacheGetSlabSize();
+
+} // namespace Memory
+#endif
+//------------------------------------------------------------------------------
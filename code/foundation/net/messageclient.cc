@@ -17,9 +17,11 @@ using namespace Util;
 //------------------------------------------------------------------------------
 /**
 */
-MessageClient::MessageClient()
+MessageClient::MessageClient() :
+    hasRecvMessage(false)
 {
-    // empty
+    this->recvMessage.data = nullptr;
+    this->recvMessage.size = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -59,6 +61,8 @@ MessageClient::Disconnect()
     TcpClient::Disconnect();
     this->sendMessageStream = nullptr;
     this->recvMessageStream = nullptr;
+    this->hasRecvMessage = false;
+    this->codec.Reset();
 }
 
 //------------------------------------------------------------------------------
@@ -73,11 +77,11 @@ MessageClient::Send()
         // nothing to send
         return Socket::Success;
     }
-    Socket::Result res = Socket::Error;
-    this->sendMessageStream->SetAccessMode(Stream::ReadAccess);
-    this->codec.EncodeToMessage(this->sendMessageStream,TcpClient::GetSendStream());
+    uchar header[TcpMessageCodec::HeaderSize];
+    TcpMessageCodec::EncodeHeader(this->sendMessageStream->GetSize(), header);
+    bool res = this->SendWithHeader(header, sizeof(header), this->sendMessageStream);
     this->sendMessageStream->SetSize(0);
-    return TcpClient::Send();
+    return res;
 }
 
 //------------------------------------------------------------------------------
@@ -91,51 +95,64 @@ MessageClient::GetSendStream()
 
 //------------------------------------------------------------------------------
 /**
+    Returns one complete message per call, or none at all. New data is
+    only received once all messages of the data received before have been
+    handed out, so the messages can be decoded in place. If a message
+    header is invalid, the client disconnects.
 */
 bool
 MessageClient::Recv()
 {
-    // first check if new data is available from the socket
-    if (TcpClient::Recv())
+    this->recvMessageStream = nullptr;
+    this->hasRecvMessage = this->codec.DequeueMessage(this->recvMessage);
+    if (!this->hasRecvMessage && TcpClient::Recv())
     {
-        // decode incoming data into separate message, and queue the
-        // message for later use
         this->codec.DecodeStream(this->recvStream);
-        if (this->codec.HasMessages())
-        {
-            Array<Ptr<Stream> > msgArray = this->codec.DequeueMessages();
-            IndexT i;
-            for (i = 0; i < msgArray.Size(); i++)
-            {
-                this->msgQueue.Enqueue(msgArray[i]);
-            }
-        }
+        this->hasRecvMessage = this->codec.DequeueMessage(this->recvMessage);
     }
-
-    // set the oldest received message from the message queue
-    // as receive stream (we either return 1 complete message,
-    // or none at all per call to Recv()
-    if (!this->msgQueue.IsEmpty())
-    {
-        this->recvMessageStream = this->msgQueue.Dequeue();
-        return true;
-    }
-    else
+    if (this->codec.HasError())
     {
-        // no messages to return
+        n_printf("MessageClient: invalid message header from server, disconnecting\n");
+        this->Disconnect();
         return false;
     }
+    return this->hasRecvMessage;
 }
 
 //------------------------------------------------------------------------------
 /**
+    The message is copied into the stream the first time it is requested.
 */
 const Ptr<IO::Stream>&
 MessageClient::GetRecvStream()
 {
+    if (this->hasRecvMessage && !this->recvMessageStream.isvalid())
+    {
+        this->recvMessageStream = MemoryStream::Create();
+        this->recvMessageStream->SetAccessMode(Stream::WriteAccess);
+        if (this->recvMessageStream->Open())
+        {
+            if (this->recvMessage.size > 0)
+            {
+                this->recvMessageStream->Write(this->recvMessage.data, this->recvMessage.size);
+            }
+            this->recvMessageStream->Close();
+        }
+        this->recvMessageStream->SetAccessMode(Stream::ReadAccess);
+    }
     return this->recvMessageStream;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+const TcpMessageCodec::MessageView&
+MessageClient::GetRecvMessage() const
+{
+    n_assert(this->hasRecvMessage);
+    return this->recvMessage;
+}
+
 } // namespace Net
 
 #endif // #if not __WII__
\ No newline at end of file
@@ -6,13 +6,16 @@
     Wrapper class for the Net::TcpClient that sends data in special message
     container.
 
+    Like the MessageClientConnection, the message header is sent together
+    with the message and received messages are decoded in place, see
+    GetRecvMessage().
+
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "net/tcpclient.h"
 #include "net/tcpmessagecodec.h"
 #include "io/memorystream.h"
-#include "util/queue.h"
 
 //------------------------------------------------------------------------------
 namespace Net
@@ -39,12 +42,15 @@ public:
     virtual bool Recv();
     /// access to recv stream
     virtual const Ptr<IO::Stream>& GetRecvStream();
+    /// access to the received message without copying it, valid until the next Recv()
+    const TcpMessageCodec::MessageView& GetRecvMessage() const;
 
 private:
     TcpMessageCodec codec;
     Ptr<IO::Stream> sendMessageStream;
     Ptr<IO::Stream> recvMessageStream;
-    Util::Queue<Ptr<IO::Stream> > msgQueue;
+    TcpMessageCodec::MessageView recvMessage;
+    bool hasRecvMessage;
 };
 
 //------------------------------------------------------------------------------
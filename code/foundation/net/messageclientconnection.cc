@@ -21,9 +21,11 @@ __ImplementClass(Net::MessageClientConnection,'MGCC',Net::TcpClientConnection);
 /**
     Constructor	
 */
-MessageClientConnection::MessageClientConnection()
+MessageClientConnection::MessageClientConnection() :
+    hasRecvMessage(false)
 {
-    // empty
+    this->recvMessage.data = nullptr;
+    this->recvMessage.size = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -44,7 +46,6 @@ MessageClientConnection::Connect(const Ptr<Socket>& s)
 {
     n_assert(!this->sendMessageStream.isvalid());
     n_assert(!this->recvMessageStream.isvalid());
-    n_assert(this->msgQueue.IsEmpty());
     bool res = TcpClientConnection::Connect(s);
     if (res)
     {
@@ -60,10 +61,11 @@ MessageClientConnection::Connect(const Ptr<Socket>& s)
 void
 MessageClientConnection::Shutdown()
 {
-    n_assert(this->msgQueue.IsEmpty());
     TcpClientConnection::Shutdown();
     this->sendMessageStream = nullptr;
     this->recvMessageStream = nullptr;
+    this->hasRecvMessage = false;
+    this->codec.Reset();
 }
 
 //------------------------------------------------------------------------------
@@ -74,12 +76,15 @@ MessageClientConnection::Shutdown()
 Socket::Result
 MessageClientConnection::Send()
 {
-    return this->Send(this->sendMessageStream);
+    Socket::Result res = this->Send(this->sendMessageStream);
+    this->sendMessageStream->SetSize(0);
+    return res;
 }
 
 //------------------------------------------------------------------------------
 /**
-	Writes given stream into a message container and sends this container.
+	Sends the given stream as a message. The header is sent together with
+    the stream, without copying the stream behind the header.
 */
 Socket::Result
 MessageClientConnection::Send(const Ptr<IO::Stream> &stream)
@@ -91,13 +96,9 @@ MessageClientConnection::Send(const Ptr<IO::Stream> &stream)
         return Socket::Success;
     }
 
-    Socket::Result res = Socket::Error;
-    stream->SetAccessMode(Stream::ReadAccess);
-    this->codec.EncodeToMessage(stream, this->sendStream);
-
-	n_printf("MessageClientConnection: sending %d bytes\n", this->sendStream->GetSize());
-
-    return TcpClientConnection::Send(sendStream);
+    uchar header[TcpMessageCodec::HeaderSize];
+    TcpMessageCodec::EncodeHeader(stream->GetSize(), header);
+    return this->SendWithHeader(header, sizeof(header), stream);
 }
 
 //------------------------------------------------------------------------------
@@ -114,40 +115,35 @@ MessageClientConnection::GetSendStream()
 /**
 	Receive data from the clients, but returns only Success, if a
     complete message was available. This message will either return one
-    complete message, or none at all.
+    complete message, or none at all. New data is only received once all
+    messages of the data received before have been handed out, so the
+    messages can be decoded in place. Returns Error if a message header
+    was invalid, the server then drops the connection.
 */
 Socket::Result
 MessageClientConnection::Recv()
 {
-    // first check if new data is available from the socket...
-    Socket::Result returnValue = TcpClientConnection::Recv();
-    if (Socket::Success == returnValue)
+    this->recvMessageStream = nullptr;
+    this->hasRecvMessage = this->codec.DequeueMessage(this->recvMessage);
+    Socket::Result returnValue = Socket::Success;
+    if (!this->hasRecvMessage)
     {
-        // decode incoming data into separate messages, and queue 
-        // the messages for later use
-        this->codec.DecodeStream(this->recvStream);
-        if (this->codec.HasMessages())
+        returnValue = TcpClientConnection::Recv();
+        if (Socket::Success == returnValue)
         {
-            Array<Ptr<Stream> > msgArray = this->codec.DequeueMessages();
-            IndexT i;
-            for (i = 0; i < msgArray.Size(); i++)
-            {
-                this->msgQueue.Enqueue(msgArray[i]);
-            }
-        }
-        else
-        {
-            // Connection blocks if received data, but no complete message
-            returnValue = Socket::WouldBlock;
+            this->codec.DecodeStream(this->recvStream);
+            this->hasRecvMessage = this->codec.DequeueMessage(this->recvMessage);
         }
     }
 
-    // now write the oldest message from the message queue
-    // to the recv stream, so that exactly one 
-    if (!this->msgQueue.IsEmpty())
+    if (this->codec.HasError())
+    {
+        // the client sent a header which can't be trusted, drop the connection
+        n_printf("MessageClientConnection: invalid message header from '%s', dropping connection\n", this->GetClientAddress().GetHostAddr().AsCharPtr());
+        return Socket::Error;
+    }
+    if (this->hasRecvMessage)
     {
-        this->recvMessageStream = this->msgQueue.Dequeue();
-        
         // as long as messages are available, and no error occured,
         // set the result to Success
         if (Socket::Error != returnValue)
@@ -155,28 +151,49 @@ MessageClientConnection::Recv()
             returnValue = Socket::Success;
         }
     }
-    else
+    else if (Socket::Success == returnValue)
     {
-        // no messages available
-        this->recvMessageStream = nullptr;
-        if (Socket::Error != returnValue)
-        {
-            returnValue = Socket::WouldBlock;
-        }
+        // Connection blocks if received data, but no complete message
+        returnValue = Socket::WouldBlock;
     }
     return returnValue;
 }
 
 //------------------------------------------------------------------------------
 /**
-    Returns the stream with the received data	
+    Returns the stream with the received data. The message is copied into
+    the stream the first time it is requested.
 */
 const Ptr<IO::Stream>&
 MessageClientConnection::GetRecvStream()
 {
+    if (this->hasRecvMessage && !this->recvMessageStream.isvalid())
+    {
+        this->recvMessageStream = MemoryStream::Create();
+        this->recvMessageStream->SetAccessMode(Stream::WriteAccess);
+        if (this->recvMessageStream->Open())
+        {
+            if (this->recvMessage.size > 0)
+            {
+                this->recvMessageStream->Write(this->recvMessage.data, this->recvMessage.size);
+            }
+            this->recvMessageStream->Close();
+        }
+        this->recvMessageStream->SetAccessMode(Stream::ReadAccess);
+    }
     return this->recvMessageStream;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+const TcpMessageCodec::MessageView&
+MessageClientConnection::GetRecvMessage() const
+{
+    n_assert(this->hasRecvMessage);
+    return this->recvMessage;
+}
+
 } // namespace Net
 
 #endif // #if not __WII__
\ No newline at end of file
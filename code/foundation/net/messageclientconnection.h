@@ -13,12 +13,17 @@
     The MessageClientConnection will concatenate incoming data chunks to full messages and
     Recv() will only return finished messages.
 
+    The message header and the message are sent with one gathering send,
+    the message isn't copied behind the header first. Received messages
+    are decoded in place in the received data, GetRecvMessage() gives
+    access to them without a copy. GetRecvStream() copies the message into
+    a stream on demand.
+
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "net/tcpclientconnection.h"
 #include "net/tcpmessagecodec.h"
-#include "util/queue.h"
 
 //------------------------------------------------------------------------------
 namespace Net
@@ -47,11 +52,14 @@ public:
     virtual Socket::Result Recv();
     /// access to recv stream
     virtual const Ptr<IO::Stream>& GetRecvStream();    
+    /// access to the received message without copying it, valid until the next Recv()
+    const TcpMessageCodec::MessageView& GetRecvMessage() const;
 
 private:   
     Ptr<IO::Stream> sendMessageStream;
     Ptr<IO::Stream> recvMessageStream;
-    Util::Queue<Ptr<IO::Stream> > msgQueue;
+    TcpMessageCodec::MessageView recvMessage;
+    bool hasRecvMessage;
     TcpMessageCodec codec;
 };
 } // namespace Net
\ No newline at end of file
@@ -0,0 +1,430 @@
+//------------------------------------------------------------------------------
+//  linuxtcpiothread.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "net/posix/linuxtcpiothread.h"
+#include "net/tcp/stdtcpserver.h"
+#include "io/memorystream.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Net
+{
+__ImplementClass(Net::LinuxTcpIoThread, 'LTIO', Threading::Thread);
+
+using namespace Util;
+using namespace IO;
+
+static const int MaxEvents = 256;
+static const SizeT RecvChunkSize = 64 * 1024;
+
+//------------------------------------------------------------------------------
+/**
+    The wakeup event is created here, so Notify() and Stop() may be
+    called before the thread runs.
+*/
+LinuxTcpIoThread::LinuxTcpIoThread() :
+    connectionClassRtti(nullptr),
+    epollFd(-1),
+    wakeupFd(-1)
+{
+    this->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    n_assert(-1 != this->wakeupFd);
+    this->notifyQueue.SetSignalOnEnqueueEnabled(false);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+LinuxTcpIoThread::~LinuxTcpIoThread()
+{
+    n_assert(this->connections.IsEmpty());
+    close(this->wakeupFd);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::SetTcpServer(StdTcpServer* serv)
+{
+    n_assert(0 != serv);
+    this->tcpServer = serv;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::SetAddress(const IpAddress& a)
+{
+    this->ipAddress = a;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::SetClientConnectionClass(const Core::Rtti& type)
+{
+    this->connectionClassRtti = &type;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::Notify(const Ptr<StdTcpClientConnection>& connection)
+{
+    this->notifyQueue.Enqueue(connection);
+    this->EmitWakeupSignal();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::DequeueReady(Array<Ptr<StdTcpClientConnection> >& outConnections)
+{
+    if (!this->readyQueue.IsEmpty())
+    {
+        this->readyQueue.DequeueAll(outConnections);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::WaitReady(int timeoutMs)
+{
+    this->readyQueue.WaitTimeout(timeoutMs);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::EmitWakeupSignal()
+{
+    uint64_t one = 1;
+    ssize_t res = write(this->wakeupFd, &one, sizeof(one));
+    (void)res;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The I/O loop. The server socket and the wakeup event are registered
+    with a null pointer and a pointer to the wakeup event, all other
+    events carry the connection they belong to.
+*/
+void
+LinuxTcpIoThread::DoWork()
+{
+    n_printf("LinuxTcpIoThread started!\n");
+
+    Ptr<Socket> serverSocket = Socket::Create();
+    if (serverSocket->Open(Socket::TCP))
+    {
+        serverSocket->SetAddress(this->ipAddress);
+        serverSocket->SetReUseAddr(true);
+        serverSocket->SetBlocking(false);
+        if (serverSocket->Bind() && serverSocket->Listen())
+        {
+            this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+            n_assert(-1 != this->epollFd);
+
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = nullptr;
+            epoll_ctl(this->epollFd, EPOLL_CTL_ADD, serverSocket->GetSocket(), &event);
+            event.data.ptr = &this->wakeupFd;
+            epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->wakeupFd, &event);
+
+            n_printf("LinuxTcpIoThread listening...\n");
+            epoll_event events[MaxEvents];
+            while (!this->ThreadStopRequested())
+            {
+                int numEvents = epoll_wait(this->epollFd, events, MaxEvents, -1);
+                IndexT i;
+                for (i = 0; i < numEvents; i++)
+                {
+                    void* ptr = events[i].data.ptr;
+                    if (nullptr == ptr)
+                    {
+                        this->AcceptConnections(serverSocket);
+                    }
+                    else if (&this->wakeupFd == ptr)
+                    {
+                        uint64_t count;
+                        ssize_t res = read(this->wakeupFd, &count, sizeof(count));
+                        (void)res;
+                        this->HandleNotifications();
+                    }
+                    else
+                    {
+                        // a connection may have been closed by an earlier event of this batch
+                        StdTcpClientConnection* conn = (StdTcpClientConnection*)ptr;
+                        if ((InvalidIndex != conn->ioIndex) && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                        {
+                            this->ReadConnection(conn);
+                        }
+                        if ((InvalidIndex != conn->ioIndex) && (events[i].events & EPOLLOUT))
+                        {
+                            this->WriteConnection(conn);
+                        }
+                    }
+                }
+
+                // connections closed during this batch may be destroyed now
+                this->closed.Clear();
+            }
+
+            // close the remaining connections, the server shuts them down
+            while (!this->connections.IsEmpty())
+            {
+                this->CloseConnection(this->connections.Back());
+            }
+            this->closed.Clear();
+            close(this->epollFd);
+            this->epollFd = -1;
+        }
+        else
+        {
+            n_printf("LinuxTcpIoThread: Socket::Bind() failed!");
+        }
+        serverSocket->Close();
+    }
+    this->notifyQueue.Clear();
+    n_printf("LinuxTcpIoThread shutting down!\n");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::AcceptConnections(const Ptr<Socket>& serverSocket)
+{
+    Ptr<Socket> newSocket;
+    while (serverSocket->Accept(newSocket))
+    {
+        Ptr<StdTcpClientConnection> conn = (StdTcpClientConnection*)this->connectionClassRtti->Create();
+        if (conn->Connect(newSocket))
+        {
+            // Connect() made the socket blocking
+            newSocket->SetBlocking(false);
+            conn->ioThread = this;
+            conn->ioDriven = true;
+            conn->ioRecvStream = MemoryStream::Create();
+            conn->ioSendStream = MemoryStream::Create();
+            conn->ioSendingStream = MemoryStream::Create();
+            conn->ioConnected.store(true, std::memory_order_release);
+            conn->ioIndex = this->connections.Size();
+            this->connections.Append(conn);
+
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = conn.get();
+            epoll_ctl(this->epollFd, EPOLL_CTL_ADD, newSocket->GetSocket(), &event);
+
+            this->tcpServer->AddClientConnection(conn.downcast<TcpClientConnection>());
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Read until the socket would block, the data of every recv() is
+    appended to the receive buffer right away, so the main thread may
+    take it while the rest is being read.
+*/
+void
+LinuxTcpIoThread::ReadConnection(StdTcpClientConnection* conn)
+{
+    uchar buf[RecvChunkSize];
+    bool closed = false;
+    bool becameReady = false;
+    Socket::Result res = Socket::Success;
+    while (Socket::Success == res)
+    {
+        SizeT bytesReceived = 0;
+        res = conn->socket->Recv(buf, sizeof(buf), bytesReceived);
+        if ((Socket::Success == res) && (bytesReceived > 0))
+        {
+            conn->ioCritSect.Enter();
+            const Ptr<Stream>& stream = conn->ioRecvStream;
+            becameReady |= (0 == stream->GetSize());
+            stream->SetAccessMode(Stream::AppendAccess);
+            if (stream->Open())
+            {
+                stream->Write(buf, bytesReceived);
+                stream->Close();
+            }
+            conn->ioCritSect.Leave();
+        }
+        else if ((Socket::Closed == res) || (Socket::Error == res))
+        {
+            closed = true;
+        }
+    }
+    if (becameReady)
+    {
+        this->readyQueue.Enqueue(conn);
+    }
+    if (closed)
+    {
+        this->CloseConnection(conn);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The send buffer of a connection is swapped with the buffer the I/O
+    thread writes from, so the sending threads only wait for the swap.
+*/
+void
+LinuxTcpIoThread::WriteConnection(StdTcpClientConnection* conn)
+{
+    for (;;)
+    {
+        const Ptr<Stream>& sending = conn->ioSendingStream;
+        if (conn->ioSendOffset == sending->GetSize())
+        {
+            sending->SetSize(0);
+            conn->ioSendOffset = 0;
+            conn->ioCritSect.Enter();
+            conn->ioSendingStream = conn->ioSendStream;
+            conn->ioSendStream = sending;
+            conn->ioCritSect.Leave();
+            if (0 == conn->ioSendingStream->GetSize())
+            {
+                this->SetWriteInterest(conn, false);
+                if (conn->ioShutdownRequested.load(std::memory_order_acquire))
+                {
+                    this->CloseConnection(conn);
+                }
+                return;
+            }
+        }
+
+        const Ptr<Stream>& stream = conn->ioSendingStream;
+        stream->SetAccessMode(Stream::ReadAccess);
+        stream->Open();
+        const uchar* ptr = (const uchar*)stream->Map();
+        SizeT bytesSent = 0;
+        Socket::Result res = conn->socket->Send(ptr + conn->ioSendOffset, stream->GetSize() - conn->ioSendOffset, bytesSent);
+        stream->Unmap();
+        stream->Close();
+        if (Socket::Success == res)
+        {
+            conn->ioSendOffset += bytesSent;
+        }
+        else if (Socket::WouldBlock == res)
+        {
+            // wait until the socket takes more
+            this->SetWriteInterest(conn, true);
+            return;
+        }
+        else
+        {
+            this->CloseConnection(conn);
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Connections are only watched for writability while they have data
+    which didn't fit into the socket, otherwise epoll would report them
+    all the time.
+*/
+void
+LinuxTcpIoThread::SetWriteInterest(StdTcpClientConnection* conn, bool b)
+{
+    if (conn->ioWriteInterest != b)
+    {
+        epoll_event event;
+        event.events = b ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.ptr = conn;
+        epoll_ctl(this->epollFd, EPOLL_CTL_MOD, conn->socket->GetSocket(), &event);
+        conn->ioWriteInterest = b;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+LinuxTcpIoThread::HandleNotifications()
+{
+    this->notified.Clear();
+    this->notifyQueue.DequeueAll(this->notified);
+    IndexT i;
+    for (i = 0; i < this->notified.Size(); i++)
+    {
+        StdTcpClientConnection* conn = this->notified[i].get();
+        if (InvalidIndex == conn->ioIndex)
+        {
+            // already closed
+            continue;
+        }
+        if (conn->ioShutdownRequested.load(std::memory_order_acquire))
+        {
+            // data sent right before the shutdown still goes out, the
+            // connection is closed once it has been written
+            if (!conn->ioWriteInterest)
+            {
+                this->WriteConnection(conn);
+            }
+            if ((InvalidIndex != conn->ioIndex) && !conn->ioWriteInterest)
+            {
+                this->CloseConnection(conn);
+            }
+        }
+        else
+        {
+            conn->ioNotifyPending.store(false, std::memory_order_release);
+            if (!conn->ioWriteInterest)
+            {
+                this->WriteConnection(conn);
+            }
+        }
+    }
+    this->notified.Clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+    The connection is queued for the main thread, which sees that it is no
+    longer connected and drops it. Unless the application shut it down, in
+    which case the server already dropped it. Events of the same epoll
+    batch may still point to the connection, so it's kept alive until the
+    batch is done.
+*/
+void
+LinuxTcpIoThread::CloseConnection(StdTcpClientConnection* conn)
+{
+    n_assert(InvalidIndex != conn->ioIndex);
+    this->closed.Append(conn);
+    epoll_ctl(this->epollFd, EPOLL_CTL_DEL, conn->socket->GetSocket(), nullptr);
+    conn->socket->Close();
+    conn->ioConnected.store(false, std::memory_order_release);
+
+    IndexT index = conn->ioIndex;
+    this->connections.EraseIndexSwap(index);
+    if (index < this->connections.Size())
+    {
+        this->connections[index]->ioIndex = index;
+    }
+    conn->ioIndex = InvalidIndex;
+
+    if (!conn->ioShutdownRequested.load(std::memory_order_acquire))
+    {
+        this->readyQueue.Enqueue(conn);
+    }
+}
+
+} // namespace Net
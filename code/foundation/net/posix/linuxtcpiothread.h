@@ -0,0 +1,92 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Net::LinuxTcpIoThread
+
+    The I/O thread of a StdTcpServer on Linux. It owns the listening
+    socket and the sockets of all client connections, and waits for all
+    of them at once with epoll, so idle connections cost nothing.
+
+    Accepted sockets are switched to non-blocking mode. Received data is
+    appended to the receive buffer of its connection, and the connection
+    is queued for the main thread once its buffer turns non-empty or the
+    connection is closed. StdTcpServer::Recv() picks the queued
+    connections up, so only connections which actually received
+    something are looked at.
+
+    Data sent through a connection is appended to its send buffer by the
+    calling thread, which then queues the connection for the I/O thread
+    with Notify(). The I/O thread writes as much as the socket takes, and
+    waits for the socket to become writable again if it doesn't take all
+    of it. Connections which are shut down by the application are queued
+    the same way and closed by the I/O thread, after the data which was
+    sent before the shutdown has been written.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "threading/thread.h"
+#include "threading/safequeue.h"
+#include "net/socket/socket.h"
+#include "net/tcp/stdtcpclientconnection.h"
+
+//------------------------------------------------------------------------------
+namespace Net
+{
+class StdTcpServer;
+
+class LinuxTcpIoThread : public Threading::Thread
+{
+    __DeclareClass(LinuxTcpIoThread);
+public:
+    /// constructor
+    LinuxTcpIoThread();
+    /// destructor
+    virtual ~LinuxTcpIoThread();
+
+    /// set pointer to parent tcp server
+    void SetTcpServer(StdTcpServer* tcpServer);
+    /// set ip address
+    void SetAddress(const IpAddress& a);
+    /// set client connection class
+    void SetClientConnectionClass(const Core::Rtti& type);
+
+    /// queue a connection which has data to send or has been shut down, may be called from any thread
+    void Notify(const Ptr<StdTcpClientConnection>& connection);
+    /// get the connections which received data or have been closed since the last call
+    void DequeueReady(Util::Array<Ptr<StdTcpClientConnection> >& outConnections);
+    /// wait until a connection is ready, or the timeout expired
+    void WaitReady(int timeoutMs);
+
+private:
+    /// implements the actual I/O loop
+    virtual void DoWork();
+    /// send a wakeup signal
+    virtual void EmitWakeupSignal();
+
+    /// accept all pending connections
+    void AcceptConnections(const Ptr<Socket>& serverSocket);
+    /// read all available data of a connection
+    void ReadConnection(StdTcpClientConnection* connection);
+    /// write as much of the send buffer of a connection as the socket takes
+    void WriteConnection(StdTcpClientConnection* connection);
+    /// handle the connections queued with Notify()
+    void HandleNotifications();
+    /// watch or stop watching a connection for writability
+    void SetWriteInterest(StdTcpClientConnection* connection, bool b);
+    /// close a connection and let the main thread know
+    void CloseConnection(StdTcpClientConnection* connection);
+
+    Ptr<StdTcpServer> tcpServer;
+    IpAddress ipAddress;
+    const Core::Rtti* connectionClassRtti;
+    int epollFd;
+    int wakeupFd;
+    Util::Array<Ptr<StdTcpClientConnection> > connections;
+    Threading::SafeQueue<Ptr<StdTcpClientConnection> > notifyQueue;
+    Threading::SafeQueue<Ptr<StdTcpClientConnection> > readyQueue;
+    Util::Array<Ptr<StdTcpClientConnection> > notified;
+    Util::Array<Ptr<StdTcpClientConnection> > closed;
+};
+
+} // namespace Net
+//------------------------------------------------------------------------------
@@ -9,6 +9,8 @@
 #include <sys/errno.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <sys/uio.h>
+#include <poll.h>
 
 namespace Posix
 {
@@ -332,6 +334,11 @@ PosixSocket::Accept(Ptr<Net::Socket>& outSocket)
     if (INVALID_SOCKET == newSocket)
     {
         this->SetToLastSocketError();
+        if (!this->isBlocking && (ErrorWouldBlock == this->error))
+        {
+            // no pending connection on a non-blocking socket
+            return false;
+        }
         n_printf("PosixSocket::Accept(): accept() failed with '%s'!\n", this->GetErrorString().AsCharPtr());
         return false;
     }
@@ -395,20 +402,18 @@ PosixSocket::Connect()
 
 //------------------------------------------------------------------------------
 /**
-    This tests if the socket is actually connected by doing a select()
+    This tests if the socket is actually connected by doing a poll()
     on the socket to probe for writability. So the IsConnected() method
     basically checks whether data can be sent through the socket.
+    poll() is used instead of select(), which can't handle descriptors
+    above FD_SETSIZE.
 */
 bool
 PosixSocket::IsConnected()
 {
     n_assert(this->IsOpen());
-    fd_set readSet;
-    FD_ZERO(&readSet);
-    FD_SET(this->sock, &readSet);
-    
-    timeval timeVal = { 0, 0 };
-    int res = select(this->sock + 1, 0, &readSet, 0, &timeVal); 
+    pollfd pollFd = { this->sock, POLLOUT, 0 };
+    int res = poll(&pollFd, 1, 0);
     if (SOCKET_ERROR == res)
     {
         this->SetToLastSocketError();
@@ -432,6 +437,8 @@ PosixSocket::IsConnected()
     content of bytesSent will be less then numBytes, even though the
     return value will be Success. It is up to the caller to handle the
     extra data which hasn't been sent with the current call.
+    Sending into a connection which has been closed by the other side
+    returns an Error instead of raising SIGPIPE.
 */
 PosixSocket::Result
 PosixSocket::Send(const void* buf, SizeT numBytes, SizeT& bytesSent)
@@ -440,10 +447,10 @@ PosixSocket::Send(const void* buf, SizeT numBytes, SizeT& bytesSent)
     n_assert(0 != buf);
     this->ClearError();
     bytesSent = 0;
-    int res = send(this->sock, (const char*) buf, numBytes, 0);
+    int res = send(this->sock, (const char*) buf, numBytes, MSG_NOSIGNAL);
     if (SOCKET_ERROR == res)
     {
-        if (EWOULDBLOCK == res)
+        if (EWOULDBLOCK == errno)
         {
             return WouldBlock;
         }
@@ -457,6 +464,66 @@ PosixSocket::Send(const void* buf, SizeT numBytes, SizeT& bytesSent)
     return Success;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Sends the buffers with a single sendmsg(), the data is gathered from
+    the buffers by the kernel. Up to a kilobyte of data is copied together
+    and sent with send() instead, which is cheaper than a sendmsg() with
+    several buffers for that little data.
+*/
+PosixSocket::Result
+PosixSocket::Send(const void* const* bufs, const SizeT* numBytes, SizeT numBufs, SizeT& bytesSent)
+{
+    n_assert(this->IsOpen());
+    n_assert((numBufs > 0) && (numBufs <= MaxSendBuffers));
+    const SizeT MaxCopySize = 1024;
+    SizeT totalBytes = 0;
+    IndexT i;
+    for (i = 0; i < numBufs; i++)
+    {
+        totalBytes += numBytes[i];
+    }
+    if (totalBytes <= MaxCopySize)
+    {
+        uchar buf[MaxCopySize];
+        SizeT offset = 0;
+        for (i = 0; i < numBufs; i++)
+        {
+            Memory::Copy(bufs[i], buf + offset, numBytes[i]);
+            offset += numBytes[i];
+        }
+        return this->Send(buf, totalBytes, bytesSent);
+    }
+
+    this->ClearError();
+    bytesSent = 0;
+    struct iovec iov[MaxSendBuffers];
+    for (i = 0; i < numBufs; i++)
+    {
+        iov[i].iov_base = (void*)bufs[i];
+        iov[i].iov_len = numBytes[i];
+    }
+    struct msghdr msg;
+    Memory::Clear(&msg, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = numBufs;
+    ssize_t res = sendmsg(this->sock, &msg, MSG_NOSIGNAL);
+    if (SOCKET_ERROR == res)
+    {
+        if (EWOULDBLOCK == errno)
+        {
+            return WouldBlock;
+        }
+        else
+        {
+            this->SetToLastSocketError();
+            return Error;
+        }
+    }
+    bytesSent = (SizeT)res;
+    return Success;
+}
+
 //------------------------------------------------------------------------------
 /**
     This method checks if the socket has received data available. Use
@@ -467,12 +534,8 @@ bool
 PosixSocket::HasRecvData()
 {
     n_assert(this->IsOpen());
-    fd_set readSet;
-    FD_ZERO(&readSet);
-    FD_SET(this->sock, &readSet);
-    
-    timeval timeVal = { 0, 0 };
-    int res = select(this->sock + 1, &readSet, 0, 0, &timeVal);
+    pollfd pollFd = { this->sock, POLLIN, 0 };
+    int res = poll(&pollFd, 1, 0);
     if (SOCKET_ERROR == res)
     {
         this->SetToLastSocketError();
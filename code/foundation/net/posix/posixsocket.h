@@ -49,6 +49,9 @@ public:
         Closed,         // connection has been gracefully closed
     };
 
+    /// maximum number of buffers which can be sent with one call
+    static const SizeT MaxSendBuffers = 16;
+
     /// error codes
     enum ErrorCode
     {
@@ -114,6 +117,8 @@ public:
     ErrorCode GetErrorCode() const;
     /// get the last error string
     Util::String GetErrorString() const;
+    /// get the system socket handle
+    SOCKET GetSocket() const;
 
     /// set internet address of socket
     void SetAddress(const Net::IpAddress& a);
@@ -169,6 +174,8 @@ public:
     bool IsConnected();
     /// send raw data into the socket
     Result Send(const void* buf, SizeT numBytes, SizeT& bytesSent);
+    /// send several buffers with one call, without copying them together first
+    Result Send(const void* const* bufs, const SizeT* numBytes, SizeT numBufs, SizeT& bytesSent);
     /// return true if recv data is available at the socket
     bool HasRecvData();
     /// receive raw data from the socket
@@ -228,6 +235,15 @@ PosixSocket::IsOpen() const
     return (0 != this->sock);
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline SOCKET
+PosixSocket::GetSocket() const
+{
+    return this->sock;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -6,6 +6,7 @@
 #include "foundation/stdneb.h"
 #include "net/tcp/stdtcpclient.h"
 #include "io/memorystream.h"
+#include "math/scalar.h"
 
 namespace Net
 {
@@ -147,14 +148,29 @@ bool
 StdTcpClient::Send()
 {
     n_assert(this->sendStream.isvalid());
-    if (this->sendStream->GetSize() == 0)
+    bool res = this->SendWithHeader(nullptr, 0, this->sendStream);
+    this->sendStream->SetSize(0);
+    return res;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The header and the stream are handed to the socket together with a
+    gathering send, so sending a message with a header doesn't require
+    to copy the message behind the header first.
+*/
+bool
+StdTcpClient::SendWithHeader(const void* header, SizeT headerSize, const Ptr<Stream>& stream)
+{
+    n_assert(stream.isvalid());
+    if (stream->GetSize() == 0)
     {
         // nothing to send
         return true;
     }
 
-    this->sendStream->SetAccessMode(Stream::ReadAccess);
-    if (this->sendStream->Open())
+    stream->SetAccessMode(Stream::ReadAccess);
+    if (stream->Open())
     {
         // put the socket into blocking mode, so that if the
         // outgoing data doesn't fit into the send buffer the
@@ -169,22 +185,38 @@ StdTcpClient::Send()
         // so we may have to split the send data into
         // multiple packets
         SizeT maxMsgSize = this->socket->GetMaxMsgSize();
-        SizeT sendSize = this->sendStream->GetSize();
-        uchar* ptr = (uchar*) this->sendStream->Map();
+        const uchar* bufs[2] = { (const uchar*)header, (const uchar*)stream->Map() };
+        const SizeT sizes[2] = { headerSize, stream->GetSize() };
+        SizeT sendSize = headerSize + stream->GetSize();
         SizeT overallBytesSent = 0;
         Socket::Result socketResult = Socket::Success;
         while ((Socket::Success == socketResult) && (overallBytesSent < sendSize))
         {
-            SizeT bytesToSend = sendSize - overallBytesSent;
-            if (bytesToSend > maxMsgSize)
+            // skip what has been sent already
+            const void* sendBufs[2];
+            SizeT sendSizes[2];
+            SizeT numSendBufs = 0;
+            SizeT bytesToSend = 0;
+            SizeT offset = overallBytesSent;
+            IndexT i;
+            for (i = 0; (i < 2) && (bytesToSend < maxMsgSize); i++)
             {
-                bytesToSend = maxMsgSize;
+                if (offset >= sizes[i])
+                {
+                    offset -= sizes[i];
+                    continue;
+                }
+                SizeT size = Math::n_min(sizes[i] - offset, maxMsgSize - bytesToSend);
+                sendBufs[numSendBufs] = bufs[i] + offset;
+                sendSizes[numSendBufs] = size;
+                numSendBufs++;
+                bytesToSend += size;
+                offset = 0;
             }
             SizeT bytesSent = 0;
-            socketResult = this->socket->Send(ptr, bytesToSend, bytesSent);
+            socketResult = this->socket->Send(sendBufs, sendSizes, numSendBufs, bytesSent);
             if (Socket::Success == socketResult)
             {
-                ptr += bytesSent;
                 overallBytesSent += bytesSent;
             }
             else
@@ -211,13 +243,12 @@ StdTcpClient::Send()
                 this->SetBlocking(clientWasBlocking);
             }
         }
-        this->sendStream->Unmap();
+        stream->Unmap();
         if (!wasBlocking)
         {
             this->socket->SetBlocking(false);
         }
-        this->sendStream->Close();
-        this->sendStream->SetSize(0);
+        stream->Close();
         if ((Socket::Success == socketResult) && (overallBytesSent == sendSize))
         {
             return true;
@@ -60,6 +60,8 @@ public:
     bool IsConnected();
     /// send accumulated content of send stream to server
     bool Send();
+    /// send a header followed by a stream, without copying them together first
+    bool SendWithHeader(const void* header, SizeT headerSize, const Ptr<IO::Stream>& stream);
     /// access to send stream
     const Ptr<IO::Stream>& GetSendStream();
     /// receive data from server into recv stream
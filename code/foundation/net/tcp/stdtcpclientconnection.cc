@@ -6,6 +6,10 @@
 #include "foundation/stdneb.h"
 #include "net/tcp/stdtcpclientconnection.h"
 #include "io/memorystream.h"
+#include "math/scalar.h"
+#if __linux__
+#include "net/posix/linuxtcpiothread.h"
+#endif
 
 namespace Net
 {
@@ -18,6 +22,18 @@ using namespace IO;
 /**
 */
 StdTcpClientConnection::StdTcpClientConnection()
+#if __linux__
+    :
+    ioThread(nullptr),
+    ioDriven(false),
+    ioSendOffset(0),
+    ioIndex(InvalidIndex),
+    ioWriteInterest(false),
+    ioConnected(false),
+    ioShutdownRequested(false),
+    ioNotifyPending(false),
+    ioRecvStamp(0)
+#endif
 {
     // empty
 }
@@ -61,6 +77,12 @@ StdTcpClientConnection::Connect(const Ptr<Socket>& sock)
 bool
 StdTcpClientConnection::IsConnected() const
 {
+#if __linux__
+    if (this->ioDriven)
+    {
+        return this->ioConnected.load(std::memory_order_acquire);
+    }
+#endif
     if (this->socket.isvalid())
     {
         return this->socket->IsConnected();
@@ -77,6 +99,22 @@ StdTcpClientConnection::IsConnected() const
 void
 StdTcpClientConnection::Shutdown()
 {
+#if __linux__
+    if (this->ioDriven)
+    {
+        // the I/O thread owns the socket and closes it
+        this->ioConnected.store(false, std::memory_order_release);
+        if (nullptr != this->ioThread)
+        {
+            this->ioShutdownRequested.store(true, std::memory_order_release);
+            this->ioThread->Notify(this);
+            this->ioThread = nullptr;
+        }
+        this->sendStream = nullptr;
+        this->recvStream = nullptr;
+        return;
+    }
+#endif
     if (this->socket.isvalid())
     {
         this->socket->Close();
@@ -101,6 +139,18 @@ StdTcpClientConnection::GetClientAddress() const
 */
 Socket::Result
 StdTcpClientConnection::Send(const Ptr<Stream>& stream)
+{
+    return this->SendWithHeader(nullptr, 0, stream);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The header and the stream are handed to the socket together with a
+    gathering send, so sending a message with a header doesn't require
+    to copy the message behind the header first.
+*/
+Socket::Result
+StdTcpClientConnection::SendWithHeader(const void* header, SizeT headerSize, const Ptr<Stream>& stream)
 {
     n_assert(stream.isvalid());
     if (stream->GetSize() == 0)
@@ -109,6 +159,13 @@ StdTcpClientConnection::Send(const Ptr<Stream>& stream)
         return Socket::Success;
     }
     
+#if __linux__
+    if (this->ioDriven)
+    {
+        return this->SendIo(header, headerSize, stream);
+    }
+#endif
+
     Socket::Result res = Socket::Success;
     stream->SetAccessMode(Stream::ReadAccess);
     if (stream->Open())
@@ -117,19 +174,35 @@ StdTcpClientConnection::Send(const Ptr<Stream>& stream)
         // so we may have to split the send data into
         // multiple packets
         SizeT maxMsgSize = this->socket->GetMaxMsgSize();
-        SizeT sendSize = stream->GetSize();
-        uchar* ptr = (uchar*) stream->Map();
+        const uchar* bufs[2] = { (const uchar*)header, (const uchar*)stream->Map() };
+        const SizeT sizes[2] = { headerSize, stream->GetSize() };
+        SizeT sendSize = headerSize + stream->GetSize();
         SizeT overallBytesSent = 0;
         while ((Socket::Success == res) && (overallBytesSent < sendSize))
         {
-            SizeT bytesToSend = sendSize - overallBytesSent;
-            if (bytesToSend > maxMsgSize)
+            // skip what has been sent already
+            const void* sendBufs[2];
+            SizeT sendSizes[2];
+            SizeT numSendBufs = 0;
+            SizeT bytesToSend = 0;
+            SizeT offset = overallBytesSent;
+            IndexT i;
+            for (i = 0; (i < 2) && (bytesToSend < maxMsgSize); i++)
             {
-                bytesToSend = maxMsgSize;
+                if (offset >= sizes[i])
+                {
+                    offset -= sizes[i];
+                    continue;
+                }
+                SizeT size = Math::n_min(sizes[i] - offset, maxMsgSize - bytesToSend);
+                sendBufs[numSendBufs] = bufs[i] + offset;
+                sendSizes[numSendBufs] = size;
+                numSendBufs++;
+                bytesToSend += size;
+                offset = 0;
             }
             SizeT bytesSent = 0;
-            res = this->socket->Send(ptr, bytesToSend, bytesSent);
-            ptr += bytesSent;
+            res = this->socket->Send(sendBufs, sendSizes, numSendBufs, bytesSent);
             overallBytesSent += bytesSent;
         }
         stream->Unmap();
@@ -157,6 +230,12 @@ Socket::Result
 StdTcpClientConnection::Recv()
 {
     n_assert(this->recvStream.isvalid());
+#if __linux__
+    if (this->ioDriven)
+    {
+        return this->RecvIo();
+    }
+#endif
     this->recvStream->SetAccessMode(Stream::WriteAccess);
     this->recvStream->SetSize(0);
     Socket::Result res = Socket::Success;
@@ -194,6 +273,77 @@ StdTcpClientConnection::Recv()
     }
 }
 
+#if __linux__
+//------------------------------------------------------------------------------
+/**
+    Append the header and the stream to the send buffer and let the I/O
+    thread know. The I/O thread is only woken up if it hasn't been notified
+    yet.
+*/
+Socket::Result
+StdTcpClientConnection::SendIo(const void* header, SizeT headerSize, const Ptr<Stream>& stream)
+{
+    if (!this->ioConnected.load(std::memory_order_acquire))
+    {
+        return Socket::Error;
+    }
+    stream->SetAccessMode(Stream::ReadAccess);
+    if (stream->Open())
+    {
+        const void* ptr = stream->Map();
+        this->ioCritSect.Enter();
+        this->ioSendStream->SetAccessMode(Stream::AppendAccess);
+        if (this->ioSendStream->Open())
+        {
+            if (headerSize > 0)
+            {
+                this->ioSendStream->Write(header, headerSize);
+            }
+            this->ioSendStream->Write(ptr, stream->GetSize());
+            this->ioSendStream->Close();
+        }
+        this->ioCritSect.Leave();
+        stream->Unmap();
+        stream->Close();
+    }
+    if (!this->ioNotifyPending.exchange(true, std::memory_order_acq_rel))
+    {
+        this->ioThread->Notify(this);
+    }
+    return Socket::Success;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Take the data the I/O thread has received so far. The buffers are
+    swapped, so the data is not copied.
+*/
+Socket::Result
+StdTcpClientConnection::RecvIo()
+{
+    this->recvStream->SetSize(0);
+    this->ioCritSect.Enter();
+    Ptr<Stream> received = this->ioRecvStream;
+    this->ioRecvStream = this->recvStream;
+    this->ioCritSect.Leave();
+    this->recvStream = received;
+    this->recvStream->SetAccessMode(Stream::ReadAccess);
+
+    if (this->recvStream->GetSize() > 0)
+    {
+        return Socket::Success;
+    }
+    else if (this->ioConnected.load(std::memory_order_acquire))
+    {
+        return Socket::WouldBlock;
+    }
+    else
+    {
+        return Socket::Closed;
+    }
+}
+#endif
+
 //------------------------------------------------------------------------------
 /**
 */
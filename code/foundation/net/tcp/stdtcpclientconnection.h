@@ -17,6 +17,12 @@
     XmlReader, etc...). To send data back to the client just do the reverse:
     write data to the SendStream, and at any time call the Send() method which
     will send all data accumulated in the SendStream to the client.
+
+    On Linux the socket of a connection is owned by the I/O thread of the
+    TcpServer (see LinuxTcpIoThread). Recv() then takes the data which the
+    I/O thread has received so far, and Send() appends to a buffer which
+    the I/O thread writes to the socket, neither of them touches the
+    socket.
     
     (C) 2006 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
@@ -25,10 +31,18 @@
 #include "net/socket/ipaddress.h"
 #include "io/stream.h"
 #include "net/socket/socket.h"
+#if __linux__
+#include "threading/criticalsection.h"
+#include <atomic>
+#endif
 
 //------------------------------------------------------------------------------
 namespace Net
 {
+#if __linux__
+class LinuxTcpIoThread;
+#endif
+
 class StdTcpClientConnection : public Core::RefCounted
 {
     __DeclareClass(StdTcpClientConnection);
@@ -49,6 +63,8 @@ public:
     virtual Socket::Result Send();
     /// directly send a stream to the server, often prevents a memory copy
     virtual Socket::Result Send(const Ptr<IO::Stream>& stream);
+    /// send a header followed by a stream, without copying them together first
+    Socket::Result SendWithHeader(const void* header, SizeT headerSize, const Ptr<IO::Stream>& stream);
     /// access to send stream
     virtual const Ptr<IO::Stream>& GetSendStream();
     /// receive data from server into recv stream
@@ -60,6 +76,31 @@ protected:
     Ptr<Socket> socket;
     Ptr<IO::Stream> sendStream;
     Ptr<IO::Stream> recvStream;
+
+#if __linux__
+private:
+    friend class LinuxTcpIoThread;
+    friend class StdTcpServer;
+
+    /// append a header and a stream to the send buffer of the I/O thread
+    Socket::Result SendIo(const void* header, SizeT headerSize, const Ptr<IO::Stream>& stream);
+    /// take the data received by the I/O thread
+    Socket::Result RecvIo();
+
+    LinuxTcpIoThread* ioThread;             // set while the connection is served by an I/O thread
+    bool ioDriven;                          // socket is owned by an I/O thread
+    Threading::CriticalSection ioCritSect;  // protects ioRecvStream and ioSendStream
+    Ptr<IO::Stream> ioRecvStream;           // filled by the I/O thread
+    Ptr<IO::Stream> ioSendStream;           // filled by the sending threads
+    Ptr<IO::Stream> ioSendingStream;        // being written to the socket by the I/O thread
+    IO::Stream::Size ioSendOffset;
+    IndexT ioIndex;                         // index in the connections of the I/O thread
+    bool ioWriteInterest;
+    std::atomic<bool> ioConnected;
+    std::atomic<bool> ioShutdownRequested;
+    std::atomic<bool> ioNotifyPending;
+    uint ioRecvStamp;                       // last StdTcpServer::Recv() which looked at the connection
+#endif
 };
 
 } // namespace Net
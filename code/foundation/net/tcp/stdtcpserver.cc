@@ -20,6 +20,9 @@ using namespace IO;
 /**
 */
 StdTcpServer::StdTcpServer() :
+#if __linux__
+    recvStamp(0),
+#endif
     isOpen(false)
 {
     this->connectionClassRtti = &TcpClientConnection::RTTI;
@@ -40,10 +43,20 @@ bool
 StdTcpServer::Open()
 {
     n_assert(!this->isOpen);
-    n_assert(!this->listenerThread.isvalid());
     n_assert(this->clientConnections.IsEmpty());
 
+#if __linux__
+    // create the I/O thread
+    n_assert(!this->ioThread.isvalid());
+    this->ioThread = LinuxTcpIoThread::Create();
+    this->ioThread->SetName("StdTcpServer::IoThread");
+    this->ioThread->SetTcpServer(this);
+    this->ioThread->SetAddress(this->ipAddress);
+    this->ioThread->SetClientConnectionClass(*this->connectionClassRtti);
+    this->ioThread->Start();
+#else
     // create the listener thread
+    n_assert(!this->listenerThread.isvalid());
     this->listenerThread = ListenerThread::Create();
     this->listenerThread->SetName("StdTcpServer::ListenerThread");
     this->listenerThread->SetTcpServer(this);
@@ -51,7 +64,8 @@ StdTcpServer::Open()
 	this->listenerThread->SetThreadAffinity(System::Cpu::Core4);
     this->listenerThread->SetClientConnectionClass(*this->connectionClassRtti);
     this->listenerThread->Start();
-    
+#endif
+
     this->isOpen = true;
     return true;
 }
@@ -63,6 +77,24 @@ void
 StdTcpServer::Close()
 {
     n_assert(this->isOpen);
+
+#if __linux__
+    // stop the I/O thread, the connections are shut down before, while the
+    // thread may still close their sockets
+    n_assert(this->ioThread.isvalid());
+    this->connectionCritSect.Enter();
+    IndexT clientIndex;
+    for (clientIndex = 0; clientIndex < this->clientConnections.Size(); clientIndex++)
+    {
+        this->clientConnections[clientIndex]->Shutdown();
+    }
+    this->clientConnections.Clear();
+    this->connectionCritSect.Leave();
+    this->ioThread->Stop();
+    this->ioThread = nullptr;
+    this->readyConnections.Clear();
+    this->activeConnections.Clear();
+#else
     n_assert(this->listenerThread.isvalid());
     
     // stop the listener thread
@@ -79,6 +111,7 @@ StdTcpServer::Close()
     }
     this->clientConnections.Clear();
     this->connectionCritSect.Leave();
+#endif
 
     this->isOpen = false;
 }
@@ -101,6 +134,9 @@ StdTcpServer::AddClientConnection(const Ptr<TcpClientConnection>& conn)
 Array<Ptr<TcpClientConnection> >
 StdTcpServer::Recv()
 {
+#if __linux__
+    return this->RecvIo();
+#else
     Array<Ptr<TcpClientConnection> > clientsWithData;
 
     // iterate over all clients, and check for new data,
@@ -142,7 +178,87 @@ StdTcpServer::Recv()
     }
     this->connectionCritSect.Leave();
     return clientsWithData;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    Lets a thread which serves the connections sleep until there is
+    something to receive, instead of polling Recv() in fixed intervals.
+    Without the I/O thread there is nothing to wait for, so this simply
+    sleeps for the timeout.
+*/
+void
+StdTcpServer::WaitForRecv(int timeoutMs)
+{
+    n_assert(this->isOpen);
+#if __linux__
+    // connections which returned data the last time may still have more
+    if (this->activeConnections.IsEmpty())
+    {
+        this->ioThread->WaitReady(timeoutMs);
+    }
+#else
+    Core::SysFunc::Sleep(timeoutMs * 0.001);
+#endif
+}
+
+#if __linux__
+//------------------------------------------------------------------------------
+/**
+    Only looks at the connections which the I/O thread queued because they
+    received data or were closed, and at the connections which returned
+    data the last time, since a connection may return one message per
+    Recv() and keep the others (see MessageClientConnection).
+*/
+Array<Ptr<TcpClientConnection> >
+StdTcpServer::RecvIo()
+{
+    Array<Ptr<TcpClientConnection> > clientsWithData;
+    this->readyConnections.Clear();
+    this->ioThread->DequeueReady(this->readyConnections);
+    IndexT i;
+    for (i = 0; i < this->activeConnections.Size(); i++)
+    {
+        this->readyConnections.Append(this->activeConnections[i].upcast<StdTcpClientConnection>());
+    }
+    this->activeConnections.Clear();
+
+    // a connection may be queued more than once
+    this->recvStamp++;
+    this->connectionCritSect.Enter();
+    for (i = 0; i < this->readyConnections.Size(); i++)
+    {
+        const Ptr<TcpClientConnection>& cur = this->readyConnections[i].downcast<TcpClientConnection>();
+        if ((nullptr == cur->ioThread) || (cur->ioRecvStamp == this->recvStamp))
+        {
+            // already dropped or already handled
+            continue;
+        }
+        cur->ioRecvStamp = this->recvStamp;
+
+        Socket::Result res = cur->Recv();
+        if (Socket::Success == res)
+        {
+            clientsWithData.Append(cur);
+            this->activeConnections.Append(cur);
+        }
+        else if (!cur->IsConnected() || (Socket::Error == res) || (Socket::Closed == res))
+        {
+            // connection has been closed, remove the client
+            cur->Shutdown();
+            IndexT clientIndex = this->clientConnections.FindIndex(cur);
+            if (InvalidIndex != clientIndex)
+            {
+                this->clientConnections.EraseIndex(clientIndex);
+            }
+        }
+    }
+    this->connectionCritSect.Leave();
+    this->readyConnections.Clear();
+    return clientsWithData;
 }
+#endif
 
 //------------------------------------------------------------------------------
 /**
@@ -9,6 +9,11 @@
     TcpClientConnection object which can be used by the application
     to communicate with a specific client.
 
+    On Linux the listener thread is replaced by a LinuxTcpIoThread, which
+    also reads and writes the sockets of all connections. Recv() then only
+    looks at the connections which received data since the last call,
+    instead of polling every connection.
+
     (C) 2006 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
@@ -18,6 +23,9 @@
 #include "net/tcpclientconnection.h"
 #include "net/socket/socket.h"
 #include "threading/criticalsection.h"
+#if __linux__
+#include "net/posix/linuxtcpiothread.h"
+#endif
 
 //------------------------------------------------------------------------------
 namespace Net
@@ -46,6 +54,8 @@ public:
     bool IsOpen() const;
     /// poll clients connections for received data, call this frequently!
     Util::Array<Ptr<TcpClientConnection> > Recv();
+    /// wait until a client connection may have received data, or the timeout expired
+    void WaitForRecv(int timeoutMs);
     /// broadcast a message to all clients
     bool Broadcast(const Ptr<IO::Stream>& msg);
 
@@ -73,11 +83,22 @@ private:
         const Core::Rtti* connectionClassRtti;
     };
     friend class ListenerThread;
+    friend class LinuxTcpIoThread;
     /// add a client connection (called by the listener thread)
     void AddClientConnection(const Ptr<TcpClientConnection>& connection);
 
     IpAddress ipAddress;
+#if __linux__
+    /// poll the connections queued by the I/O thread
+    Util::Array<Ptr<TcpClientConnection> > RecvIo();
+
+    Ptr<LinuxTcpIoThread> ioThread;
+    Util::Array<Ptr<StdTcpClientConnection> > readyConnections;
+    Util::Array<Ptr<TcpClientConnection> > activeConnections;
+    uint recvStamp;
+#else
     Ptr<ListenerThread> listenerThread;
+#endif
     bool isOpen;
     Util::Array<Ptr<TcpClientConnection> > clientConnections;
     Threading::CriticalSection connectionCritSect;
@@ -5,9 +5,6 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "net/tcpmessagecodec.h"
-#include "io/binarywriter.h"
-#include "io/binaryreader.h"
-#include "io/memorystream.h"
 #include "memory/memory.h"
 //------------------------------------------------------------------------------
 using namespace Util;
@@ -16,14 +13,20 @@ using namespace IO;
 namespace Net
 {
 
+static const uint MessageMagic = 'TCPM';
+
 //------------------------------------------------------------------------------
 /**
 */
 TcpMessageCodec::TcpMessageCodec():
-    receiveState(HeaderData),
-    messageSize(0),
-    headerPosition(0),
-    messagePostition(0)
+    recvData(nullptr),
+    recvSize(0),
+    recvPosition(0),
+    buffer(nullptr),
+    bufferSize(0),
+    bufferCapacity(0),
+    numBytesCopied(0),
+    error(false)
 {
     // empty
 }
@@ -33,23 +36,57 @@ TcpMessageCodec::TcpMessageCodec():
 */
 TcpMessageCodec::~TcpMessageCodec()
 {
-    // closes and discards header and message streams if they exists...
-    if (this->headerStream.isvalid())
+    if (nullptr != this->buffer)
     {
-        if (this->headerStream->IsOpen())
-        {
-            this->headerStream->Close();
-        }
-        this->headerStream = nullptr;
+        Memory::Free(Memory::NetworkHeap, this->buffer);
+        this->buffer = nullptr;
     }
-    if (this->messageStream.isvalid())
+}
+
+//------------------------------------------------------------------------------
+/**
+    The header is the magic 'TCPM' followed by the size of the message,
+    both in network byte order.
+*/
+void
+TcpMessageCodec::EncodeHeader(SizeT messageSize, uchar (&outHeader)[HeaderSize])
+{
+    n_assert((messageSize >= 0) && (messageSize <= MaxMessageSize));
+    const uint size = (uint)messageSize;
+    outHeader[0] = (uchar)(MessageMagic >> 24);
+    outHeader[1] = (uchar)(MessageMagic >> 16);
+    outHeader[2] = (uchar)(MessageMagic >> 8);
+    outHeader[3] = (uchar)MessageMagic;
+    outHeader[4] = (uchar)(size >> 24);
+    outHeader[5] = (uchar)(size >> 16);
+    outHeader[6] = (uchar)(size >> 8);
+    outHeader[7] = (uchar)size;
+}
+
+//------------------------------------------------------------------------------
+/**
+    A header without the magic is skipped. A header with the magic but a
+    size above MaxMessageSize means the peer is broken or malicious, the
+    size is never used to index the received data, and the codec goes
+    into the error state.
+*/
+bool
+TcpMessageCodec::DecodeHeader(const uchar* header, SizeT& outMessageSize)
+{
+    const uint magic = ((uint)header[0] << 24) | ((uint)header[1] << 16) | ((uint)header[2] << 8) | (uint)header[3];
+    const uint size = ((uint)header[4] << 24) | ((uint)header[5] << 16) | ((uint)header[6] << 8) | (uint)header[7];
+    outMessageSize = 0;
+    if (MessageMagic != magic)
     {
-        if (this->messageStream->IsOpen())
-        {
-            this->messageStream->Close();
-        }
-        this->messageStream = nullptr;
+        return false;
+    }
+    if (size > (uint)MaxMessageSize)
+    {
+        this->error = true;
+        return false;
     }
+    outMessageSize = (SizeT)size;
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -60,142 +97,176 @@ TcpMessageCodec::~TcpMessageCodec()
 void
 TcpMessageCodec::EncodeToMessage(const Ptr<IO::Stream> &stream, const Ptr<IO::Stream> &output)
 {
-    Ptr<BinaryWriter> writer = BinaryWriter::Create();
-    writer->SetStreamByteOrder(System::ByteOrder::Network);
-    writer->SetStream(output);
     SizeT streamSize = stream->GetSize();
+    uchar header[HeaderSize];
+    EncodeHeader(streamSize, header);
     stream->SetAccessMode(Stream::ReadAccess);
     output->SetAccessMode(Stream::WriteAccess);
-    uchar* ptr = 0;
-    if (writer->Open() && stream->Open())
-    {
-        writer->WriteUInt('TCPM');
-        writer->WriteInt(streamSize);
-        ptr = (uchar*) stream->Map();
-        writer->WriteRawData(ptr,streamSize);
-    }
-    if (writer->IsOpen())
+    if (output->Open())
     {
-        writer->Close();
+        output->Write(header, HeaderSize);
+        if ((streamSize > 0) && stream->Open())
+        {
+            output->Write(stream->Map(), streamSize);
+            stream->Unmap();
+            stream->Close();
+        }
+        output->Close();
     }
-    if (stream->IsOpen())
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sets the data messages are decoded from. The data is not copied, all
+    messages of the previous data must have been dequeued.
+*/
+void
+TcpMessageCodec::DecodeData(const void* data, SizeT size)
+{
+    n_assert(this->recvPosition == this->recvSize);
+    this->recvData = (const uchar*)data;
+    this->recvSize = size;
+    this->recvPosition = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The stream has to be mappable, its memory is decoded in place like
+    with DecodeData().
+*/
+void
+TcpMessageCodec::DecodeStream(const Ptr<IO::Stream>& stream)
+{
+    n_assert(stream->CanBeMapped());
+    stream->SetAccessMode(Stream::ReadAccess);
+    if ((stream->GetSize() > 0) && stream->Open())
     {
+        this->DecodeData(stream->Map(), stream->GetSize());
+        stream->Unmap();
         stream->Close();
     }
 }
 
 //------------------------------------------------------------------------------
 /**
-    Puts a given stream to the internal buffer. This may result in new
-    messages in the queue.
+    Complete messages are handed out right from the received data. The rest
+    of the received data, which is the beginning of a message which is not
+    complete yet, is copied to the buffer and completed there by the next
+    received data. A header which isn't valid is skipped, like the data
+    which follows would be a new header. Once the codec is in the error
+    state, all received data is discarded.
 */
-void
-TcpMessageCodec::DecodeStream(const Ptr<IO::Stream> &stream)
+bool
+TcpMessageCodec::DequeueMessage(MessageView& outMessage)
 {
-    stream->SetAccessMode(Stream::ReadAccess);
-    Ptr<BinaryReader> reader = BinaryReader::Create();
-    reader->SetStream(stream);
-    if(reader->Open())
+    SizeT messageSize = 0;
+    for (;;)
     {
-        uchar byte;
-        while(!reader->Eof())
+        if (this->error)
+        {
+            this->recvPosition = this->recvSize;
+            this->bufferSize = 0;
+            return false;
+        }
+        if (this->bufferSize > 0)
         {
-            // read byte
-            byte = reader->ReadUChar();
-            
-            if(HeaderData == this->receiveState)
+            if (!this->FillBuffer(HeaderSize))
             {
-                // read header until enough bytes arrived
-                if(this->headerPosition == 0)
-                {
-                    this->headerStream = MemoryStream::Create();
-                    this->headerStream->SetAccessMode(Stream::WriteAccess);
-                    this->headerStream->Open();
-                }
-                
-                if (headerStream->IsOpen())
-                {
-                    // write byte to headerstream
-                    this->headerStream->Write(&byte,sizeof(byte));
-                    headerPosition++;
-                    
-                    if (this->headerPosition == 8)
-                    {
-                        this->headerStream->Close();
-                        n_assert(this->headerStream->GetSize() == 8);
-                        // handle complete received header
-                        this->headerStream->SetAccessMode(Stream::ReadAccess);
-                        Ptr<BinaryReader> reader = BinaryReader::Create();
-                        reader->SetStream(this->headerStream);
-                        reader->SetStreamByteOrder(System::ByteOrder::Network);
-                        n_assert(reader->Open());
-                        // read header name 'TCPM'
-                        uint tcpm = reader->ReadUInt();
-                        if(tcpm == 'TCPM')
-                        {
-                            this->messageSize = reader->ReadInt();
-                            this->messagePostition = 0;
-                            this->receiveState = MessageData;
-                        }
-                        reader->Close();
-                        this->headerPosition = 0;
-                    }
-                }
+                return false;
             }
-            else if(MessageData == this->receiveState)
-            {   
-                // read message until all bytes arrived
-                if (this->messagePostition == 0)
-                {
-                    this->messageStream = MemoryStream::Create();
-                    this->messageStream->SetAccessMode(Stream::WriteAccess);
-                    this->messageStream->Open();
-                }
-                
-                if (this->messageStream->IsOpen())
-                {
-                    // write byte to messagestream
-                    this->messageStream->Write(&byte,sizeof(byte));
-                    messagePostition++;
-                    
-                    if(messagePostition == messageSize)
-                    {
-                        this->messageStream->Close();
-                        n_assert(this->messageStream->GetSize() == messageSize);
-                        // attach completely received mesage
-                        this->messageStream->SetAccessMode(Stream::ReadAccess);
-                        this->completedMessages.Append(this->messageStream);
-                        this->messageStream = nullptr;
-                        this->messagePostition = 0;
-                        this->receiveState = HeaderData;
-                    }
-                }
+            if (!this->DecodeHeader(this->buffer, messageSize))
+            {
+                this->bufferSize = 0;
+                continue;
+            }
+            if (!this->FillBuffer(HeaderSize + messageSize))
+            {
+                return false;
             }
+            outMessage.data = this->buffer + HeaderSize;
+            outMessage.size = messageSize;
+            this->bufferSize = 0;
+            return true;
         }
+
+        const SizeT available = this->recvSize - this->recvPosition;
+        if (0 == available)
+        {
+            return false;
+        }
+        if (available < HeaderSize)
+        {
+            this->FillBuffer(HeaderSize);
+            return false;
+        }
+        const uchar* header = this->recvData + this->recvPosition;
+        if (!this->DecodeHeader(header, messageSize))
+        {
+            this->recvPosition += HeaderSize;
+            continue;
+        }
+        if ((available - HeaderSize) < messageSize)
+        {
+            this->FillBuffer(HeaderSize + messageSize);
+            return false;
+        }
+        outMessage.data = header + HeaderSize;
+        outMessage.size = messageSize;
+        this->recvPosition += HeaderSize + messageSize;
+        return true;
     }
 }
 
 //------------------------------------------------------------------------------
 /**
-    Returns true if messages are available
 */
 bool
-TcpMessageCodec::HasMessages()
+TcpMessageCodec::FillBuffer(SizeT numBytes)
 {
-    return this->completedMessages.Size() > 0;
+    n_assert((numBytes >= 0) && (numBytes <= HeaderSize + MaxMessageSize));
+    if (this->bufferSize >= numBytes)
+    {
+        return true;
+    }
+    if (numBytes > this->bufferCapacity)
+    {
+        if (nullptr == this->buffer)
+        {
+            this->buffer = (uchar*)Memory::Alloc(Memory::NetworkHeap, numBytes);
+        }
+        else
+        {
+            this->buffer = (uchar*)Memory::Realloc(Memory::NetworkHeap, this->buffer, numBytes);
+        }
+        this->bufferCapacity = numBytes;
+    }
+    SizeT bytesToCopy = numBytes - this->bufferSize;
+    const SizeT available = this->recvSize - this->recvPosition;
+    if (bytesToCopy > available)
+    {
+        bytesToCopy = available;
+    }
+    if (bytesToCopy > 0)
+    {
+        Memory::Copy(this->recvData + this->recvPosition, this->buffer + this->bufferSize, bytesToCopy);
+        this->recvPosition += bytesToCopy;
+        this->bufferSize += bytesToCopy;
+        this->numBytesCopied += bytesToCopy;
+    }
+    return this->bufferSize == numBytes;
 }
 
 //------------------------------------------------------------------------------
 /**
-    Returns all created messages since the last call and clears message
-    queue.
 */
-Util::Array<Ptr<IO::Stream> >
-TcpMessageCodec::DequeueMessages()
+void
+TcpMessageCodec::Reset()
 {
-    Array<Ptr<Stream> > output;
-    output.AppendArray(this->completedMessages);
-    this->completedMessages.Clear();
-    return output;
+    this->recvData = nullptr;
+    this->recvSize = 0;
+    this->recvPosition = 0;
+    this->bufferSize = 0;
+    this->error = false;
 }
+
 } // namespace Net
\ No newline at end of file
@@ -4,22 +4,30 @@
     @class Net::TcpMessageCodec
 
     Helperclass that provides function to encode and decode sreams into messages.
-    
-    The encoder adds header informations at the beginning of the stream,
-    that includes the complete size of the stream. Call EncodeToMessage at the
-    sending site.
 
-    The decoder reads sequential incoming streams and append the data
-    to an internal buffer. It concatenates the incoming streams to
-    a list of streams containing complete messages.
-    Call DecodeStream at the receiving site and check for completed messsages
-    with GetMessages.
+    Every message starts with a header which contains the size of the
+    message. EncodeHeader() writes the header, so the header and the
+    message can be sent with a single gathering send, without copying
+    them into one buffer first. EncodeToMessage() writes a copy of a
+    stream with header, for places which need the whole message in one
+    stream.
+
+    The decoder takes the received data as it arrives and hands out
+    complete messages one by one with DequeueMessage(). Messages are
+    handed out as views: they point directly into the received data, only
+    a message which is split between two pieces of received data is put
+    together in a buffer of the codec. A view stays valid until the next
+    call to DecodeData() or DequeueMessage(), the received data must stay
+    valid until DequeueMessage() returned false.
+
+    A header with a size above MaxMessageSize can't be trusted, the
+    decoder stops there and HasError() returns true until Reset(). The
+    connection should be dropped then.
 
     (C) 2009 Radon Labs
 	(C) 2013-2020 Individual contributors, see AUTHORS file
 */
-#include "io/memorystream.h"
-#include "io/binaryreader.h"
+#include "io/stream.h"
 
 //------------------------------------------------------------------------------
 namespace Net
@@ -27,35 +35,73 @@ namespace Net
 class TcpMessageCodec
 {
 public:
+    /// size of the header in front of each message
+    static const SizeT HeaderSize = 8;
+    /// largest message size which is accepted
+    static const SizeT MaxMessageSize = 16 * 1024 * 1024;
+
+    /// a received message
+    struct MessageView
+    {
+        const uchar* data;
+        SizeT size;
+    };
+
     /// Constructor
     TcpMessageCodec();
     /// Destructor
     virtual ~TcpMessageCodec();
 
+    /// write the header of a message with the given size
+    static void EncodeHeader(SizeT messageSize, uchar (&outHeader)[HeaderSize]);
     /// Attachs header information to the stream and returns a copy with header
-    void EncodeToMessage(const Ptr<IO::Stream> & stream, const Ptr<IO::Stream> &output);  
-    /// Decodes a given Stream. Check for HasMessages() if this completes a message.
-    void DecodeStream(const Ptr<IO::Stream> & stream);
-    /// Returns true, if there are messages in the internal message queue.
-    bool HasMessages();
-    /// Gets the list of all created messages since the last call of this function
-    Util::Array<Ptr<IO::Stream> > DequeueMessages();
-
-private: 
-    /// what data is currently expected from the decoder
-    enum ReceiveState
-    {
-        HeaderData,
-        MessageData
-    };
-    
-    ReceiveState receiveState;
-    Ptr<IO::Stream> headerStream;
-    Ptr<IO::Stream> messageStream;
-    SizeT messageSize;
-    IndexT headerPosition;
-    IndexT messagePostition;
-    Util::Array<Ptr<IO::Stream> > completedMessages;
+    void EncodeToMessage(const Ptr<IO::Stream> & stream, const Ptr<IO::Stream> &output);
+    /// decode received data, which must stay valid until DequeueMessage() returns false
+    void DecodeData(const void* data, SizeT size);
+    /// decode a stream of received data, which must not be changed until DequeueMessage() returns false
+    void DecodeStream(const Ptr<IO::Stream>& stream);
+    /// get the next complete message, returns false if there is none
+    bool DequeueMessage(MessageView& outMessage);
+    /// return true if a header with an invalid size was received
+    bool HasError() const;
+    /// discard all received data, and clear the error
+    void Reset();
+    /// get the number of received bytes copied into the codec's buffer since construction
+    size_t GetNumBytesCopied() const;
+
+private:
+    /// append up to numBytes of the received data to the buffer, returns true if the buffer holds numBytes now
+    bool FillBuffer(SizeT numBytes);
+    /// read the message size from a header, returns false if the header is invalid
+    bool DecodeHeader(const uchar* header, SizeT& outMessageSize);
+
+    const uchar* recvData;
+    SizeT recvSize;
+    SizeT recvPosition;
+    uchar* buffer;
+    SizeT bufferSize;
+    SizeT bufferCapacity;
+    size_t numBytesCopied;
+    bool error;
 };
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+TcpMessageCodec::HasError() const
+{
+    return this->error;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline size_t
+TcpMessageCodec::GetNumBytesCopied() const
+{
+    return this->numBytesCopied;
+}
+
 //------------------------------------------------------------------------------
 } // namespace Net
\ No newline at end of file
@@ -464,6 +464,48 @@ Win360Socket::Send(const void* buf, SizeT numBytes, SizeT& bytesSent)
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    Sends the buffers with a single WSASend(), the data is gathered from
+    the buffers by the network stack.
+*/
+Win360Socket::Result
+Win360Socket::Send(const void* const* bufs, const SizeT* numBytes, SizeT numBufs, SizeT& bytesSent)
+{
+    n_assert(this->IsOpen());
+    n_assert((numBufs > 0) && (numBufs <= MaxSendBuffers));
+    this->ClearError();
+    bytesSent = 0;
+    WSABUF wsaBufs[MaxSendBuffers];
+    IndexT i;
+    for (i = 0; i < numBufs; i++)
+    {
+        wsaBufs[i].buf = (CHAR*)bufs[i];
+        wsaBufs[i].len = numBytes[i];
+    }
+    DWORD numBytesSent = 0;
+    int res = WSASend(this->sock, wsaBufs, numBufs, &numBytesSent, 0, NULL, NULL);
+    if (SOCKET_ERROR == res)
+    {
+        int wsaError = WSAGetLastError();
+        if (WSAEWOULDBLOCK == wsaError)
+        {
+            return WouldBlock;
+        }
+        else
+        {
+            this->SetToLastWSAError();
+            n_printf("Win360Socket::Send(): WSASend() failed with '%s'\n", this->GetErrorString().AsCharPtr());
+            return Error;
+        }
+    }
+    else
+    {
+        bytesSent = numBytesSent;
+        return Success;
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
     This method checks if the socket has received data available. Use
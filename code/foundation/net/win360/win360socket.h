@@ -46,6 +46,9 @@ public:
         Closed,         // connection has been gracefully closed
     };
 
+    /// maximum number of buffers which can be sent with one call
+    static const SizeT MaxSendBuffers = 16;
+
     /// error codes
     enum ErrorCode
     {
@@ -166,6 +169,8 @@ public:
     bool IsConnected();
     /// send raw data into the socket
     Result Send(const void* buf, SizeT numBytes, SizeT& bytesSent);
+    /// send several buffers with one call, without copying them together first
+    Result Send(const void* const* bufs, const SizeT* numBytes, SizeT numBufs, SizeT& bytesSent);
     /// return true if recv data is available at the socket
     bool HasRecvData();
     /// receive raw data from the socket
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "system/posix/posixsysteminfo.h"
+#include <unistd.h>
 
 namespace Posix
 {
@@ -19,8 +20,8 @@ PosixSystemInfo::PosixSystemInfo()
 #else
     this->cpuType = X86_32;
 #endif
-    // XXX: this->numCpuCores = sysInfo.dwNumberOfProcessors;
-    // XXX: this->pageSize = sysInfo.dwPageSize;
+    this->numCpuCores = (SizeT)sysconf(_SC_NPROCESSORS_ONLN);
+    this->pageSize = (SizeT)sysconf(_SC_PAGESIZE);
 }
 
 } // namespace Posix
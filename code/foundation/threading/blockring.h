@@ -0,0 +1,219 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Threading::BlockRing
+
+    Single producer, single consumer ring of fixed size blocks. The producer
+    fills a block without any synchronization and publishes the whole block
+    with one atomic store, either when it is full or when Publish() is called.
+    The consumer then receives the published blocks in order through Consume().
+
+    Compared to a SafeQueue, this makes the cost of handing work to another
+    thread one atomic store and one event signal per block instead of a
+    lock per element. If the consumer falls behind and all blocks are in
+    flight, the producer waits until a block is returned.
+
+    Elements are copied as plain memory and are never constructed or
+    destroyed, so TYPE must be trivially copyable.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include "threading/event.h"
+#include <atomic>
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+namespace Threading
+{
+template<class TYPE, SizeT BLOCKSIZE = 256> class BlockRing
+{
+public:
+    /// constructor, number of blocks must be a power of two
+    BlockRing(SizeT numBlocks = 64);
+    /// destructor
+    ~BlockRing();
+
+    /// add element to the current block, publishes the block if it becomes full (producer)
+    void Enqueue(const TYPE& e);
+    /// add several elements (producer)
+    void EnqueueArray(const TYPE* elements, SizeT num);
+    /// publish the current block, even if it's not full (producer)
+    void Publish();
+
+    /// call func(const TYPE* elements, SizeT num) for every published block, returns number of elements (consumer)
+    template<class FUNC> SizeT Consume(const FUNC& func);
+    /// wait until a block has been published, or Signal() is called (consumer)
+    void Wait();
+    /// signal the consumer, so that Wait() returns
+    void Signal();
+    /// return true if no published blocks are waiting to be consumed
+    bool IsEmpty() const;
+
+private:
+    static_assert(std::is_trivially_copyable<TYPE>::value, "BlockRing elements must be trivially copyable");
+
+    struct Block
+    {
+        SizeT count;
+        TYPE elements[BLOCKSIZE];
+    };
+
+    /// get the block the producer writes to, waits for a free block if needed
+    Block* AcquireWriteBlock();
+
+    Block* blocks;
+    SizeT numBlocks;
+    Block* writeBlock;
+    Event publishEvent;
+    Event releaseEvent;
+    // written by producer and consumer respectively, keep them on separate cache lines
+    alignas(64) std::atomic<uint> published;
+    alignas(64) std::atomic<uint> consumed;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE>
+BlockRing<TYPE, BLOCKSIZE>::BlockRing(SizeT numBlocks) :
+    numBlocks(numBlocks),
+    writeBlock(nullptr),
+    published(0),
+    consumed(0)
+{
+    n_assert(numBlocks > 0 && (numBlocks & (numBlocks - 1)) == 0);
+    this->blocks = (Block*)Memory::Alloc(Memory::ObjectArrayHeap, sizeof(Block) * numBlocks);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE>
+BlockRing<TYPE, BLOCKSIZE>::~BlockRing()
+{
+    Memory::Free(Memory::ObjectArrayHeap, this->blocks);
+    this->blocks = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The producer owns a block from the moment it's acquired until it's
+    published, the consumer never looks at blocks beyond the published index.
+*/
+template<class TYPE, SizeT BLOCKSIZE> typename BlockRing<TYPE, BLOCKSIZE>::Block*
+BlockRing<TYPE, BLOCKSIZE>::AcquireWriteBlock()
+{
+    if (this->writeBlock == nullptr)
+    {
+        const uint index = this->published.load(std::memory_order_relaxed);
+        while (index - this->consumed.load(std::memory_order_acquire) >= (uint)this->numBlocks)
+            this->releaseEvent.Wait();
+
+        this->writeBlock = &this->blocks[index & (this->numBlocks - 1)];
+        this->writeBlock->count = 0;
+    }
+    return this->writeBlock;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> void
+BlockRing<TYPE, BLOCKSIZE>::Enqueue(const TYPE& e)
+{
+    Block* block = this->AcquireWriteBlock();
+    block->elements[block->count++] = e;
+    if (block->count == BLOCKSIZE)
+        this->Publish();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> void
+BlockRing<TYPE, BLOCKSIZE>::EnqueueArray(const TYPE* elements, SizeT num)
+{
+    while (num > 0)
+    {
+        Block* block = this->AcquireWriteBlock();
+        const SizeT count = Math::n_min(num, BLOCKSIZE - block->count);
+        Memory::Copy(elements, &block->elements[block->count], count * sizeof(TYPE));
+        block->count += count;
+        elements += count;
+        num -= count;
+        if (block->count == BLOCKSIZE)
+            this->Publish();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> void
+BlockRing<TYPE, BLOCKSIZE>::Publish()
+{
+    if (this->writeBlock == nullptr)
+        return;
+
+    // an empty block is simply left to be reused
+    if (this->writeBlock->count > 0)
+    {
+        this->published.store(this->published.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        this->publishEvent.Signal();
+    }
+    this->writeBlock = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> template<class FUNC> SizeT
+BlockRing<TYPE, BLOCKSIZE>::Consume(const FUNC& func)
+{
+    SizeT num = 0;
+    uint index = this->consumed.load(std::memory_order_relaxed);
+    const uint end = this->published.load(std::memory_order_acquire);
+    while (index != end)
+    {
+        const Block& block = this->blocks[index & (this->numBlocks - 1)];
+        func(block.elements, block.count);
+        num += block.count;
+
+        // hand the block back to the producer
+        index++;
+        this->consumed.store(index, std::memory_order_release);
+        this->releaseEvent.Signal();
+    }
+    return num;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> void
+BlockRing<TYPE, BLOCKSIZE>::Wait()
+{
+    this->publishEvent.Wait();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> void
+BlockRing<TYPE, BLOCKSIZE>::Signal()
+{
+    this->publishEvent.Signal();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, SizeT BLOCKSIZE> bool
+BlockRing<TYPE, BLOCKSIZE>::IsEmpty() const
+{
+    return this->consumed.load(std::memory_order_acquire) == this->published.load(std::memory_order_acquire);
+}
+
+} // namespace Threading
+//------------------------------------------------------------------------------
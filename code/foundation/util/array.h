@@ -8,10 +8,13 @@
 
     The default constructor will not pre-allocate elements, so no space
     is wasted as long as no elements are added. As soon as the first element
-    is added to the array, an initial buffer of 16 elements is created.
-    Whenever the element buffer would overflow, a new buffer of twice
-    the size of the previous buffer is created and the existing elements 
-    are then copied over to the new buffer. The element buffer will
+    is added to the array, an initial buffer of 'grow' elements is created.
+    Whenever the element buffer would overflow, a new buffer of one and a
+    half times the size of the previous buffer is created and the existing
+    elements are then moved over to the new buffer, this keeps the cost of
+    appending constant on average no matter how large the array gets.
+    Trivially copyable element types are relocated with a single memory copy,
+    other types are moved element by element. The element buffer will
     never shrink, the only way to reclaim unused memory is to 
     copy the Array to a new Array object. This is usually not a problem
     since most arrays will oscillate around some specific size, so once
@@ -77,6 +80,8 @@ public:
 
     /// append element to end of array
     void Append(const TYPE& elm);
+    /// move element to end of array
+    void Append(TYPE&& elm);
     /// append the contents of an array to this array
     void AppendArray(const Array<TYPE>& rhs);
     /// increase capacity to fit N more elements into the array.
@@ -177,8 +182,7 @@ protected:
 	void MoveRange(TYPE* to, TYPE* from, SizeT num);
 
     static const SizeT MinGrowSize = 16;
-    static const SizeT MaxGrowSize = 65536; // FIXME: big grow size needed for mesh tools
-    SizeT grow;                             // grow by this number of elements if array exhausted
+    SizeT grow;                             // initial number of elements allocated when the array is first grown
     SizeT capacity;                         // number of elements allocated
     SizeT count;                            // number of elements in array
     TYPE* elements;                         // pointer to element array
@@ -344,11 +348,7 @@ Array<TYPE>::Copy(const Array<TYPE>& src)
     if (this->capacity > 0)
     {
         this->elements = n_new_array(TYPE, this->capacity);
-        IndexT i;
-        for (i = 0; i < this->count; i++)
-        {
-            this->elements[i] = src.elements[i];
-        }
+        this->CopyRange(this->elements, src.elements, this->count);
     }
 }
 
@@ -444,13 +444,14 @@ Array<TYPE>::operator=(Array<TYPE>&& rhs)
 {
     if (this != &rhs)
     {
+        this->Delete();
         this->elements = rhs.elements;
         this->grow = rhs.grow;
         this->count = rhs.count;
         this->capacity = rhs.capacity;
         rhs.elements = nullptr;
         rhs.count = 0;
-        rhs.capacity;
+        rhs.capacity = 0;
     }
 }
 
@@ -463,7 +464,11 @@ Array<TYPE>::GrowTo(SizeT newCapacity)
     TYPE* newArray = n_new_array(TYPE, newCapacity);
     if (this->elements)
     {
-		this->MoveRange(newArray, this->elements, this->count);
+        // the buffers never overlap, so trivial types can use a plain copy
+        if constexpr (std::is_trivially_copyable<TYPE>::value)
+            Memory::Copy(this->elements, newArray, this->count * sizeof(TYPE));
+        else
+            this->MoveRange(newArray, this->elements, this->count);
 
         // discard old array
 		n_delete_array(this->elements);
@@ -485,20 +490,16 @@ Array<TYPE>::Grow()
     SizeT growToSize;
     if (0 == this->capacity)
     {
-        growToSize = this->grow;
+        growToSize = this->grow > 0 ? this->grow : MinGrowSize;
     }
     else
     {
-        // grow by half of the current capacity, but never more then MaxGrowSize
+        // grow by half of the current capacity, so the number of reallocations stays logarithmic
         SizeT growBy = this->capacity >> 1;
-        if (growBy == 0)
+        if (growBy < MinGrowSize)
         {
             growBy = MinGrowSize;
         }
-        else if (growBy > MaxGrowSize)
-        {
-            growBy = MaxGrowSize;
-        }
         growToSize = this->capacity + growBy;
     }
     this->GrowTo(growToSize);
@@ -541,11 +542,18 @@ Array<TYPE>::Move(IndexT fromIndex, IndexT toIndex)
     }
     else
     {
-        // this is a forward move
-        int i;  // NOTE: this must remain signed for the following loop to work!!!
-        for (i = num - 1; i >= 0; --i)
+        // this is a forward move, walk backwards since the ranges overlap
+        if constexpr (std::is_trivially_copyable<TYPE>::value)
         {
-            this->elements[toIndex + i] = this->elements[fromIndex + i];
+            Memory::Move(&this->elements[fromIndex], &this->elements[toIndex], num * sizeof(TYPE));
+        }
+        else
+        {
+            int i;  // NOTE: this must remain signed for the following loop to work!!!
+            for (i = num - 1; i >= 0; --i)
+            {
+                this->elements[toIndex + i] = std::move(this->elements[fromIndex + i]);
+            }
         }
 
         // destroy freed elements
@@ -639,18 +647,44 @@ Array<TYPE>::Append(const TYPE& elm)
     this->elements[this->count++] = elm;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE> void
+Array<TYPE>::Append(TYPE&& elm)
+{
+    // grow allocated space if exhausted
+    if (this->count == this->capacity)
+    {
+        this->Grow();
+    }
+    #if NEBULA_BOUNDSCHECKS
+    n_assert(this->elements);
+    #endif
+    this->elements[this->count++] = std::move(elm);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
 template<class TYPE> void
 Array<TYPE>::AppendArray(const Array<TYPE>& rhs)
 {
-    IndexT i;
-    SizeT num = rhs.count;
-    for (i = 0; i < num; i++)
+    const SizeT num = rhs.count;
+    if (num == 0)
+    {
+        return;
+    }
+
+    // make room for all elements at once, but keep growing geometrically
+    SizeT neededCapacity = this->count + num;
+    if (neededCapacity > this->capacity)
     {
-        this->Append(rhs[i]);
+        SizeT growToSize = this->capacity + (this->capacity >> 1);
+        this->GrowTo(neededCapacity > growToSize ? neededCapacity : growToSize);
     }
+    this->CopyRange(this->elements + this->count, rhs.elements, num);
+    this->count += num;
 }
 
 //------------------------------------------------------------------------------
@@ -829,7 +863,7 @@ Array<TYPE>::EraseIndexSwap(IndexT index)
     IndexT lastElementIndex = this->count - 1;
     if (index < lastElementIndex)
     {
-        this->elements[index] = this->elements[lastElementIndex];
+        this->elements[index] = std::move(this->elements[lastElementIndex]);
     }
 	if constexpr (!std::is_trivially_destructible<TYPE>::value)
 		this->Destroy(&(this->elements[lastElementIndex]));
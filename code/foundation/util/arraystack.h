@@ -53,6 +53,8 @@ public:
 
     /// append element to end of array
     void Append(const TYPE& elm);
+    /// move element to end of array
+    void Append(TYPE&& elm);
     /// append the contents of an array to this array
     void AppendArray(const ArrayStack<TYPE, STACK_SIZE>& rhs);
     /// increase capacity to fit N more elements into the array
@@ -137,8 +139,7 @@ private:
     void Move(IndexT fromIndex, IndexT toIndex);
 
     static const SizeT MinGrowSize = 16;
-    static const SizeT MaxGrowSize = 65536; // FIXME: big grow size needed for mesh tools
-    SizeT grow;                             // grow by this number of elements if array exhausted
+    SizeT grow;                             // initial number of elements allocated when the array is first grown
     SizeT capacity;                         // number of elements allocated
     SizeT count;                             // number of elements in array
 	TYPE smallVector[STACK_SIZE];
@@ -286,7 +287,7 @@ inline ArrayStack<TYPE, STACK_SIZE>::ArrayStack(ArrayStack<TYPE, STACK_SIZE>&& r
 	{
 		for (IndexT i = 0; i < rhs.count; ++i)
 		{
-			this->smallVector[i] = rhs.smallVector[i];
+			this->smallVector[i] = std::move(rhs.smallVector[i]);
 		}
 
 		this->elements = this->smallVector;
@@ -317,10 +318,17 @@ ArrayStack<TYPE, STACK_SIZE>::Copy(const ArrayStack<TYPE, STACK_SIZE>& src)
 		else
 			this->elements = smallVector;
 
-        IndexT i;
-        for (i = 0; i < this->count; i++)
+        if constexpr (std::is_trivially_copyable<TYPE>::value)
+        {
+            Memory::Copy(src.elements, this->elements, this->count * sizeof(TYPE));
+        }
+        else
         {
-            this->elements[i] = src.elements[i];
+            IndexT i;
+            for (i = 0; i < this->count; i++)
+            {
+                this->elements[i] = src.elements[i];
+            }
         }
     }
 }
@@ -452,11 +460,18 @@ ArrayStack<TYPE, STACK_SIZE>::GrowTo(SizeT newCapacity)
 		TYPE* newArray = n_new_array(TYPE, newCapacity);
 		if (this->elements)
 		{
-			// copy over contents
-			IndexT i;
-			for (i = 0; i < this->count; i++)
+			// move over contents, trivial types are relocated with a plain copy
+			if constexpr (std::is_trivially_copyable<TYPE>::value)
 			{
-				newArray[i] = this->elements[i];
+				Memory::Copy(this->elements, newArray, this->count * sizeof(TYPE));
+			}
+			else
+			{
+				IndexT i;
+				for (i = 0; i < this->count; i++)
+				{
+					newArray[i] = std::move(this->elements[i]);
+				}
 			}
 
 			// discard old array
@@ -482,20 +497,16 @@ ArrayStack<TYPE, STACK_SIZE>::Grow()
     SizeT growToSize;
     if (0 == this->capacity)
     {
-        growToSize = this->grow;
+        growToSize = this->grow > 0 ? this->grow : MinGrowSize;
     }
     else
     {
-        // grow by half of the current capacity, but never more then MaxGrowSize
+        // grow by half of the current capacity, so the number of reallocations stays logarithmic
         SizeT growBy = this->capacity >> 1;
-        if (growBy == 0)
+        if (growBy < MinGrowSize)
         {
             growBy = MinGrowSize;
         }
-        else if (growBy > MaxGrowSize)
-        {
-            growBy = MaxGrowSize;
-        }
         growToSize = this->capacity + growBy;
     }
     this->GrowTo(growToSize);
@@ -536,7 +547,7 @@ ArrayStack<TYPE, STACK_SIZE>::Move(IndexT fromIndex, IndexT toIndex)
         IndexT i;
         for (i = 0; i < num; i++)
         {
-            this->elements[toIndex + i] = this->elements[fromIndex + i];
+            this->elements[toIndex + i] = std::move(this->elements[fromIndex + i]);
         }
 
         // destroy remaining elements
@@ -551,7 +562,7 @@ ArrayStack<TYPE, STACK_SIZE>::Move(IndexT fromIndex, IndexT toIndex)
         int i;  // NOTE: this must remain signed for the following loop to work!!!
         for (i = num - 1; i >= 0; --i)
         {
-            this->elements[toIndex + i] = this->elements[fromIndex + i];
+            this->elements[toIndex + i] = std::move(this->elements[fromIndex + i]);
         }
 
         // destroy freed elements
@@ -582,6 +593,23 @@ ArrayStack<TYPE, STACK_SIZE>::Append(const TYPE& elm)
     this->elements[this->count++] = elm;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE, int STACK_SIZE> void
+ArrayStack<TYPE, STACK_SIZE>::Append(TYPE&& elm)
+{
+    // grow allocated space if exhausted
+    if (this->count == this->capacity)
+    {
+        this->Grow();
+    }
+    #if NEBULA_BOUNDSCHECKS
+    n_assert(this->elements);
+    #endif
+    this->elements[this->count++] = std::move(elm);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -757,7 +785,7 @@ ArrayStack<TYPE, STACK_SIZE>::EraseIndexSwap(IndexT index)
     IndexT lastElementIndex = this->count - 1;
     if (index < lastElementIndex)
     {
-        this->elements[index] = this->elements[lastElementIndex];
+        this->elements[index] = std::move(this->elements[lastElementIndex]);
     }
     this->Destroy(&(this->elements[lastElementIndex]));
     this->count--;
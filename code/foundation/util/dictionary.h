@@ -20,28 +20,54 @@
     Any methods which require the internal array to be sorted will
     throw an assertion between BeginBulkAdd() and EndBulkAdd().
 
+    On lookup policy:
+    With the default DictionarySorted policy the dictionary is a sorted
+    array, which is compact and fast for small dictionaries, but insertion
+    is O(n). With DictionaryHashed<N> the dictionary behaves exactly the
+    same as long as it holds at most N pairs. Once it grows beyond that, the
+    array is no longer kept sorted, and a FlatHashTable from key to array
+    index is built instead, which makes adding, erasing and finding O(1).
+    Erasing then swaps the last pair into the gap, so indices and iteration
+    order are only stable as long as nothing is erased, and the pairs are
+    not returned in key order.
+
     (C) 2006 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file	
 */    
 #include "util/array.h"
 #include "util/keyvaluepair.h"
+#include "util/flathashtable.h"
 
 //------------------------------------------------------------------------------
 namespace Util
 {
-template<class KEYTYPE, class VALUETYPE> class Dictionary
+/// dictionary policy, always keep the key/value pairs sorted
+struct DictionarySorted
+{
+    static const bool Hashed = false;
+    static const SizeT HashThreshold = 0;
+};
+
+/// dictionary policy, use a hash index once the dictionary holds more than THRESHOLD pairs
+template<SizeT THRESHOLD = 16> struct DictionaryHashed
+{
+    static const bool Hashed = true;
+    static const SizeT HashThreshold = THRESHOLD;
+};
+
+template<class KEYTYPE, class VALUETYPE, class POLICY = DictionarySorted> class Dictionary
 {
 public:
     /// default constructor
     Dictionary();
     /// copy constructor
-    Dictionary(const Dictionary<KEYTYPE, VALUETYPE>& rhs);
+    Dictionary(const Dictionary<KEYTYPE, VALUETYPE, POLICY>& rhs);
     /// move constructor
-    Dictionary(Dictionary<KEYTYPE, VALUETYPE>&& rhs);
+    Dictionary(Dictionary<KEYTYPE, VALUETYPE, POLICY>&& rhs);
     /// assignment operator
-    void operator=(const Dictionary<KEYTYPE, VALUETYPE>& rhs);
+    void operator=(const Dictionary<KEYTYPE, VALUETYPE, POLICY>& rhs);
     /// move operator
-    void operator=(Dictionary<KEYTYPE, VALUETYPE>&& rhs);
+    void operator=(Dictionary<KEYTYPE, VALUETYPE, POLICY>&& rhs);
     /// read/write [] operator
     VALUETYPE& operator[](const KEYTYPE& key);
     /// read-only [] operator
@@ -65,7 +91,7 @@ public:
     /// end a bulk insert (this will sort the internal array)
     void EndBulkAdd();
 	/// merge two dictionaries
-	void Merge(const Dictionary<KEYTYPE, VALUETYPE>& rhs);
+	void Merge(const Dictionary<KEYTYPE, VALUETYPE, POLICY>& rhs);
     /// erase a key and its associated value
     void Erase(const KEYTYPE& key);
     /// erase a key at index
@@ -102,16 +128,24 @@ public:
 protected:
     /// make sure the key value pair array is sorted
     void SortIfDirty() const;
+    /// returns true if lookups go through the hash index
+    bool IsIndexed() const;
+    /// build the hash index from the key/value pair array
+    void BuildIndex();
+
+    /// empty stand-in for the hash index of sorted dictionaries
+    struct NoIndex {};
 
     Array<KeyValuePair<KEYTYPE, VALUETYPE> > keyValuePairs;
+    typename std::conditional<POLICY::Hashed, FlatHashTable<KEYTYPE, IndexT>, NoIndex>::type index;
     bool inBulkInsert;
 };
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
-Dictionary<KEYTYPE, VALUETYPE>::Dictionary() :
+template<class KEYTYPE, class VALUETYPE, class POLICY>
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Dictionary() :
     inBulkInsert(false)
 {
     // empty
@@ -120,9 +154,10 @@ Dictionary<KEYTYPE, VALUETYPE>::Dictionary() :
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
-Dictionary<KEYTYPE, VALUETYPE>::Dictionary(const Dictionary<KEYTYPE, VALUETYPE>& rhs) :
+template<class KEYTYPE, class VALUETYPE, class POLICY>
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Dictionary(const Dictionary<KEYTYPE, VALUETYPE, POLICY>& rhs) :
     keyValuePairs(rhs.keyValuePairs),
+    index(rhs.index),
     inBulkInsert(false)
 {
     #if NEBULA_BOUNDSCHECKS
@@ -133,9 +168,10 @@ Dictionary<KEYTYPE, VALUETYPE>::Dictionary(const Dictionary<KEYTYPE, VALUETYPE>&
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
-Dictionary<KEYTYPE, VALUETYPE>::Dictionary(Dictionary<KEYTYPE, VALUETYPE>&& rhs) :
+template<class KEYTYPE, class VALUETYPE, class POLICY>
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Dictionary(Dictionary<KEYTYPE, VALUETYPE, POLICY>&& rhs) :
     keyValuePairs(std::move(rhs.keyValuePairs)),
+    index(std::move(rhs.index)),
     inBulkInsert(false)
 {
 #if NEBULA_BOUNDSCHECKS
@@ -146,50 +182,54 @@ Dictionary<KEYTYPE, VALUETYPE>::Dictionary(Dictionary<KEYTYPE, VALUETYPE>&& rhs)
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::operator=(const Dictionary<KEYTYPE, VALUETYPE>& rhs)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::operator=(const Dictionary<KEYTYPE, VALUETYPE, POLICY>& rhs)
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
     n_assert(!rhs.inBulkInsert);
     #endif
     this->keyValuePairs = rhs.keyValuePairs;
+    this->index = rhs.index;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::operator=(Dictionary<KEYTYPE, VALUETYPE>&& rhs)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::operator=(Dictionary<KEYTYPE, VALUETYPE, POLICY>&& rhs)
 {
 #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
     n_assert(!rhs.inBulkInsert);
 #endif
-    this->keyValuePairs = std::move(rhs.keyValuePairs);   
+    this->keyValuePairs = std::move(rhs.keyValuePairs);
+    this->index = std::move(rhs.index);
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::Clear()
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Clear()
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
     #endif
     this->keyValuePairs.Clear();
+    if constexpr (POLICY::Hashed)
+        this->index.Reset();
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline SizeT
-Dictionary<KEYTYPE, VALUETYPE>::Size() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Size() const
 {
     return this->keyValuePairs.Size();
 }
@@ -197,9 +237,9 @@ Dictionary<KEYTYPE, VALUETYPE>::Size() const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline bool
-Dictionary<KEYTYPE, VALUETYPE>::IsEmpty() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::IsEmpty() const
 {
     return (0 == this->keyValuePairs.Size());
 }
@@ -207,19 +247,24 @@ Dictionary<KEYTYPE, VALUETYPE>::IsEmpty() const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::Reserve(SizeT numElements)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Reserve(SizeT numElements)
 {
     this->keyValuePairs.Reserve(numElements);
+    if constexpr (POLICY::Hashed)
+    {
+        if (this->keyValuePairs.Size() + numElements > POLICY::HashThreshold)
+            this->index.Reserve(this->keyValuePairs.Size() + numElements);
+    }
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::BeginBulkAdd()
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::BeginBulkAdd()
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
@@ -230,23 +275,66 @@ Dictionary<KEYTYPE, VALUETYPE>::BeginBulkAdd()
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::EndBulkAdd()
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::EndBulkAdd()
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(this->inBulkInsert);
     #endif
+    if constexpr (POLICY::Hashed)
+    {
+        if (this->IsIndexed() || this->keyValuePairs.Size() > POLICY::HashThreshold)
+        {
+            this->BuildIndex();
+            this->inBulkInsert = false;
+            return;
+        }
+    }
     this->keyValuePairs.Sort();
     this->inBulkInsert = false;
 }
 
+//------------------------------------------------------------------------------
+/**
+    A hashed dictionary stays indexed once the index has been built, even
+    if pairs are erased again, since the array is no longer sorted.
+*/
+template<class KEYTYPE, class VALUETYPE, class POLICY>
+inline bool
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::IsIndexed() const
+{
+    if constexpr (POLICY::Hashed)
+        return !this->index.IsEmpty();
+    else
+        return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE, class POLICY>
+inline void
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::BuildIndex()
+{
+    if constexpr (POLICY::Hashed)
+    {
+        this->index.Reset();
+        this->index.Reserve(this->keyValuePairs.Size());
+        IndexT i;
+        for (i = 0; i < this->keyValuePairs.Size(); i++)
+        {
+            this->index.Add(this->keyValuePairs[i].Key(), i);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::Merge(const Dictionary<KEYTYPE, VALUETYPE>& rhs)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Merge(const Dictionary<KEYTYPE, VALUETYPE, POLICY>& rhs)
 {
 	this->BeginBulkAdd();
 	IndexT i;
@@ -261,45 +349,48 @@ Dictionary<KEYTYPE, VALUETYPE>::Merge(const Dictionary<KEYTYPE, VALUETYPE>& rhs)
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::Add(const KeyValuePair<KEYTYPE, VALUETYPE>& kvp)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Add(const KeyValuePair<KEYTYPE, VALUETYPE>& kvp)
 {
 	if (this->inBulkInsert)
 	{
 		this->keyValuePairs.Append(kvp);
 	}
+	else if (this->IsIndexed())
+	{
+		this->keyValuePairs.Append(kvp);
+		if constexpr (POLICY::Hashed)
+			this->index.Add(kvp.Key(), this->keyValuePairs.Size() - 1);
+	}
 	else
 	{
 		this->keyValuePairs.InsertSorted(kvp);
+		if constexpr (POLICY::Hashed)
+		{
+			if (this->keyValuePairs.Size() > POLICY::HashThreshold)
+				this->BuildIndex();
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::Add(const KEYTYPE& key, const VALUETYPE& value)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Add(const KEYTYPE& key, const VALUETYPE& value)
 {
     //n_assert(!this->Contains(key));
-    KeyValuePair<KEYTYPE, VALUETYPE> kvp(key, value);
-    if (this->inBulkInsert)
-    {
-        this->keyValuePairs.Append(kvp);
-    }
-    else
-    {
-        this->keyValuePairs.InsertSorted(kvp);
-    }
+    this->Add(KeyValuePair<KEYTYPE, VALUETYPE>(key, value));
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline VALUETYPE&
-Dictionary<KEYTYPE, VALUETYPE>::AddUnique(const KEYTYPE& key)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::AddUnique(const KEYTYPE& key)
 {
 	IndexT i = this->FindIndex(key);
 	if (i == InvalidIndex)
@@ -316,79 +407,101 @@ Dictionary<KEYTYPE, VALUETYPE>::AddUnique(const KEYTYPE& key)
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::Erase(const KEYTYPE& key)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Erase(const KEYTYPE& key)
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
     #endif
-    IndexT eraseIndex = this->keyValuePairs.BinarySearchIndex(key);
+    IndexT eraseIndex = this->FindIndex(key);
     #if NEBULA_BOUNDSCHECKS
     n_assert(InvalidIndex != eraseIndex);
     #endif
-    this->keyValuePairs.EraseIndex(eraseIndex);
+    this->EraseAtIndex(eraseIndex);
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::EraseAtIndex(IndexT index)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::EraseAtIndex(IndexT index)
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
     #endif
-    this->keyValuePairs.EraseIndex(index);
+    if (this->IsIndexed())
+    {
+        // the last pair takes the place of the erased one
+        if constexpr (POLICY::Hashed)
+        {
+            this->index.Erase(this->keyValuePairs[index].Key());
+            this->keyValuePairs.EraseIndexSwap(index);
+            if (index < this->keyValuePairs.Size())
+                this->index[this->keyValuePairs[index].Key()] = index;
+        }
+    }
+    else
+    {
+        this->keyValuePairs.EraseIndex(index);
+    }
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline IndexT
-Dictionary<KEYTYPE, VALUETYPE>::FindIndex(const KEYTYPE& key) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::FindIndex(const KEYTYPE& key) const
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
     #endif
+    if (this->IsIndexed())
+    {
+        if constexpr (POLICY::Hashed)
+        {
+            IndexT slot = this->index.FindIndex(key);
+            return slot != InvalidIndex ? this->index.ValueAtIndex(key, slot) : InvalidIndex;
+        }
+    }
     return this->keyValuePairs.BinarySearchIndex(key);
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline bool
-Dictionary<KEYTYPE, VALUETYPE>::Contains(const KEYTYPE& key) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Contains(const KEYTYPE& key) const
 {
 	#if NEBULA_BOUNDSCHECKS
 	n_assert(!this->inBulkInsert);
 	#endif
-    return (InvalidIndex != this->keyValuePairs.BinarySearchIndex(key));
+    return (InvalidIndex != this->FindIndex(key));
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline bool
-Dictionary<KEYTYPE, VALUETYPE>::Contains(const KEYTYPE& key, IndexT& index) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::Contains(const KEYTYPE& key, IndexT& index) const
 {
 #if NEBULA_BOUNDSCHECKS
 	n_assert(!this->inBulkInsert);
 #endif
-	index = this->keyValuePairs.BinarySearchIndex(key);
+	index = this->FindIndex(key);
 	return (InvalidIndex != index);
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline const KEYTYPE&
-Dictionary<KEYTYPE, VALUETYPE>::KeyAtIndex(IndexT index) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::KeyAtIndex(IndexT index) const
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
@@ -399,9 +512,9 @@ Dictionary<KEYTYPE, VALUETYPE>::KeyAtIndex(IndexT index) const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline VALUETYPE&
-Dictionary<KEYTYPE, VALUETYPE>::ValueAtIndex(IndexT index)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::ValueAtIndex(IndexT index)
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
@@ -412,9 +525,9 @@ Dictionary<KEYTYPE, VALUETYPE>::ValueAtIndex(IndexT index)
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline const VALUETYPE&
-Dictionary<KEYTYPE, VALUETYPE>::ValueAtIndex(IndexT index) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::ValueAtIndex(IndexT index) const
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
@@ -425,9 +538,9 @@ Dictionary<KEYTYPE, VALUETYPE>::ValueAtIndex(IndexT index) const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline KeyValuePair<KEYTYPE, VALUETYPE>&
-Dictionary<KEYTYPE, VALUETYPE>::KeyValuePairAtIndex(IndexT index) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::KeyValuePairAtIndex(IndexT index) const
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
@@ -438,9 +551,9 @@ Dictionary<KEYTYPE, VALUETYPE>::KeyValuePairAtIndex(IndexT index) const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline VALUETYPE&
-Dictionary<KEYTYPE, VALUETYPE>::operator[](const KEYTYPE& key)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::operator[](const KEYTYPE& key)
 {
     int keyValuePairIndex = this->FindIndex(key);
     #if NEBULA_BOUNDSCHECKS
@@ -452,9 +565,9 @@ Dictionary<KEYTYPE, VALUETYPE>::operator[](const KEYTYPE& key)
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 inline const VALUETYPE&
-Dictionary<KEYTYPE, VALUETYPE>::operator[](const KEYTYPE& key) const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::operator[](const KEYTYPE& key) const
 {
     int keyValuePairIndex = this->FindIndex(key);
     #if NEBULA_BOUNDSCHECKS
@@ -466,10 +579,10 @@ Dictionary<KEYTYPE, VALUETYPE>::operator[](const KEYTYPE& key) const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 template<class RETURNTYPE>
 RETURNTYPE
-Dictionary<KEYTYPE, VALUETYPE>::ValuesAs() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::ValuesAs() const
 {
     #if NEBULA_BOUNDSCHECKS
     n_assert(!this->inBulkInsert);
@@ -486,9 +599,9 @@ Dictionary<KEYTYPE, VALUETYPE>::ValuesAs() const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline Array<VALUETYPE>
-Dictionary<KEYTYPE, VALUETYPE>::ValuesAsArray() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::ValuesAsArray() const
 {
     return this->ValuesAs<Array<VALUETYPE> >();
 }
@@ -496,10 +609,10 @@ Dictionary<KEYTYPE, VALUETYPE>::ValuesAsArray() const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE> 
+template<class KEYTYPE, class VALUETYPE, class POLICY> 
 template<class RETURNTYPE>
 inline RETURNTYPE
-Dictionary<KEYTYPE, VALUETYPE>::KeysAs() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::KeysAs() const
 {
     #if NEBULA_BOUNDSCHECKS    
     n_assert(!this->inBulkInsert);
@@ -516,9 +629,9 @@ Dictionary<KEYTYPE, VALUETYPE>::KeysAs() const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline Array<KEYTYPE>
-Dictionary<KEYTYPE, VALUETYPE>::KeysAsArray() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::KeysAsArray() const
 {
     return this->KeysAs<Array<KEYTYPE> >();
 }
@@ -526,36 +639,36 @@ Dictionary<KEYTYPE, VALUETYPE>::KeysAsArray() const
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline KeyValuePair<KEYTYPE, VALUETYPE>*
-Dictionary<KEYTYPE, VALUETYPE>::begin() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::begin() const
 {
     return this->keyValuePairs.begin();
 }
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline KeyValuePair<KEYTYPE, VALUETYPE>*
-Dictionary<KEYTYPE, VALUETYPE>::end() const
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::end() const
 {
     return this->keyValuePairs.end();
 }
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::clear()
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::clear()
 {
     this->Clear();
 }
 //------------------------------------------------------------------------------
 /**
 */
-template<class KEYTYPE, class VALUETYPE>
+template<class KEYTYPE, class VALUETYPE, class POLICY>
 inline void
-Dictionary<KEYTYPE, VALUETYPE>::emplace(KEYTYPE&&key, VALUETYPE&&value)
+Dictionary<KEYTYPE, VALUETYPE, POLICY>::emplace(KEYTYPE&&key, VALUETYPE&&value)
 {
     this->Add(key, value);
 }
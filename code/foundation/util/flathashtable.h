@@ -0,0 +1,920 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	@class Util::FlatHashTable
+
+	Open addressing hash table with the same interface as Util::HashTable.
+
+	Util::HashTable uses a fixed number of buckets which is chosen at compile
+	time and never rehashes, so lookups degrade to a linear search through
+	the bucket once the number of elements is much larger than the table size.
+	The FlatHashTable grows with the number of elements instead, and keeps
+	all key/value pairs in a single flat array.
+
+	Slots are organized in groups of 16. Every slot has a control byte, which
+	is either empty, deleted, or contains 7 bits of the key's hash. A lookup
+	compares the control bytes of a whole group against the hash using SSE2
+	where available, or one byte at a time otherwise, and only compares keys for the slots that match. Groups are probed
+	quadratically until a group with an empty slot is found. The table grows
+	when it is 7/8 full.
+
+	Integer and pointer keys are hashed directly, other key types must
+	implement IndexT HashCode() const like for Util::HashTable. All hashes
+	are run through a bit mixer, so sequential ids are spread evenly.
+
+	Unlike Util::HashTable, adding or erasing elements may move other
+	elements, which invalidates references, iterators and indices returned
+	by FindIndex. Bulk adding is supported for compatibility, but does
+	nothing.
+
+	(C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include "util/array.h"
+#include "util/keyvaluepair.h"
+#include "memory/memory.h"
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NEBULA_FLATHASHTABLE_SSE2 1
+#include <emmintrin.h>
+#else
+#define NEBULA_FLATHASHTABLE_SSE2 0
+#endif
+#if __WIN32__
+#include <intrin.h>
+#endif
+#include <type_traits>
+#include <new>
+#include <utility>
+
+//------------------------------------------------------------------------------
+namespace Util
+{
+template<class KEYTYPE, class VALUETYPE> class FlatHashTable
+{
+public:
+	/// default constructor
+	FlatHashTable();
+	/// copy constructor
+	FlatHashTable(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs);
+	/// move constructor
+	FlatHashTable(FlatHashTable<KEYTYPE, VALUETYPE>&& rhs);
+	/// destructor
+	~FlatHashTable();
+	/// assignment operator
+	void operator=(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs);
+	/// move assignment operator
+	void operator=(FlatHashTable<KEYTYPE, VALUETYPE>&& rhs);
+	/// read/write [] operator, assertion if key not found
+	VALUETYPE& operator[](const KEYTYPE& key) const;
+	/// return current number of values in the hashtable
+	SizeT Size() const;
+	/// return the current number of slots
+	SizeT Capacity() const;
+	/// make room for at least num elements without growing
+	void Reserve(SizeT num);
+	/// clear the hashtable and free its memory
+	void Clear();
+	/// remove all elements but keep the memory
+	void Reset();
+	/// return true if empty
+	bool IsEmpty() const;
+	/// does nothing, provided for compatibility with Util::HashTable
+	void BeginBulkAdd();
+	/// always returns false, provided for compatibility with Util::HashTable
+	bool IsBulkAdd() const;
+	/// add a key/value pair object to the hash table, returns the slot where the item is stored
+	IndexT Add(const KeyValuePair<KEYTYPE, VALUETYPE>& kvp);
+	/// add a key and associated value
+	IndexT Add(const KEYTYPE& key, const VALUETYPE& value);
+	/// adds element only if it doesn't exist, and return reference to it
+	VALUETYPE& AddUnique(const KEYTYPE& key);
+	/// does nothing, provided for compatibility with Util::HashTable
+	void EndBulkAdd();
+	/// merge two hash tables
+	void Merge(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs);
+	/// erase an entry
+	void Erase(const KEYTYPE& key);
+	/// erase an entry with known slot
+	void EraseIndex(const KEYTYPE& key, IndexT i);
+	/// return true if key exists in the table
+	bool Contains(const KEYTYPE& key) const;
+	/// find the slot of a key, returns InvalidIndex if not found
+	IndexT FindIndex(const KEYTYPE& key) const;
+	/// get value from key and slot
+	VALUETYPE& ValueAtIndex(const KEYTYPE& key, IndexT i) const;
+	/// return array of all key/value pairs in the table
+	Array<KeyValuePair<KEYTYPE, VALUETYPE>> Content() const;
+	/// get all keys as an Util::Array
+	Array<KEYTYPE> KeysAsArray() const;
+	/// get all values as an Util::Array
+	Array<VALUETYPE> ValuesAsArray() const;
+
+	class Iterator
+	{
+	public:
+
+		/// progress to next item in the hash table
+		Iterator& operator++(int);
+		/// check if iterator is identical
+		bool operator==(const Iterator& rhs) const;
+		/// check if iterator is identical
+		bool operator!=(const Iterator& rhs) const;
+
+		/// the current value
+		VALUETYPE* val;
+		KEYTYPE const* key;
+	private:
+		friend class FlatHashTable<KEYTYPE, VALUETYPE>;
+		/// point to the slot or the next occupied slot after it
+		void Seek(IndexT slot);
+		const FlatHashTable<KEYTYPE, VALUETYPE>* table;
+		IndexT slot;
+	};
+
+	/// get iterator to first element
+	Iterator Begin();
+	/// get iterator past the last element
+	Iterator End();
+
+private:
+	static const SizeT GroupSize = 16;
+	static const int8_t Empty = -128;
+	static const int8_t Deleted = -2;
+
+	/// hash a key, integers and pointers are used directly
+	static uint64_t Hash(const KEYTYPE& key);
+	/// mix the bits of a hash
+	static uint64_t Mix(uint64_t h);
+	/// returns a bit mask of the slots in a group whose control byte matches
+	static uint MatchByte(const int8_t* group, int8_t byte);
+	/// returns a bit mask of the slots in a group which are empty or deleted
+	static uint MatchFree(const int8_t* group);
+	/// index of the lowest set bit
+	static uint LowestBit(uint mask);
+
+	/// find the slot of a key with known hash
+	IndexT Find(const KEYTYPE& key, uint64_t hash) const;
+	/// find a free slot for a hash, the key must not exist
+	IndexT FindFree(uint64_t hash) const;
+	/// insert a key which doesn't exist, returns the slot
+	IndexT Insert(const KEYTYPE& key, uint64_t hash);
+	/// erase the element in a slot
+	void EraseSlot(IndexT slot);
+	/// reallocate to a new capacity and reinsert all elements
+	void Rehash(SizeT newCapacity);
+	/// destroy all elements and free the memory
+	void Destroy();
+	/// copy all elements from another table
+	void CopyFrom(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs);
+
+	int8_t* ctrl;
+	KeyValuePair<KEYTYPE, VALUETYPE>* slots;
+	SizeT capacity;
+	SizeT size;
+	/// number of empty slots that may still be used before the table has to grow
+	SizeT growthLeft;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+FlatHashTable<KEYTYPE, VALUETYPE>::FlatHashTable() :
+	ctrl(nullptr),
+	slots(nullptr),
+	capacity(0),
+	size(0),
+	growthLeft(0)
+{
+	// empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+FlatHashTable<KEYTYPE, VALUETYPE>::FlatHashTable(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs) :
+	ctrl(nullptr),
+	slots(nullptr),
+	capacity(0),
+	size(0),
+	growthLeft(0)
+{
+	this->CopyFrom(rhs);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+FlatHashTable<KEYTYPE, VALUETYPE>::FlatHashTable(FlatHashTable<KEYTYPE, VALUETYPE>&& rhs) :
+	ctrl(rhs.ctrl),
+	slots(rhs.slots),
+	capacity(rhs.capacity),
+	size(rhs.size),
+	growthLeft(rhs.growthLeft)
+{
+	rhs.ctrl = nullptr;
+	rhs.slots = nullptr;
+	rhs.capacity = 0;
+	rhs.size = 0;
+	rhs.growthLeft = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+FlatHashTable<KEYTYPE, VALUETYPE>::~FlatHashTable()
+{
+	this->Destroy();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::operator=(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs)
+{
+	if (this != &rhs)
+	{
+		this->Destroy();
+		this->CopyFrom(rhs);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::operator=(FlatHashTable<KEYTYPE, VALUETYPE>&& rhs)
+{
+	if (this != &rhs)
+	{
+		this->Destroy();
+		this->ctrl = rhs.ctrl;
+		this->slots = rhs.slots;
+		this->capacity = rhs.capacity;
+		this->size = rhs.size;
+		this->growthLeft = rhs.growthLeft;
+		rhs.ctrl = nullptr;
+		rhs.slots = nullptr;
+		rhs.capacity = 0;
+		rhs.size = 0;
+		rhs.growthLeft = 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+VALUETYPE&
+FlatHashTable<KEYTYPE, VALUETYPE>::operator[](const KEYTYPE& key) const
+{
+	IndexT slot = this->Find(key, Hash(key));
+	n_assert(slot != InvalidIndex);
+	return this->slots[slot].Value();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+SizeT
+FlatHashTable<KEYTYPE, VALUETYPE>::Size() const
+{
+	return this->size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+SizeT
+FlatHashTable<KEYTYPE, VALUETYPE>::Capacity() const
+{
+	return this->capacity;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Reserve(SizeT num)
+{
+	// keep the load factor below 7/8
+	SizeT needed = num + num / 7 + 1;
+	if (needed - this->size <= this->growthLeft)
+		return;
+
+	SizeT newCapacity = GroupSize;
+	while (newCapacity < needed)
+		newCapacity *= 2;
+	this->Rehash(newCapacity);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Clear()
+{
+	this->Destroy();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Reset()
+{
+	IndexT i;
+	for (i = 0; i < this->capacity; i++)
+	{
+		if (this->ctrl[i] >= 0)
+			this->slots[i].~KeyValuePair<KEYTYPE, VALUETYPE>();
+	}
+	if (this->capacity > 0)
+		Memory::Fill(this->ctrl, this->capacity, (unsigned char)Empty);
+	this->size = 0;
+	this->growthLeft = this->capacity - this->capacity / 8;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+bool
+FlatHashTable<KEYTYPE, VALUETYPE>::IsEmpty() const
+{
+	return this->size == 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::BeginBulkAdd()
+{
+	// empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+bool
+FlatHashTable<KEYTYPE, VALUETYPE>::IsBulkAdd() const
+{
+	return false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::EndBulkAdd()
+{
+	// empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+IndexT
+FlatHashTable<KEYTYPE, VALUETYPE>::Add(const KeyValuePair<KEYTYPE, VALUETYPE>& kvp)
+{
+	return this->Add(kvp.Key(), kvp.Value());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+IndexT
+FlatHashTable<KEYTYPE, VALUETYPE>::Add(const KEYTYPE& key, const VALUETYPE& value)
+{
+	const uint64_t hash = Hash(key);
+	n_assert2(this->Find(key, hash) == InvalidIndex, "Key already exists in hash table!");
+	IndexT slot = this->Insert(key, hash);
+	this->slots[slot].Value() = value;
+	return slot;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+VALUETYPE&
+FlatHashTable<KEYTYPE, VALUETYPE>::AddUnique(const KEYTYPE& key)
+{
+	const uint64_t hash = Hash(key);
+	IndexT slot = this->Find(key, hash);
+	if (slot == InvalidIndex)
+		slot = this->Insert(key, hash);
+	return this->slots[slot].Value();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Merge(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs)
+{
+	this->Reserve(this->size + rhs.size);
+	IndexT i;
+	for (i = 0; i < rhs.capacity; i++)
+	{
+		if (rhs.ctrl[i] >= 0)
+			this->AddUnique(rhs.slots[i].Key()) = rhs.slots[i].Value();
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Erase(const KEYTYPE& key)
+{
+	IndexT slot = this->Find(key, Hash(key));
+	n_assert(slot != InvalidIndex);
+	this->EraseSlot(slot);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::EraseIndex(const KEYTYPE& key, IndexT i)
+{
+	n_assert(i >= 0 && i < this->capacity && this->ctrl[i] >= 0);
+	n_assert(this->slots[i].Key() == key);
+	this->EraseSlot(i);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+bool
+FlatHashTable<KEYTYPE, VALUETYPE>::Contains(const KEYTYPE& key) const
+{
+	return this->Find(key, Hash(key)) != InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+IndexT
+FlatHashTable<KEYTYPE, VALUETYPE>::FindIndex(const KEYTYPE& key) const
+{
+	return this->Find(key, Hash(key));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+VALUETYPE&
+FlatHashTable<KEYTYPE, VALUETYPE>::ValueAtIndex(const KEYTYPE& key, IndexT i) const
+{
+	n_assert(i >= 0 && i < this->capacity && this->ctrl[i] >= 0);
+	n_assert(this->slots[i].Key() == key);
+	return this->slots[i].Value();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+Array<KeyValuePair<KEYTYPE, VALUETYPE>>
+FlatHashTable<KEYTYPE, VALUETYPE>::Content() const
+{
+	Array<KeyValuePair<KEYTYPE, VALUETYPE>> res;
+	res.Reserve(this->size);
+	IndexT i;
+	for (i = 0; i < this->capacity; i++)
+	{
+		if (this->ctrl[i] >= 0)
+			res.Append(this->slots[i]);
+	}
+	return res;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+Array<KEYTYPE>
+FlatHashTable<KEYTYPE, VALUETYPE>::KeysAsArray() const
+{
+	Array<KEYTYPE> res;
+	res.Reserve(this->size);
+	IndexT i;
+	for (i = 0; i < this->capacity; i++)
+	{
+		if (this->ctrl[i] >= 0)
+			res.Append(this->slots[i].Key());
+	}
+	return res;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+Array<VALUETYPE>
+FlatHashTable<KEYTYPE, VALUETYPE>::ValuesAsArray() const
+{
+	Array<VALUETYPE> res;
+	res.Reserve(this->size);
+	IndexT i;
+	for (i = 0; i < this->capacity; i++)
+	{
+		if (this->ctrl[i] >= 0)
+			res.Append(this->slots[i].Value());
+	}
+	return res;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+typename FlatHashTable<KEYTYPE, VALUETYPE>::Iterator
+FlatHashTable<KEYTYPE, VALUETYPE>::Begin()
+{
+	Iterator ret;
+	ret.table = this;
+	ret.Seek(0);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+typename FlatHashTable<KEYTYPE, VALUETYPE>::Iterator
+FlatHashTable<KEYTYPE, VALUETYPE>::End()
+{
+	Iterator ret;
+	ret.table = this;
+	ret.Seek(this->capacity);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Iterator::Seek(IndexT i)
+{
+	while (i < this->table->capacity && this->table->ctrl[i] < 0)
+		i++;
+	this->slot = i;
+	if (i < this->table->capacity)
+	{
+		this->key = &this->table->slots[i].Key();
+		this->val = &this->table->slots[i].Value();
+	}
+	else
+	{
+		this->key = nullptr;
+		this->val = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+typename FlatHashTable<KEYTYPE, VALUETYPE>::Iterator&
+FlatHashTable<KEYTYPE, VALUETYPE>::Iterator::operator++(int)
+{
+	n_assert(this->slot < this->table->capacity);
+	this->Seek(this->slot + 1);
+	return *this;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+bool
+FlatHashTable<KEYTYPE, VALUETYPE>::Iterator::operator==(const Iterator& rhs) const
+{
+	return this->table == rhs.table && this->slot == rhs.slot;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+bool
+FlatHashTable<KEYTYPE, VALUETYPE>::Iterator::operator!=(const Iterator& rhs) const
+{
+	return this->table != rhs.table || this->slot != rhs.slot;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Final mixer of MurmurHash3, every input bit affects every output bit.
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline uint64_t
+FlatHashTable<KEYTYPE, VALUETYPE>::Mix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline uint64_t
+FlatHashTable<KEYTYPE, VALUETYPE>::Hash(const KEYTYPE& key)
+{
+	if constexpr (std::is_integral<KEYTYPE>::value || std::is_enum<KEYTYPE>::value)
+		return Mix((uint64_t)key);
+	else if constexpr (std::is_pointer<KEYTYPE>::value)
+		return Mix((uint64_t)PtrT(key));
+	else
+		return Mix((uint64_t)(uint)key.HashCode());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline uint
+FlatHashTable<KEYTYPE, VALUETYPE>::MatchByte(const int8_t* group, int8_t byte)
+{
+#if NEBULA_FLATHASHTABLE_SSE2
+	__m128i ctrlBytes = _mm_loadu_si128((const __m128i*)group);
+	return (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrlBytes, _mm_set1_epi8(byte)));
+#else
+	uint mask = 0;
+	IndexT i;
+	for (i = 0; i < GroupSize; i++)
+		mask |= (uint)(group[i] == byte) << i;
+	return mask;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+	Empty and deleted are the only control bytes with the sign bit set.
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline uint
+FlatHashTable<KEYTYPE, VALUETYPE>::MatchFree(const int8_t* group)
+{
+#if NEBULA_FLATHASHTABLE_SSE2
+	__m128i ctrlBytes = _mm_loadu_si128((const __m128i*)group);
+	return (uint)_mm_movemask_epi8(ctrlBytes);
+#else
+	uint mask = 0;
+	IndexT i;
+	for (i = 0; i < GroupSize; i++)
+		mask |= (uint)(group[i] < 0) << i;
+	return mask;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline uint
+FlatHashTable<KEYTYPE, VALUETYPE>::LowestBit(uint mask)
+{
+	n_assert(mask != 0);
+#if __WIN32__
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (uint)index;
+#else
+	return (uint)__builtin_ctz(mask);
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+	The low 7 bits of the hash are stored in the control byte, the rest
+	selects the first group to probe.
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE>::Find(const KEYTYPE& key, uint64_t hash) const
+{
+	if (this->size == 0)
+		return InvalidIndex;
+
+	const int8_t h2 = (int8_t)(hash & 0x7F);
+	const SizeT groupMask = this->capacity / GroupSize - 1;
+	SizeT group = (SizeT)(hash >> 7) & groupMask;
+	SizeT probe;
+	for (probe = 0; probe <= groupMask; probe++)
+	{
+		const int8_t* groupCtrl = this->ctrl + group * GroupSize;
+		uint mask = MatchByte(groupCtrl, h2);
+		while (mask != 0)
+		{
+			IndexT slot = group * GroupSize + LowestBit(mask);
+			if (this->slots[slot].Key() == key)
+				return slot;
+			mask &= mask - 1;
+		}
+
+		// a group with an empty slot ends the probe sequence
+		if (MatchByte(groupCtrl, Empty) != 0)
+			return InvalidIndex;
+
+		group = (group + probe + 1) & groupMask;
+	}
+	return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE>::FindFree(uint64_t hash) const
+{
+	const SizeT groupMask = this->capacity / GroupSize - 1;
+	SizeT group = (SizeT)(hash >> 7) & groupMask;
+	SizeT probe;
+	for (probe = 0; probe <= groupMask; probe++)
+	{
+		uint mask = MatchFree(this->ctrl + group * GroupSize);
+		if (mask != 0)
+			return group * GroupSize + LowestBit(mask);
+		group = (group + probe + 1) & groupMask;
+	}
+	n_error("FlatHashTable: no free slot found, table is corrupt!");
+	return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline IndexT
+FlatHashTable<KEYTYPE, VALUETYPE>::Insert(const KEYTYPE& key, uint64_t hash)
+{
+	if (this->capacity == 0)
+		this->Rehash(GroupSize);
+
+	IndexT slot = this->FindFree(hash);
+	if (this->growthLeft == 0 && this->ctrl[slot] == Empty)
+	{
+		// if most of the used slots are tombstones, cleaning them up is enough
+		if (this->size * 2 < this->capacity - this->capacity / 8)
+			this->Rehash(this->capacity);
+		else
+			this->Rehash(this->capacity * 2);
+		slot = this->FindFree(hash);
+	}
+
+	if (this->ctrl[slot] == Empty)
+		this->growthLeft--;
+	this->ctrl[slot] = (int8_t)(hash & 0x7F);
+	new (&this->slots[slot]) KeyValuePair<KEYTYPE, VALUETYPE>(key);
+	this->size++;
+	return slot;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Probing only continues past groups without empty slots. If the group
+	already has an empty slot, no probe sequence can pass through it, so
+	the slot can be marked empty again instead of leaving a tombstone.
+*/
+template<class KEYTYPE, class VALUETYPE>
+inline void
+FlatHashTable<KEYTYPE, VALUETYPE>::EraseSlot(IndexT slot)
+{
+	this->slots[slot].~KeyValuePair<KEYTYPE, VALUETYPE>();
+	const int8_t* groupCtrl = this->ctrl + (slot / GroupSize) * GroupSize;
+	if (MatchByte(groupCtrl, Empty) != 0)
+	{
+		this->ctrl[slot] = Empty;
+		this->growthLeft++;
+	}
+	else
+	{
+		this->ctrl[slot] = Deleted;
+	}
+	this->size--;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Rehash(SizeT newCapacity)
+{
+	n_assert(newCapacity >= GroupSize && (newCapacity & (newCapacity - 1)) == 0);
+	int8_t* oldCtrl = this->ctrl;
+	KeyValuePair<KEYTYPE, VALUETYPE>* oldSlots = this->slots;
+	const SizeT oldCapacity = this->capacity;
+
+	this->ctrl = (int8_t*)Memory::Alloc(Memory::ObjectArrayHeap, newCapacity);
+	this->slots = (KeyValuePair<KEYTYPE, VALUETYPE>*)Memory::Alloc(Memory::ObjectArrayHeap, newCapacity * sizeof(KeyValuePair<KEYTYPE, VALUETYPE>));
+	Memory::Fill(this->ctrl, newCapacity, (unsigned char)Empty);
+	this->capacity = newCapacity;
+	this->growthLeft = newCapacity - newCapacity / 8 - this->size;
+
+	IndexT i;
+	for (i = 0; i < oldCapacity; i++)
+	{
+		if (oldCtrl[i] >= 0)
+		{
+			const uint64_t hash = Hash(oldSlots[i].Key());
+			IndexT slot = this->FindFree(hash);
+			this->ctrl[slot] = (int8_t)(hash & 0x7F);
+			new (&this->slots[slot]) KeyValuePair<KEYTYPE, VALUETYPE>(std::move(oldSlots[i]));
+			oldSlots[i].~KeyValuePair<KEYTYPE, VALUETYPE>();
+		}
+	}
+
+	if (oldCtrl != nullptr)
+	{
+		Memory::Free(Memory::ObjectArrayHeap, oldCtrl);
+		Memory::Free(Memory::ObjectArrayHeap, oldSlots);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::Destroy()
+{
+	if (this->ctrl != nullptr)
+	{
+		IndexT i;
+		for (i = 0; i < this->capacity; i++)
+		{
+			if (this->ctrl[i] >= 0)
+				this->slots[i].~KeyValuePair<KEYTYPE, VALUETYPE>();
+		}
+		Memory::Free(Memory::ObjectArrayHeap, this->ctrl);
+		Memory::Free(Memory::ObjectArrayHeap, this->slots);
+	}
+	this->ctrl = nullptr;
+	this->slots = nullptr;
+	this->capacity = 0;
+	this->size = 0;
+	this->growthLeft = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class KEYTYPE, class VALUETYPE>
+void
+FlatHashTable<KEYTYPE, VALUETYPE>::CopyFrom(const FlatHashTable<KEYTYPE, VALUETYPE>& rhs)
+{
+	n_assert(this->ctrl == nullptr);
+	if (rhs.capacity == 0)
+		return;
+
+	this->ctrl = (int8_t*)Memory::Alloc(Memory::ObjectArrayHeap, rhs.capacity);
+	this->slots = (KeyValuePair<KEYTYPE, VALUETYPE>*)Memory::Alloc(Memory::ObjectArrayHeap, rhs.capacity * sizeof(KeyValuePair<KEYTYPE, VALUETYPE>));
+	Memory::Copy(rhs.ctrl, this->ctrl, rhs.capacity);
+	IndexT i;
+	for (i = 0; i < rhs.capacity; i++)
+	{
+		if (rhs.ctrl[i] >= 0)
+			new (&this->slots[i]) KeyValuePair<KEYTYPE, VALUETYPE>(rhs.slots[i]);
+	}
+	this->capacity = rhs.capacity;
+	this->size = rhs.size;
+	this->growthLeft = rhs.growthLeft;
+}
+
+} // namespace Util
+//------------------------------------------------------------------------------
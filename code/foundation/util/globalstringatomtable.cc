@@ -6,6 +6,8 @@
 #include "foundation/stdneb.h"
 #include "util/globalstringatomtable.h"
 
+#include <string.h>
+
 namespace Util
 {
 __ImplementInterfaceSingleton(Util::GlobalStringAtomTable);
@@ -17,8 +19,13 @@ GlobalStringAtomTable::GlobalStringAtomTable()
 {
     __ConstructInterfaceSingleton;
     
-    // setup the global string buffer
-    this->stringBuffer.Setup(NEBULA_GLOBAL_STRINGBUFFER_CHUNKSIZE);
+    // setup the shards, each has its own string buffer
+    this->shards = n_new_array(Shard, NumShards);
+    IndexT i;
+    for (i = 0; i < NumShards; i++)
+    {
+        this->shards[i].stringBuffer.Setup(NEBULA_GLOBAL_STRINGBUFFER_CHUNKSIZE);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -26,44 +33,42 @@ GlobalStringAtomTable::GlobalStringAtomTable()
 */
 GlobalStringAtomTable::~GlobalStringAtomTable()
 {
-    this->critSect.Enter();
-    this->stringBuffer.Discard();
+    n_delete_array(this->shards);
+    this->shards = nullptr;
     __DestructInterfaceSingleton;
-    this->critSect.Leave();
-}
-
-//------------------------------------------------------------------------------
-/**
-*/
-void
-GlobalStringAtomTable::Lock()
-{
-    this->critSect.Enter();
 }
 
 //------------------------------------------------------------------------------
 /**
+    The low bits of the hash select the slot within a shard's table, so
+    use the high bits to select the shard.
 */
-void
-GlobalStringAtomTable::Unlock()
+GlobalStringAtomTable::Shard&
+GlobalStringAtomTable::GetShard(uint hash) const
 {
-    this->critSect.Leave();
+    return this->shards[(hash >> 24) & (NumShards - 1)];
 }
 
 //------------------------------------------------------------------------------
 /**
-    This adds a new string to the atom table and the global string buffer,
-    and returns the pointer to the string in the string buffer.
-
-    NOTE: you MUST call this method within Lock()/Unlock()!
+    This looks up a string in its shard, and if it's not found, copies it
+    into the shard's string buffer and adds it to the shard's table.
+    Returns the pointer to the string in the string buffer.
 */
 const char*
-GlobalStringAtomTable::Add(const char* str)
+GlobalStringAtomTable::FindOrAdd(const char* str, uint hash)
 {
-    StaticString sstr;
-    sstr.ptr = (char*)this->stringBuffer.AddString(str);
-    this->table.InsertSorted(sstr);
-    return sstr.ptr;
+    Shard& shard = this->GetShard(hash);
+    shard.critSect.Enter();
+    const char* content = shard.table.Find(str, hash);
+    if (0 == content)
+    {
+        // hrmpf, string isn't in the table yet, so add it...
+        content = shard.stringBuffer.AddString(str);
+        shard.table.Insert(content, hash);
+    }
+    shard.critSect.Leave();
+    return content;
 }
 
 //------------------------------------------------------------------------------
@@ -73,24 +78,32 @@ GlobalStringAtomTable::Add(const char* str)
 GlobalStringAtomTable::DebugInfo
 GlobalStringAtomTable::GetDebugInfo() const
 {
-    this->critSect.Enter();
     DebugInfo debugInfo;
-    debugInfo.strings.Reserve(this->table.Size());
     debugInfo.chunkSize = NEBULA_GLOBAL_STRINGBUFFER_CHUNKSIZE;
-    debugInfo.numChunks = this->stringBuffer.GetNumChunks();
-    debugInfo.allocSize = debugInfo.chunkSize * debugInfo.numChunks;
+    debugInfo.numChunks = 0;
     debugInfo.usedSize  = 0;
     debugInfo.growthEnabled = NEBULA_ENABLE_GLOBAL_STRINGBUFFER_GROWTH;
 
     IndexT i;
-    for (i = 0; i < table.Size(); i++)
-    {        
-        const char* str = this->table[i].ptr;
-        debugInfo.strings.Append(this->table[i].ptr);
-        debugInfo.usedSize += strlen(str) + 1;
+    for (i = 0; i < NumShards; i++)
+    {
+        Shard& shard = this->shards[i];
+        shard.critSect.Enter();
+        debugInfo.numChunks += shard.stringBuffer.GetNumChunks();
+        debugInfo.strings.Reserve(shard.table.Size());
+        shard.table.GetStrings(debugInfo.strings);
+        shard.critSect.Leave();
     }
-    this->critSect.Leave();
+    debugInfo.allocSize = debugInfo.chunkSize * debugInfo.numChunks;
+
+    for (i = 0; i < debugInfo.strings.Size(); i++)
+    {
+        debugInfo.usedSize += strlen(debugInfo.strings[i]) + 1;
+    }
+
+    // shards are unordered, sort for display
+    debugInfo.strings.SortWithFunc([](const char* const& lhs, const char* const& rhs) { return strcmp(lhs, rhs) < 0; });
     return debugInfo;
 }
 
-} // namespace Util
\ No newline at end of file
+} // namespace Util
@@ -4,10 +4,13 @@
     @class Util::GlobalStringAtomTable
   
     Global string atom table. This is the definitive string atom table which
-    contains the string of all string atoms of all threads. Locking
-    is necessary to lookup or add a string (that's why thread-local
-    string atom tables exist as local cache to prevent too much locking of
-    the global table).
+    contains the string of all string atoms of all threads.
+
+    The table is split into shards by string hash, each with its own lock,
+    hash set and string buffer. Threads creating different strings will
+    almost never touch the same shard, so loading resources from many
+    threads doesn't serialize on a single lock. Thread-local string atom
+    tables still act as a lock free cache in front of the global table.
     
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
@@ -20,7 +23,7 @@
 //------------------------------------------------------------------------------
 namespace Util
 {
-class GlobalStringAtomTable : public StringAtomTableBase
+class GlobalStringAtomTable
 {
     __DeclareInterfaceSingleton(GlobalStringAtomTable);
 public:
@@ -29,8 +32,8 @@ public:
     /// destructor
     ~GlobalStringAtomTable();
 
-    /// get pointer to global string buffer
-    StringBuffer* GetGlobalStringBuffer() const;
+    /// number of shards, must be a power of two
+    static const SizeT NumShards = 64;
 
     /// debug functionality: DebugInfo struct
     struct DebugInfo
@@ -49,17 +52,21 @@ public:
 private:
     friend class StringAtom;
 
-    /// take the critical section
-    void Lock();
-    /// add a string pointer to the atom table and string buffer (must be called inside Lock())
-    const char* Add(const char* str);
-    /// release the critical section
-    void Unlock();
+    /// find a string, or copy it into the string buffer and add it, returns the pointer in the string buffer
+    const char* FindOrAdd(const char* str, uint hash);
+
+    struct Shard
+    {
+        Threading::CriticalSection critSect;
+        StringAtomTableBase table;
+        StringBuffer stringBuffer;
+    };
+
+    /// get the shard a hash belongs to
+    Shard& GetShard(uint hash) const;
 
-    Threading::CriticalSection critSect;
-    StringBuffer stringBuffer;
+    Shard* shards;
 };
 
 } // namespace Util
 //------------------------------------------------------------------------------
-
@@ -32,11 +32,9 @@ LocalStringAtomTable::~LocalStringAtomTable()
     buffer (see GlobalStringAtomTable for details).
 */
 void
-LocalStringAtomTable::Add(const char* str)
+LocalStringAtomTable::Add(const char* str, uint hash)
 {
-    StaticString sstr;
-    sstr.ptr = (char*)str;
-    this->table.InsertSorted(sstr);
+    this->Insert(str, hash);
 }
 
 } // namespace Util
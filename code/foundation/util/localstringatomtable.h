@@ -28,7 +28,7 @@ private:
     friend class StringAtom;
 
     /// add a string pointer to the atom table
-    void Add(const char* str);
+    void Add(const char* str, uint hash);
 };        
 
 } // namespace Util
@@ -10,16 +10,17 @@ namespace Util
 //------------------------------------------------------------------------------
 /**
 	XorShift128 implementation.
+	The state is per thread, since garbage collection of components may run concurrently.
 */
 uint
 FastRandom()
 {
 	// These are predefined to give us the largest
 	// possible sequence of random numbers
-    static uint x = 123456789;
-    static uint y = 362436069;
-    static uint z = 521288629;
-    static uint w = 88675123;
+    static thread_local uint x = 123456789;
+    static thread_local uint y = 362436069;
+    static thread_local uint z = 521288629;
+    static thread_local uint w = 88675123;
     uint t;
     t = x ^ (x << 11);
     x = y;
@@ -29,12 +29,14 @@ namespace Util
 void
 StringAtom::Setup(const char* str)
 {
+    const uint hash = StringAtomTableBase::Hash(str);
+
     #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
         // first check our thread-local string atom table whether the string
         // is already registered there, this does not require any thread
         // synchronisation
         LocalStringAtomTable* localTable = LocalStringAtomTable::Instance();
-        this->content = localTable->Find(str);
+        this->content = localTable->Find(str, hash);
         if (0 != this->content)
         {
             // yep, the string is in the local table, we're done
@@ -43,21 +45,13 @@ StringAtom::Setup(const char* str)
     #endif
 
     // the string wasn't in the local table (or thread-local tables are disabled), 
-    // so we need to check the global table, this involves thread synchronisation
-    GlobalStringAtomTable* globalTable = GlobalStringAtomTable::Instance();
-    globalTable->Lock();
-    this->content = globalTable->Find(str);
-    if (0 == this->content)
-    {
-        // hrmpf, string isn't in global table either yet, so add it...
-        this->content = globalTable->Add(str);
-    }
-    globalTable->Unlock();
+    // so we need to check the global table, this locks the shard the string hashes to
+    this->content = GlobalStringAtomTable::Instance()->FindOrAdd(str, hash);
 
     #if NEBULA_ENABLE_THREADLOCAL_STRINGATOM_TABLES
         // finally, add the new string to our local table as well, so the
         // next lookup from our thread of this string will be faster
-        localTable->Add(this->content);
+        localTable->Add(this->content, hash);
     #endif
 }
 
@@ -5,6 +5,7 @@
 //------------------------------------------------------------------------------
 #include "foundation/stdneb.h"
 #include "util/stringatomtablebase.h"
+#include "util/stringid.h"
 
 #include <string.h>
 
@@ -14,7 +15,10 @@ namespace Util
 //------------------------------------------------------------------------------
 /**
 */
-StringAtomTableBase::StringAtomTableBase()
+StringAtomTableBase::StringAtomTableBase() :
+    entries(nullptr),
+    capacity(0),
+    size(0)
 {
     // empty
 }
@@ -24,63 +28,128 @@ StringAtomTableBase::StringAtomTableBase()
 */
 StringAtomTableBase::~StringAtomTableBase()
 {
-    // empty
+    if (nullptr != this->entries)
+    {
+        Memory::Free(Memory::StringDataHeap, this->entries);
+        this->entries = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Same FNV-1a hash as StringId, followed by a final mix so that both the
+    low bits (used for the slot) and the high bits (used for the global
+    table shard) are well distributed.
+*/
+uint
+StringAtomTableBase::Hash(const char* str)
+{
+    uint hash = StringId::Hash(str);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
 const char*
-StringAtomTableBase::Find(const char* str) const
+StringAtomTableBase::Find(const char* str, uint hash) const
 {
-    StaticString sstr;
-    sstr.ptr = (char*)str;
-    IndexT i = this->table.BinarySearchIndex(sstr);
-    if (InvalidIndex == i)
+    if (0 == this->size)
     {
         return 0;
     }
-    else
-    {
-        return this->table[i].ptr;
 
+    const SizeT mask = this->capacity - 1;
+    SizeT slot = hash & mask;
+    while (nullptr != this->entries[slot].ptr)
+    {
+        const Entry& entry = this->entries[slot];
+        if (entry.hash == hash && 0 == strcmp(entry.ptr, str))
+        {
+            return entry.ptr;
+        }
+        slot = (slot + 1) & mask;
     }
-}    
-
-//------------------------------------------------------------------------------
-/**
-*/
-bool
-StringAtomTableBase::StaticString::operator==(const StaticString& rhs) const
-{
-    return (strcmp(this->ptr, rhs.ptr) == 0);
+    return 0;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-bool
-StringAtomTableBase::StaticString::operator!=(const StaticString& rhs) const
+void
+StringAtomTableBase::Insert(const char* str, uint hash)
 {
-    return (strcmp(this->ptr, rhs.ptr) != 0);
+    n_assert(0 != str);
+
+    // keep the load factor below 1/2 so probe sequences stay short
+    if ((this->size + 1) * 2 > this->capacity)
+    {
+        this->Grow();
+    }
+
+    const SizeT mask = this->capacity - 1;
+    SizeT slot = hash & mask;
+    while (nullptr != this->entries[slot].ptr)
+    {
+        n_assert(this->entries[slot].ptr != str);
+        slot = (slot + 1) & mask;
+    }
+    this->entries[slot].hash = hash;
+    this->entries[slot].ptr = str;
+    this->size++;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-bool
-StringAtomTableBase::StaticString::operator<(const StaticString& rhs) const
+void
+StringAtomTableBase::Grow()
 {
-    return (strcmp(this->ptr, rhs.ptr) < 0);
+    const SizeT newCapacity = this->capacity == 0 ? 256 : this->capacity * 2;
+    Entry* newEntries = (Entry*)Memory::Alloc(Memory::StringDataHeap, newCapacity * sizeof(Entry));
+    Memory::Clear(newEntries, newCapacity * sizeof(Entry));
+
+    const SizeT mask = newCapacity - 1;
+    IndexT i;
+    for (i = 0; i < this->capacity; i++)
+    {
+        const Entry& entry = this->entries[i];
+        if (nullptr != entry.ptr)
+        {
+            SizeT slot = entry.hash & mask;
+            while (nullptr != newEntries[slot].ptr)
+            {
+                slot = (slot + 1) & mask;
+            }
+            newEntries[slot] = entry;
+        }
+    }
+
+    if (nullptr != this->entries)
+    {
+        Memory::Free(Memory::StringDataHeap, this->entries);
+    }
+    this->entries = newEntries;
+    this->capacity = newCapacity;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-bool
-StringAtomTableBase::StaticString::operator>(const StaticString& rhs) const
+void
+StringAtomTableBase::GetStrings(Util::Array<const char*>& outStrings) const
 {
-    return (strcmp(this->ptr, rhs.ptr) > 0);
+    IndexT i;
+    for (i = 0; i < this->capacity; i++)
+    {
+        if (nullptr != this->entries[i].ptr)
+        {
+            outStrings.Append(this->entries[i].ptr);
+        }
+    }
 }
 
-} // namespace Util
\ No newline at end of file
+} // namespace Util
@@ -14,12 +14,13 @@
     already been registered in the thread-local table, the string atom will
     be setup and no locking at all is necessary. Only if the string is
     not in the thread local table, the global string atom table will
-    be consulted (which requires locking). If the string is in the
-    global table, the pointer to the string will be sorted into the
-    thread-local atom table and the string will be setup. If the 
-    string is completely new (not even in the global atom table),
-    then the string needs to be sorted both into the global, and
-    the thread-local atom table.
+    be consulted, which only locks the shard the string hashes to.
+    If the string is completely new (not even in the global atom table),
+    it is copied into the global string buffer and added to both the global
+    and the thread-local atom table.
+
+    Tables are open addressing hash sets of string pointers. The string hash
+    is computed once per lookup and passed to every table.
     
     (C) 2009 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
@@ -37,30 +38,46 @@ public:
     /// destructor
     ~StringAtomTableBase();
 
+    /// compute the hash of a string as used by all string atom tables
+    static uint Hash(const char* str);
+
 protected:
     friend class StringAtom;
+    friend class GlobalStringAtomTable;
 
     /// find a string pointer in the atom table
-    const char* Find(const char* str) const;
+    const char* Find(const char* str, uint hash) const;
+    /// insert a string pointer, the string must not be in the table yet
+    void Insert(const char* str, uint hash);
+    /// get number of strings in the table
+    SizeT Size() const;
+    /// append all strings in the table to an array (in no particular order)
+    void GetStrings(Util::Array<const char*>& outStrings) const;
 
-    /// a static string class for sorting the array
-    struct StaticString
-    {
-        /// equality operator
-        bool operator==(const StaticString& rhs) const;
-        /// inequality operator
-        bool operator!=(const StaticString& rhs) const;
-        /// less-then operator
-        bool operator<(const StaticString& rhs) const;
-        /// greater-then operator
-        bool operator>(const StaticString& rhs) const;
+private:
+    /// resize the table and reinsert all strings
+    void Grow();
 
-        char* ptr;
+    struct Entry
+    {
+        uint hash;
+        const char* ptr;
     };
 
-    Util::Array<StaticString> table;
+    Entry* entries;
+    SizeT capacity;
+    SizeT size;
 };
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+StringAtomTableBase::Size() const
+{
+    return this->size;
+}
+
 } // namespace Util
 //------------------------------------------------------------------------------
 
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+//  stringid.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "util/stringid.h"
+#if NEBULA_DEBUG
+#include "util/hashtable.h"
+#include "threading/criticalsection.h"
+#endif
+
+namespace Util
+{
+
+#if NEBULA_DEBUG
+typedef Util::HashTable<uint, Util::StringAtom> StringIdRegistry;
+static Threading::CriticalSection registryLock;
+static StringIdRegistry* registry = nullptr;
+#endif
+
+//------------------------------------------------------------------------------
+/**
+*/
+StringId::StringId(const StringAtom& atom) :
+    value(atom.IsValid() ? Hash(atom.Value()) : 2166136261u)
+{
+    #if NEBULA_DEBUG
+    this->Register(atom);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+StringId::StringId(const String& str) :
+    value(Hash(str.AsCharPtr(), str.Length()))
+{
+    #if NEBULA_DEBUG
+    this->Register(str);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    Since string atoms are unique per string, a collision is simply a
+    different atom already being registered for the same hash.
+*/
+void
+StringId::Register(const StringAtom& atom) const
+{
+    #if NEBULA_DEBUG
+    if (!atom.IsValid())
+    {
+        return;
+    }
+
+    registryLock.Enter();
+    if (nullptr == registry)
+    {
+        // created on first use, memory heaps don't exist during static initialization
+        registry = n_new(StringIdRegistry);
+    }
+    IndexT index = registry->FindIndex(this->value);
+    if (InvalidIndex == index)
+    {
+        registry->Add(this->value, atom);
+    }
+    else if (registry->ValueAtIndex(this->value, index) != atom)
+    {
+        const Util::StringAtom other = registry->ValueAtIndex(this->value, index);
+        registryLock.Leave();
+        n_error("StringId collision: '%s' and '%s' both hash to 0x%08x!\n", atom.Value(), other.Value(), this->value);
+        return;
+    }
+    registryLock.Leave();
+    #endif
+}
+
+} // namespace Util
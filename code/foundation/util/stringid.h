@@ -0,0 +1,211 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Util::StringId
+    
+    A string identifier which is just the 32 bit FNV-1a hash of a string.
+    Unlike StringAtom, a StringId can be computed at compile time, so looking
+    up something by a literal name costs no string interning at all:
+
+        IndexT idx = type->GetSurfaceConstantIndex(sur, "MatDiffuse"_id);
+
+    StringIds compare and hash as plain integers and can be used as keys in
+    Util::HashTable and Util::Dictionary.
+
+    The string itself is not stored. In debug builds, every StringId created
+    at runtime from a string or StringAtom is recorded in a registry, and
+    two different strings hashing to the same id raise an error. Constant
+    expression ids can't be recorded, so containers should always be filled
+    from runtime strings (which is the case for anything loaded from disk).
+
+    Creating a StringId from a String or StringAtom hashes the whole string,
+    and takes the registry lock in debug builds, so these constructors are
+    explicit. Create the id once, when the name is loaded, and keep it.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "core/types.h"
+#include "util/stringatom.h"
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+namespace Util
+{
+class StringId
+{
+public:
+    /// default constructor, creates an invalid id
+    constexpr StringId();
+    /// construct from a string at compile time
+    explicit constexpr StringId(const char* str);
+    /// construct from a string with known length at compile time
+    constexpr StringId(const char* str, std::size_t len);
+    /// construct from a string atom, hashes the string
+    explicit StringId(const StringAtom& atom);
+    /// construct from a string object, hashes the string
+    explicit StringId(const String& str);
+
+    /// equality operator
+    constexpr bool operator==(const StringId& rhs) const;
+    /// inequality operator
+    constexpr bool operator!=(const StringId& rhs) const;
+    /// greater-then operator
+    constexpr bool operator>(const StringId& rhs) const;
+    /// less-then operator
+    constexpr bool operator<(const StringId& rhs) const;
+
+    /// return true if valid
+    constexpr bool IsValid() const;
+    /// get the hash value
+    constexpr uint Value() const;
+    /// calculate hash code for Util::HashTable
+    IndexT HashCode() const;
+
+    /// compute the FNV-1a hash of a zero terminated string
+    static constexpr uint Hash(const char* str);
+    /// compute the FNV-1a hash of a string with known length
+    static constexpr uint Hash(const char* str, std::size_t len);
+
+private:
+    /// DEBUG: record the string of a runtime id, and fail on collisions
+    void Register(const StringAtom& atom) const;
+
+    uint value;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr uint
+StringId::Hash(const char* str)
+{
+    uint hash = 2166136261u;
+    while (0 != *str)
+    {
+        hash = (hash ^ (uchar)*str++) * 16777619u;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr uint
+StringId::Hash(const char* str, std::size_t len)
+{
+    uint hash = 2166136261u;
+    for (std::size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (uchar)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The empty string hashes to the FNV offset basis, which is used as the
+    invalid id.
+*/
+constexpr
+StringId::StringId() :
+    value(2166136261u)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr
+StringId::StringId(const char* str) :
+    value(Hash(str))
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr
+StringId::StringId(const char* str, std::size_t len) :
+    value(Hash(str, len))
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr bool
+StringId::operator==(const StringId& rhs) const
+{
+    return this->value == rhs.value;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr bool
+StringId::operator!=(const StringId& rhs) const
+{
+    return this->value != rhs.value;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr bool
+StringId::operator>(const StringId& rhs) const
+{
+    return this->value > rhs.value;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr bool
+StringId::operator<(const StringId& rhs) const
+{
+    return this->value < rhs.value;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr bool
+StringId::IsValid() const
+{
+    return this->value != 2166136261u;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+constexpr uint
+StringId::Value() const
+{
+    return this->value;
+}
+
+//------------------------------------------------------------------------------
+/**
+    FNV-1a is already well distributed, just make sure the hash is positive.
+*/
+inline IndexT
+StringId::HashCode() const
+{
+    return IndexT(this->value & 0x7fffffff);
+}
+
+} // namespace Util
+
+//------------------------------------------------------------------------------
+/**
+    Literal constructor for string ids, "foobar"_id is evaluated at compile time
+*/
+constexpr Util::StringId
+operator ""_id(const char* c, std::size_t s)
+{
+    return Util::StringId(c, s);
+}
+//------------------------------------------------------------------------------
@@ -8,13 +8,17 @@
 #include "apprender/renderapplication.h"
 #include "io/logfileconsolehandler.h"
 #include "memory/debug/memorypagehandler.h"
+#include "memory/memorytracker.h"
+#include "memory/frameallocator.h"
 #include "core/debug/corepagehandler.h"
 #include "core/debug/stringatompagehandler.h"
 #include "io/debug/iopagehandler.h"
 #include "http/debug/svgtestpagehandler.h"
 #include "http/debug/helloworldrequesthandler.h"
 #include "threading/debug/threadpagehandler.h"
+#include "jobs/debug/jobpagehandler.h"
 #include "io/debug/consolepagehandler.h"
+#include "coregraphics/debug/texturepagehandler.h"
 #include "resources/simpleresourcemapper.h"
 #include "coregraphics/streamtextureloader.h"
 #include "coregraphics/streammeshloader.h"
@@ -155,9 +159,11 @@ RenderApplication::Open()
 		this->httpServerProxy->AttachRequestHandler(Debug::CorePageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::StringAtomPageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::ThreadPageHandler::Create());
+		this->httpServerProxy->AttachRequestHandler(Debug::JobPageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::MemoryPageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::ConsolePageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::IoPageHandler::Create());
+		this->httpServerProxy->AttachRequestHandler(Debug::TexturePageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::SvgTestPageHandler::Create());
 		this->httpServerProxy->AttachRequestHandler(Debug::HelloWorldRequestHandler::Create()); 
         
@@ -382,7 +388,20 @@ RenderApplication::Run()
 
         this->inputServer->EndFrame();
 
+#if NEBULA_MEMORY_TRACKING
+        Memory::TrackerEndFrame();
+#endif
+        Memory::FrameAllocatorNewFrame();
+
         _stop_timer(MainThreadFrameTimeAll);
+
+#if __NEBULA_HTTP__
+        // sample the frame for telemetry clients
+        if (Debug::TelemetryCollector::HasInstance())
+        {
+            Debug::TelemetryCollector::Instance()->OnFrame();
+        }
+#endif
     }
 }
 
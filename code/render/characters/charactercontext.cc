@@ -16,6 +16,7 @@
 #include "util/round.h"
 #include "dynui/im3d/im3dcontext.h"
 #include "models/nodes/characternode.h"
+#include "memory/frameallocator.h"
 
 using namespace Graphics;
 using namespace Resources;
@@ -606,9 +607,9 @@ CharacterContext::OnBeforeFrame(const Graphics::FrameContext& ctx)
 				{
 					// start setting up job
 					if (firstAnimTrack || playing.blend != 1.0f)
-						jobs[0] = Jobs::CreateJob({ AnimSampleJob });
+						jobs[0] = Jobs::CreateJob({ AnimSampleJob, "AnimSampleJob" });
 					else
-						jobs[0] = Jobs::CreateJob({ AnimSampleJobWithMix });
+						jobs[0] = Jobs::CreateJob({ AnimSampleJobWithMix, "AnimSampleJobWithMix" });
 
 					// need to compute the sample weight and pointers to "before" and "after" keys
 					const CoreAnimation::AnimClip& clip = CoreAnimation::AnimGetClip(anim, playing.clip);
@@ -617,8 +618,8 @@ CharacterContext::OnBeforeFrame(const Graphics::FrameContext& ctx)
 					IndexT keyIndex1 = ClampKeyIndex(keyIndex0 + 1, clip);
 					Timing::Tick inbetweenTicks = InbetweenTicks(playing.sampleTime, clip);
 
-					// create scratch memory
-					AnimSampleMixInfo* sampleMixInfo = (AnimSampleMixInfo*)Jobs::JobAllocateScratchMemory(jobs[0], Memory::ScratchHeap, sizeof(CoreAnimation::AnimSampleMixInfo));
+					// create scratch memory, the jobs are done by the end of the frame
+					AnimSampleMixInfo* sampleMixInfo = Memory::FrameAllocArray<AnimSampleMixInfo>(1);
 					Memory::Clear(sampleMixInfo, sizeof(AnimSampleMixInfo));
 					sampleMixInfo->sampleType = SampleType::Linear;
 					sampleMixInfo->sampleWeight = float(inbetweenTicks) / float(keyDuration);
@@ -668,7 +669,7 @@ CharacterContext::OnBeforeFrame(const Graphics::FrameContext& ctx)
 
 				{
 					// create skeleton eval job
-					jobs[1] = Jobs::CreateJob({ SkeletonEvalJobWithVariation });
+					jobs[1] = Jobs::CreateJob({ SkeletonEvalJobWithVariation, "SkeletonEvalJobWithVariation" });
 
 					const SizeT elmSize = sizeof(Math::matrix44);
 					const SizeT numElements = jobJoint.Size();
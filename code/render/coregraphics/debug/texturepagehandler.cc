@@ -25,6 +25,18 @@ using namespace Util;
 using namespace Http;
 using namespace Resources;
 
+/// a row of the texture list, copied on the render thread
+struct TextureInfo
+{
+    String name;
+    Resource::State state;
+    SizeT usage;
+    TextureType type;
+    TextureDimensions dims;
+    SizeT mips;
+    CoreGraphics::PixelFormat::Code format;
+};
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -33,6 +45,121 @@ TexturePageHandler::TexturePageHandler()
     this->SetName("Textures");
     this->SetDesc("show debug information about texture resources");
     this->SetRootLocation("texture");
+    this->SetThreadSafe(true);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Copies the textures of a pool, must be called on the render thread.
+*/
+template<class POOL>
+static void
+CopyTextureInfos(const POOL* pool, Array<TextureInfo>& infos)
+{
+    const Util::Dictionary<Resources::ResourceName, Resources::ResourceId>& resources = pool->GetResources();
+    infos.Reserve(resources.Size());
+    IndexT i;
+    for (i = 0; i < resources.Size(); i++)
+    {
+        const Resources::ResourceId res = resources.ValueAtIndex(i);
+        TextureInfo info;
+        info.name = resources.KeyAtIndex(i).AsString();
+        info.state = pool->GetState(res);
+        if (info.state == Resource::Loaded)
+        {
+            info.usage = pool->GetUsage(res);
+            info.type = TextureGetType(res);
+            info.dims = TextureGetDimensions(res);
+            info.mips = TextureGetNumMips(res);
+            info.format = TextureGetPixelFormat(res);
+        }
+        infos.Append(info);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Writes a table of textures, and flushes the response content every
+    RowsPerFlush rows.
+*/
+static void
+WriteTextureTable(const Ptr<HtmlPageWriter>& htmlWriter, const Ptr<HttpRequest>& request, const Array<TextureInfo>& infos, SizeT rowsPerFlush)
+{
+    // create a table of all existing textures
+    htmlWriter->AddAttr("border", "1");
+    htmlWriter->AddAttr("rules", "cols");
+    htmlWriter->Begin(HtmlElement::Table);
+    htmlWriter->AddAttr("bgcolor", "lightsteelblue");
+    htmlWriter->Begin(HtmlElement::TableRow);
+    htmlWriter->Element(HtmlElement::TableHeader, "ResId");
+    htmlWriter->Element(HtmlElement::TableHeader, "State");
+    htmlWriter->Element(HtmlElement::TableHeader, "UseCount");
+    htmlWriter->Element(HtmlElement::TableHeader, "Type");
+    htmlWriter->Element(HtmlElement::TableHeader, "Width");
+    htmlWriter->Element(HtmlElement::TableHeader, "Height");
+    htmlWriter->Element(HtmlElement::TableHeader, "Depth");
+    htmlWriter->Element(HtmlElement::TableHeader, "Mips");
+    htmlWriter->Element(HtmlElement::TableHeader, "Format");
+    htmlWriter->End(HtmlElement::TableRow);
+
+    IndexT i;
+    for (i = 0; i < infos.Size(); i++)
+    {
+        const TextureInfo& info = infos[i];
+        htmlWriter->Begin(HtmlElement::TableRow);
+        if (info.state == Resource::Loaded)
+        {
+            // only loaded texture can be inspected
+            htmlWriter->Begin(HtmlElement::TableData);
+            htmlWriter->AddAttr("href", "/texture?texinfo=" + info.name);
+            htmlWriter->Element(HtmlElement::Anchor, info.name);
+            htmlWriter->End(HtmlElement::TableData);
+        }
+        else
+        {
+            htmlWriter->Element(HtmlElement::TableData, info.name);
+        }
+
+        String resState;
+        switch (info.state)
+        {
+        case Resource::Loaded:      resState = "Loaded"; break;
+        case Resource::Pending:     resState = "Pending"; break;
+        case Resource::Failed:      resState = "FAILED"; break;
+        case Resource::Unloaded:    resState = "Unloaded"; break;
+        default:                    resState = "CANT HAPPEN"; break;
+        }
+        htmlWriter->Element(HtmlElement::TableData, resState);
+        if (info.state == Resource::Loaded)
+        {
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.usage));
+            switch (info.type)
+            {
+            case Texture1D:    htmlWriter->Element(HtmlElement::TableData, "1D"); break;
+            case Texture2D:    htmlWriter->Element(HtmlElement::TableData, "2D"); break;
+            case Texture3D:    htmlWriter->Element(HtmlElement::TableData, "3D"); break;
+            case TextureCube:  htmlWriter->Element(HtmlElement::TableData, "CUBE"); break;
+            default:           htmlWriter->Element(HtmlElement::TableData, "ERROR"); break;
+            }
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.dims.width));
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.dims.height));
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.dims.depth));
+            htmlWriter->Element(HtmlElement::TableData, String::FromInt(info.mips));
+            htmlWriter->Element(HtmlElement::TableData, PixelFormat::ToString(info.format));
+        }
+        else
+        {
+            // texture not currently loaded
+        }
+        htmlWriter->End(HtmlElement::TableRow);
+
+        // let the server send what is there while the rest is formatted
+        if ((i + 1) % rowsPerFlush == 0)
+        {
+            request->FlushResponseContent();
+        }
+    }
+    htmlWriter->End(HtmlElement::Table);
 }
 
 //------------------------------------------------------------------------------
@@ -43,20 +170,43 @@ TexturePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
 {
     n_assert(HttpMethod::Get == request->GetMethod());
 
-    // first check if a command has been defined in the URI
+    // first check if a command has been defined in the URI, those need the resources
+    // of the render thread all the time, and are handled there as a whole
     Dictionary<String,String> query = request->GetURI().ParseQuery();
-    if (query.Contains("img"))
+    if (query.Contains("img") || query.Contains("texinfo"))
     {
-        request->SetStatus(this->HandleImageRequest(query, request->GetResponseContentStream()));
+        HttpStatus::Code status = HttpStatus::ServiceUnavailable;
+        this->RunOnOwnerThread([&]()
+        {
+            if (query.Contains("img"))
+            {
+                status = this->HandleImageRequest(query, request->GetResponseContentStream());
+            }
+            else
+            {
+                status = this->HandleTextureInfoRequest(query["texinfo"], request->GetResponseContentStream());
+            }
+        });
+        request->SetStatus(status);
         return;
     }
-    else if (query.Contains("texinfo"))
+
+    // copy the texture lists on the render thread
+    Array<TextureInfo> streamTextures;
+    Array<TextureInfo> memoryTextures;
+    bool copied = this->RunOnOwnerThread([&]()
+    {
+        CopyTextureInfos(ResourceManager::Instance()->GetStreamPool<StreamTexturePool>(), streamTextures);
+        CopyTextureInfos(ResourceManager::Instance()->GetMemoryPool<MemoryTexturePool>(), memoryTextures);
+    });
+    if (!copied)
     {
-        request->SetStatus(this->HandleTextureInfoRequest(query["texinfo"], request->GetResponseContentStream()));
+        request->SetStatus(HttpStatus::ServiceUnavailable);
         return;
     }
 
     // no command, send the Texture home page
+    request->SetStatus(HttpStatus::OK);
     Ptr<HtmlPageWriter> htmlWriter = HtmlPageWriter::Create();
     htmlWriter->SetStream(request->GetResponseContentStream());
     htmlWriter->SetTitle("Nebula Textures");
@@ -67,178 +217,16 @@ TexturePageHandler::HandleRequest(const Ptr<HttpRequest>& request)
         htmlWriter->Element(HtmlElement::Anchor, "Home");
         htmlWriter->LineBreak();
         htmlWriter->LineBreak();
+        WriteTextureTable(htmlWriter, request, streamTextures, RowsPerFlush);
 
-		const StreamTexturePool* streamPool = ResourceManager::Instance()->GetStreamPool<StreamTexturePool>();
-		const Util::Dictionary<Resources::ResourceName, Resources::ResourceId>& streamResources = streamPool->GetResources();
-
-		// create a table of all existing textures
-		htmlWriter->AddAttr("border", "1");
-		htmlWriter->AddAttr("rules", "cols");
-		htmlWriter->Begin(HtmlElement::Table);
-		htmlWriter->AddAttr("bgcolor", "lightsteelblue");
-		htmlWriter->Begin(HtmlElement::TableRow);
-		htmlWriter->Element(HtmlElement::TableHeader, "ResId");
-		htmlWriter->Element(HtmlElement::TableHeader, "State");
-		htmlWriter->Element(HtmlElement::TableHeader, "UseCount");
-		htmlWriter->Element(HtmlElement::TableHeader, "Type");
-		htmlWriter->Element(HtmlElement::TableHeader, "Width");
-		htmlWriter->Element(HtmlElement::TableHeader, "Height");
-		htmlWriter->Element(HtmlElement::TableHeader, "Depth");
-		htmlWriter->Element(HtmlElement::TableHeader, "Mips");
-		htmlWriter->Element(HtmlElement::TableHeader, "Format");
-		htmlWriter->End(HtmlElement::TableRow);
-
-		// iterate over shared resources
-		IndexT i;
-		for (i = 0; i < streamResources.Size(); i++)
-		{
-			const Resources::ResourceId res = streamResources.ValueAtIndex(i);
-			const ResourceName& resName = streamResources.KeyAtIndex(i);
-			Resource::State state = streamPool->GetState(res);
-			htmlWriter->Begin(HtmlElement::TableRow);
-			if (state == Resource::Loaded)
-			{
-				// only loaded texture can be inspected
-				htmlWriter->Begin(HtmlElement::TableData);
-				htmlWriter->AddAttr("href", "/texture?texinfo=" + resName.AsString());
-				htmlWriter->Element(HtmlElement::Anchor, resName.Value());
-				htmlWriter->End(HtmlElement::TableData);
-			}
-			else
-			{
-				htmlWriter->Element(HtmlElement::TableData, resName.Value());
-			}
-
-			String resState;
-
-			switch (state)
-			{
-			case Resource::Loaded:      resState = "Loaded"; break;
-			case Resource::Pending:     resState = "Pending"; break;
-			case Resource::Failed:      resState = "FAILED"; break;
-			case Resource::Unloaded:	resState = "Unloaded"; break;
-			default:                    resState = "CANT HAPPEN"; break;
-			}
-			htmlWriter->Element(HtmlElement::TableData, resState);
-			if (state == Resource::Loaded)
-			{
-				const uint usage = streamPool->GetUsage(res);
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(usage));
-				TextureType type = TextureGetType(res);
-				switch (type)
-				{
-				case Texture1D:    htmlWriter->Element(HtmlElement::TableData, "1D"); break;
-				case Texture2D:    htmlWriter->Element(HtmlElement::TableData, "2D"); break;
-				case Texture3D:    htmlWriter->Element(HtmlElement::TableData, "3D"); break;
-				case TextureCube:  htmlWriter->Element(HtmlElement::TableData, "CUBE"); break;
-				default:           htmlWriter->Element(HtmlElement::TableData, "ERROR"); break;
-				}
-				TextureDimensions dims = TextureGetDimensions(res);
-				CoreGraphics::PixelFormat::Code fmt = TextureGetPixelFormat(res);
-				uint mips = TextureGetNumMips(res);
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(dims.width));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(dims.height));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(dims.depth));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(mips));
-				htmlWriter->Element(HtmlElement::TableData, PixelFormat::ToString(fmt));
-			}
-			else
-			{
-				// texture not currently loaded
-			}
-			htmlWriter->End(HtmlElement::TableRow);
-		}
-		htmlWriter->End(HtmlElement::Table);
-
-		const MemoryTexturePool* memPool = ResourceManager::Instance()->GetMemoryPool<MemoryTexturePool>();
-		const Util::Dictionary<Resources::ResourceName, Resources::ResourceId>& memResources = memPool->GetResources();
-
-		htmlWriter->Element(HtmlElement::Heading1, "Texture Resources (memory loaded)");
-		htmlWriter->AddAttr("href", "/index.html");
-		htmlWriter->Element(HtmlElement::Anchor, "Home");
-		htmlWriter->LineBreak();
-		htmlWriter->LineBreak();
-
-		// create a table of all existing textures
-		htmlWriter->AddAttr("border", "1");
-		htmlWriter->AddAttr("rules", "cols");
-		htmlWriter->Begin(HtmlElement::Table);
-		htmlWriter->AddAttr("bgcolor", "lightsteelblue");
-		htmlWriter->Begin(HtmlElement::TableRow);
-		htmlWriter->Element(HtmlElement::TableHeader, "ResId");
-		htmlWriter->Element(HtmlElement::TableHeader, "State");
-		htmlWriter->Element(HtmlElement::TableHeader, "UseCount");
-		htmlWriter->Element(HtmlElement::TableHeader, "Type");
-		htmlWriter->Element(HtmlElement::TableHeader, "Width");
-		htmlWriter->Element(HtmlElement::TableHeader, "Height");
-		htmlWriter->Element(HtmlElement::TableHeader, "Depth");
-		htmlWriter->Element(HtmlElement::TableHeader, "Mips");
-		htmlWriter->Element(HtmlElement::TableHeader, "Format");
-		htmlWriter->End(HtmlElement::TableRow);
-
-		// iterate over shared resources
-		for (i = 0; i < memResources.Size(); i++)
-		{
-			const Resources::ResourceId res = memResources.ValueAtIndex(i);
-			const ResourceName& resName = memResources.KeyAtIndex(i);
-			Resource::State state = memPool->GetState(res);
-			htmlWriter->Begin(HtmlElement::TableRow);
-			if (state == Resource::Loaded)
-			{
-				// only loaded texture can be inspected
-				htmlWriter->Begin(HtmlElement::TableData);
-				htmlWriter->AddAttr("href", "/texture?texinfo=" + resName.AsString());
-				htmlWriter->Element(HtmlElement::Anchor, resName.Value());
-				htmlWriter->End(HtmlElement::TableData);
-			}
-			else
-			{
-				htmlWriter->Element(HtmlElement::TableData, resName.Value());
-			}
-
-			String resState;
-
-			switch (state)
-			{
-			case Resource::Loaded:      resState = "Loaded"; break;
-			case Resource::Pending:     resState = "Pending"; break;
-			case Resource::Failed:      resState = "FAILED"; break;
-			case Resource::Unloaded:	resState = "Unloaded"; break;
-			default:                    resState = "CANT HAPPEN"; break;
-			}
-			htmlWriter->Element(HtmlElement::TableData, resState);
-			if (state == Resource::Loaded)
-			{
-				const SizeT usage = memPool->GetUsage(res);
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(usage));
-				TextureType type = TextureGetType(res);
-				switch (type)
-				{
-				case Texture1D:    htmlWriter->Element(HtmlElement::TableData, "1D"); break;
-				case Texture2D:    htmlWriter->Element(HtmlElement::TableData, "2D"); break;
-				case Texture3D:    htmlWriter->Element(HtmlElement::TableData, "3D"); break;
-				case TextureCube:  htmlWriter->Element(HtmlElement::TableData, "CUBE"); break;
-				default:           htmlWriter->Element(HtmlElement::TableData, "ERROR"); break;
-				}
-				TextureDimensions dims = TextureGetDimensions(res);
-				CoreGraphics::PixelFormat::Code fmt = TextureGetPixelFormat(res);
-				uint mips = TextureGetNumMips(res);
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(dims.width));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(dims.height));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(dims.depth));
-				htmlWriter->Element(HtmlElement::TableData, String::FromInt(mips));
-				htmlWriter->Element(HtmlElement::TableData, PixelFormat::ToString(fmt));
-			}
-			else
-			{
-				// texture not currently loaded
-			}
-			htmlWriter->End(HtmlElement::TableRow);
-		}
-		htmlWriter->End(HtmlElement::Table);
+        htmlWriter->Element(HtmlElement::Heading1, "Texture Resources (memory loaded)");
+        htmlWriter->AddAttr("href", "/index.html");
+        htmlWriter->Element(HtmlElement::Anchor, "Home");
+        htmlWriter->LineBreak();
+        htmlWriter->LineBreak();
+        WriteTextureTable(htmlWriter, request, memoryTextures, RowsPerFlush);
       
         htmlWriter->Close();
-        request->SetStatus(HttpStatus::OK);
     }
     else
     {
@@ -13,6 +13,11 @@
     http://host/texture?img=[resId]&fmt=[fmt]   - retrieve an image of the texture
     http://host/texture?texinfo=[resId]         - build a HTML page about specific texture    
 
+    Requests are handled on the worker thread of the HttpServer. The
+    texture list is copied on the render thread with RunOnOwnerThread()
+    and formatted on the worker thread, image and info requests run on
+    the render thread as a whole.
+
     (C) 2007 Radon Labs GmbH
     (C) 2013-2020 Individual contributors, see AUTHORS file
 */
@@ -36,6 +41,9 @@ private:
     Http::HttpStatus::Code HandleImageRequest(const Util::Dictionary<Util::String,Util::String>& query, const Ptr<IO::Stream>& responseStream);
     /// handle a texture info request (returns an info page about a single texture)
     Http::HttpStatus::Code HandleTextureInfoRequest(const Util::String& resId, const Ptr<IO::Stream>& responseContentStream);
+
+    /// number of table rows written between two flushes
+    static const SizeT RowsPerFlush = 256;
 };
 
 } // namespace Debug
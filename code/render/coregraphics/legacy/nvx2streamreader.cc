@@ -8,6 +8,8 @@
 #include "coregraphics/legacy/nvx2fileformatstructs.h"
 #include "resources/resourcemanager.h"
 #include "coregraphics/config.h"
+#include "coregraphics/meshoptimizer.h"
+#include "util/fixedarray.h"
 
 #if NEBULA_LEGACY_SUPPORT
 namespace Legacy
@@ -26,6 +28,7 @@ Nvx2StreamReader::Nvx2StreamReader() :
     usage(CoreGraphics::GpuBufferTypes::UsageImmutable),
     access(CoreGraphics::GpuBufferTypes::AccessNone),
     rawMode(false),
+    optimizeMesh(false),
     mapPtr(0),
 	ibo(IndexBufferId::Invalid()),
 	vbo(VertexBufferId::Invalid()),
@@ -76,6 +79,10 @@ Nvx2StreamReader::Open(const Resources::ResourceName& name)
         this->ReadHeaderData();
         this->ReadPrimitiveGroups();
         this->SetupVertexComponents();
+        if (this->optimizeMesh)
+        {
+            this->OptimizeMesh();
+        }
         if (!this->rawMode)
         {
             this->SetupVertexBuffer(name);
@@ -225,6 +232,39 @@ Nvx2StreamReader::SetupVertexComponents()
     }
 }
 
+//------------------------------------------------------------------------------
+/**
+    The Nebula2 exporter wrote triangles and vertices in modelling order,
+    so the triangles of every group are reordered for the post transform
+    cache, and then the vertices are reordered by first use. This works on
+    the mapped copy of the file, before the buffers are created. Vertices
+    which no triangle references are dropped.
+*/
+void
+Nvx2StreamReader::OptimizeMesh()
+{
+    n_assert(0 != this->vertexDataPtr);
+    n_assert(0 != this->indexDataPtr);
+
+    uint* indexPtr = (uint*) this->indexDataPtr;
+    Util::FixedArray<uint> reordered(this->numIndices);
+    IndexT groupIndex;
+    for (groupIndex = 0; groupIndex < this->primGroups.Size(); groupIndex++)
+    {
+        const PrimitiveGroup& group = this->primGroups[groupIndex];
+        n_assert(group.GetBaseIndex() + group.GetNumIndices() <= (SizeT)this->numIndices);
+        uint* groupIndices = indexPtr + group.GetBaseIndex();
+        MeshOptimizer::OptimizeVertexCache(&reordered[group.GetBaseIndex()], groupIndices, group.GetNumIndices(), this->numVertices);
+        Memory::Copy(&reordered[group.GetBaseIndex()], groupIndices, group.GetNumIndices() * sizeof(uint));
+    }
+
+    const SizeT vertexByteSize = this->vertexWidth * sizeof(float);
+    Util::FixedArray<uchar> vertices(this->vertexDataSize);
+    this->numVertices = MeshOptimizer::OptimizeVertexFetch(vertices.Begin(), indexPtr, this->numIndices, this->vertexDataPtr, this->numVertices, vertexByteSize);
+    this->vertexDataSize = this->numVertices * vertexByteSize;
+    Memory::Copy(vertices.Begin(), this->vertexDataPtr, this->vertexDataSize);
+}
+
 //------------------------------------------------------------------------------
 /**
     Since nvx2 files don't contain any bounding box information
@@ -240,7 +280,7 @@ Nvx2StreamReader::UpdateGroupBoundingBoxes()
     n_assert(this->primGroups.Size() > 0);
 
     float* vertexPtr = (float*) this->vertexDataPtr;
-    ushort* indexPtr = (ushort*) this->indexDataPtr;
+    uint* indexPtr = (uint*) this->indexDataPtr;
     IndexT groupIndex;
     for (groupIndex = 0; groupIndex < this->primGroups.Size(); groupIndex++)
     {
@@ -34,6 +34,10 @@ public:
     void SetRawMode(bool b);
     /// get raw mode flag
     bool IsRawMode() const;
+    /// enable/disable reordering triangles and vertices with the MeshOptimizer, default is false
+    void SetOptimizeMesh(bool b);
+    /// get optimize mesh flag
+    bool IsOptimizeMesh() const;
     /// set the intended resource usage (default is UsageImmutable)
     void SetUsage(CoreGraphics::GpuBufferTypes::Usage usage);
     /// get resource usage
@@ -77,6 +81,8 @@ private:
     void ReadPrimitiveGroups();
     /// setup vertex components array
     void SetupVertexComponents();
+    /// reorder triangles and vertices for the vertex cache and vertex fetch
+    void OptimizeMesh();
     /// update primitive group bounding boxes
     void UpdateGroupBoundingBoxes();
     /// setup the vertex buffer object (not called in raw mode)
@@ -117,6 +123,7 @@ private:
 	CoreGraphics::GpuBufferTypes::Access access;
 
     bool rawMode;
+    bool optimizeMesh;
 	Util::StringAtom tag;
 	Resources::ResourceName name;
 	CoreGraphics::VertexBufferId vbo;
@@ -159,6 +166,24 @@ Nvx2StreamReader::IsRawMode() const
     return this->rawMode;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Nvx2StreamReader::SetOptimizeMesh(bool b)
+{
+    this->optimizeMesh = b;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+Nvx2StreamReader::IsOptimizeMesh() const
+{
+    return this->optimizeMesh;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
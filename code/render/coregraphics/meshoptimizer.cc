@@ -0,0 +1,245 @@
+//------------------------------------------------------------------------------
+// meshoptimizer.cc
+// (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "render/stdneb.h"
+#include "meshoptimizer.h"
+#include "util/array.h"
+#include "util/fixedarray.h"
+#include "math/scalar.h"
+
+namespace CoreGraphics
+{
+
+//------------------------------------------------------------------------------
+/**
+	Vertex score from Forsyth's "Linear-Speed Vertex Cache Optimisation",
+	the three most recent vertices get a fixed score so that the next triangle
+	doesn't simply reuse the edge of the previous one, after that the score
+	falls off with the cache position. Vertices with few remaining triangles
+	get a boost to get rid of lone triangles early.
+*/
+static float
+VertexScore(IndexT cachePosition, SizeT remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+		{
+			const float scale = 1.0f / (MeshOptimizer::VertexCacheSize - 3);
+			score = Math::n_pow(1.0f - (cachePosition - 3) * scale, 1.5f);
+		}
+	}
+	score += 2.0f * Math::n_pow((float)remainingTriangles, -0.5f);
+	return score;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshOptimizer::OptimizeVertexCache(uint* dst, const uint* indices, SizeT numIndices, SizeT numVertices)
+{
+	n_assert(dst != indices);
+	n_assert((numIndices % 3) == 0);
+	const SizeT numTriangles = numIndices / 3;
+	if (numTriangles == 0)
+		return;
+
+	// build vertex to triangle adjacency
+	Util::FixedArray<SizeT> remaining(numVertices, 0);
+	IndexT i;
+	for (i = 0; i < numIndices; i++)
+	{
+		n_assert(indices[i] < (uint)numVertices);
+		remaining[indices[i]]++;
+	}
+	Util::FixedArray<IndexT> offsets(numVertices + 1);
+	offsets[0] = 0;
+	for (i = 0; i < numVertices; i++)
+		offsets[i + 1] = offsets[i] + remaining[i];
+	Util::FixedArray<IndexT> adjacency(numIndices);
+	Util::FixedArray<IndexT> fill(numVertices, 0);
+	for (i = 0; i < numIndices; i++)
+	{
+		const uint v = indices[i];
+		adjacency[offsets[v] + fill[v]++] = i / 3;
+	}
+
+	// initial scores
+	Util::FixedArray<float> vertexScore(numVertices);
+	for (i = 0; i < numVertices; i++)
+		vertexScore[i] = VertexScore(InvalidIndex, remaining[i]);
+	Util::FixedArray<float> triangleScore(numTriangles);
+	Util::FixedArray<bool> emitted(numTriangles, false);
+	for (i = 0; i < numTriangles; i++)
+		triangleScore[i] = vertexScore[indices[i * 3]] + vertexScore[indices[i * 3 + 1]] + vertexScore[indices[i * 3 + 2]];
+
+	// the cache holds three extra entries for the vertices pushed out by the last triangle
+	uint cache[VertexCacheSize + 3];
+	uint newCache[VertexCacheSize + 3];
+	SizeT cacheCount = 0;
+
+	IndexT nextSearch = 0;
+	IndexT bestTriangle = InvalidIndex;
+	SizeT emittedCount = 0;
+	while (emittedCount < numTriangles)
+	{
+		// nothing in the cache is adjacent to a triangle, continue with the next one in input order
+		if (bestTriangle == InvalidIndex)
+		{
+			while (emitted[nextSearch])
+				nextSearch++;
+			bestTriangle = nextSearch;
+		}
+
+		// emit triangle
+		const uint* tri = &indices[bestTriangle * 3];
+		dst[emittedCount * 3] = tri[0];
+		dst[emittedCount * 3 + 1] = tri[1];
+		dst[emittedCount * 3 + 2] = tri[2];
+		emitted[bestTriangle] = true;
+		emittedCount++;
+
+		// push its vertices to the front of the cache, and remove the triangle from the adjacency
+		SizeT newCount = 0;
+		IndexT j;
+		for (j = 0; j < 3; j++)
+		{
+			const uint v = tri[j];
+			newCache[newCount++] = v;
+
+			IndexT* begin = &adjacency[offsets[v]];
+			IndexT k;
+			for (k = 0; k < remaining[v]; k++)
+			{
+				if (begin[k] == bestTriangle)
+				{
+					begin[k] = begin[remaining[v] - 1];
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+		for (j = 0; j < cacheCount; j++)
+		{
+			const uint v = cache[j];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache[newCount++] = v;
+		}
+
+		// update the scores of everything that was in the cache, and find the next triangle among their neighbours
+		float bestScore = -1.0f;
+		bestTriangle = InvalidIndex;
+		for (j = 0; j < newCount; j++)
+		{
+			const uint v = newCache[j];
+			const IndexT position = j < VertexCacheSize ? j : InvalidIndex;
+			const float score = VertexScore(position, remaining[v]);
+			const float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+
+			const IndexT* begin = &adjacency[offsets[v]];
+			IndexT k;
+			for (k = 0; k < remaining[v]; k++)
+			{
+				const IndexT t = begin[k];
+				triangleScore[t] += delta;
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cacheCount = Math::n_min(newCount, VertexCacheSize);
+		Memory::Copy(newCache, cache, cacheCount * sizeof(uint));
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+	Vertices which are not referenced by any index are dropped.
+*/
+SizeT
+MeshOptimizer::OptimizeVertexFetch(void* dst, uint* indices, SizeT numIndices, const void* vertices, SizeT numVertices, SizeT vertexByteSize)
+{
+	n_assert(dst != vertices);
+	Util::FixedArray<uint> remap(numVertices, (uint)InvalidIndex);
+	uint next = 0;
+	IndexT i;
+	for (i = 0; i < numIndices; i++)
+	{
+		const uint v = indices[i];
+		n_assert(v < (uint)numVertices);
+		if (remap[v] == (uint)InvalidIndex)
+		{
+			remap[v] = next;
+			Memory::Copy((const uchar*)vertices + v * vertexByteSize, (uchar*)dst + next * vertexByteSize, vertexByteSize);
+			next++;
+		}
+		indices[i] = remap[v];
+	}
+	return next;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+MeshOptimizer::SimulateCache(const uint* indices, SizeT numIndices, SizeT numVertices, SizeT cacheSize, SizeT& numReferenced)
+{
+	n_assert(cacheSize > 0);
+
+	// a vertex is in the cache if fewer than cacheSize misses happened since it was transformed
+	Util::FixedArray<SizeT> timestamp(numVertices, 0);
+	SizeT misses = 0;
+	numReferenced = 0;
+	IndexT i;
+	for (i = 0; i < numIndices; i++)
+	{
+		const uint v = indices[i];
+		n_assert(v < (uint)numVertices);
+		if (timestamp[v] == 0)
+			numReferenced++;
+		if (timestamp[v] == 0 || misses - timestamp[v] >= cacheSize)
+		{
+			misses++;
+			timestamp[v] = misses;
+		}
+	}
+	return misses;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+float
+MeshOptimizer::ComputeACMR(const uint* indices, SizeT numIndices, SizeT numVertices, SizeT cacheSize)
+{
+	if (numIndices < 3)
+		return 0.0f;
+	SizeT numReferenced;
+	const SizeT misses = SimulateCache(indices, numIndices, numVertices, cacheSize, numReferenced);
+	return misses / float(numIndices / 3);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+float
+MeshOptimizer::ComputeATVR(const uint* indices, SizeT numIndices, SizeT numVertices, SizeT cacheSize)
+{
+	SizeT numReferenced;
+	const SizeT misses = SimulateCache(indices, numIndices, numVertices, cacheSize, numReferenced);
+	return numReferenced > 0 ? misses / float(numReferenced) : 0.0f;
+}
+
+} // namespace CoreGraphics
@@ -0,0 +1,51 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	@class CoreGraphics::MeshOptimizer
+
+	CPU side optimization passes for indexed triangle lists, meant to be run
+	once when a mesh is exported to nvx3 and not at load time. Legacy nvx2
+	files predate these passes, so the Nvx2StreamReader runs them when it
+	loads a mesh.
+
+	OptimizeVertexCache reorders the triangles of a list using Tom Forsyth's
+	linear-speed vertex cache optimization, so that consecutive triangles
+	reuse vertices still in the post transform cache. OptimizeVertexFetch
+	then reorders the vertices in the order in which they are first
+	referenced, which turns the vertex fetches of the reordered index buffer
+	into an almost linear walk through memory.
+
+	ComputeACMR and ComputeATVR simulate a FIFO post transform cache of a
+	given size and return the average number of vertex shader invocations
+	per triangle and per unique vertex respectively, lower is better, 0.5 and
+	1.0 being the theoretical best for a regular grid.
+
+	(C) 2020 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+
+namespace CoreGraphics
+{
+class MeshOptimizer
+{
+public:
+	/// reorder triangles for the post transform cache, dst and indices may not overlap
+	static void OptimizeVertexCache(uint* dst, const uint* indices, SizeT numIndices, SizeT numVertices);
+	/// reorder vertices in order of first use and remap indices in place, returns number of referenced vertices written to dst
+	static SizeT OptimizeVertexFetch(void* dst, uint* indices, SizeT numIndices, const void* vertices, SizeT numVertices, SizeT vertexByteSize);
+
+	/// compute average cache miss ratio, transformed vertices per triangle
+	static float ComputeACMR(const uint* indices, SizeT numIndices, SizeT numVertices, SizeT cacheSize = 16);
+	/// compute average transformed vertex ratio, transformed vertices per referenced vertex
+	static float ComputeATVR(const uint* indices, SizeT numIndices, SizeT numVertices, SizeT cacheSize = 16);
+
+	/// size of the cache modelled by OptimizeVertexCache
+	static const SizeT VertexCacheSize = 32;
+
+private:
+	/// simulate FIFO cache, returns number of transformed vertices and number of referenced vertices
+	static SizeT SimulateCache(const uint* indices, SizeT numIndices, SizeT numVertices, SizeT cacheSize, SizeT& numReferenced);
+};
+
+} // namespace CoreGraphics
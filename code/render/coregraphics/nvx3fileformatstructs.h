@@ -2,11 +2,23 @@
 //------------------------------------------------------------------------------
 /**
     @file nvx3fileformatstructs.h
-    
+
     NVX3 file format structures.
-    
+
+    An nvx3 file is laid out so that it can be used directly from a mapped
+    file, without any parsing or conversion:
+
+        Nvx3Header
+        Nvx3VertexComponent[numVertexComponents]
+        Nvx3Group[numGroups]
+        vertex data, numVertices * vertexByteSize bytes
+        index data, numIndices * 2 or 4 bytes depending on Nvx3Index16
+
+    The flags tell which optimizations the exporter has applied to the
+    mesh, see CoreGraphics::MeshOptimizer.
+
     (C) 2013 Gustav Sterbrant
-	(C) 2013-2018 Individual contributors, see AUTHORS file
+	(C) 2013-2020 Individual contributors, see AUTHORS file
 */
 #include "core/types.h"
 #include "coregraphics/gpubuffertypes.h"
@@ -17,9 +29,19 @@ namespace CoreGraphics
 #pragma pack(push, 1)
 
 #define NEBULA_NVX3_MAGICNUMBER 'NVX3'
+#define NEBULA_NVX3_VERSION 2
+
+/// nvx3 header flags
+enum Nvx3Flags
+{
+	Nvx3Index16 = (1 << 0),					// indices are 16 bit, otherwise 32 bit
+	Nvx3VertexCacheOptimized = (1 << 1),	// triangles are ordered for the post transform cache
+	Nvx3VertexFetchOptimized = (1 << 2),	// vertices are ordered by first use in the index buffer
+	Nvx3Quantized = (1 << 3),				// vertex components have been packed to compact formats
+};
 
 //------------------------------------------------------------------------------
-/** 
+/**
     NVX3 file format structs.
 
     NOTE: keep all header-structs 4-byte aligned!
@@ -27,23 +49,34 @@ namespace CoreGraphics
 struct Nvx3Header
 {
 	uint magic;
+	uint version;
+	uint flags;
 	uint numGroups;
 	uint numVertices;
-	uint vertexWidth;
+	uint vertexByteSize;
 	uint numIndices;
-	uint vertexComponentMask;
+	uint numVertexComponents;
 	CoreGraphics::GpuBufferTypes::Usage usage;
 	CoreGraphics::GpuBufferTypes::Access access;
 };
 
+struct Nvx3VertexComponent
+{
+	uint semanticName;
+	uint semanticIndex;
+	uint format;
+};
+
 struct Nvx3Group
 {
 	uint primType;
 	uint firstVertex;
 	uint numVertices;
-	uint firstTriangle;
-	uint numTriangles;
+	uint firstIndex;
+	uint numIndices;
+	float boxMin[3];
+	float boxMax[3];
 };
 
 #pragma pack(pop)
-} // namespace CoreGraphics   
\ No newline at end of file
+} // namespace CoreGraphics
@@ -6,6 +6,10 @@
 #include "streammeshpool.h"
 #include "coregraphics/mesh.h"
 #include "coregraphics/legacy/nvx2streamreader.h"
+#include "coregraphics/nvx3fileformatstructs.h"
+#include "coregraphics/vertexbuffer.h"
+#include "coregraphics/indexbuffer.h"
+#include "coregraphics/vertexlayout.h"
 #include "coregraphics/memorymeshpool.h"
 #include "coregraphics/graphicsdevice.h"
 #include "streammeshpool.h"
@@ -115,6 +119,7 @@ StreamMeshPool::SetupMeshFromNvx2(const Ptr<Stream>& stream, const Resources::Re
 	nvx2Reader->SetStream(stream);
 	nvx2Reader->SetUsage(this->usage);
 	nvx2Reader->SetAccess(this->access);
+	nvx2Reader->SetOptimizeMesh(true);
 	Resources::ResourceName name = this->GetName(res);
 
 	// opening the reader also loads the file
@@ -150,9 +155,114 @@ StreamMeshPool::SetupMeshFromNvx2(const Ptr<Stream>& stream, const Resources::Re
 Resources::ResourcePool::LoadStatus
 StreamMeshPool::SetupMeshFromNvx3(const Ptr<Stream>& stream, const Resources::ResourceId res)
 {
-	// FIXME!
-	n_error("StreamMeshPool::SetupMeshFromNvx3() not yet implemented");
-	return Resources::ResourcePool::Failed;
+	n_assert(stream.isvalid());
+	n_assert(stream->CanBeMapped());
+
+	// the file is used straight from the mapping, vertices and indices are only copied once, into the buffers
+	uchar* mapPtr = (uchar*)stream->Map();
+	const SizeT mapSize = stream->GetSize();
+	const Nvx3Header* header = (const Nvx3Header*)mapPtr;
+	if (mapSize < sizeof(Nvx3Header) || FourCC(header->magic) != FourCC(NEBULA_NVX3_MAGICNUMBER) || header->version != NEBULA_NVX3_VERSION)
+	{
+		n_warning("StreamMeshPool: '%s' is not a version %d nvx3 file!\n", stream->GetURI().AsString().AsCharPtr(), NEBULA_NVX3_VERSION);
+		stream->Unmap();
+		return ResourcePool::Failed;
+	}
+
+	// the counts come straight from the file, so the sizes are computed in 64 bits and checked against the file before any pointer is formed
+	const IndexType::Code indexType = (header->flags & Nvx3Index16) ? IndexType::Index16 : IndexType::Index32;
+	const uint64 headerSize = sizeof(Nvx3Header) + uint64(header->numVertexComponents) * sizeof(Nvx3VertexComponent) + uint64(header->numGroups) * sizeof(Nvx3Group);
+	const uint64 vertexDataSize64 = uint64(header->numVertices) * header->vertexByteSize;
+	const uint64 indexDataSize64 = uint64(header->numIndices) * IndexType::SizeOf(indexType);
+	if (header->numGroups == 0 || header->numVertices == 0 || header->vertexByteSize == 0 || headerSize + vertexDataSize64 + indexDataSize64 > uint64(mapSize))
+	{
+		n_warning("StreamMeshPool: nvx3 file '%s' is truncated!\n", stream->GetURI().AsString().AsCharPtr());
+		stream->Unmap();
+		return ResourcePool::Failed;
+	}
+	const Nvx3VertexComponent* components = (const Nvx3VertexComponent*)(header + 1);
+	const Nvx3Group* groups = (const Nvx3Group*)(components + header->numVertexComponents);
+	const uchar* vertexData = (const uchar*)(groups + header->numGroups);
+	const SizeT vertexDataSize = (SizeT)vertexDataSize64;
+	const uchar* indexData = vertexData + vertexDataSize;
+	const SizeT indexDataSize = (SizeT)indexDataSize64;
+
+	IndexT i;
+	for (i = 0; i < (IndexT)header->numGroups; i++)
+	{
+		const Nvx3Group& group = groups[i];
+		if (uint64(group.firstVertex) + group.numVertices > header->numVertices || uint64(group.firstIndex) + group.numIndices > header->numIndices)
+		{
+			n_warning("StreamMeshPool: nvx3 file '%s' has a primitive group outside of its buffers!\n", stream->GetURI().AsString().AsCharPtr());
+			stream->Unmap();
+			return ResourcePool::Failed;
+		}
+	}
+
+	Util::Array<VertexComponent> vertexComponents;
+	for (i = 0; i < (IndexT)header->numVertexComponents; i++)
+	{
+		const Nvx3VertexComponent& comp = components[i];
+		vertexComponents.Append(VertexComponent((VertexComponent::SemanticName)comp.semanticName, comp.semanticIndex, (VertexComponent::Format)comp.format));
+	}
+
+	Resources::ResourceName name = this->GetName(res);
+
+	VertexBufferCreateInfo vboInfo;
+	vboInfo.name = name;
+	vboInfo.access = header->access;
+	vboInfo.usage = header->usage;
+	vboInfo.numVerts = header->numVertices;
+	vboInfo.comps = vertexComponents;
+	vboInfo.data = (void*)vertexData;
+	vboInfo.dataSize = vertexDataSize;
+	VertexBufferId vbo = CreateVertexBuffer(vboInfo);
+
+	IndexBufferId ibo = IndexBufferId::Invalid();
+	if (header->numIndices > 0)
+	{
+		IndexBufferCreateInfo iboInfo;
+		iboInfo.name = name;
+		iboInfo.access = header->access;
+		iboInfo.usage = header->usage;
+		iboInfo.numIndices = header->numIndices;
+		iboInfo.type = indexType;
+		iboInfo.data = (void*)indexData;
+		iboInfo.dataSize = indexDataSize;
+		ibo = CreateIndexBuffer(iboInfo);
+	}
+
+	// groups carry their own bounding boxes, so there is no need to walk the indices
+	auto vertexLayout = CreateVertexLayout({ vertexComponents });
+	Util::Array<PrimitiveGroup> primGroups;
+	for (i = 0; i < (IndexT)header->numGroups; i++)
+	{
+		const Nvx3Group& group = groups[i];
+		PrimitiveGroup primGroup;
+		primGroup.SetBaseVertex(group.firstVertex);
+		primGroup.SetNumVertices(group.numVertices);
+		primGroup.SetBaseIndex(group.firstIndex);
+		primGroup.SetNumIndices(group.numIndices);
+		Math::bbox box;
+		box.begin_extend();
+		box.extend(Math::point(group.boxMin[0], group.boxMin[1], group.boxMin[2]));
+		box.extend(Math::point(group.boxMax[0], group.boxMax[1], group.boxMax[2]));
+		primGroup.SetBoundingBox(box);
+		primGroup.SetVertexLayout(vertexLayout);
+		primGroups.Append(primGroup);
+	}
+
+	meshPool->EnterGet();
+	MeshCreateInfo& msh = meshPool->Get<0>(res);
+	n_assert(this->GetState(res) == Resources::Resource::Pending);
+	msh.streams.Append({ vbo, 0 });
+	msh.indexBuffer = ibo;
+	msh.topology = (PrimitiveTopology::Code)groups[0].primType;
+	msh.primitiveGroups = primGroups;
+	meshPool->LeaveGet();
+
+	stream->Unmap();
+	return ResourcePool::Success;
 }
 
 //------------------------------------------------------------------------------
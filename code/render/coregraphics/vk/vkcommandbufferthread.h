@@ -2,6 +2,11 @@
 //------------------------------------------------------------------------------
 /**
 	This thread records commands to a Vulkan Command Buffer in its own thread.
+
+	Commands are passed from the submitting thread in blocks through a
+	single producer ring, so pushing a command doesn't take a lock. Commands
+	only become visible to the thread when their block is full or when
+	FlushCommands is called.
 	
 	(C) 2016-2020 Individual contributors, see AUTHORS file
 */
@@ -9,7 +14,7 @@
 #include <vulkan/vulkan.h>
 #include "coregraphics/config.h"
 #include "threading/thread.h"
-#include "threading/safequeue.h"
+#include "threading/blockring.h"
 #include "coregraphics/primitivegroup.h"
 #include "debug/debugtimer.h"
 #include "math/rectangle.h"
@@ -220,15 +225,19 @@ public:
 	void PushCommand(const Command& command);
 	/// push command buffer work
 	void PushCommands(const Util::Array<Command>& commands);
+	/// hand all pushed commands over to the thread
+	void FlushCommands();
 	/// set command buffer
 	void SetCommandBuffer(const VkCommandBuffer& buffer);
 private:
 	friend struct GraphicsDeviceState;
 
+	/// record a single command to the command buffer
+	void RecordCommand(const Command& cmd);
 
 	VkCommandBuffer commandBuffer;
 	VkPipelineLayout pipelineLayout;
-	Threading::SafeQueue<Command> commands;
+	Threading::BlockRing<Command> commands;
 #if NEBULA_ENABLE_PROFILING
 	_declare_timer(debugTimer);
 #endif
@@ -259,7 +268,16 @@ VkCommandBufferThread::PushCommand(const Command& command)
 inline void
 VkCommandBufferThread::PushCommands(const Util::Array<Command>& commands)
 {
-	this->commands.EnqueueArray(commands);
+	this->commands.EnqueueArray(commands.Begin(), commands.Size());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+VkCommandBufferThread::FlushCommands()
+{
+	this->commands.Publish();
 }
 
 } // namespace Vulkan
\ No newline at end of file
@@ -85,7 +85,6 @@ struct GraphicsDeviceState : CoreGraphics::GraphicsDeviceState
 	Threading::Event* compCompletionEvents[NumComputeThreads];
 
 	Util::FixedArray<VkCommandBufferThread::Command> propagateDescriptorSets;
-	Util::Array<VkCommandBufferThread::Command> threadCmds[NumDrawThreads];
 	SizeT numCallsLastFrame;
 	SizeT numActiveThreads;
 	SizeT numUsedThreads;
@@ -868,20 +867,10 @@ EndDrawThreads()
 void 
 PushToThread(const VkCommandBufferThread::Command& cmd, const IndexT& index, bool allowStaging)
 {
-	//this->threadCmds[index].Append(cmd);
-	if (allowStaging)
-	{
-		state.threadCmds[index].Append(cmd);
-		if (state.threadCmds[index].Size() == 1500)
-		{
-			state.drawThreads[index]->PushCommands(state.threadCmds[index]);
-			state.threadCmds[index].Reset();
-		}
-	}
-	else
-	{
-		state.drawThreads[index]->PushCommand(cmd);
-	}
+	// staged commands are handed to the thread once their block fills up
+	state.drawThreads[index]->PushCommand(cmd);
+	if (!allowStaging)
+		state.drawThreads[index]->FlushCommands();
 }
 
 //------------------------------------------------------------------------------
@@ -890,11 +879,7 @@ PushToThread(const VkCommandBufferThread::Command& cmd, const IndexT& index, boo
 void 
 FlushToThread(const IndexT& index)
 {
-	if (!state.threadCmds[index].IsEmpty())
-	{
-		state.drawThreads[index]->PushCommands(state.threadCmds[index]);
-		state.threadCmds[index].Clear();
-	}
+	state.drawThreads[index]->FlushCommands();
 }
 
 #if NEBULA_GRAPHICS_DEBUG
@@ -969,6 +954,63 @@ using namespace Vulkan;
 template<> void ObjectSetName(const CoreGraphics::CommandBufferId id, const Util::String& name);
 #endif
 
+static const SizeT PipelineCacheHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static Util::String
+PipelineCachePath()
+{
+	return Util::String::Sprintf("bin:%s_vkpipelinecache", App::Application::Instance()->GetAppTitle().AsCharPtr());
+}
+
+//------------------------------------------------------------------------------
+/**
+	Reads the pipeline cache saved on the last shutdown. The header is
+	checked against the current device, since a cache from another GPU or
+	driver version is useless and some drivers don't validate it themselves.
+*/
+static Util::Blob
+LoadPipelineCacheData(const VkPhysicalDeviceProperties& props)
+{
+	const Util::String path = PipelineCachePath();
+	if (!IO::IoServer::Instance()->FileExists(path))
+		return Util::Blob();
+
+	Ptr<IO::Stream> stream = IO::IoServer::Instance()->CreateStream(path);
+	stream->SetAccessMode(IO::Stream::ReadAccess);
+	if (!stream->Open())
+		return Util::Blob();
+
+	const IO::Stream::Size size = stream->GetSize();
+	if (size < (IO::Stream::Size)PipelineCacheHeaderSize)
+	{
+		stream->Close();
+		return Util::Blob();
+	}
+	Util::Blob data(size);
+	const IO::Stream::Size bytesRead = stream->Read(data.GetPtr(), size);
+	stream->Close();
+	if (bytesRead != size)
+		return Util::Blob();
+
+	// header is headerSize, headerVersion, vendorID, deviceID followed by the cache UUID
+	const uint32_t* header = (const uint32_t*)data.GetPtr();
+	const uint8_t* uuid = (const uint8_t*)data.GetPtr() + 4 * sizeof(uint32_t);
+	if (header[0] < PipelineCacheHeaderSize
+		|| header[0] > (uint32_t)size
+		|| header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		|| header[2] != props.vendorID
+		|| header[3] != props.deviceID
+		|| memcmp(uuid, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+	{
+		n_printf("Discarding pipeline cache '%s', it was created by a different device or driver\n", path.AsCharPtr());
+		return Util::Blob();
+	}
+	return data;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -1239,21 +1281,30 @@ CreateGraphicsDevice(const GraphicsDeviceCreateInfo& info)
 	state.queueFamilyMap[TransferQueueType] = state.transferQueueFamily;
 	state.queueFamilyMap[SparseQueueType] = state.sparseQueueFamily;
 
+	// load the pipeline cache from the previous run, if it was created by the same driver
+	Util::Blob cacheData = LoadPipelineCacheData(state.deviceProps[state.currentDevice]);
 	VkPipelineCacheCreateInfo cacheInfo =
 	{
 		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
 		NULL,
 		0,
-		0,
-		NULL
+		cacheData.IsValid() ? (size_t)cacheData.Size() : 0,
+		cacheData.IsValid() ? cacheData.GetPtr() : NULL
 	};
 
 	// create cache
 	res = vkCreatePipelineCache(state.devices[state.currentDevice], &cacheInfo, NULL, &state.cache);
+	if (res != VK_SUCCESS && cacheData.IsValid())
+	{
+		// the driver rejected the stored data, start with an empty cache
+		cacheInfo.initialDataSize = 0;
+		cacheInfo.pInitialData = NULL;
+		res = vkCreatePipelineCache(state.devices[state.currentDevice], &cacheInfo, NULL, &state.cache);
+	}
 	n_assert(res == VK_SUCCESS);
 
 	// setup our own pipeline database
-	state.database.Setup(state.devices[state.currentDevice], state.cache);
+	state.database.Setup(state.devices[state.currentDevice], state.cache, info.numBufferedFrames);
 
 	// setup the empty descriptor set
 	SetupEmptyDescriptorSetLayout();
@@ -1617,14 +1668,14 @@ DestroyGraphicsDevice()
 	vkGetPipelineCacheData(state.devices[0], state.cache, &size, nullptr);
 	uint8_t* data = (uint8_t*)Memory::Alloc(Memory::ScratchHeap, size);
 	vkGetPipelineCacheData(state.devices[0], state.cache, &size, data);
-	Util::String path = Util::String::Sprintf("bin:%s_vkpipelinecache", App::Application::Instance()->GetAppTitle().AsCharPtr());
-	Ptr<IO::Stream> cachedData = IO::IoServer::Instance()->CreateStream(path);
+	Ptr<IO::Stream> cachedData = IO::IoServer::Instance()->CreateStream(PipelineCachePath());
 	cachedData->SetAccessMode(IO::Stream::WriteAccess);
 	if (cachedData->Open())
 	{
 		cachedData->Write(data, (IO::Stream::Size)size);
 		cachedData->Close();
 	}
+	Memory::Free(Memory::ScratchHeap, data);
 
 	IndexT i;
 	for (i = 0; i < state.NumDrawThreads; i++)
@@ -1836,6 +1887,9 @@ BeginFrame(IndexT frameIndex)
 	state.gfxFence = CoreGraphics::SubmissionContextNextCycle(state.gfxSubmission);
 	state.computeFence = CoreGraphics::SubmissionContextNextCycle(state.computeSubmission);
 
+	// the oldest frame has finished, so pipelines it retired can be destroyed
+	state.database.NextCycle();
+
 	// update constant buffer offsets
 	Vulkan::GraphicsDeviceState::ConstantsRingBuffer& nextCboRing = state.constantBufferRings[state.currentBufferedFrameIndex];
 	for (IndexT i = 0; i < CoreGraphics::GlobalConstantBufferType::NumConstantBufferTypes; i++)
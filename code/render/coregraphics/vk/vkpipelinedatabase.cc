@@ -17,7 +17,10 @@ __ImplementSingleton(VkPipelineDatabase);
 */
 VkPipelineDatabase::VkPipelineDatabase() :
 	dev(VK_NULL_HANDLE),
-	cache(VK_NULL_HANDLE)
+	cache(VK_NULL_HANDLE),
+	createFunc(DefaultCreatePipeline),
+	destroyFunc(DefaultDestroyPipeline),
+	currentCycle(0)
 {
 	__ConstructSingleton;
 	this->Reset();
@@ -35,40 +38,66 @@ VkPipelineDatabase::~VkPipelineDatabase()
 /**
 */
 void
-VkPipelineDatabase::Setup(const VkDevice dev, const VkPipelineCache cache)
+VkPipelineDatabase::Setup(const VkDevice dev, const VkPipelineCache cache, SizeT numBufferedFrames)
 {
+	n_assert(numBufferedFrames > 0);
 	this->dev = dev;
 	this->cache = cache;
+	this->retiredPipelines.Resize(numBufferedFrames);
+	this->currentCycle = 0;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
-void 
+void
 VkPipelineDatabase::Discard()
 {
+	auto it = this->pipelines.Begin();
+	while (it != this->pipelines.End())
+	{
+		if (it.val->pipeline != VK_NULL_HANDLE)
+			this->DestroyPipeline(it.val->pipeline);
+		it++;
+	}
+	this->pipelines.Clear();
+
+	IndexT i;
+	for (i = 0; i < this->retiredPipelines.Size(); i++)
+		this->DestroyRetiredPipelines(i);
+	this->Reset();
 }
 
 //------------------------------------------------------------------------------
 /**
+	Pipelines created by a mock function are not real Vulkan objects, so
+	they are never passed to vkDestroyPipeline. Without a destroy function
+	they are simply dropped.
 */
 void
-VkPipelineDatabase::SetPass(const CoreGraphics::PassId pass)
+VkPipelineDatabase::SetCreatePipelineFunc(CreatePipelineFunc createFunc, DestroyPipelineFunc destroyFunc)
 {
-	this->currentPass = pass;
-	IndexT index = this->tier1.FindIndex(pass);
-	if (index != InvalidIndex)
+	if (createFunc != nullptr)
 	{
-		this->ct1 = this->tier1.ValueAtIndex(index);
-		this->SetSubpass(this->currentSubpass);
+		this->createFunc = createFunc;
+		this->destroyFunc = destroyFunc;
 	}
 	else
 	{
-		this->ct1 = n_new(Tier1Node);
-		this->tier1.Add(pass, this->ct1);
+		this->createFunc = DefaultCreatePipeline;
+		this->destroyFunc = DefaultDestroyPipeline;
 	}
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VkPipelineDatabase::SetPass(const CoreGraphics::PassId pass)
+{
+	this->currentPass = pass;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -76,17 +105,6 @@ void
 VkPipelineDatabase::SetSubpass(uint32_t subpass)
 {
 	this->currentSubpass = subpass;
-	IndexT index = this->ct1->children.FindIndex(subpass);
-	if (index != InvalidIndex)
-	{
-		this->ct2 = this->ct1->children.ValueAtIndex(index);
-		this->SetShader(this->currentShaderProgram, this->currentShaderInfo);
-	}
-	else
-	{
-		this->ct2 = n_new(Tier2Node);
-		this->ct1->children.Add(subpass, this->ct2);
-	}
 }
 
 //------------------------------------------------------------------------------
@@ -97,18 +115,6 @@ VkPipelineDatabase::SetShader(const CoreGraphics::ShaderProgramId program, const
 {
 	this->currentShaderProgram = program;
 	this->currentShaderInfo = gfxPipe;
-	IndexT index = this->ct2->children.FindIndex(program);
-	if (index != InvalidIndex)
-	{
-		this->ct3 = this->ct2->children.ValueAtIndex(index);
-		this->SetVertexLayout(this->currentVertexLayout);
-	}
-	else
-	{
-		this->ct3 = n_new(Tier3Node);
-		this->ct2->children.Add(program, this->ct3);
-		this->SetVertexLayout(this->currentVertexLayout);
-	}
 }
 
 //------------------------------------------------------------------------------
@@ -118,18 +124,6 @@ void
 VkPipelineDatabase::SetVertexLayout(VkPipelineVertexInputStateCreateInfo* layout)
 {
 	this->currentVertexLayout = layout;
-	IndexT index = this->ct3->children.FindIndex(layout);
-	if (index != InvalidIndex)
-	{
-		this->ct4 = this->ct3->children.ValueAtIndex(index);
-		this->SetInputLayout(this->currentInputAssemblyInfo);
-	}
-	else
-	{
-		this->ct4 = n_new(Tier4Node);
-		this->ct3->children.Add(layout, this->ct4);
-		this->SetInputLayout(this->currentInputAssemblyInfo);
-	}
 }
 
 //------------------------------------------------------------------------------
@@ -139,76 +133,149 @@ void
 VkPipelineDatabase::SetInputLayout(VkPipelineInputAssemblyStateCreateInfo* input)
 {
 	this->currentInputAssemblyInfo = input;
-	IndexT index = this->ct4->children.FindIndex(input);
+}
+
+//------------------------------------------------------------------------------
+/**
+	The input assembly state is hashed by value, since the same structure
+	is modified in place whenever the primitive topology changes.
+*/
+VkPipelineDatabase::PipelineKey
+VkPipelineDatabase::CurrentKey() const
+{
+	PipelineKey key;
+	key.program = this->currentShaderProgram.HashCode64();
+	key.vertexLayout = (uint64_t)(uintptr_t)this->currentVertexLayout;
+	key.pass = (Ids::Id32)this->currentPass;
+	key.subpass = this->currentSubpass;
+	key.topology = this->currentInputAssemblyInfo != nullptr ? (uint32_t)this->currentInputAssemblyInfo->topology : 0;
+	key.primitiveRestart = this->currentInputAssemblyInfo != nullptr ? (uint32_t)this->currentInputAssemblyInfo->primitiveRestartEnable : 0;
+	return key;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+VkPipeline
+VkPipelineDatabase::GetCompiledPipeline()
+{
+	n_assert(this->dev != VK_NULL_HANDLE);
+	n_assert(this->cache != VK_NULL_HANDLE);
+	n_assert(this->currentInputAssemblyInfo != nullptr);
+
+	const PipelineKey key = this->CurrentKey();
+	IndexT index = this->pipelines.FindIndex(key);
 	if (index != InvalidIndex)
 	{
-		this->ct5 = this->ct4->children.ValueAtIndex(index);
+		Entry& entry = this->pipelines.ValueAtIndex(key, index);
+		if (entry.pipeline == VK_NULL_HANDLE)
+			entry.pipeline = this->CreatePipeline(entry);
+		this->currentPipeline = entry.pipeline;
 	}
 	else
 	{
-		this->ct5 = n_new(Tier5Node);
-		this->ct4->children.Add(input, this->ct5);
+		Entry entry;
+		entry.pass = this->currentPass;
+		entry.subpass = this->currentSubpass;
+		entry.shaderInfo = this->currentShaderInfo;
+		entry.vertexLayout = this->currentVertexLayout;
+		entry.inputAssembly = *this->currentInputAssemblyInfo;
+		entry.pipeline = this->CreatePipeline(entry);
+		this->pipelines.Add(key, entry);
+		this->currentPipeline = entry.pipeline;
 	}
+
+	return this->currentPipeline;
 }
 
 //------------------------------------------------------------------------------
 /**
 */
 VkPipeline
-VkPipelineDatabase::GetCompiledPipeline()
+VkPipelineDatabase::CreatePipeline(const Entry& entry)
 {
-	n_assert(this->dev != VK_NULL_HANDLE);
-	n_assert(this->cache != VK_NULL_HANDLE);
-	if (this->ct1->initial ||
-		this->ct2->initial ||
-		this->ct3->initial ||
-		this->ct4->initial ||
-		this->ct5->initial)
+	// get fragment of graphics pipeline residing in shader
+	const VkGraphicsPipelineCreateInfo& shaderInfo = entry.shaderInfo;
+
+	// get other fragment from framebuffer, passes only exist on a real device
+	const VkPipelineViewportStateCreateInfo* viewportState = nullptr;
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+	VkPipelineColorBlendStateCreateInfo colorBlendInfo = *shaderInfo.pColorBlendState;
+	if (this->createFunc == DefaultCreatePipeline)
 	{
-		// get fragment of graphics pipeline residing in shader
-		VkGraphicsPipelineCreateInfo shaderInfo = this->currentShaderInfo;
+		viewportState = PassGetVkFramebufferInfo(entry.pass).pViewportState;
+		renderPass = PassGetVkRenderPassBeginInfo(entry.pass).renderPass;
+		colorBlendInfo.attachmentCount = PassGetNumSubpassAttachments(entry.pass, entry.subpass);
+	}
 
-		// get other fragment from framebuffer
-		VkGraphicsPipelineCreateInfo passInfo = PassGetVkFramebufferInfo(this->currentPass);
-		VkPipelineColorBlendStateCreateInfo colorBlendInfo = *shaderInfo.pColorBlendState;
-		colorBlendInfo.attachmentCount = PassGetNumSubpassAttachments(this->currentPass, this->currentSubpass);
+	// use shader, framebuffer, vertex input and layout, input assembly and pass info to construct a complete pipeline
+	VkGraphicsPipelineCreateInfo info =
+	{
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		NULL,
+		0,
+		shaderInfo.stageCount,
+		shaderInfo.pStages,
+		entry.vertexLayout,
+		&entry.inputAssembly,
+		shaderInfo.pTessellationState,
+		viewportState,
+		shaderInfo.pRasterizationState,
+		shaderInfo.pMultisampleState,
+		shaderInfo.pDepthStencilState,
+		&colorBlendInfo,
+		shaderInfo.pDynamicState,
+		shaderInfo.layout,
+		renderPass,
+		entry.subpass,
+		VK_NULL_HANDLE,
+		-1
+	};
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult res = this->createFunc(this->dev, this->cache, &info, &pipeline);
+	n_assert(res == VK_SUCCESS);
+	return pipeline;
+}
 
-		// use shader, framebuffer, vertex input and layout, input assembly and pass info to construct a complete pipeline
-		VkGraphicsPipelineCreateInfo info =
-		{
-			VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-			NULL,
-			0,
-			shaderInfo.stageCount,
-			shaderInfo.pStages,
-			this->currentVertexLayout,
-			this->currentInputAssemblyInfo,
-			shaderInfo.pTessellationState,
-			passInfo.pViewportState,
-			shaderInfo.pRasterizationState,
-			shaderInfo.pMultisampleState,
-			shaderInfo.pDepthStencilState,
-			&colorBlendInfo,
-			shaderInfo.pDynamicState,
-			shaderInfo.layout,
-			PassGetVkRenderPassBeginInfo(this->currentPass).renderPass,
-			this->currentSubpass,
-			VK_NULL_HANDLE,
-			-1
-		};
-		VkResult res = vkCreateGraphicsPipelines(this->dev, this->cache, 1, &info, NULL, &this->currentPipeline);
-		n_assert(res == VK_SUCCESS);
-		this->ct5->pipeline = this->currentPipeline;
+//------------------------------------------------------------------------------
+/**
+*/
+VkResult
+VkPipelineDatabase::DefaultCreatePipeline(VkDevice dev, VkPipelineCache cache, const VkGraphicsPipelineCreateInfo* info, VkPipeline* pipeline)
+{
+	return vkCreateGraphicsPipelines(dev, cache, 1, info, nullptr, pipeline);
+}
 
-		// DAG path is created, so set entire path to not initial
-		this->ct1->initial = this->ct2->initial = this->ct3->initial = this->ct4->initial = this->ct5->initial = false;
-	}
-	else
-	{
-		this->currentPipeline = this->ct5->pipeline;
-	}
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VkPipelineDatabase::DefaultDestroyPipeline(VkDevice dev, VkPipeline pipeline)
+{
+	vkDestroyPipeline(dev, pipeline, nullptr);
+}
 
-	return this->currentPipeline;
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VkPipelineDatabase::DestroyPipeline(VkPipeline pipeline)
+{
+	if (this->destroyFunc != nullptr)
+		this->destroyFunc(this->dev, pipeline);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VkPipelineDatabase::DestroyRetiredPipelines(IndexT cycle)
+{
+	Util::Array<VkPipeline>& retired = this->retiredPipelines[cycle];
+	IndexT i;
+	for (i = 0; i < retired.Size(); i++)
+		this->DestroyPipeline(retired[i]);
+	retired.Clear();
 }
 
 //------------------------------------------------------------------------------
@@ -220,127 +287,115 @@ VkPipelineDatabase::Reset()
 	this->currentPass = CoreGraphics::PassId::Invalid();
 	this->currentSubpass = -1;
 	this->currentShaderProgram = CoreGraphics::ShaderProgramId::Invalid();
-	this->currentVertexLayout = 0;
-	this->currentInputAssemblyInfo = 0;
+	this->currentVertexLayout = nullptr;
+	this->currentInputAssemblyInfo = nullptr;
 	this->currentPipeline = VK_NULL_HANDLE;
-	this->ct1 = NULL;
-	this->ct2 = NULL;
-	this->ct3 = NULL;
-	this->ct4 = NULL;
-	this->ct5 = NULL;
 }
 
 //------------------------------------------------------------------------------
 /**
+	The shader state stored with the pipelines belongs to the old program,
+	so entries using it are removed and get recreated on their next use.
+	Frames in flight may still use the old pipelines, so they are retired
+	and destroyed by NextCycle.
 */
-void 
+void
 VkPipelineDatabase::Reload(const CoreGraphics::ShaderProgramId id)
 {
-	// save initial state
-	Tier1Node* tmp1 = this->ct1;
-	Tier2Node* tmp2 = this->ct2;
-	Tier3Node* tmp3 = this->ct3;
-	Tier4Node* tmp4 = this->ct4;
-	Tier5Node* tmp5 = this->ct5;
-
-	// walk through the tree and update every pipeline using the shader
+	n_assert(!this->retiredPipelines.IsEmpty());
+	const uint64_t program = id.HashCode64();
+	Util::Array<PipelineKey> keys = this->pipelines.KeysAsArray();
 	IndexT i;
-	for (i = 0; i < this->tier1.Size(); i++)
+	for (i = 0; i < keys.Size(); i++)
 	{
-		Tier1Node* t1 = this->tier1.ValueAtIndex(i);
-		
-		IndexT j;
-		for (j = 0; j < t1->children.Size(); j++)
+		if (keys[i].program == program)
 		{
-			Tier2Node* t2 = t1->children.ValueAtIndex(j);
-
-			IndexT k;
-			for (k = 0; k < t2->children.Size(); k++)
+			VkPipeline pipeline = this->pipelines[keys[i]].pipeline;
+			if (pipeline != VK_NULL_HANDLE)
 			{
-				const CoreGraphics::ShaderProgramId& prog = t2->children.KeyAtIndex(k);
-				Tier3Node* t3 = t2->children.ValueAtIndex(k);
-				// shaders match, so start a reload!
-				if (prog == id)
-				{
-					t3->initial = true;
-					
-					IndexT l;
-					for (l = 0; l < t3->children.Size(); l++)
-					{
-						Tier4Node* t4 = t3->children.ValueAtIndex(l);
-
-						IndexT m;
-						for (m = 0; m < t4->children.Size(); m++)
-						{
-							Tier5Node* t5 = t4->children.ValueAtIndex(m);
-							this->ct1 = t1;
-							this->ct2 = t2;
-							this->ct3 = t3;
-							this->ct4 = t4;
-							this->ct5 = t5;
-
-							// since t3 is initial, we will create a new pipeline
-							//this->GetCompiledPipeline();
-						}
-					}
-				}
+				this->retiredPipelines[this->currentCycle].Append(pipeline);
+				if (pipeline == this->currentPipeline)
+					this->currentPipeline = VK_NULL_HANDLE;
 			}
+			this->pipelines.Erase(keys[i]);
 		}
 	}
-
-	// reset old state
-	this->ct1 = tmp1;
-	this->ct2 = tmp2;
-	this->ct3 = tmp3;
-	this->ct4 = tmp4;
-	this->ct5 = tmp5;
 }
 
 //------------------------------------------------------------------------------
 /**
+	Destroys all pipelines and compiles them again right away, the
+	pipeline cache makes this cheap compared to creating them on their
+	first draw. The pipelines are destroyed immediately, so the device
+	must be idle.
 */
 void
 VkPipelineDatabase::RecreatePipelines()
 {
-    IndexT i;
-    for (i = 0; i < this->tier1.Size(); i++)
-    {
-        Tier1Node* t1 = this->tier1.ValueAtIndex(i);
-
-        IndexT j;
-        for (j = 0; j < t1->children.Size(); j++)
-        {
-            Tier2Node* t2 = t1->children.ValueAtIndex(j);
-
-            IndexT k;
-            for (k = 0; k < t2->children.Size(); k++)
-            {
-                Tier3Node* t3 = t2->children.ValueAtIndex(k);
+	auto it = this->pipelines.Begin();
+	while (it != this->pipelines.End())
+	{
+		if (it.val->pipeline != VK_NULL_HANDLE)
+		{
+			// destroy any existing pipeline
+			this->DestroyPipeline(it.val->pipeline);
+			it.val->pipeline = VK_NULL_HANDLE;
+		}
+		it++;
+	}
+	this->currentPipeline = VK_NULL_HANDLE;
+	this->Precompile();
+}
 
-                IndexT l;
-                for (l = 0; l < t3->children.Size(); l++)
-                {
-                    Tier4Node* t4 = t3->children.ValueAtIndex(l);
+//------------------------------------------------------------------------------
+/**
+*/
+void
+VkPipelineDatabase::Precompile()
+{
+	auto it = this->pipelines.Begin();
+	while (it != this->pipelines.End())
+	{
+		if (it.val->pipeline == VK_NULL_HANDLE)
+			it.val->pipeline = this->CreatePipeline(*it.val);
+		it++;
+	}
+}
 
-                    IndexT m;
-                    for (m = 0; m < t4->children.Size(); m++)
-                    {
-                        Tier5Node* t5 = t4->children.ValueAtIndex(m);
+//------------------------------------------------------------------------------
+/**
+	The cycle advances once per frame, like the graphics submission
+	context. By the time a cycle comes around again, the submission of the
+	frame which retired its pipelines has been waited for.
+*/
+void
+VkPipelineDatabase::NextCycle()
+{
+	n_assert(!this->retiredPipelines.IsEmpty());
+	this->currentCycle = (this->currentCycle + 1) % this->retiredPipelines.Size();
+	this->DestroyRetiredPipelines(this->currentCycle);
+}
 
-                        if (t5->pipeline != VK_NULL_HANDLE)
-                        {
-                            // destroy any existing pipeline
-                            vkDestroyPipeline(this->dev, t5->pipeline, nullptr);
-                            t5->pipeline = VK_NULL_HANDLE;
-                        }
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+VkPipelineDatabase::GetNumPipelines() const
+{
+	return this->pipelines.Size();
+}
 
-                        // set t5 to initial, so that the next time we try to get compiled pipeline, it gets recreated
-                        t5->initial = true;
-                    }
-                }
-            }
-        }
-    }
+//------------------------------------------------------------------------------
+/**
+*/
+SizeT
+VkPipelineDatabase::GetNumRetiredPipelines() const
+{
+	SizeT num = 0;
+	IndexT i;
+	for (i = 0; i < this->retiredPipelines.Size(); i++)
+		num += this->retiredPipelines[i].Size();
+	return num;
 }
 
 } // namespace Vulkan
@@ -2,18 +2,29 @@
 //------------------------------------------------------------------------------
 /**
 	VkPipelineDatabase implements something akin to a VkPipelineCache.
-	It works in a tree-like structure, where frequency of change dictates
-	which level the state belongs to.
-
-	It works by incrementally creating a DAG, which at the end points to 
-	a path used to create a graphics pipeline. If it has already been created,
-	then the pipeline is simply returned, however, if a node is set to initial
-	(which happens on construction, meaning all children are also initial),
-	then a new graphics pipeline is created and gets associated with the DAG path.
-	
-	It can be slightly more efficient, currently, whenever a state is changed high up in the DAG,
-	child nodes are created for the rest of the currently used state. This is somewhat unnecessary,
-	instead, the nodes should be created when and if we actually do create a pipeline. 
+
+	All state which affects a graphics pipeline is packed into a single
+	PipelineKey, which is looked up in a flat hash table when a pipeline is
+	requested. If the key has been seen before the pipeline is simply returned,
+	otherwise a new graphics pipeline is created and stored with the key.
+
+	Every entry remembers the state needed to build its pipeline, so that
+	all previously seen pipelines can be compiled up front when they have
+	been invalidated, for example on a window resize, instead of stalling
+	the first draw which uses them.
+
+	Pipelines removed by Reload may still be used by frames in flight, so
+	they are retired and only destroyed by NextCycle, once the graphics
+	submission of the frame in which they were retired has finished.
+
+	Pipelines are still compiled on the calling thread, both on first use
+	and by RecreatePipelines and Precompile.
+
+	Pipeline creation and destruction go through replaceable functions,
+	which allows the database to be driven without a GPU by setting mock
+	functions with SetCreatePipelineFunc. Pipelines created by a mock
+	function don't get the state of their pass, since passes only exist
+	on a real device.
 
 	(C) 2016-2020 Individual contributors, see AUTHORS file
 */
@@ -21,36 +32,50 @@
 #include "core/singleton.h"
 #include "coregraphics/shader.h"
 #include "coregraphics/pass.h"
+#include "util/flathashtable.h"
+#include "util/fixedarray.h"
 
 namespace Vulkan
 {
-class VkVertexLayout;
-class VkShaderProgram;
-class VkPass;
 class VkPipelineDatabase
 {
 	__DeclareSingleton(VkPipelineDatabase);
 public:
 
-	enum StateLevel
+	/// the complete state used to look up a pipeline
+	struct PipelineKey
 	{
-		PassLevel,
-		SubpassLevel,
-		ShaderLevel,
-		VertexLayoutLevel,
-		InputAssemblyLevel,
-		PipelineLevel
+		uint64_t program;
+		uint64_t vertexLayout;
+		uint32_t pass;
+		uint32_t subpass;
+		uint32_t topology;
+		uint32_t primitiveRestart;
+
+		/// compare keys
+		bool operator==(const PipelineKey& rhs) const;
+		/// compare keys
+		bool operator!=(const PipelineKey& rhs) const;
+		/// hash key
+		IndexT HashCode() const;
 	};
 
+	/// function used to create pipelines, mirrors vkCreateGraphicsPipelines for a single pipeline
+	typedef VkResult(*CreatePipelineFunc)(VkDevice dev, VkPipelineCache cache, const VkGraphicsPipelineCreateInfo* info, VkPipeline* pipeline);
+	/// function used to destroy pipelines, mirrors vkDestroyPipeline
+	typedef void(*DestroyPipelineFunc)(VkDevice dev, VkPipeline pipeline);
+
 	/// constructor
 	VkPipelineDatabase();
 	/// destructor
 	virtual ~VkPipelineDatabase();
 
-	/// setup database
-	void Setup(const VkDevice dev, const VkPipelineCache cache);
+	/// setup database, numBufferedFrames is the number of frames which may be in flight
+	void Setup(const VkDevice dev, const VkPipelineCache cache, SizeT numBufferedFrames);
 	/// discard database
 	void Discard();
+	/// set the functions used to create and destroy pipelines, a nullptr create function restores the Vulkan functions
+	void SetCreatePipelineFunc(CreatePipelineFunc createFunc, DestroyPipelineFunc destroyFunc = nullptr);
 
 	/// set pass
 	void SetPass(const CoreGraphics::PassId pass);
@@ -69,62 +94,96 @@ public:
 
 	/// re-creates all pipelines for the given shader program id
 	void Reload(const CoreGraphics::ShaderProgramId id);
-    /// re-creates all pipelines for all shader programs
-    void RecreatePipelines();
+	/// re-creates all pipelines for all shader programs
+	void RecreatePipelines();
+	/// compile all known pipelines which have been invalidated
+	void Precompile();
+	/// advance to the next frame, call after waiting for the graphics submission of the oldest frame in flight
+	void NextCycle();
+
+	/// get number of pipelines known by the database
+	SizeT GetNumPipelines() const;
+	/// get number of retired pipelines waiting to be destroyed
+	SizeT GetNumRetiredPipelines() const;
+
 private:
-	
+
+	struct Entry
+	{
+		VkPipeline pipeline;
+		CoreGraphics::PassId pass;
+		uint32_t subpass;
+		VkGraphicsPipelineCreateInfo shaderInfo;
+		VkPipelineVertexInputStateCreateInfo* vertexLayout;
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+	};
+
+	/// build key from the current state
+	PipelineKey CurrentKey() const;
+	/// create pipeline for entry
+	VkPipeline CreatePipeline(const Entry& entry);
+	/// destroy a pipeline right away
+	void DestroyPipeline(VkPipeline pipeline);
+	/// destroy all pipelines retired in a cycle
+	void DestroyRetiredPipelines(IndexT cycle);
+	/// default create function
+	static VkResult DefaultCreatePipeline(VkDevice dev, VkPipelineCache cache, const VkGraphicsPipelineCreateInfo* info, VkPipeline* pipeline);
+	/// default destroy function
+	static void DefaultDestroyPipeline(VkDevice dev, VkPipeline pipeline);
+
 	VkDevice dev;
 	VkPipelineCache cache;
+	CreatePipelineFunc createFunc;
+	DestroyPipelineFunc destroyFunc;
 	CoreGraphics::PassId currentPass;
 	uint32_t currentSubpass;
 	CoreGraphics::ShaderProgramId currentShaderProgram;
 	VkGraphicsPipelineCreateInfo currentShaderInfo;
 	VkPipelineVertexInputStateCreateInfo* currentVertexLayout;
 	VkPipelineInputAssemblyStateCreateInfo* currentInputAssemblyInfo;
-	StateLevel currentLevel;
+	VkPipeline currentPipeline;
 
-	struct Tier1Node;
-	struct Tier2Node;
-	struct Tier3Node;
-	struct Tier4Node;
-	struct Tier5Node;
+	Util::FlatHashTable<PipelineKey, Entry> pipelines;
 
-	struct BaseNode
-	{
-		bool initial;
+	/// pipelines waiting for the frames which might use them to finish, per cycle
+	Util::FixedArray<Util::Array<VkPipeline>> retiredPipelines;
+	IndexT currentCycle;
+};
 
-		BaseNode() : initial(true) {}
-	};
-	struct Tier1Node : public BaseNode
-	{
-        // IndexT == subpass id
-		Util::Dictionary<IndexT, Tier2Node*> children;
-	};
-	struct Tier2Node : public BaseNode
-	{
-		Util::Dictionary<CoreGraphics::ShaderProgramId, Tier3Node*> children;
-	};
-	struct Tier3Node : public BaseNode
-	{
-		Util::Dictionary<VkPipelineVertexInputStateCreateInfo*, Tier4Node*> children;
-	};
-	struct Tier4Node : public BaseNode
-	{
-		Util::Dictionary<VkPipelineInputAssemblyStateCreateInfo*, Tier5Node*> children;
-	};
-	struct Tier5Node : public BaseNode
-	{
-		VkPipeline pipeline = VK_NULL_HANDLE;
-	};
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+VkPipelineDatabase::PipelineKey::operator==(const PipelineKey& rhs) const
+{
+	return this->program == rhs.program
+		&& this->vertexLayout == rhs.vertexLayout
+		&& this->pass == rhs.pass
+		&& this->subpass == rhs.subpass
+		&& this->topology == rhs.topology
+		&& this->primitiveRestart == rhs.primitiveRestart;
+}
 
-	Util::Dictionary<CoreGraphics::PassId, Tier1Node*> tier1;
-	IndexT tier1Iterator;
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+VkPipelineDatabase::PipelineKey::operator!=(const PipelineKey& rhs) const
+{
+	return !(*this == rhs);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline IndexT
+VkPipelineDatabase::PipelineKey::HashCode() const
+{
+	uint64_t h = this->program * 0x9E3779B97F4A7C15ull;
+	h ^= this->vertexLayout + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	h ^= ((uint64_t)this->pass << 32 | this->subpass) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	h ^= ((uint64_t)this->topology << 32 | this->primitiveRestart) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	return (IndexT)((h ^ (h >> 32)) & 0x7fffffff);
+}
 
-	Tier1Node* ct1;
-	Tier2Node* ct2;
-	Tier3Node* ct3;
-	Tier4Node* ct4;
-	Tier5Node* ct5;
-	VkPipeline currentPipeline;
-};
 } // namespace Vulkan
@@ -159,6 +159,9 @@ VkShaderServer::RegisterTexture(const CoreGraphics::TextureId& tex, bool depth,
 		idx = this->textureCubePool.Alloc();
 		var = this->textureCubeTextureVar;
 		break;
+	default:
+		n_error("VkShaderServer::RegisterTexture(): texture type %d has no bindless texture table\n", type);
+		return 0;
 	}
 
 	ResourceTableTexture info;
@@ -198,6 +201,9 @@ VkShaderServer::UnregisterTexture(const uint32_t id, const CoreGraphics::Texture
 	case TextureCube:
 		this->textureCubePool.Free(id);
 		break;
+	default:
+		n_error("VkShaderServer::UnregisterTexture(): texture type %d has no bindless texture table\n", type);
+		break;
 	}
 }
 
@@ -7,7 +7,7 @@
 #include "coregraphics/texture.h"
 #include "io/ioserver.h"
 #include "coregraphics/vk/vktypes.h"
-#include "IL/il.h"
+#include "vktexturecontainer.h"
 
 #include <vulkan/vulkan.h>
 #include "vkgraphicsdevice.h"
@@ -92,25 +92,30 @@ VkStreamTexturePool::LoadFromStream(const Resources::ResourceId res, const Util:
 	VkPhysicalDevice physicalDev = Vulkan::GetCurrentPhysicalDevice();
 	VkDevice dev = Vulkan::GetCurrentDevice();
 
-	// load using IL
-	ILuint image = ilGenImage();
-	ilBindImage(image);
-	ilSetInteger(IL_DXTC_NO_DECOMPRESS, IL_TRUE);
-	ilLoadL(IL_DDS, srcData, srcDataSize);
-
-	ILuint width = ilGetInteger(IL_IMAGE_WIDTH);
-	ILuint height = ilGetInteger(IL_IMAGE_HEIGHT);
-	ILuint depth = ilGetInteger(IL_IMAGE_DEPTH);
-	ILuint bpp = ilGetInteger(IL_IMAGE_BYTES_PER_PIXEL);
-	ILuint numImages = ilGetInteger(IL_NUM_IMAGES);
-	ILuint numFaces = ilGetInteger(IL_NUM_FACES);
-	ILuint numLayers = ilGetInteger(IL_NUM_LAYERS);
-	ILuint mips = ilGetInteger(IL_NUM_MIPMAPS);
-	ILenum cube = ilGetInteger(IL_IMAGE_CUBEFLAGS);
-	ILenum format = ilGetInteger(IL_PIXEL_FORMAT);	// only available when loading DDS, so this might need some work...
-
-	VkFormat vkformat = VkTypes::AsVkFormat(format);
-	VkTypes::VkBlockDimensions block = VkTypes::AsVkBlockSize(vkformat);
+	// parse the container in place, the pixel data is uploaded straight from the mapped stream
+	VkTextureContainer::Layout layout;
+	if (!VkTextureContainer::Parse(srcData, srcDataSize, layout))
+	{
+		n_warning("VkStreamTexturePool::LoadFromStream(): '%s' is not a supported DDS or KTX2 texture\n", stream->GetURI().LocalPath().AsCharPtr());
+		stream->Unmap();
+		return ResourcePool::Failed;
+	}
+
+	VkFormat vkformat = layout.format;
+	const bool cube = layout.cube;
+	const uint32_t width = layout.width;
+	const uint32_t height = layout.height;
+	const uint32_t depth = layout.depth;
+	const uint32_t mips = layout.mips;
+	const uint32_t arrayLayers = layout.cube ? layout.layers / 6 : layout.layers;
+
+	// the shader server has no bindless table for cube arrays
+	if (cube && arrayLayers > 1)
+	{
+		n_warning("VkStreamTexturePool::LoadFromStream(): '%s' is a cube array, which is not supported\n", stream->GetURI().LocalPath().AsCharPtr());
+		stream->Unmap();
+		return ResourcePool::Failed;
+	}
 
 	// use linear if we really have to
 	VkFormatProperties formatProps;
@@ -121,22 +126,21 @@ VkStreamTexturePool::LoadFromStream(const Resources::ResourceId res, const Util:
 		forceLinear = true;
 	}
 
-	// create image
+	// create image, 1D textures are created as 2D textures with a height of 1 so they can be bound like any other 2D texture
 	VkExtent3D extents;
 	extents.width = width;
 	extents.height = height;
-	extents.depth = 1;
-	//auto queues = Vulkan::GetQueueFamilies();
+	extents.depth = depth;
 	VkImageCreateInfo info =
 	{
 		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
 		NULL,
 		cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0,
-		depth > 1 ? VK_IMAGE_TYPE_3D : (height > 1 ? VK_IMAGE_TYPE_2D : VK_IMAGE_TYPE_1D),
+		depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D,
 		vkformat,
 		extents,
 		mips,
-		cube ? (uint32_t)numFaces : (uint32_t)numImages,
+		layout.layers,
 		VK_SAMPLE_COUNT_1_BIT,
 		forceLinear ? VK_IMAGE_TILING_LINEAR : VK_IMAGE_TILING_OPTIMAL,
 		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
@@ -169,78 +173,23 @@ VkStreamTexturePool::LoadFromStream(const Resources::ResourceId res, const Util:
 		CoreGraphics::BarrierStage::Host,
 		CoreGraphics::BarrierStage::Transfer,
 		VkUtilities::ImageMemoryBarrier(loadInfo.img, subres, VK_ACCESS_HOST_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
-	
-	uint32_t remainingBytes = alignedSize;
 
-	// now load texture by walking through all images and mips
-	ILuint i;
-	ILuint j;
-	if (cube)
+	// upload every mip of every layer and face directly from the mapped file
+	IndexT i;
+	for (i = 0; i < layout.subresources.Size(); i++)
 	{
-		for (i = 0; i < 6; i++)
-		{
-			ilBindImage(image);
-			ilActiveFace(i);
-			ilActiveMipmap(0);
-			for (j = 0; j < mips; j++)
-			{
-				// move to next mip
-				ilBindImage(image);
-				ilActiveFace(i);
-				ilActiveMipmap(j);
-
-				ILuint size = ilGetInteger(IL_IMAGE_SIZE_OF_DATA);
-				remainingBytes -= size;
-				n_assert(remainingBytes >= 0);
-				ILubyte* buf = ilGetData();
-
-				int32_t mipWidth = (int32_t)Math::n_max(1.0f, Math::n_floor(width / Math::n_pow(2, (float)j)));
-				int32_t mipHeight = (int32_t)Math::n_max(1.0f, Math::n_floor(height / Math::n_pow(2, (float)j)));
-				int32_t mipDepth = (int32_t)Math::n_max(1.0f, Math::n_floor(depth / Math::n_pow(2, (float)j)));
-
-				info.extent.width = mipWidth;
-				info.extent.height = mipHeight;
-				info.extent.depth = 1;
-
-				VkBuffer outBuf;
-				VkDeviceMemory outMem;
-				VkUtilities::ImageUpdate(dev, CoreGraphics::SubmissionContextGetCmdBuffer(sub), TransferQueueType, loadInfo.img, info, j, i, size, (uint32_t*)buf, outBuf, outMem);
-
-				// add host memory buffer, intermediate device memory, and intermediate device buffer to delete queue
-				SubmissionContextFreeDeviceMemory(sub, dev, outMem);
-				SubmissionContextFreeBuffer(sub, dev, outBuf);
-			}
-		}
-	}
-	else
-	{
-		for (j = 0; j < mips; j++)
-		{
-			// move to next mip
-			ilBindImage(image);
-			ilActiveMipmap(j);
-
-			ILuint size = ilGetInteger(IL_IMAGE_SIZE_OF_DATA);
-			remainingBytes -= size;
-			n_assert(remainingBytes >= 0);
-			ILubyte* buf = ilGetData();
-
-			int32_t mipWidth = (int32_t)Math::n_max(1.0f, Math::n_floor(width / Math::n_pow(2, (float)j)));
-			int32_t mipHeight = (int32_t)Math::n_max(1.0f, Math::n_floor(height / Math::n_pow(2, (float)j)));
-			int32_t mipDepth = (int32_t)Math::n_max(1.0f, Math::n_floor(depth / Math::n_pow(2, (float)j)));
-
-			info.extent.width = mipWidth;
-			info.extent.height = mipHeight;
-			info.extent.depth = 1;
-
-			VkBuffer outBuf;
-			VkDeviceMemory outMem;
-			VkUtilities::ImageUpdate(dev, CoreGraphics::SubmissionContextGetCmdBuffer(sub), TransferQueueType, loadInfo.img, info, j, 0, size, (uint32_t*)buf, outBuf, outMem);
-
-			// add host memory buffer, intermediate device memory, and intermediate device buffer to delete queue
-			SubmissionContextFreeDeviceMemory(sub, dev, outMem);
-			SubmissionContextFreeBuffer(sub, dev, outBuf);
-		}
+		const VkTextureContainer::Subresource& region = layout.subresources[i];
+		info.extent.width = region.width;
+		info.extent.height = region.height;
+		info.extent.depth = region.depth;
+
+		VkBuffer outBuf;
+		VkDeviceMemory outMem;
+		VkUtilities::ImageUpdate(dev, CoreGraphics::SubmissionContextGetCmdBuffer(sub), TransferQueueType, loadInfo.img, info, region.mip, region.layer, region.size, (uint32_t*)((ubyte*)srcData + region.offset), outBuf, outMem);
+
+		// add host memory buffer, intermediate device memory, and intermediate device buffer to delete queue
+		SubmissionContextFreeDeviceMemory(sub, dev, outMem);
+		SubmissionContextFreeBuffer(sub, dev, outBuf);
 	}
 
 	// transition image to be used for rendering
@@ -255,26 +204,27 @@ VkStreamTexturePool::LoadFromStream(const Resources::ResourceId res, const Util:
 		CoreGraphics::BarrierStage::Transfer,
 		CoreGraphics::BarrierStage::AllGraphicsShaders,
 		VkUtilities::ImageMemoryBarrier(loadInfo.img, subres, TransferQueueType, GraphicsQueueType, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
-		
-	ilDeleteImage(image);
 
 	// create view
 	VkImageViewType viewType;
-	if (cube) viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+	CoreGraphics::TextureType type;
+	if (cube)
+	{
+		viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+		type = CoreGraphics::TextureCube;
+	}
+	else if (depth > 1)
+	{
+		viewType = VK_IMAGE_VIEW_TYPE_3D;
+		type = CoreGraphics::Texture3D;
+	}
 	else
 	{
-		if (height > 1)
-		{
-			if (depth > 1) viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
-			else		   viewType = VK_IMAGE_VIEW_TYPE_2D;
-		}
-		else
-		{
-			if (depth > 1) viewType = VK_IMAGE_VIEW_TYPE_1D_ARRAY;
-			else		   viewType = VK_IMAGE_VIEW_TYPE_1D;
-		}
+		viewType = arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+		type = arrayLayers > 1 ? CoreGraphics::Texture2DArray : CoreGraphics::Texture2D;
 	}
 
+	// formats are read with their real channel order, so no swizzle is needed
 	VkImageViewCreateInfo viewCreate =
 	{
 		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -283,8 +233,7 @@ VkStreamTexturePool::LoadFromStream(const Resources::ResourceId res, const Util:
 		loadInfo.img,
 		viewType,
 		vkformat,
-		//VK_FORMAT_R8G8B8A8_UNORM,
-		VkTypes::AsVkMapping(format),
+		{ VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
 		subres
 	};
 	stat = vkCreateImageView(dev, &viewCreate, NULL, &runtimeInfo.view);
@@ -293,10 +242,11 @@ VkStreamTexturePool::LoadFromStream(const Resources::ResourceId res, const Util:
 	loadInfo.dims.width = width;
 	loadInfo.dims.height = height;
 	loadInfo.dims.depth = depth;
-	loadInfo.mips = Math::n_max(mips, 1u);
+	loadInfo.mips = mips;
+	loadInfo.layers = layout.layers;
 	loadInfo.format = VkTypes::AsNebulaPixelFormat(vkformat);
 	loadInfo.dev = dev;
-	runtimeInfo.type = cube ? CoreGraphics::TextureCube : depth > 1 ? CoreGraphics::Texture3D : CoreGraphics::Texture2D;
+	runtimeInfo.type = type;
 	runtimeInfo.bind = VkShaderServer::Instance()->RegisterTexture(TextureId(res), false, runtimeInfo.type);
 
 	stream->Unmap();
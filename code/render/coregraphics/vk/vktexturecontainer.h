@@ -0,0 +1,424 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Parses DDS and KTX2 texture containers directly from memory.
+
+	The parser doesn't copy or convert any pixel data, it only validates the
+	header and computes the format and the offset and size of every mip, array
+	layer and cube face within the source buffer. This means a texture can be
+	uploaded straight from a mapped file, and because there is no global
+	state, several textures can be parsed in parallel.
+
+	Only formats that can be sampled without conversion are accepted, which
+	covers everything the texture converter produces. KTX2 files using
+	supercompression are not supported.
+
+	(C) 2020 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/types.h"
+#include "util/array.h"
+#include "math/scalar.h"
+#include <vulkan/vulkan.h>
+
+namespace Vulkan
+{
+class VkTextureContainer
+{
+public:
+
+	/// a single mip of an array layer or cube face, for 3D textures it contains all slices
+	struct Subresource
+	{
+		uint32_t mip;
+		uint32_t layer;
+		uint32_t width;
+		uint32_t height;
+		uint32_t depth;
+		SizeT offset;
+		SizeT size;
+	};
+
+	/// layout of a whole texture
+	struct Layout
+	{
+		VkFormat format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t depth;
+		uint32_t mips;
+		uint32_t layers;		// array layers times faces
+		bool cube;
+		Util::Array<Subresource> subresources;
+	};
+
+	/// parse either a DDS or KTX2 file, returns false if the format is unknown or the data is invalid
+	static bool Parse(const void* data, SizeT size, Layout& layout);
+	/// parse DDS file
+	static bool ParseDDS(const void* data, SizeT size, Layout& layout);
+	/// parse KTX2 file
+	static bool ParseKTX2(const void* data, SizeT size, Layout& layout);
+	/// get block dimensions and bytes per block for a format, returns false if format is unsupported
+	static bool GetBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes);
+	/// calculate size of an image with the given dimensions
+	static uint64_t ImageSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth);
+
+private:
+
+	/// read a little endian value at offset
+	template<class TYPE> static TYPE Read(const uint8_t* data, SizeT offset);
+	/// convert DXGI format from DX10 header
+	static VkFormat FromDXGIFormat(uint32_t format);
+	/// convert legacy DDS pixel format
+	static VkFormat FromDDSPixelFormat(const uint8_t* pixelFormat);
+	/// calculate mip dimension
+	static uint32_t MipDimension(uint32_t size, uint32_t mip);
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class TYPE>
+inline TYPE
+VkTextureContainer::Read(const uint8_t* data, SizeT offset)
+{
+	TYPE ret;
+	memcpy(&ret, data + offset, sizeof(TYPE));
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint32_t
+VkTextureContainer::MipDimension(uint32_t size, uint32_t mip)
+{
+	const uint32_t ret = mip < 32 ? size >> mip : 0;
+	return ret > 0 ? ret : 1;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+VkTextureContainer::GetBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes)
+{
+	blockWidth = blockHeight = 1;
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		blockWidth = blockHeight = 4;
+		blockBytes = 8;
+		return true;
+	case VK_FORMAT_BC2_UNORM_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		blockWidth = blockHeight = 4;
+		blockBytes = 16;
+		return true;
+	case VK_FORMAT_R8_UNORM:
+		blockBytes = 1;
+		return true;
+	case VK_FORMAT_R16_SFLOAT:
+		blockBytes = 2;
+		return true;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+	case VK_FORMAT_R16G16_SFLOAT:
+	case VK_FORMAT_R32_SFLOAT:
+	case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		blockBytes = 4;
+		return true;
+	case VK_FORMAT_R16G16B16A16_UNORM:
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+	case VK_FORMAT_R32G32_SFLOAT:
+		blockBytes = 8;
+		return true;
+	case VK_FORMAT_R32G32B32_SFLOAT:
+		blockBytes = 12;
+		return true;
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		blockBytes = 16;
+		return true;
+	default:
+		blockBytes = 0;
+		return false;
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+VkTextureContainer::ImageSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth)
+{
+	uint32_t blockWidth, blockHeight, blockBytes;
+	if (!GetBlockInfo(format, blockWidth, blockHeight, blockBytes))
+		return 0;
+	const uint64_t blocksX = (width + blockWidth - 1) / blockWidth;
+	const uint64_t blocksY = (height + blockHeight - 1) / blockHeight;
+	return blocksX * blocksY * depth * blockBytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline VkFormat
+VkTextureContainer::FromDXGIFormat(uint32_t format)
+{
+	switch (format)
+	{
+	case 2:		return VK_FORMAT_R32G32B32A32_SFLOAT;	// DXGI_FORMAT_R32G32B32A32_FLOAT
+	case 6:		return VK_FORMAT_R32G32B32_SFLOAT;		// DXGI_FORMAT_R32G32B32_FLOAT
+	case 10:	return VK_FORMAT_R16G16B16A16_SFLOAT;	// DXGI_FORMAT_R16G16B16A16_FLOAT
+	case 11:	return VK_FORMAT_R16G16B16A16_UNORM;	// DXGI_FORMAT_R16G16B16A16_UNORM
+	case 16:	return VK_FORMAT_R32G32_SFLOAT;			// DXGI_FORMAT_R32G32_FLOAT
+	case 26:	return VK_FORMAT_B10G11R11_UFLOAT_PACK32;	// DXGI_FORMAT_R11G11B10_FLOAT
+	case 28:	return VK_FORMAT_R8G8B8A8_UNORM;		// DXGI_FORMAT_R8G8B8A8_UNORM
+	case 29:	return VK_FORMAT_R8G8B8A8_SRGB;			// DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+	case 34:	return VK_FORMAT_R16G16_SFLOAT;			// DXGI_FORMAT_R16G16_FLOAT
+	case 41:	return VK_FORMAT_R32_SFLOAT;			// DXGI_FORMAT_R32_FLOAT
+	case 54:	return VK_FORMAT_R16_SFLOAT;			// DXGI_FORMAT_R16_FLOAT
+	case 61:	return VK_FORMAT_R8_UNORM;				// DXGI_FORMAT_R8_UNORM
+	case 71:	return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;	// DXGI_FORMAT_BC1_UNORM
+	case 72:	return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;	// DXGI_FORMAT_BC1_UNORM_SRGB
+	case 74:	return VK_FORMAT_BC2_UNORM_BLOCK;		// DXGI_FORMAT_BC2_UNORM
+	case 75:	return VK_FORMAT_BC2_SRGB_BLOCK;		// DXGI_FORMAT_BC2_UNORM_SRGB
+	case 77:	return VK_FORMAT_BC3_UNORM_BLOCK;		// DXGI_FORMAT_BC3_UNORM
+	case 78:	return VK_FORMAT_BC3_SRGB_BLOCK;		// DXGI_FORMAT_BC3_UNORM_SRGB
+	case 87:	return VK_FORMAT_B8G8R8A8_UNORM;		// DXGI_FORMAT_B8G8R8A8_UNORM
+	case 91:	return VK_FORMAT_B8G8R8A8_SRGB;			// DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+	case 98:	return VK_FORMAT_BC7_UNORM_BLOCK;		// DXGI_FORMAT_BC7_UNORM
+	case 99:	return VK_FORMAT_BC7_SRGB_BLOCK;		// DXGI_FORMAT_BC7_UNORM_SRGB
+	default:	return VK_FORMAT_UNDEFINED;
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+	The pixel format is the DDS_PIXELFORMAT structure, size, flags, fourcc,
+	bit count and the red, green, blue and alpha masks.
+*/
+inline VkFormat
+VkTextureContainer::FromDDSPixelFormat(const uint8_t* pixelFormat)
+{
+	const uint32_t flags = Read<uint32_t>(pixelFormat, 4);
+	const uint32_t fourcc = Read<uint32_t>(pixelFormat, 8);
+	const uint32_t bitCount = Read<uint32_t>(pixelFormat, 12);
+	const uint32_t redMask = Read<uint32_t>(pixelFormat, 16);
+	const uint32_t greenMask = Read<uint32_t>(pixelFormat, 20);
+	const uint32_t blueMask = Read<uint32_t>(pixelFormat, 24);
+
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDPF_RGB = 0x40;
+	const uint32_t DDPF_LUMINANCE = 0x20000;
+	if (flags & DDPF_FOURCC)
+	{
+		switch (fourcc)
+		{
+		case 0x31545844:	return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;	// 'DXT1'
+		case 0x32545844:											// 'DXT2'
+		case 0x33545844:	return VK_FORMAT_BC2_UNORM_BLOCK;		// 'DXT3'
+		case 0x34545844:											// 'DXT4'
+		case 0x35545844:	return VK_FORMAT_BC3_UNORM_BLOCK;		// 'DXT5'
+		case 36:			return VK_FORMAT_R16G16B16A16_UNORM;	// D3DFMT_A16B16G16R16
+		case 111:			return VK_FORMAT_R16_SFLOAT;			// D3DFMT_R16F
+		case 112:			return VK_FORMAT_R16G16_SFLOAT;			// D3DFMT_G16R16F
+		case 113:			return VK_FORMAT_R16G16B16A16_SFLOAT;	// D3DFMT_A16B16G16R16F
+		case 114:			return VK_FORMAT_R32_SFLOAT;			// D3DFMT_R32F
+		case 115:			return VK_FORMAT_R32G32_SFLOAT;			// D3DFMT_G32R32F
+		case 116:			return VK_FORMAT_R32G32B32A32_SFLOAT;	// D3DFMT_A32B32G32R32F
+		default:			return VK_FORMAT_UNDEFINED;
+		}
+	}
+	else if (flags & DDPF_RGB)
+	{
+		if (bitCount == 32 && redMask == 0x00ff0000 && greenMask == 0x0000ff00 && blueMask == 0x000000ff)
+			return VK_FORMAT_B8G8R8A8_UNORM;
+		if (bitCount == 32 && redMask == 0x000000ff && greenMask == 0x0000ff00 && blueMask == 0x00ff0000)
+			return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+	else if ((flags & DDPF_LUMINANCE) && bitCount == 8)
+	{
+		return VK_FORMAT_R8_UNORM;
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+//------------------------------------------------------------------------------
+/**
+	DDS stores every array layer and cube face with its whole mip chain
+	before the next one, with all slices of a volume mip stored together.
+*/
+inline bool
+VkTextureContainer::ParseDDS(const void* data, SizeT size, Layout& layout)
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	const SizeT HeaderSize = 4 + 124;
+	if (size < HeaderSize || Read<uint32_t>(bytes, 0) != 0x20534444 || Read<uint32_t>(bytes, 4) != 124)
+		return false;
+
+	const uint32_t height = Read<uint32_t>(bytes, 12);
+	const uint32_t width = Read<uint32_t>(bytes, 16);
+	const uint32_t depth = Read<uint32_t>(bytes, 24);
+	const uint32_t mips = Read<uint32_t>(bytes, 28);
+	const uint8_t* pixelFormat = bytes + 76;
+	const uint32_t caps2 = Read<uint32_t>(bytes, 112);
+
+	const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	const uint32_t DDSCAPS2_VOLUME = 0x200000;
+	const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+	bool cube = (caps2 & DDSCAPS2_CUBEMAP) != 0;
+	bool volume = (caps2 & DDSCAPS2_VOLUME) != 0;
+	uint32_t arraySize = 1;
+	SizeT offset = HeaderSize;
+
+	if (Read<uint32_t>(pixelFormat, 8) == 0x30315844) // 'DX10'
+	{
+		const SizeT DX10HeaderSize = 20;
+		if (size < HeaderSize + DX10HeaderSize)
+			return false;
+		layout.format = FromDXGIFormat(Read<uint32_t>(bytes, HeaderSize));
+		const uint32_t dimension = Read<uint32_t>(bytes, HeaderSize + 4);
+		cube = (Read<uint32_t>(bytes, HeaderSize + 8) & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+		arraySize = Read<uint32_t>(bytes, HeaderSize + 12);
+		volume = dimension == 4; // D3D10_RESOURCE_DIMENSION_TEXTURE3D
+		offset += DX10HeaderSize;
+	}
+	else
+	{
+		layout.format = FromDDSPixelFormat(pixelFormat);
+	}
+
+	if (layout.format == VK_FORMAT_UNDEFINED || width == 0 || height == 0)
+		return false;
+
+	layout.width = width;
+	layout.height = height;
+	layout.depth = volume ? Math::n_max(depth, 1u) : 1;
+	layout.mips = Math::n_max(mips, 1u);
+	layout.cube = cube && !volume;
+	layout.layers = Math::n_max(arraySize, 1u) * (layout.cube ? 6 : 1);
+	if (layout.mips > 32 || (volume && layout.layers > 1))
+		return false;
+
+	layout.subresources.Clear();
+	layout.subresources.Reserve(layout.layers * layout.mips);
+	uint32_t layer, mip;
+	for (layer = 0; layer < layout.layers; layer++)
+	{
+		for (mip = 0; mip < layout.mips; mip++)
+		{
+			Subresource sub;
+			sub.mip = mip;
+			sub.layer = layer;
+			sub.width = MipDimension(layout.width, mip);
+			sub.height = MipDimension(layout.height, mip);
+			sub.depth = MipDimension(layout.depth, mip);
+			const uint64_t subSize = ImageSize(layout.format, sub.width, sub.height, sub.depth);
+			if (subSize == 0 || (uint64_t)offset + subSize > (uint64_t)size)
+				return false;
+			sub.offset = offset;
+			sub.size = (SizeT)subSize;
+			layout.subresources.Append(sub);
+			offset += sub.size;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+	KTX2 stores every mip level separately, located through the level index,
+	with the array layers and faces of a level stored one after another.
+*/
+inline bool
+VkTextureContainer::ParseKTX2(const void* data, SizeT size, Layout& layout)
+{
+	static const uint8_t Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	const uint8_t* bytes = (const uint8_t*)data;
+	const SizeT HeaderSize = 80;
+	if (size < HeaderSize || memcmp(bytes, Identifier, sizeof(Identifier)) != 0)
+		return false;
+
+	layout.format = (VkFormat)Read<uint32_t>(bytes, 12);
+	const uint32_t width = Read<uint32_t>(bytes, 20);
+	const uint32_t height = Read<uint32_t>(bytes, 24);
+	const uint32_t depth = Read<uint32_t>(bytes, 28);
+	const uint32_t layerCount = Read<uint32_t>(bytes, 32);
+	const uint32_t faceCount = Read<uint32_t>(bytes, 36);
+	const uint32_t levelCount = Read<uint32_t>(bytes, 40);
+	const uint32_t supercompression = Read<uint32_t>(bytes, 44);
+
+	uint32_t blockWidth, blockHeight, blockBytes;
+	if (!GetBlockInfo(layout.format, blockWidth, blockHeight, blockBytes) || supercompression != 0)
+		return false;
+	if (width == 0 || (faceCount != 1 && faceCount != 6) || levelCount > 32)
+		return false;
+
+	layout.width = width;
+	layout.height = Math::n_max(height, 1u);
+	layout.depth = Math::n_max(depth, 1u);
+	layout.mips = Math::n_max(levelCount, 1u);
+	layout.cube = faceCount == 6;
+	layout.layers = Math::n_max(layerCount, 1u) * faceCount;
+	if (layout.depth > 1 && layout.layers > 1)
+		return false;
+
+	// level index follows the header, with byte offset, byte length and uncompressed byte length per level
+	const SizeT LevelIndexEntrySize = 24;
+	if ((uint64_t)HeaderSize + (uint64_t)layout.mips * LevelIndexEntrySize > (uint64_t)size)
+		return false;
+
+	layout.subresources.Clear();
+	layout.subresources.Reserve(layout.layers * layout.mips);
+	uint32_t layer, mip;
+	for (mip = 0; mip < layout.mips; mip++)
+	{
+		const uint64_t levelOffset = Read<uint64_t>(bytes, HeaderSize + mip * LevelIndexEntrySize);
+		const uint64_t levelLength = Read<uint64_t>(bytes, HeaderSize + mip * LevelIndexEntrySize + 8);
+		if (levelOffset + levelLength < levelOffset || levelOffset + levelLength > (uint64_t)size)
+			return false;
+
+		uint64_t offset = levelOffset;
+		for (layer = 0; layer < layout.layers; layer++)
+		{
+			Subresource sub;
+			sub.mip = mip;
+			sub.layer = layer;
+			sub.width = MipDimension(layout.width, mip);
+			sub.height = MipDimension(layout.height, mip);
+			sub.depth = MipDimension(layout.depth, mip);
+			const uint64_t subSize = ImageSize(layout.format, sub.width, sub.height, sub.depth);
+			if (offset + subSize > levelOffset + levelLength)
+				return false;
+			sub.offset = (SizeT)offset;
+			sub.size = (SizeT)subSize;
+			layout.subresources.Append(sub);
+			offset += subSize;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline bool
+VkTextureContainer::Parse(const void* data, SizeT size, Layout& layout)
+{
+	if (size >= 4 && Read<uint32_t>((const uint8_t*)data, 0) == 0x20534444)
+		return ParseDDS(data, size, layout);
+	else
+		return ParseKTX2(data, size, layout);
+}
+
+} // namespace Vulkan
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 #include "render/stdneb.h"
 #include "graphicsserver.h"
+#include "debug/profiling.h"
 #include "graphicscontext.h"
 #include "view.h"
 #include "stage.h"
@@ -331,6 +332,7 @@ GraphicsServer::BeginFrame()
 	// go through views and call prepare view
 	for (i = 0; i < this->views.Size(); i++)
 	{
+		N_SCOPE("OnPrepareView", "Graphics");
 		const Ptr<View>& view = this->views[i];
 
 		IndexT j;
@@ -346,6 +348,7 @@ GraphicsServer::BeginFrame()
 	// begin frame
 	CoreGraphics::BeginFrame(this->frameContext.frameIndex);
 
+	N_SCOPE("OnBeforeFrame", "Graphics");
 	for (i = 0; i < this->contexts.Size(); i++)
 	{
 		if (this->contexts[i]->StageBits)
@@ -364,12 +367,15 @@ GraphicsServer::BeforeViews()
 {
 	// wait for visibility
 	IndexT i;
-	for (i = 0; i < this->contexts.Size(); i++)
 	{
-		if (this->contexts[i]->StageBits)
-			*this->contexts[i]->StageBits = Graphics::OnWaitForWorkStage;
-		if (this->contexts[i]->OnWaitForWork != nullptr)
-			this->contexts[i]->OnWaitForWork(this->frameContext);
+		N_SCOPE("OnWaitForWork", "Graphics");
+		for (i = 0; i < this->contexts.Size(); i++)
+		{
+			if (this->contexts[i]->StageBits)
+				*this->contexts[i]->StageBits = Graphics::OnWaitForWorkStage;
+			if (this->contexts[i]->OnWaitForWork != nullptr)
+				this->contexts[i]->OnWaitForWork(this->frameContext);
+		}
 	}
 
 	// go through views and call before view
@@ -380,6 +386,7 @@ GraphicsServer::BeforeViews()
 		if (!view->enabled)
 			continue;
 
+		N_SCOPE("OnBeforeView", "Graphics");
 		this->currentView = view;
 
 		// begin frame
@@ -412,6 +419,7 @@ GraphicsServer::RenderViews()
 		if (!view->enabled)
 			continue;
 
+		N_SCOPE("Render", "Graphics");
 		view->Render(this->frameContext.frameIndex, this->frameContext.time);
 	}
 }
@@ -431,6 +439,7 @@ GraphicsServer::EndViews()
 		if (!view->enabled)
 			continue;
 
+		N_SCOPE("OnAfterView", "Graphics");
 		this->shaderServer->AfterView();
 		this->currentView->EndFrame(this->frameContext.frameIndex, this->frameContext.time);
 
@@ -455,9 +464,13 @@ GraphicsServer::EndFrame()
 {
 
 	// stop the graphics side frame
-	CoreGraphics::EndFrame(this->frameContext.frameIndex);
+	{
+		N_SCOPE("EndFrame", "Graphics");
+		CoreGraphics::EndFrame(this->frameContext.frameIndex);
+	}
 
 	// finish frame and prepare for the next one
+	N_SCOPE("OnAfterFrame", "Graphics");
 	IndexT i;
 	for (i = 0; i < this->contexts.Size(); i++)
 	{
@@ -223,6 +223,7 @@ MaterialServer::LoadMaterialTypes(const IO::URI& file)
 
 						constant.system = system;
 						constant.name = name;
+						constant.id = Util::StringId(constant.name);
 						constant.offset = { UINT_MAX };
 						constant.slot = InvalidIndex;
 						constant.group = InvalidIndex;
@@ -246,6 +247,7 @@ MaterialServer::LoadMaterialTypes(const IO::URI& file)
 						texture.defaultValue = res.As<CoreGraphics::TextureId>();
 						texture.system = system;
 						texture.name = name;
+						texture.id = Util::StringId(texture.name);
 						texture.slot = InvalidIndex;
 						type->textures.Add(name, texture);
 					}
@@ -289,6 +291,7 @@ MaterialServer::LoadMaterialTypes(const IO::URI& file)
 
 						constant.system = system;
 						constant.name = name;
+						constant.id = Util::StringId(constant.name);
 						constant.offset = { UINT_MAX };
 						constant.slot = InvalidIndex;
 						constant.group = InvalidIndex;
@@ -51,7 +51,7 @@ MaterialType::Setup()
 			}
 			else
 			{
-				this->texturesByBatch[*it.val].Add(tex.name, { tex.name, CoreGraphics::TextureId::Invalid(), CoreGraphics::InvalidTextureType, false, InvalidIndex });
+				this->texturesByBatch[*it.val].Add(tex.name, { tex.name, CoreGraphics::TextureId::Invalid(), CoreGraphics::InvalidTextureType, false, InvalidIndex, tex.id });
 			}
 		}
 
@@ -69,7 +69,7 @@ MaterialType::Setup()
 			}
 			else
 			{
-				this->constantsByBatch[*it.val].Add(constant.name, { constant.name, constant.defaultValue, nullptr, nullptr, constant.defaultValue.GetType(), false, UINT_MAX, InvalidIndex, InvalidIndex });
+				this->constantsByBatch[*it.val].Add(constant.name, { constant.name, constant.defaultValue, nullptr, nullptr, constant.defaultValue.GetType(), false, UINT_MAX, InvalidIndex, InvalidIndex, constant.id });
 			}
 		}
 
@@ -163,7 +163,7 @@ MaterialType::CreateSurface()
 					CoreGraphics::ResourceTableSetTexture(surfaceTable, { tex.defaultValue, tex.slot, 0, CoreGraphics::SamplerId::Invalid(), false });
 
 				if (batchIt == this->batchToIndexMap.Begin())
-					this->surfaceAllocator.Get<TextureMap>(sur).Add(tex.name, this->surfaceAllocator.Get<Textures>(sur)[*batchIt.val].Size());
+					this->surfaceAllocator.Get<TextureMap>(sur).Add(tex.id, this->surfaceAllocator.Get<Textures>(sur)[*batchIt.val].Size());
 
 				this->surfaceAllocator.Get<Textures>(sur)[*batchIt.val].Append(surTex);
 			}
@@ -221,7 +221,7 @@ MaterialType::CreateSurface()
 			}
 #endif
 			if (batchIt == this->batchToIndexMap.Begin())
-				this->surfaceAllocator.Get<ConstantMap>(sur).Add(constant.name, this->surfaceAllocator.Get<Constants>(sur)[*batchIt.val].Size());
+				this->surfaceAllocator.Get<ConstantMap>(sur).Add(constant.id, this->surfaceAllocator.Get<Constants>(sur)[*batchIt.val].Size());
 
 			this->surfaceAllocator.Get<Constants>(sur)[*batchIt.val].Append(surConst);
 			
@@ -290,7 +290,7 @@ MaterialType::DestroySurfaceInstance(const SurfaceInstanceId id)
 /**
 */
 IndexT 
-MaterialType::GetSurfaceConstantIndex(const SurfaceId sur, const Util::StringAtom& name)
+MaterialType::GetSurfaceConstantIndex(const SurfaceId sur, const Util::StringId name)
 {
 	IndexT idx = this->surfaceAllocator.Get<ConstantMap>(sur.id).FindIndex(name);
 	if (idx != InvalidIndex)	return this->surfaceAllocator.Get<ConstantMap>(sur.id).ValueAtIndex(idx);
@@ -301,7 +301,7 @@ MaterialType::GetSurfaceConstantIndex(const SurfaceId sur, const Util::StringAto
 /**
 */
 IndexT 
-MaterialType::GetSurfaceTextureIndex(const SurfaceId sur, const Util::StringAtom& name)
+MaterialType::GetSurfaceTextureIndex(const SurfaceId sur, const Util::StringId name)
 {
 	IndexT idx = this->surfaceAllocator.Get<TextureMap>(sur.id).FindIndex(name);
 	if (idx != InvalidIndex)	return this->surfaceAllocator.Get<TextureMap>(sur.id).ValueAtIndex(idx);
@@ -312,7 +312,7 @@ MaterialType::GetSurfaceTextureIndex(const SurfaceId sur, const Util::StringAtom
 /**
 */
 IndexT 
-MaterialType::GetSurfaceConstantInstanceIndex(const SurfaceInstanceId sur, const Util::StringAtom& name)
+MaterialType::GetSurfaceConstantInstanceIndex(const SurfaceInstanceId sur, const Util::StringId name)
 {
 	IndexT idx = this->surfaceAllocator.Get<ConstantMap>(sur.surface).FindIndex(name);
 	if (idx != InvalidIndex)	return this->surfaceAllocator.Get<ConstantMap>(sur.surface).ValueAtIndex(idx);
@@ -7,6 +7,7 @@
 */
 //------------------------------------------------------------------------------
 #include "util/hashtable.h"
+#include "util/stringid.h"
 #include "coregraphics/batchgroup.h"
 #include "coregraphics/shader.h"
 #include "memory/arenaallocator.h"
@@ -27,6 +28,7 @@ struct MaterialTexture
 	bool system : 1;
 
 	IndexT slot;
+	Util::StringId id;
 };
 struct MaterialConstant
 {
@@ -40,6 +42,7 @@ struct MaterialConstant
 	CoreGraphics::ConstantBinding offset;
 	IndexT slot;
 	IndexT group;
+	Util::StringId id;
 };
 
 class MaterialType
@@ -64,12 +67,12 @@ public:
 	/// destroy instance of a surface
 	void DestroySurfaceInstance(const SurfaceInstanceId id);
 
-	/// get constant index
-	IndexT GetSurfaceConstantIndex(const SurfaceId sur, const Util::StringAtom& name);
-	/// get texture index
-	IndexT GetSurfaceTextureIndex(const SurfaceId sur, const Util::StringAtom& name);
-	/// get surface constant instance index
-	IndexT GetSurfaceConstantInstanceIndex(const SurfaceInstanceId sur, const Util::StringAtom& name);
+	/// get constant index, use "Name"_id to avoid creating a string atom
+	IndexT GetSurfaceConstantIndex(const SurfaceId sur, const Util::StringId name);
+	/// get texture index, use "Name"_id to avoid creating a string atom
+	IndexT GetSurfaceTextureIndex(const SurfaceId sur, const Util::StringId name);
+	/// get surface constant instance index, use "Name"_id to avoid creating a string atom
+	IndexT GetSurfaceConstantInstanceIndex(const SurfaceInstanceId sur, const Util::StringId name);
 
 	/// get default value for constant
 	const Util::Variant GetSurfaceConstantDefault(const SurfaceId sur, IndexT idx);
@@ -172,8 +175,8 @@ private:
 		Util::FixedArray<Util::Array<std::tuple<IndexT, void*, SizeT>>>,						// instance level instance buffers, mapped batch -> memory + size
 		Util::FixedArray<Util::Array<SurfaceTexture>>,											// textures
 		Util::FixedArray<Util::Array<SurfaceConstant>>,											// constants
-		Util::Dictionary<Util::StringAtom, IndexT>,												// name to resource map
-		Util::Dictionary<Util::StringAtom, IndexT>												// name to constant map
+		Util::Dictionary<Util::StringId, IndexT>,												// name to resource map
+		Util::Dictionary<Util::StringId, IndexT>												// name to constant map
 	> surfaceAllocator;
 
 
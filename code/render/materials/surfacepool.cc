@@ -62,7 +62,7 @@ SurfacePool::LoadFromStream(const Resources::ResourceId id, const Util::StringAt
 		if (reader->SetToFirstChild("Param")) do
 		{
 			
-			Util::StringAtom paramName = reader->GetString("name");
+			Util::StringId paramName(reader->GetString("name"));
 
 			// set variant value which we will use in the surface constants
 			IndexT binding = type->GetSurfaceConstantIndex(sid, paramName);
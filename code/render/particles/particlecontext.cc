@@ -10,6 +10,7 @@
 #include "particles/emitterattrs.h"
 #include "particles/emittermesh.h"
 #include "particles/envelopesamplebuffer.h"
+#include "memory/frameallocator.h"
 
 using namespace Graphics;
 using namespace Models;
@@ -612,7 +613,7 @@ ParticleContext::RunParticleStep(ParticleRuntime& rt, ParticleSystemRuntime& srt
 	ctx.output.numBuffers = 2;
 
 	// issue job
-	Jobs::JobId job = Jobs::CreateJob({ Particles::ParticleStepJob });
+	Jobs::JobId job = Jobs::CreateJob({ Particles::ParticleStepJob, "ParticleStepJob" });
 
 	// pass in uniforms from system which is not step-dependent
 	ctx.uniform.data[0] = &srt.uniformData;
@@ -621,7 +622,7 @@ ParticleContext::RunParticleStep(ParticleRuntime& rt, ParticleSystemRuntime& srt
 	// create a copy of the uniforms, because the step size may change between every step,
 	// which causes bugs if we do precalculation while we are changing the value
 	srt.perJobUniformData.stepTime = stepTime;
-	void* uniformCopy = Jobs::JobAllocateScratchMemory(job, Memory::HeapType::ScratchHeap, sizeof(ParticleJobUniformPerJobData));
+	void* uniformCopy = Memory::FrameAlloc(sizeof(ParticleJobUniformPerJobData));
 	memcpy(uniformCopy, &srt.perJobUniformData, sizeof(ParticleJobUniformPerJobData));
 	ctx.uniform.data[1] = uniformCopy;
 	ctx.uniform.dataSize[1] = sizeof(ParticleJobUniformPerJobData);
@@ -49,7 +49,7 @@ BruteforceSystem::Run()
 		ctx.output.sliceSize[0] = sizeof(bool);
 
 		// create and run job
-		Jobs::JobId job = Jobs::CreateJob({ BruteforceSystemJobFunc });
+		Jobs::JobId job = Jobs::CreateJob({ BruteforceSystemJobFunc, "BruteforceSystemJobFunc" });
 		Jobs::JobSchedule(job, ObserverContext::jobPort, ctx);
 
 		// enqueue here, but don't dequeue as VisibilityContext will do it for us
@@ -209,8 +209,6 @@ ObserverContext::OnBeforeFrame(const Graphics::FrameContext& ctx)
 		const Util::Array<bool>& flags = vis[i].GetArray<VisibilityResultFlag>();
 		const Util::Array<Graphics::ContextEntityId>& entities = vis[i].GetArray<VisibilityResultCtxId>();
 		VisibilityDrawList& visibilities = observerAllocator.Get<ObserverDrawList>(i);
-		Memory::ArenaAllocator<1024>& allocator = observerAllocator.Get<ObserverDrawListAllocator>(i);
-		allocator.Release();
 
         if (entities.Size() == 0)
         {
@@ -220,7 +218,7 @@ ObserverContext::OnBeforeFrame(const Graphics::FrameContext& ctx)
 		// then execute sort job, which only runs the function once
 		Jobs::JobContext ctx;
 		ctx.uniform.scratchSize = 0;
-		ctx.uniform.numBuffers = 1;
+		ctx.uniform.numBuffers = 0;
 		ctx.input.numBuffers = 2;
 		ctx.output.numBuffers = 1;
 
@@ -236,11 +234,8 @@ ObserverContext::OnBeforeFrame(const Graphics::FrameContext& ctx)
 		ctx.output.dataSize[0] = sizeof(VisibilityDrawList);
 		ctx.output.sliceSize[0] = sizeof(VisibilityDrawList);
 
-		ctx.uniform.data[0] = &allocator;
-		ctx.uniform.dataSize[0] = sizeof(allocator);
-
 		// schedule job
-		Jobs::JobId job = Jobs::CreateJob({ VisibilitySortJob });
+		Jobs::JobId job = Jobs::CreateJob({ VisibilitySortJob, "VisibilitySortJob" });
 		Jobs::JobSchedule(job, ObserverContext::jobPort, ctx);
 
 		// add to delete list
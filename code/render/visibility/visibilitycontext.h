@@ -14,7 +14,6 @@
 #include "models/nodes/modelnode.h"
 #include "materials/surfacepool.h"
 #include "materials/materialtype.h"
-#include "memory/arenaallocator.h"
 namespace Visibility
 {
 
@@ -25,8 +24,7 @@ enum ObserverAllocatorMembers
 	ObserverEntityType,
 	ObserverResultAllocator,
 	ObserverResults,
-	ObserverDrawList,
-	ObserverDrawListAllocator
+	ObserverDrawList
 };
 
 enum VisibilityResultAllocatorMembers
@@ -107,8 +105,7 @@ private:
 		VisibilityEntityType,				// type of object so we know how to get the transform
 		VisibilityResultAllocator,			// visibility lookup table
 		bool*,
-		VisibilityDrawList,					// draw list
-		Memory::ArenaAllocator<1024>		// memory allocator for draw commands
+		VisibilityDrawList					// draw list, packets are allocated with Memory::FrameAlloc
 	> ObserverAllocator;
 	static ObserverAllocator observerAllocator;
 
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 #include "render/stdneb.h"
 #include "jobs/jobs.h"
+#include "memory/frameallocator.h"
 #include "visibilitycontext.h"
 #include "models/modelcontext.h"
 #include "models/nodes/shaderstatenode.h"
@@ -17,7 +18,6 @@ void
 VisibilitySortJob(const Jobs::JobFuncContext& ctx)
 {
 	ObserverContext::VisibilityDrawList* buckets = (ObserverContext::VisibilityDrawList*)ctx.outputs[0];
-	Memory::ArenaAllocator<1024>* packetAllocator = (Memory::ArenaAllocator<1024>*)ctx.uniforms[0];
 
 	bool* results = (bool*)ctx.inputs[0];
 	Graphics::ContextEntityId* entities = (Graphics::ContextEntityId*)ctx.inputs[1];
@@ -53,8 +53,8 @@ VisibilitySortJob(const Jobs::JobFuncContext& ctx)
 				// add an array if non existant, or return reference to one if it exists
 				auto& draw = bucket.AddUnique(inst->node);
 
-				// allocate memory for draw packet
-				void* mem = packetAllocator->Alloc(shdNodeInst->GetDrawPacketSize());
+				// allocate memory for draw packet, it only has to live until the frame is rendered
+				void* mem = Memory::FrameAlloc(shdNodeInst->GetDrawPacketSize());
 
 				// update packet and add to list
 				Models::ModelNode::DrawPacket* packet = shdNodeInst->UpdateDrawPacket(mem);
@@ -126,7 +126,7 @@ protected:
 	//Util::Dictionary<Util::StringAtom, _PendingResource> pending;
 	//Util::FixedArray<Util::Array<_PendingResource>> 
 
-	Util::Dictionary<Resources::ResourceName, Ids::Id32> pendingLoadMap;
+	Util::Dictionary<Resources::ResourceName, Ids::Id32, Util::DictionaryHashed<>> pendingLoadMap;
 	Util::FixedArray<_PendingResourceLoad> pendingLoads;
 	Ids::IdPool pendingLoadPool;
 	Util::Array<_PendingResourceUnload> pendingUnloads;
@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+//  testcase.cc
+//  (C) 2006 Radon Labs GmbH
+//  (C) 2013-2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "testbase/testcase.h"
+
+namespace Test
+{
+__ImplementClass(Test::TestCase, 'TSTC', Core::RefCounted);
+
+//------------------------------------------------------------------------------
+/**
+*/
+TestCase::TestCase() :
+    numVerified(0),
+    numSucceeded(0),
+    numFailed(0)
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+TestCase::~TestCase()
+{
+    // empty
+}
+
+//------------------------------------------------------------------------------
+/**
+    Override this method in a subclass.
+*/
+void
+TestCase::Run()
+{
+    this->numVerified = 0;
+    this->numSucceeded = 0;
+    this->numFailed = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TestCase::Verify(bool b, const char* stmt, const char* file, int line)
+{
+    this->numVerified++;
+    if (b)
+    {
+        this->numSucceeded++;
+    }
+    else
+    {
+        this->numFailed++;
+        n_printf("*** VERIFY FAILED: %s(%d): %s\n", file, line, stmt);
+    }
+}
+
+} // namespace Test
@@ -0,0 +1,73 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::TestCase
+
+    Base class for a test case. Override Run() and check conditions with
+    the VERIFY() macro. Failed conditions are printed with their location,
+    and counted so the TestRunner can report them.
+
+    (C) 2006 Radon Labs GmbH
+    (C) 2013-2020 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+
+//------------------------------------------------------------------------------
+#define VERIFY(exp) this->Verify((exp), #exp, __FILE__, __LINE__)
+
+namespace Test
+{
+class TestCase : public Core::RefCounted
+{
+    __DeclareClass(TestCase);
+public:
+    /// constructor
+    TestCase();
+    /// destructor
+    virtual ~TestCase();
+    /// run the test
+    virtual void Run();
+    /// verify a statement, use the VERIFY() macro instead of calling this directly
+    void Verify(bool b, const char* stmt, const char* file, int line);
+    /// get number of verifies
+    SizeT GetNumVerified() const;
+    /// get number of succeeded verifies
+    SizeT GetNumSucceeded() const;
+    /// get number of failed verifies
+    SizeT GetNumFailed() const;
+
+private:
+    SizeT numVerified;
+    SizeT numSucceeded;
+    SizeT numFailed;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+TestCase::GetNumVerified() const
+{
+    return this->numVerified;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+TestCase::GetNumSucceeded() const
+{
+    return this->numSucceeded;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline SizeT
+TestCase::GetNumFailed() const
+{
+    return this->numFailed;
+}
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+//  testrunner.cc
+//  (C) 2006 Radon Labs GmbH
+//  (C) 2013-2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "testbase/testrunner.h"
+#include "timing/timer.h"
+
+namespace Test
+{
+__ImplementClass(Test::TestRunner, 'TSTR', Core::RefCounted);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TestRunner::AttachTestCase(TestCase* testCase)
+{
+    this->testCases.Append(testCase);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+TestRunner::Run()
+{
+    SizeT numFailedCases = 0;
+    SizeT numVerified = 0;
+    SizeT numFailed = 0;
+    IndexT i;
+    for (i = 0; i < this->testCases.Size(); i++)
+    {
+        TestCase* testCase = this->testCases[i];
+        n_printf("-> Running test: %s\n", testCase->GetClassName().AsCharPtr());
+
+        Timing::Timer timer;
+        timer.Start();
+        testCase->Run();
+        timer.Stop();
+
+        if (testCase->GetNumFailed() > 0)
+        {
+            n_printf("*** FAILED: %d of %d verifies failed (%.3f sec)\n\n", testCase->GetNumFailed(), testCase->GetNumVerified(), timer.GetTime());
+            numFailedCases++;
+        }
+        else
+        {
+            n_printf("   success: %d verifies (%.3f sec)\n\n", testCase->GetNumVerified(), timer.GetTime());
+        }
+        numVerified += testCase->GetNumVerified();
+        numFailed += testCase->GetNumFailed();
+    }
+
+    n_printf("* TEST RESULTS: %d of %d test cases failed, %d of %d verifies failed\n", numFailedCases, this->testCases.Size(), numFailed, numVerified);
+    return numFailedCases == 0;
+}
+
+} // namespace Test
@@ -0,0 +1,32 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::TestRunner
+
+    Runs a list of test cases and prints a summary of the results.
+
+    (C) 2006 Radon Labs GmbH
+    (C) 2013-2020 Individual contributors, see AUTHORS file
+*/
+#include "core/refcounted.h"
+#include "testbase/testcase.h"
+#include "util/array.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class TestRunner : public Core::RefCounted
+{
+    __DeclareClass(TestRunner);
+public:
+    /// attach a test case
+    void AttachTestCase(TestCase* testCase);
+    /// run all test cases, returns false if any of them failed
+    bool Run();
+
+private:
+    Util::Array<Ptr<TestCase>> testCases;
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,203 @@
+//------------------------------------------------------------------------------
+//  blockpooltest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "blockpooltest.h"
+#include "memory/blockpool.h"
+#include "threading/thread.h"
+#include "threading/event.h"
+#include "util/fixedarray.h"
+#include <atomic>
+
+using namespace Memory;
+using namespace Threading;
+
+namespace Test
+{
+__ImplementClass(Test::BlockPoolTest, 'BPLT', Test::TestCase);
+
+static const SizeT NumThreads = 32;
+static const SizeT NumIterations = 2000;
+static const SizeT BlocksPerIteration = 64;
+static const SizeT NumExchangeSlots = 1024;
+static const SizeT BlockWords = 16;
+
+//------------------------------------------------------------------------------
+/**
+    State shared by all threads, blocks are passed on by swapping them
+    with the block in a random exchange slot.
+*/
+struct BlockPoolTestShared
+{
+    BlockPool pool;
+    Event startEvent{ true };
+    std::atomic<void*> slots[NumExchangeSlots];
+    std::atomic<uint> nextStamp{ 1 };
+    std::atomic<uint> numCorrupted{ 0 };
+    std::atomic<uint> numFreed{ 0 };
+};
+
+//------------------------------------------------------------------------------
+/**
+    Every word of a block is derived from its stamp, so a block which is
+    handed out twice, or written after it has been freed, doesn't check out.
+*/
+static void
+StampBlock(void* ptr, uint stamp)
+{
+    uint* words = (uint*)ptr;
+    IndexT i;
+    for (i = 0; i < BlockWords; i++)
+        words[i] = stamp * 2654435761u + i;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+CheckBlock(const void* ptr)
+{
+    const uint* words = (const uint*)ptr;
+    const uint stamp = words[0] * 244002641u;   // inverse of 2654435761 mod 2^32
+    IndexT i;
+    for (i = 1; i < BlockWords; i++)
+    {
+        if (words[i] != stamp * 2654435761u + i)
+            return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+CheckAndFree(BlockPoolTestShared* shared, void* ptr)
+{
+    if (!CheckBlock(ptr))
+        shared->numCorrupted.fetch_add(1, std::memory_order_relaxed);
+    shared->numFreed.fetch_add(1, std::memory_order_relaxed);
+    shared->pool.Free(ptr);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+class BlockPoolTestThread : public Thread
+{
+    __DeclareClass(BlockPoolTestThread);
+public:
+    /// setup before starting the thread
+    void Setup(BlockPoolTestShared* shared, uint seed);
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    BlockPoolTestShared* shared;
+    uint seed;
+};
+__ImplementClass(Test::BlockPoolTestThread, 'BPTT', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPoolTestThread::Setup(BlockPoolTestShared* shared_, uint seed_)
+{
+    this->shared = shared_;
+    this->seed = seed_;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Half of the blocks of an iteration are freed by the thread itself, the
+    other half are swapped into the exchange slots, and whatever comes out
+    of a slot was allocated by some other thread.
+*/
+void
+BlockPoolTestThread::DoWork()
+{
+    void* blocks[BlocksPerIteration];
+    this->shared->startEvent.Wait();
+    IndexT iteration;
+    for (iteration = 0; iteration < NumIterations; iteration++)
+    {
+        IndexT i;
+        for (i = 0; i < BlocksPerIteration; i++)
+        {
+            blocks[i] = this->shared->pool.Alloc();
+            StampBlock(blocks[i], this->shared->nextStamp.fetch_add(1, std::memory_order_relaxed));
+        }
+        for (i = 0; i < BlocksPerIteration; i++)
+        {
+            if (i & 1)
+            {
+                CheckAndFree(this->shared, blocks[i]);
+                continue;
+            }
+            this->seed = this->seed * 1664525 + 1013904223;
+            void* other = this->shared->slots[(this->seed >> 16) % NumExchangeSlots].exchange(blocks[i], std::memory_order_acq_rel);
+            if (other != nullptr)
+                CheckAndFree(this->shared, other);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+RunGeneration(BlockPoolTestShared* shared, uint seedBase)
+{
+    shared->startEvent.Reset();
+    Util::FixedArray<Ptr<BlockPoolTestThread>> threads(NumThreads);
+    IndexT i;
+    for (i = 0; i < NumThreads; i++)
+    {
+        threads[i] = BlockPoolTestThread::Create();
+        threads[i]->SetName(Util::String::Sprintf("BlockPoolTest%d", i));
+        threads[i]->Setup(shared, seedBase + i);
+        threads[i]->Start();
+    }
+    shared->startEvent.Signal();
+    for (i = 0; i < NumThreads; i++)
+        threads[i]->Stop();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockPoolTest::Run()
+{
+    BlockPoolTestShared* shared = n_new(BlockPoolTestShared);
+    shared->pool.Setup("BlockPoolTest", Memory::ObjectHeap, BlockWords * sizeof(uint));
+    IndexT i;
+    for (i = 0; i < NumExchangeSlots; i++)
+        shared->slots[i] = nullptr;
+
+    // the second generation inherits the thread indices of the first one
+    RunGeneration(shared, 1);
+    RunGeneration(shared, 1000);
+
+    for (i = 0; i < NumExchangeSlots; i++)
+    {
+        void* ptr = shared->slots[i].exchange(nullptr);
+        if (ptr != nullptr)
+            CheckAndFree(shared, ptr);
+    }
+
+    const uint numAllocated = shared->nextStamp.load() - 1;
+    VERIFY(numAllocated == 2 * NumThreads * NumIterations * BlocksPerIteration);
+    VERIFY(shared->numFreed.load() == numAllocated);
+    VERIFY(shared->numCorrupted.load() == 0);
+
+    // blocks are reused, the pool only grows with the number of blocks alive at once
+    n_printf("    %d blocks in %d chunks\n", shared->pool.GetCapacity(), shared->pool.GetNumChunks());
+    VERIFY(shared->pool.GetCapacity() <= 16 * 1024);
+
+    shared->pool.Discard();
+    n_delete(shared);
+}
+
+} // namespace Test
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::BlockPoolTest
+
+    Stress test for Memory::BlockPool. 32 threads allocate stamped blocks
+    and pass them to each other, so most blocks are freed by another thread
+    than the one which allocated them. A second generation of 32 threads
+    then inherits the thread indices and the blocks left in their free
+    lists. Every block is checked for corruption before it is freed.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class BlockPoolTest : public TestCase
+{
+    __DeclareClass(BlockPoolTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+//  blockringtest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "blockringtest.h"
+#include "threading/blockring.h"
+#include "threading/thread.h"
+
+using namespace Threading;
+
+namespace Test
+{
+__ImplementClass(Test::BlockRingTest, 'BRGT', Test::TestCase);
+
+static const SizeT NumBlocks = 4;
+static const SizeT BlockSize = 8;
+static const uint NumElements = 1000000;
+
+typedef BlockRing<uint, BlockSize> TestRing;
+
+//------------------------------------------------------------------------------
+/**
+    Checks that consumed elements continue the sequence.
+*/
+struct BlockRingTestChecker
+{
+    uint next = 0;
+    SizeT numBlocks = 0;
+    bool inOrder = true;
+    bool sizesOk = true;
+
+    /// check a consumed block
+    void Check(const uint* elements, SizeT num)
+    {
+        this->numBlocks++;
+        this->sizesOk &= num > 0 && num <= BlockSize;
+        IndexT i;
+        for (i = 0; i < num; i++)
+            this->inOrder &= elements[i] == this->next++;
+    }
+};
+
+//------------------------------------------------------------------------------
+/**
+    Mixes full blocks, partially filled published blocks and array
+    enqueues which straddle block boundaries.
+*/
+class BlockRingTestProducer : public Thread
+{
+    __DeclareClass(BlockRingTestProducer);
+public:
+    /// setup before starting the thread
+    void Setup(TestRing* ring);
+    /// this method runs in the thread context
+    virtual void DoWork();
+private:
+    TestRing* ring;
+};
+__ImplementClass(Test::BlockRingTestProducer, 'BRGP', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingTestProducer::Setup(TestRing* ring_)
+{
+    this->ring = ring_;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingTestProducer::DoWork()
+{
+    uint elements[BlockSize * 3];
+    uint next = 0;
+    while (next < NumElements)
+    {
+        switch (next % 7)
+        {
+        case 0:
+        {
+            // straddles up to four blocks
+            const SizeT num = Math::n_min((SizeT)(BlockSize * 3), (SizeT)(NumElements - next));
+            IndexT i;
+            for (i = 0; i < num; i++)
+                elements[i] = next++;
+            this->ring->EnqueueArray(elements, num);
+            break;
+        }
+        case 3:
+            this->ring->Enqueue(next++);
+            this->ring->Publish();
+            break;
+        default:
+            this->ring->Enqueue(next++);
+            break;
+        }
+    }
+    this->ring->Publish();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+BlockRingTest::Run()
+{
+    // single thread, consume whenever the ring might be full
+    TestRing ring(NumBlocks);
+    VERIFY(ring.IsEmpty());
+    ring.Publish();
+    VERIFY(ring.IsEmpty());
+
+    BlockRingTestChecker checker;
+    auto check = [&checker](const uint* elements, SizeT num) { checker.Check(elements, num); };
+    uint next = 0;
+    IndexT round;
+    for (round = 0; round < 1000; round++)
+    {
+        // fill all blocks, the last one partially
+        SizeT num = (NumBlocks - 1) * BlockSize + 1 + round % (BlockSize - 1);
+        IndexT i;
+        for (i = 0; i < num; i++)
+            ring.Enqueue(next++);
+        ring.Publish();
+        VERIFY(!ring.IsEmpty());
+        VERIFY(ring.Consume(check) == num);
+        VERIFY(ring.IsEmpty());
+    }
+    VERIFY(checker.inOrder);
+    VERIFY(checker.sizesOk);
+    VERIFY(checker.next == next);
+    VERIFY(checker.numBlocks == 1000 * NumBlocks);
+
+    // nothing more is consumed once the ring is drained
+    VERIFY(ring.Consume(check) == 0);
+
+    // producer and consumer thread, the producer keeps running into a full ring
+    TestRing threadRing(NumBlocks);
+    BlockRingTestChecker threadChecker;
+    auto threadCheck = [&threadChecker](const uint* elements, SizeT num) { threadChecker.Check(elements, num); };
+    Ptr<BlockRingTestProducer> producer = BlockRingTestProducer::Create();
+    producer->SetName("BlockRingTestProducer");
+    producer->Setup(&threadRing);
+    producer->Start();
+    while (threadChecker.next < NumElements)
+    {
+        threadRing.Consume(threadCheck);
+        if (threadChecker.next < NumElements)
+            threadRing.Wait();
+    }
+    producer->Stop();
+
+    VERIFY(threadChecker.inOrder);
+    VERIFY(threadChecker.sizesOk);
+    VERIFY(threadChecker.next == NumElements);
+    VERIFY(threadRing.IsEmpty());
+
+    // the ring wraps around many times
+    n_printf("    %d blocks through a ring of %d\n", threadChecker.numBlocks, NumBlocks);
+    VERIFY(threadChecker.numBlocks > 1000 * NumBlocks);
+}
+
+} // namespace Test
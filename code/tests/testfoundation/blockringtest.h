@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::BlockRingTest
+
+    Tests Threading::BlockRing with a ring of only a few small blocks, so
+    the producer wraps around the ring many times and has to wait for the
+    consumer whenever all blocks are in flight. Checks that every element
+    arrives exactly once and in order, on a single thread and with a
+    producer and a consumer thread.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class BlockRingTest : public TestCase
+{
+    __DeclareClass(BlockRingTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,183 @@
+//------------------------------------------------------------------------------
+//  dictionarytest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "dictionarytest.h"
+#include "util/dictionary.h"
+
+using namespace Util;
+
+namespace Test
+{
+__ImplementClass(Test::DictionaryTest, 'DCTT', Test::TestCase);
+
+static const SizeT Threshold = 8;
+typedef Dictionary<int, int, DictionaryHashed<Threshold>> HashedDictionary;
+
+//------------------------------------------------------------------------------
+/**
+*/
+template<class DICTIONARY>
+static bool
+IsSorted(const DICTIONARY& dict)
+{
+    IndexT i;
+    for (i = 1; i < dict.Size(); i++)
+    {
+        if (!(dict.KeyAtIndex(i - 1) < dict.KeyAtIndex(i)))
+            return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Every key must be found at its own index, with the value derived from it.
+*/
+static bool
+IsConsistent(const HashedDictionary& dict)
+{
+    IndexT i;
+    for (i = 0; i < dict.Size(); i++)
+    {
+        const int key = dict.KeyAtIndex(i);
+        if (dict.FindIndex(key) != i || dict.ValueAtIndex(i) != key * 10)
+            return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DictionaryTest::Run()
+{
+    // up to the threshold the pairs are kept sorted, like DictionarySorted
+    HashedDictionary dict;
+    IndexT i;
+    for (i = Threshold; i > 0; i--)
+        dict.Add(i * 2, i * 20);
+    VERIFY(dict.Size() == Threshold);
+    VERIFY(IsSorted(dict));
+    VERIFY(dict.KeyAtIndex(0) == 2);
+    VERIFY(IsConsistent(dict));
+
+    // the pair which crosses the threshold is still inserted sorted, then the index is built
+    dict.Add(3, 30);
+    VERIFY(dict.Size() == Threshold + 1);
+    VERIFY(IsSorted(dict));
+    VERIFY(dict.KeyAtIndex(1) == 3);
+    VERIFY(IsConsistent(dict));
+
+    // from then on pairs are appended, and the existing ones keep their index
+    dict.Add(1, 10);
+    VERIFY(!IsSorted(dict));
+    VERIFY(dict.KeyAtIndex(0) == 2);
+    VERIFY(dict.KeyAtIndex(Threshold + 1) == 1);
+    VERIFY(IsConsistent(dict));
+    VERIFY(!dict.Contains(5));
+
+    for (i = 100; i < 1100; i++)
+        dict.Add(i, i * 10);
+    VERIFY(dict.Size() == Threshold + 1002);
+    VERIFY(IsConsistent(dict));
+
+    // erasing the first pair moves the last one into its place
+    const int firstKey = dict.KeyAtIndex(0);
+    const int lastKey = dict.KeyAtIndex(dict.Size() - 1);
+    dict.EraseAtIndex(0);
+    VERIFY(!dict.Contains(firstKey));
+    VERIFY(dict.KeyAtIndex(0) == lastKey);
+    VERIFY(dict.FindIndex(lastKey) == 0);
+    VERIFY(IsConsistent(dict));
+
+    // erasing the last pair doesn't move anything
+    const int tailKey = dict.KeyAtIndex(dict.Size() - 1);
+    const int secondKey = dict.KeyAtIndex(1);
+    dict.EraseAtIndex(dict.Size() - 1);
+    VERIFY(!dict.Contains(tailKey));
+    VERIFY(dict.KeyAtIndex(1) == secondKey);
+    VERIFY(IsConsistent(dict));
+
+    // erase every other key, then add them again
+    for (i = 100; i < 1100; i += 2)
+    {
+        if (dict.Contains(i))
+            dict.Erase(i);
+    }
+    VERIFY(IsConsistent(dict));
+    bool erasedOk = true;
+    for (i = 100; i < 1100; i += 2)
+        erasedOk &= !dict.Contains(i);
+    VERIFY(erasedOk);
+    for (i = 100; i < 1100; i += 2)
+        dict.Add(i, i * 10);
+    VERIFY(IsConsistent(dict));
+
+    // below the threshold again, the dictionary still uses the index
+    while (dict.Size() > Threshold / 2)
+        dict.EraseAtIndex(dict.Size() / 2);
+    VERIFY(IsConsistent(dict));
+    dict.Add(-1, -10);
+    VERIFY(dict.KeyAtIndex(dict.Size() - 1) == -1);
+    VERIFY(IsConsistent(dict));
+
+    // once empty, it starts out sorted again
+    while (!dict.IsEmpty())
+        dict.EraseAtIndex(0);
+    for (i = 0; i < Threshold; i++)
+        dict.Add(Threshold - i, (Threshold - i) * 10);
+    VERIFY(IsSorted(dict));
+    VERIFY(IsConsistent(dict));
+    dict.Clear();
+    VERIFY(dict.IsEmpty());
+
+    // bulk adds switch at the same size
+    HashedDictionary bulk;
+    bulk.BeginBulkAdd();
+    for (i = Threshold; i > 0; i--)
+        bulk.Add(i, i * 10);
+    bulk.EndBulkAdd();
+    VERIFY(IsSorted(bulk));
+    VERIFY(IsConsistent(bulk));
+    bulk.BeginBulkAdd();
+    bulk.Add(0, 0);
+    bulk.EndBulkAdd();
+    VERIFY(bulk.KeyAtIndex(Threshold) == 0);
+    VERIFY(!IsSorted(bulk));
+    VERIFY(IsConsistent(bulk));
+
+    // the sorted policy holds the same content after the same operations
+    Dictionary<int, int> sorted;
+    HashedDictionary hashed;
+    for (i = 0; i < 500; i++)
+    {
+        const int key = (i * 7919) % 1000;
+        sorted.Add(key, key * 10);
+        hashed.Add(key, key * 10);
+    }
+    for (i = 0; i < 500; i += 3)
+    {
+        const int key = (i * 7919) % 1000;
+        sorted.Erase(key);
+        hashed.Erase(key);
+    }
+    VERIFY(sorted.Size() == hashed.Size());
+    VERIFY(IsSorted(sorted));
+    VERIFY(IsConsistent(hashed));
+    bool sameContent = true;
+    for (i = 0; i < sorted.Size(); i++)
+        sameContent &= hashed.Contains(sorted.KeyAtIndex(i)) && hashed[sorted.KeyAtIndex(i)] == sorted.ValueAtIndex(i);
+    VERIFY(sameContent);
+
+    // copies keep their own index
+    HashedDictionary copy(hashed);
+    copy.EraseAtIndex(0);
+    VERIFY(IsConsistent(copy));
+    VERIFY(IsConsistent(hashed));
+    VERIFY(copy.Size() == hashed.Size() - 1);
+}
+
+} // namespace Test
@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::DictionaryTest
+
+    Tests the Util::DictionaryHashed policy: the dictionary stays sorted up
+    to the threshold, switches to the hash index when it is exceeded, both
+    by Add and by a bulk add, and keeps the index consistent when
+    EraseAtIndex swaps the last pair into the gap.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class DictionaryTest : public TestCase
+{
+    __DeclareClass(DictionaryTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
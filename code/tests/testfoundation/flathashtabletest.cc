@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+//  flathashtabletest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "flathashtabletest.h"
+#include "util/flathashtable.h"
+
+using namespace Util;
+
+namespace Test
+{
+__ImplementClass(Test::FlatHashTableTest, 'FHTT', Test::TestCase);
+
+//------------------------------------------------------------------------------
+/**
+    Key with only a handful of different hash codes, all keys with the same
+    code end up in the same group and with the same control byte.
+*/
+struct CollidingKey
+{
+    int id;
+
+    bool operator==(const CollidingKey& rhs) const { return this->id == rhs.id; }
+    IndexT HashCode() const { return this->id % 4; }
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+FlatHashTableTest::Run()
+{
+    // growth, the capacity stays a power of two and the load below 7/8
+    FlatHashTable<int, int> table;
+    VERIFY(table.IsEmpty());
+    VERIFY(table.Capacity() == 0);
+    VERIFY(!table.Contains(0));
+    bool loadOk = true;
+    bool powerOfTwo = true;
+    IndexT i;
+    for (i = 0; i < 100000; i++)
+    {
+        table.Add(i, i * 3);
+        loadOk &= table.Size() <= table.Capacity() - table.Capacity() / 8;
+        powerOfTwo &= (table.Capacity() & (table.Capacity() - 1)) == 0;
+    }
+    VERIFY(table.Size() == 100000);
+    VERIFY(loadOk);
+    VERIFY(powerOfTwo);
+    bool allFound = true;
+    for (i = 0; i < 100000; i++)
+        allFound &= table.Contains(i) && table[i] == i * 3;
+    VERIFY(allFound);
+    VERIFY(!table.Contains(100000));
+    VERIFY(!table.Contains(-1));
+
+    // reserving up front avoids growing while adding
+    FlatHashTable<int, int> reserved;
+    reserved.Reserve(5000);
+    const SizeT reservedCapacity = reserved.Capacity();
+    for (i = 0; i < 5000; i++)
+        reserved.Add(i, i);
+    VERIFY(reserved.Capacity() == reservedCapacity);
+
+    // erase and reinsert, the table fills up with tombstones which must
+    // not break lookups, and must be cleaned up instead of growing forever
+    const SizeT grownCapacity = table.Capacity();
+    IndexT round;
+    for (round = 0; round < 8; round++)
+    {
+        for (i = round & 1; i < 100000; i += 2)
+            table.Erase(i);
+        VERIFY(table.Size() == 50000);
+
+        bool erasedOk = true;
+        for (i = 0; i < 100000; i++)
+            erasedOk &= table.Contains(i) == ((i & 1) != (round & 1));
+        VERIFY(erasedOk);
+
+        for (i = round & 1; i < 100000; i += 2)
+            table.Add(i, i * 3 + round);
+        VERIFY(table.Size() == 100000);
+    }
+    VERIFY(table.Capacity() == grownCapacity);
+    allFound = true;
+    for (i = 0; i < 100000; i++)
+        allFound &= table[i] == i * 3 + ((i & 1) ? 7 : 6);
+    VERIFY(allFound);
+
+    // erasing by slot and iterating
+    IndexT slot = table.FindIndex(1234);
+    VERIFY(slot != InvalidIndex);
+    VERIFY(table.ValueAtIndex(1234, slot) == 1234 * 3 + 6);
+    table.EraseIndex(1234, slot);
+    VERIFY(!table.Contains(1234));
+    SizeT numIterated = 0;
+    FlatHashTable<int, int>::Iterator it = table.Begin();
+    while (it != table.End())
+    {
+        numIterated++;
+        it++;
+    }
+    VERIFY(numIterated == table.Size());
+
+    // reset keeps the memory, clear releases it
+    table.Reset();
+    VERIFY(table.IsEmpty());
+    VERIFY(table.Capacity() == grownCapacity);
+    VERIFY(!table.Contains(0));
+    table.AddUnique(7) = 70;
+    VERIFY(table[7] == 70);
+    table.Clear();
+    VERIFY(table.Capacity() == 0);
+
+    // colliding keys
+    FlatHashTable<CollidingKey, int> colliding;
+    for (i = 0; i < 1000; i++)
+        colliding.Add({ i }, i);
+    VERIFY(colliding.Size() == 1000);
+    allFound = true;
+    for (i = 0; i < 1000; i++)
+        allFound &= colliding.Contains({ i }) && colliding[{ i }] == i;
+    VERIFY(allFound);
+    VERIFY(!colliding.Contains({ 1000 }));
+
+    for (i = 0; i < 1000; i += 3)
+        colliding.Erase({ i });
+    bool collidingOk = true;
+    for (i = 0; i < 1000; i++)
+        collidingOk &= colliding.Contains({ i }) == (i % 3 != 0);
+    VERIFY(collidingOk);
+    for (i = 0; i < 1000; i += 3)
+        colliding.Add({ i }, -i);
+    collidingOk = true;
+    for (i = 0; i < 1000; i++)
+        collidingOk &= colliding[{ i }] == ((i % 3 == 0) ? -i : i);
+    VERIFY(collidingOk);
+
+    // copies are independent
+    FlatHashTable<CollidingKey, int> copy(colliding);
+    copy.Erase({ 1 });
+    VERIFY(colliding.Contains({ 1 }));
+    VERIFY(copy.Size() == colliding.Size() - 1);
+}
+
+} // namespace Test
@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::FlatHashTableTest
+
+    Tests Util::FlatHashTable: erasing and reinserting keys so tombstones
+    build up, growth from an empty table, and keys whose hash codes collide
+    so they share both the probe sequence and the control byte.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class FlatHashTableTest : public TestCase
+{
+    __DeclareClass(FlatHashTableTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
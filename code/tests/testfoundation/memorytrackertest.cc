@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+//  memorytrackertest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "memorytrackertest.h"
+#include "memory/memorytracker.h"
+
+using namespace Memory;
+
+namespace Test
+{
+__ImplementClass(Test::MemoryTrackerTest, 'MTRT', Test::TestCase);
+
+#if NEBULA_MEMORY_TRACKING
+static const HeapType TestHeap = PhysicsHeap;
+
+/// more than fit into a thread's ring, so a single frame overflows it
+static const SizeT MaxAllocs = 20000;
+static void* allocs[MaxAllocs];
+
+//------------------------------------------------------------------------------
+/**
+    All allocations of one call come from the same callsite.
+*/
+static void
+AllocateFromA(SizeT num, size_t size)
+{
+    IndexT i;
+    for (i = 0; i < num; i++)
+        allocs[i] = Memory::Alloc(TestHeap, size);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Same as AllocateFromA, but a different callsite.
+*/
+static void
+AllocateFromB(SizeT num, size_t size)
+{
+    IndexT i;
+    for (i = 0; i < num; i++)
+        allocs[i] = Memory::Alloc(TestHeap, size);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Freeing isn't tracked.
+*/
+static void
+FreeAllocs(SizeT num)
+{
+    IndexT i;
+    for (i = 0; i < num; i++)
+        Memory::Free(TestHeap, allocs[i]);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Find the callsite of the test heap with a given number of allocations.
+*/
+static IndexT
+FindCallsite(const TrackerFrameReport& report, SizeT allocCount)
+{
+    IndexT i;
+    for (i = 0; i < report.callsites.Size(); i++)
+    {
+        if (report.callsites[i].heapType == TestHeap && report.callsites[i].allocCount == allocCount)
+            return i;
+    }
+    return InvalidIndex;
+}
+#endif
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MemoryTrackerTest::Run()
+{
+#if NEBULA_MEMORY_TRACKING
+    const bool wasEnabled = TrackerIsEnabled();
+    TrackerEnable(true);
+    VERIFY(TrackerIsEnabled());
+
+    // start from a clean frame
+    TrackerEndFrame();
+
+    // per callsite counts, sorted by number of allocations
+    AllocateFromA(100, 32);
+    FreeAllocs(100);
+    AllocateFromB(37, 64);
+    FreeAllocs(37);
+    VERIFY(TrackerEndFrame());
+    TrackerFrameReport report;
+    TrackerGetLastFrame(report);
+    VERIFY(report.heapAllocCount[TestHeap] == 137);
+    VERIFY(report.heapAllocSize[TestHeap] == 100 * 32 + 37 * 64);
+    VERIFY(report.allocCount >= 137);
+    VERIFY(report.droppedCount == 0);
+    const IndexT callsiteA = FindCallsite(report, 100);
+    const IndexT callsiteB = FindCallsite(report, 37);
+    VERIFY(callsiteA != InvalidIndex);
+    VERIFY(callsiteB != InvalidIndex);
+    if (callsiteA != InvalidIndex && callsiteB != InvalidIndex)
+    {
+        VERIFY(callsiteA < callsiteB);
+        VERIFY(report.callsites[callsiteA].allocSize == 100 * 32);
+        VERIFY(report.callsites[callsiteB].allocSize == 37 * 64);
+        VERIFY(report.callsites[callsiteA].callsite != report.callsites[callsiteB].callsite);
+        n_printf("    callsite A:\n");
+        Util::Array<Util::String> stack = TrackerGetCallsiteStack(report.callsites[callsiteA].callsite);
+        IndexT i;
+        for (i = 0; i < stack.Size() && i < 3; i++)
+            n_printf("        %s\n", stack[i].AsCharPtr());
+        VERIFY(!stack.IsEmpty());
+    }
+
+    // the same callsite in the next frame starts counting from zero
+    AllocateFromA(10, 32);
+    FreeAllocs(10);
+    TrackerEndFrame();
+    TrackerGetLastFrame(report);
+    VERIFY(report.heapAllocCount[TestHeap] == 10);
+    VERIFY(FindCallsite(report, 10) != InvalidIndex);
+
+    // a frame which doesn't fit into the ring drops the rest and counts it
+    AllocateFromA(MaxAllocs, 16);
+    FreeAllocs(MaxAllocs);
+    TrackerEndFrame();
+    TrackerGetLastFrame(report);
+    VERIFY(report.heapAllocCount[TestHeap] < MaxAllocs);
+    VERIFY(report.droppedCount >= MaxAllocs - report.heapAllocCount[TestHeap]);
+    n_printf("    %d of %d allocations recorded, %d dropped\n", report.heapAllocCount[TestHeap], MaxAllocs, report.droppedCount);
+
+    // the ring is empty again, the next frame drops nothing
+    AllocateFromA(100, 16);
+    FreeAllocs(100);
+    TrackerEndFrame();
+    TrackerGetLastFrame(report);
+    VERIFY(report.heapAllocCount[TestHeap] == 100);
+    VERIFY(report.droppedCount == 0);
+
+    // budget on the number of allocations, the warning lists the callsite
+    TrackerSetBudgetsFatal(false);
+    TrackerSetFrameBudget(TestHeap, 50, 0);
+    AllocateFromA(40, 16);
+    FreeAllocs(40);
+    VERIFY(TrackerEndFrame());
+    AllocateFromA(60, 16);
+    FreeAllocs(60);
+    VERIFY(!TrackerEndFrame());
+
+    // budget on the allocated size
+    TrackerSetFrameBudget(TestHeap, 0, 1000);
+    AllocateFromB(10, 64);
+    FreeAllocs(10);
+    VERIFY(TrackerEndFrame());
+    AllocateFromB(20, 64);
+    FreeAllocs(20);
+    VERIFY(!TrackerEndFrame());
+    TrackerSetFrameBudget(TestHeap, 0, 0);
+
+    // budget over all heaps
+    TrackerSetFrameBudget(NumHeapTypes, 50, 0);
+    AllocateFromA(100, 16);
+    FreeAllocs(100);
+    VERIFY(!TrackerEndFrame());
+    TrackerSetFrameBudget(NumHeapTypes, 0, 0);
+    AllocateFromA(100, 16);
+    FreeAllocs(100);
+    VERIFY(TrackerEndFrame());
+
+    TrackerEnable(wasEnabled);
+#else
+    n_printf("    NEBULA_MEMORY_TRACKING is disabled, nothing to test\n");
+#endif
+}
+
+} // namespace Test
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::MemoryTrackerTest
+
+    Tests the allocation tracker: allocations are counted per callsite and
+    heap, allocations which don't fit into a thread's ring are reported as
+    dropped, and exceeding a frame budget is reported by TrackerEndFrame.
+    Allocates from the physics heap, which nothing else in the test uses.
+    Does nothing if NEBULA_MEMORY_TRACKING is disabled.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class MemoryTrackerTest : public TestCase
+{
+    __DeclareClass(MemoryTrackerTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,281 @@
+//------------------------------------------------------------------------------
+//  tcpmessagecodectest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "tcpmessagecodectest.h"
+#include "net/tcpmessagecodec.h"
+
+using namespace Net;
+
+namespace Test
+{
+__ImplementClass(Test::TcpMessageCodecTest, 'TMCT', Test::TestCase);
+
+static const SizeT NumRoundTripRounds = 200;
+static const SizeT NumCorruptionRounds = 1000;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static uint
+NextRandom(uint& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+AppendHeader(Util::Array<ubyte>& wire, uint magic, uint size)
+{
+    wire.Append((ubyte)(magic >> 24));
+    wire.Append((ubyte)(magic >> 16));
+    wire.Append((ubyte)(magic >> 8));
+    wire.Append((ubyte)magic);
+    wire.Append((ubyte)(size >> 24));
+    wire.Append((ubyte)(size >> 16));
+    wire.Append((ubyte)(size >> 8));
+    wire.Append((ubyte)size);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Appends a message with random content, mostly small messages, some
+    of them empty, and some which span several received pieces.
+*/
+static void
+AppendMessage(Util::Array<ubyte>& wire, Util::Array<Util::Array<ubyte>>& messages, uint& seed)
+{
+    const SizeT size = (NextRandom(seed) % 3 == 0) ? NextRandom(seed) % 5 : NextRandom(seed) % 3000;
+    uchar header[TcpMessageCodec::HeaderSize];
+    TcpMessageCodec::EncodeHeader(size, header);
+    IndexT i;
+    for (i = 0; i < TcpMessageCodec::HeaderSize; i++)
+    {
+        wire.Append(header[i]);
+    }
+    Util::Array<ubyte> message;
+    for (i = 0; i < size; i++)
+    {
+        message.Append((ubyte)NextRandom(seed));
+        wire.Append(message.Back());
+    }
+    messages.Append(message);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Copies the next piece of the wire into chunk, the way data arrives
+    from a socket.
+*/
+static void
+NextChunk(const Util::Array<ubyte>& wire, IndexT& position, Util::Array<ubyte>& chunk, uint& seed)
+{
+    SizeT size = 1 + NextRandom(seed) % ((NextRandom(seed) & 1) ? 16 : 5000);
+    if (size > wire.Size() - position)
+    {
+        size = wire.Size() - position;
+    }
+    chunk.Clear();
+    IndexT i;
+    for (i = 0; i < size; i++)
+    {
+        chunk.Append(wire[position + i]);
+    }
+    position += size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TcpMessageCodecTest::Run()
+{
+    uint seed = 7;
+    TcpMessageCodec::MessageView view;
+
+    // messages split at random, with headers without the magic in between
+    SizeT numMismatches = 0;
+    SizeT numMissing = 0;
+    IndexT round;
+    for (round = 0; round < NumRoundTripRounds; round++)
+    {
+        Util::Array<ubyte> wire;
+        Util::Array<Util::Array<ubyte>> messages;
+        const SizeT numMessages = 1 + NextRandom(seed) % 50;
+        IndexT i;
+        for (i = 0; i < numMessages; i++)
+        {
+            if (NextRandom(seed) % 17 == 0)
+            {
+                AppendHeader(wire, 'XXXX', 1);
+            }
+            AppendMessage(wire, messages, seed);
+        }
+
+        TcpMessageCodec codec;
+        Util::Array<ubyte> chunk;
+        IndexT position = 0;
+        IndexT numReceived = 0;
+        while (position < wire.Size())
+        {
+            NextChunk(wire, position, chunk, seed);
+            codec.DecodeData(chunk.Begin(), chunk.Size());
+            while (codec.DequeueMessage(view))
+            {
+                if ((numReceived >= messages.Size()) || (view.size != messages[numReceived].Size()) ||
+                    ((view.size > 0) && (0 != memcmp(view.data, messages[numReceived].Begin(), view.size))))
+                {
+                    numMismatches++;
+                }
+                numReceived++;
+            }
+
+            // the received data may be reused once all messages are dequeued
+            chunk.Fill(0, chunk.Size(), 0xcc);
+        }
+        if (numReceived != messages.Size())
+        {
+            numMissing++;
+        }
+        VERIFY(!codec.HasError());
+    }
+    VERIFY(numMismatches == 0);
+    VERIFY(numMissing == 0);
+
+    // random bytes of the headers are overwritten, messages may get lost,
+    // but the decoder must never hand out more than it received
+    SizeT numOutOfBounds = 0;
+    SizeT numAfterError = 0;
+    SizeT numErrors = 0;
+    uint checksum = 0;
+    for (round = 0; round < NumCorruptionRounds; round++)
+    {
+        Util::Array<ubyte> wire;
+        Util::Array<Util::Array<ubyte>> messages;
+        Util::Array<IndexT> headers;
+        const SizeT numMessages = 1 + NextRandom(seed) % 20;
+        IndexT i;
+        for (i = 0; i < numMessages; i++)
+        {
+            headers.Append(wire.Size());
+            AppendMessage(wire, messages, seed);
+        }
+        const SizeT numCorruptions = 1 + NextRandom(seed) % 4;
+        for (i = 0; i < numCorruptions; i++)
+        {
+            const IndexT header = headers[NextRandom(seed) % headers.Size()];
+            const IndexT offset = 4 + NextRandom(seed) % 4;
+            wire[header + offset] = (ubyte)NextRandom(seed);
+        }
+
+        TcpMessageCodec codec;
+        Util::Array<ubyte> chunk;
+        IndexT position = 0;
+        SizeT numBytesHandedOut = 0;
+        bool hadError = false;
+        while (position < wire.Size())
+        {
+            NextChunk(wire, position, chunk, seed);
+            codec.DecodeData(chunk.Begin(), chunk.Size());
+            while (codec.DequeueMessage(view))
+            {
+                if (hadError)
+                {
+                    numAfterError++;
+                }
+                const bool inChunk = (view.data >= chunk.Begin()) && (view.data <= chunk.End());
+                if ((view.size < 0) || (view.size > TcpMessageCodec::MaxMessageSize) ||
+                    (inChunk && (view.data + view.size > chunk.End())))
+                {
+                    numOutOfBounds++;
+                    continue;
+                }
+
+                // every message consumes its header and its size from the wire
+                numBytesHandedOut += TcpMessageCodec::HeaderSize + view.size;
+                IndexT byteIndex;
+                for (byteIndex = 0; byteIndex < view.size; byteIndex++)
+                {
+                    checksum += view.data[byteIndex];
+                }
+            }
+            hadError |= codec.HasError();
+            chunk.Fill(0, chunk.Size(), 0xcc);
+        }
+        if (numBytesHandedOut > wire.Size())
+        {
+            numOutOfBounds++;
+        }
+        if (hadError)
+        {
+            numErrors++;
+        }
+    }
+    n_printf("    %d of %d corrupted streams dropped, checksum %08x\n", numErrors, NumCorruptionRounds, checksum);
+    VERIFY(numOutOfBounds == 0);
+    VERIFY(numAfterError == 0);
+    VERIFY(numErrors > 0);
+
+    // sizes above MaxMessageSize, including ones which are negative as SizeT,
+    // in one piece and split in the middle of the header
+    const uint badSizes[] = { (uint)TcpMessageCodec::MaxMessageSize + 1, 0x7fffffff, 0x80000000, 0xffffffff };
+    IndexT sizeIndex;
+    for (sizeIndex = 0; sizeIndex < (IndexT)(sizeof(badSizes) / sizeof(uint)); sizeIndex++)
+    {
+        IndexT split;
+        for (split = 0; split < 2; split++)
+        {
+            Util::Array<ubyte> wire;
+            Util::Array<Util::Array<ubyte>> messages;
+            AppendMessage(wire, messages, seed);
+            const IndexT headerPosition = wire.Size();
+            AppendHeader(wire, 'TCPM', badSizes[sizeIndex]);
+            AppendMessage(wire, messages, seed);
+
+            TcpMessageCodec codec;
+            const IndexT end = split ? headerPosition + 5 : wire.Size();
+            codec.DecodeData(wire.Begin(), end);
+            VERIFY(codec.DequeueMessage(view) && (view.size == messages[0].Size()));
+            bool dequeued = codec.DequeueMessage(view);
+            if (split)
+            {
+                // the header isn't complete yet
+                VERIFY(!dequeued && !codec.HasError());
+                codec.DecodeData(wire.Begin() + end, wire.Size() - end);
+                dequeued = codec.DequeueMessage(view);
+            }
+            VERIFY(!dequeued && codec.HasError());
+
+            // more data is accepted, but discarded
+            codec.DecodeData(wire.Begin(), wire.Size());
+            VERIFY(!codec.DequeueMessage(view) && codec.HasError());
+
+            codec.Reset();
+            VERIFY(!codec.HasError());
+            codec.DecodeData(wire.Begin(), headerPosition);
+            VERIFY(codec.DequeueMessage(view) && (view.size == messages[0].Size()));
+        }
+    }
+
+    // complete messages are not copied, a split one is copied once
+    Util::Array<ubyte> wire;
+    Util::Array<Util::Array<ubyte>> messages;
+    AppendMessage(wire, messages, seed);
+    AppendMessage(wire, messages, seed);
+    TcpMessageCodec codec;
+    codec.DecodeData(wire.Begin(), wire.Size());
+    VERIFY(codec.DequeueMessage(view) && codec.DequeueMessage(view) && !codec.DequeueMessage(view));
+    VERIFY(codec.GetNumBytesCopied() == 0);
+    const IndexT end = wire.Size() - messages[1].Size() / 2 - 1;
+    codec.DecodeData(wire.Begin(), end);
+    VERIFY(codec.DequeueMessage(view) && !codec.DequeueMessage(view));
+    codec.DecodeData(wire.Begin() + end, wire.Size() - end);
+    VERIFY(codec.DequeueMessage(view) && (view.size == messages[1].Size()));
+    VERIFY(codec.GetNumBytesCopied() == size_t(TcpMessageCodec::HeaderSize + messages[1].Size()));
+}
+
+} // namespace Test
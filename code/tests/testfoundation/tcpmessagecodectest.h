@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::TcpMessageCodecTest
+
+    Feeds Net::TcpMessageCodec random messages split into random pieces,
+    with garbage headers in between, and checks every message comes out
+    unchanged. Then corrupts random header bytes, and checks the decoder
+    never hands out a message beyond the received data, and drops the
+    stream on a header with a size above MaxMessageSize.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class TcpMessageCodecTest : public TestCase
+{
+    __DeclareClass(TcpMessageCodecTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
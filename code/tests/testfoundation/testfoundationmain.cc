@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------
+//  testfoundationmain.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "core/coreserver.h"
+#include "system/appentry.h"
+#include "testbase/testrunner.h"
+#include "blockpooltest.h"
+#include "blockringtest.h"
+#include "dictionarytest.h"
+#include "flathashtabletest.h"
+#include "memorytrackertest.h"
+#include "tcpmessagecodectest.h"
+#include "threadcachetest.h"
+
+ImplementNebulaApplication();
+
+using namespace Core;
+using namespace Test;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NebulaMain(const Util::CommandLineArgs& args)
+{
+    // create Nebula runtime
+    Ptr<CoreServer> coreServer = CoreServer::Create();
+    coreServer->SetAppName(Util::StringAtom("Nebula Foundation Tests"));
+    coreServer->Open();
+
+    n_printf("NEBULA FOUNDATION TESTS\n");
+    n_printf("=======================\n");
+
+    // setup and run test runner
+    Ptr<TestRunner> testRunner = TestRunner::Create();
+    testRunner->AttachTestCase(BlockPoolTest::Create());
+    testRunner->AttachTestCase(TcpMessageCodecTest::Create());
+    testRunner->AttachTestCase(ThreadCacheTest::Create());
+    testRunner->AttachTestCase(FlatHashTableTest::Create());
+    testRunner->AttachTestCase(BlockRingTest::Create());
+    testRunner->AttachTestCase(DictionaryTest::Create());
+    testRunner->AttachTestCase(MemoryTrackerTest::Create());
+    bool success = testRunner->Run();
+
+    testRunner = nullptr;
+    coreServer->Close();
+    coreServer = nullptr;
+
+    Core::SysFunc::Exit(success ? 0 : 1);
+}
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+//  threadcachetest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "threadcachetest.h"
+#include "memory/memory.h"
+#include "threading/thread.h"
+
+using namespace Memory;
+
+namespace Test
+{
+__ImplementClass(Test::ThreadCacheTest, 'TCOT', Test::TestCase);
+
+static const SizeT NumBlocks = 256;
+
+//------------------------------------------------------------------------------
+/**
+    Frees blocks which were allocated by the main thread.
+*/
+class ThreadCacheTestThread : public Threading::Thread
+{
+    __DeclareClass(ThreadCacheTestThread);
+public:
+    /// blocks to free
+    void* blocks[NumBlocks];
+    /// this method runs in the thread context
+    virtual void DoWork();
+};
+__ImplementClass(Test::ThreadCacheTestThread, 'TCOH', Threading::Thread);
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ThreadCacheTestThread::DoWork()
+{
+    IndexT i;
+    for (i = 0; i < NumBlocks; i++)
+        Memory::Free(ObjectHeap, this->blocks[i]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ThreadCacheTest::Run()
+{
+#if NEBULA_MEMORY_THREADCACHE
+    // small blocks of the cached heaps come from slabs
+    void* small = Memory::Alloc(ObjectHeap, 56);
+    VERIFY(ThreadCacheIsSlabBlock(small));
+    VERIFY(ThreadCacheGetSize(small) == 56);
+
+    // large blocks and the other heaps are passed on to the C runtime
+    void* large = Memory::Alloc(ObjectHeap, 1024 * 1024);
+    VERIFY(!ThreadCacheIsSlabBlock(large));
+    VERIFY(ThreadCacheGetSize(large) == 1024 * 1024);
+    void* uncached = Memory::Alloc(ResourceHeap, 64);
+    VERIFY(!ThreadCacheIsSlabBlock(uncached));
+    Memory::Free(ResourceHeap, uncached);
+
+    // memory of the C runtime is never mistaken for a slab block
+    void* foreign = malloc(64);
+    VERIFY(!ThreadCacheIsSlabBlock(foreign));
+    free(foreign);
+
+    // growing within the 80 byte size class keeps the block, growing beyond the largest class makes it a large block
+    memset(small, 0x5a, 56);
+    VERIFY(Memory::Realloc(ObjectHeap, small, 64) == small);
+    void* grown = Memory::Realloc(ObjectHeap, small, 64 * 1024);
+    VERIFY(!ThreadCacheIsSlabBlock(grown));
+    VERIFY(ThreadCacheGetSize(grown) == 64 * 1024);
+    bool preserved = true;
+    IndexT i;
+    for (i = 0; i < 56; i++)
+        preserved &= ((const ubyte*)grown)[i] == 0x5a;
+    VERIFY(preserved);
+    Memory::Free(ObjectHeap, grown);
+    Memory::Free(ObjectHeap, large);
+
+    // blocks freed by another thread are reused by this one
+    Ptr<ThreadCacheTestThread> thread = ThreadCacheTestThread::Create();
+    thread->SetName("ThreadCacheTest");
+    bool allSlab = true;
+    for (i = 0; i < NumBlocks; i++)
+    {
+        thread->blocks[i] = Memory::Alloc(ObjectHeap, 48);
+        allSlab &= ThreadCacheIsSlabBlock(thread->blocks[i]);
+    }
+    VERIFY(allSlab);
+    thread->Start();
+    thread->Stop();
+    allSlab = true;
+    for (i = 0; i < NumBlocks; i++)
+    {
+        void* block = Memory::Alloc(ObjectHeap, 48);
+        allSlab &= ThreadCacheIsSlabBlock(block);
+        Memory::Free(ObjectHeap, block);
+    }
+    VERIFY(allSlab);
+#else
+    n_printf("    thread cache is disabled, nothing to test\n");
+#endif
+}
+
+} // namespace Test
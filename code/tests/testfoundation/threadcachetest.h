@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::ThreadCacheTest
+
+    Checks that the thread cache backend of Memory::Alloc() tells slab
+    blocks and large blocks apart by address, including blocks which move
+    between the two by Realloc(), and blocks freed by another thread.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class ThreadCacheTest : public TestCase
+{
+    __DeclareClass(ThreadCacheTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+//------------------------------------------------------------------------------
+//  componentscheduletest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "componentscheduletest.h"
+#include "basegamefeature/managers/componentmanager.h"
+#include "basegamefeature/components/tagcomponent.h"
+#include "threading/thread.h"
+#include <atomic>
+
+namespace Test
+{
+__ImplementClass(Test::ComponentScheduleTest, 'CSCT', Test::TestCase);
+
+using namespace Game;
+
+enum
+{
+    ReaderA,        // reads 'ATTA', writes 'ATTB'
+    ReaderB,        // reads 'ATTA', writes 'ATTC'
+    WriterB,        // writes 'ATTB', conflicts with ReaderA
+    Undeclared,     // conflicts with everything
+
+    NumComponents
+};
+
+static std::atomic<int> numCalls[NumComponents];
+static Threading::ThreadId callThreads[NumComponents];
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <int COMPONENT> static void
+OnEndFrame()
+{
+    callThreads[COMPONENT] = Threading::Thread::GetMyThreadId();
+    numCalls[COMPONENT]++;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Runs one OnEndFrame pass, returns true if every component was called once.
+*/
+static bool
+RunEndFrame(ComponentManager* manager)
+{
+    IndexT i;
+    for (i = 0; i < NumComponents; i++)
+    {
+        numCalls[i] = 0;
+        callThreads[i] = Threading::InvalidThreadId;
+    }
+    manager->OnEndFrame();
+
+    bool calledOnce = true;
+    for (i = 0; i < NumComponents; i++)
+        calledOnce &= (numCalls[i] == 1);
+    return calledOnce;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ComponentScheduleTest::Run()
+{
+    Ptr<ComponentManager> manager = ComponentManager::Create();
+
+    const Util::FourCC attrA('ATTA'), attrB('ATTB'), attrC('ATTC');
+    TagComponentAllocator* components[NumComponents];
+    IndexT i;
+    for (i = 0; i < NumComponents; i++)
+    {
+        components[i] = n_new(TagComponentAllocator);
+        components[i]->EnableEvent(ComponentEvent::OnEndFrame);
+    }
+    components[ReaderA]->functions.OnEndFrame = OnEndFrame<ReaderA>;
+    components[ReaderB]->functions.OnEndFrame = OnEndFrame<ReaderB>;
+    components[WriterB]->functions.OnEndFrame = OnEndFrame<WriterB>;
+    components[Undeclared]->functions.OnEndFrame = OnEndFrame<Undeclared>;
+    components[ReaderA]->DeclareFrameAccess({ attrA }, { attrB });
+    components[ReaderB]->DeclareFrameAccess({ attrA }, { attrC });
+    components[WriterB]->DeclareFrameAccess({}, { attrB });
+
+    VERIFY(!components[ReaderA]->ConflictsWith(components[ReaderB]));
+    VERIFY(components[ReaderA]->ConflictsWith(components[WriterB]));
+    VERIFY(!components[ReaderB]->ConflictsWith(components[WriterB]));
+    VERIFY(components[Undeclared]->ConflictsWith(components[ReaderB]));
+
+    manager->RegisterComponent(components[ReaderA], "ScheduleTestReaderA", 'STRA');
+    manager->RegisterComponent(components[ReaderB], "ScheduleTestReaderB", 'STRB');
+    manager->RegisterComponent(components[WriterB], "ScheduleTestWriterB", 'STWB');
+    manager->RegisterComponent(components[Undeclared], "ScheduleTestUndeclared", 'STUD');
+
+    // ReaderA and ReaderB share the first batch, which runs on the component job port
+    VERIFY(RunEndFrame(manager));
+    VERIFY(manager->GetComponentTimings(ReaderA).onEndFrameBatch == 0);
+    VERIFY(manager->GetComponentTimings(ReaderB).onEndFrameBatch == 0);
+    VERIFY(manager->GetComponentTimings(WriterB).onEndFrameBatch == 1);
+    VERIFY(manager->GetComponentTimings(Undeclared).onEndFrameBatch == 2);
+    VERIFY(callThreads[Undeclared] == Threading::Thread::GetMyThreadId());
+
+    // serial execution runs the same schedule on this thread
+    manager->SetSerialExecution(true);
+    VERIFY(RunEndFrame(manager));
+    VERIFY(manager->GetComponentTimings(ReaderA).onEndFrameBatch == 0);
+    VERIFY(manager->GetComponentTimings(ReaderB).onEndFrameBatch == 0);
+    bool onThisThread = true;
+    for (i = 0; i < NumComponents; i++)
+        onThisThread &= (callThreads[i] == Threading::Thread::GetMyThreadId());
+    VERIFY(onThisThread);
+    manager->SetSerialExecution(false);
+
+    // disabling the conflicting writer leaves the undeclared component in the second batch
+    manager->DisableComponent('STWB');
+    for (i = 0; i < NumComponents; i++)
+        numCalls[i] = 0;
+    manager->OnEndFrame();
+    VERIFY(numCalls[WriterB] == 0);
+    VERIFY(manager->GetComponentTimings(WriterB).onEndFrameBatch == InvalidIndex);
+    VERIFY(manager->GetComponentTimings(Undeclared).onEndFrameBatch == 1);
+
+    manager->DeregisterAll();
+    manager = nullptr;
+    for (i = 0; i < NumComponents; i++)
+        n_delete(components[i]);
+}
+
+} // namespace Test
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::ComponentScheduleTest
+
+    Registers components with and without declared frame access to the
+    Game::ComponentManager, and checks that two components which don't
+    conflict are run in the same OnEndFrame batch, while conflicting and
+    undeclared components get batches of their own. Then checks serial
+    execution keeps the batches, but runs everything on the game thread.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class ComponentScheduleTest : public TestCase
+{
+    __DeclareClass(ComponentScheduleTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------
+//  testgamemain.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "core/coreserver.h"
+#include "system/appentry.h"
+#include "debug/debuginterface.h"
+#include "testbase/testrunner.h"
+#include "componentscheduletest.h"
+
+ImplementNebulaApplication();
+
+using namespace Core;
+using namespace Test;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NebulaMain(const Util::CommandLineArgs& args)
+{
+    // create Nebula runtime
+    Ptr<CoreServer> coreServer = CoreServer::Create();
+    coreServer->SetAppName(Util::StringAtom("Nebula Game Tests"));
+    coreServer->Open();
+
+#if __NEBULA_HTTP__
+    // the game managers setup debug timers, which register with the debug server
+    Ptr<Debug::DebugInterface> debugInterface = Debug::DebugInterface::Create();
+    debugInterface->Open();
+#endif
+
+    n_printf("NEBULA GAME TESTS\n");
+    n_printf("=================\n");
+
+    // setup and run test runner
+    Ptr<TestRunner> testRunner = TestRunner::Create();
+    testRunner->AttachTestCase(ComponentScheduleTest::Create());
+    bool success = testRunner->Run();
+
+    testRunner = nullptr;
+#if __NEBULA_HTTP__
+    debugInterface->Close();
+    debugInterface = nullptr;
+#endif
+    coreServer->Close();
+    coreServer = nullptr;
+
+    Core::SysFunc::Exit(success ? 0 : 1);
+}
@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------------
+//  meshoptimizertest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "meshoptimizertest.h"
+#include "coregraphics/meshoptimizer.h"
+#include "util/fixedarray.h"
+
+using namespace CoreGraphics;
+
+namespace Test
+{
+__ImplementClass(Test::MeshOptimizerTest, 'MOPT', Test::TestCase);
+
+//------------------------------------------------------------------------------
+/**
+    Builds a grid of size x size quads, two triangles each, with the
+    triangles shuffled so that the input has no locality at all.
+*/
+static Util::FixedArray<uint>
+MakeShuffledGrid(SizeT size)
+{
+    const SizeT stride = size + 1;
+    Util::FixedArray<uint> indices(size * size * 6);
+    IndexT x, y, i = 0;
+    for (y = 0; y < size; y++)
+    {
+        for (x = 0; x < size; x++)
+        {
+            const uint v = y * stride + x;
+            indices[i++] = v; indices[i++] = v + stride; indices[i++] = v + 1;
+            indices[i++] = v + 1; indices[i++] = v + stride; indices[i++] = v + stride + 1;
+        }
+    }
+
+    // Fisher-Yates with a fixed LCG, so the test is deterministic
+    uint seed = 12345;
+    const SizeT numTriangles = size * size * 2;
+    IndexT t;
+    for (t = numTriangles - 1; t > 0; t--)
+    {
+        seed = seed * 1664525 + 1013904223;
+        const IndexT other = (seed >> 8) % (t + 1);
+        IndexT j;
+        for (j = 0; j < 3; j++)
+        {
+            const uint tmp = indices[t * 3 + j];
+            indices[t * 3 + j] = indices[other * 3 + j];
+            indices[other * 3 + j] = tmp;
+        }
+    }
+    return indices;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Triangles are compared with their vertices rotated so the smallest
+    comes first, which keeps the winding.
+*/
+static uint64
+TriangleKey(const uint* tri)
+{
+    IndexT first = 0;
+    if (tri[1] < tri[first]) first = 1;
+    if (tri[2] < tri[first]) first = 2;
+    return (uint64(tri[first]) << 42) | (uint64(tri[(first + 1) % 3]) << 21) | uint64(tri[(first + 2) % 3]);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static bool
+SameTriangles(const uint* a, const uint* b, SizeT numIndices)
+{
+    Util::FixedArray<uint64> keysA(numIndices / 3), keysB(numIndices / 3);
+    IndexT i;
+    for (i = 0; i < numIndices / 3; i++)
+    {
+        keysA[i] = TriangleKey(&a[i * 3]);
+        keysB[i] = TriangleKey(&b[i * 3]);
+    }
+    keysA.Sort();
+    keysB.Sort();
+    return keysA == keysB;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+MeshOptimizerTest::Run()
+{
+    // a single triangle transforms all its vertices once
+    const uint single[] = { 0, 1, 2 };
+    VERIFY(MeshOptimizer::ComputeACMR(single, 3, 3) == 3.0f);
+    VERIFY(MeshOptimizer::ComputeATVR(single, 3, 3) == 1.0f);
+
+    // the second triangle of a quad reuses an edge
+    const uint quad[] = { 0, 1, 2, 2, 1, 3 };
+    VERIFY(MeshOptimizer::ComputeACMR(quad, 6, 4) == 2.0f);
+    VERIFY(MeshOptimizer::ComputeATVR(quad, 6, 4) == 1.0f);
+
+    // with a cache of 3 the first vertex is evicted before it is used again
+    const uint evict[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    VERIFY(MeshOptimizer::ComputeACMR(evict, 9, 6, 3) == 3.0f);
+    VERIFY(MeshOptimizer::ComputeATVR(evict, 9, 6, 3) == 1.5f);
+    VERIFY(MeshOptimizer::ComputeACMR(evict, 9, 6, 6) == 2.0f);
+    VERIFY(MeshOptimizer::ComputeATVR(evict, 9, 6, 6) == 1.0f);
+
+    // optimize a shuffled 32x32 grid
+    const SizeT gridSize = 32;
+    const SizeT numVertices = (gridSize + 1) * (gridSize + 1);
+    Util::FixedArray<uint> input = MakeShuffledGrid(gridSize);
+    const SizeT numIndices = input.Size();
+    const float inputACMR = MeshOptimizer::ComputeACMR(input.Begin(), numIndices, numVertices);
+    VERIFY(inputACMR > 2.5f);
+
+    Util::FixedArray<uint> optimized(numIndices);
+    MeshOptimizer::OptimizeVertexCache(optimized.Begin(), input.Begin(), numIndices, numVertices);
+    VERIFY(SameTriangles(input.Begin(), optimized.Begin(), numIndices));
+    const float optimizedACMR = MeshOptimizer::ComputeACMR(optimized.Begin(), numIndices, numVertices);
+    const float optimizedATVR = MeshOptimizer::ComputeATVR(optimized.Begin(), numIndices, numVertices);
+    n_printf("    ACMR %.3f -> %.3f, ATVR %.3f\n", inputACMR, optimizedACMR, optimizedATVR);
+    VERIFY(optimizedACMR < 0.8f);
+    VERIFY(optimizedATVR < 1.5f);
+
+    // the vertex positions are their own index, so the remapped mesh can be compared with the original
+    Util::FixedArray<uint> vertices(numVertices + 1);
+    IndexT i;
+    for (i = 0; i < vertices.Size(); i++)
+        vertices[i] = i;
+    Util::FixedArray<uint> remapped = optimized;
+    Util::FixedArray<uint> fetched(numVertices + 1, 0);
+    const SizeT numReferenced = MeshOptimizer::OptimizeVertexFetch(fetched.Begin(), remapped.Begin(), numIndices, vertices.Begin(), numVertices + 1, sizeof(uint));
+    VERIFY(numReferenced == numVertices);
+
+    bool sameMesh = true;
+    bool firstUseOrder = true;
+    uint nextVertex = 0;
+    for (i = 0; i < numIndices; i++)
+    {
+        sameMesh &= fetched[remapped[i]] == optimized[i];
+        if (remapped[i] == nextVertex)
+            nextVertex++;
+        else
+            firstUseOrder &= remapped[i] < nextVertex;
+    }
+    VERIFY(sameMesh);
+    VERIFY(firstUseOrder);
+    VERIFY(MeshOptimizer::ComputeACMR(remapped.Begin(), numIndices, numVertices) == optimizedACMR);
+}
+
+} // namespace Test
@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::MeshOptimizerTest
+
+    Checks the cache simulation of CoreGraphics::MeshOptimizer against
+    hand computed ACMR and ATVR values, and that the vertex cache and vertex
+    fetch passes keep the triangles of a shuffled grid intact while bringing
+    its ACMR and ATVR down.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class MeshOptimizerTest : public TestCase
+{
+    __DeclareClass(MeshOptimizerTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+//  pipelinedatabasetest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "render/stdneb.h"
+#include "pipelinedatabasetest.h"
+#include "coregraphics/vk/vkpipelinedatabase.h"
+
+using namespace Vulkan;
+using namespace CoreGraphics;
+
+namespace Test
+{
+__ImplementClass(Test::PipelineDatabaseTest, 'PDBT', Test::TestCase);
+
+static const SizeT NumBufferedFrames = 3;
+
+static SizeT numCreated = 0;
+static SizeT numDestroyed = 0;
+static VkPrimitiveTopology lastTopology = VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
+
+//------------------------------------------------------------------------------
+/**
+    Hands out consecutive fake handles, so every created pipeline is unique.
+*/
+static VkResult
+MockCreatePipeline(VkDevice dev, VkPipelineCache cache, const VkGraphicsPipelineCreateInfo* info, VkPipeline* pipeline)
+{
+    numCreated++;
+    lastTopology = info->pInputAssemblyState->topology;
+    *pipeline = (VkPipeline)(uintptr_t)numCreated;
+    return VK_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+MockDestroyPipeline(VkDevice dev, VkPipeline pipeline)
+{
+    numDestroyed++;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Everything which goes into a pipeline key.
+*/
+struct PipelineDatabaseTestState
+{
+    ShaderProgramId program;
+    PassId pass;
+    uint32_t subpass;
+    VkPipelineVertexInputStateCreateInfo* vertexLayout;
+    VkPrimitiveTopology topology;
+};
+
+//------------------------------------------------------------------------------
+/**
+    The input assembly state is changed in place, like the graphics device does.
+*/
+static VkPipeline
+GetPipeline(VkPipelineDatabase& database, const PipelineDatabaseTestState& state, const VkGraphicsPipelineCreateInfo& shaderInfo, VkPipelineInputAssemblyStateCreateInfo& inputAssembly)
+{
+    inputAssembly.topology = state.topology;
+    database.SetPass(state.pass);
+    database.SetSubpass(state.subpass);
+    database.SetShader(state.program, shaderInfo);
+    database.SetVertexLayout(state.vertexLayout);
+    database.SetInputLayout(&inputAssembly);
+    return database.GetCompiledPipeline();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PipelineDatabaseTest::Run()
+{
+    numCreated = 0;
+    numDestroyed = 0;
+
+    VkPipelineDatabase database;
+    database.SetCreatePipelineFunc(MockCreatePipeline, MockDestroyPipeline);
+    database.Setup((VkDevice)(uintptr_t)1, (VkPipelineCache)(uintptr_t)1, NumBufferedFrames);
+
+    VkPipelineColorBlendStateCreateInfo colorBlend = {};
+    VkGraphicsPipelineCreateInfo shaderInfo = {};
+    shaderInfo.pColorBlendState = &colorBlend;
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    VkPipelineVertexInputStateCreateInfo layouts[2] = {};
+
+    const ShaderProgramId programA(1, 0, 1, 0);
+    const ShaderProgramId programB(2, 0, 1, 0);
+    PipelineDatabaseTestState base;
+    base.program = programA;
+    base.pass = PassId(0, 0);
+    base.subpass = 0;
+    base.vertexLayout = &layouts[0];
+    base.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // the first request creates the pipeline, the second one hits
+    VkPipeline basePipeline = GetPipeline(database, base, shaderInfo, inputAssembly);
+    VERIFY(basePipeline != VK_NULL_HANDLE);
+    VERIFY(numCreated == 1);
+    VERIFY(GetPipeline(database, base, shaderInfo, inputAssembly) == basePipeline);
+    VERIFY(numCreated == 1);
+
+    // every part of the key misses on its own
+    PipelineDatabaseTestState state = base;
+    state.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    VkPipeline linePipeline = GetPipeline(database, state, shaderInfo, inputAssembly);
+    VERIFY(numCreated == 2);
+    VERIFY(linePipeline != basePipeline);
+    VERIFY(lastTopology == VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+
+    state = base;
+    state.subpass = 1;
+    GetPipeline(database, state, shaderInfo, inputAssembly);
+    VERIFY(numCreated == 3);
+
+    state = base;
+    state.pass = PassId(1, 0);
+    GetPipeline(database, state, shaderInfo, inputAssembly);
+    VERIFY(numCreated == 4);
+
+    state = base;
+    state.vertexLayout = &layouts[1];
+    GetPipeline(database, state, shaderInfo, inputAssembly);
+    VERIFY(numCreated == 5);
+
+    state = base;
+    state.program = programB;
+    VkPipeline programBPipeline = GetPipeline(database, state, shaderInfo, inputAssembly);
+    VERIFY(numCreated == 6);
+    VERIFY(database.GetNumPipelines() == 6);
+
+    // changing the topology back in place, and resetting the state, still hits
+    VERIFY(GetPipeline(database, base, shaderInfo, inputAssembly) == basePipeline);
+    database.Reset();
+    VERIFY(GetPipeline(database, base, shaderInfo, inputAssembly) == basePipeline);
+    state = base;
+    state.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    VERIFY(GetPipeline(database, state, shaderInfo, inputAssembly) == linePipeline);
+    VERIFY(numCreated == 6);
+
+    // reloading a program retires its pipelines, but doesn't destroy them yet
+    database.Reload(programA);
+    VERIFY(database.GetNumPipelines() == 1);
+    VERIFY(database.GetNumRetiredPipelines() == 5);
+    VERIFY(numDestroyed == 0);
+
+    // the next request for a reloaded pipeline creates a new one
+    VkPipeline reloadedPipeline = GetPipeline(database, base, shaderInfo, inputAssembly);
+    VERIFY(reloadedPipeline != basePipeline);
+    VERIFY(numCreated == 7);
+    state = base;
+    state.program = programB;
+    VERIFY(GetPipeline(database, state, shaderInfo, inputAssembly) == programBPipeline);
+
+    // retired pipelines survive until every buffered frame has passed
+    IndexT i;
+    for (i = 0; i < NumBufferedFrames - 1; i++)
+    {
+        database.NextCycle();
+        VERIFY(numDestroyed == 0);
+        VERIFY(database.GetNumRetiredPipelines() == 5);
+    }
+    database.NextCycle();
+    VERIFY(numDestroyed == 5);
+    VERIFY(database.GetNumRetiredPipelines() == 0);
+
+    // pipelines retired in a later cycle get the same grace period
+    database.NextCycle();
+    database.Reload(programB);
+    VERIFY(database.GetNumPipelines() == 1);
+    VERIFY(database.GetNumRetiredPipelines() == 1);
+    for (i = 0; i < NumBufferedFrames - 1; i++)
+        database.NextCycle();
+    VERIFY(numDestroyed == 5);
+    database.NextCycle();
+    VERIFY(numDestroyed == 6);
+
+    // discarding destroys everything which is left
+    database.Discard();
+    VERIFY(database.GetNumPipelines() == 0);
+    VERIFY(numDestroyed == numCreated);
+}
+
+} // namespace Test
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::PipelineDatabaseTest
+
+    Drives Vulkan::VkPipelineDatabase with mock create and destroy
+    functions. Checks which state changes hit or miss the database, that
+    Reload retires the pipelines of a program, and that NextCycle only
+    destroys retired pipelines once all buffered frames have passed.
+    Runs entirely on the CPU.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class PipelineDatabaseTest : public TestCase
+{
+    __DeclareClass(PipelineDatabaseTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -0,0 +1,44 @@
+//------------------------------------------------------------------------------
+//  testrendermain.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "core/coreserver.h"
+#include "system/appentry.h"
+#include "testbase/testrunner.h"
+#include "meshoptimizertest.h"
+#include "pipelinedatabasetest.h"
+#include "texturecontainertest.h"
+
+ImplementNebulaApplication();
+
+using namespace Core;
+using namespace Test;
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NebulaMain(const Util::CommandLineArgs& args)
+{
+    // create Nebula runtime
+    Ptr<CoreServer> coreServer = CoreServer::Create();
+    coreServer->SetAppName(Util::StringAtom("Nebula Render Tests"));
+    coreServer->Open();
+
+    n_printf("NEBULA RENDER TESTS\n");
+    n_printf("===================\n");
+
+    // setup and run test runner
+    Ptr<TestRunner> testRunner = TestRunner::Create();
+    testRunner->AttachTestCase(MeshOptimizerTest::Create());
+    testRunner->AttachTestCase(TextureContainerTest::Create());
+    testRunner->AttachTestCase(PipelineDatabaseTest::Create());
+    bool success = testRunner->Run();
+
+    testRunner = nullptr;
+    coreServer->Close();
+    coreServer = nullptr;
+
+    Core::SysFunc::Exit(success ? 0 : 1);
+}
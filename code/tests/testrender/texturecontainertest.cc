@@ -0,0 +1,272 @@
+//------------------------------------------------------------------------------
+//  texturecontainertest.cc
+//  (C) 2020 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "foundation/stdneb.h"
+#include "texturecontainertest.h"
+#include "coregraphics/vk/vktexturecontainer.h"
+
+using namespace Vulkan;
+
+namespace Test
+{
+__ImplementClass(Test::TextureContainerTest, 'TXCT', Test::TestCase);
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+Append32(Util::Array<ubyte>& buf, uint32_t value)
+{
+    IndexT i;
+    for (i = 0; i < 4; i++)
+        buf.Append((ubyte)(value >> (i * 8)));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+Append64(Util::Array<ubyte>& buf, uint64_t value)
+{
+    Append32(buf, (uint32_t)value);
+    Append32(buf, (uint32_t)(value >> 32));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+AppendBytes(Util::Array<ubyte>& buf, SizeT num, ubyte value)
+{
+    IndexT i;
+    for (i = 0; i < num; i++)
+        buf.Append(value);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Builds a DDS header, with a DX10 header if dxgiFormat is not 0. The
+    pixel format is either a fourcc, or an uncompressed RGB format when
+    fourcc is 0.
+*/
+static Util::Array<ubyte>
+MakeDDS(uint32_t width, uint32_t height, uint32_t depth, uint32_t mips, uint32_t fourcc, uint32_t bitCount, uint32_t caps2, uint32_t dxgiFormat, uint32_t dimension, uint32_t miscFlags, uint32_t arraySize)
+{
+    Util::Array<ubyte> buf;
+    Append32(buf, 0x20534444);          // 'DDS '
+    Append32(buf, 124);                 // header size
+    Append32(buf, 0);                   // flags
+    Append32(buf, height);
+    Append32(buf, width);
+    Append32(buf, 0);                   // pitch
+    Append32(buf, depth);
+    Append32(buf, mips);
+    AppendBytes(buf, 44, 0);            // reserved
+
+    // pixel format
+    Append32(buf, 32);
+    if (dxgiFormat != 0)
+    {
+        Append32(buf, 0x4);             // DDPF_FOURCC
+        Append32(buf, 0x30315844);      // 'DX10'
+        AppendBytes(buf, 20, 0);
+    }
+    else if (fourcc != 0)
+    {
+        Append32(buf, 0x4);             // DDPF_FOURCC
+        Append32(buf, fourcc);
+        AppendBytes(buf, 20, 0);
+    }
+    else
+    {
+        Append32(buf, 0x40);            // DDPF_RGB
+        Append32(buf, 0);
+        Append32(buf, bitCount);
+        Append32(buf, bitCount == 32 ? 0x00ff0000 : 0x000000ff);
+        Append32(buf, 0x0000ff00);
+        Append32(buf, bitCount == 32 ? 0x000000ff : 0x00ff0000);
+        Append32(buf, bitCount == 32 ? 0xff000000 : 0);
+    }
+
+    Append32(buf, 0);                   // caps
+    Append32(buf, caps2);
+    AppendBytes(buf, 12, 0);            // caps3, caps4, reserved
+    n_assert(buf.Size() == 128);
+
+    if (dxgiFormat != 0)
+    {
+        Append32(buf, dxgiFormat);
+        Append32(buf, dimension);
+        Append32(buf, miscFlags);
+        Append32(buf, arraySize);
+        Append32(buf, 0);
+    }
+    return buf;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Builds a KTX2 file with one level index entry per level, followed by
+    the level data.
+*/
+static Util::Array<ubyte>
+MakeKTX2(VkFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t layers, uint32_t faces, const Util::Array<uint64_t>& levelSizes, uint32_t supercompression)
+{
+    static const ubyte Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    Util::Array<ubyte> buf;
+    IndexT i;
+    for (i = 0; i < 12; i++)
+        buf.Append(Identifier[i]);
+    Append32(buf, (uint32_t)format);
+    Append32(buf, 1);                   // type size
+    Append32(buf, width);
+    Append32(buf, height);
+    Append32(buf, depth);
+    Append32(buf, layers);
+    Append32(buf, faces);
+    Append32(buf, levelSizes.Size());
+    Append32(buf, supercompression);
+    AppendBytes(buf, 32, 0);            // dfd, kvd and sgd offsets and sizes
+    n_assert(buf.Size() == 80);
+
+    uint64_t offset = 80 + 24 * levelSizes.Size();
+    for (i = 0; i < levelSizes.Size(); i++)
+    {
+        Append64(buf, offset);
+        Append64(buf, levelSizes[i]);
+        Append64(buf, levelSizes[i]);
+        offset += levelSizes[i];
+    }
+    for (i = 0; i < levelSizes.Size(); i++)
+        AppendBytes(buf, (SizeT)levelSizes[i], 0x22);
+    return buf;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static SizeT
+BlockSize(uint32_t width, uint32_t height, SizeT blockBytes)
+{
+    return Math::n_max((width + 3) / 4, 1u) * Math::n_max((height + 3) / 4, 1u) * blockBytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TextureContainerTest::Run()
+{
+    VkTextureContainer::Layout layout;
+    uint32_t mip;
+
+    // DXT1 256x128 with a full mip chain
+    {
+        Util::Array<ubyte> dds = MakeDDS(256, 128, 0, 9, 0x31545844, 0, 0, 0, 0, 0, 0);
+        SizeT dataSize = 0;
+        for (mip = 0; mip < 9; mip++)
+            dataSize += BlockSize(Math::n_max(256u >> mip, 1u), Math::n_max(128u >> mip, 1u), 8);
+        AppendBytes(dds, dataSize, 0x11);
+
+        VERIFY(VkTextureContainer::Parse(dds.Begin(), dds.Size(), layout));
+        VERIFY(layout.format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK);
+        VERIFY(layout.width == 256 && layout.height == 128 && layout.depth == 1);
+        VERIFY(layout.mips == 9 && layout.layers == 1 && !layout.cube);
+        VERIFY(layout.subresources.Size() == 9);
+        VERIFY(layout.subresources[0].offset == 128);
+        VERIFY(layout.subresources[0].size == 64 * 32 * 8);
+        VERIFY(layout.subresources[8].width == 1 && layout.subresources[8].height == 1);
+        VERIFY(layout.subresources[8].size == 8);
+        VERIFY(layout.subresources.Back().offset + layout.subresources.Back().size == dds.Size());
+
+        // one byte short
+        VERIFY(!VkTextureContainer::Parse(dds.Begin(), dds.Size() - 1, layout));
+    }
+
+    // DX10 header, BC7 sRGB cube array with two cubes and 7 mips
+    {
+        Util::Array<ubyte> dds = MakeDDS(64, 64, 0, 7, 0, 0, 0, 99, 3, 0x4, 2);
+        SizeT dataSize = 0;
+        for (mip = 0; mip < 7; mip++)
+            dataSize += BlockSize(64 >> mip, 64 >> mip, 16) * 12;
+        AppendBytes(dds, dataSize, 0x11);
+
+        VERIFY(VkTextureContainer::Parse(dds.Begin(), dds.Size(), layout));
+        VERIFY(layout.format == VK_FORMAT_BC7_SRGB_BLOCK);
+        VERIFY(layout.cube && layout.layers == 12 && layout.mips == 7);
+        VERIFY(layout.subresources.Size() == 84);
+        VERIFY(layout.subresources[0].offset == 148);
+
+        // DDS stores the whole mip chain of a face before the next face
+        VERIFY(layout.subresources[7].layer == 1 && layout.subresources[7].mip == 0);
+        VERIFY(layout.subresources.Back().offset + layout.subresources.Back().size == dds.Size());
+    }
+
+    // uncompressed 32 bit BGRA, and 24 bit BGR which can't be sampled without conversion
+    {
+        Util::Array<ubyte> dds = MakeDDS(32, 16, 0, 1, 0, 32, 0, 0, 0, 0, 0);
+        AppendBytes(dds, 32 * 16 * 4, 0x11);
+        VERIFY(VkTextureContainer::Parse(dds.Begin(), dds.Size(), layout));
+        VERIFY(layout.format == VK_FORMAT_B8G8R8A8_UNORM);
+        VERIFY(layout.subresources.Size() == 1 && layout.subresources[0].size == 32 * 16 * 4);
+
+        Util::Array<ubyte> bgr = MakeDDS(32, 16, 0, 1, 0, 24, 0, 0, 0, 0, 0);
+        AppendBytes(bgr, 32 * 16 * 3, 0x11);
+        VERIFY(!VkTextureContainer::Parse(bgr.Begin(), bgr.Size(), layout));
+    }
+
+    // KTX2 volume, RGBA16 float 16x16x4 with 5 levels
+    {
+        Util::Array<uint64_t> levelSizes;
+        for (mip = 0; mip < 5; mip++)
+            levelSizes.Append((uint64_t)Math::n_max(16u >> mip, 1u) * Math::n_max(16u >> mip, 1u) * Math::n_max(4u >> mip, 1u) * 8);
+        Util::Array<ubyte> ktx = MakeKTX2(VK_FORMAT_R16G16B16A16_SFLOAT, 16, 16, 4, 0, 1, levelSizes, 0);
+
+        VERIFY(VkTextureContainer::Parse(ktx.Begin(), ktx.Size(), layout));
+        VERIFY(layout.format == VK_FORMAT_R16G16B16A16_SFLOAT);
+        VERIFY(layout.depth == 4 && layout.mips == 5 && layout.layers == 1);
+        VERIFY(layout.subresources[0].offset == 80 + 24 * 5);
+        VERIFY(layout.subresources[0].size == 16 * 16 * 4 * 8);
+        VERIFY(layout.subresources[2].width == 4 && layout.subresources[2].depth == 1);
+        VERIFY(layout.subresources[4].size == 8);
+    }
+
+    // KTX2 cube, BC3 32x32 with 6 levels
+    {
+        Util::Array<uint64_t> levelSizes;
+        for (mip = 0; mip < 6; mip++)
+            levelSizes.Append(BlockSize(32 >> mip, 32 >> mip, 16) * 6);
+        Util::Array<ubyte> ktx = MakeKTX2(VK_FORMAT_BC3_UNORM_BLOCK, 32, 32, 0, 0, 6, levelSizes, 0);
+
+        VERIFY(VkTextureContainer::Parse(ktx.Begin(), ktx.Size(), layout));
+        VERIFY(layout.cube && layout.layers == 6 && layout.mips == 6);
+        VERIFY(layout.subresources.Size() == 36);
+
+        // KTX2 stores all faces of a level together
+        VERIFY(layout.subresources[1].mip == 0 && layout.subresources[1].layer == 1);
+        VERIFY(layout.subresources[1].offset == layout.subresources[0].offset + 1024);
+        VERIFY(layout.subresources.Back().offset + layout.subresources.Back().size == ktx.Size());
+
+        // a level which doesn't fit in the file
+        VERIFY(!VkTextureContainer::Parse(ktx.Begin(), ktx.Size() - 1, layout));
+    }
+
+    // supercompressed KTX2 is rejected
+    {
+        Util::Array<uint64_t> levelSizes;
+        levelSizes.Append(64);
+        Util::Array<ubyte> ktx = MakeKTX2(VK_FORMAT_R8G8B8A8_UNORM, 4, 4, 0, 0, 1, levelSizes, 1);
+        VERIFY(!VkTextureContainer::Parse(ktx.Begin(), ktx.Size(), layout));
+    }
+
+    // garbage
+    {
+        Util::Array<ubyte> garbage;
+        AppendBytes(garbage, 200, 0);
+        VERIFY(!VkTextureContainer::Parse(garbage.Begin(), garbage.Size(), layout));
+        VERIFY(!VkTextureContainer::Parse(garbage.Begin(), 2, layout));
+    }
+}
+
+} // namespace Test
@@ -0,0 +1,26 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Test::TextureContainerTest
+
+    Checks the layouts computed by Vulkan::VkTextureContainer for DDS and
+    KTX2 headers, and that truncated or unsupported files are rejected.
+    Runs entirely on the CPU.
+
+    (C) 2020 Individual contributors, see AUTHORS file
+*/
+#include "testbase/testcase.h"
+
+//------------------------------------------------------------------------------
+namespace Test
+{
+class TextureContainerTest : public TestCase
+{
+    __DeclareClass(TextureContainerTest);
+public:
+    /// run the test
+    virtual void Run();
+};
+
+} // namespace Test
+//------------------------------------------------------------------------------
@@ -7,6 +7,8 @@ include(cotire)
 
 option(N_USE_PRECOMPILED_HEADERS "Use precompiled headers" ON)
 option(N_ENABLE_SHADER_COMMAND_GENERATION "Generate shader compile file for live shader reload" ON)
+option(N_BUILD_TESTS "Build the unit tests" OFF)
+option(N_BUILD_BENCHMARKS "Build the benchmarks" OFF)
 
 if(FIPS_WINDOWS)
 	option(N_STATIC_BUILD "Use static runtime in windows builds" ON)
@@ -0,0 +1,64 @@
+#-------------------------------------------------------------------------------
+#   telemetryclient.py
+#
+#   Minimal client for the /telemetry server-sent event stream of a running
+#   Nebula application (see Debug::TelemetryPageHandler). Prints one line per
+#   frame and reports frames which were dropped because the client didn't
+#   keep up.
+#
+#   usage: python telemetryclient.py [url]
+#       url defaults to http://localhost:2100/telemetry, without a url
+#       and with stdin redirected the events are read from stdin
+#-------------------------------------------------------------------------------
+import sys
+import json
+import urllib.request
+
+DefaultUrl = 'http://localhost:2100/telemetry'
+
+#-------------------------------------------------------------------------------
+def events(lines) :
+    """yields (event, payload) for every event, the default event is 'message'"""
+    event, data = 'message', []
+    for raw in lines :
+        line = raw.decode('utf-8').rstrip('\r\n')
+        if line == '' :
+            if data :
+                yield event, json.loads('\n'.join(data))
+            event, data = 'message', []
+        elif line.startswith('event:') :
+            event = line[6:].strip()
+        elif line.startswith('data:') :
+            data.append(line[5:].strip())
+
+#-------------------------------------------------------------------------------
+def run(lines) :
+    channels, last = None, None
+    for event, payload in events(lines) :
+        if event == 'channels' :
+            # the frame indices start over with new channels
+            channels, last = payload, None
+            print('channels', channels)
+        else :
+            frame, values = payload[0], payload[1:]
+            if channels is None or len(values) != len(channels) :
+                print('frame {} doesn\'t match the channels'.format(frame), file=sys.stderr)
+                continue
+            gap = ''
+            if last is not None and frame != last + 1 :
+                gap = '  (dropped {})'.format(frame - last - 1)
+            print(frame, dict(zip(channels, values)), gap)
+            last = frame
+
+#-------------------------------------------------------------------------------
+if __name__ == '__main__' :
+    if len(sys.argv) > 1 :
+        source = urllib.request.urlopen(sys.argv[1])
+    elif sys.stdin.isatty() :
+        source = urllib.request.urlopen(DefaultUrl)
+    else :
+        source = sys.stdin.buffer
+    try :
+        run(source)
+    except KeyboardInterrupt :
+        pass